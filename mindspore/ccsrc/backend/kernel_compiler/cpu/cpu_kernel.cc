@@ -14,9 +14,129 @@
  * limitations under the License.
  */
 #include "backend/kernel_compiler/cpu/cpu_kernel.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <thread>
 
 namespace mindspore {
 namespace kernel {
+namespace {
+// Threads are created once and shared by all kernels, instead of spawning threads in every launch.
+class CPUKernelThreadPool {
+ public:
+  static CPUKernelThreadPool &GetInstance() {
+    static CPUKernelThreadPool instance;
+    return instance;
+  }
+
+  size_t thread_num() const { return workers_.size() + 1; }
+
+  void SyncRun(const std::vector<std::function<void()>> &tasks) {
+    if (tasks.empty()) {
+      return;
+    }
+    auto batch = std::make_shared<TaskBatch>(&tasks);
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      for (size_t i = 1; i < tasks.size(); ++i) {
+        queue_.push(batch);
+      }
+    }
+    queue_cond_.notify_all();
+    // The caller runs the tasks of its own batch that no worker has claimed yet. It never picks up tasks of other
+    // callers, which may wait on locks the caller holds.
+    while (batch->RunNext()) {
+    }
+    {
+      std::unique_lock<std::mutex> lock(batch->mutex_);
+      batch->cond_.wait(lock, [&batch]() { return batch->remaining_ == 0; });
+    }
+    if (batch->exception_ != nullptr) {
+      std::rethrow_exception(batch->exception_);
+    }
+  }
+
+ private:
+  struct TaskBatch {
+    explicit TaskBatch(const std::vector<std::function<void()>> *tasks)
+        : tasks_(tasks), task_num_(tasks->size()), remaining_(tasks->size()) {}
+
+    // Claims and runs one task, the queue entries of a finished batch find nothing left to claim.
+    bool RunNext() {
+      size_t index = next_++;
+      if (index >= task_num_) {
+        return false;
+      }
+      try {
+        (*tasks_)[index]();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (exception_ == nullptr) {
+          exception_ = std::current_exception();
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--remaining_ == 0) {
+        cond_.notify_all();
+      }
+      return true;
+    }
+
+    const std::vector<std::function<void()>> *tasks_;
+    const size_t task_num_;
+    std::atomic<size_t> next_{0};
+    size_t remaining_;
+    std::exception_ptr exception_{nullptr};
+    std::mutex mutex_;
+    std::condition_variable cond_;
+  };
+
+  CPUKernelThreadPool() {
+    size_t worker_num = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+    for (size_t i = 0; i < worker_num; ++i) {
+      workers_.emplace_back(&CPUKernelThreadPool::WorkerLoop, this);
+    }
+  }
+
+  ~CPUKernelThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      stop_ = true;
+    }
+    queue_cond_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void WorkerLoop() {
+    while (true) {
+      std::shared_ptr<TaskBatch> batch;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        batch = std::move(queue_.front());
+        queue_.pop();
+      }
+      batch->RunNext();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::queue<std::shared_ptr<TaskBatch>> queue_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;
+  bool stop_{false};
+};
+}  // namespace
+
 void CPUKernel::InitInputOutputSize(const CNodePtr &kernel_node) {
   MS_EXCEPTION_IF_NULL(kernel_node);
   size_t input_num = AnfAlgo::GetInputTensorNum(kernel_node);
@@ -79,5 +199,22 @@ void CPUKernelUtils::GetElementNumEveryDim(const std::vector<size_t> &shape, std
   }
   std::reverse(element_num->begin(), element_num->end());
 }
+
+size_t CPUKernelUtils::GetParallelThreadNum() { return CPUKernelThreadPool::GetInstance().thread_num(); }
+
+void CPUKernelUtils::ParallelFor(const CTask &task, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  size_t task_num = std::min(count, GetParallelThreadNum());
+  size_t once_compute_size = (count + task_num - 1) / task_num;
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(task_num);
+  for (size_t start = 0; start < count; start += once_compute_size) {
+    size_t end = std::min(start + once_compute_size, count);
+    tasks.emplace_back([&task, start, end]() { task(start, end); });
+  }
+  CPUKernelThreadPool::GetInstance().SyncRun(tasks);
+}
 }  // namespace kernel
 }  // namespace mindspore
@@ -97,12 +97,18 @@ class CPUKernel : public kernel::KernelMod {
   std::vector<size_t> workspace_size_list_;
 };
 
+using CTask = std::function<void(size_t, size_t)>;
+
 class CPUKernelUtils {
  public:
   static void ExpandDimsTo4(std::vector<size_t> *shape);
   static size_t CalcOffset(const std::vector<size_t> &shape, size_t dim0, size_t dim1, size_t dim2, size_t dim3);
   static size_t GetElementNumOnAxis(const std::vector<size_t> &shape, int axis);
   static void GetElementNumEveryDim(const std::vector<size_t> &shape, std::vector<size_t> *element_num);
+  // Splits [0, count) into one range per thread of a persistent pool and returns when all ranges are done.
+  // Safe to call from several threads and from inside a running task.
+  static void ParallelFor(const CTask &task, size_t count);
+  static size_t GetParallelThreadNum();
 };
 }  // namespace kernel
 }  // namespace mindspore
@@ -0,0 +1,189 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "backend/kernel_compiler/cpu/multi_tensor_optimizer_cpu_kernel.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "common/thread_pool.h"
+
+namespace mindspore {
+namespace kernel {
+namespace {
+// below this many elements per task the thread pool costs more than it saves
+constexpr size_t kMinElemNumPerTask = 4096;
+// keep the task ranges on separate cache lines
+constexpr size_t kElemNumAlign = 16;
+}  // namespace
+
+void MultiTensorOptimizerCPUKernel::InitKernel(const CNodePtr &kernel_node) {
+  MS_EXCEPTION_IF_NULL(kernel_node);
+  group_num_ = AnfAlgo::GetNodeAttr<size_t>(kernel_node, "n");
+  size_t input_num = AnfAlgo::GetInputTensorNum(kernel_node);
+  if (group_num_ == 0 || input_num != group_num_ * group_input_num_) {
+    MS_LOG(EXCEPTION) << "Input number is " << input_num << ", but " << AnfAlgo::GetCNodeName(kernel_node)
+                      << " needs " << group_input_num_ << " inputs for each of the " << group_num_ << " parameters.";
+  }
+  InitGroupAttr(kernel_node);
+}
+
+bool MultiTensorOptimizerCPUKernel::Launch(const std::vector<kernel::AddressPtr> &inputs,
+                                           const std::vector<kernel::AddressPtr> & /*workspace*/,
+                                           const std::vector<kernel::AddressPtr> & /*outputs*/) {
+  if (inputs.size() != group_num_ * group_input_num_) {
+    MS_LOG(EXCEPTION) << "Input number is " << inputs.size() << ", but " << group_num_ * group_input_num_
+                      << " inputs are needed.";
+  }
+  // elem_offsets[i] is the offset of parameter i in the concatenated element space of all parameters
+  std::vector<size_t> elem_offsets(group_num_ + 1, 0);
+  for (size_t group = 0; group < group_num_; ++group) {
+    CheckGroup(inputs, group);
+    elem_offsets[group + 1] = elem_offsets[group] + inputs[group * group_input_num_]->size / sizeof(float);
+  }
+  size_t total_elem_num = elem_offsets.back();
+  auto update_range = [this, &inputs, &elem_offsets](size_t start, size_t end) {
+    auto group = static_cast<size_t>(std::upper_bound(elem_offsets.begin(), elem_offsets.end(), start) -
+                                     elem_offsets.begin() - 1);
+    for (; group < group_num_ && elem_offsets[group] < end; ++group) {
+      size_t group_start = std::max(start, elem_offsets[group]) - elem_offsets[group];
+      size_t group_end = std::min(end, elem_offsets[group + 1]) - elem_offsets[group];
+      if (group_start < group_end) {
+        UpdateGroup(inputs, group * group_input_num_, group_start, group_end);
+      }
+    }
+  };
+
+  size_t max_task_num = std::max(std::min(static_cast<size_t>(std::thread::hardware_concurrency()),
+                                          static_cast<size_t>(kDefaultMaxThreadNum)),
+                                 static_cast<size_t>(1));
+  size_t task_num = std::min(max_task_num, (total_elem_num + kMinElemNumPerTask - 1) / kMinElemNumPerTask);
+  if (task_num <= 1) {
+    update_range(0, total_elem_num);
+    return true;
+  }
+  size_t once_compute_size = (total_elem_num + task_num - 1) / task_num;
+  once_compute_size = (once_compute_size + kElemNumAlign - 1) / kElemNumAlign * kElemNumAlign;
+  std::vector<Task> tasks;
+  for (size_t start = 0; start < total_elem_num; start += once_compute_size) {
+    size_t end = std::min(start + once_compute_size, total_elem_num);
+    tasks.emplace_back([&update_range, start, end]() -> int {
+      update_range(start, end);
+      return SUCCESS;
+    });
+  }
+  return ThreadPool::GetInstance()->LaunchMultipleTask(tasks);
+}
+
+void MultiTensorApplyMomentumCPUKernel::CheckGroup(const std::vector<AddressPtr> &inputs, size_t group) const {
+  size_t offset = group * group_input_num_;
+  if (inputs[offset]->size != inputs[offset + 1]->size || inputs[offset]->size != inputs[offset + 3]->size) {
+    MS_LOG(EXCEPTION) << "Error input data size of parameter " << group << "!";
+  }
+}
+
+void MultiTensorApplyMomentumCPUKernel::UpdateGroup(const std::vector<AddressPtr> &inputs, size_t group_offset,
+                                                    size_t start, size_t end) const {
+  auto weight = reinterpret_cast<float *>(inputs[group_offset]->addr);
+  auto accumulate = reinterpret_cast<float *>(inputs[group_offset + 1]->addr);
+  float learning_rate = reinterpret_cast<float *>(inputs[group_offset + 2]->addr)[0];
+  auto gradient = reinterpret_cast<float *>(inputs[group_offset + 3]->addr);
+  float moment = reinterpret_cast<float *>(inputs[group_offset + 4]->addr)[0];
+  for (size_t i = start; i < end; ++i) {
+    accumulate[i] = accumulate[i] * moment + gradient[i];
+    weight[i] -= accumulate[i] * learning_rate;
+  }
+}
+
+void MultiTensorAdamCPUKernel::InitGroupAttr(const CNodePtr &kernel_node) {
+  use_nesterov_ = AnfAlgo::GetNodeAttr<bool>(kernel_node, "use_nesterov");
+}
+
+void MultiTensorAdamCPUKernel::CheckGroup(const std::vector<AddressPtr> &inputs, size_t group) const {
+  size_t offset = group * group_input_num_;
+  if (inputs[offset]->size != inputs[offset + 1]->size || inputs[offset]->size != inputs[offset + 2]->size ||
+      inputs[offset]->size != inputs[offset + 9]->size) {
+    MS_LOG(EXCEPTION) << "Error input data size of parameter " << group << "!";
+  }
+  for (size_t i = 3; i < 9; ++i) {
+    if (inputs[offset + i]->size != sizeof(float)) {
+      MS_LOG(EXCEPTION) << "The attribute beta_power, beta, lr and epsilon must be float!";
+    }
+  }
+  if (reinterpret_cast<float *>(inputs[offset + 3]->addr)[0] == 1) {
+    MS_LOG(EXCEPTION) << "The beta1_power can't be set 1.";
+  }
+}
+
+void MultiTensorAdamCPUKernel::UpdateGroup(const std::vector<AddressPtr> &inputs, size_t group_offset, size_t start,
+                                           size_t end) const {
+  auto var = reinterpret_cast<float *>(inputs[group_offset]->addr);
+  auto m = reinterpret_cast<float *>(inputs[group_offset + 1]->addr);
+  auto v = reinterpret_cast<float *>(inputs[group_offset + 2]->addr);
+  float beta1_power = reinterpret_cast<float *>(inputs[group_offset + 3]->addr)[0];
+  float beta2_power = reinterpret_cast<float *>(inputs[group_offset + 4]->addr)[0];
+  float lr = reinterpret_cast<float *>(inputs[group_offset + 5]->addr)[0];
+  float beta1 = reinterpret_cast<float *>(inputs[group_offset + 6]->addr)[0];
+  float beta2 = reinterpret_cast<float *>(inputs[group_offset + 7]->addr)[0];
+  float epsilon = reinterpret_cast<float *>(inputs[group_offset + 8]->addr)[0];
+  auto gradient = reinterpret_cast<float *>(inputs[group_offset + 9]->addr);
+  float new_lr = lr * std::sqrt(1.0 - beta2_power) / (1 - beta1_power);
+  float one_sub_beta1 = 1 - beta1;
+  float one_sub_beta2 = 1 - beta2;
+  // the branch is hoisted out of the element loops, so that both loops can be vectorized
+  if (use_nesterov_) {
+    for (size_t i = start; i < end; ++i) {
+      m[i] += (gradient[i] - m[i]) * one_sub_beta1;
+      v[i] += (gradient[i] * gradient[i] - v[i]) * one_sub_beta2;
+      var[i] -= new_lr * (m[i] * beta1 + one_sub_beta1 * gradient[i]) / (std::sqrt(v[i]) + epsilon);
+    }
+  } else {
+    for (size_t i = start; i < end; ++i) {
+      m[i] += (gradient[i] - m[i]) * one_sub_beta1;
+      v[i] += (gradient[i] * gradient[i] - v[i]) * one_sub_beta2;
+      var[i] -= new_lr * m[i] / (std::sqrt(v[i]) + epsilon);
+    }
+  }
+}
+
+void MultiTensorApplyRMSPropCPUKernel::InitGroupAttr(const CNodePtr &kernel_node) {
+  decay_ = AnfAlgo::GetNodeAttr<float>(kernel_node, "rho");
+  momentum_ = AnfAlgo::GetNodeAttr<float>(kernel_node, "momentum");
+  epsilon_ = AnfAlgo::GetNodeAttr<float>(kernel_node, "epsilon");
+}
+
+void MultiTensorApplyRMSPropCPUKernel::CheckGroup(const std::vector<AddressPtr> &inputs, size_t group) const {
+  size_t offset = group * group_input_num_;
+  if (inputs[offset]->size != inputs[offset + 1]->size || inputs[offset]->size != inputs[offset + 2]->size ||
+      inputs[offset]->size != inputs[offset + 4]->size) {
+    MS_LOG(EXCEPTION) << "Error input data size of parameter " << group << "!";
+  }
+}
+
+void MultiTensorApplyRMSPropCPUKernel::UpdateGroup(const std::vector<AddressPtr> &inputs, size_t group_offset,
+                                                   size_t start, size_t end) const {
+  auto variable = reinterpret_cast<float *>(inputs[group_offset]->addr);
+  auto mean_square = reinterpret_cast<float *>(inputs[group_offset + 1]->addr);
+  auto moment = reinterpret_cast<float *>(inputs[group_offset + 2]->addr);
+  float learning_rate = reinterpret_cast<float *>(inputs[group_offset + 3]->addr)[0];
+  auto gradients = reinterpret_cast<float *>(inputs[group_offset + 4]->addr);
+  float one_sub_decay = 1 - decay_;
+  for (size_t i = start; i < end; ++i) {
+    mean_square[i] += (gradients[i] * gradients[i] - mean_square[i]) * one_sub_decay;
+    moment[i] = moment[i] * momentum_ + (gradients[i] * learning_rate) / std::sqrt(mean_square[i] + epsilon_);
+    variable[i] -= moment[i];
+  }
+}
+}  // namespace kernel
+}  // namespace mindspore
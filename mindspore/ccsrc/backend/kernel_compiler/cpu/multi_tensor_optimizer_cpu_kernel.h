@@ -0,0 +1,103 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_MULTI_TENSOR_OPTIMIZER_CPU_KERNEL_H_
+#define MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_MULTI_TENSOR_OPTIMIZER_CPU_KERNEL_H_
+
+#include <vector>
+#include <memory>
+#include "backend/kernel_compiler/cpu/cpu_kernel.h"
+#include "backend/kernel_compiler/cpu/cpu_kernel_factory.h"
+
+namespace mindspore {
+namespace kernel {
+// Updates n parameters in one launch. The inputs are the inputs of the n single tensor optimizers concatenated,
+// the elements of all parameters are split into equal ranges that run as one parallel-for on the thread pool.
+class MultiTensorOptimizerCPUKernel : public CPUKernel {
+ public:
+  explicit MultiTensorOptimizerCPUKernel(size_t group_input_num) : group_input_num_(group_input_num) {}
+  ~MultiTensorOptimizerCPUKernel() override = default;
+
+  void InitKernel(const CNodePtr &kernel_node) override;
+
+  bool Launch(const std::vector<AddressPtr> &inputs, const std::vector<AddressPtr> &workspace,
+              const std::vector<AddressPtr> &outputs) override;
+
+ protected:
+  virtual void InitGroupAttr(const CNodePtr &kernel_node) {}
+  virtual void CheckGroup(const std::vector<AddressPtr> &inputs, size_t group) const = 0;
+  // Update the elements [start, end) of the parameter of one group, group inputs begin at inputs[group_offset].
+  virtual void UpdateGroup(const std::vector<AddressPtr> &inputs, size_t group_offset, size_t start,
+                           size_t end) const = 0;
+  size_t group_input_num_;
+  size_t group_num_{0};
+};
+
+class MultiTensorApplyMomentumCPUKernel : public MultiTensorOptimizerCPUKernel {
+ public:
+  MultiTensorApplyMomentumCPUKernel() : MultiTensorOptimizerCPUKernel(5) {}
+  ~MultiTensorApplyMomentumCPUKernel() override = default;
+
+ protected:
+  void CheckGroup(const std::vector<AddressPtr> &inputs, size_t group) const override;
+  void UpdateGroup(const std::vector<AddressPtr> &inputs, size_t group_offset, size_t start,
+                   size_t end) const override;
+};
+
+class MultiTensorAdamCPUKernel : public MultiTensorOptimizerCPUKernel {
+ public:
+  MultiTensorAdamCPUKernel() : MultiTensorOptimizerCPUKernel(10) {}
+  ~MultiTensorAdamCPUKernel() override = default;
+
+ protected:
+  void InitGroupAttr(const CNodePtr &kernel_node) override;
+  void CheckGroup(const std::vector<AddressPtr> &inputs, size_t group) const override;
+  void UpdateGroup(const std::vector<AddressPtr> &inputs, size_t group_offset, size_t start,
+                   size_t end) const override;
+
+ private:
+  bool use_nesterov_{false};
+};
+
+class MultiTensorApplyRMSPropCPUKernel : public MultiTensorOptimizerCPUKernel {
+ public:
+  MultiTensorApplyRMSPropCPUKernel() : MultiTensorOptimizerCPUKernel(5) {}
+  ~MultiTensorApplyRMSPropCPUKernel() override = default;
+
+ protected:
+  void InitGroupAttr(const CNodePtr &kernel_node) override;
+  void CheckGroup(const std::vector<AddressPtr> &inputs, size_t group) const override;
+  void UpdateGroup(const std::vector<AddressPtr> &inputs, size_t group_offset, size_t start,
+                   size_t end) const override;
+
+ private:
+  float decay_{0.0};
+  float momentum_{0.9};
+  float epsilon_{1e-12};
+};
+
+MS_REG_CPU_KERNEL(MultiTensorApplyMomentum,
+                  KernelAttr().SetAllSameAttr(true).AddInputAttr(kNumberTypeFloat32).AddOutputAttr(kNumberTypeFloat32),
+                  MultiTensorApplyMomentumCPUKernel);
+MS_REG_CPU_KERNEL(MultiTensorAdam,
+                  KernelAttr().SetAllSameAttr(true).AddInputAttr(kNumberTypeFloat32).AddOutputAttr(kNumberTypeFloat32),
+                  MultiTensorAdamCPUKernel);
+MS_REG_CPU_KERNEL(MultiTensorApplyRMSProp,
+                  KernelAttr().SetAllSameAttr(true).AddInputAttr(kNumberTypeFloat32).AddOutputAttr(kNumberTypeFloat32),
+                  MultiTensorApplyRMSPropCPUKernel);
+}  // namespace kernel
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_MULTI_TENSOR_OPTIMIZER_CPU_KERNEL_H_
@@ -40,6 +40,8 @@ class EmbeddingLookUpPSKernel : public EmbeddingLookUpCPUKernel, public PServerK
   const std::vector<size_t> &input_sizes() const override;
   const std::vector<size_t> &output_sizes() const override;
   const std::vector<size_t> &workspace_sizes() const override;
+  // The id of the first row of the shard held by this server.
+  size_t offset() const { return static_cast<size_t>(offset_); }
 
  private:
   std::vector<size_t> input_shape_;
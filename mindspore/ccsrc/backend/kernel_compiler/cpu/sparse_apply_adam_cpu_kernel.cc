@@ -165,7 +165,6 @@ void SparseApplyAdamCPUKernel::LaunchKernel(const std::vector<kernel::AddressPtr
   param.output_grad_ = &unique_sparse_grad;
   param.max_index_ = var_first_dim_size_;
   param.value_stride_ = var_outer_dim_size_;
-  BucketReduceSparseGradient(param);
 
   size_t total_dim_size = var_first_dim_size_ * var_outer_dim_size_;
   lr = lr * std::sqrt(1 - beta2_power) / (1 - beta1_power);
@@ -179,10 +178,9 @@ void SparseApplyAdamCPUKernel::LaunchKernel(const std::vector<kernel::AddressPtr
 
   input_params.m_t_ = m_t;
   input_params.use_nesterov_ = use_nesterov_;
-  input_params.sparse_grad_ = unique_sparse_grad;
   input_params.var_first_dim_size_ = var_first_dim_size_;
   input_params.var_outer_dim_size_ = var_outer_dim_size_;
-  MultiThreadCompute<T>(ComputeAdam<T>, &input_params, unique_sparse_grad.indices_size_);
+  BucketReduceAndApplySparseGradient<T>(param, ComputeAdam<T>, input_params);
 
   if (use_nesterov_) {
     input_params.m_ = input_params.m_t_;
@@ -18,8 +18,7 @@
 
 #include <vector>
 #include <memory>
-#include <thread>
-#include <unordered_map>
+#include <limits>
 #include <algorithm>
 #include <utility>
 #include "backend/kernel_compiler/cpu/cpu_kernel.h"
@@ -27,11 +26,10 @@
 
 namespace mindspore {
 namespace kernel {
-#ifdef ENABLE_D
-constexpr size_t kUsedThreadNum = 23;
-#else
-constexpr size_t kUsedThreadNum = 8;
-#endif
+// buckets covering at most this many rows are reduced with a direct mapped slot table instead of a hash table
+constexpr size_t kDenseReduceMaxRange = 1 << 18;
+constexpr size_t kInvalidReduceSlot = std::numeric_limits<size_t>::max();
+
 template <typename T>
 struct SparseGradient {
   float *value_{nullptr};
@@ -46,7 +44,6 @@ struct ReduceSparseGradientParam {
   SparseGradient<T> *output_grad_{nullptr};
   size_t max_index_{0};
   size_t value_stride_{0};
-  bool use_sort_reduce_{false};
 };
 
 template <typename T>
@@ -67,17 +64,18 @@ struct MultiThreadComputeParams {
   SparseGradient<T> sparse_grad_;
   size_t var_first_dim_size_{0};
   size_t var_outer_dim_size_{0};
-  bool use_nesterov_;
+  bool use_nesterov_{false};
 };
 template <typename T>
 using MultiThreadComputeFunc = std::function<void(MultiThreadComputeParams<T> *param, size_t start, size_t end)>;
 
 template <typename T>
 struct BucketSparseGradient {
-  float *value_;
-  T *indices_;
-  T *global_indices_;
-  size_t indices_size_;
+  T *indices_{nullptr};
+  T *global_indices_{nullptr};
+  size_t indices_size_{0};
+  // position of the bucket in the output and workspace buffers
+  size_t offset_{0};
 };
 
 template <typename T>
@@ -87,8 +85,64 @@ struct MultiThreadReduceSparseGradientParam {
   SparseGradient<T> *output_grad_{nullptr};
   size_t max_index_{0};
   size_t value_stride_{0};
-  size_t thread_num_{0};
-  bool use_sort_reduce_{false};
+  size_t segment_num_{0};
+  size_t bucket_num_{0};
+  // the bucket of index i is i >> radix_shift_, so every bucket covers a contiguous range of rows
+  size_t radix_shift_{0};
+};
+
+// Maps the rows of one bucket to their slot in the reduced bucket with a table indexed by the row itself.
+template <typename T>
+class DenseReduceSlotMap {
+ public:
+  DenseReduceSlotMap(T base, size_t range) : base_(base) {
+    // the table stays with the thread and only the touched entries are reset, so a launch costs O(indices)
+    static thread_local std::vector<size_t> slots;
+    if (slots.size() < range) {
+      slots.resize(range, kInvalidReduceSlot);
+    }
+    slots_ = slots.data();
+  }
+  size_t &Slot(T index) { return slots_[index - base_]; }
+  void Reset(const T *indices, size_t indices_size) {
+    for (size_t i = 0; i < indices_size; ++i) {
+      slots_[indices[i] - base_] = kInvalidReduceSlot;
+    }
+  }
+
+ private:
+  T base_;
+  size_t *slots_{nullptr};
+};
+
+// Open addressing with linear probing for buckets whose row range is too wide for a dense table.
+template <typename T>
+class HashReduceSlotMap {
+ public:
+  explicit HashReduceSlotMap(size_t indices_size) {
+    static thread_local std::vector<std::pair<T, size_t>> table;
+    size_t capacity = 1;
+    while (capacity < indices_size * 2) {
+      capacity <<= 1;
+    }
+    table.assign(capacity, std::make_pair(static_cast<T>(-1), kInvalidReduceSlot));
+    table_ = table.data();
+    mask_ = capacity - 1;
+  }
+  size_t &Slot(T index) {
+    size_t pos = (static_cast<size_t>(index) * kHashMultiplier) & mask_;
+    while (table_[pos].first != index && table_[pos].first != static_cast<T>(-1)) {
+      pos = (pos + 1) & mask_;
+    }
+    table_[pos].first = index;
+    return table_[pos].second;
+  }
+  void Reset(const T *, size_t) {}
+
+ private:
+  static constexpr size_t kHashMultiplier = 0x9E3779B97F4A7C15ULL;
+  std::pair<T, size_t> *table_{nullptr};
+  size_t mask_{0};
 };
 
 class SparseOptimizerCPUKernel : public CPUKernel {
@@ -96,342 +150,218 @@ class SparseOptimizerCPUKernel : public CPUKernel {
   SparseOptimizerCPUKernel() = default;
   ~SparseOptimizerCPUKernel() override = default;
 
+  // Sums the rows of duplicated indices into param.output_grad_, ordered by bucket of rows. Indices out of
+  // [0, max_index) are dropped.
   template <typename T>
   static void BucketReduceSparseGradient(const ReduceSparseGradientParam<T> &param) {
     MS_LOG(DEBUG) << "Start";
-    MS_EXCEPTION_IF_NULL(param.input_grad_);
-    size_t thread_num = kUsedThreadNum;
-    if (param.input_grad_->indices_size_ < thread_num) {
-      thread_num = param.input_grad_->indices_size_;
-    }
-    MultiThreadReduceSparseGradientParam<T> multi_thread_param(
-      {param.input_grad_, param.workspace_grad_, param.output_grad_, param.max_index_, param.value_stride_, thread_num,
-       param.use_sort_reduce_});
-    std::vector<std::shared_ptr<SparseGradient<T>>> segments;
-    std::vector<std::shared_ptr<std::vector<size_t>>> segment_bucket_sizes;
-    SplitAndCalculateSegmentBucketSize(multi_thread_param, &segments, &segment_bucket_sizes);
-
-    std::vector<std::shared_ptr<BucketSparseGradient<T>>> buckets;
-    GatherSegmentIndicesToOutputBucket(multi_thread_param, segments, segment_bucket_sizes, &buckets);
-
-    std::vector<std::shared_ptr<SparseGradient<T>>> reduced_buckets;
-    ReduceBucketSparseGradientToWorkspace(multi_thread_param, buckets, &reduced_buckets);
-
+    auto multi_thread_param = InitMultiThreadReduceParam(param);
+    std::vector<BucketSparseGradient<T>> buckets;
+    RadixPartitionToBuckets(multi_thread_param, &buckets);
+    std::vector<SparseGradient<T>> reduced_buckets(buckets.size());
+    CPUKernelUtils::ParallelFor(
+      [&multi_thread_param, &buckets, &reduced_buckets](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+          ReduceBucketSparseGradient(multi_thread_param, i, buckets[i], &reduced_buckets[i]);
+        }
+      },
+      buckets.size());
     MergeReduceSparseGradient(multi_thread_param, reduced_buckets);
     MS_LOG(DEBUG) << "End";
   }
 
- protected:
+  // Reduces like BucketReduceSparseGradient and runs func on the reduced rows of every bucket in the task that
+  // reduced it. The buckets cover disjoint rows, so func may update the rows without locking. The reduced gradient
+  // is never merged, param.output_grad_ is only used as scratch memory.
   template <typename T>
-  void MultiThreadCompute(const MultiThreadComputeFunc<T> &func, MultiThreadComputeParams<T> *params,
-                          size_t total_compute_size) const {
-    std::vector<std::thread> threads;
-    threads.reserve(kUsedThreadNum);
-    size_t start = 0;
-    size_t once_compute_size = (total_compute_size + kUsedThreadNum - 1) / kUsedThreadNum;
-    while (start < total_compute_size) {
-      size_t end = (start + once_compute_size) > total_compute_size ? total_compute_size : (start + once_compute_size);
-      threads.emplace_back(std::thread(func, params, start, end));
-      start += once_compute_size;
-    }
-    for (size_t i = 0; i < threads.size(); ++i) {
-      threads[i].join();
-    }
-  }
-
- private:
-  template <typename T>
-  static void CalculateEachBucketSize(const std::shared_ptr<SparseGradient<T>> &sparse_grad, size_t max_index,
-                                      std::vector<size_t> *each_bucket_size) {
+  static void BucketReduceAndApplySparseGradient(const ReduceSparseGradientParam<T> &param,
+                                                 const MultiThreadComputeFunc<T> &func,
+                                                 const MultiThreadComputeParams<T> &compute_params) {
     MS_LOG(DEBUG) << "Start";
-    MS_EXCEPTION_IF_NULL(sparse_grad);
-    MS_EXCEPTION_IF_NULL(sparse_grad->indices_);
-    MS_EXCEPTION_IF_NULL(each_bucket_size);
-    size_t bucket_num = each_bucket_size->size();
-    for (size_t i = 0; i < sparse_grad->indices_size_; ++i) {
-      T index = sparse_grad->indices_[i];
-      if (index >= 0 && LongToSize(index) < max_index) {
-        auto bucket_id = index % bucket_num;
-        each_bucket_size->at(bucket_id)++;
-      }
-    }
+    auto multi_thread_param = InitMultiThreadReduceParam(param);
+    std::vector<BucketSparseGradient<T>> buckets;
+    RadixPartitionToBuckets(multi_thread_param, &buckets);
+    CPUKernelUtils::ParallelFor(
+      [&multi_thread_param, &buckets, &func, &compute_params](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+          MultiThreadComputeParams<T> bucket_params = compute_params;
+          ReduceBucketSparseGradient(multi_thread_param, i, buckets[i], &bucket_params.sparse_grad_);
+          func(&bucket_params, 0, bucket_params.sparse_grad_.indices_size_);
+        }
+      },
+      buckets.size());
     MS_LOG(DEBUG) << "End";
   }
 
+ protected:
   template <typename T>
-  static void SplitAndCalculateSegmentBucketSize(
-    const MultiThreadReduceSparseGradientParam<T> &param, std::vector<std::shared_ptr<SparseGradient<T>>> *segments_ptr,
-    std::vector<std::shared_ptr<std::vector<size_t>>> *segment_bucket_sizes_ptr) {
-    MS_EXCEPTION_IF_NULL(param.input_grad_);
-    MS_EXCEPTION_IF_NULL(segment_bucket_sizes_ptr);
-    MS_EXCEPTION_IF_NULL(segments_ptr);
-    auto &segments = *segments_ptr;
-    auto &segment_bucket_sizes = *segment_bucket_sizes_ptr;
-    auto input_grad = param.input_grad_;
-    if (param.thread_num_ < 1) {
-      MS_EXCEPTION(ArgumentError) << "Input param thread num must > 0!";
-    }
-    size_t thread_indices_size = input_grad->indices_size_ / param.thread_num_;
-    size_t left_indices_size = input_grad->indices_size_ % param.thread_num_;
-    std::vector<std::thread> threads;
-    threads.reserve(param.thread_num_);
-    segments.reserve(param.thread_num_);
-
-    size_t current_indices_offset = 0;
-    for (size_t i = 0; i < param.thread_num_; ++i) {
-      segment_bucket_sizes.emplace_back(std::make_shared<std::vector<size_t>>(param.thread_num_, 0));
-      size_t indices_size = thread_indices_size;
-      if (i < left_indices_size) {
-        indices_size += 1;
-      }
-      segments.emplace_back(std::make_shared<SparseGradient<T>>());
-      segments[i]->value_ = input_grad->value_ + current_indices_offset * param.value_stride_;
-      segments[i]->indices_ = input_grad->indices_ + current_indices_offset;
-      segments[i]->indices_size_ = indices_size;
-      threads.emplace_back(
-        std::thread(CalculateEachBucketSize<T>, segments[i], param.max_index_, segment_bucket_sizes[i].get()));
-      current_indices_offset += indices_size;
-    }
-
-    for (size_t i = 0; i < param.thread_num_; ++i) {
-      threads[i].join();
-    }
+  void MultiThreadCompute(const MultiThreadComputeFunc<T> &func, MultiThreadComputeParams<T> *params,
+                          size_t total_compute_size) const {
+    CPUKernelUtils::ParallelFor([&func, params](size_t start, size_t end) { func(params, start, end); },
+                                total_compute_size);
   }
 
+ private:
   template <typename T>
-  static void CopySegmentIndicesToBucket(const MultiThreadReduceSparseGradientParam<T> &param,
-                                         const std::shared_ptr<SparseGradient<T>> &segment, size_t bucket_offset,
-                                         const std::vector<std::shared_ptr<BucketSparseGradient<T>>> &buckets) {
-    MS_LOG(DEBUG) << "Start";
-    MS_EXCEPTION_IF_NULL(segment);
-    MS_EXCEPTION_IF_NULL(segment->indices_);
-    std::vector<size_t> bucket_data_num(param.thread_num_, 0);
-    for (size_t i = 0; i < segment->indices_size_; ++i) {
-      T index = segment->indices_[i];
-      if (index >= 0 && LongToSize(index) < param.max_index_) {
-        auto bucket_id = index % param.thread_num_;
-        auto bucket_index = bucket_data_num[bucket_id];
-        buckets[bucket_id]->indices_[bucket_index] = index;
-        buckets[bucket_id]->global_indices_[bucket_index] = bucket_offset + i;
-        bucket_data_num[bucket_id]++;
-      }
+  static MultiThreadReduceSparseGradientParam<T> InitMultiThreadReduceParam(const ReduceSparseGradientParam<T> &param) {
+    MS_EXCEPTION_IF_NULL(param.input_grad_);
+    MS_EXCEPTION_IF_NULL(param.workspace_grad_);
+    MS_EXCEPTION_IF_NULL(param.output_grad_);
+    MultiThreadReduceSparseGradientParam<T> multi_thread_param;
+    multi_thread_param.input_grad_ = param.input_grad_;
+    multi_thread_param.workspace_grad_ = param.workspace_grad_;
+    multi_thread_param.output_grad_ = param.output_grad_;
+    multi_thread_param.max_index_ = param.max_index_;
+    multi_thread_param.value_stride_ = param.value_stride_;
+    size_t thread_num = CPUKernelUtils::GetParallelThreadNum();
+    multi_thread_param.segment_num_ = std::max(std::min(thread_num, param.input_grad_->indices_size_), size_t(1));
+    size_t bucket_num = std::max(std::min(thread_num, param.max_index_), size_t(1));
+    size_t bucket_range = (param.max_index_ + bucket_num - 1) / bucket_num;
+    while ((size_t(1) << multi_thread_param.radix_shift_) < bucket_range) {
+      multi_thread_param.radix_shift_++;
     }
-    MS_LOG(DEBUG) << "End";
+    multi_thread_param.bucket_num_ =
+      param.max_index_ == 0 ? 1 : ((param.max_index_ - 1) >> multi_thread_param.radix_shift_) + 1;
+    return multi_thread_param;
   }
 
+  // Two pass radix partition: count the rows of every (segment, bucket), then scatter the indices of each segment
+  // to its slice of the buckets. The buckets keep the input order of the indices.
   template <typename T>
-  static void GatherSegmentIndicesToOutputBucket(
-    const MultiThreadReduceSparseGradientParam<T> &param,
-    const std::vector<std::shared_ptr<SparseGradient<T>>> &segments,
-    const std::vector<std::shared_ptr<std::vector<size_t>>> &segment_bucket_sizes,
-    std::vector<std::shared_ptr<BucketSparseGradient<T>>> *buckets_ptr) {
-    MS_EXCEPTION_IF_NULL(param.output_grad_);
-    MS_EXCEPTION_IF_NULL(param.output_grad_->value_);
-    MS_EXCEPTION_IF_NULL(param.output_grad_->indices_);
+  static void RadixPartitionToBuckets(const MultiThreadReduceSparseGradientParam<T> &param,
+                                      std::vector<BucketSparseGradient<T>> *buckets_ptr) {
     MS_EXCEPTION_IF_NULL(buckets_ptr);
+    MS_EXCEPTION_IF_NULL(param.input_grad_->indices_);
+    MS_EXCEPTION_IF_NULL(param.output_grad_->indices_);
+    MS_EXCEPTION_IF_NULL(param.workspace_grad_->indices_);
+    auto input_grad = param.input_grad_;
+    size_t segment_num = param.segment_num_;
+    size_t bucket_num = param.bucket_num_;
+    size_t segment_size = (input_grad->indices_size_ + segment_num - 1) / segment_num;
+    std::vector<size_t> segment_bucket_sizes(segment_num * bucket_num, 0);
+    CPUKernelUtils::ParallelFor(
+      [&](size_t start, size_t end) {
+        for (size_t segment = start; segment < end; ++segment) {
+          size_t *bucket_sizes = segment_bucket_sizes.data() + segment * bucket_num;
+          size_t segment_end = std::min((segment + 1) * segment_size, input_grad->indices_size_);
+          for (size_t i = segment * segment_size; i < segment_end; ++i) {
+            T index = input_grad->indices_[i];
+            if (index >= 0 && LongToSize(index) < param.max_index_) {
+              bucket_sizes[LongToSize(index) >> param.radix_shift_]++;
+            }
+          }
+        }
+      },
+      segment_num);
+
+    // bucket major prefix sum, so every bucket is contiguous and the segments follow each other inside it
     auto &buckets = *buckets_ptr;
-    size_t thread_num = param.thread_num_;
-    if (thread_num != segment_bucket_sizes.size()) {
-      MS_EXCEPTION(ArgumentError) << "Input param thread num not equal to segment size!";
-    }
-    std::vector<size_t> bucket_data_size(thread_num, 0);
-    for (size_t i = 0; i < thread_num; ++i) {
-      for (size_t j = 0; j < thread_num; ++j) {
-        bucket_data_size[j] += segment_bucket_sizes[i]->at(j);
-      }
-    }
-    size_t current_indices_offset = 0;
-    for (size_t i = 0; i < thread_num; ++i) {
-      buckets.emplace_back(std::make_shared<BucketSparseGradient<T>>());
-      buckets[i]->value_ = param.output_grad_->value_ + current_indices_offset * param.value_stride_;
-      buckets[i]->indices_ = param.output_grad_->indices_ + current_indices_offset;
-      buckets[i]->global_indices_ = param.workspace_grad_->indices_ + current_indices_offset;
-      buckets[i]->indices_size_ = bucket_data_size[i];
-      current_indices_offset += bucket_data_size[i];
-    }
-    std::vector<size_t> tmp_bucket_data_size(thread_num, 0);
-    std::vector<std::vector<std::shared_ptr<BucketSparseGradient<T>>>> each_thread_buckets;
-    for (size_t i = 0; i < thread_num; ++i) {
-      std::vector<std::shared_ptr<BucketSparseGradient<T>>> thread_buckets;
-      for (size_t j = 0; j < thread_num; ++j) {
-        thread_buckets.emplace_back(std::make_shared<BucketSparseGradient<T>>());
-        thread_buckets[j]->indices_ = buckets[j]->indices_ + tmp_bucket_data_size[j];
-        thread_buckets[j]->global_indices_ = buckets[j]->global_indices_ + tmp_bucket_data_size[j];
-        thread_buckets[j]->value_ = buckets[j]->value_ + tmp_bucket_data_size[j] * param.value_stride_;
-        thread_buckets[j]->indices_size_ = segment_bucket_sizes[i]->at(j);
-        tmp_bucket_data_size[j] += segment_bucket_sizes[i]->at(j);
+    buckets.resize(bucket_num);
+    std::vector<size_t> write_offsets(segment_num * bucket_num, 0);
+    size_t current_offset = 0;
+    for (size_t bucket = 0; bucket < bucket_num; ++bucket) {
+      buckets[bucket].offset_ = current_offset;
+      buckets[bucket].indices_ = param.output_grad_->indices_ + current_offset;
+      buckets[bucket].global_indices_ = param.workspace_grad_->indices_ + current_offset;
+      for (size_t segment = 0; segment < segment_num; ++segment) {
+        write_offsets[segment * bucket_num + bucket] = current_offset;
+        current_offset += segment_bucket_sizes[segment * bucket_num + bucket];
       }
-      each_thread_buckets.emplace_back(thread_buckets);
+      buckets[bucket].indices_size_ = current_offset - buckets[bucket].offset_;
     }
-    std::vector<std::thread> threads;
-    threads.reserve(thread_num);
-    current_indices_offset = 0;
-    for (size_t i = 0; i < thread_num; ++i) {
-      threads.emplace_back(
-        std::thread(CopySegmentIndicesToBucket<T>, param, segments[i], current_indices_offset, each_thread_buckets[i]));
-      current_indices_offset += segments[i]->indices_size_;
-    }
-    for (size_t i = 0; i < thread_num; ++i) {
-      threads[i].join();
-    }
-  }
 
-  template <typename T>
-  static void SortAndReduceBucketSparseGradient(const MultiThreadReduceSparseGradientParam<T> &param,
-                                                const std::shared_ptr<BucketSparseGradient<T>> &bucket,
-                                                const std::shared_ptr<SparseGradient<T>> &reduced_bucket) {
-    MS_LOG(DEBUG) << "Start";
-    MS_EXCEPTION_IF_NULL(bucket);
-    MS_EXCEPTION_IF_NULL(bucket->value_);
-    MS_EXCEPTION_IF_NULL(bucket->indices_);
-    MS_EXCEPTION_IF_NULL(reduced_bucket);
-    MS_EXCEPTION_IF_NULL(reduced_bucket->value_);
-    MS_EXCEPTION_IF_NULL(reduced_bucket->indices_);
-    std::vector<std::pair<T, T>> sorted_indices;
-    sorted_indices.reserve(bucket->indices_size_);
-    for (size_t i = 0; i < bucket->indices_size_; ++i) {
-      T index = bucket->indices_[i];
-      T global_index = bucket->global_indices_[i];
-      sorted_indices.emplace_back(std::pair<T, T>(index, global_index));
-    }
-    std::sort(sorted_indices.begin(), sorted_indices.end());
-
-    float *global_value = param.input_grad_->value_;
-    size_t unique_indices_size = 0;
-    size_t max_length = reduced_bucket->indices_size_ * param.value_stride_;
-    T last_index{0};
-    size_t value_offset{0};
-    for (size_t i = 0; i < sorted_indices.size(); ++i) {
-      T index = sorted_indices[i].first;
-      T global_index = sorted_indices[i].second;
-      T global_value_offset = global_index * param.value_stride_;
-      if (i == 0 || index != last_index) {
-        if (i != 0) {
-          unique_indices_size++;
+    CPUKernelUtils::ParallelFor(
+      [&](size_t start, size_t end) {
+        for (size_t segment = start; segment < end; ++segment) {
+          size_t *offsets = write_offsets.data() + segment * bucket_num;
+          size_t segment_end = std::min((segment + 1) * segment_size, input_grad->indices_size_);
+          for (size_t i = segment * segment_size; i < segment_end; ++i) {
+            T index = input_grad->indices_[i];
+            if (index >= 0 && LongToSize(index) < param.max_index_) {
+              size_t pos = offsets[LongToSize(index) >> param.radix_shift_]++;
+              param.output_grad_->indices_[pos] = index;
+              param.workspace_grad_->indices_[pos] = static_cast<T>(i);
+            }
+          }
         }
-        reduced_bucket->indices_[unique_indices_size] = index;
-        value_offset = unique_indices_size * param.value_stride_;
-        auto ret_code = memcpy_s(reduced_bucket->value_ + value_offset, (max_length - value_offset) * sizeof(float),
-                                 global_value + global_value_offset, param.value_stride_ * sizeof(float));
-        if (ret_code != EOK) {
-          MS_LOG(EXCEPTION) << "Failed to copy data!";
-        }
-      } else {
-        for (size_t j = 0; j < param.value_stride_; ++j) {
-          reduced_bucket->value_[value_offset + j] += global_value[global_value_offset + j];
-        }
-      }
-      last_index = index;
-    }
-    reduced_bucket->indices_size_ = unique_indices_size;
-    MS_LOG(DEBUG) << "End";
+      },
+      segment_num);
   }
 
-  template <typename T>
-  static void ReduceBucketSparseGradient(const MultiThreadReduceSparseGradientParam<T> &param,
-                                         const std::shared_ptr<BucketSparseGradient<T>> &bucket,
-                                         const std::shared_ptr<SparseGradient<T>> &reduced_bucket) {
-    MS_LOG(DEBUG) << "Start";
-    MS_EXCEPTION_IF_NULL(bucket);
-    MS_EXCEPTION_IF_NULL(bucket->value_);
-    MS_EXCEPTION_IF_NULL(bucket->indices_);
-    MS_EXCEPTION_IF_NULL(reduced_bucket);
-    MS_EXCEPTION_IF_NULL(reduced_bucket->value_);
-    MS_EXCEPTION_IF_NULL(reduced_bucket->indices_);
-
-    float *global_value = param.input_grad_->value_;
-    std::unordered_map<T, size_t> index_map;
+  template <typename T, typename SlotMap>
+  static void ReduceBucketWithSlotMap(const MultiThreadReduceSparseGradientParam<T> &param,
+                                      const BucketSparseGradient<T> &bucket, SlotMap *slot_map,
+                                      SparseGradient<T> *reduced_bucket) {
+    const float *global_value = param.input_grad_->value_;
+    size_t stride = param.value_stride_;
     size_t unique_indices_size = 0;
-    size_t max_length = reduced_bucket->indices_size_ * param.value_stride_;
-    for (size_t i = 0; i < bucket->indices_size_; ++i) {
-      T index = bucket->indices_[i];
-      T global_index = bucket->global_indices_[i];
-      auto iter = index_map.find(index);
-      if (iter == index_map.end()) {
+    for (size_t i = 0; i < bucket.indices_size_; ++i) {
+      T index = bucket.indices_[i];
+      const float *src = global_value + LongToSize(bucket.global_indices_[i]) * stride;
+      size_t &slot = slot_map->Slot(index);
+      if (slot == kInvalidReduceSlot) {
+        slot = unique_indices_size;
+        // reduced indices share memory with global_indices_, the write never passes the read position
         reduced_bucket->indices_[unique_indices_size] = index;
-        size_t start_index = unique_indices_size * param.value_stride_;
-        index_map[index] = start_index;
-        auto ret_code =
-          memcpy_s(reduced_bucket->value_ + start_index, (max_length - start_index) * sizeof(float),
-                   global_value + global_index * param.value_stride_, param.value_stride_ * sizeof(float));
-        if (ret_code != EOK) {
-          MS_LOG(EXCEPTION) << "Failed to copy data!";
-        }
+        float *dst = reduced_bucket->value_ + unique_indices_size * stride;
+        std::copy(src, src + stride, dst);
         unique_indices_size++;
       } else {
-        size_t start_index = iter->second;
-        size_t end_index = start_index + param.value_stride_;
-        for (size_t j = start_index, k = global_index * param.value_stride_; j < end_index; ++j, ++k) {
-          reduced_bucket->value_[j] += global_value[k];
+        float *dst = reduced_bucket->value_ + slot * stride;
+        for (size_t j = 0; j < stride; ++j) {
+          dst[j] += src[j];
         }
       }
     }
     reduced_bucket->indices_size_ = unique_indices_size;
-    MS_LOG(DEBUG) << "End";
+    slot_map->Reset(reduced_bucket->indices_, unique_indices_size);
   }
 
   template <typename T>
-  static void ReduceBucketSparseGradientToWorkspace(
-    const MultiThreadReduceSparseGradientParam<T> &param,
-    const std::vector<std::shared_ptr<BucketSparseGradient<T>>> &buckets,
-    std::vector<std::shared_ptr<SparseGradient<T>>> *reduced_buckets_ptr) {
-    MS_EXCEPTION_IF_NULL(param.workspace_grad_);
+  static void ReduceBucketSparseGradient(const MultiThreadReduceSparseGradientParam<T> &param, size_t bucket_id,
+                                         const BucketSparseGradient<T> &bucket, SparseGradient<T> *reduced_bucket) {
+    MS_EXCEPTION_IF_NULL(reduced_bucket);
+    MS_EXCEPTION_IF_NULL(param.input_grad_->value_);
     MS_EXCEPTION_IF_NULL(param.workspace_grad_->value_);
-    MS_EXCEPTION_IF_NULL(param.workspace_grad_->indices_);
-    MS_EXCEPTION_IF_NULL(reduced_buckets_ptr);
-    auto &reduced_buckets = *reduced_buckets_ptr;
-    size_t thread_num = buckets.size();
-    std::vector<std::thread> threads;
-    threads.reserve(thread_num);
-
-    size_t current_indices_offset = 0;
-    for (size_t i = 0; i < thread_num; ++i) {
-      reduced_buckets.emplace_back(std::make_shared<SparseGradient<T>>());
-      reduced_buckets[i]->value_ = param.workspace_grad_->value_ + current_indices_offset * param.value_stride_;
-      reduced_buckets[i]->indices_ = param.workspace_grad_->indices_ + current_indices_offset;
-      reduced_buckets[i]->indices_size_ = buckets[i]->indices_size_;
-      if (param.use_sort_reduce_) {
-        threads.emplace_back(std::thread(SortAndReduceBucketSparseGradient<T>, param, buckets[i], reduced_buckets[i]));
-      } else {
-        threads.emplace_back(std::thread(ReduceBucketSparseGradient<T>, param, buckets[i], reduced_buckets[i]));
-      }
-      current_indices_offset += buckets[i]->indices_size_;
+    reduced_bucket->value_ = param.workspace_grad_->value_ + bucket.offset_ * param.value_stride_;
+    reduced_bucket->indices_ = bucket.global_indices_;
+    reduced_bucket->indices_size_ = 0;
+    if (bucket.indices_size_ == 0) {
+      return;
     }
-    for (size_t i = 0; i < thread_num; ++i) {
-      threads[i].join();
+    size_t range = size_t(1) << param.radix_shift_;
+    if (range <= kDenseReduceMaxRange) {
+      DenseReduceSlotMap<T> slot_map(static_cast<T>(bucket_id << param.radix_shift_), range);
+      ReduceBucketWithSlotMap(param, bucket, &slot_map, reduced_bucket);
+    } else {
+      HashReduceSlotMap<T> slot_map(bucket.indices_size_);
+      ReduceBucketWithSlotMap(param, bucket, &slot_map, reduced_bucket);
     }
   }
 
   template <typename T>
   static void MergeReduceSparseGradient(const MultiThreadReduceSparseGradientParam<T> &param,
-                                        const std::vector<std::shared_ptr<SparseGradient<T>>> &reduced_buckets) {
-    MS_EXCEPTION_IF_NULL(param.output_grad_);
+                                        const std::vector<SparseGradient<T>> &reduced_buckets) {
     auto output_grad = param.output_grad_;
     MS_EXCEPTION_IF_NULL(output_grad->value_);
     MS_EXCEPTION_IF_NULL(output_grad->indices_);
-    size_t stride_data_size = param.value_stride_ * sizeof(float);
-    size_t unique_indices_size = 0;
+    std::vector<size_t> merge_offsets(reduced_buckets.size() + 1, 0);
     for (size_t i = 0; i < reduced_buckets.size(); ++i) {
-      auto &bucket = reduced_buckets[i];
-      MS_EXCEPTION_IF_NULL(bucket);
-      if (bucket->indices_size_ == 0) {
-        continue;
-      }
-      auto ret_code = memcpy_s(output_grad->value_ + unique_indices_size * param.value_stride_,
-                               (output_grad->indices_size_ - unique_indices_size) * stride_data_size, bucket->value_,
-                               bucket->indices_size_ * stride_data_size);
-      if (ret_code != EOK) {
-        MS_LOG(EXCEPTION) << "Failed to copy data!";
-      }
-      ret_code = memcpy_s(output_grad->indices_ + unique_indices_size,
-                          (output_grad->indices_size_ - unique_indices_size) * sizeof(T), bucket->indices_,
-                          bucket->indices_size_ * sizeof(T));
-      if (ret_code != EOK) {
-        MS_LOG(EXCEPTION) << "Failed to copy data!";
-      }
-      unique_indices_size += bucket->indices_size_;
+      merge_offsets[i + 1] = merge_offsets[i] + reduced_buckets[i].indices_size_;
     }
-    output_grad->indices_size_ = unique_indices_size;
+    // the reduced buckets live in the workspace, so every bucket is copied to the output independently
+    CPUKernelUtils::ParallelFor(
+      [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+          auto &bucket = reduced_buckets[i];
+          size_t stride = param.value_stride_;
+          std::copy(bucket.value_, bucket.value_ + bucket.indices_size_ * stride,
+                    output_grad->value_ + merge_offsets[i] * stride);
+          std::copy(bucket.indices_, bucket.indices_ + bucket.indices_size_, output_grad->indices_ + merge_offsets[i]);
+        }
+      },
+      reduced_buckets.size());
+    output_grad->indices_size_ = merge_offsets.back();
   }
 
  protected:
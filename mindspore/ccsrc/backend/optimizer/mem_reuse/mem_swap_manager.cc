@@ -480,10 +480,8 @@ void MemSwapManager::AddKernelExecutionPerform(const AnfNodePtr &kernel, float p
 void MemSwapManager::AddKernelSwapPerform(const AnfNodePtr &kernel, size_t output_idx,
                                           const std::pair<float, float> &perform) {
   MS_EXCEPTION_IF_NULL(kernel);
-  auto iter = kernel_swap_perform_.find(kernel.get());
-  if (iter == kernel_swap_perform_.end()) {
-    kernel_swap_perform_[kernel.get()][output_idx] = perform;
-  }
+  // keep the first record of every output
+  (void)kernel_swap_perform_[kernel.get()].emplace(output_idx, perform);
 }
 
 void MemSwapManager::AddKernelMemSwapInfo(const AnfNodePtr &kernel, const MemSwapInfo &mem_swap_info) {
@@ -0,0 +1,386 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "backend/optimizer/pass/memory_budget_recompute.h"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <set>
+
+#include "backend/session/anf_runtime_algorithm.h"
+#include "backend/session/kernel_graph.h"
+#include "runtime/device/kernel_info.h"
+#include "utils/ms_utils.h"
+#include "utils/flags.h"
+#include "utils/utils.h"
+
+namespace mindspore {
+namespace opt {
+namespace {
+constexpr auto kGradientsScope = "Gradients/";
+constexpr auto kAttrTransposeA = "transpose_a";
+constexpr size_t kMBShift = 20;
+const std::set<std::string> kNotRecomputableOps = {kDropoutOpName,  kDropoutGenMaskOpName, "StandardNormal",
+                                                   "UniformInt",    "UniformReal",         "RandomChoiceWithMask",
+                                                   "Assign",        "AssignAdd",           "ScatterNdUpdate"};
+
+bool IsBackwardKernel(const CNodePtr &kernel) {
+  MS_EXCEPTION_IF_NULL(kernel);
+  return kernel->fullname_with_scope().find(kGradientsScope) == 0;
+}
+
+bool IsRecomputableKernel(const CNodePtr &kernel) {
+  MS_EXCEPTION_IF_NULL(kernel);
+  if (AnfAlgo::GetOutputTensorNum(kernel) != 1 || AnfAlgo::IsCommunicationOp(kernel)) {
+    return false;
+  }
+  if (kNotRecomputableOps.find(AnfAlgo::GetCNodeName(kernel)) != kNotRecomputableOps.end()) {
+    return false;
+  }
+  return !AnfAlgo::HasNodeAttr(GRAPH_FLAG_SIDE_EFFECT, kernel) ||
+         !AnfAlgo::GetNodeAttr<bool>(kernel, GRAPH_FLAG_SIDE_EFFECT);
+}
+
+size_t ShapeSize(const std::vector<size_t> &shape) {
+  return std::accumulate(shape.begin(), shape.end(), static_cast<size_t>(1), std::multiplies<size_t>());
+}
+
+size_t OutputMemSize(const CNodePtr &kernel, size_t index) {
+  auto type_size = GetTypeByte(TypeIdToType(AnfAlgo::GetOutputDeviceDataType(kernel, index)));
+  return ShapeSize(AnfAlgo::GetOutputDeviceShape(kernel, index)) * type_size;
+}
+
+// A rough cost model: one flop per output element, except for the contractions dominating CNN and NLP graphs.
+double EstimateKernelFlops(const CNodePtr &kernel) {
+  MS_EXCEPTION_IF_NULL(kernel);
+  double output_elements = 0;
+  for (size_t i = 0; i < AnfAlgo::GetOutputTensorNum(kernel); ++i) {
+    output_elements += ShapeSize(AnfAlgo::GetOutputDeviceShape(kernel, i));
+  }
+  auto kernel_name = AnfAlgo::GetCNodeName(kernel);
+  if (kernel_name == prim::kPrimMatMul->name() && AnfAlgo::GetInputTensorNum(kernel) >= 2) {
+    auto shape_a = AnfAlgo::GetPrevNodeOutputInferShape(kernel, 0);
+    if (shape_a.size() == 2) {
+      bool transpose_a =
+        AnfAlgo::HasNodeAttr(kAttrTransposeA, kernel) && AnfAlgo::GetNodeAttr<bool>(kernel, kAttrTransposeA);
+      return 2 * output_elements * (transpose_a ? shape_a[0] : shape_a[1]);
+    }
+  }
+  if (kernel_name == kConv2DOpName && AnfAlgo::GetInputTensorNum(kernel) >= 2) {
+    auto weight_shape = AnfAlgo::GetPrevNodeOutputInferShape(kernel, 1);
+    if (!weight_shape.empty() && weight_shape[0] != 0) {
+      return 2 * output_elements * (ShapeSize(weight_shape) / weight_shape[0]);
+    }
+  }
+  return output_elements;
+}
+
+CNodePtr CloneKernel(const KernelGraphPtr &kernel_graph, const CNodePtr &origin,
+                     const std::map<AnfNodePtr, AnfNodePtr> &replace_inputs) {
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  MS_EXCEPTION_IF_NULL(origin);
+  std::vector<AnfNodePtr> inputs = {origin->input(0)};
+  for (size_t i = 1; i < origin->inputs().size(); ++i) {
+    auto iter = replace_inputs.find(origin->input(i));
+    inputs.push_back(iter == replace_inputs.end() ? origin->input(i) : iter->second);
+  }
+  auto clone = kernel_graph->NewCNode(inputs);
+  MS_EXCEPTION_IF_NULL(clone);
+  clone->set_abstract(origin->abstract());
+  clone->set_scope(origin->scope());
+  AnfAlgo::SetSelectKernelBuildInfo(AnfAlgo::GetSelectKernelBuildInfo(origin), clone.get());
+  return clone;
+}
+}  // namespace
+
+size_t RecomputePlanner::RecomputeStep(size_t tensor_id) const {
+  const auto &use_steps = tensors_[tensor_id].use_steps;
+  auto iter = std::lower_bound(use_steps.begin(), use_steps.end(), first_backward_step_);
+  return iter == use_steps.end() ? step_num_ : *iter;
+}
+
+bool RecomputePlanner::CanDrop(size_t tensor_id) const {
+  const auto &tensor = tensors_[tensor_id];
+  if (!tensor.recomputable || tensor.use_steps.empty() || tensor.def_step >= first_backward_step_) {
+    return false;
+  }
+  auto recompute_step = RecomputeStep(tensor_id);
+  if (recompute_step >= step_num_) {
+    return false;
+  }
+  size_t last_forward_use = tensor.def_step;
+  for (auto use_step : tensor.use_steps) {
+    if (use_step < first_backward_step_) {
+      last_forward_use = use_step;
+    }
+  }
+  // nothing to gain when the tensor is alive across the forward/backward boundary only briefly
+  return recompute_step > last_forward_use + 1;
+}
+
+std::vector<size_t> RecomputePlanner::RecomputeSegment(size_t tensor_id, const std::vector<bool> &dropped) const {
+  std::vector<size_t> segment;
+  std::set<size_t> visited = {tensor_id};
+  std::vector<size_t> todo = {tensor_id};
+  while (!todo.empty()) {
+    auto current = todo.back();
+    todo.pop_back();
+    segment.push_back(current);
+    for (auto input : tensors_[current].producer_inputs) {
+      if (dropped[input] && visited.insert(input).second) {
+        todo.push_back(input);
+      }
+    }
+  }
+  std::sort(segment.begin(), segment.end(),
+            [this](size_t a, size_t b) { return tensors_[a].def_step < tensors_[b].def_step; });
+  return segment;
+}
+
+size_t RecomputePlanner::EstimatePeak(const std::vector<bool> &dropped) const {
+  std::vector<int64_t> delta(step_num_ + 1, 0);
+  auto add_interval = [&delta](size_t begin, size_t end, size_t size) {
+    delta[begin] += SizeToLong(size);
+    delta[end + 1] -= SizeToLong(size);
+  };
+  std::vector<size_t> keep_until(tensors_.size());
+  for (size_t id = 0; id < tensors_.size(); ++id) {
+    const auto &use_steps = tensors_[id].use_steps;
+    keep_until[id] = use_steps.empty() ? tensors_[id].def_step : use_steps.back();
+  }
+  for (size_t id = 0; id < tensors_.size(); ++id) {
+    if (!dropped[id]) {
+      continue;
+    }
+    auto recompute_step = RecomputeStep(id);
+    for (auto seg_id : RecomputeSegment(id, dropped)) {
+      for (auto input : tensors_[seg_id].producer_inputs) {
+        if (!dropped[input]) {
+          keep_until[input] = std::max(keep_until[input], recompute_step);
+        }
+      }
+      if (seg_id != id) {
+        add_interval(recompute_step, recompute_step, tensors_[seg_id].size);
+      }
+    }
+    add_interval(recompute_step, tensors_[id].use_steps.back(), tensors_[id].size);
+  }
+  for (size_t id = 0; id < tensors_.size(); ++id) {
+    const auto &tensor = tensors_[id];
+    if (!dropped[id]) {
+      add_interval(tensor.def_step, keep_until[id], tensor.size);
+      continue;
+    }
+    size_t last_forward_use = tensor.def_step;
+    for (auto use_step : tensor.use_steps) {
+      if (use_step < first_backward_step_) {
+        last_forward_use = use_step;
+      }
+    }
+    add_interval(tensor.def_step, last_forward_use, tensor.size);
+  }
+  int64_t current = 0;
+  int64_t peak = 0;
+  for (size_t step = 0; step < step_num_; ++step) {
+    current += delta[step];
+    peak = std::max(peak, current);
+  }
+  return LongToSize(peak);
+}
+
+RecomputePlan RecomputePlanner::Plan(size_t mem_budget) const {
+  RecomputePlan plan;
+  std::vector<bool> dropped(tensors_.size(), false);
+  plan.origin_peak = EstimatePeak(dropped);
+  plan.planned_peak = plan.origin_peak;
+  for (const auto &tensor : tensors_) {
+    plan.total_flops += tensor.flops;
+  }
+
+  std::vector<size_t> candidates;
+  for (size_t id = 0; id < tensors_.size(); ++id) {
+    if (CanDrop(id)) {
+      candidates.push_back(id);
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [this](size_t a, size_t b) { return tensors_[a].size > tensors_[b].size; });
+  for (auto id : candidates) {
+    if (plan.planned_peak <= mem_budget) {
+      break;
+    }
+    dropped[id] = true;
+    auto peak = EstimatePeak(dropped);
+    if (peak < plan.planned_peak) {
+      plan.planned_peak = peak;
+    } else {
+      dropped[id] = false;
+    }
+  }
+
+  for (size_t id = 0; id < tensors_.size(); ++id) {
+    if (!dropped[id]) {
+      continue;
+    }
+    plan.dropped.push_back(id);
+    for (auto seg_id : RecomputeSegment(id, dropped)) {
+      plan.extra_flops += tensors_[seg_id].flops;
+    }
+  }
+  std::stable_sort(plan.dropped.begin(), plan.dropped.end(),
+                   [this](size_t a, size_t b) { return RecomputeStep(a) < RecomputeStep(b); });
+  return plan;
+}
+
+size_t MemoryBudgetRecompute::GetMemBudgetFromEnv() {
+  auto mem_budget = common::GetEnv(kEnvRecomputeMemBudget);
+  if (mem_budget.empty()) {
+    return 0;
+  }
+  size_t mem_budget_mb = 0;
+  try {
+    mem_budget_mb = std::stoul(mem_budget);
+  } catch (std::exception &e) {
+    MS_LOG(WARNING) << "Invalid " << kEnvRecomputeMemBudget << " value: " << mem_budget << ", recompute is disabled.";
+    return 0;
+  }
+  return mem_budget_mb << kMBShift;
+}
+
+bool MemoryBudgetRecompute::Run(const FuncGraphPtr &func_graph) {
+  MS_EXCEPTION_IF_NULL(func_graph);
+  recomputed_num_ = 0;
+  auto kernel_graph = func_graph->cast<KernelGraphPtr>();
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  auto execution_order = kernel_graph->execution_order();
+  auto backward_iter = std::find_if(execution_order.begin(), execution_order.end(), IsBackwardKernel);
+  if (backward_iter == execution_order.end()) {
+    MS_LOG(INFO) << "Graph " << kernel_graph->graph_id() << " has no backward kernel, skip recompute.";
+    return false;
+  }
+  size_t first_backward_step = LongToSize(backward_iter - execution_order.begin());
+
+  std::vector<RecomputeTensorInfo> tensors;
+  std::vector<CNodePtr> tensor_kernels;
+  std::map<session::KernelWithIndex, size_t> output_to_tensor;
+  for (size_t step = 0; step < execution_order.size(); ++step) {
+    const auto &kernel = execution_order[step];
+    bool recomputable = IsRecomputableKernel(kernel);
+    for (size_t i = 0; i < AnfAlgo::GetOutputTensorNum(kernel); ++i) {
+      RecomputeTensorInfo tensor;
+      tensor.size = OutputMemSize(kernel, i);
+      tensor.def_step = step;
+      tensor.flops = EstimateKernelFlops(kernel);
+      tensor.recomputable = recomputable && !kernel_graph->IsInRefOutputMap({kernel, i});
+      output_to_tensor[{kernel, i}] = tensors.size();
+      tensors.push_back(tensor);
+      tensor_kernels.push_back(kernel);
+    }
+  }
+  for (size_t step = 0; step < execution_order.size(); ++step) {
+    const auto &kernel = execution_order[step];
+    std::vector<size_t> kernel_inputs;
+    for (size_t i = 0; i < AnfAlgo::GetInputTensorNum(kernel); ++i) {
+      auto prev_output = AnfAlgo::GetPrevNodeOutput(kernel, i);
+      auto iter = output_to_tensor.find(prev_output);
+      if (iter == output_to_tensor.end()) {
+        continue;
+      }
+      auto &tensor = tensors[iter->second];
+      if (tensor.use_steps.empty() || tensor.use_steps.back() != step) {
+        tensor.use_steps.push_back(step);
+      }
+      // only direct edges can be redirected to a regenerated tensor
+      if (kernel->input(i + 1) != prev_output.first) {
+        tensor.recomputable = false;
+      }
+      kernel_inputs.push_back(iter->second);
+    }
+    for (size_t i = 0; i < AnfAlgo::GetOutputTensorNum(kernel); ++i) {
+      tensors[output_to_tensor[{kernel, i}]].producer_inputs = kernel_inputs;
+    }
+  }
+  for (const auto &output : AnfAlgo::GetAllOutput(kernel_graph->output(), {prim::kPrimTupleGetItem})) {
+    auto iter = output_to_tensor.find(AnfAlgo::VisitKernel(output, 0));
+    if (iter != output_to_tensor.end()) {
+      tensors[iter->second].recomputable = false;
+    }
+  }
+
+  RecomputePlanner planner(tensors, execution_order.size(), first_backward_step);
+  auto plan = planner.Plan(mem_budget_);
+  MS_LOG(INFO) << "Graph " << kernel_graph->graph_id() << " recompute " << plan.dropped.size()
+               << " activations, estimated peak memory " << plan.origin_peak << " -> " << plan.planned_peak
+               << " bytes (budget " << mem_budget_ << "), extra flops " << plan.extra_flops << " ("
+               << (plan.total_flops > 0 ? plan.extra_flops * 100 / plan.total_flops : 0) << "% of graph)";
+  if (plan.planned_peak > mem_budget_) {
+    MS_LOG(WARNING) << "Graph " << kernel_graph->graph_id() << " estimated peak memory " << plan.planned_peak
+                    << " bytes still exceeds the recompute budget " << mem_budget_ << " bytes.";
+  }
+  if (plan.dropped.empty()) {
+    return false;
+  }
+
+  std::vector<bool> dropped(tensors.size(), false);
+  for (auto id : plan.dropped) {
+    dropped[id] = true;
+  }
+  auto manager = kernel_graph->manager();
+  std::map<size_t, std::vector<CNodePtr>> inserted_kernels;
+  for (auto id : plan.dropped) {
+    auto recompute_step = planner.RecomputeStep(id);
+    std::map<AnfNodePtr, AnfNodePtr> clones;
+    for (auto seg_id : planner.RecomputeSegment(id, dropped)) {
+      auto clone = CloneKernel(kernel_graph, tensor_kernels[seg_id], clones);
+      clones[tensor_kernels[seg_id]] = clone;
+      inserted_kernels[recompute_step].push_back(clone);
+    }
+    const auto &origin = tensor_kernels[id];
+    for (auto use_step : tensors[id].use_steps) {
+      if (use_step < recompute_step) {
+        continue;
+      }
+      auto &consumer = execution_order[use_step];
+      for (size_t i = 1; i < consumer->inputs().size(); ++i) {
+        if (consumer->input(i) != origin) {
+          continue;
+        }
+        if (manager != nullptr) {
+          manager->SetEdge(consumer, SizeToInt(i), clones[origin]);
+        } else {
+          consumer->set_input(i, clones[origin]);
+        }
+      }
+    }
+  }
+
+  std::vector<CNodePtr> new_execution_order;
+  for (size_t step = 0; step < execution_order.size(); ++step) {
+    auto iter = inserted_kernels.find(step);
+    if (iter != inserted_kernels.end()) {
+      new_execution_order.insert(new_execution_order.end(), iter->second.begin(), iter->second.end());
+    }
+    new_execution_order.push_back(execution_order[step]);
+  }
+  kernel_graph->set_execution_order(new_execution_order);
+  recomputed_num_ = plan.dropped.size();
+  return true;
+}
+}  // namespace opt
+}  // namespace mindspore
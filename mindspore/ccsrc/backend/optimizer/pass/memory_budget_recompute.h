@@ -0,0 +1,86 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_BACKEND_OPTIMIZER_PASS_MEMORY_BUDGET_RECOMPUTE_H_
+#define MINDSPORE_CCSRC_BACKEND_OPTIMIZER_PASS_MEMORY_BUDGET_RECOMPUTE_H_
+#include <vector>
+#include <string>
+
+#include "backend/optimizer/common/pass.h"
+#include "ir/func_graph.h"
+#include "ir/anf.h"
+
+namespace mindspore {
+namespace opt {
+constexpr auto kEnvRecomputeMemBudget = "MS_CPU_RECOMPUTE_MEM_BUDGET";
+
+// Liveness of one kernel output in execution order, as seen by the recompute planner.
+struct RecomputeTensorInfo {
+  size_t size{0};
+  size_t def_step{0};
+  // sorted execution steps of the kernels reading this tensor
+  std::vector<size_t> use_steps;
+  // tensors read by the producer, indexed into the planner's tensor list
+  std::vector<size_t> producer_inputs;
+  double flops{0};
+  bool recomputable{false};
+};
+
+struct RecomputePlan {
+  std::vector<size_t> dropped;
+  size_t origin_peak{0};
+  size_t planned_peak{0};
+  double extra_flops{0};
+  double total_flops{0};
+};
+
+// Greedy activation checkpointing: drops the largest forward activations whose regeneration lowers the
+// estimated peak, until the peak fits into the memory budget.
+class RecomputePlanner {
+ public:
+  RecomputePlanner(const std::vector<RecomputeTensorInfo> &tensors, size_t step_num, size_t first_backward_step)
+      : tensors_(tensors), step_num_(step_num), first_backward_step_(first_backward_step) {}
+  ~RecomputePlanner() = default;
+  RecomputePlan Plan(size_t mem_budget) const;
+  size_t EstimatePeak(const std::vector<bool> &dropped) const;
+  // The step before which a dropped tensor is regenerated, i.e. its first backward use.
+  size_t RecomputeStep(size_t tensor_id) const;
+  // The dropped tensors (the tensor itself included) that have to be cloned to regenerate tensor_id.
+  std::vector<size_t> RecomputeSegment(size_t tensor_id, const std::vector<bool> &dropped) const;
+
+ private:
+  bool CanDrop(size_t tensor_id) const;
+  std::vector<RecomputeTensorInfo> tensors_;
+  size_t step_num_;
+  size_t first_backward_step_;
+};
+
+class MemoryBudgetRecompute : public Pass {
+ public:
+  explicit MemoryBudgetRecompute(size_t mem_budget) : Pass("memory_budget_recompute"), mem_budget_(mem_budget) {}
+  ~MemoryBudgetRecompute() override = default;
+  bool Run(const FuncGraphPtr &func_graph) override;
+  // The number of activations the last run regenerates, 0 when it left the graph unchanged.
+  size_t recomputed_num() const { return recomputed_num_; }
+  // Budget in bytes read from MS_CPU_RECOMPUTE_MEM_BUDGET (in MB), 0 when recomputation is disabled.
+  static size_t GetMemBudgetFromEnv();
+
+ private:
+  size_t mem_budget_;
+  size_t recomputed_num_{0};
+};
+}  // namespace opt
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_BACKEND_OPTIMIZER_PASS_MEMORY_BUDGET_RECOMPUTE_H_
@@ -0,0 +1,209 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "backend/optimizer/pass/multi_tensor_optimizer_fusion.h"
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+#include "backend/session/anf_runtime_algorithm.h"
+#include "backend/optimizer/common/helper.h"
+#include "frontend/operator/ops.h"
+#include "utils/utils.h"
+#include "utils/ms_utils.h"
+
+namespace mindspore {
+namespace opt {
+namespace {
+const std::map<std::string, std::string> kMultiTensorOptimizerMap = {
+  {kApplyMomentumOpName, kMultiTensorApplyMomentumOpName},
+  {kApplyAdamOpName, kMultiTensorAdamOpName},
+  {kApplyRMSPropOpName, kMultiTensorApplyRMSPropOpName}};
+// the attributes the multi-tensor kernel reads once for all parameters
+const std::map<std::string, std::vector<std::string>> kMultiTensorOptimizerAttrs = {
+  {kApplyMomentumOpName, {}},
+  {kApplyAdamOpName, {"use_nesterov"}},
+  {kApplyRMSPropOpName, {"rho", "momentum", "epsilon"}}};
+
+bool IsFusibleOptimizer(const CNodePtr &cnode) {
+  MS_EXCEPTION_IF_NULL(cnode);
+  if (kMultiTensorOptimizerMap.find(AnfAlgo::GetCNodeName(cnode)) == kMultiTensorOptimizerMap.end()) {
+    return false;
+  }
+  // only the float32 kernels have multi-tensor versions
+  for (size_t i = 0; i < AnfAlgo::GetInputTensorNum(cnode); ++i) {
+    if (AnfAlgo::GetInputDeviceDataType(cnode, i) != kNumberTypeFloat32) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < AnfAlgo::GetOutputTensorNum(cnode); ++i) {
+    if (AnfAlgo::GetOutputDeviceDataType(cnode, i) != kNumberTypeFloat32) {
+      return false;
+    }
+  }
+  for (const auto &attr : kMultiTensorOptimizerAttrs.at(AnfAlgo::GetCNodeName(cnode))) {
+    if (!AnfAlgo::HasNodeAttr(attr, cnode)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string GetFusionGroupKey(const CNodePtr &cnode) {
+  auto op_name = AnfAlgo::GetCNodeName(cnode);
+  auto primitive = AnfAlgo::GetCNodePrimitive(cnode);
+  MS_EXCEPTION_IF_NULL(primitive);
+  std::string key = op_name;
+  for (const auto &attr : kMultiTensorOptimizerAttrs.at(op_name)) {
+    key.append("_").append(primitive->GetAttr(attr)->ToString());
+  }
+  return key;
+}
+
+// An optimizer reading the output of another one can't share its kernel, the combined node would form a cycle.
+std::vector<CNodePtr> RemoveDependentOptimizers(const FuncGraphManagerPtr &manager,
+                                                const std::vector<CNodePtr> &optimizers) {
+  MS_EXCEPTION_IF_NULL(manager);
+  auto &node_users = manager->node_users();
+  std::set<AnfNodePtr> visited;
+  std::queue<AnfNodePtr> to_visit;
+  for (const auto &optimizer : optimizers) {
+    to_visit.push(optimizer);
+  }
+  while (!to_visit.empty()) {
+    auto node = to_visit.front();
+    to_visit.pop();
+    auto iter = node_users.find(node);
+    if (iter == node_users.end()) {
+      continue;
+    }
+    for (const auto &user : iter->second) {
+      if (visited.insert(user.first).second) {
+        to_visit.push(user.first);
+      }
+    }
+  }
+  std::vector<CNodePtr> independent_optimizers;
+  for (const auto &optimizer : optimizers) {
+    if (visited.find(optimizer) == visited.end()) {
+      independent_optimizers.push_back(optimizer);
+    }
+  }
+  return independent_optimizers;
+}
+}  // namespace
+
+void MultiTensorOptimizerFusion::FuseOptimizers(const FuncGraphPtr &func_graph,
+                                                const std::vector<CNodePtr> &optimizers) const {
+  MS_EXCEPTION_IF_NULL(func_graph);
+  auto manager = func_graph->manager();
+  MS_EXCEPTION_IF_NULL(manager);
+  auto op_name = AnfAlgo::GetCNodeName(optimizers[0]);
+  std::vector<AnfNodePtr> inputs = {NewValueNode(std::make_shared<Primitive>(kMultiTensorOptimizerMap.at(op_name)))};
+  std::vector<std::string> inputs_format;
+  std::vector<TypeId> inputs_device_type;
+  std::vector<std::string> outputs_format;
+  std::vector<TypeId> outputs_device_type;
+  AbstractBasePtrList abstract_list;
+  for (const auto &optimizer : optimizers) {
+    for (size_t i = 0; i < AnfAlgo::GetInputTensorNum(optimizer); ++i) {
+      inputs.push_back(AnfAlgo::GetInputNode(optimizer, i));
+      inputs_format.push_back(AnfAlgo::GetInputFormat(optimizer, i));
+      inputs_device_type.push_back(AnfAlgo::GetInputDeviceDataType(optimizer, i));
+    }
+    auto abstract = optimizer->abstract();
+    MS_EXCEPTION_IF_NULL(abstract);
+    size_t output_num = AnfAlgo::GetOutputTensorNum(optimizer);
+    for (size_t i = 0; i < output_num; ++i) {
+      outputs_format.push_back(AnfAlgo::GetOutputFormat(optimizer, i));
+      outputs_device_type.push_back(AnfAlgo::GetOutputDeviceDataType(optimizer, i));
+      abstract_list.push_back(abstract->isa<abstract::AbstractTuple>()
+                                ? abstract->cast<abstract::AbstractTuplePtr>()->elements()[i]
+                                : abstract);
+    }
+  }
+  auto fused_node = func_graph->NewCNode(inputs);
+  MS_EXCEPTION_IF_NULL(fused_node);
+  fused_node->set_scope(optimizers[0]->scope());
+  fused_node->set_abstract(std::make_shared<abstract::AbstractTuple>(abstract_list));
+  AnfAlgo::CopyNodeAttrs(optimizers[0], fused_node);
+  AnfAlgo::SetNodeAttr("n", MakeValue(optimizers.size()), fused_node);
+  kernel::KernelBuildInfo::KernelBuildInfoBuilder builder;
+  builder.SetInputsFormat(inputs_format);
+  builder.SetInputsDeviceType(inputs_device_type);
+  builder.SetOutputsFormat(outputs_format);
+  builder.SetOutputsDeviceType(outputs_device_type);
+  AnfAlgo::SetSelectKernelBuildInfo(builder.Build(), fused_node.get());
+
+  // every optimizer is replaced by its slice of the outputs, so the users see the same values as before
+  size_t output_offset = 0;
+  for (const auto &optimizer : optimizers) {
+    size_t output_num = AnfAlgo::GetOutputTensorNum(optimizer);
+    AnfNodePtr replace_node = nullptr;
+    if (output_num == 1 && !optimizer->abstract()->isa<abstract::AbstractTuple>()) {
+      replace_node = CreatTupleGetItemNode(func_graph, fused_node, output_offset);
+    } else {
+      std::vector<AnfNodePtr> make_tuple_inputs = {NewValueNode(prim::kPrimMakeTuple)};
+      for (size_t i = 0; i < output_num; ++i) {
+        make_tuple_inputs.push_back(CreatTupleGetItemNode(func_graph, fused_node, output_offset + i));
+      }
+      replace_node = func_graph->NewCNode(make_tuple_inputs);
+      replace_node->set_abstract(optimizer->abstract());
+    }
+    output_offset += output_num;
+    if (!manager->Replace(optimizer, replace_node)) {
+      MS_LOG(EXCEPTION) << "Replace node " << optimizer->DebugString() << " failed.";
+    }
+  }
+  MS_LOG(INFO) << "Combine " << optimizers.size() << " " << op_name << " into " << fused_node->fullname_with_scope();
+}
+
+bool MultiTensorOptimizerFusion::IsEnabledByEnv() { return common::GetEnv(kEnvCpuOptimizerFusion) == "1"; }
+
+bool MultiTensorOptimizerFusion::Run(const FuncGraphPtr &func_graph) {
+  MS_EXCEPTION_IF_NULL(func_graph);
+  auto manager = func_graph->manager();
+  MS_EXCEPTION_IF_NULL(manager);
+  std::vector<CNodePtr> optimizers;
+  for (const auto &node : TopoSort(func_graph->get_return())) {
+    if (node == nullptr || !node->isa<CNode>() || !AnfAlgo::IsRealKernel(node)) {
+      continue;
+    }
+    auto cnode = node->cast<CNodePtr>();
+    if (IsFusibleOptimizer(cnode)) {
+      optimizers.push_back(cnode);
+    }
+  }
+  if (optimizers.size() <= 1) {
+    return false;
+  }
+  std::map<std::string, std::vector<CNodePtr>> fusion_groups;
+  for (const auto &optimizer : RemoveDependentOptimizers(manager, optimizers)) {
+    fusion_groups[GetFusionGroupKey(optimizer)].push_back(optimizer);
+  }
+  bool changed = false;
+  for (const auto &group : fusion_groups) {
+    if (group.second.size() <= 1) {
+      continue;
+    }
+    FuseOptimizers(func_graph, group.second);
+    changed = true;
+  }
+  return changed;
+}
+}  // namespace opt
+}  // namespace mindspore
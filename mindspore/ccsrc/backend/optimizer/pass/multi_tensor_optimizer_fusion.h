@@ -0,0 +1,43 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_BACKEND_OPTIMIZER_PASS_MULTI_TENSOR_OPTIMIZER_FUSION_H_
+#define MINDSPORE_CCSRC_BACKEND_OPTIMIZER_PASS_MULTI_TENSOR_OPTIMIZER_FUSION_H_
+#include <vector>
+
+#include "backend/optimizer/common/pass.h"
+#include "ir/func_graph.h"
+#include "ir/anf.h"
+
+namespace mindspore {
+namespace opt {
+constexpr auto kEnvCpuOptimizerFusion = "MS_CPU_OPTIMIZER_FUSION";
+
+// Combines the single tensor optimizers (ApplyMomentum, Adam, ApplyRMSProp) of a CPU graph into one multi-tensor
+// optimizer kernel per op type and attributes, so that an optimizer step is a single launch.
+class MultiTensorOptimizerFusion : public Pass {
+ public:
+  MultiTensorOptimizerFusion() : Pass("multi_tensor_optimizer_fusion") {}
+  ~MultiTensorOptimizerFusion() override = default;
+  bool Run(const FuncGraphPtr &func_graph) override;
+  // The fusion replaces the optimizer kernels of the graph, it is only done when MS_CPU_OPTIMIZER_FUSION is 1.
+  static bool IsEnabledByEnv();
+
+ private:
+  void FuseOptimizers(const FuncGraphPtr &func_graph, const std::vector<CNodePtr> &optimizers) const;
+};
+}  // namespace opt
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_BACKEND_OPTIMIZER_PASS_MULTI_TENSOR_OPTIMIZER_FUSION_H_
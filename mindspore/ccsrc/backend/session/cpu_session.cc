@@ -28,6 +28,8 @@
 #include "backend/optimizer/common/optimizer.h"
 #include "backend/optimizer/common/pass_manager.h"
 #include "backend/optimizer/pass/replace_node_by_proxy.h"
+#include "backend/optimizer/pass/memory_budget_recompute.h"
+#include "backend/optimizer/pass/multi_tensor_optimizer_fusion.h"
 #if (ENABLE_CPU && (ENABLE_D || ENABLE_GPU))
 #include "ps/util.h"
 #endif
@@ -63,6 +65,33 @@ void CPUSession::Optimize(const std::shared_ptr<KernelGraph> &kernel_graph) {
   kernel_graph->SetExecOrderByDefault();
 }
 
+void CPUSession::FuseOptimizers(const std::shared_ptr<KernelGraph> &kernel_graph) {
+  if (!opt::MultiTensorOptimizerFusion::IsEnabledByEnv()) {
+    return;
+  }
+  auto optimizer = std::make_shared<opt::GraphOptimizer>();
+  auto pm = std::make_shared<opt::PassManager>("cpu_optimizer_fusion_pm");
+  pm->AddPass(std::make_shared<opt::MultiTensorOptimizerFusion>());
+  optimizer->AddPassManager(pm);
+  (void)optimizer->Optimize(kernel_graph);
+  kernel_graph->SetExecOrderByDefault();
+}
+
+bool CPUSession::OptimizeMemory(const std::shared_ptr<KernelGraph> &kernel_graph) {
+  auto mem_budget = opt::MemoryBudgetRecompute::GetMemBudgetFromEnv();
+  if (mem_budget == 0) {
+    return false;
+  }
+  // the recompute pass places the regenerated kernels itself, so the execution order must not be reset here
+  auto optimizer = std::make_shared<opt::GraphOptimizer>();
+  auto pm = std::make_shared<opt::PassManager>("cpu_memory_pm");
+  auto recompute = std::make_shared<opt::MemoryBudgetRecompute>(mem_budget);
+  pm->AddPass(recompute);
+  optimizer->AddPassManager(pm);
+  (void)optimizer->Optimize(kernel_graph);
+  return recompute->recomputed_num() > 0;
+}
+
 GraphId CPUSession::CompileGraphImpl(const AnfNodePtrList &lst, const AnfNodePtrList &outputs) {
   auto graph_id = graph_sum_;
   auto graph = ConstructKernelGraph(lst, outputs);
@@ -77,12 +106,25 @@ GraphId CPUSession::CompileGraphImpl(const AnfNodePtrList &lst, const AnfNodePtr
     if (ps::Util::IsRoleOfWorker()) {
       Optimize(graph);
     }
+  } else {
+    FuseOptimizers(graph);
   }
+#else
+  FuseOptimizers(graph);
 #endif
+  bool recomputed = OptimizeMemory(graph);
   MS_LOG(INFO) << "Build kernel";
   BuildKernel(graph.get());
   MS_LOG(INFO) << "Assign kernel address";
+  // dropped activations are only released when memory follows the kernel reference counts, the graphs compiled
+  // later keep the static memory plan
+  if (recomputed) {
+    runtime_.set_dynamic_malloc(true);
+  }
   runtime_.AssignKernelAddress(graph.get());
+  if (recomputed) {
+    runtime_.set_dynamic_malloc(false);
+  }
   return graph_id;
 }
 
@@ -39,6 +39,8 @@ class CPUSession : public SessionBasic {
   void RunGraphImpl(const GraphId &graph_id, const std::vector<tensor::TensorPtr> &inputs, VectorRef *outputs) override;
   ParameterPtr CreateNewParameterFromParameter(const AnfNodePtr &anf, KernelGraph *graph) override;
   void Optimize(const std::shared_ptr<KernelGraph> &kernel_graph);
+  void FuseOptimizers(const std::shared_ptr<KernelGraph> &kernel_graph);
+  bool OptimizeMemory(const std::shared_ptr<KernelGraph> &kernel_graph);
   void BuildOpImpl(const OpRunInfo &op_run_info, const GraphInfo &graph_info,
                    const std::vector<tensor::TensorPtr> &input_tensors,
                    const std::vector<int64_t> &tensors_mask) override;
@@ -39,6 +39,7 @@ PYBIND_REGISTER(ConfigManager, 0, ([](const py::module *m) {
                     .def("get_callback_timeout", &ConfigManager::callback_timeout)
                     .def("get_monitor_sampling_interval", &ConfigManager::monitor_sampling_interval)
                     .def("get_num_parallel_workers", &ConfigManager::num_parallel_workers)
+                    .def("get_numa_aware", &ConfigManager::numa_aware)
                     .def("get_op_connector_size", &ConfigManager::op_connector_size)
                     .def("get_rows_per_buffer", &ConfigManager::rows_per_buffer)
                     .def("get_seed", &ConfigManager::seed)
@@ -49,6 +50,7 @@ PYBIND_REGISTER(ConfigManager, 0, ([](const py::module *m) {
                     .def("set_callback_timeout", &ConfigManager::set_callback_timeout)
                     .def("set_monitor_sampling_interval", &ConfigManager::set_monitor_sampling_interval)
                     .def("set_num_parallel_workers", &ConfigManager::set_num_parallel_workers)
+                    .def("set_numa_aware", &ConfigManager::set_numa_aware)
                     .def("set_op_connector_size", &ConfigManager::set_op_connector_size)
                     .def("set_rows_per_buffer", &ConfigManager::set_rows_per_buffer)
                     .def("set_seed", &ConfigManager::set_seed)
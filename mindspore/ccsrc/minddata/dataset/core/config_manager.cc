@@ -43,6 +43,7 @@ ConfigManager::ConfigManager()
       num_connections_(kDftNumConnections),
       prefetch_size_(kDftPrefetchSize),
       auto_num_workers_(kDftAutoNumWorkers),
+      numa_aware_(kDftNumaAware),
       num_cpu_threads_(std::thread::hardware_concurrency()),
       auto_num_workers_num_shards_(1),
       auto_worker_config_(0) {
@@ -70,7 +71,8 @@ void ConfigManager::Print(std::ostream &out) const {
       << "\nDataCache Rows per buffer    : " << rows_per_buffer_
       << "\nParallelOp workers           : " << num_parallel_workers_
       << "\nParallelOp worker connector size    : " << worker_connector_size_
-      << "\nSize of each Connector : " << op_connector_size_ << std::endl;
+      << "\nSize of each Connector : " << op_connector_size_ << std::boolalpha
+      << "\nNuma aware pipeline : " << numa_aware_ << std::endl;
 }
 
 // Private helper function that takes a nlohmann json format and populates the settings
@@ -85,6 +87,7 @@ Status ConfigManager::FromJson(const nlohmann::json &j) {
   set_cache_port(j.value("cachePort", cache_port_));
   set_num_connections(j.value("numConnections", num_connections_));
   set_prefetch_size(j.value("prefetchSize", prefetch_size_));
+  set_numa_aware(j.value("numaAware", numa_aware_));
   return Status::OK();
 }
 
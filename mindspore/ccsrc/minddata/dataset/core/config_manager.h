@@ -111,6 +111,10 @@ class ConfigManager {
   /// \return auto_num_workers_
   bool auto_num_workers() const { return auto_num_workers_; }
 
+  /// getter function
+  /// \return numa_aware_
+  bool numa_aware() const { return numa_aware_; }
+
   // setter function
   // @param rows_per_buffer - The setting to apply to the config
   void set_rows_per_buffer(int32_t rows_per_buffer);
@@ -172,6 +176,11 @@ class ConfigManager {
   // @param auto_num_workers - whether assign threads to each op automatically
   void set_auto_num_workers(bool auto_num_workers) { auto_num_workers_ = auto_num_workers; }
 
+  // setter function
+  // @param numa_aware - whether to pin the workers of each op to the numa nodes and let them allocate the
+  //     tensors they produce from the memory of their node
+  void set_numa_aware(bool numa_aware) { numa_aware_ = numa_aware; }
+
   // setter function
   // this function will be called when a distributed sampler (RT and Obj) is created and will be used by AutoWorkerPass
   // This is to get around the limitation of PreBuildSampler (which doesn't have a getter for sharding params)
@@ -219,6 +228,7 @@ class ConfigManager {
   int32_t num_connections_;
   int32_t prefetch_size_;
   bool auto_num_workers_;
+  bool numa_aware_;
   const int32_t num_cpu_threads_;
   int32_t auto_num_workers_num_shards_;
   uint8_t auto_worker_config_;
@@ -15,6 +15,7 @@
  */
 #include "minddata/dataset/core/global_context.h"
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 
@@ -25,6 +26,7 @@
 #include "minddata/dataset/core/tensor.h"
 #include "minddata/dataset/util/allocator.h"
 #include "minddata/dataset/util/circular_pool.h"
+#include "minddata/dataset/util/numa_pool.h"
 #include "minddata/dataset/util/system_pool.h"
 
 namespace mindspore {
@@ -36,6 +38,7 @@ std::once_flag GlobalContext::init_instance_flag_;
 constexpr int GlobalContext::kArenaSize;
 constexpr int GlobalContext::kMaxSize;
 constexpr bool GlobalContext::kInitArena;
+constexpr int GlobalContext::kNumaArenaSize;
 
 // Singleton initializer
 GlobalContext *GlobalContext::Instance() {
@@ -55,6 +58,13 @@ Status GlobalContext::Init() {
   config_manager_ = std::make_shared<ConfigManager>();
   mem_pool_ = std::make_shared<SystemPool>();
   // For testing we can use Dummy pool instead
+  // Workers bound to a numa node allocate from the pool of their node. The memory of a pool is only
+  // reserved on the first allocation, so nothing is wasted if the pipeline is not numa aware.
+  if (GetNumaNodeCount() > 1) {
+    for (auto numa_node : GetNumaNodes()) {
+      numa_pools_.push_back(std::make_shared<NumaPool>(numa_node, kNumaArenaSize));
+    }
+  }
 
   // Create some tensor allocators for the different types and hook them into the pool.
   tensor_allocator_ = std::make_unique<Allocator<Tensor>>(mem_pool_);
@@ -65,6 +75,19 @@ Status GlobalContext::Init() {
   return Status::OK();
 }
 
+std::shared_ptr<MemoryPool> GlobalContext::mem_pool() const {
+  int32_t numa_node = GetThreadNumaNode();
+  if (numa_node >= 0 && !numa_pools_.empty()) {
+    // The pools are in the order of GetNumaNodes(), which is sorted.
+    const auto &nodes = GetNumaNodes();
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), numa_node);
+    if (it != nodes.end() && *it == numa_node) {
+      return numa_pools_[it - nodes.begin()];
+    }
+  }
+  return mem_pool_;
+}
+
 // A print method typically used for debugging
 void GlobalContext::Print(std::ostream &out) const {
   out << "GlobalContext contains the following default config: " << *config_manager_ << "\n";
@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "minddata/dataset/core/constants.h"
 #include "minddata/dataset/util/allocator.h"
@@ -40,6 +41,7 @@ class GlobalContext {
   static constexpr int kArenaSize = 128;
   static constexpr int kMaxSize = -1;
   static constexpr bool kInitArena = true;
+  static constexpr int kNumaArenaSize = 1024;
 
  public:
   // Singleton pattern.  This method either:
@@ -71,8 +73,8 @@ class GlobalContext {
   static std::shared_ptr<ConfigManager> config_manager() { return Instance()->config_manager_; }
 
   // Getter method
-  // @return the mem pool
-  std::shared_ptr<MemoryPool> mem_pool() const { return mem_pool_; }
+  // @return the mem pool of the calling thread. A thread bound to a numa node gets the pool of that node.
+  std::shared_ptr<MemoryPool> mem_pool() const;
 
   // Getter method
   // @return the tensor allocator as raw pointer
@@ -97,6 +99,7 @@ class GlobalContext {
   static std::once_flag init_instance_flag_;
   static std::unique_ptr<GlobalContext> global_context_;  // The instance of the singleton (global)
   std::shared_ptr<MemoryPool> mem_pool_;                  // A global memory pool
+  std::vector<std::shared_ptr<MemoryPool>> numa_pools_;   // One pool per numa node
   std::shared_ptr<ConfigManager> config_manager_;         // The configs
   std::unique_ptr<TensorAlloc> tensor_allocator_;         // An allocator for Tensors
   std::unique_ptr<CVTensorAlloc> cv_tensor_allocator_;    // An allocator for CV Tensors
@@ -137,6 +137,26 @@ Status Tensor::CreateFromMemory(const TensorShape &shape, const DataType &type,
   return Status::OK();
 }
 
+Status Tensor::CreateFromMemory(const TensorShape &shape, const DataType &type, uchar *src, const dsize_t &length,
+                                const std::shared_ptr<MemoryPool> &pool, TensorPtr *out) {
+  CHECK_FAIL_RETURN_UNEXPECTED(src != nullptr, "Pointer to source data is null.");
+  RETURN_UNEXPECTED_IF_NULL(pool);
+  if (type.IsNumeric()) {
+    CHECK_FAIL_RETURN_UNEXPECTED(shape.NumOfElements() * type.SizeInBytes() == length,
+                                 "Length of source data does not match the shape.");
+  } else {
+    dsize_t min_length = (shape.NumOfElements() + 1) * kOffsetSize + shape.NumOfElements();
+    CHECK_FAIL_RETURN_UNEXPECTED(min_length <= length, "Length of source data does not match the shape.");
+  }
+  const TensorAlloc *alloc = GlobalContext::Instance()->tensor_allocator();
+  *out = std::allocate_shared<Tensor>(*alloc, shape, type);
+  // The buffer goes back to the given pool rather than the global one.
+  (*out)->data_allocator_ = std::make_unique<Allocator<unsigned char>>(pool);
+  (*out)->data_ = src;
+  (*out)->data_end_ = src + length;
+  return Status::OK();
+}
+
 #ifdef ENABLE_PYTHON
 Status Tensor::CreateFromNpString(py::array arr, std::shared_ptr<Tensor> *out) {
   std::vector<dsize_t> shape;
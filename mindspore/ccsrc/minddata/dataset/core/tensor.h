@@ -60,6 +60,7 @@ class DETensor;
 #endif
 namespace dataset {
 class Tensor;
+class MemoryPool;
 template <typename T>
 class Allocator;
 
@@ -115,6 +116,18 @@ class Tensor {
   static Status CreateFromMemory(const TensorShape &shape, const DataType &type, const uchar *src,
                                  const dsize_t &length, TensorPtr *out);
 
+  /// Create a tensor on top of a buffer handed out by a memory pool. Data is not copied. The buffer is given back to
+  /// the pool when the tensor is destroyed.
+  /// \param[in] shape shape of the output tensor
+  /// \param[in] type type of the output tensor
+  /// \param[in] src pointer to the buffer
+  /// \param[in] length length of the buffer
+  /// \param[in] pool memory pool owning the buffer
+  /// \param[out] out Generated tensor
+  /// \return Status code
+  static Status CreateFromMemory(const TensorShape &shape, const DataType &type, uchar *src, const dsize_t &length,
+                                 const std::shared_ptr<MemoryPool> &pool, TensorPtr *out);
+
   /// Create a copy of the input tensor
   /// \param[in] in original tensor to be copied
   /// \param[out] out output tensor to be generated
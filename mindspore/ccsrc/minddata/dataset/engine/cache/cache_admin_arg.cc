@@ -47,8 +47,12 @@ CacheAdminArgHandler::CacheAdminArgHandler()
       shm_mem_sz_(kDefaultSharedMemorySizeInGB),
       log_level_(kDefaultLogLevel),
       memory_cap_ratio_(kMemoryCapRatio),
+      pin_epochs_(kDefaultPinEpochs),
+      compress_(false),
+      persist_(false),
       hostname_(kCfgDefaultCacheHost),
       spill_dir_(DefaultSpillDir()),
+      evict_policy_(CacheEvictPolicyName(CacheEvictPolicy::kEvictNone)),
       command_id_(CommandId::kCmdUnknown) {
   // Initialize the command mappings
   arg_map_["-h"] = ArgValue::kArgHost;
@@ -73,6 +77,12 @@ CacheAdminArgHandler::CacheAdminArgHandler()
   arg_map_["-r"] = ArgValue::kArgMemoryCapRatio;
   arg_map_["--memory_cap_ratio"] = ArgValue::kArgMemoryCapRatio;
   arg_map_["--list_sessions"] = ArgValue::kArgListSessions;
+  arg_map_["-e"] = ArgValue::kArgEviction;
+  arg_map_["--eviction"] = ArgValue::kArgEviction;
+  arg_map_["--pin_epochs"] = ArgValue::kArgPinEpochs;
+  arg_map_["-c"] = ArgValue::kArgCompress;
+  arg_map_["--compress"] = ArgValue::kArgCompress;
+  arg_map_["--persist"] = ArgValue::kArgPersist;
   // Initialize argument tracker with false values
   for (int16_t i = 0; i < static_cast<int16_t>(ArgValue::kArgNumArgs); ++i) {
     ArgValue currAV = static_cast<ArgValue>(i);
@@ -280,6 +290,24 @@ Status CacheAdminArgHandler::ParseArgStream(std::stringstream *arg_stream) {
         RETURN_IF_NOT_OK(AssignArg(tok, static_cast<std::string *>(nullptr), arg_stream, CommandId::kCmdListSessions));
         break;
       }
+      case ArgValue::kArgEviction: {
+        RETURN_IF_NOT_OK(AssignArg(tok, &evict_policy_, arg_stream));
+        break;
+      }
+      case ArgValue::kArgPinEpochs: {
+        RETURN_IF_NOT_OK(AssignArg(tok, &pin_epochs_, arg_stream));
+        break;
+      }
+      case ArgValue::kArgCompress: {
+        RETURN_IF_NOT_OK(AssignArg(tok, static_cast<std::string *>(nullptr), arg_stream));
+        compress_ = true;
+        break;
+      }
+      case ArgValue::kArgPersist: {
+        RETURN_IF_NOT_OK(AssignArg(tok, static_cast<std::string *>(nullptr), arg_stream));
+        persist_ = true;
+        break;
+      }
       default: {
         // Save space delimited trailing arguments
         trailing_args_ += (" " + tok);
@@ -319,6 +347,10 @@ Status CacheAdminArgHandler::Validate() {
   if (memory_cap_ratio_ <= 0 || memory_cap_ratio_ > 1)
     return Status(StatusCode::kSyntaxError, "Memory cap ratio should be positive and no greater than 1");
   if (port_ < 1025 || port_ > 65535) return Status(StatusCode::kSyntaxError, "Port must be in range (1025..65535).");
+  CacheEvictPolicy policy;
+  if (!CacheEvictPolicyFromName(evict_policy_, &policy))
+    return Status(StatusCode::kSyntaxError, "Eviction policy must be one of none, lru and pin.");
+  if (pin_epochs_ < 1) return Status(StatusCode::kSyntaxError, "Number of epochs before pinning must be positive.");
 
   return Status::OK();
 }
@@ -392,8 +424,11 @@ Status CacheAdminArgHandler::RunCommand() {
       RETURN_IF_NOT_OK(rq->Wait());
       std::vector<SessionCacheInfo> session_info = rq->GetSessionCacheInfo();
       if (!session_info.empty()) {
+        auto na_if_zero = [](int64_t n) { return n == 0 ? std::string("n/a") : std::to_string(n); };
         std::cout << std::setw(12) << "Session" << std::setw(12) << "Cache Id" << std::setw(12) << "Mem cached"
                   << std::setw(12) << "Disk cached" << std::setw(16) << "Avg cache size" << std::setw(10) << "Numa hit"
+                  << std::setw(14) << "Mem bytes" << std::setw(14) << "Raw mem bytes" << std::setw(12) << "Hit"
+                  << std::setw(12) << "Miss" << std::setw(14) << "Hit bytes" << std::setw(12) << "Evicted"
                   << std::endl;
         for (auto curr_session : session_info) {
           std::string cache_id;
@@ -414,7 +449,12 @@ Status CacheAdminArgHandler::RunCommand() {
 
           std::cout << std::setw(12) << curr_session.session_id << std::setw(12) << cache_id << std::setw(12)
                     << stat_mem_cached << std::setw(12) << stat_disk_cached << std::setw(16) << stat_avg_cached
-                    << std::setw(10) << stat_numa_hit << std::endl;
+                    << std::setw(10) << stat_numa_hit << std::setw(14) << na_if_zero(curr_session.stats.mem_bytes)
+                    << std::setw(14) << na_if_zero(curr_session.stats.raw_mem_bytes) << std::setw(12)
+                    << na_if_zero(curr_session.stats.num_hit) << std::setw(12)
+                    << na_if_zero(curr_session.stats.num_miss) << std::setw(14)
+                    << na_if_zero(curr_session.stats.hit_bytes) << std::setw(12)
+                    << na_if_zero(curr_session.stats.num_evicted) << std::endl;
         }
       } else {
         std::cout << "No active sessions." << std::endl;
@@ -510,8 +550,11 @@ Status CacheAdminArgHandler::StartServer(CommandId command_id) {
     std::string minloglevel_string = std::to_string(log_level_);
     std::string daemonize_string = "true";
     std::string memory_cap_ratio_string = std::to_string(memory_cap_ratio_);
+    std::string pin_epochs_string = std::to_string(pin_epochs_);
+    std::string compress_string = compress_ ? "true" : "false";
+    std::string persist_string = persist_ ? "true" : "false";
 
-    char *argv[9];
+    char *argv[13];
     argv[0] = cache_server_binary.data();
     argv[1] = spill_dir_.data();
     argv[2] = workers_string.data();
@@ -520,7 +563,11 @@ Status CacheAdminArgHandler::StartServer(CommandId command_id) {
     argv[5] = minloglevel_string.data();
     argv[6] = daemonize_string.data();
     argv[7] = memory_cap_ratio_string.data();
-    argv[8] = nullptr;
+    argv[8] = evict_policy_.data();
+    argv[9] = pin_epochs_string.data();
+    argv[10] = compress_string.data();
+    argv[11] = persist_string.data();
+    argv[12] = nullptr;
 
     // Now exec the binary
     execv(cache_server_binary.data(), argv);
@@ -540,6 +587,10 @@ void CacheAdminArgHandler::Help() {
   std::cerr << "                [[-w | --workers] <number of workers>]    Default is " << kDefaultNumWorkers << ".\n";
   std::cerr << "                [[-s | --spilldir] <spilling directory>]  Default is " << DefaultSpillDir() << ".\n";
   std::cerr << "                [[-l | --loglevel] <log level>]           Default is 1 (warning level).\n";
+  std::cerr << "                [[-e | --eviction] <none | lru | pin>]    Default is none.\n";
+  std::cerr << "                [--pin_epochs <number of epochs>]         Default is " << kDefaultPinEpochs << ".\n";
+  std::cerr << "                [-c | --compress]                         Default is off.\n";
+  std::cerr << "                [--persist]                               Default is off.\n";
   std::cerr << "            [--destroy_session  | -d] <session id>\n";
   std::cerr << "                [[-p | --port] <port number>]\n";
   std::cerr << "            [--generate_session | -g]\n";
@@ -74,7 +74,11 @@ class CacheAdminArgHandler {
     kArgLogLevel = 11,
     kArgMemoryCapRatio = 12,
     kArgListSessions = 13,
-    kArgNumArgs = 14  // Must be the last position to provide a count
+    kArgEviction = 14,
+    kArgPinEpochs = 15,
+    kArgCompress = 16,
+    kArgPersist = 17,
+    kArgNumArgs = 18  // Must be the last position to provide a count
   };
 
   Status StartServer(CommandId command_id);
@@ -96,9 +100,13 @@ class CacheAdminArgHandler {
   int32_t shm_mem_sz_;
   int32_t log_level_;
   float memory_cap_ratio_;
+  int32_t pin_epochs_;
+  bool compress_;
+  bool persist_;
   session_id_type session_id_;
   std::string hostname_;
   std::string spill_dir_;
+  std::string evict_policy_;
   std::string trailing_args_;
   std::map<std::string, ArgValue> arg_map_;
   std::map<ArgValue, bool> used_args_;
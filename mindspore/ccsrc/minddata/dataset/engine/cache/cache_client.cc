@@ -175,18 +175,8 @@ Status CacheClient::GetRows(const std::vector<row_id_type> &row_id, TensorTable
   auto rq = std::make_shared<BatchFetchRequest>(this, row_id);
   RETURN_IF_NOT_OK(PushRequest(rq));
   RETURN_IF_NOT_OK(rq->Wait());
-  int64_t mem_addr;
-  Status rc = rq->RestoreRows(out, comm_->SharedMemoryBaseAddr(), &mem_addr);
-  // Free the memory by sending a request back to the server.
-  if (mem_addr != -1) {
-    auto mfree_req = std::make_shared<FreeSharedBlockRequest>(server_connection_id_, client_id_, mem_addr);
-    Status rc2 = PushRequest(mfree_req);
-    // But we won't wait for the result for the sake of performance.
-    if (rc.IsOk() && rc2.IsError()) {
-      rc = rc2;
-    }
-  }
-  return rc;
+  // Rows in shared memory are not copied. The memory is freed once the rows are no longer used.
+  return rq->RestoreRows(out, comm_->SharedMemoryBaseAddr());
 }
 
 Status CacheClient::CreateCache(uint32_t tree_crc, bool generate_id) {
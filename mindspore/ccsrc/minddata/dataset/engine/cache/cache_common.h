@@ -48,6 +48,12 @@ constexpr static uint32_t kLocalClientSupport = 1;
 constexpr static uint32_t kDataIsInSharedMemory = 2;
 /// \brief Size of each message used in message queue.
 constexpr static int32_t kSharedMessageSize = 2048;
+/// \brief Number of request slots in the shared memory queue used by local clients
+constexpr static int32_t kNumSharedQueueSlots = 256;
+/// \brief Size of the buffer of each slot. Requests that don't fit are sent using gRPC.
+constexpr static int32_t kSharedQueueSlotSize = 64 * 1024;
+/// \brief Seconds between two checkpoints of the caches when persistence is on
+constexpr static int32_t kCheckpointInterval = 60;
 /// \brief Prefix for default cache spilling path and log path
 const char kDefaultPathPrefix[] = "/tmp/mindspore/cache";
 
@@ -86,6 +92,38 @@ inline int64_t round_up_4K(int64_t sz) {
 /// Memory policy
 enum CachePoolPolicy : int8_t { kOnNode, kPreferred, kLocal, kInterleave, kNone };
 
+/// \brief What the server does with the rows in memory once the memory of a cache is full.
+/// kEvictNone keeps them and sends the new rows to disk (if spilling is enabled).
+/// kEvictLru moves the least recently used rows out of memory to make room for the new rows.
+/// kEvictPinHotSet behaves like kEvictLru for the first few epochs and then pins what is left in memory.
+enum class CacheEvictPolicy : int8_t { kEvictNone = 0, kEvictLru = 1, kEvictPinHotSet = 2 };
+/// \brief Default number of epochs kEvictPinHotSet watches before it pins the hot set
+constexpr static int32_t kDefaultPinEpochs = 1;
+
+/// \brief Names of the eviction policies as given to cache_admin
+inline std::string CacheEvictPolicyName(CacheEvictPolicy policy) {
+  switch (policy) {
+    case CacheEvictPolicy::kEvictLru:
+      return "lru";
+    case CacheEvictPolicy::kEvictPinHotSet:
+      return "pin";
+    default:
+      return "none";
+  }
+}
+
+/// \brief Look up an eviction policy by its name
+/// \return False if the name is unknown
+inline bool CacheEvictPolicyFromName(const std::string &name, CacheEvictPolicy *policy) {
+  for (auto p : {CacheEvictPolicy::kEvictNone, CacheEvictPolicy::kEvictLru, CacheEvictPolicy::kEvictPinHotSet}) {
+    if (CacheEvictPolicyName(p) == name) {
+      *policy = p;
+      return true;
+    }
+  }
+  return false;
+}
+
 /// Misc typedef
 using worker_id_t = int32_t;
 using numa_id_t = int32_t;
@@ -102,7 +102,8 @@ Status SerializeTensorRowHeader(const TensorRow &row, std::shared_ptr<flatbuffer
   }
 }
 
-Status RestoreOneTensor(const TensorMetaMsg *col_ts, const ReadableSlice &data, std::shared_ptr<Tensor> *out) {
+Status RestoreOneTensor(const TensorMetaMsg *col_ts, const ReadableSlice &data, std::shared_ptr<Tensor> *out,
+                        const std::shared_ptr<MemoryPool> &pool) {
   RETURN_UNEXPECTED_IF_NULL(col_ts);
   auto shape_in = col_ts->dims();
   auto type_in = col_ts->type();
@@ -135,8 +136,16 @@ Status RestoreOneTensor(const TensorMetaMsg *col_ts, const ReadableSlice &data,
 
   DataType type(dest);
   std::shared_ptr<Tensor> ts;
-  RETURN_IF_NOT_OK(
-    Tensor::CreateFromMemory(shape, type, static_cast<const unsigned char *>(data.GetPointer()), data.GetSize(), &ts));
+  auto *src = static_cast<const unsigned char *>(data.GetPointer());
+  // 8 byte alignment is good enough for all the data types including the offsets of string tensors.
+  constexpr uintptr_t kAlignment = sizeof(int64_t);
+  if (pool != nullptr && reinterpret_cast<uintptr_t>(src) % kAlignment == 0) {
+    // The data belongs to the pool, and the tensor will give it back to the pool when it is destroyed.
+    RETURN_IF_NOT_OK(
+      Tensor::CreateFromMemory(shape, type, const_cast<unsigned char *>(src), data.GetSize(), pool, &ts));
+  } else {
+    RETURN_IF_NOT_OK(Tensor::CreateFromMemory(shape, type, src, data.GetSize(), &ts));
+  }
   // Next we restore the real data which can be embedded or stored separately.
   if (ts->SizeInBytes() != data.GetSize()) {
     MS_LOG(ERROR) << "Unexpected length. Read " << data.GetSize() << ". Expected " << ts->SizeInBytes() << ".\n"
@@ -15,12 +15,13 @@
 */
 #include "minddata/dataset/engine/cache/cache_grpc_client.h"
 #include <chrono>
+#include <vector>
 namespace mindspore {
 namespace dataset {
 CacheClientGreeter::~CacheClientGreeter() { (void)ServiceStop(); }
 
 CacheClientGreeter::CacheClientGreeter(const std::string &hostname, int32_t port, int32_t num_connections)
-    : num_connections_(num_connections), request_cnt_(0), hostname_(std::move(hostname)), port_(port) {
+    : num_connections_(num_connections), request_cnt_(0), cq_closed_(false), hostname_(std::move(hostname)), port_(port) {
   grpc::ChannelArguments args;
   // We need to bump up the message size to unlimited. The default receiving
   // message limit is 4MB which is not big enough.
@@ -51,6 +52,14 @@ Status CacheClientGreeter::AttachToSharedMemory(bool *local_bypass) {
   mem_.SetPublicKey(shm_key);
   RETURN_IF_NOT_OK(mem_.Attach());
   *local_bypass = true;
+  // From now on requests go through the shared request queue. If we can't attach to it, we stay on gRPC.
+  Status rc = SharedRequestQueue::AttachQueue(port_, &local_q_);
+  if (rc.IsOk()) {
+    RETURN_IF_NOT_OK(vg_.CreateAsyncTask("Local reply", std::bind(&CacheClientGreeter::LocalReplyEntry, this)));
+  } else {
+    MS_LOG(INFO) << "Unable to attach to the shared request queue. " << rc.ToString();
+    local_q_.reset();
+  }
 #endif
   return Status::OK();
 }
@@ -58,14 +67,20 @@ Status CacheClientGreeter::AttachToSharedMemory(bool *local_bypass) {
 Status CacheClientGreeter::DoServiceStart() {
   RETURN_IF_NOT_OK(vg_.ServiceStart());
   RETURN_IF_NOT_OK(DispatchWorkers(num_connections_));
+  RETURN_IF_NOT_OK(vg_.CreateAsyncTask("Free shared block", std::bind(&CacheClientGreeter::FreeBlockEntry, this)));
   return Status::OK();
 }
 
 Status CacheClientGreeter::DoServiceStop() {
+  // Give back the blocks queued so far while we can still send requests through gRPC.
+  RETURN_IF_NOT_OK(FlushFreeBlocks());
   // Shutdown the queue. We don't accept any more new incomers.
+  cq_closed_ = true;
   cq_.Shutdown();
   // Shutdown the TaskGroup.
   vg_.interrupt_all();
+  local_cv_.notify_all();
+  free_cv_.notify_all();
   vg_.join_all(Task::WaitFlag::kNonBlocking);
   // Drain the queue. We know how many requests we send out
   while (!req_.empty()) {
@@ -76,12 +91,42 @@ Status CacheClientGreeter::DoServiceStop() {
       req_.erase(r->seqNo_);
     }
   }
-  return Status::OK();
+  // Give up on the requests still in the shared request queue.
+  if (local_q_ == nullptr) {
+    return Status::OK();
+  }
+  std::unique_lock<std::mutex> lck(local_mux_);
+  for (auto &it : local_req_) {
+    auto slot_id = it.first;
+    auto *rq = it.second.base_rq_.get();
+    if (local_q_->Abandon(slot_id)) {
+      Status2CacheReply(Status(StatusCode::kInterrupted), &rq->reply_);
+      rq->wp_.Set();
+    } else {
+      Status rc = ReceiveLocalReply(slot_id, rq);
+      if (rc.IsError()) {
+        MS_LOG(WARNING) << rc.ToString();
+      }
+    }
+  }
+  local_req_.clear();
+  lck.unlock();
+  // The replies we just read may have left some blocks to give back.
+  return FlushFreeBlocks();
 }
 
 Status CacheClientGreeter::HandleRequest(std::shared_ptr<BaseRequest> rq) {
   // If there is anything extra we need to do before we send.
   RETURN_IF_NOT_OK(rq->Prepare());
+  if (local_q_ != nullptr) {
+    bool sent = false;
+    RETURN_IF_NOT_OK(SendLocalRequest(rq, &sent));
+    if (sent) {
+      return Status::OK();
+    }
+  }
+  // The completion queue is shut down once the service is stopped.
+  CHECK_FAIL_RETURN_UNEXPECTED(!cq_closed_, "Cache client is not running");
   auto seqNo = request_cnt_.fetch_add(1);
   auto tag = std::make_unique<CacheClientRequestTag>(std::move(rq), seqNo);
   // One minute timeout
@@ -148,6 +193,152 @@ Status CacheClientGreeter::WorkerEntry() {
   return Status::OK();
 }
 
+Status CacheClientGreeter::SendLocalRequest(const std::shared_ptr<BaseRequest> &rq, bool *sent) {
+  *sent = false;
+  int64_t sz = rq->rq_.ByteSizeLong();
+  if (sz > kSharedQueueSlotSize) {
+    return Status::OK();
+  }
+  auto slot_id = local_q_->ClaimSlot();
+  if (slot_id == -1) {
+    return Status::OK();
+  }
+  auto *slot = local_q_->GetSlot(slot_id);
+  // We don't wait for the reply of kFreeSharedBlock which is the same as what we do with gRPC.
+  bool no_reply = rq->type_ == BaseRequest::RequestType::kFreeSharedBlock;
+  slot->flag = no_reply ? SharedRequestQueue::kNoReply : 0;
+  slot->reply_addr = -1;
+  if (!rq->rq_.SerializeToArray(slot->buf, sz)) {
+    local_q_->SetState(slot_id, SharedRequestQueue::SlotState::kFree);
+    RETURN_STATUS_UNEXPECTED("Unable to serialize the request");
+  }
+  slot->sz = sz;
+  if (no_reply) {
+    local_q_->SetState(slot_id, SharedRequestQueue::SlotState::kRequest);
+    rq->wp_.Set();
+  } else {
+    // Same one minute timeout as gRPC. Register the request before the server can see it.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    std::unique_lock<std::mutex> lck(local_mux_);
+    local_req_.emplace(slot_id, LocalRequestTag{rq, deadline});
+    local_q_->SetState(slot_id, SharedRequestQueue::SlotState::kRequest);
+    local_cv_.notify_one();
+  }
+  local_q_->RingRequestBell();
+  *sent = true;
+  return Status::OK();
+}
+
+Status CacheClientGreeter::ReceiveLocalReply(int32_t slot_id, BaseRequest *rq) {
+  auto *slot = local_q_->GetSlot(slot_id);
+  auto addr = slot->reply_addr;
+  const char *buf = slot->buf;
+  if (addr != -1) {
+    buf = static_cast<const char *>(SharedMemoryBaseAddr()) + addr;
+  }
+  bool success = rq->reply_.ParseFromArray(buf, slot->sz);
+  local_q_->SetState(slot_id, SharedRequestQueue::SlotState::kFree);
+  if (!success) {
+    Status2CacheReply(Status(StatusCode::kUnexpectedError, __LINE__, __FILE__, "Unable to parse the reply"),
+                      &rq->reply_);
+  }
+  if (addr != -1) {
+    // The reply was too big for the slot. Give the memory back to the server.
+    FreeSharedBlock(rq->rq_.connection_id(), rq->rq_.client_id(), addr);
+  }
+  rq->wp_.Set();
+  return Status::OK();
+}
+
+void CacheClientGreeter::FreeSharedBlock(connection_id_type connection_id, int32_t client_id, int64_t addr) {
+  std::unique_lock<std::mutex> lck(free_mux_);
+  if (ServiceState() == STATE::kStopped) {
+    MS_LOG(WARNING) << "Cache client is not running. Unable to free shared memory block at " << addr;
+    return;
+  }
+  free_blocks_.push_back(FreeBlock{connection_id, client_id, addr});
+  free_cv_.notify_one();
+}
+
+Status CacheClientGreeter::FlushFreeBlocks() {
+  std::deque<FreeBlock> blocks;
+  {
+    std::unique_lock<std::mutex> lck(free_mux_);
+    blocks.swap(free_blocks_);
+  }
+  for (auto &blk : blocks) {
+    // We won't wait for the result for the sake of performance.
+    auto mfree_req = std::make_shared<FreeSharedBlockRequest>(blk.connection_id_, blk.client_id_, blk.addr_);
+    Status rc = HandleRequest(mfree_req);
+    if (rc.IsError()) {
+      MS_LOG(WARNING) << "Unable to free shared memory block at " << blk.addr_ << ". " << rc.ToString();
+    }
+  }
+  return Status::OK();
+}
+
+Status CacheClientGreeter::FreeBlockEntry() {
+  TaskManager::FindMe()->Post();
+  do {
+    {
+      std::unique_lock<std::mutex> lck(free_mux_);
+      // Wake up once in a while to check for interrupt.
+      (void)free_cv_.wait_for(lck, std::chrono::seconds(1),
+                              [this] { return !free_blocks_.empty() || this_thread::is_interrupted(); });
+    }
+    RETURN_IF_INTERRUPTED();
+    RETURN_IF_NOT_OK(FlushFreeBlocks());
+  } while (true);
+  return Status::OK();
+}
+
+Status CacheClientGreeter::LocalReplyEntry() {
+  TaskManager::FindMe()->Post();
+  int32_t num_idle = 0;
+  do {
+    std::vector<std::pair<int32_t, std::shared_ptr<BaseRequest>>> ready;
+    bool in_flight = false;
+    // Take the snapshot before we look, so that a reply posted while we look doesn't get missed.
+    auto bell = local_q_->ReplyBell();
+    {
+      std::unique_lock<std::mutex> lck(local_mux_);
+      // Nothing to poll for until a request is sent. Wake up once in a while to check for interrupt.
+      (void)local_cv_.wait_for(lck, std::chrono::seconds(1),
+                               [this] { return !local_req_.empty() || this_thread::is_interrupted(); });
+      auto now = std::chrono::steady_clock::now();
+      for (auto it = local_req_.begin(); it != local_req_.end();) {
+        auto slot_id = it->first;
+        if (local_q_->GetState(slot_id) == SharedRequestQueue::SlotState::kReply) {
+          ready.emplace_back(slot_id, std::move(it->second.base_rq_));
+          it = local_req_.erase(it);
+        } else if (now > it->second.deadline_ && local_q_->Abandon(slot_id)) {
+          std::string err_msg = "Cache server with port " + std::to_string(port_) +
+                                " is not responding. Make sure the server is running.";
+          auto *rq = it->second.base_rq_.get();
+          Status2CacheReply(Status(StatusCode::kNetWorkError, __LINE__, __FILE__, err_msg), &rq->reply_);
+          rq->wp_.Set();
+          it = local_req_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      in_flight = !local_req_.empty();
+    }
+    for (auto &r : ready) {
+      RETURN_IF_NOT_OK(ReceiveLocalReply(r.first, r.second.get()));
+    }
+    if (ready.empty()) {
+      RETURN_IF_INTERRUPTED();
+      if (in_flight) {
+        local_q_->WaitForReply(bell, ++num_idle);
+      }
+    } else {
+      num_idle = 0;
+    }
+  } while (true);
+  return Status::OK();
+}
+
 Status CacheClientGreeter::DispatchWorkers(int32_t num_workers) {
   auto f = std::bind(&CacheClientGreeter::WorkerEntry, this);
   for (auto i = 0; i < num_workers; ++i) {
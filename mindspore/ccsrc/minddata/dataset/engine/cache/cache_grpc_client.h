@@ -17,6 +17,9 @@
 #define MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_CACHE_GRPC_CLIENT_H_
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -86,16 +89,72 @@ class CacheClientGreeter : public Service {
   /// \return Base address of the shared memory.
   const void *SharedMemoryBaseAddr() const { return mem_.SharedMemoryBaseAddr(); }
 
+  /// \brief A thread polling the shared request queue for the replies of the requests sent by SendLocalRequest
+  /// \return Status object
+  Status LocalReplyEntry();
+
+  /// \brief Give a block of the shared memory back to the server. It can be called from any thread, e.g. the one
+  /// destroying the last tensor using the block, so the request is only queued and sent by FreeBlockEntry.
+  /// \param connection_id Connection id of the cache
+  /// \param client_id Client id which the block is allocated for
+  /// \param addr Offset of the block in the shared memory
+  void FreeSharedBlock(connection_id_type connection_id, int32_t client_id, int64_t addr);
+
+  /// \brief A thread sending the requests queued by FreeSharedBlock
+  /// \return Status object
+  Status FreeBlockEntry();
+
+  /// \brief Number of blocks queued by FreeSharedBlock but not yet sent to the server
+  size_t NumPendingFreeBlocks() const {
+    std::unique_lock<std::mutex> lck(free_mux_);
+    return free_blocks_.size();
+  }
+
  private:
+  /// \brief A client view of a request sent through the shared request queue
+  struct LocalRequestTag {
+    std::shared_ptr<BaseRequest> base_rq_;
+    std::chrono::steady_clock::time_point deadline_;
+  };
+
+  /// \brief A block of shared memory to be given back to the server
+  struct FreeBlock {
+    connection_id_type connection_id_;
+    int32_t client_id_;
+    int64_t addr_;
+  };
+
+  /// \brief Send all the requests queued by FreeSharedBlock
+  /// \return Status object
+  Status FlushFreeBlocks();
+
+  /// \brief Send the request through the shared request queue rather than gRPC
+  /// \param[in] rq The request
+  /// \param[out] sent False if the request doesn't fit into a slot or all the slots are busy
+  /// \return Status object
+  Status SendLocalRequest(const std::shared_ptr<BaseRequest> &rq, bool *sent);
+
+  /// \brief Read the reply from the slot, release the slot and notify the waiting thread
+  /// \return Status object
+  Status ReceiveLocalReply(int32_t slot_id, BaseRequest *rq);
+
   std::shared_ptr<grpc::Channel> channel_;
   std::unique_ptr<CacheServerGreeter::Stub> stub_;
   grpc::CompletionQueue cq_;
   TaskGroup vg_;
   int32_t num_connections_;
   std::atomic<int64_t> request_cnt_;
+  std::atomic<bool> cq_closed_;
   mutable std::mutex mux_;
   std::map<int64_t, std::unique_ptr<CacheClientRequestTag>> req_;
   SharedMemory mem_;
+  std::unique_ptr<SharedRequestQueue> local_q_;
+  std::mutex local_mux_;
+  std::map<int32_t, LocalRequestTag> local_req_;  // In flight requests sent to the queue. Key is the slot id.
+  std::condition_variable local_cv_;               // Signaled when local_req_ becomes non-empty.
+  mutable std::mutex free_mux_;
+  std::condition_variable free_cv_;
+  std::deque<FreeBlock> free_blocks_;
   int32_t port_;
   std::string hostname_;
 };
@@ -43,6 +43,7 @@ class CacheServerRequest : public BaseRequest {
       : BaseRequest::BaseRequest(BaseRequest::RequestType::kRequestUnknown),
         qid_(queue_id),
         st_(STATE::CREATE),
+        slot_(-1),
         responder_(&ctx_) {}
 
   ~CacheServerRequest() override = default;
@@ -62,10 +63,14 @@ class CacheServerRequest : public BaseRequest {
   /// \return The queue where the request should go to
   int32_t getQid() const { return qid_; }
 
+  /// \brief Check if the request comes from the shared request queue rather than gRPC
+  bool IsLocal() const { return slot_ != -1; }
+
  private:
   int32_t qid_;
   Status rc_;
   STATE st_;
+  int32_t slot_;  // Slot of the shared request queue if the request doesn't come from gRPC
   grpc::ServerContext ctx_;
   grpc::ServerAsyncResponseWriter<CacheReply> responder_;
 };
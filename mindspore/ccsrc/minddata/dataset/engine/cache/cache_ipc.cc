@@ -15,14 +15,36 @@
 */
 #include "minddata/dataset/engine/cache/cache_ipc.h"
 #include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <chrono>
+#include <climits>
+#include <ctime>
+#include <new>
+#include <thread>
 
 namespace mindspore {
 namespace dataset {
-Status PortToFtok(int port, SharedMemory::shm_key_t *out) {
+namespace {
+// ftok project id of the shared request queue. The shared memory arena uses the default 'a'.
+constexpr int kRequestQueueProjId = 'q';
+// Slots start on a cache line boundary.
+constexpr int64_t kSlotAlignment = 64;
+int64_t QueueHeaderSize(int64_t sz) { return (sz + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment; }
+// Number of times an idle poller polls again right away before it sleeps on the doorbell.
+constexpr int32_t kSpinCount = 64;
+// Sleepers wake up this often even if the doorbell doesn't ring, to check for interrupts and deadlines.
+constexpr int64_t kDoorbellTimeoutMs = 100;
+}  // namespace
+
+Status PortToFtok(int port, SharedMemory::shm_key_t *out, int proj_id) {
   RETURN_UNEXPECTED_IF_NULL(out);
   key_t shmkey = -1;
   const std::string unix_path = PortToUnixSocketPath(port);
-  shmkey = ftok(unix_path.data(), 'a');
+  shmkey = ftok(unix_path.data(), proj_id);
   if (shmkey == (key_t)-1) {
     std::string errMsg = "Unable to create a ftok token. Errno = " + std::to_string(errno);
     return Status(errno == ENOENT ? StatusCode::kFileNotExist : StatusCode::kUnexpectedError, errMsg);
@@ -159,5 +181,107 @@ Status SharedMemory::GetNumAttached(int32_t *num) {
   *num = ds.shm_nattch;
   return Status::OK();
 }
+
+Status SharedRequestQueue::GetQueueKey(int32_t port, SharedMemory::shm_key_t *out) {
+  return PortToFtok(port, out, kRequestQueueProjId);
+}
+
+void SharedRequestQueue::Setup() {
+  auto *base = static_cast<char *>(mem_.SharedMemoryBaseAddr());
+  hdr_ = reinterpret_cast<Header *>(base);
+  slots_ = reinterpret_cast<Slot *>(base + QueueHeaderSize(sizeof(Header)));
+  num_slots_ = hdr_->num_slots;
+}
+
+Status SharedRequestQueue::CreateQueue(int32_t port, std::unique_ptr<SharedRequestQueue> *out) {
+  RETURN_UNEXPECTED_IF_NULL(out);
+  static_assert(std::atomic<int32_t>::is_always_lock_free, "Slot state must be lock free to be shared");
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Doorbell must be usable as a futex");
+  std::unique_ptr<SharedRequestQueue> q(new SharedRequestQueue());
+  SharedMemory::shm_key_t shm_key;
+  RETURN_IF_NOT_OK(GetQueueKey(port, &shm_key));
+  q->mem_.SetPublicKey(shm_key);
+  // The server removes the queue when it exits.
+  q->mem_.RemoveResourcesOnExit();
+  int64_t sz = QueueHeaderSize(sizeof(Header)) + kNumSharedQueueSlots * sizeof(Slot);
+  RETURN_IF_NOT_OK(q->mem_.Create(sz));
+  auto *hdr = new (q->mem_.SharedMemoryBaseAddr()) Header();
+  hdr->num_slots = kNumSharedQueueSlots;
+  hdr->next_slot.store(0);
+  hdr->request_bell.seq.store(0);
+  hdr->request_bell.num_waiters.store(0);
+  hdr->reply_bell.seq.store(0);
+  hdr->reply_bell.num_waiters.store(0);
+  q->Setup();
+  for (auto i = 0; i < q->num_slots_; ++i) {
+    auto *slot = new (q->GetSlot(i)) Slot();
+    slot->state.store(static_cast<int32_t>(SlotState::kFree));
+    slot->reply_addr = -1;
+  }
+  // Set the magic last. Clients check it before they use the queue.
+  std::atomic_thread_fence(std::memory_order_release);
+  hdr->magic = kQueueMagic;
+  MS_LOG(INFO) << "Creation of shared request queue successful. Shared memory key " << shm_key;
+  *out = std::move(q);
+  return Status::OK();
+}
+
+Status SharedRequestQueue::AttachQueue(int32_t port, std::unique_ptr<SharedRequestQueue> *out) {
+  RETURN_UNEXPECTED_IF_NULL(out);
+  std::unique_ptr<SharedRequestQueue> q(new SharedRequestQueue());
+  SharedMemory::shm_key_t shm_key;
+  RETURN_IF_NOT_OK(GetQueueKey(port, &shm_key));
+  q->mem_.SetPublicKey(shm_key);
+  RETURN_IF_NOT_OK(q->mem_.Attach());
+  auto *hdr = static_cast<Header *>(q->mem_.SharedMemoryBaseAddr());
+  CHECK_FAIL_RETURN_UNEXPECTED(hdr->magic == kQueueMagic, "Shared request queue is not initialized");
+  std::atomic_thread_fence(std::memory_order_acquire);
+  q->Setup();
+  *out = std::move(q);
+  return Status::OK();
+}
+
+int32_t SharedRequestQueue::ClaimSlot() {
+  // Start from where the last client stopped so that the slots are used (and polled by the server)
+  // in a round robin fashion.
+  auto start = hdr_->next_slot.fetch_add(1, std::memory_order_relaxed);
+  for (auto i = 0; i < num_slots_; ++i) {
+    int32_t slot_id = (start + i) % num_slots_;
+    if (GetState(slot_id) == SlotState::kFree && Transit(slot_id, SlotState::kFree, SlotState::kClaimed)) {
+      return slot_id;
+    }
+  }
+  return -1;
+}
+
+void SharedRequestQueue::Ring(Doorbell *bell) {
+  bell->seq.fetch_add(1);
+  // A process which dies while it sleeps leaves num_waiters behind. That only costs us a system call.
+  if (bell->num_waiters.load() > 0) {
+#ifdef __linux__
+    (void)syscall(SYS_futex, reinterpret_cast<uint32_t *>(&bell->seq), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+  }
+}
+
+void SharedRequestQueue::Wait(Doorbell *bell, uint32_t seen, int32_t num_idle) {
+  if (num_idle < kSpinCount) {
+    return;
+  }
+  // Register first and then check, so that a ring in between either changes seq before the futex call (which then
+  // returns right away) or sees us waiting and wakes us up.
+  bell->num_waiters.fetch_add(1);
+  if (bell->seq.load() == seen) {
+#ifdef __linux__
+    struct timespec timeout {
+      0, kDoorbellTimeoutMs * 1000000
+    };
+    (void)syscall(SYS_futex, reinterpret_cast<uint32_t *>(&bell->seq), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+  }
+  bell->num_waiters.fetch_sub(1);
+}
 }  // namespace dataset
 }  // namespace mindspore
@@ -20,6 +20,8 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/msg.h>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <utility>
 #include "minddata/dataset/engine/cache/cache_common.h"
@@ -202,8 +204,135 @@ class SharedMemory : public BaseIPC {
 /// \note Caller must check the return value. -1 means ftok failed.
 /// \param[in] port
 /// \param[out] err. If not null and ftok fails, this will contain the value of errno
+/// \param[in] proj_id. Different ids give different keys for the same port
 /// \return key
-Status PortToFtok(int port, SharedMemory::shm_key_t *);
+Status PortToFtok(int port, SharedMemory::shm_key_t *, int proj_id = 'a');
+
+/// \brief A fixed number of request slots in shared memory used by the clients on the same machine to talk to the
+/// cache server without going through gRPC. A client claims a free slot, writes the serialized request into it and
+/// flips the state of the slot. The server polls the slots, processes the request and writes the reply back into the
+/// same slot. All state changes are atomic operations on the slot, so no lock is held across processes.
+/// Idle pollers sleep on a doorbell in the shared memory (a futex) which is rung whenever a request or a reply is
+/// posted, so nobody spins while there is nothing to do.
+class SharedRequestQueue {
+ public:
+  enum class SlotState : int32_t {
+    kFree = 0,        // Slot can be claimed by any client
+    kClaimed = 1,     // A client is writing a request into the slot
+    kRequest = 2,     // Request is ready to be picked up by the server
+    kProcessing = 3,  // Server is working on the request
+    kReply = 4,       // Reply is ready to be picked up by the client
+    kAbandoned = 5    // Client no longer waits for the reply. Server frees the slot when it is done.
+  };
+  /// \brief A flag in the slot telling the server the client doesn't wait for the reply
+  constexpr static uint32_t kNoReply = 1;
+
+  struct Slot {
+    std::atomic<int32_t> state;
+    uint32_t flag;
+    // Size of the serialized request or reply
+    int64_t sz;
+    // If the reply is too big for the slot, this is where the server puts it relative to the
+    // base address of the shared memory arena. -1 otherwise.
+    int64_t reply_addr;
+    char buf[kSharedQueueSlotSize];
+  };
+
+  ~SharedRequestQueue() = default;
+
+  /// \brief Create the queue. Only the cache server does this and it removes the queue on exit.
+  /// \param[in] port Port of the cache server
+  /// \param[out] out The queue
+  /// \return Status object
+  static Status CreateQueue(int32_t port, std::unique_ptr<SharedRequestQueue> *out);
+
+  /// \brief Attach to the queue created by the cache server
+  /// \param[in] port Port of the cache server
+  /// \param[out] out The queue
+  /// \return Status object
+  static Status AttachQueue(int32_t port, std::unique_ptr<SharedRequestQueue> *out);
+
+  /// \brief Find the shared memory key of the queue
+  static Status GetQueueKey(int32_t port, SharedMemory::shm_key_t *out);
+
+  int32_t NumSlots() const { return num_slots_; }
+
+  Slot *GetSlot(int32_t slot_id) { return &slots_[slot_id]; }
+
+  /// \brief Claim a free slot. The slot is in kClaimed state on return.
+  /// \return Slot id. -1 if all the slots are busy.
+  int32_t ClaimSlot();
+
+  SlotState GetState(int32_t slot_id) const {
+    return static_cast<SlotState>(slots_[slot_id].state.load(std::memory_order_acquire));
+  }
+
+  void SetState(int32_t slot_id, SlotState to) {
+    slots_[slot_id].state.store(static_cast<int32_t>(to), std::memory_order_release);
+  }
+
+  /// \brief Change the state of a slot only if it is in a given state
+  /// \return True if the state is changed
+  bool Transit(int32_t slot_id, SlotState from, SlotState to) {
+    auto expected = static_cast<int32_t>(from);
+    return slots_[slot_id].state.compare_exchange_strong(expected, static_cast<int32_t>(to),
+                                                         std::memory_order_acq_rel);
+  }
+
+  /// \brief Called by the client to give up waiting on a request.
+  /// \return False if the reply has already come back. The client then owns the reply and frees the slot itself.
+  bool Abandon(int32_t slot_id) {
+    return Transit(slot_id, SlotState::kRequest, SlotState::kFree) ||
+           Transit(slot_id, SlotState::kProcessing, SlotState::kAbandoned);
+  }
+
+  /// \brief Called by the client once a request is in kRequest state
+  void RingRequestBell() { Ring(&hdr_->request_bell); }
+
+  /// \brief Called by the server once a reply is in kReply state
+  void RingReplyBell() { Ring(&hdr_->reply_bell); }
+
+  /// \brief Take a snapshot of the request doorbell. The server takes it before looking for requests, so that
+  /// a request posted while it looks wakes it up from WaitForRequest.
+  uint32_t RequestBell() const { return hdr_->request_bell.seq.load(); }
+
+  /// \brief Take a snapshot of the reply doorbell. Same as RequestBell but for the client.
+  uint32_t ReplyBell() const { return hdr_->reply_bell.seq.load(); }
+
+  /// \brief Polling threads of the server call this when they find nothing to do. Requests usually come in
+  /// bursts, so we poll again right away a few times before we sleep until the doorbell rings.
+  /// \param seen Snapshot taken by RequestBell before polling
+  /// \param num_idle Number of consecutive times nothing is found
+  void WaitForRequest(uint32_t seen, int32_t num_idle) { Wait(&hdr_->request_bell, seen, num_idle); }
+
+  /// \brief Same as WaitForRequest but for a client waiting for its replies
+  void WaitForReply(uint32_t seen, int32_t num_idle) { Wait(&hdr_->reply_bell, seen, num_idle); }
+
+ private:
+  /// \brief A counter which threads of any process can sleep on until it changes
+  struct Doorbell {
+    std::atomic<uint32_t> seq;
+    // Ringing only makes a system call if someone may be sleeping.
+    std::atomic<int32_t> num_waiters;
+  };
+  struct Header {
+    uint32_t magic;
+    int32_t num_slots;
+    std::atomic<uint32_t> next_slot;
+    Doorbell request_bell;
+    Doorbell reply_bell;
+  };
+  constexpr static uint32_t kQueueMagic = 0x4d535251;
+  SharedMemory mem_;
+  int32_t num_slots_;
+  Header *hdr_;
+  Slot *slots_;
+
+  SharedRequestQueue() : num_slots_(0), hdr_(nullptr), slots_(nullptr) {}
+  void Setup();
+  static void Ring(Doorbell *bell);
+  static void Wait(Doorbell *bell, uint32_t seen, int32_t num_idle);
+};
 
 }  // namespace dataset
 }  // namespace mindspore
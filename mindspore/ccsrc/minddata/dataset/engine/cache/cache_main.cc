@@ -33,16 +33,25 @@ namespace ds = mindspore::dataset;
 ds::Status StartServer(int argc, char **argv) {
   ds::Status rc;
   ds::CacheServer::Builder builder;
-  if (argc != 8) {
+  if (argc != 12) {
     return ds::Status(ds::StatusCode::kSyntaxError);
   }
 
+  ds::CacheEvictPolicy evict_policy;
+  if (!ds::CacheEvictPolicyFromName(argv[8], &evict_policy)) {
+    std::string errMsg = "Invalid eviction policy " + std::string(argv[8]);
+    return ds::Status(ds::StatusCode::kSyntaxError, __LINE__, __FILE__, errMsg);
+  }
   int32_t port = strtol(argv[3], nullptr, 10);
   builder.SetRootDirectory(argv[1])
     .SetNumWorkers(strtol(argv[2], nullptr, 10))
     .SetPort(port)
     .SetSharedMemorySizeInGB(strtol(argv[4], nullptr, 10))
-    .SetMemoryCapRatio(strtof(argv[7], nullptr));
+    .SetMemoryCapRatio(strtof(argv[7], nullptr))
+    .SetEvictPolicy(evict_policy)
+    .SetPinEpochs(strtol(argv[9], nullptr, 10))
+    .SetCompression(strcmp(argv[10], "true") == 0)
+    .SetPersistence(strcmp(argv[11], "true") == 0);
 
   auto daemonize_string = argv[6];
   bool daemonize = strcmp(daemonize_string, "true") == 0 || strcmp(daemonize_string, "TRUE") == 0 ||
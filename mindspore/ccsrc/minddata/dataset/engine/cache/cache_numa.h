@@ -156,6 +156,9 @@ class NumaMemoryPool : public MemoryPool {
   /// \brief Return if the memory pool is numa aware
   bool NumaAware() const { return CacheServerHW::numa_enabled(); }
 
+  /// \brief Return the numa node of the calling thread
+  numa_id_t GetMyNode() const { return hw_->GetMyNode(); }
+
   /// \brief. This returns all the numa nodes that we are able to allocate memory from.
   std::vector<numa_id_t> GetAvailableNodes() const;
 
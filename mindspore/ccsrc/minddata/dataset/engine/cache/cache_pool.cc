@@ -14,24 +14,80 @@
  * limitations under the License.
  */
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include "utils/ms_utils.h"
 #include "minddata/dataset/engine/cache/cache_pool.h"
-#include "minddata/dataset/engine/cache/cache_server.h"
+#include "minddata/dataset/util/lz4_block.h"
 #include "minddata/dataset/util/services.h"
 
 namespace mindspore {
 namespace dataset {
-CachePool::CachePool(std::shared_ptr<NumaMemoryPool> mp, const std::string &root)
-    : mp_(std::move(mp)), root_(root), subfolder_(Services::GetUniqueID()), sm_(nullptr), tree_(nullptr) {}
+namespace {
+// A buffer is kept compressed only if this saves at least 1/8 of its size.
+constexpr size_t kMinCompressSavingShift = 3;
+// Give up making room for a buffer after this many evictions. The free memory may be too fragmented.
+constexpr int32_t kMaxEvictionsPerInsert = 16;
+// The index saved by Checkpoint. Bump the version whenever the header or the record changes.
+const char kIndexCheckpoint[] = "INDEX.ckpt";
+constexpr uint32_t kIndexCheckpointMagic = 0x4d534349;
+constexpr uint32_t kIndexCheckpointVersion = 2;
+struct IndexCheckpointHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t record_sz;
+  int32_t num_containers;
+  int64_t num_rows;
+};
+struct IndexCheckpointRecord {
+  int64_t key;
+  uint64_t sz;
+  uint64_t stored_sz;
+  int64_t offset;
+  int32_t container;
+  int32_t compressed;
+};
+}  // namespace
+
+CachePool::CachePool(std::shared_ptr<NumaMemoryPool> mp, const std::string &root, CacheEvictPolicy policy,
+                     int32_t pin_epochs, bool compress, bool allow_drop, const std::string &name)
+    : mp_(std::move(mp)),
+      root_(root),
+      subfolder_(name.empty() ? Services::GetUniqueID() : name),
+      sm_(nullptr),
+      tree_(nullptr),
+      policy_(policy),
+      pin_epochs_(pin_epochs),
+      compress_(compress),
+      allow_drop_(allow_drop),
+      persist_(false),
+      modified_(false),
+      hot_set_pinned_(false),
+      num_lookups_(0),
+      max_lookup_key_(-1),
+      num_hit_(0),
+      num_miss_(0),
+      hit_bytes_(0),
+      num_evicted_(0) {}
 
 Status CachePool::DoServiceStart() {
   tree_ = std::make_shared<data_index>();
+  if (CanEvict() && root_.toString().empty() && !allow_drop_) {
+    // Nowhere to put the evicted rows.
+    MS_LOG(WARNING) << "Eviction is turned off for a cache with a build phase and no spilling directory.";
+    policy_ = CacheEvictPolicy::kEvictNone;
+  }
   // If we are given a disk path, set up the StorageManager
   if (!root_.toString().empty()) {
     Path spill = GetSpillPath();
     RETURN_IF_NOT_OK(spill.CreateDirectories());
-    sm_ = std::make_shared<StorageManager>(spill);
-    RETURN_IF_NOT_OK(sm_->ServiceStart());
+    Path checkpoint = spill / kIndexCheckpoint;
+    if (checkpoint.Exists()) {
+      RETURN_IF_NOT_OK(Restore(checkpoint));
+    } else {
+      sm_ = std::make_shared<StorageManager>(spill);
+      RETURN_IF_NOT_OK(sm_->ServiceStart());
+    }
     MS_LOG(INFO) << "CachePool will use disk folder: " << spill.toString();
   }
   return Status::OK();
@@ -54,7 +110,7 @@ Status CachePool::DoServiceStop() {
   // release each buffer in the DataLocator one by one.
 
   tree_.reset();
-  if (!root_.toString().empty()) {
+  if (!root_.toString().empty() && !persist_) {
     Path spill = GetSpillPath();
     auto it = Path::DirIterator::OpenDirectory(&spill);
     while (it->hasNext()) {
@@ -73,6 +129,229 @@ Status CachePool::DoServiceStop() {
 
 CachePool::~CachePool() noexcept { (void)ServiceStop(); }
 
+Status CachePool::Checkpoint() {
+  CHECK_FAIL_RETURN_UNEXPECTED(sm_ != nullptr, "Only a cache which spills to disk can be checkpointed");
+  std::vector<IndexCheckpointRecord> records;
+  tree_->LockShared();
+  Status rc;
+  modified_ = false;
+  for (auto it = tree_->begin(); it != tree_->end() && rc.IsOk(); ++it) {
+    it.LockExclusive();
+    DataLocator &bl = it.value();
+    // A dropped row is a cache miss anyway.
+    if (!bl.evicted) {
+      if (bl.ptr != nullptr && !bl.saved) {
+        rc = sm_->Write(&bl.storage_key, {ReadableSlice(bl.ptr, bl.stored_sz)});
+        bl.saved = rc.IsOk();
+      }
+      StorageManager::value_type v;
+      if (rc.IsOk()) {
+        rc = sm_->Locate(bl.storage_key, &v);
+      }
+      if (rc.IsOk()) {
+        records.push_back({it.key(), bl.sz, bl.stored_sz, v.second.first, v.first, bl.compressed ? 1 : 0});
+      }
+    }
+    it.Unlock();
+  }
+  tree_->Unlock();
+  RETURN_IF_NOT_OK(rc);
+  // Write to a temporary file first so that an earlier checkpoint is never left half overwritten.
+  Path checkpoint = GetSpillPath() / kIndexCheckpoint;
+  std::string tmp = checkpoint.toString() + ".tmp";
+  IndexCheckpointHeader hdr{kIndexCheckpointMagic, kIndexCheckpointVersion, sizeof(IndexCheckpointRecord),
+                            sm_->NumContainers(), static_cast<int64_t>(records.size())};
+  std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+  out.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(IndexCheckpointRecord));
+  out.close();
+  CHECK_FAIL_RETURN_UNEXPECTED(out.good(), "Unable to write " + tmp);
+  CHECK_FAIL_RETURN_UNEXPECTED(rename(tmp.data(), checkpoint.toString().data()) == 0,
+                               "Unable to rename " + tmp + ". Errno = " + std::to_string(errno));
+  MS_LOG(INFO) << "Checkpoint " << records.size() << " rows into " << checkpoint;
+  return Status::OK();
+}
+
+void CachePool::Persist() {
+  if (sm_ != nullptr) {
+    sm_->KeepFiles();
+    persist_ = true;
+  }
+}
+
+Status CachePool::Restore(const Path &checkpoint) {
+  std::ifstream in(checkpoint.toString(), std::ios::binary);
+  CHECK_FAIL_RETURN_UNEXPECTED(in.good(), "Unable to open " + checkpoint.toString());
+  IndexCheckpointHeader hdr{0, 0, 0, 0, 0};
+  in.read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+  CHECK_FAIL_RETURN_UNEXPECTED(in.good() && hdr.magic == kIndexCheckpointMagic,
+                               "Invalid checkpoint " + checkpoint.toString());
+  CHECK_FAIL_RETURN_UNEXPECTED(hdr.version == kIndexCheckpointVersion && hdr.record_sz == sizeof(IndexCheckpointRecord),
+                               "Checkpoint " + checkpoint.toString() + " has version " + std::to_string(hdr.version) +
+                                 ". Expected " + std::to_string(kIndexCheckpointVersion));
+  CHECK_FAIL_RETURN_UNEXPECTED(hdr.num_containers > 0 && hdr.num_rows >= 0,
+                               "Invalid checkpoint " + checkpoint.toString());
+  // The records must fill up the rest of the file exactly.
+  auto data_start = in.tellg();
+  in.seekg(0, std::ios::end);
+  int64_t data_sz = in.tellg() - data_start;
+  in.seekg(data_start);
+  CHECK_FAIL_RETURN_UNEXPECTED(data_sz == hdr.num_rows * static_cast<int64_t>(sizeof(IndexCheckpointRecord)),
+                               "Size mismatch in checkpoint " + checkpoint.toString());
+  sm_ = std::make_shared<StorageManager>(GetSpillPath(), hdr.num_containers);
+  RETURN_IF_NOT_OK(sm_->ServiceStart());
+  for (int64_t i = 0; i < hdr.num_rows; ++i) {
+    IndexCheckpointRecord rec;
+    in.read(reinterpret_cast<char *>(&rec), sizeof(rec));
+    CHECK_FAIL_RETURN_UNEXPECTED(in.good(), "Truncated checkpoint " + checkpoint.toString());
+    DataLocator bl;
+    bl.sz = rec.sz;
+    bl.stored_sz = rec.stored_sz;
+    bl.compressed = (rec.compressed != 0);
+    RETURN_IF_NOT_OK(sm_->Restore(std::make_pair(rec.container, std::make_pair(rec.offset, rec.stored_sz)),
+                                  &bl.storage_key));
+    RETURN_IF_NOT_OK(tree_->DoInsert(rec.key, bl));
+  }
+  MS_LOG(INFO) << "Restored " << hdr.num_rows << " rows from " << checkpoint;
+  return Status::OK();
+}
+
+Status CachePool::Compress(const std::vector<ReadableSlice> &buf, size_t sz, std::string *out) const {
+  RETURN_UNEXPECTED_IF_NULL(out);
+  ReadableSlice src;
+  std::string consolidated;
+  if (buf.size() == 1) {
+    src = buf.front();
+  } else {
+    consolidated.resize(sz);
+    WritableSlice dest(&consolidated[0], sz);
+    size_t pos = 0;
+    for (auto &v : buf) {
+      WritableSlice part(dest, pos);
+      RETURN_IF_NOT_OK(WritableSlice::Copy(&part, v));
+      pos += v.GetSize();
+    }
+    src = ReadableSlice(consolidated.data(), sz);
+  }
+  // Anything that doesn't fit into the smaller buffer isn't worth compressing.
+  out->resize(sz - (sz >> kMinCompressSavingShift));
+  WritableSlice dest(&(*out)[0], out->size());
+  out->resize(Lz4Compress(src, &dest));
+  return Status::OK();
+}
+
+Status CachePool::Allocate(size_t sz, pointer *p) {
+  Status rc = mp_->Allocate(sz, reinterpret_cast<void **>(p));
+  for (int32_t i = 0; CanEvict() && rc.IsOutofMemory() && i < kMaxEvictionsPerInsert; ++i) {
+    bool evicted = false;
+    RETURN_IF_NOT_OK(EvictOne(&evicted));
+    if (!evicted) {
+      break;
+    }
+    rc = mp_->Allocate(sz, reinterpret_cast<void **>(p));
+  }
+  return rc;
+}
+
+Status CachePool::EvictOne(bool *evicted) {
+  *evicted = false;
+  key_type key;
+  {
+    std::unique_lock<std::mutex> lck(lru_mux_);
+    if (lru_.empty()) {
+      return Status::OK();
+    }
+    key = lru_.front();
+    lru_.pop_front();
+    lru_pos_.erase(key);
+  }
+  DataLocator victim;
+  {
+    auto r = tree_->Search(key);
+    if (!r.second || r.first->ptr == nullptr) {
+      return Status::OK();
+    }
+    victim = *r.first;
+  }
+  // No one else can evict this buffer now that it is off the lru list, so its memory stays valid until we
+  // swap the locator below. Readers hold the leaf of the tree in S mode while they copy, so the swap waits for them.
+  DataLocator bl(victim);
+  bl.ptr = nullptr;
+  bl.node_hit = false;
+  bl.saved = false;
+  if (victim.saved) {
+    // Checkpoint has already written it to disk.
+  } else if (sm_ != nullptr) {
+    RETURN_IF_NOT_OK(sm_->Write(&bl.storage_key, {ReadableSlice(victim.ptr, victim.stored_sz)}));
+  } else {
+    bl.evicted = true;
+  }
+  auto old = tree_->DoUpdate(key, bl);
+  if (old != nullptr && old->ptr != nullptr) {
+    mp_->Deallocate(old->ptr);
+  }
+  ++num_evicted_;
+  modified_ = true;
+  *evicted = true;
+  return Status::OK();
+}
+
+Status CachePool::Readmit(key_type key, const DataLocator &bl) {
+  {
+    auto r = tree_->Search(key);
+    if (!r.second || !r.first->evicted) {
+      return Status(StatusCode::kDuplicateKey);
+    }
+  }
+  auto old = tree_->DoUpdate(key, bl);
+  // Someone else may have readmitted the key in the meantime.
+  if (old != nullptr && old->ptr != nullptr) {
+    mp_->Deallocate(old->ptr);
+  }
+  return Status::OK();
+}
+
+void CachePool::Touch(key_type key, bool add) const {
+  std::unique_lock<std::mutex> lck(lru_mux_);
+  if (hot_set_pinned_) {
+    return;
+  }
+  auto it = lru_pos_.find(key);
+  if (it != lru_pos_.end()) {
+    lru_.splice(lru_.end(), lru_, it->second);
+  } else if (add) {
+    lru_pos_.emplace(key, lru_.insert(lru_.end(), key));
+  }
+}
+
+void CachePool::CountLookup(key_type key, bool hit, size_t sz) const {
+  if (hit) {
+    ++num_hit_;
+    hit_bytes_ += sz;
+  } else {
+    ++num_miss_;
+  }
+  auto n = ++num_lookups_;
+  auto max_key = max_lookup_key_.load();
+  while (key > max_key && !max_lookup_key_.compare_exchange_weak(max_key, key)) {
+  }
+  if (policy_ != CacheEvictPolicy::kEvictPinHotSet) {
+    return;
+  }
+  // An epoch has gone by every time the number of lookups reaches the number of rows, which we estimate from
+  // the largest row id looked up so far.
+  max_key = std::max(max_key, key);
+  if (n >= static_cast<int64_t>(pin_epochs_) * (max_key + 1)) {
+    std::unique_lock<std::mutex> lck(lru_mux_);
+    if (!hot_set_pinned_) {
+      MS_LOG(INFO) << "Pin " << lru_.size() << " rows in memory after " << pin_epochs_ << " epochs.";
+      hot_set_pinned_ = true;
+      lru_.clear();
+      lru_pos_.clear();
+    }
+  }
+}
+
 Status CachePool::Insert(CachePool::key_type key, const std::vector<ReadableSlice> &buf) {
   DataLocator bl;
   Status rc;
@@ -82,20 +361,31 @@ Status CachePool::Insert(CachePool::key_type key, const std::vector<ReadableSlic
     sz += v.GetSize();
   }
   bl.sz = sz;
-  rc = mp_->Allocate(sz, reinterpret_cast<void **>(&bl.ptr));
+  bl.stored_sz = sz;
+  std::string compressed;
+  if (compress_) {
+    RETURN_IF_NOT_OK(Compress(buf, sz, &compressed));
+  }
+  std::vector<ReadableSlice> compressed_buf;
+  if (!compressed.empty()) {
+    bl.compressed = true;
+    bl.stored_sz = compressed.size();
+    compressed_buf.emplace_back(compressed.data(), compressed.size());
+  }
+  const std::vector<ReadableSlice> &stored_buf = bl.compressed ? compressed_buf : buf;
+  rc = Allocate(bl.stored_sz, &bl.ptr);
   if (rc.IsOk()) {
     // Write down which numa node where we allocate from. It only make sense if the policy is kOnNode.
-    if (CacheServerHW::numa_enabled()) {
-      auto &cs = CacheServer::GetInstance();
-      auto node_id = cs.GetHWControl()->GetMyNode();
+    if (mp_->NumaAware()) {
+      auto node_id = mp_->GetMyNode();
       bl.node_id = mp_->FindNode(bl.ptr);
       CHECK_FAIL_RETURN_UNEXPECTED(bl.node_id != -1, "Allocator is not from numa memory pool");
       bl.node_hit = (bl.node_id == node_id);
     }
     // We will do a piecewise copy.
-    WritableSlice dest(bl.ptr, bl.sz);
+    WritableSlice dest(bl.ptr, bl.stored_sz);
     size_t pos = 0;
-    for (auto &v : buf) {
+    for (auto &v : stored_buf) {
       WritableSlice out(dest, pos);
       rc = WritableSlice::Copy(&out, v);
       if (rc.IsError()) {
@@ -111,8 +401,8 @@ Status CachePool::Insert(CachePool::key_type key, const std::vector<ReadableSlic
   } else if (rc.IsOutofMemory()) {
     // If no memory, write to disk.
     if (sm_ != nullptr) {
-      MS_LOG(DEBUG) << "Spill to disk directly ... " << bl.sz << " bytes.";
-      RETURN_IF_NOT_OK(sm_->Write(&bl.storage_key, buf));
+      MS_LOG(DEBUG) << "Spill to disk directly ... " << bl.stored_sz << " bytes.";
+      RETURN_IF_NOT_OK(sm_->Write(&bl.storage_key, stored_buf));
     } else {
       // If asked to spill to disk instead but there is no storage set up, simply return no memory
       // instead.
@@ -124,6 +414,9 @@ Status CachePool::Insert(CachePool::key_type key, const std::vector<ReadableSlic
   // Insert into the B+ tree. We may still get out of memory error. So need to catch it.
   try {
     rc = tree_->DoInsert(key, bl);
+    if (rc == Status(StatusCode::kDuplicateKey) && allow_drop_) {
+      rc = Readmit(key, bl);
+    }
   } catch (const std::bad_alloc &e) {
     rc = Status(StatusCode::kOutOfMemory, __LINE__, __FILE__);
   }
@@ -133,6 +426,12 @@ Status CachePool::Insert(CachePool::key_type key, const std::vector<ReadableSlic
     bl.ptr = nullptr;
     return rc;
   }
+  if (rc.IsOk()) {
+    modified_ = true;
+  }
+  if (rc.IsOk() && bl.ptr != nullptr && CanEvict()) {
+    Touch(key, true);
+  }
   return rc;
 }
 
@@ -141,18 +440,38 @@ Status CachePool::Read(CachePool::key_type key, WritableSlice *dest, size_t *byt
   auto r = tree_->Search(key);
   if (r.second) {
     auto &it = r.first;
-    if (it->ptr != nullptr) {
-      ReadableSlice src(it->ptr, it->sz);
-      RETURN_IF_NOT_OK(WritableSlice::Copy(dest, src));
-    } else if (sm_ != nullptr) {
+    if (it->evicted) {
+      // The lookup before the read counted a hit which turns out to be a miss.
+      --num_hit_;
+      hit_bytes_ -= it->sz;
+      ++num_miss_;
+      return Status(StatusCode::kFileNotExist, __LINE__, __FILE__, "Row has been evicted");
+    }
+    ReadableSlice src(it->ptr, it->stored_sz);
+    std::string compressed;
+    if (it->ptr == nullptr && sm_ != nullptr) {
       size_t expectedLength = 0;
-      RETURN_IF_NOT_OK(sm_->Read(it->storage_key, dest, &expectedLength));
-      if (expectedLength != it->sz) {
-        MS_LOG(ERROR) << "Unexpected length. Read " << expectedLength << ". Expected " << it->sz << "."
+      if (it->compressed) {
+        compressed.resize(it->stored_sz);
+        WritableSlice buf(&compressed[0], compressed.size());
+        RETURN_IF_NOT_OK(sm_->Read(it->storage_key, &buf, &expectedLength));
+        src = ReadableSlice(compressed.data(), compressed.size());
+      } else {
+        RETURN_IF_NOT_OK(sm_->Read(it->storage_key, dest, &expectedLength));
+      }
+      if (expectedLength != it->stored_sz) {
+        MS_LOG(ERROR) << "Unexpected length. Read " << expectedLength << ". Expected " << it->stored_sz << "."
                       << " Internal key: " << key << "\n";
         RETURN_STATUS_UNEXPECTED("Length mismatch. See log file for details.");
       }
     }
+    if (it->compressed) {
+      CHECK_FAIL_RETURN_UNEXPECTED(dest->GetSize() >= it->sz, "Destination is too small");
+      WritableSlice out(*dest, 0, it->sz);
+      RETURN_IF_NOT_OK(Lz4Decompress(src, &out));
+    } else if (it->ptr != nullptr) {
+      RETURN_IF_NOT_OK(WritableSlice::Copy(dest, src));
+    }
     if (bytesRead != nullptr) {
       *bytesRead = it->sz;
     }
@@ -169,23 +488,31 @@ Path CachePool::GetSpillPath() const {
 
 CachePool::CacheStat CachePool::GetStat(bool GetMissingKeys) const {
   tree_->LockShared();  // Prevent any node split while we search.
-  CacheStat cs{-1, -1, 0, 0, 0, 0};
+  CacheStat cs{-1, -1, 0, 0, 0, 0, 0, 0, num_hit_, num_miss_, hit_bytes_, num_evicted_};
   int64_t total_sz = 0;
   if (tree_->begin() != tree_->end()) {
     cs.min_key = tree_->begin().key();
     cs.max_key = cs.min_key;  // will adjust later.
     for (auto it = tree_->begin(); it != tree_->end(); ++it) {
       it.LockShared();
-      total_sz += it.value().sz;
-      if (it.value().ptr != nullptr) {
+      auto cur_key = it.key();
+      if (it.value().evicted) {
+        // An evicted row is a cache miss just like the gap between the keys.
+        if (GetMissingKeys) {
+          cs.gap.push_back(cur_key);
+        }
+      } else if (it.value().ptr != nullptr) {
+        total_sz += it.value().sz;
         ++cs.num_mem_cached;
+        cs.mem_bytes += it.value().stored_sz;
+        cs.raw_mem_bytes += it.value().sz;
       } else {
+        total_sz += it.value().sz;
         ++cs.num_disk_cached;
       }
       if (it.value().node_hit) {
         ++cs.num_numa_hit;
       }
-      auto cur_key = it.key();
       if (GetMissingKeys) {
         for (auto i = cs.max_key + 1; i < cur_key; ++i) {
           cs.gap.push_back((i));
@@ -209,21 +536,35 @@ CachePool::CacheStat CachePool::GetStat(bool GetMissingKeys) const {
 Status CachePool::GetDataLocator(key_type key, const std::shared_ptr<flatbuffers::FlatBufferBuilder> &fbb,
                                  flatbuffers::Offset<DataLocatorMsg> *out) const {
   RETURN_UNEXPECTED_IF_NULL(out);
-  auto r = tree_->Search(key);
-  if (r.second) {
-    auto &it = r.first;
-    DataLocatorMsgBuilder bld(*fbb);
-    bld.add_key(key);
-    bld.add_size(it->sz);
-    bld.add_node_id(it->node_id);
-    bld.add_addr(reinterpret_cast<int64_t>(it->ptr));
-    auto offset = bld.Finish();
-    *out = offset;
-  } else {
-    // Key not in the cache.
-    auto offset = CreateDataLocatorMsg(*fbb, key, 0, 0, 0);
-    *out = offset;
+  bool hit = false;
+  bool in_memory = false;
+  size_t sz = 0;
+  {
+    auto r = tree_->Search(key);
+    if (r.second && !r.first->evicted) {
+      auto &it = r.first;
+      hit = true;
+      in_memory = (it->ptr != nullptr);
+      sz = it->sz;
+      // A buffer that is compressed or can be evicted has to be read through the tree under the lock of its leaf.
+      bool direct = !it->compressed && !CanEvict();
+      DataLocatorMsgBuilder bld(*fbb);
+      bld.add_key(key);
+      bld.add_size(it->sz);
+      bld.add_node_id(it->node_id);
+      bld.add_addr(direct ? reinterpret_cast<int64_t>(it->ptr) : 0);
+      auto offset = bld.Finish();
+      *out = offset;
+    } else {
+      // Key not in the cache.
+      auto offset = CreateDataLocatorMsg(*fbb, key, 0, 0, 0);
+      *out = offset;
+    }
+  }
+  if (in_memory && CanEvict()) {
+    Touch(key, false);
   }
+  CountLookup(key, hit, sz);
   return Status::OK();
 }
 }  // namespace dataset
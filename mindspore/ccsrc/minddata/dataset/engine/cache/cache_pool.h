@@ -16,9 +16,12 @@
 #ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_CACHE_POOL_H_
 #define MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_CACHE_POOL_H_
 
+#include <atomic>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include "minddata/dataset/engine/cache/cache_common.h"
@@ -48,37 +51,60 @@ class CachePool : public Service {
   // An internal class to locate the whereabouts of a backed up buffer which can be either in
   class DataLocator {
    public:
-    DataLocator() : ptr(nullptr), sz(0), node_id(0), node_hit(false), storage_key(0) {}
+    DataLocator()
+        : ptr(nullptr),
+          sz(0),
+          stored_sz(0),
+          node_id(0),
+          node_hit(false),
+          compressed(false),
+          evicted(false),
+          saved(false),
+          storage_key(0) {}
     ~DataLocator() = default;
     DataLocator(const DataLocator &other) = default;
     DataLocator &operator=(const DataLocator &other) = default;
     DataLocator(DataLocator &&other) noexcept {
       ptr = other.ptr;
       sz = other.sz;
+      stored_sz = other.stored_sz;
       node_id = other.node_id;
       node_hit = other.node_hit;
+      compressed = other.compressed;
+      evicted = other.evicted;
+      saved = other.saved;
       storage_key = other.storage_key;
       other.ptr = nullptr;
       other.sz = 0;
+      other.stored_sz = 0;
       other.storage_key = 0;
     }
     DataLocator &operator=(DataLocator &&other) noexcept {
       if (&other != this) {
         ptr = other.ptr;
         sz = other.sz;
+        stored_sz = other.stored_sz;
         node_id = other.node_id;
         node_hit = other.node_hit;
+        compressed = other.compressed;
+        evicted = other.evicted;
+        saved = other.saved;
         storage_key = other.storage_key;
         other.ptr = nullptr;
         other.sz = 0;
+        other.stored_sz = 0;
         other.storage_key = 0;
       }
       return *this;
     }
     pointer ptr;
-    size_t sz;
+    size_t sz;          // size of the buffer given to Insert
+    size_t stored_sz;   // size kept in memory or on disk, smaller than sz if the buffer is compressed
     numa_id_t node_id;  // where the numa node the memory is allocated to
     bool node_hit;      // we can allocate to the preferred node
+    bool compressed;    // the buffer is kept in lz4 block format
+    bool evicted;       // the buffer was dropped from memory and is neither in memory nor on disk
+    bool saved;         // the buffer is in memory and Checkpoint has also written it to disk at storage_key
     StorageManager::key_type storage_key;
   };
 
@@ -95,13 +121,28 @@ class CachePool : public Service {
     int64_t num_disk_cached;
     int64_t average_cache_sz;
     int64_t num_numa_hit;
+    int64_t mem_bytes;      // bytes in memory after compression
+    int64_t raw_mem_bytes;  // bytes in memory before compression
+    int64_t num_hit;
+    int64_t num_miss;
+    int64_t hit_bytes;
+    int64_t num_evicted;
     std::vector<key_type> gap;
   };
 
   /// \brief Constructor
   /// \param alloc Allocator to allocate memory from
   /// \param root Optional disk folder to spill
-  explicit CachePool(std::shared_ptr<NumaMemoryPool> mp, const std::string &root = "");
+  /// \param policy What to do with the rows in memory once the memory is full
+  /// \param pin_epochs Number of epochs kEvictPinHotSet watches before it pins the rows in memory
+  /// \param compress Keep the rows in lz4 block format if this saves memory
+  /// \param allow_drop Rows can be dropped from memory if there is no disk folder to spill them to. The client
+  /// must be able to recompute a dropped row, i.e. the cache has no build phase.
+  /// \param name Optional name of the spill folder under root. A unique name is generated if empty. If the folder
+  /// holds a checkpoint, the rows are restored from it.
+  explicit CachePool(std::shared_ptr<NumaMemoryPool> mp, const std::string &root = "",
+                     CacheEvictPolicy policy = CacheEvictPolicy::kEvictNone, int32_t pin_epochs = kDefaultPinEpochs,
+                     bool compress = false, bool allow_drop = false, const std::string &name = "");
 
   CachePool(const CachePool &) = delete;
   CachePool(CachePool &&) = delete;
@@ -126,10 +167,12 @@ class CachePool : public Service {
   /// \param[in] key A previous key returned from Insert
   /// \param[out] dest The cached buffer will be copied to this destination represented by a WritableSlice
   /// \param[out] bytesRead Optional. Number of bytes read.
-  /// \return Error code
+  /// \return Error code. kFileNotExist if the buffer has been evicted since it was looked up. The lookup is then
+  /// counted as a miss.
   Status Read(key_type key, WritableSlice *dest, size_t *bytesRead = nullptr) const;
 
-  /// \brief Serialize a DataLocator
+  /// \brief Serialize a DataLocator. The lookup counts as an access of the key for the hit rate and the
+  /// eviction policy. The address is only given out if the buffer can be copied as is and can't be evicted.
   Status GetDataLocator(key_type, const std::shared_ptr<flatbuffers::FlatBufferBuilder> &,
                         flatbuffers::Offset<DataLocatorMsg> *) const;
 
@@ -137,6 +180,19 @@ class CachePool : public Service {
   /// \return CacheStat object
   CacheStat GetStat(bool GetMissingKeys = false) const;
 
+  /// \brief Copy the rows in memory to disk and save the index next to the spilled rows, so that a CachePool
+  /// created later with the same root and name gets them back. The rows stay in memory. A row is written to disk
+  /// only once, so calling this again, e.g. periodically, only writes the rows added since.
+  /// \note The caller must make sure no one is using the pool.
+  /// \return Status object
+  Status Checkpoint();
+
+  /// \brief Keep the spill folder and the last checkpoint when the service stops. Otherwise they are removed.
+  void Persist();
+
+  /// \brief True if rows have been added or evicted since the last Checkpoint
+  bool Modified() const { return modified_; }
+
   std::string MyName() const { return subfolder_; }
 
   /// \brief Toggle locking
@@ -149,6 +205,49 @@ class CachePool : public Service {
   const std::string subfolder_;
   std::shared_ptr<StorageManager> sm_;
   std::shared_ptr<data_index> tree_;
+  CacheEvictPolicy policy_;
+  int32_t pin_epochs_;
+  bool compress_;
+  bool allow_drop_;
+  bool persist_;
+  std::atomic<bool> modified_;
+  // Rows in memory which can be evicted, the least recently used one first.
+  mutable std::mutex lru_mux_;
+  mutable std::list<key_type> lru_;
+  mutable std::unordered_map<key_type, std::list<key_type>::iterator> lru_pos_;
+  mutable bool hot_set_pinned_;
+  // Lookups and the largest key looked up tell how many epochs have gone by.
+  mutable std::atomic<int64_t> num_lookups_;
+  mutable std::atomic<key_type> max_lookup_key_;
+  mutable std::atomic<int64_t> num_hit_;
+  mutable std::atomic<int64_t> num_miss_;
+  mutable std::atomic<int64_t> hit_bytes_;
+  std::atomic<int64_t> num_evicted_;
+
+  bool CanEvict() const { return policy_ != CacheEvictPolicy::kEvictNone; }
+
+  /// \brief Reopen the spilled rows saved by Checkpoint
+  Status Restore(const Path &checkpoint);
+
+  /// \brief Compress the buffer if this saves enough memory
+  /// \param[out] out The compressed buffer. Empty if the buffer is kept as is.
+  Status Compress(const std::vector<ReadableSlice> &buf, size_t sz, std::string *out) const;
+
+  /// \brief Allocate memory for a buffer, evicting the least recently used buffers if the memory is full
+  Status Allocate(size_t sz, pointer *p);
+
+  /// \brief Move the least recently used buffer out of memory
+  /// \param[out] evicted False if there is nothing to evict
+  Status EvictOne(bool *evicted);
+
+  /// \brief Insert a buffer in place of an evicted one
+  Status Readmit(key_type key, const DataLocator &bl);
+
+  /// \brief Make a buffer in memory the most recently used one
+  void Touch(key_type key, bool add) const;
+
+  /// \brief Count a lookup for the hit rate and the epochs watched by kEvictPinHotSet
+  void CountLookup(key_type key, bool hit, size_t sz) const;
 };
 }  // namespace dataset
 }  // namespace mindspore
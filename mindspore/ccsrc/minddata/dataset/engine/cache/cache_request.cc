@@ -137,7 +137,10 @@ CacheRowRequest::CacheRowRequest(const CacheClient *cc)
 }
 
 BatchFetchRequest::BatchFetchRequest(const CacheClient *cc, const std::vector<row_id_type> &row_id)
-    : BaseRequest(RequestType::kBatchFetchRows), support_local_bypass_(cc->local_bypass_), row_id_(row_id) {
+    : BaseRequest(RequestType::kBatchFetchRows),
+      support_local_bypass_(cc->local_bypass_),
+      row_id_(row_id),
+      comm_(cc->comm_) {
   rq_.set_connection_id(cc->server_connection_id_);
   rq_.set_client_id(cc->client_id_);
   rq_.set_flag(support_local_bypass_ ? kLocalClientSupport : 0);
@@ -151,7 +154,12 @@ BatchFetchRequest::BatchFetchRequest(const CacheClient *cc, const std::vector<ro
   rq_.add_buf_data(fbb.GetBufferPointer(), fbb.GetSize());
 }
 
-Status BatchFetchRequest::RestoreRows(TensorTable *out, const void *baseAddr, int64_t *out_addr) {
+SharedBlockPool::~SharedBlockPool() {
+  // We can be on any thread here, e.g. the one destroying the last tensor. Let the client send the request.
+  comm_->FreeSharedBlock(connection_id_, client_id_, addr_);
+}
+
+Status BatchFetchRequest::RestoreRows(TensorTable *out, const void *baseAddr) {
   RETURN_UNEXPECTED_IF_NULL(out);
   auto num_elements = row_id_.size();
   const char *ptr = nullptr;
@@ -160,14 +168,14 @@ Status BatchFetchRequest::RestoreRows(TensorTable *out, const void *baseAddr, in
   // so small that it doesn't use shared memory method.
   auto flag = reply_.flag();
   bool dataOnSharedMemory = support_local_bypass_ ? (BitTest(flag, kDataIsInSharedMemory)) : false;
+  std::shared_ptr<MemoryPool> pool;
   if (dataOnSharedMemory) {
     auto addr = strtoll(reply_.result().data(), nullptr, 10);
     ptr = reinterpret_cast<const char *>(reinterpret_cast<int64_t>(baseAddr) + addr);
-    RETURN_UNEXPECTED_IF_NULL(out);
-    *out_addr = addr;
+    // From now on the block is freed when the pool goes away, i.e. after the last tensor using it is destroyed.
+    pool = std::make_shared<SharedBlockPool>(comm_, rq_.connection_id(), rq_.client_id(), addr);
   } else {
     ptr = reply_.result().data();
-    *out_addr = -1;
   }
   auto *offset_array = reinterpret_cast<const int64_t *>(ptr);
   sz = offset_array[num_elements];
@@ -191,7 +199,7 @@ Status BatchFetchRequest::RestoreRows(TensorTable *out, const void *baseAddr, in
         auto col_ts = msg->column()->Get(k);
         std::shared_ptr<Tensor> ts;
         ReadableSlice data(row_data, ts_offset, msg->data_sz()->Get(k));
-        RETURN_IF_NOT_OK(mindspore::dataset::RestoreOneTensor(col_ts, data, &ts));
+        RETURN_IF_NOT_OK(mindspore::dataset::RestoreOneTensor(col_ts, data, &ts, pool));
         row.push_back(ts);
         ts_offset += data.GetSize();
       }
@@ -302,6 +310,12 @@ Status GetStatRequest::PostReply() {
   stat_.max_row_id = msg->max_row_id();
   stat_.min_row_id = msg->min_row_id();
   stat_.cache_service_state = msg->state();
+  stat_.mem_bytes = msg->mem_bytes();
+  stat_.raw_mem_bytes = msg->raw_mem_bytes();
+  stat_.num_hit = msg->num_hit();
+  stat_.num_miss = msg->num_miss();
+  stat_.hit_bytes = msg->hit_bytes();
+  stat_.num_evicted = msg->num_evicted();
   return Status::OK();
 }
 
@@ -330,6 +344,12 @@ Status ListSessionsRequest::PostReply() {
     stats.min_row_id = current_session_info->stats()->min_row_id();
     stats.max_row_id = current_session_info->stats()->max_row_id();
     stats.cache_service_state = current_session_info->stats()->state();
+    stats.mem_bytes = current_session_info->stats()->mem_bytes();
+    stats.raw_mem_bytes = current_session_info->stats()->raw_mem_bytes();
+    stats.num_hit = current_session_info->stats()->num_hit();
+    stats.num_miss = current_session_info->stats()->num_miss();
+    stats.hit_bytes = current_session_info->stats()->hit_bytes();
+    stats.num_evicted = current_session_info->stats()->num_evicted();
     current_info.stats = stats;  // fixed length struct.  = operator is safe
     session_info_list_.push_back(current_info);
   }
@@ -30,12 +30,14 @@
 #include "proto/cache_grpc.pb.h"
 #include "minddata/dataset/core/tensor_row.h"
 #include "minddata/dataset/engine/cache/de_tensor_generated.h"
+#include "minddata/dataset/util/memory_pool.h"
 #include "minddata/dataset/util/slice.h"
 #include "minddata/dataset/util/wait_post.h"
 
 namespace mindspore {
 namespace dataset {
 class CacheClient;
+class CacheClientGreeter;
 /// \brief Statistic structure for GetStat request
 struct CacheServiceStat {
   int64_t num_mem_cached;
@@ -45,6 +47,12 @@ struct CacheServiceStat {
   row_id_type min_row_id;
   row_id_type max_row_id;
   int8_t cache_service_state;
+  int64_t mem_bytes;
+  int64_t raw_mem_bytes;
+  int64_t num_hit;
+  int64_t num_miss;
+  int64_t hit_bytes;
+  int64_t num_evicted;
 };
 
 /// \brief Info structure ListSessionsRequest
@@ -192,6 +200,31 @@ class CacheRowRequest : public BaseRequest {
   row_id_type row_id_from_server_;
 };
 
+/// \brief A memory pool made of the shared memory block the server returns for a BatchFetchRequest. The tensors
+/// restored from the block use it as is, and the block is given back to the server when the last of them is gone.
+class SharedBlockPool : public MemoryPool {
+ public:
+  SharedBlockPool(std::shared_ptr<CacheClientGreeter> comm, connection_id_type connection_id, int32_t client_id,
+                  int64_t addr)
+      : comm_(std::move(comm)), connection_id_(connection_id), client_id_(client_id), addr_(addr) {}
+  ~SharedBlockPool() override;
+
+  Status Allocate(size_t, void **) override { RETURN_STATUS_UNEXPECTED("Shared block can't allocate memory"); }
+  Status Reallocate(void **, size_t old_sz, size_t new_sz) override {
+    RETURN_STATUS_UNEXPECTED("Shared block can't allocate memory");
+  }
+  /// \brief Nothing to do for each tensor. The whole block is freed in the destructor.
+  void Deallocate(void *) override {}
+  uint64_t get_max_size() const override { return 0; }
+  int PercentFree() const override { return 0; }
+
+ private:
+  std::shared_ptr<CacheClientGreeter> comm_;
+  connection_id_type connection_id_;
+  int32_t client_id_;
+  int64_t addr_;
+};
+
 /// \brief Request to fetch rows in batch
 class BatchFetchRequest : public BaseRequest {
  public:
@@ -199,11 +232,18 @@ class BatchFetchRequest : public BaseRequest {
   friend class CacheService;
   BatchFetchRequest(const CacheClient *cc, const std::vector<row_id_type> &row_id);
   ~BatchFetchRequest() override = default;
-  Status RestoreRows(TensorTable *out, const void *baseAddr, int64_t *out_addr);
+
+  /// \brief Restore the rows from the reply. If the server puts the rows in shared memory, the tensors are built
+  /// on top of the shared memory and the memory is given back to the server when all of them are destroyed.
+  /// \param out The rows
+  /// \param baseAddr Base address of the shared memory
+  /// \return Status object
+  Status RestoreRows(TensorTable *out, const void *baseAddr);
 
  private:
   bool support_local_bypass_;
   std::vector<row_id_type> row_id_;
+  std::shared_ptr<CacheClientGreeter> comm_;
 };
 
 /// \brief Request to create a cache for the current connection
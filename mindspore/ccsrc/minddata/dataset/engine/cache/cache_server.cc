@@ -31,6 +31,18 @@
 
 namespace mindspore {
 namespace dataset {
+namespace {
+std::string PersistentCachePrefix(int32_t port) { return "cache_" + std::to_string(port) + "_"; }
+
+void RemoveSpillFolder(Path folder) {
+  auto it = Path::DirIterator::OpenDirectory(&folder);
+  while (it != nullptr && it->hasNext()) {
+    (void)it->next().Remove();
+  }
+  (void)folder.Remove();
+}
+}  // namespace
+
 CacheServer *CacheServer::instance_ = nullptr;
 std::once_flag CacheServer::init_instance_flag_;
 Status CacheServer::DoServiceStart() {
@@ -53,6 +65,9 @@ Status CacheServer::DoServiceStart() {
     CacheServerHW::SetDefaultMemoryPolicy(numa_affinity_ ? CachePoolPolicy::kLocal : CachePoolPolicy::kInterleave));
   auto my_node = hw_info_->GetMyNode();
   MS_LOG(DEBUG) << "Cache server is running on numa node " << my_node;
+  if (persist_) {
+    RETURN_IF_NOT_OK(RestoreCaches());
+  }
   // Bump up num_workers_ to at least the number of numa nodes
   num_workers_ = std::max(num_numa_nodes, num_workers_);
   // But also it shouldn't be too many more than the hardware concurrency
@@ -113,6 +128,8 @@ Status CacheServer::DoServiceStart() {
   }
 #if CACHE_LOCAL_CLIENT
   RETURN_IF_NOT_OK(CachedSharedMemory::CreateArena(&shm_, port_, shared_memory_sz_in_gb_));
+  // Local clients send their requests through this queue instead of gRPC.
+  RETURN_IF_NOT_OK(SharedRequestQueue::CreateQueue(port_, &local_q_));
   // Bring up a thread to monitor the unix socket in case it is removed. But it must be done
   // after we have created the unix socket.
   auto inotify_f = std::bind(&CacheServerGreeterImpl::MonitorUnixSocket, comm_layer_.get());
@@ -142,6 +159,20 @@ Status CacheServer::DoServiceStart() {
       RETURN_IF_NOT_OK(SetAffinity(*pTask, i % num_numa_nodes));
     }
   }
+#if CACHE_LOCAL_CLIENT
+  // Same number of threads to poll the shared request queue. They take the free tags from the same free lists.
+  auto l = std::bind(&CacheServer::LocalRequest, this, std::placeholders::_1);
+  for (auto i = 0; i < num_grpc_workers_; ++i) {
+    Task *pTask;
+    RETURN_IF_NOT_OK(vg_.CreateAsyncTask("Local request worker", std::bind(l, i), &pTask));
+    if (IsNumaAffinityOn()) {
+      RETURN_IF_NOT_OK(SetAffinity(*pTask, i % num_numa_nodes));
+    }
+  }
+#endif
+  if (persist_) {
+    RETURN_IF_NOT_OK(vg_.CreateAsyncTask("Checkpoint caches", std::bind(&CacheServer::CheckpointCaches, this)));
+  }
   return Status::OK();
 }
 
@@ -239,7 +270,7 @@ Status CacheServer::CreateService(CacheRequest *rq, CacheReply *reply) {
       auto &cs = it->second;
       CacheService::ServiceStat stat;
       RETURN_IF_NOT_OK(cs->GetStat(&stat));
-      int64_t mem_consumed = stat.stat_.num_mem_cached * stat.stat_.average_cache_sz;
+      int64_t mem_consumed = stat.stat_.mem_bytes;
       max_avail -= mem_consumed;
       if (max_avail <= 0) {
         return Status(StatusCode::kOutOfMemory, __LINE__, __FILE__, "Please destroy some sessions");
@@ -264,7 +295,9 @@ Status CacheServer::CreateService(CacheRequest *rq, CacheReply *reply) {
     }
     std::unique_ptr<CacheService> cs;
     try {
-      cs = std::make_unique<CacheService>(cache_mem_sz, spill ? top_ : "", generate_id);
+      // A cache which spills can be checkpointed. Its spill folder must be found again after a restart.
+      std::string name = (spill && persist_) ? PersistentCacheName(connection_id) : "";
+      cs = std::make_unique<CacheService>(cache_mem_sz, spill ? top_ : "", generate_id, name);
       RETURN_IF_NOT_OK(cs->ServiceStart());
       cookie = cs->cookie();
       client_id = cs->num_clients_.fetch_add(1);
@@ -440,6 +473,7 @@ Status CacheServer::BatchFetch(const std::shared_ptr<flatbuffers::FlatBufferBuil
       fb2.Finish(offset);
       cache_rq->rq_.add_buf_data(fb2.GetBufferPointer(), fb2.GetSize());
       cache_rq->rq_.add_buf_data(std::to_string(reinterpret_cast<int64_t>(batch_wait.get())));
+      cache_rq->rq_.add_buf_data(std::to_string(i));
       RETURN_IF_NOT_OK(PushRequest(worker_id, cache_rq));
     } else {
       // Nothing to fetch but we still need to post something back into the wait area.
@@ -448,8 +482,28 @@ Status CacheServer::BatchFetch(const std::shared_ptr<flatbuffers::FlatBufferBuil
   }
   // Now wait for all of them to come back.
   RETURN_IF_NOT_OK(batch_wait->Wait());
-  // Return the result
-  return batch_wait->GetRc();
+  RETURN_IF_NOT_OK(batch_wait->GetRc());
+  // Rows evicted since they were looked up become cache misses. Move the rows after each of them up so that
+  // the output stays contiguous.
+  auto missing_rows = batch_wait->GetMissingRows();
+  if (!missing_rows.empty()) {
+    auto *base = static_cast<char *>(out->GetMutablePointer());
+    auto next_missing = missing_rows.begin();
+    int64_t old_start = offset_array[0];
+    for (auto i = 0; i < num_elements; ++i) {
+      int64_t old_end = offset_array[i + 1];
+      int64_t row_sz = old_end - old_start;
+      if (next_missing != missing_rows.end() && *next_missing == i) {
+        ++next_missing;
+        row_sz = 0;
+      } else if (row_sz > 0 && offset_array[i] != old_start) {
+        memmove(base + offset_array[i], base + old_start, row_sz);
+      }
+      offset_array[i + 1] = offset_array[i] + row_sz;
+      old_start = old_end;
+    }
+  }
+  return Status::OK();
 }
 
 Status CacheServer::BatchFetchRows(CacheRequest *rq, CacheReply *reply) {
@@ -521,6 +575,8 @@ Status CacheServer::BatchFetchRows(CacheRequest *rq, CacheReply *reply) {
       }
       WritableSlice dest(mem.data(), mem_sz);
       RETURN_IF_NOT_OK(BatchFetch(fbb, &dest));
+      // Evicted rows may have shrunk the output.
+      mem.resize(reinterpret_cast<const int64_t *>(mem.data())[sz]);
       reply->set_result(std::move(mem));
     }
   }
@@ -547,6 +603,12 @@ Status CacheServer::GetStat(CacheRequest *rq, CacheReply *reply) {
     bld.add_max_row_id(svc_stat.stat_.max_key);
     bld.add_min_row_id(svc_stat.stat_.min_key);
     bld.add_state(svc_stat.state_);
+    bld.add_mem_bytes(svc_stat.stat_.mem_bytes);
+    bld.add_raw_mem_bytes(svc_stat.stat_.raw_mem_bytes);
+    bld.add_num_hit(svc_stat.stat_.num_hit);
+    bld.add_num_miss(svc_stat.stat_.num_miss);
+    bld.add_hit_bytes(svc_stat.stat_.hit_bytes);
+    bld.add_num_evicted(svc_stat.stat_.num_evicted);
     auto offset = bld.Finish();
     fbb.Finish(offset);
     reply->set_result(fbb.GetBufferPointer(), fbb.GetSize());
@@ -680,7 +742,10 @@ Status CacheServer::ListSessions(CacheReply *reply) {
         RETURN_IF_NOT_OK(cs->GetStat(&svc_stat));
         auto current_stats = CreateServiceStatMsg(fbb, svc_stat.stat_.num_mem_cached, svc_stat.stat_.num_disk_cached,
                                                   svc_stat.stat_.average_cache_sz, svc_stat.stat_.num_numa_hit,
-                                                  svc_stat.stat_.min_key, svc_stat.stat_.max_key, svc_stat.state_);
+                                                  svc_stat.stat_.min_key, svc_stat.stat_.max_key, svc_stat.state_,
+                                                  svc_stat.stat_.mem_bytes, svc_stat.stat_.raw_mem_bytes,
+                                                  svc_stat.stat_.num_hit, svc_stat.stat_.num_miss,
+                                                  svc_stat.stat_.hit_bytes, svc_stat.stat_.num_evicted);
         auto current_session_info = CreateListSessionMsg(fbb, current_session_id, current_conn_id, current_stats);
         session_msgs_vector.push_back(current_session_info);
       }
@@ -820,7 +885,8 @@ Status CacheServer::ProcessRequest(CacheServerRequest *cache_req) {
         try {
           int64_t addr = strtol(rq.buf_data(1).data(), nullptr, 10);
           auto *bw = reinterpret_cast<BatchWait *>(addr);
-          RETURN_IF_NOT_OK(bw->Set(std::move(cache_req->rc_)));
+          int64_t row = strtol(rq.buf_data(2).data(), nullptr, 10);
+          RETURN_IF_NOT_OK(bw->Set(std::move(cache_req->rc_), row));
         } catch (const std::exception &e) {
           RETURN_STATUS_UNEXPECTED(e.what());
         }
@@ -918,11 +984,14 @@ Status CacheServer::ProcessRequest(CacheServerRequest *cache_req) {
   cache_req->st_ = CacheServerRequest::STATE::FINISH;
   // We will re-tag the request back to the grpc queue. Once it comes back from the client,
   // the CacheServerRequest, i.e. the pointer cache_req, will be free
-  if (!internal_request) {
-    cache_req->responder_.Finish(reply, grpc::Status::OK, cache_req);
-  } else {
+  if (internal_request) {
     // We can free up the request now.
     RETURN_IF_NOT_OK(ReturnRequestTag(cache_req));
+  } else if (cache_req->IsLocal()) {
+    // The reply goes back through the shared request queue and the tag is free after that.
+    RETURN_IF_NOT_OK(ReplyLocalRequest(cache_req));
+  } else {
+    cache_req->responder_.Finish(reply, grpc::Status::OK, cache_req);
   }
   return Status::OK();
 }
@@ -954,7 +1023,8 @@ session_id_type CacheServer::GetSessionID(connection_id_type connection_id) cons
 }
 
 CacheServer::CacheServer(const std::string &spill_path, int32_t num_workers, int32_t port,
-                         int32_t shared_meory_sz_in_gb, float memory_cap_ratio)
+                         int32_t shared_meory_sz_in_gb, float memory_cap_ratio, CacheEvictPolicy evict_policy,
+                         int32_t pin_epochs, bool compress, bool persist)
     : top_(spill_path),
       num_workers_(num_workers),
       num_grpc_workers_(num_workers_),
@@ -962,6 +1032,10 @@ CacheServer::CacheServer(const std::string &spill_path, int32_t num_workers, int
       shared_memory_sz_in_gb_(shared_meory_sz_in_gb),
       global_shutdown_(false),
       memory_cap_ratio_(memory_cap_ratio),
+      evict_policy_(evict_policy),
+      pin_epochs_(pin_epochs),
+      compress_(compress),
+      persist_(persist),
       numa_affinity_(true) {
   hw_info_ = std::make_shared<CacheServerHW>();
   // If we are not linked with numa library (i.e. NUMA_ENABLED is false), turn off cpu
@@ -1072,6 +1146,83 @@ session_id_type CacheServer::GenerateSessionID() {
   return session_id;
 }
 
+std::string CacheServer::PersistentCacheName(connection_id_type connection_id) const {
+  return PersistentCachePrefix(port_) + std::to_string(connection_id);
+}
+
+Status CacheServer::RestoreCaches() {
+  Path top(top_);
+  auto dir_it = Path::DirIterator::OpenDirectory(&top);
+  CHECK_FAIL_RETURN_UNEXPECTED(dir_it != nullptr, "Unable to open spilling directory " + top_);
+  const std::string prefix = PersistentCachePrefix(port_);
+  std::vector<std::string> names;
+  while (dir_it->hasNext()) {
+    Path p = dir_it->next();
+    std::string name = p.Basename();
+    if (p.IsDirectory() && name.compare(0, prefix.size(), prefix) == 0) {
+      names.push_back(name);
+    }
+  }
+  UniqueLock sess_lck(&sessions_lock_);
+  UniqueLock lck(&rwLock_);
+  for (auto &name : names) {
+    connection_id_type connection_id = 0;
+    std::unique_ptr<CacheService> cs;
+    Status rc = CacheService::Restore(top_, name, &connection_id, &cs);
+    if (rc.IsOk() && name != PersistentCacheName(connection_id)) {
+      rc = Status(StatusCode::kUnexpectedError, __LINE__, __FILE__, "Connection id mismatch");
+    }
+    if (rc.IsError()) {
+      // Most likely the server went down without a checkpoint. Nothing to restore.
+      MS_LOG(WARNING) << "Unable to restore cache from " << name << ". " << rc.ToString();
+      cs.reset();
+      RemoveSpillFolder(top / name);
+      continue;
+    }
+    // The session comes back with its caches so that a job resubmitted with the same session id finds them.
+    (void)active_sessions_.insert(GetSessionID(connection_id));
+    all_caches_.emplace(connection_id, std::move(cs));
+    MS_LOG(INFO) << "Restored cache with connection id " << connection_id;
+  }
+  return Status::OK();
+}
+
+Status CacheServer::CheckpointCaches() {
+  TaskManager::FindMe()->Post();
+  auto last = std::chrono::steady_clock::now();
+  while (!global_shutdown_) {
+    RETURN_IF_INTERRUPTED();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto now = std::chrono::steady_clock::now();
+    if (now - last < std::chrono::seconds(kCheckpointInterval)) {
+      continue;
+    }
+    last = now;
+    SharedLock lck(&rwLock_);
+    for (auto &it : all_caches_) {
+      auto &cs = it.second;
+      if (cs->root_.empty()) {
+        continue;
+      }
+      UniqueLock cs_lock(&cs->rw_lock_);
+      if (cs->NeedsCheckpoint()) {
+        (void)CheckpointCache(it.first, cs.get());
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status CacheServer::CheckpointCache(connection_id_type id, CacheService *cs) {
+  Status rc = cs->Checkpoint(id);
+  if (rc.IsOk()) {
+    MS_LOG(INFO) << "Cache with connection id " << std::to_string(id) << " is saved in " << cs->GetSpillPath();
+  } else {
+    MS_LOG(WARNING) << "Unable to save cache with connection id " << std::to_string(id) << ". " << rc.ToString();
+  }
+  return rc;
+}
+
 Status CacheServer::AllocateSharedMemory(CacheRequest *rq, CacheReply *reply) {
   auto client_id = rq->client_id();
   CHECK_FAIL_RETURN_UNEXPECTED(client_id != -1, "Client ID not set");
@@ -1110,6 +1261,105 @@ Status CacheServer::RpcRequest(worker_id_t worker_id) {
   return Status::OK();
 }
 
+Status CacheServer::LocalRequest(worker_id_t worker_id) {
+  TaskManager::FindMe()->Post();
+  const int32_t num_slots = local_q_->NumSlots();
+  int32_t num_idle = 0;
+  do {
+    bool found = false;
+    // Take the snapshot before we look, so that a request posted while we look doesn't get missed.
+    auto bell = local_q_->RequestBell();
+    for (auto slot_id = worker_id; slot_id < num_slots; slot_id += num_grpc_workers_) {
+      if (local_q_->GetState(slot_id) != SharedRequestQueue::SlotState::kRequest ||
+          !local_q_->Transit(slot_id, SharedRequestQueue::SlotState::kRequest,
+                             SharedRequestQueue::SlotState::kProcessing)) {
+        continue;
+      }
+      found = true;
+      auto *slot = local_q_->GetSlot(slot_id);
+      CacheServerRequest *cache_req;
+      RETURN_IF_NOT_OK(GetFreeRequestTag(worker_id, &cache_req));
+      cache_req->slot_ = slot_id;
+      if (!cache_req->rq_.ParseFromArray(slot->buf, slot->sz)) {
+        cache_req->rc_ = Status(StatusCode::kUnexpectedError, __LINE__, __FILE__, "Unable to parse the request");
+        Status2CacheReply(cache_req->rc_, &cache_req->reply_);
+        RETURN_IF_NOT_OK(ReplyLocalRequest(cache_req));
+        continue;
+      }
+      cache_req->type_ = static_cast<BaseRequest::RequestType>(cache_req->rq_.type());
+      MS_LOG(DEBUG) << "Handle local request " << *cache_req;
+      // Same routing as the gRPC requests. Local clients never send kStopService.
+      auto type = cache_req->type_;
+      if (type == BaseRequest::RequestType::kBatchFetchRows || type == BaseRequest::RequestType::kBatchCacheRows ||
+          type == BaseRequest::RequestType::kAllocateSharedBlock ||
+          type == BaseRequest::RequestType::kFreeSharedBlock) {
+        RETURN_IF_NOT_OK(ProcessRequest(cache_req));
+      } else {
+        bool random = GetNumWorkers() != GetNumGrpcWorkers();
+        worker_id_t target = random ? GetRandomWorker() : worker_id;
+        RETURN_IF_NOT_OK(PushRequest(target, cache_req));
+      }
+    }
+    if (found) {
+      num_idle = 0;
+    } else {
+      RETURN_IF_INTERRUPTED();
+      local_q_->WaitForRequest(bell, ++num_idle);
+    }
+  } while (true);
+  return Status::OK();
+}
+
+Status CacheServer::ReplyLocalRequest(CacheServerRequest *cache_req) {
+  auto slot_id = cache_req->slot_;
+  auto *slot = local_q_->GetSlot(slot_id);
+  if (BitTest(slot->flag, SharedRequestQueue::kNoReply)) {
+    local_q_->SetState(slot_id, SharedRequestQueue::SlotState::kFree);
+    return ReturnRequestTag(cache_req);
+  }
+  auto *reply = &cache_req->reply_;
+  auto client_id = cache_req->rq_.client_id();
+  int64_t sz = reply->ByteSizeLong();
+  void *p = nullptr;
+  slot->reply_addr = -1;
+  if (sz > kSharedQueueSlotSize) {
+    // Too big for the slot. Put it in the shared memory arena and the client will free it once it is read.
+    Status rc = client_id != -1 ? AllocateSharedMemory(client_id, sz, &p)
+                                : Status(StatusCode::kUnexpectedError, __LINE__, __FILE__, "Client ID not set");
+    if (rc.IsOk()) {
+      auto *base = SharedMemoryBaseAddr();
+      slot->reply_addr = reinterpret_cast<int64_t>(p) - reinterpret_cast<int64_t>(base);
+    } else {
+      reply->Clear();
+      Status2CacheReply(rc, reply);
+      sz = reply->ByteSizeLong();
+    }
+  }
+  bool success = reply->SerializeToArray(p != nullptr ? p : slot->buf, sz);
+  if (!success) {
+    if (p != nullptr) {
+      DeallocateSharedMemory(client_id, p);
+      p = nullptr;
+      slot->reply_addr = -1;
+    }
+    reply->Clear();
+    Status2CacheReply(Status(StatusCode::kUnexpectedError, __LINE__, __FILE__, "Unable to serialize the reply"), reply);
+    sz = reply->ByteSizeLong();
+    (void)reply->SerializeToArray(slot->buf, sz);
+  }
+  slot->sz = sz;
+  if (local_q_->Transit(slot_id, SharedRequestQueue::SlotState::kProcessing, SharedRequestQueue::SlotState::kReply)) {
+    local_q_->RingReplyBell();
+  } else {
+    // The client is no longer waiting for it.
+    if (p != nullptr) {
+      DeallocateSharedMemory(client_id, p);
+    }
+    local_q_->SetState(slot_id, SharedRequestQueue::SlotState::kFree);
+  }
+  return ReturnRequestTag(cache_req);
+}
+
 Status CacheServer::AcknowledgeShutdown(CacheServerRequest *cache_req) {
   auto *rq = &cache_req->rq_;
   auto *reply = &cache_req->reply_;
@@ -1148,6 +1398,11 @@ void CacheServer::GlobalShutdown() {
       // Wait for all outstanding work to be finished.
       auto &cs = it->second;
       UniqueLock cs_lock(&cs->rw_lock_);
+      if (persist_ && !cs->root_.empty()) {
+        if (CheckpointCache(id, cs.get()).IsOk()) {
+          cs->Persist();
+        }
+      }
       it = all_caches_.erase(it);
     }
   }
@@ -1198,8 +1453,16 @@ Status CacheServer::Builder::IpcResourceCleanup() {
   RETURN_IF_NOT_OK(mem.GetNumAttached(&num_attached));
   if (num_attached == 0) {
     // Stale shared memory from last time.
-    // Remove both the memory and the socket path
+    // Remove both the memory, the request queue and the socket path
     RETURN_IF_NOT_OK(mem.Destroy());
+    SharedMemory::shm_key_t queue_key;
+    if (SharedRequestQueue::GetQueueKey(port_, &queue_key).IsOk()) {
+      SharedMemory queue_mem(queue_key);
+      if (queue_mem.Attach().IsOk()) {
+        RETURN_IF_NOT_OK(queue_mem.Detach());
+        RETURN_IF_NOT_OK(queue_mem.Destroy());
+      }
+    }
     Path p(unix_socket);
     (void)p.Remove();
   } else {
@@ -1238,6 +1501,12 @@ Status CacheServer::Builder::SanityCheck() {
   if (memory_cap_ratio_ <= 0 || memory_cap_ratio_ > 1) {
     RETURN_STATUS_UNEXPECTED("Memory cap ratio should be positive and no greater than 1");
   }
+  if (pin_epochs_ < 1) {
+    RETURN_STATUS_UNEXPECTED("Number of epochs before pinning the rows in memory should be positive");
+  }
+  if (persist_ && top_.empty()) {
+    RETURN_STATUS_UNEXPECTED("Caches can only be saved if there is a spilling directory");
+  }
 
   // Check if the shared memory.
   RETURN_IF_NOT_OK(IpcResourceCleanup());
@@ -1249,7 +1518,11 @@ CacheServer::Builder::Builder()
       num_workers_(std::thread::hardware_concurrency() / 2),
       port_(50052),
       shared_memory_sz_in_gb_(kDefaultSharedMemorySize),
-      memory_cap_ratio_(kDefaultMemoryCapRatio) {
+      memory_cap_ratio_(kDefaultMemoryCapRatio),
+      evict_policy_(CacheEvictPolicy::kEvictNone),
+      pin_epochs_(kDefaultPinEpochs),
+      compress_(false),
+      persist_(false) {
   if (num_workers_ == 0) {
     num_workers_ = 1;
   }
@@ -70,6 +70,10 @@ class CacheServer : public Service {
     int32_t GetPort() const { return port_; }
     int32_t GetSharedMemorySzInGb() const { return shared_memory_sz_in_gb_; }
     float GetMemoryCapRatio() const { return memory_cap_ratio_; }
+    CacheEvictPolicy GetEvictPolicy() const { return evict_policy_; }
+    int32_t GetPinEpochs() const { return pin_epochs_; }
+    bool IsCompressionOn() const { return compress_; }
+    bool IsPersistenceOn() const { return persist_; }
 
     Builder &SetRootDirectory(std::string root) {
       top_ = std::move(root);
@@ -91,6 +95,22 @@ class CacheServer : public Service {
       memory_cap_ratio_ = ratio;
       return *this;
     }
+    Builder &SetEvictPolicy(CacheEvictPolicy policy) {
+      evict_policy_ = policy;
+      return *this;
+    }
+    Builder &SetPinEpochs(int32_t n) {
+      pin_epochs_ = n;
+      return *this;
+    }
+    Builder &SetCompression(bool on_off) {
+      compress_ = on_off;
+      return *this;
+    }
+    Builder &SetPersistence(bool on_off) {
+      persist_ = on_off;
+      return *this;
+    }
 
     Status SanityCheck();
 
@@ -100,7 +120,11 @@ class CacheServer : public Service {
           << "Number of parallel workers: " << GetNumWorkers() << "\n"
           << "Tcp/ip port: " << GetPort() << "\n"
           << "Shared memory size (in GB): " << GetSharedMemorySzInGb() << "\n"
-          << "Memory cap ratio: " << GetMemoryCapRatio();
+          << "Memory cap ratio: " << GetMemoryCapRatio() << "\n"
+          << "Eviction policy: " << CacheEvictPolicyName(GetEvictPolicy()) << "\n"
+          << "Pinned after number of epochs: " << GetPinEpochs() << "\n"
+          << "Compression: " << (IsCompressionOn() ? "on" : "off") << "\n"
+          << "Persistence: " << (IsPersistenceOn() ? "on" : "off");
     }
 
     friend std::ostream &operator<<(std::ostream &out, const Builder &bld) {
@@ -112,8 +136,8 @@ class CacheServer : public Service {
       RETURN_IF_NOT_OK(SanityCheck());
       // We need to bring up the Task Manager by bringing up the Services singleton.
       RETURN_IF_NOT_OK(Services::CreateInstance());
-      RETURN_IF_NOT_OK(
-        CacheServer::CreateInstance(top_, num_workers_, port_, shared_memory_sz_in_gb_, memory_cap_ratio_));
+      RETURN_IF_NOT_OK(CacheServer::CreateInstance(top_, num_workers_, port_, shared_memory_sz_in_gb_,
+                                                   memory_cap_ratio_, evict_policy_, pin_epochs_, compress_, persist_));
       return Status::OK();
     }
 
@@ -123,6 +147,10 @@ class CacheServer : public Service {
     int32_t port_;
     int32_t shared_memory_sz_in_gb_;
     float memory_cap_ratio_;
+    CacheEvictPolicy evict_policy_;
+    int32_t pin_epochs_;
+    bool compress_;
+    bool persist_;
 
     /// \brief Sanity checks on the shared memory.
     /// \return Status object
@@ -138,11 +166,13 @@ class CacheServer : public Service {
   ~CacheServer() override { (void)ServiceStop(); }
 
   static Status CreateInstance(const std::string &spill_path, int32_t num_workers, int32_t port,
-                               int32_t shared_memory_sz, float memory_cap_ratio) {
+                               int32_t shared_memory_sz, float memory_cap_ratio,
+                               CacheEvictPolicy evict_policy = CacheEvictPolicy::kEvictNone,
+                               int32_t pin_epochs = kDefaultPinEpochs, bool compress = false, bool persist = false) {
     std::call_once(init_instance_flag_, [&]() -> Status {
       auto &SvcManager = Services::GetInstance();
-      RETURN_IF_NOT_OK(
-        SvcManager.AddHook(&instance_, spill_path, num_workers, port, shared_memory_sz, memory_cap_ratio));
+      RETURN_IF_NOT_OK(SvcManager.AddHook(&instance_, spill_path, num_workers, port, shared_memory_sz,
+                                          memory_cap_ratio, evict_policy, pin_epochs, compress, persist));
       return Status::OK();
     });
     return Status::OK();
@@ -201,6 +231,18 @@ class CacheServer : public Service {
   /// \brief Return the memory cap ratio
   float GetMemoryCapRatio() const { return memory_cap_ratio_; }
 
+  /// \brief What the caches do with the rows in memory once their memory is full
+  CacheEvictPolicy GetEvictPolicy() const { return evict_policy_; }
+
+  /// \brief Number of epochs kEvictPinHotSet watches before it pins the rows in memory
+  int32_t GetPinEpochs() const { return pin_epochs_; }
+
+  /// \brief Check if the caches keep the rows compressed
+  bool IsCompressionOn() const { return compress_; }
+
+  /// \brief Check if the caches spilled to disk are checkpointed periodically and at shutdown, and restored at startup
+  bool IsPersistenceOn() const { return persist_; }
+
   /// \brief How a request is handled.
   /// \note that it can be process immediately by a grpc thread or routed to a server thread
   /// which is pinned to some numa node core.
@@ -242,17 +284,23 @@ class CacheServer : public Service {
   int32_t shared_memory_sz_in_gb_;
   std::atomic<bool> global_shutdown_;
   float memory_cap_ratio_;
+  CacheEvictPolicy evict_policy_;
+  int32_t pin_epochs_;
+  bool compress_;
+  bool persist_;
   std::shared_ptr<CacheServerHW> hw_info_;
   std::map<worker_id_t, Task *> numa_tasks_;
   bool numa_affinity_;
   std::vector<int32_t> shutdown_qIDs_;
   std::unique_ptr<CachedSharedMemory> shm_;
+  std::unique_ptr<SharedRequestQueue> local_q_;
 
   /// \brief Constructor
   /// \param spill_path Top directory for spilling buffers to.
   /// \param num_workers Number of threads for handling requests.
   explicit CacheServer(const std::string &spill_path, int32_t num_workers, int32_t port, int32_t share_memory_sz_in_gb,
-                       float memory_cap_ratio);
+                       float memory_cap_ratio, CacheEvictPolicy evict_policy, int32_t pin_epochs, bool compress,
+                       bool persist);
 
   /// \brief Locate a cache service from connection id.
   /// \return Pointer to cache service. Null if not found
@@ -276,6 +324,15 @@ class CacheServer : public Service {
   /// \return
   Status RpcRequest(worker_id_t worker_id);
 
+  /// \brief Entry point for the threads polling the shared request queue of the local clients.
+  /// Each thread polls its own share of the slots.
+  /// \return Status object
+  Status LocalRequest(worker_id_t worker_id);
+
+  /// \brief Write the reply of a request coming from the shared request queue back into its slot.
+  /// \return Status object
+  Status ReplyLocalRequest(CacheServerRequest *cache_req);
+
   Status DestroySession(CacheRequest *rq);
 
   /// \brief Create a connection id from a session id and a crc
@@ -293,6 +350,24 @@ class CacheServer : public Service {
   /// \return Session ID
   session_id_type GenerateSessionID();
 
+  /// \brief Name of the spill folder of a cache which can be checkpointed. It is derived from the port and the
+  /// connection id so that the same cache is found again after a restart.
+  std::string PersistentCacheName(connection_id_type connection_id) const;
+
+  /// \brief Bring back the caches (and their sessions) checkpointed by the last server on the same port
+  /// \return Status object
+  Status RestoreCaches();
+
+  /// \brief Entry point of the thread which checkpoints the changed caches every kCheckpointInterval seconds, so
+  /// that they survive a server which goes down without a clean shutdown.
+  /// \return Status object
+  Status CheckpointCaches();
+
+  /// \brief Checkpoint one cache and log the outcome
+  /// \note The caller must hold the lock of the cache exclusively.
+  /// \return Status object
+  Status CheckpointCache(connection_id_type id, CacheService *cs);
+
   /// \brief Handle kAllocateSharedBlock request
   /// \param rq CacheRequest
   /// \param reply CacheReply
@@ -366,9 +441,16 @@ class CacheServer : public Service {
       rc_lists_.reserve(expected_);
     }
 
-    Status Set(Status rc) {
+    /// \param rc Return code of the internal request
+    /// \param row Position of the row in the batch. A row evicted since it was looked up (kFileNotExist) is
+    /// remembered as a miss instead of failing the batch.
+    Status Set(Status rc, int64_t row = -1) {
       CHECK_FAIL_RETURN_UNEXPECTED(expected_ > num_back_, "Programming error");
       std::unique_lock<std::mutex> lck(mux_);
+      if (rc.get_code() == StatusCode::kFileNotExist && row >= 0) {
+        missing_rows_.push_back(row);
+        rc = Status::OK();
+      }
       rc_lists_.push_back(std::move(rc));
       ++num_back_;
       if (num_back_ == expected_) {
@@ -389,12 +471,19 @@ class CacheServer : public Service {
       return rc;
     }
 
+    /// \brief Rows evicted since they were looked up, in ascending order
+    std::vector<int64_t> GetMissingRows() {
+      std::sort(missing_rows_.begin(), missing_rows_.end());
+      return missing_rows_;
+    }
+
    private:
     std::mutex mux_;
     WaitPost wp_;
     int64_t expected_;
     int64_t num_back_;
     std::vector<Status> rc_lists_;
+    std::vector<int64_t> missing_rows_;
   };
 
   /// \brief Internal function to do row batch fetch
@@ -405,6 +494,7 @@ class CacheServer : public Service {
 
   /// \brief Main function to fetch rows in batch. The output is a contiguous memory which will be decoded
   /// by the CacheClient. Cache miss is not an error, and will be coded in the output to mark an empty row.
+  /// So is a row evicted after it was looked up. The rows after it are moved up and the output shrinks.
   /// \param[in] v A vector of row id.
   /// \param[out] out A contiguous memory buffer that holds the requested rows.
   /// \return Status object
@@ -13,6 +13,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
 */
+#include <cstdio>
+#include <fstream>
 #include <random>
 #include "minddata/dataset/engine/cache/cache_service.h"
 #include "minddata/dataset/engine/cache/cache_server.h"
@@ -22,8 +24,27 @@
 
 namespace mindspore {
 namespace dataset {
-CacheService::CacheService(uint64_t mem_sz, const std::string &root, bool generate_id)
+namespace {
+// The service information saved by Checkpoint next to the index of the CachePool. The schema follows the header.
+// Bump the version whenever the header changes.
+const char kServiceCheckpoint[] = "SERVICE.ckpt";
+constexpr uint32_t kServiceCheckpointMagic = 0x4d534353;
+constexpr uint32_t kServiceCheckpointVersion = 2;
+struct ServiceCheckpointHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_sz;
+  int32_t generate_id;
+  connection_id_type connection_id;
+  uint64_t cache_mem_sz;
+  row_id_type next_id;
+  uint64_t schema_sz;
+};
+}  // namespace
+
+CacheService::CacheService(uint64_t mem_sz, const std::string &root, bool generate_id, const std::string &name)
     : root_(root),
+      name_(name),
       cache_mem_sz_(mem_sz * 1048576L),  // mem_sz is in MB unit
       cp_(nullptr),
       next_id_(0),
@@ -50,8 +71,10 @@ Status CacheService::DoServiceStart() {
   if (avail_nodes.empty()) {
     RETURN_STATUS_UNEXPECTED("Unable to bring up numa memory pool");
   }
-  // Put together a CachePool for backing up the Tensor.
-  cp_ = std::make_shared<CachePool>(numa_pool_, root_);
+  // Put together a CachePool for backing up the Tensor. Rows can only be dropped from memory if the client can
+  // read them again from the source, i.e. there is no build phase.
+  cp_ = std::make_shared<CachePool>(numa_pool_, root_, cs.GetEvictPolicy(), cs.GetPinEpochs(), cs.IsCompressionOn(),
+                                    !HasBuildPhase(), name_);
   RETURN_IF_NOT_OK(cp_->ServiceStart());
   // Assign a name to this cache. Used for exclusive connection. But we can just use CachePool's name.
   cookie_ = cp_->MyName();
@@ -267,6 +290,7 @@ Status CacheService::InternalFetchRow(const FetchRowMsg *p) {
     ReadableSlice src(source_addr, sz);
     RETURN_IF_NOT_OK(WritableSlice::Copy(&dest, src));
   } else {
+    // kFileNotExist if the row was evicted after the client looked it up. BatchFetch sends it back as a miss.
     RETURN_IF_NOT_OK(cp_->Read(key, &dest, &bytesRead));
     if (bytesRead != sz) {
       std::string errMsg = "Unexpected length. Read " + std::to_string(bytesRead) + ". Expected " + std::to_string(sz) +
@@ -341,5 +365,63 @@ Status CacheService::ToggleWriteMode(bool on_off) {
   }
   return Status::OK();
 }
+
+Status CacheService::Checkpoint(connection_id_type connection_id) {
+  // The next job can't rebuild the missing rows of a cache with a build phase.
+  if (HasBuildPhase() && st_ != CacheServiceState::kFetchPhase) {
+    RETURN_STATUS_UNEXPECTED("Cache is not completely built. Current phase: " +
+                             std::to_string(static_cast<int>(st_.load())));
+  }
+  RETURN_IF_NOT_OK(cp_->Checkpoint());
+  Path checkpoint = GetSpillPath() / kServiceCheckpoint;
+  std::string tmp = checkpoint.toString() + ".tmp";
+  ServiceCheckpointHeader hdr{kServiceCheckpointMagic, kServiceCheckpointVersion, sizeof(ServiceCheckpointHeader),
+                              generate_id_ ? 1 : 0, connection_id, cache_mem_sz_, next_id_.load(), schema_.size()};
+  std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+  out.write(schema_.data(), schema_.size());
+  out.close();
+  CHECK_FAIL_RETURN_UNEXPECTED(out.good(), "Unable to write " + tmp);
+  CHECK_FAIL_RETURN_UNEXPECTED(rename(tmp.data(), checkpoint.toString().data()) == 0,
+                               "Unable to rename " + tmp + ". Errno = " + std::to_string(errno));
+  return Status::OK();
+}
+
+Status CacheService::Restore(const std::string &root, const std::string &name, connection_id_type *connection_id,
+                             std::unique_ptr<CacheService> *out) {
+  RETURN_UNEXPECTED_IF_NULL(connection_id);
+  RETURN_UNEXPECTED_IF_NULL(out);
+  Path checkpoint = Path(root) / name / kServiceCheckpoint;
+  std::ifstream in(checkpoint.toString(), std::ios::binary);
+  CHECK_FAIL_RETURN_UNEXPECTED(in.good(), "Unable to open " + checkpoint.toString());
+  ServiceCheckpointHeader hdr{0, 0, 0, 0, 0, 0, 0, 0};
+  in.read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+  CHECK_FAIL_RETURN_UNEXPECTED(in.good() && hdr.magic == kServiceCheckpointMagic,
+                               "Invalid checkpoint " + checkpoint.toString());
+  CHECK_FAIL_RETURN_UNEXPECTED(hdr.version == kServiceCheckpointVersion && hdr.header_sz == sizeof(hdr),
+                               "Checkpoint " + checkpoint.toString() + " has version " + std::to_string(hdr.version) +
+                                 ". Expected " + std::to_string(kServiceCheckpointVersion));
+  // The schema must fill up the rest of the file exactly.
+  in.seekg(0, std::ios::end);
+  CHECK_FAIL_RETURN_UNEXPECTED(static_cast<uint64_t>(in.tellg()) == sizeof(hdr) + hdr.schema_sz,
+                               "Size mismatch in checkpoint " + checkpoint.toString());
+  in.seekg(sizeof(hdr));
+  std::string schema(hdr.schema_sz, '\0');
+  in.read(&schema[0], schema.size());
+  CHECK_FAIL_RETURN_UNEXPECTED(in.good(), "Truncated checkpoint " + checkpoint.toString());
+  // The constructor takes the memory size in MB.
+  auto cs = std::make_unique<CacheService>(hdr.cache_mem_sz / 1048576L, root, hdr.generate_id != 0, name);
+  RETURN_IF_NOT_OK(cs->ServiceStart());
+  cs->next_id_ = hdr.next_id;
+  cs->schema_ = std::move(schema);
+  if (cs->HasBuildPhase()) {
+    // Only a built cache is saved. Same as BuildPhaseDone.
+    cs->st_ = CacheServiceState::kFetchPhase;
+    cs->cp_->SetLocking(false);
+  }
+  *connection_id = hdr.connection_id;
+  *out = std::move(cs);
+  return Status::OK();
+}
 }  // namespace dataset
 }  // namespace mindspore
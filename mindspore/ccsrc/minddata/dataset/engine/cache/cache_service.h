@@ -49,7 +49,8 @@ class CacheService : public Service {
   /// \param root Spill path. Empty string means no spilling
   /// \param generate_id If the cache service should generate row id for buffer that is cached.
   /// For non-mappable dataset, this should be set to true.
-  CacheService(uint64_t mem_sz, const std::string &root, bool generate_id);
+  /// \param name Name of the spill folder under root which is also the cookie. A unique one is generated if empty.
+  CacheService(uint64_t mem_sz, const std::string &root, bool generate_id, const std::string &name = "");
   ~CacheService() override;
 
   Status DoServiceStart() override;
@@ -123,10 +124,31 @@ class CacheService : public Service {
   Status BuildPhaseDone();
   /// \brief For kToggleWriteMode request
   Status ToggleWriteMode(bool on_off);
+  /// \brief Save the cache into its spill folder so that it can be restored by a server started later.
+  /// A cache with a build phase is only saved once it is built.
+  /// \note The caller must hold the lock of this cache exclusively.
+  /// \param connection_id Connection id of this cache
+  /// \return Status object
+  Status Checkpoint(connection_id_type connection_id);
+  /// \brief True if the cache has changed since the last Checkpoint and can be saved now
+  bool NeedsCheckpoint() const {
+    return cp_->Modified() && (!HasBuildPhase() || st_ == CacheServiceState::kFetchPhase);
+  }
+  /// \brief Keep the last checkpoint when the cache is stopped. Otherwise the spill folder is removed with it.
+  void Persist() { cp_->Persist(); }
+  /// \brief Restore a cache saved by Checkpoint
+  /// \param[in] root Spill path given to the saved cache
+  /// \param[in] name Name of the spill folder of the saved cache
+  /// \param[out] connection_id Connection id of the saved cache
+  /// \param[out] out The restored cache service which has been started
+  /// \return Status object
+  static Status Restore(const std::string &root, const std::string &name, connection_id_type *connection_id,
+                        std::unique_ptr<CacheService> *out);
 
  private:
   mutable RWLock rw_lock_;
   std::string root_;
+  std::string name_;
   uint64_t cache_mem_sz_;
   std::shared_ptr<CachePool> cp_;
   std::atomic<row_id_type> next_id_;
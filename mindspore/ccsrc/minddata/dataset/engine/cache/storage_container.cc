@@ -120,6 +120,9 @@ Status StorageContainer::Insert(const std::vector<ReadableSlice> &buf, off64_t *
   if (sz == 0) {
     RETURN_STATUS_UNEXPECTED("Unexpected 0 length");
   }
+  if (bs_ == nullptr) {
+    RETURN_STATUS_UNEXPECTED("Container " + cont_.toString() + " is read only");
+  }
   if (sz > bs_->GetMaxSize()) {
     RETURN_STATUS_UNEXPECTED("Request size too big");
   }
@@ -149,7 +152,10 @@ StorageContainer::~StorageContainer() noexcept {
 }
 
 std::ostream &operator<<(std::ostream &os, const StorageContainer &s) {
-  os << "File path : " << s.cont_ << "\n" << *(s.bs_.get());
+  os << "File path : " << s.cont_ << "\n";
+  if (s.bs_ != nullptr) {
+    os << *(s.bs_.get());
+  }
   return os;
 }
 
@@ -167,5 +173,22 @@ Status StorageContainer::CreateStorageContainer(std::shared_ptr<StorageContainer
   }
   return rc;
 }
+
+Status StorageContainer::OpenStorageContainer(std::shared_ptr<StorageContainer> *out_sc, const std::string &path) {
+  Status rc;
+  auto sc = new (std::nothrow) StorageContainer(path);
+  if (sc == nullptr) {
+    return Status(StatusCode::kOutOfMemory);
+  }
+  // No BuddySpace. We don't know which part of the file is free.
+  rc = sc->Open();
+  if (rc.IsOk()) {
+    (*out_sc).reset(sc);
+    MS_LOG(INFO) << "Container " << path << " reopened";
+  } else {
+    delete sc;
+  }
+  return rc;
+}
 }  // namespace dataset
 }  // namespace mindspore
@@ -60,6 +60,9 @@ class StorageContainer {
 
   static Status CreateStorageContainer(std::shared_ptr<StorageContainer> *out_sc, const std::string &path);
 
+  /// \brief Open a container written by an earlier process. It can only be read from.
+  static Status OpenStorageContainer(std::shared_ptr<StorageContainer> *out_sc, const std::string &path);
+
  private:
   mutable std::mutex mutex_;
   Path cont_;
@@ -37,10 +37,14 @@ std::string StorageManager::ConstructFileName(const std::string &prefix, int32_t
   return (base_name + "." + suffix);
 }
 
-Status StorageManager::AddOneContainer() {
+Path StorageManager::ContainerPath(int32_t file_id) {
   const std::string kPrefix = "IMG";
   const std::string kSuffix = "LB";
-  Path container_name = root_ / ConstructFileName(kPrefix, file_id_, kSuffix);
+  return root_ / ConstructFileName(kPrefix, file_id, kSuffix);
+}
+
+Status StorageManager::AddOneContainer() {
+  Path container_name = ContainerPath(file_id_);
   std::shared_ptr<StorageContainer> sc;
   RETURN_IF_NOT_OK(StorageContainer::CreateStorageContainer(&sc, container_name.toString()));
   containers_.push_back(sc);
@@ -48,9 +52,22 @@ Status StorageManager::AddOneContainer() {
   return Status::OK();
 }
 
+Status StorageManager::OpenOneContainer() {
+  Path container_name = ContainerPath(file_id_);
+  std::shared_ptr<StorageContainer> sc;
+  RETURN_IF_NOT_OK(StorageContainer::OpenStorageContainer(&sc, container_name.toString()));
+  containers_.push_back(sc);
+  file_id_++;
+  return Status::OK();
+}
+
 Status StorageManager::DoServiceStart() {
   containers_.reserve(1000);
   if (root_.IsDirectory()) {
+    // The reopened containers are read only. New buffers always go to the last container which is a new one.
+    for (int32_t i = 0; i < num_existing_; ++i) {
+      RETURN_IF_NOT_OK(OpenOneContainer());
+    }
     RETURN_IF_NOT_OK(AddOneContainer());
   } else {
     RETURN_STATUS_UNEXPECTED("Not a directory");
@@ -138,13 +155,38 @@ Status StorageManager::Read(StorageManager::key_type key, WritableSlice *dest, s
   return Status::OK();
 }
 
+Status StorageManager::Locate(key_type key, value_type *out) const {
+  RETURN_UNEXPECTED_IF_NULL(out);
+  auto r = index_.Search(key);
+  if (!r.second) {
+    RETURN_STATUS_UNEXPECTED("Key not found");
+  }
+  *out = *(r.first);
+  return Status::OK();
+}
+
+Status StorageManager::Restore(const value_type &value, key_type *out_key) {
+  RETURN_UNEXPECTED_IF_NULL(out_key);
+  int container_inx = value.first;
+  if (container_inx < 0 || container_inx >= num_existing_) {
+    RETURN_STATUS_UNEXPECTED("Container " + std::to_string(container_inx) + " was not reopened");
+  }
+  RETURN_IF_NOT_OK(index_.insert(value, out_key));
+  return Status::OK();
+}
+
+int32_t StorageManager::NumContainers() {
+  SharedLock lock_s(&rw_lock_);
+  return static_cast<int32_t>(containers_.size());
+}
+
 Status StorageManager::DoServiceStop() noexcept {
   Status rc;
   Status rc1;
   for (auto const &p : containers_) {
     // The destructor of StorageContainer is not called automatically until the use
     // count drops to 0. But it is not always the case. We will do it ourselves.
-    rc = p.get()->Truncate();
+    rc = keep_files_ ? p.get()->Close() : p.get()->Truncate();
     if (rc.IsError()) {
       rc1 = rc;
     }
@@ -154,7 +196,8 @@ Status StorageManager::DoServiceStop() noexcept {
   return rc1;
 }
 
-StorageManager::StorageManager(const Path &root) : root_(root), file_id_(0), index_() {}
+StorageManager::StorageManager(const Path &root, int32_t num_existing)
+    : root_(root), file_id_(0), num_existing_(num_existing), keep_files_(false), index_() {}
 
 StorageManager::~StorageManager() { (void)StorageManager::DoServiceStop(); }
 
@@ -39,7 +39,10 @@ class StorageManager : public Service {
   using key_type = storage_index::key_type;
   using value_type = storage_index::value_type;
 
-  explicit StorageManager(const Path &);
+  /// \brief Constructor
+  /// \param root Folder of the containers
+  /// \param num_existing Number of containers left in the folder by an earlier process to be reopened for reading
+  explicit StorageManager(const Path &root, int32_t num_existing = 0);
 
   ~StorageManager() override;
 
@@ -51,6 +54,24 @@ class StorageManager : public Service {
 
   Status Read(key_type key, WritableSlice *dest, size_t *bytesRead) const;
 
+  /// \brief Find out where a buffer is stored
+  /// \param[in] key A key returned from Write or Restore
+  /// \param[out] out Container number, offset and size of the buffer
+  /// \return Status object
+  Status Locate(key_type key, value_type *out) const;
+
+  /// \brief Index a buffer written by an earlier process into one of the reopened containers
+  /// \param[in] value Container number, offset and size of the buffer as returned from Locate
+  /// \param[out] out_key A new key of the buffer
+  /// \return Status object
+  Status Restore(const value_type &value, key_type *out_key);
+
+  /// \brief Number of containers including the reopened ones
+  int32_t NumContainers();
+
+  /// \brief Close the containers instead of truncating them when the service stops
+  void KeepFiles() { keep_files_ = true; }
+
   Status DoServiceStart() override;
 
   Status DoServiceStop() noexcept override;
@@ -61,6 +82,8 @@ class StorageManager : public Service {
   Path root_;
   ListOfContainers containers_;
   int file_id_;
+  int32_t num_existing_;
+  bool keep_files_;
   RWLock rw_lock_;
   storage_index index_;
 
@@ -68,7 +91,11 @@ class StorageManager : public Service {
 
   std::string ConstructFileName(const std::string &prefix, int32_t file_id, const std::string &suffix);
 
+  Path ContainerPath(int32_t file_id);
+
   Status AddOneContainer();
+
+  Status OpenOneContainer();
 };
 }  // namespace dataset
 }  // namespace mindspore
@@ -35,6 +35,7 @@ class CacheClientGreeter : public Service {
   void *SharedMemoryBaseAddr() { return nullptr; }
   Status HandleRequest(std::shared_ptr<BaseRequest> rq) { RETURN_STATUS_UNEXPECTED("Not supported"); }
   Status AttachToSharedMemory(bool *local_bypass) { RETURN_STATUS_UNEXPECTED("Not supported"); }
+  void FreeSharedBlock(connection_id_type connection_id, int32_t client_id, int64_t addr) {}
 
  protected:
  private:
@@ -24,6 +24,7 @@
 #include "minddata/dataset/engine/datasetops/dataset_op.h"
 #include "minddata/dataset/engine/datasetops/shuffle_op.h"
 #include "minddata/dataset/engine/datasetops/device_queue_op.h"
+#include "minddata/dataset/util/numa_pool.h"
 #include "minddata/dataset/util/task_manager.h"
 #include "minddata/dataset/engine/opt/pass.h"
 #include "minddata/dataset/engine/opt/pre/removal_pass.h"
@@ -154,8 +155,11 @@ Status ExecutionTree::Launch() {
   // numa_bind_id = rank_id_ % (numa_max_node() + 1)
   // Now we only test pass in GPU scenario, we've not tested D scenario,
   // without enough test we don't suggest numa feature open in D scenario
+  // A numa aware pipeline spreads its workers over all the nodes, so skip the process level bind.
   int numa_node_max_id = numa_max_node();
-  if (numa_node_max_id >= 0 && rank_id_ >= 0) {
+  if (GlobalContext::config_manager()->numa_aware()) {
+    MS_LOG(INFO) << "Numa aware pipeline, skip the process level numa bind.";
+  } else if (numa_node_max_id >= 0 && rank_id_ >= 0) {
     uint32_t numa_bind_id = static_cast<uint32_t>(rank_id_ % (numa_node_max_id + 1));
     auto bm = numa_allocate_nodemask();
     numa_bitmask_clearall(bm);
@@ -243,8 +247,27 @@ Status ExecutionTree::LaunchWorkers(int32_t num_workers, std::function<Status(ui
     MS_LOG(WARNING) << name + " is launched with " << std::to_string(num_workers) << " worker threads which exceeds "
                     << std::to_string(num_cpu_threads) << ", the maximum number of threads on this CPU.";
   }
+  // In a numa aware pipeline, worker i of every op runs on node (i % number of nodes), and the tensors it
+  // produces are allocated from the memory of that node (see GlobalContext::mem_pool). This keeps the work of
+  // each worker local. It doesn't keep a row on one node from op to op: the ops deal their buffers to the
+  // workers round robin, and the connectors need that order, so a row moves whenever the worker that
+  // produced it and the one that consumes it are on different nodes.
+  const auto &numa_nodes = GetNumaNodes();
+  int32_t num_numa_nodes = GlobalContext::config_manager()->numa_aware() ? GetNumaNodeCount() : 1;
   for (int32_t i = 0; i < num_workers; ++i) {
-    RETURN_IF_NOT_OK(tg_->CreateAsyncTask(name, std::bind(func, i)));
+    if (num_numa_nodes > 1) {
+      int32_t numa_node = numa_nodes[i % num_numa_nodes];
+      RETURN_IF_NOT_OK(tg_->CreateAsyncTask(name, [func, i, numa_node, name]() -> Status {
+        Status rc = BindThreadToNumaNode(numa_node);
+        if (rc.IsError()) {
+          MS_LOG(WARNING) << name << " worker " << i << " is not bound to numa node " << numa_node << ". "
+                          << rc.ToString();
+        }
+        return func(i);
+      }));
+    } else {
+      RETURN_IF_NOT_OK(tg_->CreateAsyncTask(name, std::bind(func, i)));
+    }
   }
   return Status::OK();
 }
@@ -0,0 +1,193 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/util/lz4_block.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace mindspore {
+namespace dataset {
+namespace {
+// Constants of the LZ4 block format.
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchFindLimit = 12;
+constexpr size_t kMaxDistance = 65535;
+constexpr uint8_t kLengthMask = 15;
+constexpr int kMatchLengthBits = 4;
+constexpr uint8_t kLengthExtension = 255;
+constexpr int kHashLog = 12;
+
+uint32_t Read32(const uint8_t *p) {
+  uint32_t v;
+  (void)memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t Hash(uint32_t v) { return (v * 2654435761U) >> (32 - kHashLog); }
+
+// Writes the part of a length that does not fit into the nibble of the token.
+bool PutLength(size_t len, uint8_t **op, const uint8_t *oend) {
+  while (len >= kLengthExtension) {
+    if (*op >= oend) {
+      return false;
+    }
+    *(*op)++ = kLengthExtension;
+    len -= kLengthExtension;
+  }
+  if (*op >= oend) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(len);
+  return true;
+}
+
+bool GetLength(const uint8_t **ip, const uint8_t *iend, size_t *len) {
+  uint8_t b;
+  do {
+    if (*ip >= iend) {
+      return false;
+    }
+    b = *(*ip)++;
+    *len += b;
+  } while (b == kLengthExtension);
+  return true;
+}
+
+// Writes one sequence, i.e. the literals followed by a match. The last sequence of a block has no match.
+bool PutSequence(const uint8_t *literals, size_t lit_len, size_t offset, size_t match_len, bool last, uint8_t **op,
+                 const uint8_t *oend) {
+  if (*op >= oend) {
+    return false;
+  }
+  uint8_t *token = (*op)++;
+  *token = static_cast<uint8_t>((lit_len >= kLengthMask ? kLengthMask : lit_len) << kMatchLengthBits);
+  if (lit_len >= kLengthMask && !PutLength(lit_len - kLengthMask, op, oend)) {
+    return false;
+  }
+  if (static_cast<size_t>(oend - *op) < lit_len) {
+    return false;
+  }
+  (void)memcpy(*op, literals, lit_len);
+  *op += lit_len;
+  if (last) {
+    return true;
+  }
+  if (oend - *op < 2) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(offset & 0xff);
+  *(*op)++ = static_cast<uint8_t>(offset >> 8);
+  *token |= static_cast<uint8_t>(match_len >= kLengthMask ? kLengthMask : match_len);
+  return match_len < kLengthMask || PutLength(match_len - kLengthMask, op, oend);
+}
+}  // namespace
+
+size_t Lz4CompressBound(size_t sz) { return sz + sz / kLengthExtension + 16; }
+
+size_t Lz4Compress(const ReadableSlice &src, WritableSlice *dest) {
+  if (dest == nullptr) {
+    return 0;
+  }
+  const auto *base = static_cast<const uint8_t *>(src.GetPointer());
+  const uint8_t *iend = base + src.GetSize();
+  const uint8_t *ip = base;
+  const uint8_t *anchor = base;
+  auto *ostart = static_cast<uint8_t *>(dest->GetMutablePointer());
+  uint8_t *op = ostart;
+  const uint8_t *oend = ostart + dest->GetSize();
+  if (src.GetSize() > kMatchFindLimit) {
+    // Position of the last occurrence of each hashed 4 bytes sequence.
+    std::vector<uint32_t> table(1u << kHashLog, 0);
+    const uint8_t *mflimit = iend - kMatchFindLimit;
+    const uint8_t *match_limit = iend - kLastLiterals;
+    while (ip < mflimit) {
+      uint32_t h = Hash(Read32(ip));
+      const uint8_t *ref = base + table[h];
+      table[h] = static_cast<uint32_t>(ip - base);
+      if (ref >= ip || static_cast<size_t>(ip - ref) > kMaxDistance || Read32(ref) != Read32(ip)) {
+        ++ip;
+        continue;
+      }
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        --ip;
+        --ref;
+      }
+      const uint8_t *match_end = ip + kMinMatch;
+      const uint8_t *ref_end = ref + kMinMatch;
+      while (match_end < match_limit && *match_end == *ref_end) {
+        ++match_end;
+        ++ref_end;
+      }
+      size_t match_len = static_cast<size_t>(match_end - ip) - kMinMatch;
+      if (!PutSequence(anchor, ip - anchor, ip - ref, match_len, false, &op, oend)) {
+        return 0;
+      }
+      ip = match_end;
+      anchor = ip;
+    }
+  }
+  if (!PutSequence(anchor, iend - anchor, 0, 0, true, &op, oend)) {
+    return 0;
+  }
+  return op - ostart;
+}
+
+Status Lz4Decompress(const ReadableSlice &src, WritableSlice *dest) {
+  RETURN_UNEXPECTED_IF_NULL(dest);
+  const auto *ip = static_cast<const uint8_t *>(src.GetPointer());
+  const uint8_t *iend = ip + src.GetSize();
+  auto *ostart = static_cast<uint8_t *>(dest->GetMutablePointer());
+  uint8_t *op = ostart;
+  const uint8_t *oend = ostart + dest->GetSize();
+  const std::string errMsg = "Corrupted lz4 block";
+  while (ip < iend) {
+    uint8_t token = *ip++;
+    size_t lit_len = token >> kMatchLengthBits;
+    if (lit_len == kLengthMask) {
+      CHECK_FAIL_RETURN_UNEXPECTED(GetLength(&ip, iend, &lit_len), errMsg);
+    }
+    CHECK_FAIL_RETURN_UNEXPECTED(static_cast<size_t>(iend - ip) >= lit_len, errMsg);
+    CHECK_FAIL_RETURN_UNEXPECTED(static_cast<size_t>(oend - op) >= lit_len, errMsg);
+    (void)memcpy(op, ip, lit_len);
+    ip += lit_len;
+    op += lit_len;
+    if (ip == iend) {
+      break;
+    }
+    CHECK_FAIL_RETURN_UNEXPECTED(iend - ip >= 2, errMsg);
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    CHECK_FAIL_RETURN_UNEXPECTED(offset != 0 && offset <= static_cast<size_t>(op - ostart), errMsg);
+    size_t match_len = token & kLengthMask;
+    if (match_len == kLengthMask) {
+      CHECK_FAIL_RETURN_UNEXPECTED(GetLength(&ip, iend, &match_len), errMsg);
+    }
+    match_len += kMinMatch;
+    CHECK_FAIL_RETURN_UNEXPECTED(static_cast<size_t>(oend - op) >= match_len, errMsg);
+    // The match may overlap with the bytes being written, so copy byte by byte.
+    const uint8_t *match = op - offset;
+    for (size_t i = 0; i < match_len; ++i) {
+      op[i] = match[i];
+    }
+    op += match_len;
+  }
+  CHECK_FAIL_RETURN_UNEXPECTED(op == oend, "Size mismatch after lz4 decompression");
+  return Status::OK();
+}
+}  // namespace dataset
+}  // namespace mindspore
@@ -0,0 +1,47 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_LZ4_BLOCK_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_LZ4_BLOCK_H_
+
+#include <cstddef>
+#include "minddata/dataset/util/slice.h"
+#include "minddata/dataset/util/status.h"
+
+namespace mindspore {
+namespace dataset {
+/// \brief A small codec of the LZ4 block format. It favours speed over ratio and is meant for data that is
+/// compressed once and decompressed many times, e.g. rows kept by the cache server. The output is a raw block
+/// without frame header, so the caller must remember the original size.
+
+/// \brief Largest size a block of the given size can grow to.
+/// \param sz Size of the uncompressed block
+/// \return Size of the buffer to be given to Lz4Compress so that it never fails
+size_t Lz4CompressBound(size_t sz);
+
+/// \brief Compress a block
+/// \param[in] src Data to compress
+/// \param[out] dest Destination buffer
+/// \return Number of bytes written to dest. 0 if the compressed block does not fit into dest.
+size_t Lz4Compress(const ReadableSlice &src, WritableSlice *dest);
+
+/// \brief Decompress a block
+/// \param[in] src Compressed block
+/// \param[out] dest Destination buffer. Its size must be the exact size of the uncompressed block.
+/// \return Status object
+Status Lz4Decompress(const ReadableSlice &src, WritableSlice *dest);
+}  // namespace dataset
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_LZ4_BLOCK_H_
@@ -0,0 +1,170 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/util/numa_pool.h"
+#ifdef NUMA_ENABLED
+#include <numa.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include "minddata/dataset/util/log_adapter.h"
+#include "./securec.h"
+
+namespace mindspore {
+namespace dataset {
+namespace {
+thread_local int32_t g_thread_numa_node = -1;
+}  // namespace
+
+const std::vector<int32_t> &GetNumaNodes() {
+  static const std::vector<int32_t> nodes = []() {
+    std::vector<int32_t> v;
+#ifdef NUMA_ENABLED
+    // numa_max_node() is the highest node id of the machine. Not all the ids below it have to exist, and
+    // the cpuset of the process may not allow all of those which do.
+    if (numa_available() >= 0) {
+      struct bitmask *allowed = numa_get_mems_allowed();
+      for (int32_t i = 0; i <= numa_max_node(); ++i) {
+        if (numa_bitmask_isbitset(allowed, i)) {
+          v.push_back(i);
+        }
+      }
+      numa_bitmask_free(allowed);
+    }
+#endif
+    if (v.empty()) {
+      v.push_back(0);
+    }
+    return v;
+  }();
+  return nodes;
+}
+
+int32_t GetNumaNodeCount() { return static_cast<int32_t>(GetNumaNodes().size()); }
+
+Status BindThreadToNumaNode(int32_t numa_node) {
+  const auto &nodes = GetNumaNodes();
+  CHECK_FAIL_RETURN_UNEXPECTED(std::find(nodes.begin(), nodes.end(), numa_node) != nodes.end(),
+                               "Invalid numa node " + std::to_string(numa_node));
+#ifdef NUMA_ENABLED
+  if (numa_available() >= 0) {
+    // Both calls only affect the calling thread.
+    if (numa_run_on_node(numa_node) != 0) {
+      RETURN_STATUS_UNEXPECTED("Fail to bind thread to numa node " + std::to_string(numa_node) + ". Errno " +
+                               std::to_string(errno));
+    }
+    numa_set_preferred(numa_node);
+  }
+#endif
+  g_thread_numa_node = numa_node;
+  return Status::OK();
+}
+
+int32_t GetThreadNumaNode() { return g_thread_numa_node; }
+
+NumaPool::NumaPool(int32_t numa_node, int64_t arena_size_in_mb)
+    : numa_node_(numa_node), arena_size_(arena_size_in_mb * 1048576L), ptr_(nullptr) {}
+
+NumaPool::~NumaPool() {
+  impl_.reset();
+#ifdef NUMA_ENABLED
+  if (ptr_ != nullptr) {
+    numa_free(ptr_, arena_size_);
+  }
+#endif
+  ptr_ = nullptr;
+}
+
+Status NumaPool::InitArena() {
+#ifdef NUMA_ENABLED
+  if (numa_available() >= 0 && arena_size_ > 0) {
+    ptr_ = numa_alloc_onnode(arena_size_, numa_node_);
+    if (ptr_ != nullptr) {
+      impl_ = std::make_unique<ArenaImpl>(ptr_, arena_size_);
+      MS_LOG(DEBUG) << "Reserve " << arena_size_ << " bytes on numa node " << numa_node_;
+      return Status::OK();
+    }
+    MS_LOG(WARNING) << "Unable to reserve " << arena_size_ << " bytes on numa node " << numa_node_
+                    << ". Use system memory instead.";
+  }
+#endif
+  // Don't try again.
+  arena_size_ = 0;
+  return Status::OK();
+}
+
+bool NumaPool::InArena(const void *p) const {
+  auto *base = static_cast<const char *>(ptr_);
+  auto *q = static_cast<const char *>(p);
+  return base != nullptr && q >= base && q < base + arena_size_;
+}
+
+Status NumaPool::Allocate(size_t n, void **p) {
+  RETURN_UNEXPECTED_IF_NULL(p);
+  {
+    std::unique_lock<std::mutex> lock(mux_);
+    if (impl_ == nullptr && arena_size_ > 0) {
+      RETURN_IF_NOT_OK(InitArena());
+    }
+    if (impl_ != nullptr && impl_->Allocate(n, p).IsOk()) {
+      return Status::OK();
+    }
+  }
+  // The arena is full. The pages of malloc still come from the preferred node of the calling thread.
+  return DeMalloc(n, p, false);
+}
+
+Status NumaPool::Reallocate(void **p, size_t old_sz, size_t new_sz) {
+  RETURN_UNEXPECTED_IF_NULL(p);
+  if (old_sz >= new_sz) {
+    // Do nothing if we shrink.
+    return Status::OK();
+  }
+  void *q = nullptr;
+  RETURN_IF_NOT_OK(Allocate(new_sz, &q));
+  if (*p != nullptr) {
+    errno_t err = memcpy_s(q, new_sz, *p, old_sz);
+    if (err) {
+      Deallocate(q);
+      RETURN_STATUS_UNEXPECTED(std::to_string(err));
+    }
+    Deallocate(*p);
+  }
+  *p = q;
+  return Status::OK();
+}
+
+void NumaPool::Deallocate(void *p) {
+  {
+    std::unique_lock<std::mutex> lock(mux_);
+    if (InArena(p)) {
+      impl_->Deallocate(p);
+      return;
+    }
+  }
+  free(p);
+}
+
+uint64_t NumaPool::get_max_size() const { return std::numeric_limits<uint64_t>::max(); }
+
+int NumaPool::PercentFree() const {
+  std::unique_lock<std::mutex> lock(mux_);
+  return impl_ != nullptr ? impl_->PercentFree() : 100;
+}
+}  // namespace dataset
+}  // namespace mindspore
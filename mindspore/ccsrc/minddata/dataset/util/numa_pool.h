@@ -0,0 +1,87 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_NUMA_POOL_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_NUMA_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "minddata/dataset/util/arena.h"
+#include "minddata/dataset/util/memory_pool.h"
+#include "minddata/dataset/util/status.h"
+
+namespace mindspore {
+namespace dataset {
+/// \brief The numa nodes whose memory the process is allowed to use, in ascending order. The ids are not
+/// necessarily contiguous, e.g. in a container restricted to some of the nodes. {0} if numa is not supported.
+const std::vector<int32_t> &GetNumaNodes();
+
+/// \brief Number of numa nodes the process is allowed to use. 1 if numa is not supported.
+int32_t GetNumaNodeCount();
+
+/// \brief Bind the calling thread to the cpus of a numa node and prefer the memory of the same node for
+/// whatever the thread allocates afterwards.
+/// \param numa_node The node to bind to. It must be one of GetNumaNodes().
+/// \return Status object
+Status BindThreadToNumaNode(int32_t numa_node);
+
+/// \brief The numa node the calling thread is bound to by BindThreadToNumaNode
+/// \return -1 if the thread is not bound
+int32_t GetThreadNumaNode();
+
+/// \brief A memory pool whose memory lives on one numa node. Memory is carved out of an arena that
+/// is reserved on the node on the first allocation. Once the arena is full, we fall back to malloc
+/// and rely on the memory policy of the (bound) calling thread to keep the pages on the node.
+/// \note A block can be freed by any thread, it always goes back to the pool it came from.
+class NumaPool : public MemoryPool {
+ public:
+  /// \brief Constructor
+  /// \param numa_node The node the memory comes from
+  /// \param arena_size_in_mb Size of the arena reserved on the node
+  NumaPool(int32_t numa_node, int64_t arena_size_in_mb);
+
+  ~NumaPool() override;
+
+  Status Allocate(size_t n, void **p) override;
+
+  Status Reallocate(void **p, size_t old_sz, size_t new_sz) override;
+
+  void Deallocate(void *p) override;
+
+  uint64_t get_max_size() const override;
+
+  int PercentFree() const override;
+
+  /// \return The numa node of this pool
+  int32_t numa_node() const { return numa_node_; }
+
+ private:
+  int32_t numa_node_;
+  int64_t arena_size_;
+  mutable std::mutex mux_;
+  void *ptr_;
+  std::unique_ptr<ArenaImpl> impl_;
+
+  /// \brief Reserve the arena on the node. Called with the lock held.
+  Status InitArena();
+
+  /// \brief Check if a block is carved out of the arena.
+  bool InArena(const void *p) const;
+};
+}  // namespace dataset
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_UTIL_NUMA_POOL_H_
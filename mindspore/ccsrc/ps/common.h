@@ -32,6 +32,15 @@ constexpr char kEnvPServerNum[] = "MS_SERVER_NUM";
 constexpr char kEnvWorkerNum[] = "MS_WORKER_NUM";
 constexpr char kEnvSchedulerHost[] = "MS_SCHED_HOST";
 constexpr char kEnvSchedulerPort[] = "MS_SCHED_PORT";
+constexpr char kEnvGradCodec[] = "MS_PS_GRAD_CODEC";
+constexpr char kEnvGradTopKRatio[] = "MS_PS_GRAD_TOPK_RATIO";
+constexpr char kEnvStaleness[] = "MS_PS_STALENESS";
+constexpr char kEnvStalenessLrScale[] = "MS_PS_STALENESS_LR_SCALE";
+constexpr char kEnvStalenessTimeout[] = "MS_PS_STALENESS_TIMEOUT";
+constexpr char kEnvEmbeddingCachePolicy[] = "MS_EMBEDDING_CACHE_POLICY";
+constexpr char kEnvEmbeddingStorageDir[] = "MS_PS_EMBEDDING_STORAGE_DIR";
+constexpr char kEnvHotRowNum[] = "MS_PS_HOT_ROW_NUM";
+constexpr char kEnvHotRowRefreshSteps[] = "MS_PS_HOT_ROW_REFRESH_STEPS";
 
 constexpr char kDmlcCommType[] = "DMLC_PS_VAN_TYPE";
 constexpr char kDmlcInterface[] = "DMLC_INTERFACE";
@@ -63,13 +72,28 @@ constexpr int64_t kInitWeightsCmd = 10;
 constexpr int64_t kInitWeightToOptimIdCmd = 11;
 constexpr int64_t kInitOptimInputsShapeCmd = 12;
 constexpr int64_t kInitKeyToPushNodeIdCmd = 13;
+constexpr int64_t kInitGradCodecCmd = 14;
 constexpr int64_t kInitEmbeddingsCmd = 20;
 constexpr int64_t kUpdateEmbeddingsCmd = 21;
 constexpr int64_t kCheckReadyForPushCmd = 25;
 constexpr int64_t kCheckReadyForPullCmd = 26;
 constexpr int64_t kEmbeddingLookupCmd = 30;
+constexpr int64_t kPullHotEmbeddingsCmd = 31;
 constexpr int64_t kFinalizeCmd = 40;
 
+constexpr float kDefaultGradTopKRatio = 0.01;
+// Gradients smaller than this are pushed uncompressed, the codec header would cost more than it saves.
+constexpr size_t kMinGradSizeToEncode = 1024;
+// The lookups a worker serves from its copies of the hot rows before it pulls them again.
+constexpr size_t kDefaultHotRowRefreshSteps = 10;
+// The seconds after which the lookup counts of the embedding rows on a server are halved.
+constexpr int64_t kHotRowDecayInterval = 10;
+// A server keeps the lookup counts of this many times the hot rows a worker pulls, and at least kMinHotRowCandidates.
+constexpr size_t kHotRowCandidateFactor = 4;
+constexpr size_t kMinHotRowCandidates = 1024;
+// The seconds a worker may stay silent before the pulls of the other workers stop waiting for it in SSP mode.
+constexpr uint64_t kDefaultStalenessTimeout = 300;
+
 constexpr size_t kInvalidKey = UINT64_MAX;
 constexpr int64_t kInvalidID = -1;
 
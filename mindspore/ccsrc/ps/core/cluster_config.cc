@@ -33,6 +33,9 @@ uint32_t ClusterConfig::heartbeat_timeout_ = 30;
 uint32_t ClusterConfig::cluster_available_timeout_ = 300;
 // The timeout period for the client to connect to the server is 100ms.
 uint32_t ClusterConfig::connect_interval_ = 100;
+// The size of the shared memory each end of a connection on the same host writes to, 0 disables it. It is disabled by
+// default, each connection takes this size of /dev/shm in both directions.
+size_t ClusterConfig::shm_arena_size_ = 0;
 
 void ClusterConfig::Init(const uint32_t &worker_num, const uint32_t &server_num,
                          std::unique_ptr<std::string> scheduler_host, const uint16_t &scheduler_port) {
@@ -74,6 +77,10 @@ void ClusterConfig::set_cluster_available_timeout(const uint32_t &cluster_availa
 uint32_t ClusterConfig::connect_interval() { return connect_interval_; }
 
 void ClusterConfig::set_connect_interval(const uint32_t &connect_interval) { connect_interval_ = connect_interval; }
+
+size_t ClusterConfig::shm_arena_size() { return shm_arena_size_; }
+
+void ClusterConfig::set_shm_arena_size(const size_t &shm_arena_size) { shm_arena_size_ = shm_arena_size; }
 }  // namespace core
 }  // namespace ps
 }  // namespace mindspore
@@ -44,6 +44,8 @@ class ClusterConfig {
   static void set_cluster_available_timeout(const uint32_t &cluster_available_timeout);
   static uint32_t connect_interval();
   static void set_connect_interval(const uint32_t &connect_interval);
+  static size_t shm_arena_size();
+  static void set_shm_arena_size(const size_t &shm_arena_size);
 
  private:
   static uint32_t worker_num_;
@@ -54,6 +56,7 @@ class ClusterConfig {
   static uint32_t heartbeat_timeout_;
   static uint32_t cluster_available_timeout_;
   static uint32_t connect_interval_;
+  static size_t shm_arena_size_;
 };
 }  // namespace core
 }  // namespace ps
@@ -17,6 +17,7 @@
 #include "ps/core/comm_util.h"
 
 #include <arpa/inet.h>
+#include <sys/socket.h>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -129,6 +130,29 @@ bool CommUtil::ValidateRankId(const enum NodeRole &node_role, const uint32_t &ra
   }
   return true;
 }
+
+bool CommUtil::IsLocalPeer(const evutil_socket_t &fd) {
+  sockaddr_storage local_addr{};
+  sockaddr_storage peer_addr{};
+  socklen_t local_len = sizeof(local_addr);
+  socklen_t peer_len = sizeof(peer_addr);
+  if (getsockname(fd, reinterpret_cast<sockaddr *>(&local_addr), &local_len) != 0 ||
+      getpeername(fd, reinterpret_cast<sockaddr *>(&peer_addr), &peer_len) != 0) {
+    return false;
+  }
+  // The kernel picks the address of the peer as the local address of a connection to this host.
+  if (local_addr.ss_family == AF_INET && peer_addr.ss_family == AF_INET) {
+    auto local_in = reinterpret_cast<sockaddr_in *>(&local_addr);
+    auto peer_in = reinterpret_cast<sockaddr_in *>(&peer_addr);
+    return local_in->sin_addr.s_addr == peer_in->sin_addr.s_addr;
+  }
+  if (local_addr.ss_family == AF_INET6 && peer_addr.ss_family == AF_INET6) {
+    auto local_in6 = reinterpret_cast<sockaddr_in6 *>(&local_addr);
+    auto peer_in6 = reinterpret_cast<sockaddr_in6 *>(&peer_addr);
+    return memcmp(&local_in6->sin6_addr, &peer_in6->sin6_addr, sizeof(in6_addr)) == 0;
+  }
+  return false;
+}
 }  // namespace core
 }  // namespace ps
 }  // namespace mindspore
@@ -68,6 +68,8 @@ class CommUtil {
   static std::string GenerateUUID();
   static std::string NodeRoleToString(const NodeRole &role);
   static bool ValidateRankId(const enum NodeRole &node_role, const uint32_t &rank_id);
+  // Whether the two ends of the connected socket fd are on the same host.
+  static bool IsLocalPeer(const evutil_socket_t &fd);
 
  private:
   static std::random_device rd;
@@ -0,0 +1,280 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/core/shm_transport.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <random>
+
+#include "ps/core/cluster_config.h"
+#include "ps/core/comm_util.h"
+
+namespace mindspore {
+namespace ps {
+namespace core {
+namespace {
+constexpr char kShmDir[] = "/dev/shm/";
+// The data starts on a cache line of its own, away from the header the reader writes.
+constexpr size_t kShmHeaderSize = 64;
+
+std::atomic<uint64_t> arena_count(0);
+}  // namespace
+
+ShmArena::ShmArena(const std::string &name, void *addr, size_t mapped_size, bool owner)
+    : name_(name),
+      addr_(addr),
+      mapped_size_(mapped_size),
+      owner_(owner),
+      header_(reinterpret_cast<Header *>(addr)),
+      data_(reinterpret_cast<uint8_t *>(addr) + kShmHeaderSize),
+      capacity_(header_->capacity),
+      head_(0) {}
+
+ShmArena::~ShmArena() {
+  (void)munmap(addr_, mapped_size_);
+  Unlink();
+}
+
+void ShmArena::Unlink() {
+  if (owner_) {
+    (void)unlink((kShmDir + name_).c_str());
+    owner_ = false;
+  }
+}
+
+std::shared_ptr<ShmArena> ShmArena::Create(const std::string &name, size_t capacity) {
+  std::string path = kShmDir + name;
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    MS_LOG(ERROR) << "Create the shared memory " << path << " failed: " << strerror(errno);
+    return nullptr;
+  }
+  size_t mapped_size = kShmHeaderSize + capacity;
+  // A file of /dev/shm only takes memory when its pages are written, so a full /dev/shm would raise SIGBUS on the
+  // write of a message instead.
+  int ret = posix_fallocate(fd, 0, static_cast<off_t>(mapped_size));
+  if (ret != 0) {
+    MS_LOG(WARNING) << "Allocate " << mapped_size << " bytes of the shared memory " << path
+                    << " failed: " << strerror(ret);
+    (void)close(fd);
+    (void)unlink(path.c_str());
+    return nullptr;
+  }
+  void *addr = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  (void)close(fd);
+  if (addr == MAP_FAILED) {
+    MS_LOG(ERROR) << "Map the shared memory " << path << " of " << mapped_size << " bytes failed: " << strerror(errno);
+    (void)unlink(path.c_str());
+    return nullptr;
+  }
+  auto header = new (addr) Header();
+  header->capacity = capacity;
+  header->tail.store(0, std::memory_order_release);
+  return std::shared_ptr<ShmArena>(new ShmArena(name, addr, mapped_size, true));
+}
+
+std::shared_ptr<ShmArena> ShmArena::Attach(const std::string &name) {
+  std::string path = kShmDir + name;
+  int fd = open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    MS_LOG(ERROR) << "Open the shared memory " << path << " failed: " << strerror(errno);
+    return nullptr;
+  }
+  struct stat file_stat {};
+  void *addr = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 && static_cast<size_t>(file_stat.st_size) > kShmHeaderSize) {
+    addr = mmap(nullptr, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  (void)close(fd);
+  if (addr == MAP_FAILED) {
+    MS_LOG(ERROR) << "Map the shared memory " << path << " failed: " << strerror(errno);
+    return nullptr;
+  }
+  size_t mapped_size = static_cast<size_t>(file_stat.st_size);
+  if (reinterpret_cast<Header *>(addr)->capacity != mapped_size - kShmHeaderSize) {
+    MS_LOG(ERROR) << "The shared memory " << path << " is not an arena.";
+    (void)munmap(addr, mapped_size);
+    return nullptr;
+  }
+  return std::shared_ptr<ShmArena>(new ShmArena(name, addr, mapped_size, false));
+}
+
+bool ShmArena::Allocate(size_t size, uint64_t *position, uint8_t **addr) {
+  MS_EXCEPTION_IF_NULL(position);
+  MS_EXCEPTION_IF_NULL(addr);
+  if (size == 0 || size > capacity_) {
+    return false;
+  }
+  uint64_t start = head_;
+  size_t offset = start % capacity_;
+  if (offset + size > capacity_) {
+    // skip the end of the ring, it is freed with the message
+    start += capacity_ - offset;
+  }
+  if (start + size - header_->tail.load(std::memory_order_acquire) > capacity_) {
+    return false;
+  }
+  head_ = start + size;
+  *position = start;
+  *addr = data_ + start % capacity_;
+  return true;
+}
+
+const uint8_t *ShmArena::Data(uint64_t position, size_t size) const {
+  size_t offset = position % capacity_;
+  if (size > capacity_ || offset + size > capacity_) {
+    return nullptr;
+  }
+  return data_ + offset;
+}
+
+void ShmArena::Release(uint64_t position, size_t size) {
+  header_->tail.store(position + size, std::memory_order_release);
+}
+
+void ShmTransport::Init(const evutil_socket_t &fd, const WriteMessage &write) {
+  std::string name;
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (arena_ != nullptr || ClusterConfig::shm_arena_size() == 0 || !CommUtil::IsLocalPeer(fd)) {
+      return;
+    }
+    // The random part keeps the processes of other containers, which may have the same pid, from opening an arena
+    // of the same name in their own /dev/shm.
+    std::random_device random;
+    name = "mindspore_ps_" + std::to_string(getpid()) + "_" + std::to_string(arena_count++) + "_" +
+           std::to_string(random()) + std::to_string(random());
+    arena_ = ShmArena::Create(name, ClusterConfig::shm_arena_size());
+    if (arena_ == nullptr) {
+      MS_LOG(WARNING) << "The messages to the peer on this host are sent through the socket.";
+      return;
+    }
+    attached_ = false;
+  }
+  CommMessage offer;
+  offer.mutable_pb_meta()->set_shm_handshake(SHM_OFFER);
+  offer.mutable_pb_meta()->set_shm_name(name);
+  write(offer);
+}
+
+bool ShmTransport::enable() const {
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  return attached_;
+}
+
+bool ShmTransport::SendMessage(const CommMessage &message, const WriteMessage &write) {
+  if (message.data().size() < kShmMinMessageSize) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  if (!attached_) {
+    return false;
+  }
+  const std::string &data = message.data();
+  uint64_t position = 0;
+  uint8_t *addr = nullptr;
+  if (!arena_->Allocate(data.size(), &position, &addr)) {
+    return false;
+  }
+  (void)memcpy(addr, data.data(), data.size());
+  CommMessage packed;
+  *packed.mutable_pb_meta() = message.pb_meta();
+  packed.mutable_pb_meta()->set_shm_name(arena_->name());
+  packed.mutable_pb_meta()->set_shm_position(position);
+  packed.mutable_pb_meta()->set_shm_length(data.size());
+  write(packed);
+  return true;
+}
+
+bool ShmTransport::ReceiveMessage(CommMessage *message, const WriteMessage &write) {
+  MS_EXCEPTION_IF_NULL(message);
+  MessageMeta *meta = message->mutable_pb_meta();
+  switch (meta->shm_handshake()) {
+    case SHM_OFFER:
+      OnOffer(meta->shm_name(), write);
+      return false;
+    case SHM_ACCEPT:
+    case SHM_REJECT:
+      OnAnswer(meta->shm_name(), meta->shm_handshake() == SHM_ACCEPT);
+      return false;
+    default:
+      break;
+  }
+  std::lock_guard<std::mutex> lock(receive_mutex_);
+  auto iter = peer_arenas_.find(meta->shm_name());
+  if (iter == peer_arenas_.end()) {
+    MS_LOG(ERROR) << "The data of the message is in the shared memory " << meta->shm_name()
+                  << " that was not offered, the message is dropped.";
+    return false;
+  }
+  const std::shared_ptr<ShmArena> &arena = iter->second;
+  const uint8_t *data = arena->Data(meta->shm_position(), meta->shm_length());
+  if (data == nullptr) {
+    MS_LOG(ERROR) << "The data of the message at " << meta->shm_position() << " of " << meta->shm_length()
+                  << " bytes is out of the shared memory " << meta->shm_name() << ", the message is dropped.";
+    return false;
+  }
+  message->set_data(data, meta->shm_length());
+  arena->Release(meta->shm_position(), meta->shm_length());
+  meta->clear_shm_name();
+  meta->clear_shm_position();
+  meta->clear_shm_length();
+  return true;
+}
+
+void ShmTransport::OnOffer(const std::string &name, const WriteMessage &write) {
+  bool accepted = false;
+  {
+    std::lock_guard<std::mutex> lock(receive_mutex_);
+    std::shared_ptr<ShmArena> arena = ShmArena::Attach(name);
+    if (arena != nullptr) {
+      peer_arenas_[name] = arena;
+      accepted = true;
+    } else {
+      MS_LOG(WARNING) << "The peer on this host doesn't share the shared memory " << name
+                      << ", its messages are received through the socket.";
+    }
+  }
+  CommMessage answer;
+  answer.mutable_pb_meta()->set_shm_handshake(accepted ? SHM_ACCEPT : SHM_REJECT);
+  answer.mutable_pb_meta()->set_shm_name(name);
+  write(answer);
+}
+
+void ShmTransport::OnAnswer(const std::string &name, bool accepted) {
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  if (arena_ == nullptr || arena_->name() != name) {
+    return;
+  }
+  if (!accepted) {
+    MS_LOG(WARNING) << "The peer can't attach the shared memory " << name
+                    << ", the messages to it are sent through the socket.";
+    arena_ = nullptr;
+    return;
+  }
+  // both ends have mapped the arena, its memory is freed with the mappings even if a node dies
+  arena_->Unlink();
+  attached_ = true;
+  MS_LOG(INFO) << "The messages to the peer on this host are sent through the shared memory " << name;
+}
+}  // namespace core
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,120 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_CORE_SHM_TRANSPORT_H_
+#define MINDSPORE_CCSRC_PS_CORE_SHM_TRANSPORT_H_
+
+#include <event2/util.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "proto/comm.pb.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+namespace core {
+// Smaller messages are sent through the socket, the copies saved don't pay for the bookkeeping.
+constexpr size_t kShmMinMessageSize = 4096;
+
+// A ring of bytes in a file of /dev/shm, written by one process and read by another. The writer reserves the bytes
+// of a message at the head, the reader frees them in the order they were reserved. Positions in the ring only grow,
+// the byte of position p is at p % capacity, and a message never wraps around the end of the ring.
+class ShmArena {
+ public:
+  // The file of the arena is removed when its creator releases it. The memory of the arena is allocated up front, so
+  // Create fails instead of the writes to the arena faulting when /dev/shm is full.
+  static std::shared_ptr<ShmArena> Create(const std::string &name, size_t capacity);
+  static std::shared_ptr<ShmArena> Attach(const std::string &name);
+  ~ShmArena();
+
+  // Reserves size bytes for a message, returns false if the ring doesn't have room for them now.
+  bool Allocate(size_t size, uint64_t *position, uint8_t **addr);
+  // Returns the size bytes of the message at position, or nullptr if they are out of the ring.
+  const uint8_t *Data(uint64_t position, size_t size) const;
+  // Frees the message at position and those before it.
+  void Release(uint64_t position, size_t size);
+  // Removes the file of the arena once both ends have mapped it, so that it doesn't outlive them.
+  void Unlink();
+  const std::string &name() const { return name_; }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Header {
+    uint64_t capacity;
+    // the position up to which the reader has freed the ring
+    std::atomic<uint64_t> tail;
+  };
+  ShmArena(const std::string &name, void *addr, size_t mapped_size, bool owner);
+
+  std::string name_;
+  void *addr_;
+  size_t mapped_size_;
+  bool owner_;
+  Header *header_;
+  uint8_t *data_;
+  size_t capacity_;
+  // the position the writer reserves next
+  uint64_t head_;
+};
+
+// Carries the data of large messages between the two ends of a connection on the same host through shared memory.
+// Each end writes to an arena it creates, and the message sent through the socket only tells where the data is.
+// The arena is only used once the peer has told it could attach it, the peers of the same address may not share
+// /dev/shm. Messages that don't fit in the arena are sent whole through the socket.
+class ShmTransport {
+ public:
+  using WriteMessage = std::function<void(const CommMessage &)>;
+
+  ShmTransport() = default;
+  ~ShmTransport() = default;
+
+  // Creates the arena of the messages sent through fd and offers it to the peer with write, if the shared memory is
+  // enabled by ClusterConfig::shm_arena_size and the peer is on this host.
+  void Init(const evutil_socket_t &fd, const WriteMessage &write);
+  bool enable() const;
+  // Moves the data of message to the arena and writes the message without it, returns false if message should be
+  // sent as it is. The arena is freed in order, so the message is written while the arena is locked.
+  bool SendMessage(const CommMessage &message, const WriteMessage &write);
+  // Handles a message for which IsShmMessage is true, answering the offer of the peer with write. Returns true if the
+  // message is to be passed on, with its data moved back from the arena of the peer, and false if it belonged to the
+  // handshake or its data can't be read.
+  bool ReceiveMessage(CommMessage *message, const WriteMessage &write);
+  static bool IsShmMessage(const CommMessage &message) {
+    return message.pb_meta().shm_handshake() != SHM_NONE || message.pb_meta().shm_length() > 0;
+  }
+
+ private:
+  void OnOffer(const std::string &name, const WriteMessage &write);
+  void OnAnswer(const std::string &name, bool accepted);
+
+  std::shared_ptr<ShmArena> arena_;
+  // whether the peer has attached arena_
+  bool attached_{false};
+  mutable std::mutex send_mutex_;
+  std::map<std::string, std::shared_ptr<ShmArena>> peer_arenas_;
+  std::mutex receive_mutex_;
+};
+}  // namespace core
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_CORE_SHM_TRANSPORT_H_
@@ -45,8 +45,16 @@ TcpClient::TcpClient(const std::string &address, std::uint16_t port)
       is_stop_(true),
       is_connected_(false) {
   message_handler_.SetCallback([this](const CommMessage &message) {
-    if (message_callback_) {
-      message_callback_(*this, message);
+    if (!ShmTransport::IsShmMessage(message)) {
+      if (message_callback_) {
+        message_callback_(*this, message);
+      }
+      return;
+    }
+    CommMessage received = message;
+    if (shm_transport_.ReceiveMessage(&received, [this](const CommMessage &answer) { WriteMessage(answer); }) &&
+        message_callback_) {
+      message_callback_(*this, received);
     }
   });
 }
@@ -216,6 +224,7 @@ void TcpClient::EventCallback(struct bufferevent *bev, std::int16_t events, void
     tcp_client->NotifyConnected();
     evutil_socket_t fd = bufferevent_getfd(bev);
     SetTcpNoDelay(fd);
+    tcp_client->shm_transport_.Init(fd, [tcp_client](const CommMessage &offer) { tcp_client->WriteMessage(offer); });
     MS_LOG(INFO) << "Client connected!";
   } else if (events & BEV_EVENT_ERROR) {
     MS_LOG(ERROR) << "Client connected error!";
@@ -252,6 +261,12 @@ void TcpClient::SetMessageCallback(const OnMessage &cb) { message_callback_ = cb
 
 void TcpClient::SendMessage(const CommMessage &message) const {
   MS_EXCEPTION_IF_NULL(buffer_event_);
+  if (!shm_transport_.SendMessage(message, [this](const CommMessage &packed) { WriteMessage(packed); })) {
+    WriteMessage(message);
+  }
+}
+
+void TcpClient::WriteMessage(const CommMessage &message) const {
   size_t buf_size = message.ByteSizeLong();
   std::vector<unsigned char> serialized(buf_size);
   message.SerializeToArray(serialized.data(), static_cast<int>(buf_size));
@@ -33,6 +33,7 @@
 #include <condition_variable>
 
 #include "ps/core/cluster_config.h"
+#include "ps/core/shm_transport.h"
 #include "proto/comm.pb.h"
 #include "proto/ps.pb.h"
 
@@ -75,6 +76,7 @@ class TcpClient {
   virtual void OnReadHandler(const void *buf, size_t num);
   static void TimerCallback(evutil_socket_t fd, int16_t event, void *arg);
   void NotifyConnected();
+  void WriteMessage(const CommMessage &message) const;
 
  private:
   OnMessage message_callback_;
@@ -96,6 +98,7 @@ class TcpClient {
   std::uint16_t server_port_;
   std::atomic<bool> is_stop_;
   std::atomic<bool> is_connected_;
+  mutable ShmTransport shm_transport_;
 };
 
 }  // namespace core
@@ -33,10 +33,21 @@ namespace mindspore {
 namespace ps {
 namespace core {
 void TcpConnection::InitConnection() {
+  if (buffer_event_ != nullptr) {
+    shm_transport_.Init(fd_, [this](const CommMessage &offer) { WriteMessage(offer); });
+  }
   tcp_message_handler_.SetCallback([&](const CommMessage &message) {
     OnServerReceiveMessage on_server_receive = server_->GetServerReceive();
-    if (on_server_receive) {
-      on_server_receive(*server_, *this, message);
+    if (!ShmTransport::IsShmMessage(message)) {
+      if (on_server_receive) {
+        on_server_receive(*server_, *this, message);
+      }
+      return;
+    }
+    CommMessage received = message;
+    if (shm_transport_.ReceiveMessage(&received, [this](const CommMessage &answer) { WriteMessage(answer); }) &&
+        on_server_receive) {
+      on_server_receive(*server_, *this, received);
     }
   });
 }
@@ -55,6 +66,12 @@ const evutil_socket_t &TcpConnection::GetFd() const { return fd_; }
 
 void TcpConnection::SendMessage(const CommMessage &message) const {
   MS_EXCEPTION_IF_NULL(buffer_event_);
+  if (!shm_transport_.SendMessage(message, [this](const CommMessage &packed) { WriteMessage(packed); })) {
+    WriteMessage(message);
+  }
+}
+
+void TcpConnection::WriteMessage(const CommMessage &message) const {
   size_t buf_size = message.ByteSizeLong();
   std::vector<unsigned char> serialized(buf_size);
   message.SerializeToArray(serialized.data(), static_cast<int>(buf_size));
@@ -38,6 +38,7 @@
 #include "proto/ps.pb.h"
 #include "ps/core/tcp_message_handler.h"
 #include "ps/core/cluster_config.h"
+#include "ps/core/shm_transport.h"
 #include "utils/log_adapter.h"
 
 namespace mindspore {
@@ -58,10 +59,13 @@ class TcpConnection {
   const evutil_socket_t &GetFd() const;
 
  protected:
+  void WriteMessage(const CommMessage &message) const;
+
   struct bufferevent *buffer_event_;
   evutil_socket_t fd_;
   const TcpServer *server_;
   TcpMessageHandler tcp_message_handler_;
+  mutable ShmTransport shm_transport_;
 };
 
 using OnServerReceiveMessage =
@@ -0,0 +1,208 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/embedding_hot_rows.h"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+namespace {
+constexpr size_t kSketchDepth = 4;
+constexpr size_t kMinSketchWidthBits = 6;
+constexpr size_t kMaxSketchWidthBits = 16;
+constexpr size_t kKeyBits = 64;
+// odd multipliers of the multiplicative hashes of the sketch rows
+constexpr uint64_t kSketchHashSeeds[kSketchDepth] = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+                                                     0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+
+bool Hotter(const std::pair<Key, uint32_t> &a, const std::pair<Key, uint32_t> &b) {
+  return a.second > b.second || (a.second == b.second && a.first < b.first);
+}
+}  // namespace
+
+EmbeddingAccessCounter::EmbeddingAccessCounter(size_t row_num, size_t first_id, size_t candidate_num,
+                                               Clock::duration decay_interval)
+    : row_num_(row_num),
+      first_id_(first_id),
+      candidate_num_(std::max(candidate_num, size_t(1))),
+      sketch_width_bits_(kMinSketchWidthBits),
+      decay_interval_(decay_interval),
+      last_decay_time_(Clock::now()) {
+  while (sketch_width_bits_ < kMaxSketchWidthBits && (size_t(1) << sketch_width_bits_) < row_num) {
+    sketch_width_bits_++;
+  }
+  sketch_.resize(kSketchDepth << sketch_width_bits_, 0);
+}
+
+void EmbeddingAccessCounter::Record(Key id, uint32_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DecayIfDue();
+  RecordLocked(id, count);
+}
+
+void EmbeddingAccessCounter::Record(const Key *ids, size_t ids_num) {
+  MS_EXCEPTION_IF_NULL(ids);
+  std::lock_guard<std::mutex> lock(mutex_);
+  DecayIfDue();
+  for (size_t i = 0; i < ids_num; ++i) {
+    RecordLocked(ids[i], 1);
+  }
+}
+
+std::vector<Key> EmbeddingAccessCounter::HotRows(size_t k) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<Key, uint32_t>> rows;
+  for (const auto &candidate : candidates_) {
+    uint32_t estimate = Estimate(candidate.first);
+    if (estimate > 0) {
+      rows.emplace_back(candidate.first, estimate);
+    }
+  }
+  if (rows.size() > k) {
+    std::nth_element(rows.begin(), rows.begin() + k, rows.end(), Hotter);
+    rows.resize(k);
+  }
+  std::sort(rows.begin(), rows.end(), Hotter);
+  std::vector<Key> ids;
+  for (const auto &row : rows) {
+    ids.push_back(row.first);
+  }
+  return ids;
+}
+
+void EmbeddingAccessCounter::RecordLocked(Key id, uint32_t count) {
+  if (id < first_id_ || id - first_id_ >= row_num_) {
+    return;
+  }
+  for (size_t i = 0; i < kSketchDepth; ++i) {
+    uint32_t &counter = sketch_[SketchSlot(id, i)];
+    counter = std::numeric_limits<uint32_t>::max() - counter < count ? std::numeric_limits<uint32_t>::max()
+                                                                     : counter + count;
+  }
+  uint32_t estimate = Estimate(id);
+  auto iter = candidates_.find(id);
+  if (iter != candidates_.end()) {
+    iter->second = estimate;
+    return;
+  }
+  if (estimate < admit_threshold_) {
+    return;
+  }
+  candidates_.emplace(id, estimate);
+  if (candidates_.size() >= 2 * candidate_num_) {
+    PruneCandidates();
+  }
+}
+
+uint32_t EmbeddingAccessCounter::Estimate(Key id) const {
+  uint32_t estimate = std::numeric_limits<uint32_t>::max();
+  for (size_t i = 0; i < kSketchDepth; ++i) {
+    estimate = std::min(estimate, sketch_[SketchSlot(id, i)]);
+  }
+  return estimate;
+}
+
+size_t EmbeddingAccessCounter::SketchSlot(Key id, size_t row) const {
+  uint64_t hash = static_cast<uint64_t>(id) * kSketchHashSeeds[row];
+  return (row << sketch_width_bits_) + static_cast<size_t>(hash >> (kKeyBits - sketch_width_bits_));
+}
+
+void EmbeddingAccessCounter::DecayIfDue() {
+  Clock::time_point now = Clock::now();
+  if (now - last_decay_time_ < decay_interval_) {
+    return;
+  }
+  last_decay_time_ = now;
+  for (auto &counter : sketch_) {
+    counter >>= 1;
+  }
+  for (auto iter = candidates_.begin(); iter != candidates_.end();) {
+    iter->second >>= 1;
+    iter = iter->second == 0 ? candidates_.erase(iter) : std::next(iter);
+  }
+  admit_threshold_ >>= 1;
+}
+
+void EmbeddingAccessCounter::PruneCandidates() {
+  std::vector<std::pair<Key, uint32_t>> candidates(candidates_.begin(), candidates_.end());
+  std::nth_element(candidates.begin(), candidates.begin() + candidate_num_ - 1, candidates.end(), Hotter);
+  admit_threshold_ = candidates[candidate_num_ - 1].second;
+  candidates.resize(candidate_num_);
+  candidates_.clear();
+  candidates_.insert(candidates.begin(), candidates.end());
+}
+
+HotEmbeddingRows::HotEmbeddingRows(const int *ids, size_t ids_num, const float *rows, size_t row_size,
+                                   uint64_t push_slack)
+    : ids_(ids, ids + ids_num),
+      rows_(rows, rows + ids_num * row_size),
+      hits_(ids_num, 0),
+      row_size_(row_size),
+      push_slack_(push_slack) {
+  for (size_t i = 0; i < ids_num; ++i) {
+    index_[ids[i]] = i;
+  }
+}
+
+const float *HotEmbeddingRows::Find(int id) {
+  auto iter = index_.find(id);
+  if (iter == index_.end()) {
+    return nullptr;
+  }
+  hits_[iter->second]++;
+  return rows_.data() + iter->second * row_size_;
+}
+
+void HotEmbeddingRows::TakeHits(std::vector<int> *ids_and_hits) {
+  MS_EXCEPTION_IF_NULL(ids_and_hits);
+  for (size_t i = 0; i < ids_.size(); ++i) {
+    if (hits_[i] == 0) {
+      continue;
+    }
+    ids_and_hits->push_back(ids_[i]);
+    ids_and_hits->push_back(static_cast<int>(std::min<uint32_t>(hits_[i], std::numeric_limits<int>::max())));
+    hits_[i] = 0;
+  }
+}
+
+void HotEmbeddingRows::Push(const int *ids, size_t ids_num) {
+  MS_EXCEPTION_IF_NULL(ids);
+  push_count_++;
+  // the hits of a dropped row are still reported
+  for (size_t i = 0; i < ids_num; ++i) {
+    (void)index_.erase(ids[i]);
+  }
+}
+
+size_t ParseHotRowEnv(const std::string &name, const std::string &value) {
+  bool is_digits = !value.empty() && std::all_of(value.begin(), value.end(), [](char c) {
+                     return std::isdigit(static_cast<unsigned char>(c)) != 0;
+                   });
+  if (is_digits) {
+    try {
+      return std::stoul(value);
+    } catch (const std::out_of_range &) {
+    }
+  }
+  MS_LOG(EXCEPTION) << "The value of " << name << " should be a non-negative integer, but got " << value;
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,115 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_EMBEDDING_HOT_ROWS_H_
+#define MINDSPORE_CCSRC_PS_EMBEDDING_HOT_ROWS_H_
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ps/common.h"
+
+namespace mindspore {
+namespace ps {
+// Counts the lookups of the rows in the shard of an embedding table on a server. The counts are estimated by a
+// count-min sketch, and only the ids estimated among the hottest are kept as candidates, so the memory doesn't grow
+// with the rows of the shard. The counts are halved every decay_interval, so they follow the recent distribution of
+// the ids rather than the whole history.
+class EmbeddingAccessCounter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // The first row of the shard has the id first_id, at least candidate_num of the hottest ids are kept.
+  EmbeddingAccessCounter(size_t row_num, size_t first_id, size_t candidate_num,
+                         Clock::duration decay_interval = std::chrono::seconds(kHotRowDecayInterval));
+  ~EmbeddingAccessCounter() = default;
+
+  // Counts count lookups of id, the ids out of the shard are ignored.
+  void Record(Key id, uint32_t count = 1);
+  void Record(const Key *ids, size_t ids_num);
+  // Returns the ids of at most k rows looked up the most, the hottest first. The counts are not changed.
+  std::vector<Key> HotRows(size_t k);
+  size_t candidate_num() const { return candidate_num_; }
+
+ private:
+  void RecordLocked(Key id, uint32_t count);
+  // The smallest of the sketch counters of id, it never under counts the lookups.
+  uint32_t Estimate(Key id) const;
+  size_t SketchSlot(Key id, size_t row) const;
+  void DecayIfDue();
+  // Keeps the candidate_num_ hottest candidates and raises the estimate a new candidate needs.
+  void PruneCandidates();
+
+  size_t row_num_;
+  size_t first_id_;
+  size_t candidate_num_;
+  // the sketch has kSketchDepth rows of 2^sketch_width_bits_ counters
+  size_t sketch_width_bits_;
+  std::vector<uint32_t> sketch_;
+  // the estimated counts of the ids that may be among the hottest
+  std::unordered_map<Key, uint32_t> candidates_;
+  uint32_t admit_threshold_{0};
+  Clock::duration decay_interval_;
+  Clock::time_point last_decay_time_;
+  std::mutex mutex_;
+};
+
+// The copies of the hottest rows of an embedding table a worker keeps. Their lookups are not sent to the servers,
+// so the server owning the popular ids stops being the one every request waits for. The hits are counted and
+// reported back, otherwise the rows would cool down on their servers only because they are served here.
+//
+// The copies are read within the staleness bound of the SSP mode: they expire once the worker has pushed the table
+// more than push_slack times since they were pulled. The rows the worker pushes gradients for are dropped right
+// away, so it never reads its own rows from before the update. The lookups and pushes of a worker are issued one
+// after another, the rows are not locked.
+class HotEmbeddingRows {
+ public:
+  HotEmbeddingRows(const int *ids, size_t ids_num, const float *rows, size_t row_size, uint64_t push_slack);
+  ~HotEmbeddingRows() = default;
+
+  // Returns the row of id, or nullptr if it isn't kept here.
+  const float *Find(int id);
+  bool Contains(int id) const { return index_.count(id) > 0; }
+  size_t row_size() const { return row_size_; }
+  size_t size() const { return index_.size(); }
+  // Appends the ids found since the last call and their hit counts to ids_and_hits, one pair after another.
+  void TakeHits(std::vector<int> *ids_and_hits);
+  // Counts a push of the table by the worker and drops the rows of the pushed ids.
+  void Push(const int *ids, size_t ids_num);
+  // Whether the copies fell out of the staleness bound and have to be pulled again.
+  bool Expired() const { return push_count_ > push_slack_; }
+
+ private:
+  // id to the index of its row
+  std::unordered_map<int, size_t> index_;
+  std::vector<int> ids_;
+  std::vector<float> rows_;
+  std::vector<uint32_t> hits_;
+  size_t row_size_;
+  uint64_t push_slack_;
+  uint64_t push_count_{0};
+};
+using HotEmbeddingRowsPtr = std::shared_ptr<HotEmbeddingRows>;
+
+// Parses the value of the hot row environment variable name, which should be a non-negative integer.
+size_t ParseHotRowEnv(const std::string &name, const std::string &value);
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_EMBEDDING_HOT_ROWS_H_
@@ -0,0 +1,139 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/embedding_storage.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+void EmbeddingStorage::Initialize(const std::string &dir) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  dir_ = dir;
+  page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  if (!dir_.empty()) {
+    MS_LOG(INFO) << "The embedding tables are stored in " << dir_;
+  }
+}
+
+std::shared_ptr<float> EmbeddingStorage::Map(size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (dir_.empty()) {
+    MS_LOG(EXCEPTION) << "The embedding storage directory is not set.";
+  }
+  std::string path = dir_ + "/embedding_" + std::to_string(getpid()) + "_" + std::to_string(file_count_++);
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    MS_LOG(EXCEPTION) << "Failed to create the embedding storage file " << path << ": " << strerror(errno);
+  }
+  size_t bytes = std::max(size * sizeof(float), page_size_);
+  // the file is sparse, the blocks of the rows are allocated when they are written
+  if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    int err = errno;
+    (void)close(fd);
+    (void)unlink(path.c_str());
+    MS_LOG(EXCEPTION) << "Failed to extend the embedding storage file " << path << " to " << bytes
+                      << " bytes: " << strerror(err);
+  }
+  void *addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int err = errno;
+  (void)close(fd);
+  (void)unlink(path.c_str());
+  if (addr == MAP_FAILED) {
+    MS_LOG(EXCEPTION) << "Failed to map the embedding storage file " << path << ": " << strerror(err);
+  }
+  // The rows are accessed at random, reading ahead of them only evicts other rows from the page cache.
+  (void)madvise(addr, bytes, MADV_RANDOM);
+  auto start = reinterpret_cast<uintptr_t>(addr);
+  regions_[start] = bytes;
+  return std::shared_ptr<float>(reinterpret_cast<float *>(addr), [this, start, bytes](float *data) {
+    (void)munmap(data, bytes);
+    std::lock_guard<std::mutex> lock(mutex_);
+    (void)regions_.erase(start);
+  });
+}
+
+WeightPtr EmbeddingStorage::AllocateWeight(size_t size) {
+  std::shared_ptr<float> data = Map(size);
+  WeightPtr weight = std::make_shared<Weight>();
+  // the array holds a reference to the mapping
+  weight->reset(data.get(), size, [data](float *) {});
+  return weight;
+}
+
+float *EmbeddingStorage::AllocateState(size_t size) {
+  std::shared_ptr<float> data = Map(size);
+  std::lock_guard<std::mutex> lock(mutex_);
+  states_.push_back(data);
+  return data.get();
+}
+
+bool EmbeddingStorage::IsFileBacked(const void *addr) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto address = reinterpret_cast<uintptr_t>(addr);
+  auto iter = regions_.upper_bound(address);
+  if (iter == regions_.begin()) {
+    return false;
+  }
+  --iter;
+  return address < iter->first + iter->second;
+}
+
+void EmbeddingStorage::Prefetch(const float *table, size_t table_size, size_t row_size, size_t first_id,
+                                const Key *ids, size_t ids_num) const {
+  if (table == nullptr || ids == nullptr || row_size == 0) {
+    return;
+  }
+  size_t row_num = table_size / row_size;
+  std::vector<Key> rows;
+  rows.reserve(ids_num);
+  for (size_t i = 0; i < ids_num; ++i) {
+    if (ids[i] >= first_id && ids[i] - first_id < row_num) {
+      rows.push_back(ids[i] - first_id);
+    }
+  }
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+  // The pages of neighbouring rows are merged, a batch of ids becomes a few requests to the disk.
+  auto base = reinterpret_cast<uintptr_t>(table);
+  size_t row_bytes = row_size * sizeof(float);
+  uintptr_t range_start = 0;
+  uintptr_t range_end = 0;
+  for (auto row : rows) {
+    uintptr_t start = (base + row * row_bytes) / page_size_ * page_size_;
+    uintptr_t end = base + (row + 1) * row_bytes;
+    if (range_end != 0 && start <= range_end) {
+      range_end = std::max(range_end, end);
+      continue;
+    }
+    if (range_end != 0) {
+      (void)madvise(reinterpret_cast<void *>(range_start), range_end - range_start, MADV_WILLNEED);
+    }
+    range_start = start;
+    range_end = end;
+  }
+  if (range_end != 0) {
+    (void)madvise(reinterpret_cast<void *>(range_start), range_end - range_start, MADV_WILLNEED);
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
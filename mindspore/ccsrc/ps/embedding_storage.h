@@ -0,0 +1,70 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_EMBEDDING_STORAGE_H_
+#define MINDSPORE_CCSRC_PS_EMBEDDING_STORAGE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ps/common.h"
+
+namespace mindspore {
+namespace ps {
+// Keeps the embedding tables of a server and the optimizer states of their rows in files on local disk instead of
+// memory. A file is mapped into memory, so the kernels use it like a buffer, and the page cache keeps the rows in
+// use while the others stay on disk. The files are unlinked once mapped and disappear with the process.
+class EmbeddingStorage {
+ public:
+  static EmbeddingStorage &GetInstance() {
+    static EmbeddingStorage instance;
+    return instance;
+  }
+
+  // The tables are kept in memory while the directory is empty.
+  void Initialize(const std::string &dir);
+  bool enable() const { return !dir_.empty(); }
+  // Returns a table of size zeros backed by a file, the file is unmapped when the last reference is released.
+  WeightPtr AllocateWeight(size_t size);
+  // Returns size zeros in the file backing the optimizer state of a table, they live as long as the process.
+  float *AllocateState(size_t size);
+  bool IsFileBacked(const void *addr) const;
+  // Starts reading the rows of ids from disk in background, so that the lookup following it doesn't wait on every
+  // row in turn. It returns at once, the rows that are not read yet are read on access. The first row of the table
+  // has the id first_id.
+  void Prefetch(const float *table, size_t table_size, size_t row_size, size_t first_id, const Key *ids,
+                size_t ids_num) const;
+
+ private:
+  EmbeddingStorage() = default;
+  ~EmbeddingStorage() = default;
+  EmbeddingStorage(const EmbeddingStorage &) = delete;
+  EmbeddingStorage &operator=(const EmbeddingStorage &) = delete;
+  std::shared_ptr<float> Map(size_t size);
+
+  std::string dir_;
+  size_t file_count_{0};
+  size_t page_size_{0};
+  // start address to byte size of the mapped files
+  std::map<uintptr_t, size_t> regions_;
+  std::vector<std::shared_ptr<float>> states_;
+  mutable std::mutex mutex_;
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_EMBEDDING_STORAGE_H_
@@ -0,0 +1,296 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/gradient_codec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include "base/float16.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+namespace {
+constexpr float kInt8MaxValue = 127;
+constexpr uint32_t kFloatAbsMask = 0x7fffffff;
+constexpr uint32_t kFloatInfBits = 0x7f800000;
+constexpr uint32_t kBf16QuietNaNBit = 0x40;
+constexpr uint32_t kBf16Shift = 16;
+
+void AppendUint32(uint32_t value, std::vector<float> *out) {
+  float slot;
+  (void)memcpy(&slot, &value, sizeof(slot));
+  out->push_back(slot);
+}
+
+uint32_t ReadUint32(float slot) {
+  uint32_t value;
+  (void)memcpy(&value, &slot, sizeof(value));
+  return value;
+}
+
+size_t ByteSlotNum(size_t byte_size) { return (byte_size + sizeof(float) - 1) / sizeof(float); }
+
+// Appends the float slots holding byte_size bytes of payload and returns the first byte.
+uint8_t *AppendBytes(size_t byte_size, std::vector<float> *out) {
+  size_t offset = out->size();
+  out->resize(offset + ByteSlotNum(byte_size), 0);
+  return reinterpret_cast<uint8_t *>(out->data() + offset);
+}
+
+// Reads the element count from the header and checks that the payload after it is complete.
+size_t ReadElemNum(const float *data, size_t data_size, size_t (*payload_slot_num)(const float *, size_t)) {
+  if (data == nullptr || data_size == 0) {
+    MS_LOG(EXCEPTION) << "The encoded gradient is empty.";
+  }
+  size_t elem_num = ReadUint32(data[0]);
+  if (data_size < 1 + payload_slot_num(data, elem_num)) {
+    MS_LOG(EXCEPTION) << "The encoded gradient of " << elem_num << " elements is truncated, only " << data_size
+                      << " floats are received.";
+  }
+  return elem_num;
+}
+
+uint16_t FloatToBf16(float value) {
+  uint32_t bits;
+  (void)memcpy(&bits, &value, sizeof(bits));
+  if ((bits & kFloatAbsMask) > kFloatInfBits) {
+    return static_cast<uint16_t>((bits >> kBf16Shift) | kBf16QuietNaNBit);
+  }
+  // round to nearest even
+  bits += 0x7fff + ((bits >> kBf16Shift) & 1);
+  return static_cast<uint16_t>(bits >> kBf16Shift);
+}
+
+float Bf16ToFloat(uint16_t value) {
+  uint32_t bits = static_cast<uint32_t>(value) << kBf16Shift;
+  float result;
+  (void)memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+class Fp16GradientCodec : public GradientCodec {
+ public:
+  GradCodecType type() const override { return kGradCodecFp16; }
+
+  void Encode(const float *grad, size_t size, std::vector<float> *out) override {
+    AppendUint32(static_cast<uint32_t>(size), out);
+    uint8_t *bytes = AppendBytes(size * sizeof(float16), out);
+    for (size_t i = 0; i < size; ++i) {
+      float16 half(grad[i]);
+      (void)memcpy(bytes + i * sizeof(float16), &half, sizeof(float16));
+    }
+  }
+
+  size_t Decode(const float *data, size_t data_size, std::vector<float> *out) const override {
+    size_t size = ReadElemNum(data, data_size, PayloadSlotNum);
+    auto bytes = reinterpret_cast<const uint8_t *>(data + 1);
+    out->resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      float16 half;
+      (void)memcpy(&half, bytes + i * sizeof(float16), sizeof(float16));
+      (*out)[i] = half_to_float(half);
+    }
+    return 1 + PayloadSlotNum(data, size);
+  }
+
+ private:
+  static size_t PayloadSlotNum(const float *, size_t size) { return ByteSlotNum(size * sizeof(float16)); }
+};
+
+class Bf16GradientCodec : public GradientCodec {
+ public:
+  GradCodecType type() const override { return kGradCodecBf16; }
+
+  void Encode(const float *grad, size_t size, std::vector<float> *out) override {
+    AppendUint32(static_cast<uint32_t>(size), out);
+    uint8_t *bytes = AppendBytes(size * sizeof(uint16_t), out);
+    for (size_t i = 0; i < size; ++i) {
+      uint16_t value = FloatToBf16(grad[i]);
+      (void)memcpy(bytes + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+    }
+  }
+
+  size_t Decode(const float *data, size_t data_size, std::vector<float> *out) const override {
+    size_t size = ReadElemNum(data, data_size, PayloadSlotNum);
+    auto bytes = reinterpret_cast<const uint8_t *>(data + 1);
+    out->resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      uint16_t value;
+      (void)memcpy(&value, bytes + i * sizeof(uint16_t), sizeof(uint16_t));
+      (*out)[i] = Bf16ToFloat(value);
+    }
+    return 1 + PayloadSlotNum(data, size);
+  }
+
+ private:
+  static size_t PayloadSlotNum(const float *, size_t size) { return ByteSlotNum(size * sizeof(uint16_t)); }
+};
+
+// Symmetric quantization, the scale is sent before the 8-bit values.
+class Int8GradientCodec : public GradientCodec {
+ public:
+  GradCodecType type() const override { return kGradCodecInt8; }
+
+  void Encode(const float *grad, size_t size, std::vector<float> *out) override {
+    AppendUint32(static_cast<uint32_t>(size), out);
+    float max_abs = 0;
+    for (size_t i = 0; i < size; ++i) {
+      max_abs = std::max(max_abs, std::fabs(grad[i]));
+    }
+    float scale = max_abs / kInt8MaxValue;
+    out->push_back(scale);
+    auto bytes = reinterpret_cast<int8_t *>(AppendBytes(size, out));
+    if (scale == 0) {
+      return;
+    }
+    float inv_scale = 1 / scale;
+    for (size_t i = 0; i < size; ++i) {
+      float value = std::round(grad[i] * inv_scale);
+      bytes[i] = static_cast<int8_t>(std::min(std::max(value, -kInt8MaxValue), kInt8MaxValue));
+    }
+  }
+
+  size_t Decode(const float *data, size_t data_size, std::vector<float> *out) const override {
+    size_t size = ReadElemNum(data, data_size, PayloadSlotNum);
+    float scale = data[1];
+    auto bytes = reinterpret_cast<const int8_t *>(data + 2);
+    out->resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      (*out)[i] = bytes[i] * scale;
+    }
+    return 1 + PayloadSlotNum(data, size);
+  }
+
+ private:
+  static size_t PayloadSlotNum(const float *, size_t size) { return 1 + ByteSlotNum(size); }
+};
+
+// Sends the k largest magnitudes with their positions. What is not sent is kept as residual and added to the next
+// gradient of the same key (error feedback), so that small updates are delayed instead of dropped.
+class TopKGradientCodec : public GradientCodec {
+ public:
+  explicit TopKGradientCodec(float ratio) : ratio_(ratio) {}
+  GradCodecType type() const override { return kGradCodecTopK; }
+
+  void Encode(const float *grad, size_t size, std::vector<float> *out) override {
+    if (residual_.size() != size) {
+      residual_.assign(size, 0);
+    }
+    for (size_t i = 0; i < size; ++i) {
+      residual_[i] += grad[i];
+    }
+    size_t k = std::min(size, std::max(static_cast<size_t>(1), static_cast<size_t>(std::ceil(size * ratio_))));
+    std::vector<uint32_t> indices(size);
+    std::iota(indices.begin(), indices.end(), 0);
+    auto greater = [this](uint32_t a, uint32_t b) { return std::fabs(residual_[a]) > std::fabs(residual_[b]); };
+    std::nth_element(indices.begin(), indices.begin() + k, indices.end(), greater);
+    indices.resize(k);
+    std::sort(indices.begin(), indices.end());
+
+    AppendUint32(static_cast<uint32_t>(size), out);
+    AppendUint32(static_cast<uint32_t>(k), out);
+    for (auto index : indices) {
+      AppendUint32(index, out);
+    }
+    for (auto index : indices) {
+      out->push_back(residual_[index]);
+      residual_[index] = 0;
+    }
+  }
+
+  size_t Decode(const float *data, size_t data_size, std::vector<float> *out) const override {
+    if (data_size < 2) {
+      MS_LOG(EXCEPTION) << "The encoded top-k gradient is truncated, only " << data_size << " floats are received.";
+    }
+    size_t size = ReadElemNum(data, data_size, PayloadSlotNum);
+    size_t k = ReadUint32(data[1]);
+    const float *indices = data + 2;
+    const float *values = indices + k;
+    out->assign(size, 0);
+    for (size_t i = 0; i < k; ++i) {
+      size_t index = ReadUint32(indices[i]);
+      if (index >= size) {
+        MS_LOG(EXCEPTION) << "The index " << index << " of the top-k gradient is out of range " << size;
+      }
+      (*out)[index] = values[i];
+    }
+    return 1 + PayloadSlotNum(data, size);
+  }
+
+ private:
+  static size_t PayloadSlotNum(const float *data, size_t) { return 1 + 2 * static_cast<size_t>(ReadUint32(data[1])); }
+
+  float ratio_;
+  std::vector<float> residual_;
+};
+}  // namespace
+
+GradientCodecPtr CreateGradientCodec(GradCodecType type, float topk_ratio) {
+  switch (type) {
+    case kGradCodecNone:
+      return nullptr;
+    case kGradCodecFp16:
+      return std::make_shared<Fp16GradientCodec>();
+    case kGradCodecBf16:
+      return std::make_shared<Bf16GradientCodec>();
+    case kGradCodecInt8:
+      return std::make_shared<Int8GradientCodec>();
+    case kGradCodecTopK:
+      if (topk_ratio <= 0 || topk_ratio > 1) {
+        MS_LOG(EXCEPTION) << "The top-k ratio of the gradient codec should be in (0, 1], but got " << topk_ratio;
+      }
+      return std::make_shared<TopKGradientCodec>(topk_ratio);
+    default:
+      MS_LOG(EXCEPTION) << "Invalid gradient codec type " << type;
+  }
+}
+
+GradCodecType GradCodecTypeFromName(const std::string &name) {
+  if (name.empty() || name == "none") {
+    return kGradCodecNone;
+  } else if (name == "fp16") {
+    return kGradCodecFp16;
+  } else if (name == "bf16") {
+    return kGradCodecBf16;
+  } else if (name == "topk") {
+    return kGradCodecTopK;
+  } else if (name == "int8") {
+    return kGradCodecInt8;
+  }
+  MS_LOG(EXCEPTION) << "Invalid gradient codec " << name << ", it should be one of none, fp16, bf16, topk and int8.";
+}
+
+float GradTopKRatioFromString(const std::string &ratio) {
+  float value = 0;
+  size_t parsed_len = 0;
+  try {
+    value = std::stof(ratio, &parsed_len);
+  } catch (const std::exception &) {
+    parsed_len = 0;
+  }
+  if (parsed_len == 0 || parsed_len != ratio.size()) {
+    MS_LOG(EXCEPTION) << "Invalid top-k ratio of the gradient codec: " << ratio;
+  }
+  if (!(value > 0 && value <= 1)) {
+    MS_LOG(EXCEPTION) << "The top-k ratio of the gradient codec should be in (0, 1], but got " << ratio;
+  }
+  return value;
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_GRADIENT_CODEC_H_
+#define MINDSPORE_CCSRC_PS_GRADIENT_CODEC_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mindspore {
+namespace ps {
+enum GradCodecType : int64_t {
+  kGradCodecNone = 0,
+  kGradCodecFp16 = 1,
+  kGradCodecBf16 = 2,
+  kGradCodecTopK = 3,
+  kGradCodecInt8 = 4,
+};
+
+// Wire codec of the gradients pushed by a worker. The encoded gradient is carried in the float payload of the push
+// and starts with the element count of the gradient, so the server decodes it without knowing its shape.
+class GradientCodec {
+ public:
+  virtual ~GradientCodec() = default;
+  virtual GradCodecType type() const = 0;
+  // Appends the encoded size elements of grad to out.
+  virtual void Encode(const float *grad, size_t size, std::vector<float> *out) = 0;
+  // Decodes the gradient at the beginning of data into out and returns the number of floats it took.
+  virtual size_t Decode(const float *data, size_t data_size, std::vector<float> *out) const = 0;
+};
+using GradientCodecPtr = std::shared_ptr<GradientCodec>;
+
+// The top-k codec keeps the error feedback of one gradient, every worker needs an instance per key.
+GradientCodecPtr CreateGradientCodec(GradCodecType type, float topk_ratio = 0);
+GradCodecType GradCodecTypeFromName(const std::string &name);
+// Parses the top-k ratio of the gradient codec, it should be a number in (0, 1].
+float GradTopKRatioFromString(const std::string &ratio);
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_GRADIENT_CODEC_H_
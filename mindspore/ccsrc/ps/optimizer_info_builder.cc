@@ -19,6 +19,7 @@
 #include <memory>
 #include <functional>
 #include "backend/kernel_compiler/cpu/ps/sparse_apply_ftrl_ps_kernel.h"
+#include "ps/embedding_storage.h"
 
 namespace mindspore {
 namespace ps {
@@ -51,6 +52,15 @@ void OptimizerInfoBuilder::BuildWorkspaces(OptimizerInfo *info, const std::vecto
   }
 }
 
+float *OptimizerInfoBuilder::NewStateBuffer(const WeightPtr &weight) const {
+  MS_EXCEPTION_IF_NULL(weight);
+  auto &storage = EmbeddingStorage::GetInstance();
+  if (storage.IsFileBacked(weight->data())) {
+    return storage.AllocateState(weight->size());
+  }
+  return new float[weight->size()]();
+}
+
 template <typename T>
 AddressPtr OptimizerInfoBuilder::GenInputAddrPtr(const std::string &optim_type, const std::string &input_name,
                                                  void *ps_data, const Lengths &ps_lens,
@@ -118,16 +128,9 @@ OptimizerInfo *MomentumOptimInfoBuilder::BuildInputs(const WeightPtr &weight, co
 
   AddressPtr accumulate = std::make_shared<kernel::Address>();
   MS_EXCEPTION_IF_NULL(accumulate);
-  accumulate->addr = new float[weight->size()];
+  accumulate->addr = NewStateBuffer(weight);
   MS_EXCEPTION_IF_NULL(accumulate->addr);
   accumulate->size = weight->size() * sizeof(float);
-  int64_t ret = memset_s(accumulate->addr, accumulate->size, 0x00, accumulate->size);
-  if (ret != 0) {
-    MS_LOG(EXCEPTION) << "memset_s error, errorno(" << ret << ")";
-    delete[] reinterpret_cast<float *>(accumulate->addr);
-    accumulate->addr = nullptr;
-    return nullptr;
-  }
 
   AddressPtr learning_rate = GenInputAddrPtr<float>(kApplyMomentum, "lr", values.data(), lens);
   AddressPtr gradient = GenInputAddrPtr<float>(kApplyMomentum, "grad", values.data(), lens);
@@ -146,31 +149,15 @@ OptimizerInfo *SparseAdamOptimInfoBuilder::BuildInputs(const WeightPtr &weight,
 
   AddressPtr m = std::make_shared<kernel::Address>();
   MS_EXCEPTION_IF_NULL(m);
-  m->addr = new float[weight->size()];
+  m->addr = NewStateBuffer(weight);
   MS_EXCEPTION_IF_NULL(m->addr);
   m->size = weight->size() * sizeof(float);
-  int64_t ret = memset_s(m->addr, m->size, 0x00, m->size);
-  if (ret != 0) {
-    MS_LOG(EXCEPTION) << "memset_s error, errorno(" << ret << ")";
-    delete[] reinterpret_cast<float *>(m->addr);
-    m->addr = nullptr;
-    return nullptr;
-  }
 
   AddressPtr v = std::make_shared<kernel::Address>();
   MS_EXCEPTION_IF_NULL(v);
-  v->addr = new float[weight->size()];
+  v->addr = NewStateBuffer(weight);
   MS_EXCEPTION_IF_NULL(v->addr);
   v->size = weight->size() * sizeof(float);
-  ret = memset_s(v->addr, v->size, 0x00, v->size);
-  if (ret != 0) {
-    MS_LOG(EXCEPTION) << "memset_s error, errorno(" << ret << ")";
-    delete[] reinterpret_cast<float *>(v->addr);
-    v->addr = nullptr;
-    delete[] reinterpret_cast<float *>(m->addr);
-    m->addr = nullptr;
-    return nullptr;
-  }
 
   AddressPtr beta1_power = GenInputAddrPtr<float>(kSparseAdam, "beta1_power", values.data(), lens);
   AddressPtr beta2_power = GenInputAddrPtr<float>(kSparseAdam, "beta2_power", values.data(), lens);
@@ -197,7 +184,7 @@ OptimizerInfo *SparseFtrlOptimInfoBuilder::BuildInputs(const WeightPtr &weight,
 
   AddressPtr accum = std::make_shared<kernel::Address>();
   MS_EXCEPTION_IF_NULL(accum);
-  accum->addr = new float[weight->size()];
+  accum->addr = NewStateBuffer(weight);
   MS_EXCEPTION_IF_NULL(accum->addr);
   accum->size = weight->size() * sizeof(float);
   for (size_t i = 0; i < weight->size(); i++) {
@@ -207,15 +194,8 @@ OptimizerInfo *SparseFtrlOptimInfoBuilder::BuildInputs(const WeightPtr &weight,
 
   AddressPtr linear = std::make_shared<kernel::Address>();
   MS_EXCEPTION_IF_NULL(linear);
-  linear->addr = new float[weight->size()];
+  linear->addr = NewStateBuffer(weight);
   MS_EXCEPTION_IF_NULL(linear->addr);
-  int64_t ret = memset_s(linear->addr, weight->size() * sizeof(float), 0x00, weight->size() * sizeof(float));
-  if (ret != 0) {
-    MS_LOG(EXCEPTION) << "memset_s error, errorno(" << ret << ")";
-    delete[] reinterpret_cast<float *>(linear->addr);
-    linear->addr = nullptr;
-    return nullptr;
-  }
   linear->size = weight->size() * sizeof(float);
 
   AddressPtr grad = GenInputAddrPtr<float>(kSparseFtrl, "grad", values.data(), lens, inputs_shape);
@@ -48,6 +48,8 @@ class OptimizerInfoBuilder {
   template <typename T>
   AddressPtr GenInputAddrPtr(const std::string &optim_type, const std::string &input_name, void *ps_data,
                              const Lengths &lens, const InputsShapePtr &inputs_shape = nullptr);
+  // Returns zeros as many as the elements of weight for an optimizer state, on disk if the weight is.
+  float *NewStateBuffer(const WeightPtr &weight) const;
   size_t worker_num_;
 };
 
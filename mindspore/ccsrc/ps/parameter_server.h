@@ -24,6 +24,11 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <numeric>
 #include <condition_variable>
 #include <thread>
 #include <cmath>
@@ -32,18 +37,25 @@
 #include <list>
 #include <map>
 #include <functional>
+#include <limits>
 #include "ir/func_graph.h"
 #include "backend/session/session_basic.h"
 #include "backend/session/anf_runtime_algorithm.h"
 #include "backend/session/session_factory.h"
 #include "ps/common.h"
+#include "ps/embedding_hot_rows.h"
+#include "ps/embedding_storage.h"
+#include "ps/gradient_codec.h"
 #include "ps/optimizer_info.h"
 #include "ps/optimizer_info_builder.h"
 #include "ps/util.h"
 #include "ps/ps_context.h"
+#include "ps/staleness_clock.h"
 #include "runtime/device/cpu/kernel_select_cpu.h"
 #include "utils/ms_context.h"
+#include "utils/ms_utils.h"
 #include "backend/kernel_compiler/kernel.h"
+#include "backend/kernel_compiler/cpu/cpu_kernel.h"
 #include "backend/kernel_compiler/cpu/cpu_kernel_factory.h"
 #include "backend/kernel_compiler/cpu/ps/pserver_kernel.h"
 #include "backend/kernel_compiler/cpu/ps/sparse_apply_adam_ps_kernel.h"
@@ -56,6 +68,8 @@
 
 namespace mindspore {
 namespace ps {
+// Keys are small consecutive integers, so each weight usually gets a stripe of its own.
+constexpr size_t kKeyLockStripeNum = 64;
 using mindspore::kernel::ps::PServerKernel;
 using AnfAlgo = session::AnfRuntimeAlgorithm;
 template <typename T>
@@ -79,6 +93,8 @@ class ParameterServer {
         func_graph_(nullptr),
         sess_(nullptr),
         running_(true),
+        staleness_clock_(nullptr),
+        staleness_lr_scale_(false),
         thread_(nullptr) {}
   ~ParameterServer() = default;
   ParameterServer(const ParameterServer &) = delete;
@@ -98,11 +114,14 @@ class ParameterServer {
     void HandleInitWeightToOptimId(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
                                    ::ps::KVPairs<T> *res);
     void HandleInitInputsShape(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
+    void HandleInitGradCodec(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleInitEmbeddings(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleCheckReadyForPush(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleCheckReadyForPull(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleEmbeddingLookup(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleUpdateEmbeddings(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
+    void HandlePullHotEmbeddings(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
+                                 ::ps::KVPairs<T> *res);
     void HandleFinalize(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
 
     ParameterServer *ps_;
@@ -118,6 +137,7 @@ class ParameterServer {
   void InitOptimInfoBuilders();
   void InitWeightKeyToOptims(const Key &key, const int64_t &optim_id);
   void InitOptimInputsShape(const Keys &keys, const Values &values, const Lengths &lengths);
+  void InitGradCodec(const Key &key, const GradCodecType &codec_type);
   void InitWeight(const Key &key, const WeightPtr &weight);
   void InitGrad(const Key &key, const GradPtr &grad);
   void InitEmbeddingTable(const Key &key,
@@ -126,16 +146,25 @@ class ParameterServer {
   bool HasWeight(const Key &key);
   void Finalize();
   void UpdateWeights();
-  void AccumGrad(const Keys &key, const Values &values, const Lengths &lengths);
-  WeightPtr weight(const Key &key);
+  void UpdateWeight(const Key &key);
+  void ExecuteOptimizer(const Key &key, size_t grad_divisor);
+  void AccumGrad(const Keys &key, const Values &values, const Lengths &lengths, int sender);
+  void DecodeGrad(const Key &key, const Values &values, const Lengths &lengths, Values *grad_values,
+                  Lengths *grad_lengths);
+  WeightPtr weight(const Key &key, int sender);
   void DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, ::ps::KVPairs<T> *res);
   void UpdateEmbeddings(const Key &key, const LookupIds &lookup_ids, const Values &vals);
+  void PrefetchEmbeddings(const Key &key, const LookupIds &lookup_ids);
+  void PullHotEmbeddings(const Key &key, size_t row_num, const Lengths &ids_and_hits, int sender,
+                         ::ps::KVPairs<T> *res);
   bool ReadyForUpdateWeights();
   bool ReadyForPush(const Key &key);
-  bool ReadyForPull(const Key &key);
+  bool ReadyForPull(const Key &key, int sender);
   void ResetGradAccumCount();
+  bool IsBoundedStaleness() const;
   const CNodePtr GetCNode(const std::string &name) const;
-  std::mutex &mutex();
+  std::shared_mutex &keys_mutex();
+  std::shared_mutex &key_mutex(const Key &key);
   void GetEmbeddingTableParamPtr();
   void SyncEmbeddingTables();
 
@@ -161,9 +190,24 @@ class ParameterServer {
   std::unordered_map<Key, WeightPtr> grads_;
   std::unordered_map<Key, size_t> grads_accum_counter_;
   std::unordered_map<Key, std::shared_ptr<PServerKernel>> embedding_lookup_ops_;
-  std::unordered_map<Key, uint64_t> tokens_;
-
-  std::mutex mutex_;
+  std::unordered_map<Key, std::atomic<uint64_t>> tokens_;
+  std::unordered_map<Key, GradientCodecPtr> grad_codecs_;
+  // The lookups of the rows of each embedding table, counted once a worker pulls the hot rows of the table.
+  std::unordered_map<Key, std::shared_ptr<EmbeddingAccessCounter>> access_counters_;
+
+  // Bounded staleness (SSP): a worker may push up to the staleness bound ahead of the slowest worker before its
+  // pulls wait, and gradients are applied as they arrive. nullptr keeps every step synchronous.
+  std::unique_ptr<StalenessClock> staleness_clock_;
+  // Divides a stale gradient by one plus the number of updates it missed.
+  bool staleness_lr_scale_;
+
+  // Lock order: keys_mutex_, then a key stripe, then update_mutex_.
+  // keys_mutex_ is taken exclusively only while keys are added, requests on existing keys take it shared.
+  std::shared_mutex keys_mutex_;
+  // Guards the data of the keys hashed to it, lookups of different tables don't wait on each other.
+  std::array<std::shared_mutex, kKeyLockStripeNum> key_mutexes_;
+  // Guards grad_accum_count_, grads_accum_counter_ and running_.
+  std::mutex update_mutex_;
   std::condition_variable apply_grads_cv_;
 
   std::unique_ptr<std::thread> thread_;
@@ -194,11 +238,13 @@ void ParameterServer<T>::ServerHandler::Init() {
   handlers_[kInitWeightsCmd] = &ServerHandler::HandleInitWeights;
   handlers_[kInitWeightToOptimIdCmd] = &ServerHandler::HandleInitWeightToOptimId;
   handlers_[kInitOptimInputsShapeCmd] = &ServerHandler::HandleInitInputsShape;
+  handlers_[kInitGradCodecCmd] = &ServerHandler::HandleInitGradCodec;
   handlers_[kInitEmbeddingsCmd] = &ServerHandler::HandleInitEmbeddings;
   handlers_[kCheckReadyForPushCmd] = &ServerHandler::HandleCheckReadyForPush;
   handlers_[kCheckReadyForPullCmd] = &ServerHandler::HandleCheckReadyForPull;
   handlers_[kEmbeddingLookupCmd] = &ServerHandler::HandleEmbeddingLookup;
   handlers_[kUpdateEmbeddingsCmd] = &ServerHandler::HandleUpdateEmbeddings;
+  handlers_[kPullHotEmbeddingsCmd] = &ServerHandler::HandlePullHotEmbeddings;
   handlers_[kFinalizeCmd] = &ServerHandler::HandleFinalize;
 }
 
@@ -206,7 +252,7 @@ template <typename T>
 void ParameterServer<T>::ServerHandler::HandlePushReq(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
                                                       ::ps::KVPairs<T> *res) {
   MS_EXCEPTION_IF_NULL(res);
-  ps_->AccumGrad(req_data.keys, req_data.vals, req_data.lens);
+  ps_->AccumGrad(req_data.keys, req_data.vals, req_data.lens, req_meta.sender);
 }
 
 template <typename T>
@@ -215,13 +261,13 @@ void ParameterServer<T>::ServerHandler::HandlePullReq(const ::ps::KVMeta &req_me
   MS_EXCEPTION_IF_NULL(res);
   res->keys = req_data.keys;
   ::ps::Key key = req_data.keys[0];
-  res->vals = *(ps_->weight(key));
+  res->vals = *(ps_->weight(key, req_meta.sender));
 }
 
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitWeights(const ::ps::KVMeta &req_meta,
                                                           const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->keys_mutex());
   MS_EXCEPTION_IF_NULL(res);
   size_t key_num = req_data.keys.size();
   T *data_ptr = req_data.vals.data();
@@ -248,7 +294,7 @@ template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitWeightToOptimId(const ::ps::KVMeta &req_meta,
                                                                   const ::ps::KVPairs<T> &req_data,
                                                                   ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->keys_mutex());
   MS_EXCEPTION_IF_NULL(res);
   size_t key_num = req_data.keys.size();
   for (size_t i = 0; i < key_num; i++) {
@@ -266,7 +312,7 @@ void ParameterServer<T>::ServerHandler::HandleInitWeightToOptimId(const ::ps::KV
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitInputsShape(const ::ps::KVMeta &req_meta,
                                                               const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->keys_mutex());
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
   if (init_optim_info_[key]) {
@@ -277,10 +323,19 @@ void ParameterServer<T>::ServerHandler::HandleInitInputsShape(const ::ps::KVMeta
   ps_->InitOptimInputsShape(req_data.keys, req_data.vals, req_data.lens);
 }
 
+template <typename T>
+void ParameterServer<T>::ServerHandler::HandleInitGradCodec(const ::ps::KVMeta &req_meta,
+                                                            const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
+  std::unique_lock<std::shared_mutex> lock(ps_->keys_mutex());
+  MS_EXCEPTION_IF_NULL(res);
+  const Key &key = req_data.keys[0];
+  ps_->InitGradCodec(key, static_cast<GradCodecType>(req_data.vals[0]));
+}
+
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitEmbeddings(const ::ps::KVMeta &req_meta,
                                                              const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->keys_mutex());
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
   MS_LOG(INFO) << "Initializing embedding table for key:" << key;
@@ -338,7 +393,7 @@ void ParameterServer<T>::ServerHandler::HandleCheckReadyForPull(const ::ps::KVMe
                                                                 ::ps::KVPairs<T> *res) {
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
-  bool ready = ps_->ReadyForPull(key);
+  bool ready = ps_->ReadyForPull(key, req_meta.sender);
   res->keys.push_back(key);
   res->vals.push_back(ready);
 }
@@ -358,7 +413,6 @@ template <typename T>
 void ParameterServer<T>::ServerHandler::HandleUpdateEmbeddings(const ::ps::KVMeta &req_meta,
                                                                const ::ps::KVPairs<T> &req_data,
                                                                ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
   const LookupIds &lookup_ids = req_data.keys.segment(1, req_data.keys.size());
@@ -366,11 +420,25 @@ void ParameterServer<T>::ServerHandler::HandleUpdateEmbeddings(const ::ps::KVMet
   ps_->UpdateEmbeddings(key, lookup_ids, update_vals);
 }
 
+template <typename T>
+void ParameterServer<T>::ServerHandler::HandlePullHotEmbeddings(const ::ps::KVMeta &req_meta,
+                                                                const ::ps::KVPairs<T> &req_data,
+                                                                ::ps::KVPairs<T> *res) {
+  MS_EXCEPTION_IF_NULL(res);
+  const Key &key = req_data.keys[0];
+  size_t row_num = req_data.vals.empty() ? 0 : static_cast<size_t>(req_data.vals[0]);
+  res->keys.push_back(key);
+  ps_->PullHotEmbeddings(key, row_num, req_data.lens, req_meta.sender, res);
+}
+
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleFinalize(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
                                                        ::ps::KVPairs<T> *res) {
   MS_EXCEPTION_IF_NULL(res);
-  ps_->Finalize();
+  // in SSP mode the workers finish at different steps, the others still push until they finish too
+  if (!ps_->IsBoundedStaleness() || ps_->staleness_clock_->Finish(req_meta.sender)) {
+    ps_->Finalize();
+  }
 }
 
 template <typename T>
@@ -382,6 +450,19 @@ bool ParameterServer<T>::Init(const FuncGraphPtr &func_graph) {
   handler_.reset(new ServerHandler(this));
   handler_->Init();
 
+  std::string staleness = common::GetEnv(kEnvStaleness);
+  if (!staleness.empty()) {
+    std::string timeout = common::GetEnv(kEnvStalenessTimeout);
+    uint64_t timeout_seconds =
+      timeout.empty() ? kDefaultStalenessTimeout : ParseStalenessEnv(kEnvStalenessTimeout, timeout);
+    staleness_clock_.reset(new StalenessClock(worker_num_, ParseStalenessEnv(kEnvStaleness, staleness),
+                                              std::chrono::seconds(timeout_seconds)));
+    staleness_lr_scale_ = common::GetEnv(kEnvStalenessLrScale) == "1";
+    MS_LOG(INFO) << "Workers run asynchronously with staleness bound " << staleness_clock_->staleness()
+                 << ", timeout " << timeout_seconds << "s, scale stale gradients: " << staleness_lr_scale_;
+  }
+  EmbeddingStorage::GetInstance().Initialize(common::GetEnv(kEnvEmbeddingStorageDir));
+
   InitOptimInfoBuilders();
   ps_->set_request_handle(*handler_);
   thread_.reset(new std::thread(&ParameterServer::UpdateWeights, this));
@@ -412,6 +493,21 @@ void ParameterServer<T>::InitWeightKeyToOptims(const Key &key, const int64_t &op
                << ", optimizer op name:" << weight_key_to_optim_op_[key];
 }
 
+template <typename T>
+void ParameterServer<T>::InitGradCodec(const Key &key, const GradCodecType &codec_type) {
+  auto iter = grad_codecs_.find(key);
+  if (iter != grad_codecs_.end()) {
+    if (iter->second->type() != codec_type) {
+      MS_LOG(EXCEPTION) << "Workers push the gradient of key " << key << " with different codecs "
+                        << iter->second->type() << " and " << codec_type;
+    }
+    return;
+  }
+  // The top-k ratio is only used by the encoder.
+  grad_codecs_[key] = CreateGradientCodec(codec_type, 1);
+  MS_LOG(INFO) << "Initializing gradient codec for key:" << key << ", codec:" << codec_type;
+}
+
 template <typename T>
 void ParameterServer<T>::InitOptimInputsShape(const Keys &keys, const Values &values, const Lengths &lengths) {
   InputsShapePtr inputs_shape = std::make_shared<InputsShape>();
@@ -465,6 +561,10 @@ void ParameterServer<T>::InitOptimInputsShape(const Keys &keys, const Values &va
         optimizer->InitKernel(cnode, optim_inputs_shape_[key]);
         optimizers_[key] = optimizer;
       }
+      // the slot is reserved here, so that pushes only fill it in under the lock of their key
+      if (optimizers_.count(key) > 0) {
+        optim_infos_.emplace(key, nullptr);
+      }
     }
   }
 }
@@ -498,6 +598,7 @@ void ParameterServer<T>::InitGrad(const Key &key, const GradPtr &grad) {
   MS_EXCEPTION_IF_NULL(grad);
   if (grads_.count(key) == 0) {
     grads_[key] = grad;
+    std::lock_guard<std::mutex> lock(update_mutex_);
     grads_accum_counter_[key] = 0;
   }
 }
@@ -517,7 +618,9 @@ void ParameterServer<T>::InitEmbeddingTable(
     const std::vector<size_t> &input_shapes = lookup->input_sizes();
     size_t total_dims =
       std::accumulate(input_shapes.begin(), input_shapes.end(), IntToSize(1), std::multiplies<size_t>());
-    WeightPtr embedding = std::make_shared<Weight>(total_dims, 0);
+    auto &storage = EmbeddingStorage::GetInstance();
+    WeightPtr embedding =
+      storage.enable() ? storage.AllocateWeight(total_dims) : std::make_shared<Weight>(total_dims, 0);
     MS_EXCEPTION_IF_NULL(embedding);
     T *embedding_data = embedding->data();
     std::default_random_engine engine;
@@ -538,7 +641,10 @@ void ParameterServer<T>::InitEmbeddingTable(
     weights_[key] = embedding;
     tokens_[key] = 0;
     is_embedding_[key] = true;
+    // the slot is reserved here, the counter is created under the lock of the key
+    access_counters_.emplace(key, nullptr);
 
+    std::lock_guard<std::mutex> lock(update_mutex_);
     grads_accum_counter_[key] = 0;
   }
 }
@@ -550,7 +656,10 @@ bool ParameterServer<T>::HasWeight(const Key &key) {
 
 template <typename T>
 void ParameterServer<T>::Finalize() {
-  running_ = false;
+  {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    running_ = false;
+  }
   apply_grads_cv_.notify_one();
   SyncEmbeddingTables();
 }
@@ -558,77 +667,123 @@ void ParameterServer<T>::Finalize() {
 template <typename T>
 void ParameterServer<T>::UpdateWeights() {
   while (true) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    apply_grads_cv_.wait(lock, [this] { return this->ReadyForUpdateWeights() || !running_; });
-    if (!running_) {
-      break;
+    {
+      std::unique_lock<std::mutex> lock(update_mutex_);
+      apply_grads_cv_.wait(lock, [this] { return this->ReadyForUpdateWeights() || !running_; });
+      if (!running_) {
+        break;
+      }
     }
 
+    std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
+    std::vector<Key> keys;
     for (auto iter = weights_.begin(); iter != weights_.end(); iter++) {
-      Key key = iter->first;
-      WeightPtr weight_ptr = iter->second;
-
-      std::shared_ptr<PServerKernel> optimizer = nullptr;
-      if (weight_key_to_optims_.count(key) > 0) {
-        optimizer = optimizers_[key];
-      }
-      MS_EXCEPTION_IF_NULL(optimizer);
-
-      std::shared_ptr<OptimizerInfo> optim_info = optim_infos_[key];
-      if (optim_info != nullptr) {
-        const std::vector<kernel::AddressPtr> &inputs = optim_info->inputs();
-        const std::vector<kernel::AddressPtr> &workspaces = optim_info->workspaces();
-        const std::vector<kernel::AddressPtr> &outputs = optim_info->outputs();
-
-        std::vector<std::vector<size_t>> shapes = {};
-        std::vector<size_t> indices_shape = {};
-        indices_shape.emplace_back(optim_info->indice_size());
-        shapes.push_back(indices_shape);
-
-        if (original_optim_inputs_shape_.count(key) != 0) {
-          for (auto input_shapes : *(original_optim_inputs_shape_[key])) {
-            shapes.push_back(*input_shapes);
-          }
+      keys.push_back(iter->first);
+    }
+    // The keys are handed out largest first to whichever thread is free, a big embedding table starts early
+    // instead of holding up the end of the round.
+    std::sort(keys.begin(), keys.end(),
+              [this](const Key &a, const Key &b) { return weights_.at(a)->size() > weights_.at(b)->size(); });
+    std::atomic<size_t> next_key(0);
+    size_t task_num = std::min(keys.size(), kernel::CPUKernelUtils::GetParallelThreadNum());
+    kernel::CPUKernelUtils::ParallelFor(
+      [this, &keys, &next_key](size_t, size_t) {
+        for (size_t i = next_key++; i < keys.size(); i = next_key++) {
+          UpdateWeight(keys[i]);
         }
-        optimizer->ReInit(shapes);
-        optim_info->ComputeMean(shapes, worker_num_, pserver_num_, rank_id_);
-        optimizer->Execute(inputs, workspaces, outputs);
-        optim_info->Reset();
-      }
-      if (!is_embedding_[key]) {
-        tokens_[key] = worker_num_;
+      },
+      task_num);
+    ResetGradAccumCount();
+  }
+}
+
+template <typename T>
+void ParameterServer<T>::UpdateWeight(const Key &key) {
+  std::unique_lock<std::shared_mutex> lock(key_mutex(key));
+  ExecuteOptimizer(key, worker_num_);
+  if (!is_embedding_.at(key)) {
+    tokens_.at(key) = worker_num_;
+  }
+}
+
+// Applies the gradients accumulated for key divided by grad_divisor, the caller holds the stripe of key.
+template <typename T>
+void ParameterServer<T>::ExecuteOptimizer(const Key &key, size_t grad_divisor) {
+  std::shared_ptr<PServerKernel> optimizer = nullptr;
+  auto optimizer_iter = optimizers_.find(key);
+  if (weight_key_to_optims_.count(key) > 0 && optimizer_iter != optimizers_.end()) {
+    optimizer = optimizer_iter->second;
+  }
+  MS_EXCEPTION_IF_NULL(optimizer);
+
+  auto optim_info_iter = optim_infos_.find(key);
+  std::shared_ptr<OptimizerInfo> optim_info = optim_info_iter == optim_infos_.end() ? nullptr : optim_info_iter->second;
+  if (optim_info != nullptr) {
+    const std::vector<kernel::AddressPtr> &inputs = optim_info->inputs();
+    const std::vector<kernel::AddressPtr> &workspaces = optim_info->workspaces();
+    const std::vector<kernel::AddressPtr> &outputs = optim_info->outputs();
+
+    std::vector<std::vector<size_t>> shapes = {};
+    std::vector<size_t> indices_shape = {};
+    indices_shape.emplace_back(optim_info->indice_size());
+    shapes.push_back(indices_shape);
+
+    if (original_optim_inputs_shape_.count(key) != 0) {
+      for (auto input_shapes : *(original_optim_inputs_shape_.at(key))) {
+        shapes.push_back(*input_shapes);
       }
     }
-    ResetGradAccumCount();
+    optimizer->ReInit(shapes);
+    optim_info->ComputeMean(shapes, grad_divisor, pserver_num_, rank_id_);
+    optimizer->Execute(inputs, workspaces, outputs);
+    optim_info->Reset();
   }
 }
 
 template <typename T>
-void ParameterServer<T>::AccumGrad(const Keys &keys, const Values &values, const Lengths &lengths) {
-  std::unique_lock<std::mutex> lock(mutex_);
+void ParameterServer<T>::AccumGrad(const Keys &keys, const Values &values, const Lengths &lengths, int sender) {
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
   const Key &key = keys[0];
   bool no_sparse_grad = values.size() == 1 && values[0] == -100;
+  std::unique_lock<std::shared_mutex> key_lock(key_mutex(key), std::defer_lock);
   if (!no_sparse_grad) {
-    std::shared_ptr<OptimizerInfo> optim_info = optim_infos_[key];
+    Values grad_values = values;
+    Lengths grad_lengths = lengths;
+    if (grad_codecs_.count(key) > 0) {
+      DecodeGrad(key, values, lengths, &grad_values, &grad_lengths);
+    }
+    key_lock.lock();
+    auto optim_info_iter = optim_infos_.find(key);
+    if (optim_info_iter == optim_infos_.end()) {
+      MS_LOG(EXCEPTION) << "no optimizer found for key " << key;
+    }
+    std::shared_ptr<OptimizerInfo> &optim_info = optim_info_iter->second;
 
     // Create or update the optimizer info
     if (optim_info == nullptr) {
-      const std::shared_ptr<OptimizerInfoBuilder> &builder = optim_info_builders_[weight_key_to_optims_[key]];
-      std::shared_ptr<kernel::ps::PServerKernel> pserver_kernel = optimizers_[key];
-      if (pserver_kernel == nullptr) {
-        MS_LOG(EXCEPTION) << "no optimizer found for key " << key << " optim name " << weight_key_to_optims_[key];
-      }
+      const std::shared_ptr<OptimizerInfoBuilder> &builder = optim_info_builders_.at(weight_key_to_optims_.at(key));
+      std::shared_ptr<kernel::ps::PServerKernel> pserver_kernel = optimizers_.at(key);
       MS_EXCEPTION_IF_NULL(pserver_kernel);
-      OptimizerInfo *optim = builder->Build(pserver_kernel, weights_[key], keys, values, lengths,
-                                            optim_inputs_shape_[key], worker_num_, is_embedding_[key]);
+      OptimizerInfo *optim = builder->Build(pserver_kernel, weights_.at(key), keys, grad_values, grad_lengths,
+                                            optim_inputs_shape_.at(key), worker_num_, is_embedding_.at(key));
       optim_info.reset(optim);
-      optim_infos_[key] = optim_info;
     } else {
-      optim_info->Update(values, lengths);
-      optim_info->Accumulate(values, lengths);
+      optim_info->Update(grad_values, grad_lengths);
+      optim_info->Accumulate(grad_values, grad_lengths);
+    }
+    if (IsBoundedStaleness()) {
+      size_t staleness = staleness_lr_scale_ ? staleness_clock_->GradStaleness(key, sender) : 0;
+      ExecuteOptimizer(key, worker_num_ * (1 + staleness));
+      staleness_clock_->Push(key, sender, true);
+      return;
     }
   }
 
+  if (IsBoundedStaleness()) {
+    staleness_clock_->Push(key, sender, false);
+    return;
+  }
+  std::lock_guard<std::mutex> update_lock(update_mutex_);
   grads_accum_counter_[key] += 1;
   if (grads_accum_counter_[key] == worker_num_) {
     grad_accum_count_++;
@@ -639,23 +794,61 @@ void ParameterServer<T>::AccumGrad(const Keys &keys, const Values &values, const
 }
 
 template <typename T>
-WeightPtr ParameterServer<T>::weight(const Key &key) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (weights_.count(key) == 0) {
+void ParameterServer<T>::DecodeGrad(const Key &key, const Values &values, const Lengths &lengths, Values *grad_values,
+                                    Lengths *grad_lengths) {
+  MS_EXCEPTION_IF_NULL(grad_values);
+  MS_EXCEPTION_IF_NULL(grad_lengths);
+  const GradientCodecPtr &codec = grad_codecs_.at(key);
+  MS_EXCEPTION_IF_NULL(codec);
+  size_t grad_index = kOptimToPSSendIdx.at(weight_key_to_optims_.at(key)).at("grad");
+  if (grad_index >= lengths.size()) {
+    MS_LOG(EXCEPTION) << "The gradient index " << grad_index << " is out of the " << lengths.size() << " inputs.";
+  }
+  size_t grad_offset = std::accumulate(lengths.begin(), lengths.begin() + grad_index, 0);
+  size_t encoded_size = lengths[grad_index];
+  if (grad_offset + encoded_size > values.size()) {
+    MS_LOG(EXCEPTION) << "The encoded gradient of key " << key << " is out of the " << values.size() << " values.";
+  }
+  std::vector<float> grad;
+  (void)codec->Decode(values.data() + grad_offset, encoded_size, &grad);
+
+  Values decoded_values(values.size() - encoded_size + grad.size(), 0);
+  T *dst = decoded_values.data();
+  dst = std::copy(values.data(), values.data() + grad_offset, dst);
+  dst = std::copy(grad.begin(), grad.end(), dst);
+  (void)std::copy(values.data() + grad_offset + encoded_size, values.data() + values.size(), dst);
+  Lengths decoded_lengths;
+  decoded_lengths.CopyFrom(lengths);
+  decoded_lengths[grad_index] = SizeToInt(grad.size());
+  *grad_values = decoded_values;
+  *grad_lengths = decoded_lengths;
+}
+
+template <typename T>
+WeightPtr ParameterServer<T>::weight(const Key &key, int sender) {
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
+  auto iter = weights_.find(key);
+  if (iter == weights_.end() || tokens_.count(key) == 0) {
     MS_LOG(EXCEPTION) << "Invalid weight key " << key;
   }
-  WeightPtr weight_ptr = weights_[key];
+  // pulls only read the weight, they run concurrently with each other
+  std::shared_lock<std::shared_mutex> key_lock(key_mutex(key));
+  WeightPtr weight_ptr = iter->second;
   MS_EXCEPTION_IF_NULL(weight_ptr);
   WeightPtr copy_weight_ptr = std::make_shared<::ps::SArray<T>>(weight_ptr->size(), 0);
   MS_EXCEPTION_IF_NULL(copy_weight_ptr);
   copy_weight_ptr->CopyFrom(weight_ptr->data(), weight_ptr->size());
-  tokens_[key] -= 1;
+  if (IsBoundedStaleness()) {
+    staleness_clock_->Pull(key, sender);
+  } else {
+    tokens_.at(key) -= 1;
+  }
   return copy_weight_ptr;
 }
 
 template <typename T>
 void ParameterServer<T>::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
   MS_EXCEPTION_IF_NULL(res);
   if (weights_.count(key) == 0) {
     MS_LOG(ERROR) << "Invalid embedding table key " << key;
@@ -665,10 +858,17 @@ void ParameterServer<T>::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids,
     MS_LOG(ERROR) << "Invalid embedding lookup op key " << key;
     return;
   }
-  WeightPtr table_ptr = weights_[key];
+  PrefetchEmbeddings(key, lookup_ids);
+  // the lookup kernel is reshaped for every request, so lookups of one table are exclusive
+  std::unique_lock<std::shared_mutex> key_lock(key_mutex(key));
+  WeightPtr table_ptr = weights_.at(key);
   MS_EXCEPTION_IF_NULL(table_ptr);
-  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_[key];
+  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_.at(key);
   MS_EXCEPTION_IF_NULL(table_lookup_op);
+  auto counter_iter = access_counters_.find(key);
+  if (counter_iter != access_counters_.end() && counter_iter->second != nullptr) {
+    counter_iter->second->Record(lookup_ids.data(), lookup_ids.size());
+  }
 
   // Update shapes of lookup operator
   std::vector<std::vector<size_t>> shapes = {};
@@ -714,6 +914,7 @@ void ParameterServer<T>::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids,
 
 template <typename T>
 void ParameterServer<T>::UpdateEmbeddings(const Key &key, const LookupIds &lookup_ids, const Values &vals) {
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
   if (weights_.count(key) == 0) {
     MS_LOG(ERROR) << "Invalid embedding table key " << key;
     return;
@@ -722,13 +923,95 @@ void ParameterServer<T>::UpdateEmbeddings(const Key &key, const LookupIds &looku
     MS_LOG(ERROR) << "Invalid embedding lookup op key " << key;
     return;
   }
-  WeightPtr table_ptr = weights_[key];
+  PrefetchEmbeddings(key, lookup_ids);
+  std::unique_lock<std::shared_mutex> key_lock(key_mutex(key));
+  WeightPtr table_ptr = weights_.at(key);
   MS_EXCEPTION_IF_NULL(table_ptr);
-  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_[key];
+  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_.at(key);
   MS_EXCEPTION_IF_NULL(table_lookup_op);
   table_lookup_op->UpdateEmbeddings(table_ptr->data(), lookup_ids.data(), vals.data(), lookup_ids.size());
 }
 
+// Reads the rows of a table on disk before the stripe of key is taken, the disk works while the request waits.
+// The caller holds keys_mutex_.
+template <typename T>
+void ParameterServer<T>::PrefetchEmbeddings(const Key &key, const LookupIds &lookup_ids) {
+  auto &storage = EmbeddingStorage::GetInstance();
+  const WeightPtr &table_ptr = weights_.at(key);
+  if (!storage.enable() || table_ptr == nullptr || !storage.IsFileBacked(table_ptr->data())) {
+    return;
+  }
+  auto lookup = std::dynamic_pointer_cast<kernel::ps::EmbeddingLookUpPSKernel>(embedding_lookup_ops_.at(key));
+  MS_EXCEPTION_IF_NULL(lookup);
+  const std::vector<size_t> &input_shapes = lookup->input_sizes();
+  if (input_shapes.empty() || input_shapes[0] == 0) {
+    return;
+  }
+  size_t row_size = table_ptr->size() / input_shapes[0];
+  storage.Prefetch(table_ptr->data(), table_ptr->size(), row_size, lookup->offset(), lookup_ids.data(),
+                   lookup_ids.size());
+}
+
+// Returns the row_num rows of the shard of key looked up the most, their values in res->vals. res->lens holds the
+// pushes of the table sender may make before its copies fall out of the staleness bound, the number of rows and
+// their ids. ids_and_hits are the lookups the worker served from its copies of the rows since its last pull.
+template <typename T>
+void ParameterServer<T>::PullHotEmbeddings(const Key &key, size_t row_num, const Lengths &ids_and_hits, int sender,
+                                           ::ps::KVPairs<T> *res) {
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
+  MS_EXCEPTION_IF_NULL(res);
+  auto counter_iter = access_counters_.find(key);
+  if (counter_iter == access_counters_.end() || embedding_lookup_ops_.count(key) == 0) {
+    MS_LOG(ERROR) << "Invalid embedding table key " << key;
+    return;
+  }
+  // the table is only read here, the counter has a lock of its own
+  std::shared_lock<std::shared_mutex> key_lock(key_mutex(key));
+  auto lookup = std::dynamic_pointer_cast<kernel::ps::EmbeddingLookUpPSKernel>(embedding_lookup_ops_.at(key));
+  MS_EXCEPTION_IF_NULL(lookup);
+  const WeightPtr &table_ptr = weights_.at(key);
+  MS_EXCEPTION_IF_NULL(table_ptr);
+  const std::vector<size_t> &input_shapes = lookup->input_sizes();
+  if (input_shapes.empty() || input_shapes[0] == 0) {
+    return;
+  }
+  size_t first_id = lookup->offset();
+  if (counter_iter->second == nullptr) {
+    // the counter is created by the first pull, the lookups read it under the exclusive lock
+    key_lock.unlock();
+    {
+      std::unique_lock<std::shared_mutex> create_lock(key_mutex(key));
+      if (counter_iter->second == nullptr) {
+        counter_iter->second = std::make_shared<EmbeddingAccessCounter>(
+          input_shapes[0], first_id, std::max(row_num * kHotRowCandidateFactor, kMinHotRowCandidates));
+      }
+    }
+    key_lock.lock();
+  }
+  const std::shared_ptr<EmbeddingAccessCounter> &counter = counter_iter->second;
+  for (size_t i = 0; i + 1 < ids_and_hits.size(); i += 2) {
+    counter->Record(static_cast<Key>(ids_and_hits[i]), static_cast<uint32_t>(ids_and_hits[i + 1]));
+  }
+
+  // the copies are stale reads, they are only handed out within the staleness bound of the SSP mode
+  uint64_t push_slack = 0;
+  if (!IsBoundedStaleness() || !staleness_clock_->PushSlack(key, sender, &push_slack)) {
+    res->lens.push_back(0);
+    res->lens.push_back(0);
+    return;
+  }
+  std::vector<Key> hot_ids = counter->HotRows(row_num);
+  size_t row_size = table_ptr->size() / input_shapes[0];
+  res->lens.push_back(static_cast<int>(std::min<uint64_t>(push_slack, std::numeric_limits<int>::max())));
+  res->lens.push_back(SizeToInt(hot_ids.size()));
+  res->vals = Values(hot_ids.size() * row_size, 0);
+  for (size_t i = 0; i < hot_ids.size(); i++) {
+    const T *row = table_ptr->data() + (hot_ids[i] - first_id) * row_size;
+    (void)std::copy(row, row + row_size, res->vals.data() + i * row_size);
+    res->lens.push_back(static_cast<int>(hot_ids[i]));
+  }
+}
+
 template <typename T>
 inline bool ParameterServer<T>::ReadyForUpdateWeights() {
   return grads_accum_counter_.size() > 0 && grad_accum_count_ == grads_accum_counter_.size();
@@ -736,25 +1019,36 @@ inline bool ParameterServer<T>::ReadyForUpdateWeights() {
 
 template <typename T>
 inline bool ParameterServer<T>::ReadyForPush(const Key &key) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
   if (weights_.empty()) {
     MS_LOG(EXCEPTION) << "The weights in server is empty. Many reasons could cause this: 1.The Worker didn't send "
                          "kInitWeightsCmd command. 2.The Server failed to initialize weights.";
   }
-  return grad_accum_count_ < weights_.size() && tokens_[key] <= 0;
+  if (IsBoundedStaleness()) {
+    return true;
+  }
+  auto iter = tokens_.find(key);
+  uint64_t tokens = iter == tokens_.end() ? 0 : iter->second.load();
+  std::lock_guard<std::mutex> update_lock(update_mutex_);
+  return grad_accum_count_ < weights_.size() && tokens <= 0;
 }
 
 template <typename T>
-inline bool ParameterServer<T>::ReadyForPull(const Key &key) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (tokens_.count(key) == 0 || weights_[key] == 0) {
+inline bool ParameterServer<T>::ReadyForPull(const Key &key, int sender) {
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
+  auto iter = weights_.find(key);
+  if (tokens_.count(key) == 0 || iter == weights_.end() || iter->second == nullptr) {
     MS_LOG(EXCEPTION) << "Invalid weight key " << key;
   }
-  return tokens_[key] > 0;
+  if (IsBoundedStaleness()) {
+    return staleness_clock_->ReadyForPull(key, sender);
+  }
+  return tokens_.at(key) > 0;
 }
 
 template <typename T>
 inline void ParameterServer<T>::ResetGradAccumCount() {
+  std::lock_guard<std::mutex> lock(update_mutex_);
   grad_accum_count_ = 0;
   for (auto iter = grads_accum_counter_.begin(); iter != grads_accum_counter_.end(); iter++) {
     grads_accum_counter_[iter->first] = 0;
@@ -762,8 +1056,18 @@ inline void ParameterServer<T>::ResetGradAccumCount() {
 }
 
 template <typename T>
-inline std::mutex &ParameterServer<T>::mutex() {
-  return mutex_;
+inline bool ParameterServer<T>::IsBoundedStaleness() const {
+  return staleness_clock_ != nullptr;
+}
+
+template <typename T>
+inline std::shared_mutex &ParameterServer<T>::keys_mutex() {
+  return keys_mutex_;
+}
+
+template <typename T>
+inline std::shared_mutex &ParameterServer<T>::key_mutex(const Key &key) {
+  return key_mutexes_[key % kKeyLockStripeNum];
 }
 
 template <typename T>
@@ -786,13 +1090,15 @@ void ParameterServer<T>::GetEmbeddingTableParamPtr() {
 
 template <typename T>
 void ParameterServer<T>::SyncEmbeddingTables() {
+  std::shared_lock<std::shared_mutex> keys_lock(keys_mutex_);
   for (auto embedding_table : embedding_tables_) {
     Key key = embedding_table.first;
     if (embedding_lookup_ops_.count(key) == 0) {
       MS_LOG(WARNING) << "Can't find look up PS kernel for key " << key;
       continue;
     }
-    auto lookup = embedding_lookup_ops_[key];
+    std::shared_lock<std::shared_mutex> key_lock(key_mutex(key));
+    auto lookup = embedding_lookup_ops_.at(key);
     const std::vector<size_t> &input_shapes = lookup->input_sizes();
     std::vector<int64_t> new_tensor_shape(input_shapes.begin(), input_shapes.end());
 
@@ -800,14 +1106,14 @@ void ParameterServer<T>::SyncEmbeddingTables() {
     MS_EXCEPTION_IF_NULL(new_tensor);
     float *new_tensor_data_ptr = reinterpret_cast<float *>(new_tensor->data_c());
     size_t new_tensor_size = static_cast<size_t>(new_tensor->data().nbytes());
-    size_t embedding_table_size = weights_[key]->size() * sizeof(float);
+    size_t embedding_table_size = weights_.at(key)->size() * sizeof(float);
     if (new_tensor_size != embedding_table_size) {
       MS_LOG(EXCEPTION) << "Shape of embedding table can't match. New tensor size:" << new_tensor_size
                         << ", embedding_table size:" << embedding_table_size;
     }
     MS_EXCEPTION_IF_NULL(new_tensor_data_ptr);
-    MS_EXCEPTION_IF_NULL(weights_[key]->data());
-    int64_t ret = memcpy_s(new_tensor_data_ptr, new_tensor_size, weights_[key]->data(), embedding_table_size);
+    MS_EXCEPTION_IF_NULL(weights_.at(key)->data());
+    int64_t ret = memcpy_s(new_tensor_data_ptr, new_tensor_size, weights_.at(key)->data(), embedding_table_size);
     if (ret != 0) {
       MS_LOG(EXCEPTION) << "memcpy_s error, errorno(" << ret << ")";
       return;
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/ps_cache/embedding_cache_policy.h"
+#include <algorithm>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+ListCachePolicy::ListCachePolicy(size_t capacity, size_t list_num)
+    : capacity_(capacity), prev_(capacity + list_num), next_(capacity + list_num) {
+  for (size_t i = 0; i < prev_.size(); ++i) {
+    prev_[i] = static_cast<int>(i);
+    next_[i] = static_cast<int>(i);
+  }
+}
+
+void ListCachePolicy::PushFront(size_t list, int index) {
+  int head = static_cast<int>(capacity_ + list);
+  int first = next_[head];
+  prev_[index] = head;
+  next_[index] = first;
+  prev_[first] = index;
+  next_[head] = index;
+}
+
+void ListCachePolicy::Unlink(int index) {
+  next_[prev_[index]] = next_[index];
+  prev_[next_[index]] = prev_[index];
+  prev_[index] = index;
+  next_[index] = index;
+}
+
+int ListCachePolicy::VictimInList(size_t list, const std::function<bool(int)> &evictable) const {
+  int head = static_cast<int>(capacity_ + list);
+  for (int index = prev_[head]; index != head; index = prev_[index]) {
+    if (evictable(index)) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+void LruCachePolicy::Access(int index) {
+  Unlink(index);
+  PushFront(0, index);
+}
+
+void LfuCachePolicy::Insert(int index) {
+  counts_[index] = 0;
+  PushFront(0, index);
+}
+
+void LfuCachePolicy::Access(int index) {
+  Unlink(index);
+  counts_[index] = std::min<uint8_t>(counts_[index] + 1, kLfuMaxCount);
+  PushFront(counts_[index], index);
+}
+
+int LfuCachePolicy::Victim(const std::function<bool(int)> &evictable) const {
+  for (size_t count = 0; count <= kLfuMaxCount; ++count) {
+    int index = VictimInList(count, evictable);
+    if (index >= 0) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+EmbeddingCachePolicyPtr CreateEmbeddingCachePolicy(CachePolicyType type, size_t capacity) {
+  if (type == kCacheLFU) {
+    return std::make_unique<LfuCachePolicy>(capacity);
+  }
+  return std::make_unique<LruCachePolicy>(capacity);
+}
+
+CachePolicyType CachePolicyTypeFromName(const std::string &name) {
+  if (name.empty() || name == "lru") {
+    return kCacheLRU;
+  } else if (name == "lfu") {
+    return kCacheLFU;
+  }
+  MS_LOG(EXCEPTION) << "Invalid embedding cache policy " << name << ", it should be lru or lfu.";
+}
+}  // namespace ps
+}  // namespace mindspore
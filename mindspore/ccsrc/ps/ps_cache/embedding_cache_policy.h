@@ -0,0 +1,90 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_CACHE_POLICY_H_
+#define MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_CACHE_POLICY_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mindspore {
+namespace ps {
+enum CachePolicyType { kCacheLRU = 0, kCacheLFU };
+
+// Decides which index of an embedding cache is evicted when an id is inserted into a full cache.
+class EmbeddingCachePolicy {
+ public:
+  virtual ~EmbeddingCachePolicy() = default;
+  virtual void Insert(int index) = 0;
+  virtual void Access(int index) = 0;
+  virtual void Erase(int index) = 0;
+  // Returns the evictable index of the least value, or -1 if no index is evictable.
+  virtual int Victim(const std::function<bool(int)> &evictable) const = 0;
+};
+using EmbeddingCachePolicyPtr = std::unique_ptr<EmbeddingCachePolicy>;
+
+// Keeps the indexes in intrusive doubly linked lists, the most recent one at the front of its list.
+class ListCachePolicy : public EmbeddingCachePolicy {
+ public:
+  ListCachePolicy(size_t capacity, size_t list_num);
+  ~ListCachePolicy() override = default;
+
+ protected:
+  void PushFront(size_t list, int index);
+  void Unlink(int index);
+  // Walks a list from its least recent index.
+  int VictimInList(size_t list, const std::function<bool(int)> &evictable) const;
+
+ private:
+  // the sentinel of list l is at capacity_ + l
+  size_t capacity_;
+  std::vector<int> prev_;
+  std::vector<int> next_;
+};
+
+class LruCachePolicy : public ListCachePolicy {
+ public:
+  explicit LruCachePolicy(size_t capacity) : ListCachePolicy(capacity, 1) {}
+  ~LruCachePolicy() override = default;
+  void Insert(int index) override { PushFront(0, index); }
+  void Access(int index) override;
+  void Erase(int index) override { Unlink(index); }
+  int Victim(const std::function<bool(int)> &evictable) const override { return VictimInList(0, evictable); }
+};
+
+// The access counts saturate at kLfuMaxCount, the indexes of one count are evicted in LRU order.
+class LfuCachePolicy : public ListCachePolicy {
+ public:
+  explicit LfuCachePolicy(size_t capacity) : ListCachePolicy(capacity, kLfuMaxCount + 1), counts_(capacity, 0) {}
+  ~LfuCachePolicy() override = default;
+  void Insert(int index) override;
+  void Access(int index) override;
+  void Erase(int index) override { Unlink(index); }
+  int Victim(const std::function<bool(int)> &evictable) const override;
+
+ private:
+  static constexpr uint8_t kLfuMaxCount = 15;
+  std::vector<uint8_t> counts_;
+};
+
+EmbeddingCachePolicyPtr CreateEmbeddingCachePolicy(CachePolicyType type, size_t capacity);
+CachePolicyType CachePolicyTypeFromName(const std::string &name);
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_CACHE_POLICY_H_
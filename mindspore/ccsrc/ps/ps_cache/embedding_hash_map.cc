@@ -15,47 +15,205 @@
  */
 
 #include "ps/ps_cache/embedding_hash_map.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <algorithm>
 
 namespace mindspore {
 namespace ps {
-int EmbeddingHashMap::ParseData(const int id, int *swap_out_index, int *swap_out_ids, const size_t data_step,
-                                const size_t graph_running_step, size_t *swap_out_size) {
+namespace {
+constexpr size_t kGroupWidth = 16;
+constexpr int8_t kCtrlEmpty = -128;
+constexpr int8_t kCtrlDeleted = -2;
+constexpr uint64_t kHashTagBits = 7;
+constexpr uint64_t kHashTagMask = 0x7f;
+
+// The bit i of the result is set if the ctrl byte i of the group equals ctrl.
+inline uint32_t MatchGroup(const int8_t *group, int8_t ctrl) {
+#if defined(__SSE2__)
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(ctrl))));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kGroupWidth; ++i) {
+    mask |= static_cast<uint32_t>(group[i] == ctrl) << i;
+  }
+  return mask;
+#endif
+}
+
+// Empty and deleted ctrl bytes are negative, the hash tags of full slots are not.
+inline uint32_t MatchEmptyOrDeleted(const int8_t *group) {
+#if defined(__SSE2__)
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < kGroupWidth; ++i) {
+    mask |= static_cast<uint32_t>(group[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+inline size_t LowestBit(uint32_t mask) { return static_cast<size_t>(__builtin_ctz(mask)); }
+}  // namespace
+
+EmbeddingHashMap::EmbeddingHashMap(size_t hash_count, size_t hash_capacity, CachePolicyType policy_type)
+    : hash_count_(hash_count), hash_capacity_(hash_capacity), deleted_count_(0), rehash_count_(0) {
+  hash_map_unit_.resize(hash_capacity, {0, INVALID_STEP_VALUE});
+  free_indexes_.reserve(hash_capacity);
+  for (size_t i = hash_capacity; i > 0; --i) {
+    free_indexes_.push_back(SizeToInt(i - 1));
+  }
+  policy_ = CreateEmbeddingCachePolicy(policy_type, hash_capacity);
+  // At most half of the slots are full and a quarter deleted, so probes end quickly at an empty slot even when the
+  // cache is full and every insertion swaps an id out.
+  size_t slot_num = kGroupWidth;
+  while (slot_num / 2 < hash_capacity) {
+    slot_num *= 2;
+  }
+  slot_mask_ = slot_num - 1;
+  ctrl_.assign(slot_num + kGroupWidth, kCtrlEmpty);
+  slots_.resize(slot_num);
+}
+
+uint64_t EmbeddingHashMap::Hash(int64_t id) {
+  // the finalizer of MurmurHash3, consecutive ids are spread over the whole table
+  uint64_t hash = static_cast<uint64_t>(id);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+size_t EmbeddingHashMap::FindSlot(int64_t id, uint64_t hash) const {
+  auto tag = static_cast<int8_t>(hash & kHashTagMask);
+  size_t pos = (hash >> kHashTagBits) & slot_mask_;
+  for (size_t probe = kGroupWidth; probe <= slots_.size() + kGroupWidth; probe += kGroupWidth) {
+    const int8_t *group = ctrl_.data() + pos;
+    for (uint32_t match = MatchGroup(group, tag); match != 0; match &= match - 1) {
+      size_t slot = (pos + LowestBit(match)) & slot_mask_;
+      if (slots_[slot].id_ == id) {
+        return slot;
+      }
+    }
+    if (MatchGroup(group, kCtrlEmpty) != 0) {
+      break;
+    }
+    // triangular probing visits every group once
+    pos = (pos + probe) & slot_mask_;
+  }
+  return slots_.size();
+}
+
+int EmbeddingHashMap::GetIndex(const int64_t id) const {
+  size_t slot = FindSlot(id, Hash(id));
+  return slot == slots_.size() ? INVALID_INDEX_VALUE : slots_[slot].index_;
+}
+
+void EmbeddingHashMap::SetCtrl(size_t slot, int8_t ctrl) {
+  ctrl_[slot] = ctrl;
+  if (slot < kGroupWidth) {
+    ctrl_[slot + slots_.size()] = ctrl;
+  }
+}
+
+void EmbeddingHashMap::InsertSlot(int64_t id, int index) {
+  uint64_t hash = Hash(id);
+  size_t pos = (hash >> kHashTagBits) & slot_mask_;
+  for (size_t probe = kGroupWidth;; probe += kGroupWidth) {
+    uint32_t match = MatchEmptyOrDeleted(ctrl_.data() + pos);
+    if (match != 0) {
+      size_t slot = (pos + LowestBit(match)) & slot_mask_;
+      if (ctrl_[slot] == kCtrlDeleted) {
+        deleted_count_--;
+      }
+      SetCtrl(slot, static_cast<int8_t>(hash & kHashTagMask));
+      slots_[slot] = {id, index};
+      return;
+    }
+    pos = (pos + probe) & slot_mask_;
+  }
+}
+
+void EmbeddingHashMap::EraseSlot(int64_t id) {
+  size_t slot = FindSlot(id, Hash(id));
+  if (slot == slots_.size()) {
+    return;
+  }
+  // a deleted slot keeps the probes of other ids going, it is reused by the next insertion that reaches it
+  SetCtrl(slot, kCtrlDeleted);
+  deleted_count_++;
+  // the full slots never pass half of the table, a rehash is paid for by the quarter of the slots deleted since the
+  // last one
+  if (deleted_count_ > slots_.size() / 4) {
+    Rehash();
+  }
+}
+
+void EmbeddingHashMap::Rehash() {
+  std::vector<Slot> full_slots;
+  full_slots.reserve(hash_count_);
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    if (ctrl_[i] >= 0) {
+      full_slots.push_back(slots_[i]);
+    }
+  }
+  std::fill(ctrl_.begin(), ctrl_.end(), kCtrlEmpty);
+  deleted_count_ = 0;
+  rehash_count_++;
+  for (const auto &slot : full_slots) {
+    InsertSlot(slot.id_, slot.index_);
+  }
+}
+
+int EmbeddingHashMap::ParseData(const int64_t id, const size_t data_step, const size_t graph_running_step,
+                                int *swap_out_index, int64_t *swap_out_id) {
   MS_EXCEPTION_IF_NULL(swap_out_index);
-  MS_EXCEPTION_IF_NULL(swap_out_ids);
-  MS_EXCEPTION_IF_NULL(swap_out_size);
-  auto hash_index = Hash(id);
-  auto need_swap = NeedSwap();
-  size_t loop = 0;
-  while (true) {
-    if (loop++ == hash_capacity_) {
+  MS_EXCEPTION_IF_NULL(swap_out_id);
+  *swap_out_index = INVALID_INDEX_VALUE;
+  int index = INVALID_INDEX_VALUE;
+  if (!free_indexes_.empty()) {
+    index = free_indexes_.back();
+    free_indexes_.pop_back();
+    hash_count_++;
+  } else {
+    // The indexes used by the data of steps the graph has not run can't be swapped out yet.
+    index = policy_->Victim(
+      [this, graph_running_step](int index) { return hash_map_unit_[index].IsExpired(graph_running_step); });
+    if (index == INVALID_INDEX_VALUE) {
       return INVALID_INDEX_VALUE;
     }
-    if (hash_map_unit_[hash_index].IsEmpty()) {
-      hash_count_++;
-      (void)hash_id_to_index_.emplace(id, hash_index);
-      hash_map_unit_[hash_index].set_id(id);
-      hash_map_unit_[hash_index].set_step(data_step);
-      return hash_index;
-    } else if (need_swap && hash_map_unit_[hash_index].IsExpired(graph_running_step)) {
-      // Need swap out from the hash table.
-      swap_out_index[*swap_out_size] = hash_index;
-      swap_out_ids[*swap_out_size] = hash_map_unit_[hash_index].id_;
-      (*swap_out_size)++;
-      (void)hash_id_to_index_.erase(hash_map_unit_[hash_index].id_);
-      (void)hash_id_to_index_.emplace(id, hash_index);
-      hash_map_unit_[hash_index].set_id(id);
-      hash_map_unit_[hash_index].set_step(data_step);
-      return hash_index;
-    }
-    hash_index = (hash_index + 1) % hash_capacity_;
+    // Need swap out from the hash table.
+    *swap_out_index = index;
+    *swap_out_id = hash_map_unit_[index].id_;
+    policy_->Erase(index);
+    EraseSlot(hash_map_unit_[index].id_);
   }
+  InsertSlot(id, index);
+  hash_map_unit_[index].set_id(id);
+  hash_map_unit_[index].set_step(data_step);
+  policy_->Insert(index);
+  return index;
+}
+
+void EmbeddingHashMap::set_hash_step(const int hash_index, const size_t step) {
+  hash_map_unit_[hash_index].set_step(step);
+  policy_->Access(hash_index);
 }
 
 void EmbeddingHashMap::DumpHashMap() {
-  MS_LOG(INFO) << "Dump hash map info begin, hash_capacity: " << hash_capacity_ << " hash_count: " << hash_count_;
+  MS_LOG(INFO) << "Dump hash map info begin, hash_capacity: " << hash_capacity_ << " hash_count: " << hash_count_
+               << " rehash_count: " << rehash_count_;
   MS_LOG(INFO) << "Dump hash_id_to_index: ";
-  for (auto iter = hash_id_to_index_.begin(); iter != hash_id_to_index_.end(); ++iter) {
-    MS_LOG(INFO) << "  id: " << iter->first << " index: " << iter->second;
+  for (size_t i = 0; i < slots_.size(); i++) {
+    if (ctrl_[i] >= 0) {
+      MS_LOG(INFO) << "  id: " << slots_[i].id_ << " index: " << slots_[i].index_;
+    }
   }
   MS_LOG(INFO) << "Dump hash_map_unit: ";
   for (size_t i = 0; i < hash_map_unit_.size(); i++) {
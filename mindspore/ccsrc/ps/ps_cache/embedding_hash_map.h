@@ -17,11 +17,11 @@
 #ifndef MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_HASH_MAP_H_
 #define MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_HASH_MAP_H_
 
-#include <math.h>
+#include <cstdint>
 #include <utility>
 #include <memory>
 #include <vector>
-#include <unordered_map>
+#include "ps/ps_cache/embedding_cache_policy.h"
 #include "utils/convert_utils_base.h"
 
 namespace mindspore {
@@ -30,38 +30,69 @@ static const size_t INVALID_STEP_VALUE = 0;
 static const int INVALID_INDEX_VALUE = -1;
 
 struct HashMapElement {
-  int id_;
+  int64_t id_;
   size_t step_;
   bool IsEmpty() const { return step_ == INVALID_STEP_VALUE; }
   bool IsExpired(size_t graph_running_step) const { return graph_running_step > step_; }
-  void set_id(int id) { id_ = id; }
+  void set_id(int64_t id) { id_ = id; }
   void set_step(size_t step) { step_ = step; }
 };
 
 // Hash table is held in device, HashMap is used to manage hash table in host.
+// The ids are found with an open addressing table in the style of the Swiss table: a control byte per slot keeps
+// 7 bits of the hash of its id, and the control bytes of a group of slots are compared with one SIMD instruction.
+// The indexes of the hash table are handed out from a free list, when it runs out the cache policy picks a victim
+// among the indexes the running graph doesn't use any more.
 class EmbeddingHashMap {
  public:
-  EmbeddingHashMap(size_t hash_count, size_t hash_capacity) : hash_count_(hash_count), hash_capacity_(hash_capacity) {
-    hash_map_unit_.resize(hash_capacity);
-  }
+  EmbeddingHashMap(size_t hash_count, size_t hash_capacity, CachePolicyType policy_type = kCacheLRU);
   virtual ~EmbeddingHashMap() = default;
-  int ParseData(const int id, int *swap_out_index, int *swap_out_ids, const size_t data_step,
-                const size_t graph_running_step, size_t *swap_out_size);
-  std::unordered_map<int, int>::const_iterator id_iter(const int id) const { return hash_id_to_index_.find(id); }
-  bool IsIdExist(const std::unordered_map<int, int>::const_iterator iter) const {
-    return iter != hash_id_to_index_.end();
+  // Inserts a new id and returns its index, or INVALID_INDEX_VALUE if no index can be swapped out now. When another
+  // id is swapped out for it, that id and the index are written to swap_out_id and swap_out_index, otherwise
+  // swap_out_index is set to INVALID_INDEX_VALUE.
+  int ParseData(const int64_t id, const size_t data_step, const size_t graph_running_step, int *swap_out_index,
+                int64_t *swap_out_id);
+  // Returns the index of id, or INVALID_INDEX_VALUE if it is not in the cache.
+  int GetIndex(const int64_t id) const;
+  // Looks up a batch of ids, it only reads the map and can run on several threads.
+  template <typename IdType>
+  void GetIndexes(const IdType *ids, size_t ids_size, int *indexes) const {
+    for (size_t i = 0; i < ids_size; ++i) {
+      indexes[i] = GetIndex(static_cast<int64_t>(ids[i]));
+    }
   }
   size_t hash_step(const int hash_index) const { return hash_map_unit_[hash_index].step_; }
-  void set_hash_step(const int hash_index, const size_t step) { hash_map_unit_[hash_index].set_step(step); }
+  // Records that the data of step uses the index.
+  void set_hash_step(const int hash_index, const size_t step);
+  size_t hash_count() const { return hash_count_; }
+  // The number of times the deleted slots were cleared out of the table.
+  size_t rehash_count() const { return rehash_count_; }
   void DumpHashMap();
 
  private:
-  int Hash(const int id) { return static_cast<int>((0.6180339 * id - std::floor(0.6180339 * id)) * hash_capacity_); }
-  bool NeedSwap() const { return hash_count_ > FloatToSize(hash_capacity_ * 0.9); }
+  struct Slot {
+    int64_t id_;
+    int index_;
+  };
+  static uint64_t Hash(int64_t id);
+  size_t FindSlot(int64_t id, uint64_t hash) const;
+  void InsertSlot(int64_t id, int index);
+  void EraseSlot(int64_t id);
+  void SetCtrl(size_t slot, int8_t ctrl);
+  void Rehash();
+
   size_t hash_count_;
   size_t hash_capacity_;
   std::vector<HashMapElement> hash_map_unit_;
-  std::unordered_map<int, int> hash_id_to_index_;
+  std::vector<int> free_indexes_;
+  EmbeddingCachePolicyPtr policy_;
+
+  // The ctrl bytes of the first group are repeated after the last slot, so a group load never wraps around.
+  std::vector<int8_t> ctrl_;
+  std::vector<Slot> slots_;
+  size_t slot_mask_;
+  size_t deleted_count_;
+  size_t rehash_count_;
 };
 }  // namespace ps
 }  // namespace mindspore
@@ -18,6 +18,7 @@
 #include "ps/ps_cache/ps_cache_manager.h"
 #include "utils/log_adapter.h"
 #include "utils/ms_utils.h"
+#include "backend/kernel_compiler/cpu/cpu_kernel.h"
 
 using mindspore::kernel::Address;
 namespace mindspore {
@@ -140,8 +141,9 @@ void PsCacheManager::Initialize() {
     Util::SetInternalEnvVar();
     worker.Run();
   }
-  embedding_device_cache_ = std::make_shared<EmbeddingDeviceCache>(batch_elements_, cache_vocab_size_);
-  embedding_host_cache_ = std::make_shared<EmbeddingHostCache>(batch_elements_, host_cache_vocab_size_);
+  auto policy_type = CachePolicyTypeFromName(common::GetEnv(kEnvEmbeddingCachePolicy));
+  embedding_device_cache_ = std::make_shared<EmbeddingDeviceCache>(batch_elements_, cache_vocab_size_, policy_type);
+  embedding_host_cache_ = std::make_shared<EmbeddingHostCache>(batch_elements_, host_cache_vocab_size_, policy_type);
   AddEmbeddingTable();
   AllocMemForHashTable();
   SetLocalIdRank();
@@ -342,20 +344,37 @@ void PsCacheManager::ProcessData() {
 void PsCacheManager::ParseData(const int *batch_ids, const size_t batch_ids_len, int *hash_index) {
   MS_EXCEPTION_IF_NULL(batch_ids);
   MS_EXCEPTION_IF_NULL(hash_index);
+  MS_EXCEPTION_IF_NULL(embedding_device_cache_);
+  auto device_hash_map = embedding_device_cache_->device_hash_map_;
+  MS_EXCEPTION_IF_NULL(device_hash_map);
+  LookUpDeviceHashMap(batch_ids, batch_ids_len, hash_index);
+  // Mark the hit ids first, so that they are not swapped out for the missed ids of the same batch.
   for (size_t i = 0; i < batch_ids_len; i++) {
-    bool need_swap_host_to_device = true;
-    bool need_swap_device_to_host = true;
     auto id = batch_ids[i];
     if ((id < SizeToInt(range_bound_.first)) || (id >= SizeToInt(range_bound_.second))) {
       hash_index[i] = -1;
       continue;
     }
+    auto index = hash_index[i];
+    if (index != INVALID_INDEX_VALUE && device_hash_map->hash_step(index) != data_step_) {
+      statistics_info_.hash_hit_count_++;
+      device_hash_map->set_hash_step(index, data_step_);
+    }
+  }
+  for (size_t i = 0; i < batch_ids_len; i++) {
+    auto id = batch_ids[i];
+    if ((id < SizeToInt(range_bound_.first)) || (id >= SizeToInt(range_bound_.second)) ||
+        hash_index[i] != INVALID_INDEX_VALUE) {
+      continue;
+    }
+    bool need_swap_host_to_device = true;
+    bool need_swap_device_to_host = true;
     hash_index[i] = ParseDeviceData(id, &need_swap_device_to_host, &need_swap_host_to_device);
     if (need_swap_host_to_device) {
       ParseHostDataHostToDevice(id);
     }
     if (need_swap_device_to_host) {
-      ParseHostDataDeviceToHost(id);
+      ParseHostDataDeviceToHost();
     }
   }
   // Each 1000 step prints ps cache hit rate.
@@ -366,6 +385,18 @@ void PsCacheManager::ParseData(const int *batch_ids, const size_t batch_ids_len,
   }
 }
 
+void PsCacheManager::LookUpDeviceHashMap(const int *batch_ids, const size_t batch_ids_len, int *device_indexes) const {
+  auto device_hash_map = embedding_device_cache_->device_hash_map_;
+  if (batch_ids_len < kMinParallelLookUpIds) {
+    device_hash_map->GetIndexes(batch_ids, batch_ids_len, device_indexes);
+    return;
+  }
+  auto task = [&](size_t start, size_t end) {
+    device_hash_map->GetIndexes(batch_ids + start, end - start, device_indexes + start);
+  };
+  kernel::CPUKernelUtils::ParallelFor(task, batch_ids_len);
+}
+
 void PsCacheManager::WaitGraphRun() {
   MS_LOG(INFO) << "Hash table has no space to insert new data and retries within 2 minutes.";
   std::unique_lock<std::mutex> locker(data_mutex_);
@@ -376,7 +407,7 @@ void PsCacheManager::WaitGraphRun() {
   set_current_graph_step();
 }
 
-int PsCacheManager::ParseDeviceData(size_t id, bool *need_swap_device_to_host, bool *need_swap_host_to_device) {
+int PsCacheManager::ParseDeviceData(int id, bool *need_swap_device_to_host, bool *need_swap_host_to_device) {
   MS_EXCEPTION_IF_NULL(need_swap_device_to_host);
   MS_EXCEPTION_IF_NULL(need_swap_host_to_device);
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
@@ -391,36 +422,57 @@ int PsCacheManager::ParseDeviceData(size_t id, bool *need_swap_device_to_host, b
 
   auto device_hash_map = embedding_device_cache_->device_hash_map_;
   MS_EXCEPTION_IF_NULL(device_hash_map);
-  int index = 0;
-  auto iter = device_hash_map->id_iter(id);
-  if (device_hash_map->IsIdExist(iter)) {
+  // The id may be inserted by its previous occurrence in the batch.
+  int index = device_hash_map->GetIndex(id);
+  if (index != INVALID_INDEX_VALUE) {
     *need_swap_device_to_host = false;
     *need_swap_host_to_device = false;
-    index = iter->second;
-    if (device_hash_map->hash_step(index) != data_step_) {
-      statistics_info_.hash_hit_count_++;
-      device_hash_map->set_hash_step(index, data_step_);
+    return index;
+  }
+  while (true) {
+    int swap_out_index = INVALID_INDEX_VALUE;
+    int64_t swap_out_id = 0;
+    index = device_hash_map->ParseData(id, data_step_, graph_running_step_, &swap_out_index, &swap_out_id);
+    if (index == INVALID_INDEX_VALUE) {
+      WaitGraphRun();
+      continue;
     }
-  } else {
-    auto tmp_device_to_host_size = statistics_info_.device_to_host_size_;
-    while (true) {
-      index = device_hash_map->ParseData(id, device_to_host_index, device_to_host_ids, data_step_, graph_running_step_,
-                                         &(statistics_info_.device_to_host_size_));
-      if (index == INVALID_INDEX_VALUE) {
-        WaitGraphRun();
-        continue;
-      }
-      host_to_device_index[statistics_info_.host_to_device_size_] = index;
-      host_to_device_ids[statistics_info_.host_to_device_size_] = id;
-      statistics_info_.host_to_device_size_++;
-      *need_swap_device_to_host = statistics_info_.device_to_host_size_ > tmp_device_to_host_size;
-      break;
+    host_to_device_index[statistics_info_.host_to_device_size_] = index;
+    host_to_device_ids[statistics_info_.host_to_device_size_] = id;
+    statistics_info_.host_to_device_size_++;
+    *need_swap_device_to_host = swap_out_index != INVALID_INDEX_VALUE;
+    if (*need_swap_device_to_host) {
+      // The ids of the batch are int, so are the ones swapped out.
+      device_to_host_index[statistics_info_.device_to_host_size_] = swap_out_index;
+      device_to_host_ids[statistics_info_.device_to_host_size_] = static_cast<int>(swap_out_id);
+      statistics_info_.device_to_host_size_++;
     }
+    break;
   }
   return index;
 }
 
-void PsCacheManager::ParseHostDataHostToDevice(size_t id) {
+int PsCacheManager::ParseHostData(int id, int *host_to_server_index, int *host_to_server_ids) {
+  auto host_hash_map = embedding_host_cache_->host_hash_map_;
+  MS_EXCEPTION_IF_NULL(host_hash_map);
+  while (true) {
+    int swap_out_index = INVALID_INDEX_VALUE;
+    int64_t swap_out_id = 0;
+    auto index = host_hash_map->ParseData(id, data_step_, graph_running_step_, &swap_out_index, &swap_out_id);
+    if (index == INVALID_INDEX_VALUE) {
+      WaitGraphRun();
+      continue;
+    }
+    if (swap_out_index != INVALID_INDEX_VALUE) {
+      host_to_server_index[statistics_info_.host_to_server_size_] = swap_out_index;
+      host_to_server_ids[statistics_info_.host_to_server_size_] = static_cast<int>(swap_out_id);
+      statistics_info_.host_to_server_size_++;
+    }
+    return index;
+  }
+}
+
+void PsCacheManager::ParseHostDataHostToDevice(int id) {
   MS_EXCEPTION_IF_NULL(embedding_host_cache_);
   int *host_to_server_index = embedding_host_cache_->host_to_server_index.get();
   int *host_to_server_ids = embedding_host_cache_->host_to_server_ids.get();
@@ -435,30 +487,21 @@ void PsCacheManager::ParseHostDataHostToDevice(size_t id) {
 
   auto host_hash_map = embedding_host_cache_->host_hash_map_;
   MS_EXCEPTION_IF_NULL(host_hash_map);
-  auto iter = host_hash_map->id_iter(id);
-  if (host_hash_map->IsIdExist(iter)) {
-    auto index = iter->second;
+  auto index = host_hash_map->GetIndex(id);
+  if (index != INVALID_INDEX_VALUE) {
     if (host_hash_map->hash_step(index) != data_step_) {
       host_hash_map->set_hash_step(index, data_step_);
     }
     host_to_device_index[statistics_info_.host_to_device_size_ - 1] = index;
   } else {
-    while (true) {
-      auto index = host_hash_map->ParseData(id, host_to_server_index, host_to_server_ids, data_step_,
-                                            graph_running_step_, &statistics_info_.host_to_server_size_);
-      if (index == INVALID_INDEX_VALUE) {
-        WaitGraphRun();
-        continue;
-      }
-      host_to_device_index[statistics_info_.host_to_device_size_ - 1] = index;
-      server_to_host_index[statistics_info_.server_to_host_size_] = index;
-      server_to_host_ids[statistics_info_.server_to_host_size_++] = id;
-      break;
-    }
+    index = ParseHostData(id, host_to_server_index, host_to_server_ids);
+    host_to_device_index[statistics_info_.host_to_device_size_ - 1] = index;
+    server_to_host_index[statistics_info_.server_to_host_size_] = index;
+    server_to_host_ids[statistics_info_.server_to_host_size_++] = id;
   }
 }
 
-void PsCacheManager::ParseHostDataDeviceToHost(size_t id) {
+void PsCacheManager::ParseHostDataDeviceToHost() {
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
   MS_EXCEPTION_IF_NULL(embedding_host_cache_);
   int *device_to_host_ids = embedding_device_cache_->device_to_host_ids.get();
@@ -473,25 +516,15 @@ void PsCacheManager::ParseHostDataDeviceToHost(size_t id) {
   auto host_hash_map = embedding_host_cache_->host_hash_map_;
   MS_EXCEPTION_IF_NULL(host_hash_map);
   int swap_device_to_host_id = device_to_host_ids[statistics_info_.device_to_host_size_ - 1];
-  auto iter = host_hash_map->id_iter(swap_device_to_host_id);
-  if (host_hash_map->IsIdExist(iter)) {
-    auto index = iter->second;
+  auto index = host_hash_map->GetIndex(swap_device_to_host_id);
+  if (index != INVALID_INDEX_VALUE) {
     if (host_hash_map->hash_step(index) != data_step_) {
       host_hash_map->set_hash_step(index, data_step_);
     }
-    device_to_host_index[statistics_info_.device_to_host_size_ - 1] = index;
   } else {
-    while (true) {
-      auto index = host_hash_map->ParseData(id, host_to_server_index, host_to_server_ids, data_step_,
-                                            graph_running_step_, &statistics_info_.host_to_server_size_);
-      if (index == INVALID_INDEX_VALUE) {
-        WaitGraphRun();
-        continue;
-      }
-      device_to_host_index[statistics_info_.device_to_host_size_ - 1] = index;
-      break;
-    }
+    index = ParseHostData(swap_device_to_host_id, host_to_server_index, host_to_server_ids);
   }
+  device_to_host_index[statistics_info_.device_to_host_size_ - 1] = index;
 }
 
 void PsCacheManager::LookUpTableTask(size_t indices_lens, size_t outer_dim_size, size_t first_dim_size,
@@ -520,72 +553,29 @@ void PsCacheManager::LookUpHostHashTable(size_t embedding_size, size_t indices_l
                                          const int *indices_addr, float *output_addr) {
   size_t first_dim_size = host_cache_vocab_size_;
   size_t outer_dim_size = embedding_size;
-
-  size_t thread_num = indices_lens / 10000 + 1;
-  thread_num = thread_num > kMaxThreadNum ? kMaxThreadNum : thread_num;
-  std::thread threads[kMaxThreadNum];
-  size_t task_proc_lens = (indices_lens + thread_num - 1) / thread_num;
-  size_t i;
-  size_t task_offset = 0;
-  MS_LOG(DEBUG) << "Indices lens: " << indices_lens << ", one task proc lens:" << task_proc_lens;
-  for (i = 0; i < thread_num; i++) {
-    if (task_offset >= indices_lens) {
-      break;
-    }
-    MS_LOG(DEBUG) << "Task offset: " << task_offset << ", task process lens:" << task_proc_lens;
-    threads[i] = std::thread(&PsCacheManager::LookUpTableTask, this, task_proc_lens, outer_dim_size, first_dim_size,
-                             hash_table_addr, indices_addr + task_offset, output_addr + task_offset * outer_dim_size);
-    task_offset += task_proc_lens;
-    if (task_offset + task_proc_lens > indices_lens) {
-      task_proc_lens = indices_lens - task_offset;
-    }
-  }
-  for (size_t j = 0; j < i; j++) {
-    threads[j].join();
-  }
+  auto task = [&](size_t start, size_t end) {
+    LookUpTableTask(end - start, outer_dim_size, first_dim_size, hash_table_addr, indices_addr + start,
+                    output_addr + start * outer_dim_size);
+  };
+  kernel::CPUKernelUtils::ParallelFor(task, indices_lens);
 }
 
 void PsCacheManager::InsertHostHashTable(size_t embedding_size, size_t insert_indices_size, int *insert_indices,
                                          float *insert_data, float *hash_table_addr) {
   size_t first_dim_size = host_cache_vocab_size_;
-  size_t thread_num = insert_indices_size / 10000 + 1;
-  thread_num = thread_num > kMaxThreadNum ? kMaxThreadNum : thread_num;
-  std::thread threads[kMaxThreadNum];
-  size_t task_proc_lens = (insert_indices_size + thread_num - 1) / thread_num;
-  size_t i;
-  size_t task_offset = 0;
-
-  auto insert_hash_table_task = [](size_t insert_indices_size, size_t outer_dim_size, size_t first_dim_size,
-                                   int *insert_indices, float *insert_data, float *hash_table_addr) {
-    auto type_size = sizeof(float);
-    size_t lens = outer_dim_size * type_size;
-    for (size_t i = 0; i < insert_indices_size; ++i) {
+  size_t lens = embedding_size * sizeof(float);
+  auto task = [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
       int index = insert_indices[i];
       if (index >= 0 && index < SizeToInt(first_dim_size)) {
-        auto ret = memcpy_s(hash_table_addr + index * outer_dim_size, lens, insert_data + i * outer_dim_size, lens);
+        auto ret = memcpy_s(hash_table_addr + index * embedding_size, lens, insert_data + i * embedding_size, lens);
         if (ret != EOK) {
           MS_LOG(EXCEPTION) << "Insert hash table task memcpy failed.";
         }
       }
     }
   };
-
-  for (i = 0; i < thread_num; i++) {
-    if (task_offset >= insert_indices_size) {
-      break;
-    }
-    MS_LOG(DEBUG) << "Task offset: " << task_offset << ", task process lens:" << task_proc_lens;
-    threads[i] = std::thread(insert_hash_table_task, task_proc_lens, embedding_size, first_dim_size,
-                             insert_indices + task_offset, insert_data + task_offset * embedding_size, hash_table_addr);
-    task_offset += task_proc_lens;
-    if (task_offset + task_proc_lens > insert_indices_size) {
-      task_proc_lens = insert_indices_size - task_offset;
-    }
-  }
-
-  for (size_t j = 0; j < i; j++) {
-    threads[j].join();
-  }
+  kernel::CPUKernelUtils::ParallelFor(task, insert_indices_size);
 }
 
 void PsCacheManager::HashSwapHostToDevice(const HashTableInfo &hash_info) {
@@ -39,7 +39,7 @@
 namespace mindspore {
 namespace ps {
 constexpr size_t kHostCacheScaleFactor = 10;
-constexpr size_t kMaxThreadNum = 16;
+constexpr size_t kMinParallelLookUpIds = 4096;
 using mindspore::kernel::Address;
 
 struct HashTableInfo {
@@ -53,12 +53,12 @@ struct HashTableInfo {
 };
 
 struct EmbeddingDeviceCache {
-  EmbeddingDeviceCache(size_t batch_elements, size_t cache_vocab_size) {
+  EmbeddingDeviceCache(size_t batch_elements, size_t cache_vocab_size, CachePolicyType policy_type) {
     device_to_host_index = std::make_unique<int[]>(batch_elements);
     device_to_host_ids = std::make_unique<int[]>(batch_elements);
     host_to_device_index = std::make_unique<int[]>(batch_elements);
     host_to_device_ids = std::make_unique<int[]>(batch_elements);
-    device_hash_map_ = std::make_shared<EmbeddingHashMap>(0, cache_vocab_size);
+    device_hash_map_ = std::make_shared<EmbeddingHashMap>(0, cache_vocab_size, policy_type);
     auto context_ptr = MsContext::GetInstance();
     MS_EXCEPTION_IF_NULL(context_ptr);
     auto devcie_target = context_ptr->get_param<std::string>(MS_CTX_DEVICE_TARGET);
@@ -75,14 +75,14 @@ struct EmbeddingDeviceCache {
 };
 
 struct EmbeddingHostCache {
-  EmbeddingHostCache(size_t batch_elements, size_t host_cache_vocab_size) {
+  EmbeddingHostCache(size_t batch_elements, size_t host_cache_vocab_size, CachePolicyType policy_type) {
     host_to_server_index = std::make_unique<int[]>(batch_elements);
     host_to_server_ids = std::make_unique<int[]>(batch_elements);
     server_to_host_index = std::make_unique<int[]>(batch_elements);
     server_to_host_ids = std::make_unique<int[]>(batch_elements);
     host_to_device_index = std::make_unique<int[]>(batch_elements);
     device_to_host_index = std::make_unique<int[]>(batch_elements);
-    host_hash_map_ = std::make_shared<EmbeddingHashMap>(0, host_cache_vocab_size);
+    host_hash_map_ = std::make_shared<EmbeddingHashMap>(0, host_cache_vocab_size, policy_type);
   }
   std::unique_ptr<int[]> host_to_server_index;
   std::unique_ptr<int[]> host_to_server_ids;
@@ -143,9 +143,11 @@ class PsCacheManager {
   void ProcessData();
   void ParseData(const int *batch_ids, const size_t batch_ids_len, int *hash_index);
   void WaitGraphRun();
-  int ParseDeviceData(size_t id, bool *need_swap_device_to_host, bool *need_swap_host_to_device);
-  void ParseHostDataHostToDevice(size_t id);
-  void ParseHostDataDeviceToHost(size_t id);
+  void LookUpDeviceHashMap(const int *batch_ids, const size_t batch_ids_len, int *device_indexes) const;
+  int ParseDeviceData(int id, bool *need_swap_device_to_host, bool *need_swap_host_to_device);
+  int ParseHostData(int id, int *host_to_server_index, int *host_to_server_ids);
+  void ParseHostDataHostToDevice(int id);
+  void ParseHostDataDeviceToHost();
   void HashSwapDeviceOut(int *swap_out_index, ::ps::SArray<float> *swap_out_data, const HashTableInfo &hash_info);
   void HashSwapDeviceIn(int *swap_in_ids, int *swap_in_index, const HashTableInfo &hash_info, size_t key);
   void HashSwapHostToDevice(const HashTableInfo &hash_info);
@@ -0,0 +1,143 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/staleness_clock.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+StalenessClock::StalenessClock(size_t worker_num, uint64_t staleness, Clock::duration timeout)
+    : worker_num_(worker_num), staleness_(staleness), timeout_(timeout), start_time_(Clock::now()) {}
+
+void StalenessClock::Push(const Key &key, int sender, bool applied) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Touch(sender);
+  KeyClock &clock = key_clocks_[key];
+  if (applied) {
+    clock.version++;
+  }
+  clock.push_counts[sender]++;
+}
+
+void StalenessClock::Pull(const Key &key, int sender) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Touch(sender);
+  KeyClock &clock = key_clocks_[key];
+  clock.pulled_versions[sender] = clock.version;
+}
+
+bool StalenessClock::ReadyForPull(const Key &key, int sender) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return StepsAhead(key_clocks_[key], sender) <= staleness_;
+}
+
+bool StalenessClock::PushSlack(const Key &key, int sender, uint64_t *slack) {
+  MS_EXCEPTION_IF_NULL(slack);
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t steps_ahead = StepsAhead(key_clocks_[key], sender);
+  if (steps_ahead > staleness_) {
+    return false;
+  }
+  *slack = staleness_ - steps_ahead;
+  return true;
+}
+
+uint64_t StalenessClock::GradStaleness(const Key &key, int sender) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  KeyClock &clock = key_clocks_[key];
+  return clock.version - clock.pulled_versions[sender];
+}
+
+bool StalenessClock::Finish(int sender) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  finished_workers_.insert(sender);
+  MS_LOG(INFO) << "Worker " << sender << " finished, " << finished_workers_.size() << " of " << worker_num_
+               << " workers finished.";
+  return finished_workers_.size() >= worker_num_;
+}
+
+void StalenessClock::Touch(int sender) {
+  last_active_times_[sender] = Clock::now();
+  if (lost_workers_.erase(sender) > 0) {
+    MS_LOG(WARNING) << "Worker " << sender << " is back, the pulls of the other workers wait for it again.";
+  }
+}
+
+bool StalenessClock::IsWaitedFor(int sender, Clock::time_point now) {
+  if (finished_workers_.count(sender) > 0) {
+    return false;
+  }
+  auto iter = last_active_times_.find(sender);
+  Clock::time_point last_active_time = iter == last_active_times_.end() ? start_time_ : iter->second;
+  if (now - last_active_time <= timeout_) {
+    return true;
+  }
+  if (lost_workers_.insert(sender).second) {
+    MS_LOG(WARNING) << "Worker " << sender << " has neither pushed nor pulled for "
+                    << std::chrono::duration_cast<std::chrono::seconds>(now - last_active_time).count()
+                    << "s, the pulls of the other workers stop waiting for it.";
+  }
+  return false;
+}
+
+uint64_t StalenessClock::StepsAhead(const KeyClock &clock, int sender) {
+  auto iter = clock.push_counts.find(sender);
+  uint64_t push_count = iter == clock.push_counts.end() ? 0 : iter->second;
+  Clock::time_point now = Clock::now();
+  bool has_slowest = false;
+  uint64_t slowest_push_count = 0;
+  // until the timeout passes, the workers that never showed up are at 0
+  if (last_active_times_.size() < worker_num_) {
+    if (now - start_time_ <= timeout_) {
+      has_slowest = true;
+    } else if (!unseen_workers_lost_) {
+      unseen_workers_lost_ = true;
+      MS_LOG(WARNING) << "Only " << last_active_times_.size() << " of " << worker_num_
+                      << " workers have shown up, the pulls stop waiting for the others.";
+    }
+  }
+  for (const auto &worker : last_active_times_) {
+    if (worker.first == sender || !IsWaitedFor(worker.first, now)) {
+      continue;
+    }
+    auto count_iter = clock.push_counts.find(worker.first);
+    uint64_t count = count_iter == clock.push_counts.end() ? 0 : count_iter->second;
+    slowest_push_count = has_slowest ? std::min(slowest_push_count, count) : count;
+    has_slowest = true;
+  }
+  if (!has_slowest) {
+    return 0;
+  }
+  return push_count > slowest_push_count ? push_count - slowest_push_count : 0;
+}
+
+uint64_t ParseStalenessEnv(const std::string &name, const std::string &value) {
+  bool is_digits = !value.empty() && std::all_of(value.begin(), value.end(), [](char c) {
+                     return std::isdigit(static_cast<unsigned char>(c)) != 0;
+                   });
+  if (is_digits) {
+    try {
+      return std::stoull(value);
+    } catch (const std::out_of_range &) {
+    }
+  }
+  MS_LOG(EXCEPTION) << "The value of " << name << " should be a non-negative integer, but got " << value;
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,92 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_STALENESS_CLOCK_H_
+#define MINDSPORE_CCSRC_PS_STALENESS_CLOCK_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "ps/common.h"
+
+namespace mindspore {
+namespace ps {
+// The clocks of the bounded staleness (SSP) mode of the parameter server. A worker may push a key up to staleness
+// times beyond the slowest worker before its pulls of the key wait. Workers are identified by their ps-lite node id.
+//
+// A worker stops holding the others back once it has finished, or once it has neither pushed nor pulled for timeout,
+// so the pulls of the other workers never wait forever on a worker that is gone.
+class StalenessClock {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  StalenessClock(size_t worker_num, uint64_t staleness, Clock::duration timeout);
+  ~StalenessClock() = default;
+
+  // Counts a push of key by sender, applied tells whether the push updated the weight.
+  void Push(const Key &key, int sender, bool applied);
+  // Records the version of key sender pulled.
+  void Pull(const Key &key, int sender);
+  // Whether sender is within the staleness bound of key and may pull it.
+  bool ReadyForPull(const Key &key, int sender);
+  // The pushes of key sender may still make before the weight it reads now falls out of the staleness bound, the
+  // copies of the weight a worker keeps are read within that many of its pushes. False when sender is already beyond
+  // the bound.
+  bool PushSlack(const Key &key, int sender, uint64_t *slack);
+  // The updates applied to key since sender pulled it last.
+  uint64_t GradStaleness(const Key &key, int sender);
+  // Marks sender finished and returns true once every worker has finished.
+  bool Finish(int sender);
+  uint64_t staleness() const { return staleness_; }
+
+ private:
+  struct KeyClock {
+    // the number of updates applied to the weight
+    uint64_t version{0};
+    // the pushes of each worker
+    std::unordered_map<int, uint64_t> push_counts;
+    // the version each worker pulled last
+    std::unordered_map<int, uint64_t> pulled_versions;
+  };
+
+  void Touch(int sender);
+  // Whether the pulls of the other workers still wait for sender, the caller holds mutex_.
+  bool IsWaitedFor(int sender, Clock::time_point now);
+  // The pushes of sender beyond those of the slowest worker that is waited for, the caller holds mutex_.
+  uint64_t StepsAhead(const KeyClock &clock, int sender);
+
+  size_t worker_num_;
+  uint64_t staleness_;
+  Clock::duration timeout_;
+  Clock::time_point start_time_;
+  std::unordered_map<Key, KeyClock> key_clocks_;
+  // the time of the last push or pull of each worker
+  std::unordered_map<int, Clock::time_point> last_active_times_;
+  std::unordered_set<int> finished_workers_;
+  // the workers that timed out, they are waited for again once they come back
+  std::unordered_set<int> lost_workers_;
+  // whether the workers that never showed up timed out
+  bool unseen_workers_lost_{false};
+  std::mutex mutex_;
+};
+
+// Parses the value of the environment variable name, which should be a non-negative integer.
+uint64_t ParseStalenessEnv(const std::string &name, const std::string &value);
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_STALENESS_CLOCK_H_
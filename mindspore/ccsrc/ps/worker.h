@@ -31,7 +31,9 @@
 #include "ps/util.h"
 #include "ps/common.h"
 #include "ps/worker_proxy.h"
+#include "ps/gradient_codec.h"
 #include "utils/shape_utils.h"
+#include "utils/ms_utils.h"
 #include "ps/ps_cache/ps_data/ps_data_prefetch.h"
 
 namespace mindspore {
@@ -64,13 +66,19 @@ class Worker {
   void Finalize();
 
  private:
-  Worker() : kv_worker_(nullptr), running_(false), key_cnt_(0) {}
+  Worker()
+      : kv_worker_(nullptr),
+        running_(false),
+        key_cnt_(0),
+        grad_codec_type_(kGradCodecNone),
+        grad_topk_ratio_(kDefaultGradTopKRatio) {}
   ~Worker() = default;
   Worker(const Worker &) = delete;
   Worker &operator=(const Worker &) = delete;
 
   bool IsKeyInit(const size_t key);
   void InitPSOptimId(const size_t param_key);
+  void InitPSGradCodec(const size_t param_key, const size_t param_elem_num);
   void InitPSOptimInputShapes(const size_t key);
   void InitPSParamData(const std::vector<size_t> &keys, void *origin_addr, size_t size);
   static void EmbeddingLookupIdSlicer(const ::ps::KVPairs<T> &send, const std::vector<::ps::Range> &ranges,
@@ -84,6 +92,8 @@ class Worker {
   std::map<size_t, int64_t> key_to_optimId_;
   std::map<size_t, std::vector<ShapeVector>> key_to_optim_shapes_;
   std::map<std::string, bool> param_to_init_in_server_;
+  GradCodecType grad_codec_type_;
+  float grad_topk_ratio_;
 };
 
 template <typename T>
@@ -99,6 +109,23 @@ void Worker<T>::Run() {
     MS_LOG(EXCEPTION) << "The role is not worker.";
   }
   kv_worker_ = std::make_shared<WorkerProxy<T>>(0, 0, 1, 2);
+  grad_codec_type_ = GradCodecTypeFromName(common::GetEnv(kEnvGradCodec));
+  std::string topk_ratio = common::GetEnv(kEnvGradTopKRatio);
+  if (!topk_ratio.empty()) {
+    grad_topk_ratio_ = GradTopKRatioFromString(topk_ratio);
+  }
+  MS_LOG(INFO) << "Gradient codec of the pushes: " << grad_codec_type_ << ", top-k ratio: " << grad_topk_ratio_;
+  std::string hot_row_num = common::GetEnv(kEnvHotRowNum);
+  // the copies of the hot rows are stale reads, the synchronous mode has no staleness bound to keep them in
+  if (!hot_row_num.empty() && common::GetEnv(kEnvStaleness).empty()) {
+    MS_LOG(WARNING) << kEnvHotRowNum << " is ignored, the hot embedding rows are only replicated when "
+                    << kEnvStaleness << " is set.";
+  } else if (!hot_row_num.empty()) {
+    std::string refresh_steps = common::GetEnv(kEnvHotRowRefreshSteps);
+    kv_worker_->SetHotRowReplication(
+      ParseHotRowEnv(kEnvHotRowNum, hot_row_num),
+      refresh_steps.empty() ? kDefaultHotRowRefreshSteps : ParseHotRowEnv(kEnvHotRowRefreshSteps, refresh_steps));
+  }
   running_ = true;
 }
 
@@ -319,6 +346,32 @@ void Worker<T>::InitPSOptimId(const size_t param_key) {
   kv_worker_->PushData(keys, optim_id_vals, optim_id_lens, kInitWeightToOptimIdCmd);
 }
 
+template <typename T>
+void Worker<T>::InitPSGradCodec(const size_t param_key, const size_t param_elem_num) {
+  GradCodecType codec_type = grad_codec_type_;
+  if (codec_type == kGradCodecNone || param_elem_num < kMinGradSizeToEncode) {
+    return;
+  }
+  int64_t optim_id = key_to_optimId_[param_key];
+  const std::string &optim_name = Util::optimizer_name(optim_id);
+  if (kOptimToPSSendIdx.count(optim_name) == 0) {
+    MS_LOG(EXCEPTION) << "Invalid optimizer " << optim_name << " of parameter key " << param_key;
+  }
+  bool is_sparse = optim_name == kSparseAdam || optim_name == kSparseLazyAdam || optim_name == kSparseFtrl;
+  if (is_sparse && codec_type == kGradCodecTopK) {
+    // The rows of a sparse gradient change every step, there is no fixed position to keep the residual for.
+    MS_LOG(INFO) << "Top-k codec is not supported by the sparse gradient of key " << param_key << ", use fp16.";
+    codec_type = kGradCodecFp16;
+  }
+  size_t grad_index = kOptimToPSSendIdx.at(optim_name).at("grad");
+  kv_worker_->SetGradCodec(param_key, CreateGradientCodec(codec_type, grad_topk_ratio_), grad_index);
+
+  ::ps::SArray<::ps::Key> keys = {param_key};
+  ::ps::SArray<T> codec_vals = {static_cast<T>(codec_type)};
+  ::ps::SArray<int> codec_lens = {codec_vals.size()};
+  kv_worker_->PushData(keys, codec_vals, codec_lens, kInitGradCodecCmd);
+}
+
 template <typename T>
 void Worker<T>::InitPSEmbeddingTable(const std::vector<size_t> &keys, std::vector<T> shapes, const ShapeVector &sizes) {
   bool has_init = IsKeyInit(keys[0]);
@@ -372,6 +425,7 @@ void Worker<T>::InitPSParamAndOptim(const AnfNodePtr &input_node, const tensor::
         InitPSParamData({param_key}, param_data, param_size);
       }
       InitPSOptimId(param_key);
+      InitPSGradCodec(param_key, param_size / sizeof(T));
       InitPSOptimInputShapes(param_key);
     }
   }
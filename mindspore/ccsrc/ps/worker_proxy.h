@@ -17,12 +17,14 @@
 #ifndef MINDSPORE_CCSRC_PS_WORKER_PROXY_H_
 #define MINDSPORE_CCSRC_PS_WORKER_PROXY_H_
 
+#include <limits>
 #include <map>
 #include <numeric>
 #include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include <algorithm>
+#include <type_traits>
 #include <utility>
 #include <memory>
 #include <vector>
@@ -30,6 +32,8 @@
 #include "ps/util.h"
 #include "backend/kernel_compiler/common_utils.h"
 #include "ps/ps_context.h"
+#include "ps/embedding_hot_rows.h"
+#include "ps/gradient_codec.h"
 
 namespace mindspore {
 namespace ps {
@@ -39,6 +43,8 @@ class WorkerProxy : public ::ps::KVWorker<T> {
   using Worker = ::ps::KVWorker<T>;
   using Callback = std::function<void()>;
   using SlicedKVs = std::vector<std::pair<bool, ::ps::KVPairs<T>>>;
+  // The codec of a key and the index of the gradient in its pushes.
+  using GradCodec = std::pair<GradientCodecPtr, size_t>;
   using Slicer = std::function<void(int64_t ts, const ::ps::KVPairs<T> &send, const std::vector<::ps::Range> &ranges,
                                     SlicedKVs *sliced, const std::map<int64_t, int64_t> &attrs)>;
   using ::ps::SimpleApp::obj_;
@@ -67,6 +73,10 @@ class WorkerProxy : public ::ps::KVWorker<T> {
 
   void AddEmbeddingTable(const ::ps::Key &key, const size_t &row_count);
   void AddKeyToServerId(const ::ps::Key &key);
+  void SetGradCodec(const ::ps::Key &key, const GradientCodecPtr &codec, size_t grad_index);
+  // Keeps copies of the row_num hottest rows of each server shard of the embedding tables, pulled again every
+  // refresh_steps lookups of a table, and before that once they fall out of the staleness bound of the SSP mode.
+  void SetHotRowReplication(size_t row_num, size_t refresh_steps);
   void EmbeddingLookup(const ::ps::SArray<::ps::Key> &keys, const ::ps::SArray<int> &lookup_ids,
                        const ::ps::SArray<int> &lens, ::ps::SArray<T> *outs, int64_t cmd = 0,
                        const Callback &cb = nullptr, int64_t priority = 0);
@@ -110,6 +120,8 @@ class WorkerProxy : public ::ps::KVWorker<T> {
   void Send(::ps::Customer *customer, int64_t timestamp, bool push, bool pull, int64_t cmd, const ::ps::KVPairs<T> &kvs,
             const Slicer &slicer, std::map<int64_t, int64_t> attrs = {});
   void AddKeyByHashMod(const ::ps::Key &key);
+  void EncodeGrad(const GradCodec &grad_codec, ::ps::KVPairs<T> *kvs);
+  void RefreshHotRows(const ::ps::Key &key);
 
   void PrepareSparseGradient(const size_t begin, const size_t end, const std::unordered_set<int> &distinct_ids,
                              const std::vector<std::pair<int, T *>> &indice_to_grad, const int *all_indice,
@@ -135,6 +147,11 @@ class WorkerProxy : public ::ps::KVWorker<T> {
   std::unordered_map<int64_t, int64_t> expected_result_count_;
   std::unordered_map<::ps::Key, int64_t> key_to_server_id_;
   std::unordered_map<::ps::Key, size_t> embedding_row_cnt_;
+  std::unordered_map<::ps::Key, GradCodec> grad_codecs_;
+  size_t hot_row_num_{0};
+  size_t hot_row_refresh_steps_{kDefaultHotRowRefreshSteps};
+  std::unordered_map<::ps::Key, HotEmbeddingRowsPtr> hot_rows_;
+  std::unordered_map<::ps::Key, size_t> hot_row_lookups_;
 };
 
 template <typename T>
@@ -173,10 +190,34 @@ void WorkerProxy<T>::AddKeyToServerId(const ::ps::Key &key) {
   AddKeyByHashMod(key);
 }
 
+template <typename T>
+void WorkerProxy<T>::SetGradCodec(const ::ps::Key &key, const GradientCodecPtr &codec, size_t grad_index) {
+  MS_EXCEPTION_IF_NULL(codec);
+  grad_codecs_[key] = std::make_pair(codec, grad_index);
+}
+
+template <typename T>
+void WorkerProxy<T>::SetHotRowReplication(size_t row_num, size_t refresh_steps) {
+  if (refresh_steps == 0) {
+    MS_LOG(EXCEPTION) << "The refresh steps of the hot embedding rows should be greater than zero.";
+  }
+  hot_row_num_ = row_num;
+  hot_row_refresh_steps_ = refresh_steps;
+  MS_LOG(INFO) << "The worker keeps " << row_num << " hot rows of each embedding table shard, refreshed every "
+               << refresh_steps << " lookups.";
+}
+
 template <typename T>
 void WorkerProxy<T>::EmbeddingLookup(const ::ps::SArray<::ps::Key> &keys, const ::ps::SArray<int> &lookup_ids,
                                      const ::ps::SArray<int> &lens, ::ps::SArray<T> *outs, int64_t cmd,
                                      const Callback &cb, int64_t priority) {
+  if (hot_row_num_ > 0 && embedding_table_ranges_.count(keys[0]) > 0) {
+    auto hot_rows_iter = hot_rows_.find(keys[0]);
+    bool expired = hot_rows_iter != hot_rows_.end() && hot_rows_iter->second->Expired();
+    if (hot_row_lookups_[keys[0]]++ % hot_row_refresh_steps_ == 0 || expired) {
+      RefreshHotRows(keys[0]);
+    }
+  }
   int64_t ts = AddLookupCB(keys, lookup_ids, outs, cmd, cb);
   ::ps::KVPairs<T> kvs;
   kvs.keys = keys;
@@ -185,6 +226,11 @@ void WorkerProxy<T>::EmbeddingLookup(const ::ps::SArray<::ps::Key> &keys, const
   expected_result_count_[ts] = 0;
   Send(lookup_customer_.get(), ts, true, true, cmd, kvs, lookup_slicer_);
   int64_t expect_rt_count = expected_result_count_[ts];
+  if (expect_rt_count == 0) {
+    // every id is found in the hot rows, no server answers
+    lookup_callbacks_[ts]();
+    lookup_callbacks_.erase(ts);
+  }
   lookup_customer_->AddResponse(ts, server_num_ - expect_rt_count);
   lookup_customer_->WaitRequest(ts);
   expected_result_count_.erase(ts);
@@ -213,6 +259,7 @@ void WorkerProxy<T>::UpdateEmbeddingTable(const ::ps::SArray<::ps::Key> &keys, c
   kvs.vals = vals;
   kvs.priority = priority;
   expected_result_count_[ts] = 0;
+  hot_rows_.erase(keys[0]);
   Send(general_customer_.get(), ts, true, false, kUpdateEmbeddingsCmd, kvs, update_embedding_slicer_);
   if (expected_result_count_[ts] < server_num_) {
     general_customer_->AddResponse(ts, server_num_ - expected_result_count_[ts]);
@@ -252,6 +299,14 @@ void WorkerProxy<T>::PushData(const ::ps::SArray<::ps::Key> &keys, const ::ps::S
   kvs.vals = vals;
   kvs.lens = lens;
   kvs.priority = priority;
+  auto codec_iter = grad_codecs_.find(keys[0]);
+  if (cmd == 0 && codec_iter != grad_codecs_.end()) {
+    EncodeGrad(codec_iter->second, &kvs);
+  }
+  if (cmd == 0) {
+    // a dense gradient updates every row the worker keeps a copy of
+    hot_rows_.erase(keys[0]);
+  }
   if (embedding_table_ranges_.count(keys[0])) {
     if (cmd == kInitWeightsCmd) {
       Send(general_customer_.get(), ts, true, false, cmd, kvs, worker_init_embedding_slicer_);
@@ -277,10 +332,21 @@ void WorkerProxy<T>::PushSparseData(const ::ps::SArray<::ps::Key> &keys, const :
   kvs.vals = vals;
   kvs.lens = lens;
   const int64_t cmd = 0;
+  auto hot_rows_iter = hot_rows_.find(keys[0]);
+  if (hot_rows_iter != hot_rows_.end()) {
+    // the worker must not read its own rows from before the update
+    size_t indice_offset = std::accumulate(lens.begin(), lens.begin() + indice_index, 0);
+    const int *indices = reinterpret_cast<const int *>(vals.data()) + indice_offset;
+    hot_rows_iter->second->Push(indices, IntToSize(lens[indice_index]));
+  }
   if (embedding_table_ranges_.count(keys[0])) {
     std::map<int64_t, int64_t> attrs{{0, grad_index}, {1, indice_index}, {2, first_dim_size}, {3, outer_dim_size}};
     Send(general_customer_.get(), ts, true, false, cmd, kvs, sparse_slicer_, attrs);
   } else {
+    auto codec_iter = grad_codecs_.find(keys[0]);
+    if (codec_iter != grad_codecs_.end()) {
+      EncodeGrad(codec_iter->second, &kvs);
+    }
     Send(general_customer_.get(), ts, true, false, cmd, kvs, round_robin_slicer_);
   }
   if (expected_result_count_[ts] < server_num_) {
@@ -325,7 +391,9 @@ int64_t WorkerProxy<T>::AddLookupCB(const ::ps::SArray<::ps::Key> &keys, const :
                                     C *lookup_result, int64_t cmd, const Callback &cb) {
   MS_EXCEPTION_IF_NULL(lookup_result);
   int64_t ts = lookup_customer_->NewRequest(::ps::kServerGroup);
-  const auto &callback = [this, ts, keys, lookup_ids, lookup_result, cb]() mutable {
+  auto hot_rows_iter = hot_rows_.find(keys[0]);
+  HotEmbeddingRowsPtr hot_rows = hot_rows_iter == hot_rows_.end() ? nullptr : hot_rows_iter->second;
+  const auto &callback = [this, ts, keys, lookup_ids, lookup_result, hot_rows, cb]() mutable {
     mutex_.lock();
     auto &kvs = lookup_results_[ts];
     mutex_.unlock();
@@ -353,8 +421,16 @@ int64_t WorkerProxy<T>::AddLookupCB(const ::ps::SArray<::ps::Key> &keys, const :
     size_t src_size = 0;
     void *dst_data = nullptr;
     void *src_data = nullptr;
+    if (hot_rows != nullptr && hot_rows->row_size() != LongToSize(single_id_len)) {
+      MS_LOG(EXCEPTION) << "The hot rows of " << hot_rows->row_size() << " elements don't match the lookup result of "
+                        << single_id_len << " elements a row.";
+    }
     for (size_t i = 0; i < lookup_ids.size(); i++) {
       if (id_addr_map.count(lookup_ids[i]) == 0) {
+        const float *hot_row = hot_rows == nullptr ? nullptr : hot_rows->Find(lookup_ids[i]);
+        if (hot_row != nullptr) {
+          (void)std::copy(hot_row, hot_row + single_id_len, result_addr + offset);
+        }
         offset += single_id_len;
         continue;
       }
@@ -426,6 +502,8 @@ void WorkerProxy<T>::LookupIdSlicer(int64_t timestamp, const ::ps::KVPairs<T> &s
   const Key &key = send.keys[0];
   const std::vector<::ps::Range> &ranges = *(embedding_table_ranges_[key]);
   sliced->resize(ranges.size());
+  auto hot_rows_iter = hot_rows_.find(key);
+  HotEmbeddingRowsPtr hot_rows = hot_rows_iter == hot_rows_.end() ? nullptr : hot_rows_iter->second;
 
   for (size_t i = 0; i < ranges.size(); i++) {
     const ::ps::Range &range = ranges[i];
@@ -441,7 +519,8 @@ void WorkerProxy<T>::LookupIdSlicer(int64_t timestamp, const ::ps::KVPairs<T> &s
       auto lookup_id = static_cast<uint64_t>(lookup_ids[j]);
       // If lookup_id is out of range, like negative number, unique_ids will not contain it.
       // Servers always get lookup_ids in its embedding table range.
-      if (lookup_id >= begin && lookup_id <= end) {
+      // The hot rows are copied from the servers, their lookups are answered by the worker.
+      if (lookup_id >= begin && lookup_id <= end && (hot_rows == nullptr || !hot_rows->Contains(lookup_ids[j]))) {
         unique_ids.insert(lookup_id);
       }
     }
@@ -555,6 +634,11 @@ void WorkerProxy<T>::SparseSlicer(int64_t timestamp, const ::ps::KVPairs<T> &sen
 
       kvs.lens = reduced_lens;
       kvs.vals = reduced_data;
+      // Encoded after the reduction, each server gets the rows of its own range only.
+      auto codec_iter = grad_codecs_.find(key);
+      if (codec_iter != grad_codecs_.end()) {
+        EncodeGrad(codec_iter->second, &kvs);
+      }
     }
 
     if (indices_size <= 0) {
@@ -571,6 +655,82 @@ void WorkerProxy<T>::SparseSlicer(int64_t timestamp, const ::ps::KVPairs<T> &sen
   }
 }
 
+template <typename T>
+void WorkerProxy<T>::EncodeGrad(const GradCodec &grad_codec, ::ps::KVPairs<T> *kvs) {
+  static_assert(std::is_same<T, float>::value, "Only float gradients can be encoded.");
+  MS_EXCEPTION_IF_NULL(kvs);
+  const GradientCodecPtr &codec = grad_codec.first;
+  size_t grad_index = grad_codec.second;
+  MS_EXCEPTION_IF_NULL(codec);
+  if (grad_index >= kvs->lens.size()) {
+    MS_LOG(EXCEPTION) << "The gradient index " << grad_index << " is out of the " << kvs->lens.size() << " inputs.";
+  }
+  size_t grad_offset = std::accumulate(kvs->lens.begin(), kvs->lens.begin() + grad_index, 0);
+  size_t grad_size = kvs->lens[grad_index];
+  const T *data = kvs->vals.data();
+  std::vector<float> encoded(data, data + grad_offset);
+  codec->Encode(data + grad_offset, grad_size, &encoded);
+  size_t encoded_grad_size = encoded.size() - grad_offset;
+  encoded.insert(encoded.end(), data + grad_offset + grad_size, data + kvs->vals.size());
+
+  // The lengths may be shared with the caller, they are copied instead of modified in place.
+  ::ps::SArray<int> encoded_lens;
+  encoded_lens.CopyFrom(kvs->lens);
+  encoded_lens[grad_index] = SizeToInt(encoded_grad_size);
+  ::ps::SArray<T> encoded_vals;
+  encoded_vals.CopyFrom(encoded.data(), encoded.size());
+  kvs->lens = encoded_lens;
+  kvs->vals = encoded_vals;
+}
+
+// Pulls the hottest rows of every server shard of the table key. The hits of the rows kept so far are sent along,
+// the servers count them as lookups.
+template <typename T>
+void WorkerProxy<T>::RefreshHotRows(const ::ps::Key &key) {
+  ::ps::SArray<T> rows;
+  // each server answers with the pushes its rows stay within the staleness bound for, the row number and the ids
+  ::ps::SArray<int> slacks_and_ids;
+  int64_t ts = AddGeneralRspCB({key}, &rows, &slacks_and_ids, kPullHotEmbeddingsCmd, nullptr);
+  std::vector<int> ids_and_hits;
+  auto iter = hot_rows_.find(key);
+  if (iter != hot_rows_.end()) {
+    iter->second->TakeHits(&ids_and_hits);
+  }
+  ::ps::KVPairs<T> kvs;
+  kvs.keys.push_back(key);
+  kvs.vals.push_back(static_cast<T>(hot_row_num_));
+  kvs.lens.CopyFrom(ids_and_hits.data(), ids_and_hits.size());
+  Send(general_customer_.get(), ts, false, true, kPullHotEmbeddingsCmd, kvs, broadcast_slicer_);
+  if (expected_result_count_[ts] < server_num_) {
+    general_customer_->AddResponse(ts, server_num_ - expected_result_count_[ts]);
+  }
+  general_customer_->WaitRequest(ts);
+  expected_result_count_.erase(ts);
+
+  std::vector<int> ids;
+  uint64_t push_slack = std::numeric_limits<uint64_t>::max();
+  size_t pos = 0;
+  while (pos + 1 < slacks_and_ids.size()) {
+    push_slack = std::min(push_slack, static_cast<uint64_t>(slacks_and_ids[pos]));
+    size_t id_num = IntToSize(slacks_and_ids[pos + 1]);
+    pos += 2;
+    if (pos + id_num > slacks_and_ids.size()) {
+      MS_LOG(EXCEPTION) << "The hot rows of the embedding table " << key << " have " << id_num << " ids, but only "
+                        << slacks_and_ids.size() - pos << " are received.";
+    }
+    ids.insert(ids.end(), slacks_and_ids.begin() + pos, slacks_and_ids.begin() + pos + id_num);
+    pos += id_num;
+  }
+  if (ids.empty()) {
+    hot_rows_.erase(key);
+    return;
+  }
+  hot_rows_[key] =
+    std::make_shared<HotEmbeddingRows>(ids.data(), ids.size(), rows.data(), rows.size() / ids.size(), push_slack);
+  MS_LOG(DEBUG) << "The worker keeps " << ids.size() << " hot rows of the embedding table " << key << " for "
+                << push_slack << " pushes.";
+}
+
 template <typename T>
 void WorkerProxy<T>::PrepareSparseGradient(const size_t begin, const size_t end,
                                            const std::unordered_set<int> &distinct_ids,
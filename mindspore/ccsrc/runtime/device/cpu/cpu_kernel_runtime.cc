@@ -22,8 +22,10 @@
 #include <algorithm>
 #include <functional>
 #include <exception>
+#include <set>
 #include "backend/kernel_compiler/kernel.h"
 #include "runtime/device/cpu/cpu_device_address.h"
+#include "runtime/device/cpu/cpu_memory_copy_manager.h"
 #include "utils/ms_context.h"
 #include "backend/session/anf_runtime_algorithm.h"
 #include "backend/session/session_basic.h"
@@ -31,12 +33,52 @@
 #include "utils/shape_utils.h"
 #include "utils/profile.h"
 #include "utils/trace_base.h"
+#include "utils/ms_utils.h"
+#include "utils/utils.h"
 
 namespace mindspore {
 namespace device {
 namespace cpu {
+using mindspore::device::memswap::MemSwapInfoSet;
+using mindspore::device::memswap::MemSwapManager;
+using mindspore::device::memswap::SwapKind;
 const size_t INIT_NODE_REF = 1;
+namespace {
+constexpr auto kEnvCpuSwapDir = "MS_CPU_SWAP_DIR";
+constexpr auto kEnvCpuSwapMemBudget = "MS_CPU_SWAP_MEM_BUDGET";
+constexpr size_t kMBShift = 20;
+constexpr float kSecondToMillisecond = 1000;
+constexpr size_t kMinSwapParameterSize = 1UL << 20;
+// a parameter is only released when no kernel uses it for a while, and prefetched a few kernels before the next use
+constexpr size_t kParameterSwapMinDistance = 8;
+constexpr size_t kParameterPrefetchDistance = 2;
+}  // namespace
+
+void CPUKernelRuntime::InitMemSwapConfig() {
+  if (mem_swap_config_inited_) {
+    return;
+  }
+  mem_swap_config_inited_ = true;
+  auto swap_dir = common::GetEnv(kEnvCpuSwapDir);
+  auto swap_mem_budget = common::GetEnv(kEnvCpuSwapMemBudget);
+  if (swap_dir.empty() || swap_mem_budget.empty()) {
+    return;
+  }
+  try {
+    swap_mem_budget_ = std::stoul(swap_mem_budget) << kMBShift;
+  } catch (std::exception &e) {
+    MS_LOG(WARNING) << "Invalid " << kEnvCpuSwapMemBudget << " value: " << swap_mem_budget
+                    << ", memory swap is disabled.";
+    return;
+  }
+  swap_dir_ = swap_dir;
+  // swapped tensors are released and reallocated on the fly, which only works with reference counted memory
+  resource_manager_.set_dynamic_malloc(true);
+  MS_LOG(INFO) << "Enable CPU memory swap to " << swap_dir_ << " with memory budget " << swap_mem_budget_ << " bytes.";
+}
+
 void CPUKernelRuntime::AssignKernelAddress(session::KernelGraph *kernel_graph) {
+  InitMemSwapConfig();
   AssignValueNodeAddress(kernel_graph);
   AssignInputNodeAddress(kernel_graph);
   AssignKernelOutputAddress(kernel_graph);
@@ -338,15 +380,374 @@ void CPUKernelRuntime::DecreaseSummaryRefCount(const session::NamedSummaryOutput
   resource_manager_.DecreaseSummaryRefCount(summary_outputs);
 }
 
-bool CPUKernelRuntime::Run(session::KernelGraph *kernel_graph, bool is_task_sink) {
+bool CPUKernelRuntime::IsMemSwapTriggered() const {
+  return mem_swap_manager_ != nullptr && mem_swap_manager_->trigger_swap();
+}
+
+bool CPUKernelRuntime::InitMemorySwap(const session::KernelGraph *kernel_graph) {
   MS_EXCEPTION_IF_NULL(kernel_graph);
-  resource_manager_.IncreaseAddressRefCount(kernel_graph);
+  auto graph_id = kernel_graph->graph_id();
+  param_swap_plan_ = &param_swap_plans_[graph_id];
+  auto iter = mem_swap_map_.find(graph_id);
+  if (iter != mem_swap_map_.end()) {
+    mem_swap_manager_ = iter->second;
+    // an assignment from the front end may have replaced the data of a parameter stored in the swap file
+    for (const auto &parameter : param_swap_plan_->parameters) {
+      (void)MoveParameterToSwapFile(parameter);
+    }
+    return false;
+  }
+  auto cpu_mem_copy_manager = std::make_shared<CPUMemCopyManager>(swap_dir_);
+  mem_swap_manager_ = std::make_shared<MemSwapManager>(cpu_mem_copy_manager);
+  mem_swap_map_[graph_id] = mem_swap_manager_;
+  SearchParameterSwapScheme(kernel_graph, param_swap_plan_);
+  return SearchMemSwapScheme(kernel_graph);
+}
 
-  auto kernels = kernel_graph->execution_order();
+bool CPUKernelRuntime::MoveParameterToSwapFile(const AnfNodePtr &parameter) {
+  auto iter = input_param_tensor_map_.find(parameter);
+  if (iter == input_param_tensor_map_.end()) {
+    return false;
+  }
+  auto &tensor = iter->second;
+  MS_EXCEPTION_IF_NULL(tensor);
+  auto address = AnfAlgo::GetMutableOutputAddr(parameter, 0);
+  MS_EXCEPTION_IF_NULL(address);
+  // a parameter converted to another data type is bound to a copy, which is not the storage of the tensor
+  if (tensor->data_type() != address->type_id_ || address->ptr_ != tensor->data_c()) {
+    return false;
+  }
+  if (param_swap_manager_ == nullptr) {
+    param_swap_manager_ = std::make_shared<CPUMemCopyManager>(swap_dir_);
+    param_swap_manager_->Init();
+  }
+  if (!param_swap_manager_->MoveTensorToSwapFile(tensor)) {
+    MS_LOG(WARNING) << "Move parameter " << parameter->DebugString() << " to the swap file failed.";
+    return false;
+  }
+  address->ptr_ = tensor->data_c();
+  return true;
+}
+
+void CPUKernelRuntime::AddParameterSwapPoints(const std::vector<size_t> &uses, size_t kernel_num,
+                                              const DeviceAddressPtr &address, ParameterSwapPlan *plan) const {
+  MS_EXCEPTION_IF_NULL(plan);
+  for (size_t i = 0; i < uses.size(); ++i) {
+    // the uses repeat every step, so the use after the last one is the first use of the next step
+    size_t next_use = i + 1 < uses.size() ? uses[i + 1] : uses[0] + kernel_num;
+    if (next_use - uses[i] < kParameterSwapMinDistance) {
+      continue;
+    }
+    plan->release_addresses[uses[i]].push_back(address);
+    size_t prefetch_pos = next_use > kParameterPrefetchDistance ? next_use - kParameterPrefetchDistance : 0;
+    prefetch_pos = std::max(prefetch_pos, uses[i] + 1);
+    plan->prefetch_addresses[prefetch_pos % kernel_num].push_back(address);
+  }
+}
+
+void CPUKernelRuntime::SearchParameterSwapScheme(const session::KernelGraph *kernel_graph, ParameterSwapPlan *plan) {
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  MS_EXCEPTION_IF_NULL(plan);
+  auto &kernels = kernel_graph->execution_order();
+  std::map<AnfNodePtr, std::vector<size_t>> param_uses;
+  for (size_t pos = 0; pos < kernels.size(); ++pos) {
+    for (size_t i = 0; i < AnfAlgo::GetInputTensorNum(kernels[pos]); ++i) {
+      auto input = AnfAlgo::VisitKernel(AnfAlgo::GetInputNode(kernels[pos], i), 0).first;
+      MS_EXCEPTION_IF_NULL(input);
+      if (!input->isa<Parameter>() || !AnfAlgo::IsParameterWeight(input->cast<ParameterPtr>())) {
+        continue;
+      }
+      auto &uses = param_uses[input];
+      if (uses.empty() || uses.back() != pos) {
+        uses.push_back(pos);
+      }
+    }
+  }
+  struct Candidate {
+    AnfNodePtr parameter;
+    size_t size;
+    bool optimizer_state;
+  };
+  std::vector<Candidate> candidates;
+  size_t param_mem = 0;
+  for (const auto &param_use : param_uses) {
+    auto size = AnfAlgo::GetOutputAddr(param_use.first, 0)->size_;
+    param_mem += size;
+    if (size < kMinSwapParameterSize) {
+      continue;
+    }
+    // optimizer states, e.g. the moments of Adam, are only read and updated by the optimizer once per step
+    bool optimizer_state = std::all_of(param_use.second.begin(), param_use.second.end(), [&kernels](size_t pos) {
+      return kOptOperatorSet.find(AnfAlgo::GetCNodeName(kernels[pos])) != kOptOperatorSet.end();
+    });
+    candidates.push_back({param_use.first, size, optimizer_state});
+  }
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+    return a.optimizer_state != b.optimizer_state ? a.optimizer_state : a.size > b.size;
+  });
+  auto activation_mem = MockRunPeakMemory(kernel_graph);
+  for (const auto &candidate : candidates) {
+    if (param_mem + activation_mem <= swap_mem_budget_) {
+      break;
+    }
+    if (!MoveParameterToSwapFile(candidate.parameter)) {
+      continue;
+    }
+    param_mem -= candidate.size;
+    plan->parameters.push_back(candidate.parameter);
+    AddParameterSwapPoints(param_uses[candidate.parameter], kernels.size(),
+                           AnfAlgo::GetMutableOutputAddr(candidate.parameter, 0), plan);
+  }
+  plan->mem_budget = swap_mem_budget_ > param_mem ? swap_mem_budget_ - param_mem : 0;
+  MS_LOG(INFO) << "Graph " << kernel_graph->graph_id() << " moved " << plan->parameters.size()
+               << " parameters to the swap file, resident parameters take " << param_mem << " bytes.";
+}
+
+size_t CPUKernelRuntime::MockRunPeakMemory(const session::KernelGraph *kernel_graph) const {
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  auto &kernels = kernel_graph->execution_order();
+  // graph outputs are bound to the output tensors and never released by the reference count
+  std::set<DeviceAddress *> graph_output_addresses;
+  for (const auto &output : AnfAlgo::GetAllOutput(kernel_graph->output(), {prim::kPrimTupleGetItem})) {
+    auto kernel_with_index = AnfAlgo::VisitKernel(output, 0);
+    if (AnfAlgo::IsRealCNodeKernel(kernel_with_index.first)) {
+      (void)graph_output_addresses.insert(
+        AnfAlgo::GetMutableOutputAddr(kernel_with_index.first, kernel_with_index.second).get());
+    }
+  }
+  std::set<DeviceAddress *> dynamic_addresses;
+  std::map<DeviceAddress *, int> ref_counts;
+  for (const auto &kernel : kernels) {
+    for (size_t i = 0; i < AnfAlgo::GetOutputTensorNum(kernel); ++i) {
+      auto address = AnfAlgo::GetMutableOutputAddr(kernel, i).get();
+      if (graph_output_addresses.find(address) == graph_output_addresses.end()) {
+        (void)dynamic_addresses.insert(address);
+      }
+    }
+    for (size_t i = 0; i < AnfAlgo::GetInputTensorNum(kernel); ++i) {
+      ref_counts[AnfAlgo::GetPrevNodeMutableOutputAddr(kernel, i).get()]++;
+    }
+    for (size_t i = 0; i < AnfAlgo::GetKernelMod(kernel)->GetWorkspaceSizeList().size(); ++i) {
+      auto address = AnfAlgo::GetWorkspaceAddr(kernel, i);
+      (void)dynamic_addresses.insert(address);
+      ref_counts[address]++;
+    }
+  }
+
+  std::set<DeviceAddress *> resident;
+  size_t cur_mem = 0;
+  size_t peak_mem = 0;
+  auto alloc = [&](DeviceAddress *address) {
+    if (dynamic_addresses.find(address) != dynamic_addresses.end() && resident.insert(address).second) {
+      cur_mem += address->size_;
+      peak_mem = std::max(peak_mem, cur_mem);
+    }
+  };
+  auto release = [&](DeviceAddress *address) {
+    if (resident.erase(address) > 0) {
+      cur_mem -= address->size_;
+    }
+  };
+  bool swap_triggered = IsMemSwapTriggered();
+  for (const auto &kernel : kernels) {
+    std::vector<DeviceAddress *> used_addresses;
+    for (size_t i = 0; i < AnfAlgo::GetInputTensorNum(kernel); ++i) {
+      used_addresses.push_back(AnfAlgo::GetPrevNodeMutableOutputAddr(kernel, i).get());
+      alloc(used_addresses.back());
+    }
+    for (size_t i = 0; i < AnfAlgo::GetOutputTensorNum(kernel); ++i) {
+      alloc(AnfAlgo::GetMutableOutputAddr(kernel, i).get());
+    }
+    for (size_t i = 0; i < AnfAlgo::GetKernelMod(kernel)->GetWorkspaceSizeList().size(); ++i) {
+      used_addresses.push_back(AnfAlgo::GetWorkspaceAddr(kernel, i));
+      alloc(used_addresses.back());
+    }
+    for (auto address : used_addresses) {
+      if (--ref_counts[address] == 0) {
+        release(address);
+      }
+    }
+    if (!swap_triggered || !mem_swap_manager_->QueryKernelTriggerSwap(kernel)) {
+      continue;
+    }
+    for (auto &mem_swap_info : mem_swap_manager_->QueryKernelMemSwapInfo(kernel)) {
+      auto need_swap_kernel = mem_swap_manager_->QueryKernelByTopoOrder(mem_swap_info.topo_order_);
+      auto address = AnfAlgo::GetMutableOutputAddr(need_swap_kernel, mem_swap_info.output_idx_).get();
+      if (ref_counts[address] <= 0) {
+        continue;
+      }
+      if (mem_swap_info.swap_kind_ == SwapKind::kDeviceToHost) {
+        release(address);
+      } else {
+        alloc(address);
+      }
+    }
+  }
+  return peak_mem;
+}
+
+bool CPUKernelRuntime::SearchMemSwapScheme(const session::KernelGraph *kernel_graph) {
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  auto mem_budget = param_swap_plan_->mem_budget;
+  auto peak_mem = MockRunPeakMemory(kernel_graph);
+  if (peak_mem <= mem_budget || kernel_graph->execution_order().empty()) {
+    MS_LOG(INFO) << "Graph " << kernel_graph->graph_id() << " estimated peak memory " << peak_mem
+                 << " bytes fits the memory budget, no memory swap.";
+    return false;
+  }
+  MS_LOG(INFO) << "Graph " << kernel_graph->graph_id() << " estimated peak memory " << peak_mem
+               << " bytes exceeds the memory budget " << mem_budget << " bytes, search memory swap scheme.";
+  if (!mem_swap_manager_->Init(kernel_graph)) {
+    MS_LOG(WARNING) << "Init memory swap manager failed, run graph without memory swap.";
+    return false;
+  }
+  while (peak_mem > mem_budget) {
+    if (!mem_swap_manager_->RetreatSwapInfo()) {
+      MS_LOG(WARNING) << "No memory swap scheme fits the memory budget " << mem_budget
+                      << " bytes, run graph without memory swap.";
+      return false;
+    }
+    peak_mem = MockRunPeakMemory(kernel_graph);
+  }
+  mem_swap_manager_->AssignHostMemory();
+  MS_LOG(INFO) << "Graph " << kernel_graph->graph_id() << " estimated peak memory with swap " << peak_mem << " bytes.";
+  return true;
+}
+
+void CPUKernelRuntime::RefineMemSwapScheme(const session::KernelGraph *kernel_graph) {
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  MS_LOG(INFO) << "Refine memory swap scheme, it may take some time, please wait a moment.";
+  auto &kernels = kernel_graph->execution_order();
+  auto mem_budget = param_swap_plan_->mem_budget;
   for (const auto &kernel : kernels) {
+    if (!mem_swap_manager_->QueryKernelTriggerSwapIn(kernel)) {
+      continue;
+    }
+    size_t swap_in_task_num = mem_swap_manager_->QueryKernelTriggerSwapInTaskNum(kernel);
+    for (size_t swap_in_task_idx = 0; swap_in_task_idx < swap_in_task_num; swap_in_task_idx++) {
+      // move the swap in ahead far enough to hide the copy, then back off while the budget is exceeded
+      size_t retry = 0;
+      do {
+        mem_swap_manager_->AdjustSwapInPos(kernel, swap_in_task_idx);
+      } while (MockRunPeakMemory(kernel_graph) > mem_budget && ++retry <= kernels.size());
+    }
+  }
+}
+
+void CPUKernelRuntime::AddMemorySwapTask(const AnfNodePtr &kernel, bool profiling) {
+  MS_EXCEPTION_IF_NULL(mem_swap_manager_);
+  const MemSwapInfoSet &mem_swap_info_set = mem_swap_manager_->QueryKernelMemSwapInfo(kernel);
+  for (auto &mem_swap_info : mem_swap_info_set) {
+    auto need_swap_kernel = mem_swap_manager_->QueryKernelByTopoOrder(mem_swap_info.topo_order_);
+    MS_EXCEPTION_IF_NULL(need_swap_kernel);
+    const HostAddress &host_address =
+      mem_swap_manager_->QueryKernelHostAddr(need_swap_kernel, mem_swap_info.output_idx_);
+    auto device_address = AnfAlgo::GetMutableOutputAddr(need_swap_kernel, mem_swap_info.output_idx_);
+    MS_EXCEPTION_IF_NULL(device_address);
+
+    if (mem_swap_info.swap_kind_ == SwapKind::kDeviceToHost) {
+      if (device_address->ptr_ == nullptr) {
+        continue;
+      }
+      if (mem_swap_manager_->QueryKernelHostAddrIsDirty(need_swap_kernel, mem_swap_info.output_idx_)) {
+        mem_swap_manager_->AddMemSwapTask(SwapKind::kDeviceToHost, device_address, host_address, false);
+        mem_swap_manager_->AddKernelHostAddrIsDirty(need_swap_kernel, mem_swap_info.output_idx_, false);
+      } else {
+        resource_manager_.MemFree(device_address->ptr_);
+        device_address->ptr_ = nullptr;
+        device_address->set_status(DeviceAddressStatus::kInHost);
+      }
+    } else if (mem_swap_info.swap_kind_ == SwapKind::kHostToDevice) {
+      float cost_time = 0;
+      auto status = device_address->status();
+      if (status == DeviceAddressStatus::kInDeviceToHost) {
+        device_address->set_status(DeviceAddressStatus::kInDevice);
+      } else if (status == DeviceAddressStatus::kInHost) {
+        device_address->ptr_ = resource_manager_.MemMalloc(device_address->size_);
+        mem_swap_manager_->AddMemSwapTask(SwapKind::kHostToDevice, device_address, host_address, false, profiling,
+                                          &cost_time);
+      }
+      if (profiling) {
+        mem_swap_manager_->AddKernelSwapPerform(need_swap_kernel, mem_swap_info.output_idx_,
+                                                std::make_pair(0, cost_time));
+      }
+    }
+  }
+}
+
+void CPUKernelRuntime::AddParameterSwapTask(size_t kernel_pos, bool prefetch) {
+  MS_EXCEPTION_IF_NULL(param_swap_plan_);
+  MS_EXCEPTION_IF_NULL(param_swap_manager_);
+  auto &swap_addresses = prefetch ? param_swap_plan_->prefetch_addresses : param_swap_plan_->release_addresses;
+  auto iter = swap_addresses.find(kernel_pos);
+  if (iter == swap_addresses.end()) {
+    return;
+  }
+  // only the residency of the pages is advised, the kernels access the swap file mapping directly
+  for (const auto &address : iter->second) {
+    if (prefetch) {
+      param_swap_manager_->PrefetchRegion(address->ptr_, address->size_);
+    } else {
+      param_swap_manager_->AddRegionReleaseTask(address->ptr_, address->size_);
+    }
+  }
+}
+
+void CPUKernelRuntime::UpdateHostSwapInQueue(const DeviceAddressPtr &device_address) {
+  MS_EXCEPTION_IF_NULL(device_address);
+  while (auto device_address_swap_in = mem_swap_manager_->UpdateSwapQueue(SwapKind::kHostToDevice, false)) {
+    device_address_swap_in->set_status(DeviceAddressStatus::kInDevice);
+  }
+  auto status = device_address->status();
+  switch (status) {
+    case DeviceAddressStatus::kInDevice:
+      break;
+    case DeviceAddressStatus::kInDeviceToHost: {
+      device_address->set_status(DeviceAddressStatus::kInDevice);
+      break;
+    }
+    case DeviceAddressStatus::kInHostToDevice: {
+      (void)mem_swap_manager_->SyncMemCopyStream(SwapKind::kHostToDevice);
+      while (auto device_address_swap_in = mem_swap_manager_->UpdateSwapQueue(SwapKind::kHostToDevice, false)) {
+        device_address_swap_in->set_status(DeviceAddressStatus::kInDevice);
+      }
+      break;
+    }
+    case DeviceAddressStatus::kInHost:
+      MS_LOG(EXCEPTION) << "The tensor is used while it is swapped out.";
+    default:
+      MS_LOG(EXCEPTION) << "Invaild device address status: " << static_cast<int>(status);
+  }
+}
+
+void CPUKernelRuntime::UpdateHostSwapOutQueue() {
+  while (auto device_address_swap_out = mem_swap_manager_->UpdateSwapQueue(SwapKind::kDeviceToHost, false)) {
+    if (device_address_swap_out->status() == DeviceAddressStatus::kInDeviceToHost && device_address_swap_out->ptr_) {
+      device_address_swap_out->set_status(DeviceAddressStatus::kInHost);
+      resource_manager_.MemFree(device_address_swap_out->ptr_);
+      device_address_swap_out->ptr_ = nullptr;
+    }
+  }
+}
+
+void CPUKernelRuntime::ClearSwapInfo() {
+  mem_swap_manager_->ClearSwapQueue(false);
+  mem_swap_manager_->ResetHostAddrIsDirty();
+}
+
+void CPUKernelRuntime::LaunchKernels(const session::KernelGraph *kernel_graph, bool profiling) {
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  bool swap_triggered = IsMemSwapTriggered();
+  bool param_swapped = param_swap_plan_ != nullptr && !param_swap_plan_->parameters.empty();
+  auto kernels = kernel_graph->execution_order();
+  for (size_t kernel_pos = 0; kernel_pos < kernels.size(); ++kernel_pos) {
+    const auto &kernel = kernels[kernel_pos];
 #ifdef ENABLE_PROFILE
     double start_time = GetTime();
 #endif
+    if (param_swapped) {
+      AddParameterSwapTask(kernel_pos, true);
+    }
     if (AnfAlgo::IsDynamicShape(kernel)) {
       AnfAlgo::InferShape(kernel);
     }
@@ -355,9 +756,12 @@ bool CPUKernelRuntime::Run(session::KernelGraph *kernel_graph, bool is_task_sink
     std::vector<kernel::AddressPtr> kernel_outputs;
     size_t input_num = AnfAlgo::GetInputTensorNum(kernel);
     for (size_t i = 0; i < input_num; ++i) {
-      auto device_address = AnfAlgo::GetPrevNodeMutableOutputAddr(kernel, i).get();
+      auto device_address = AnfAlgo::GetPrevNodeMutableOutputAddr(kernel, i);
       MS_EXCEPTION_IF_NULL(device_address);
-      AddRuntimeAddress(device_address, &kernel_inputs);
+      if (swap_triggered) {
+        UpdateHostSwapInQueue(device_address);
+      }
+      AddRuntimeAddress(device_address.get(), &kernel_inputs);
     }
     size_t output_num = AnfAlgo::GetOutputTensorNum(kernel);
     for (size_t i = 0; i < output_num; ++i) {
@@ -373,6 +777,7 @@ bool CPUKernelRuntime::Run(session::KernelGraph *kernel_graph, bool is_task_sink
       AddRuntimeAddress(device_address, &kernel_workspaces);
     }
     bool ret = true;
+    double launch_start_time = profiling ? GetTime() : 0;
     try {
       ret = kernel_mod->Launch(kernel_inputs, kernel_workspaces, kernel_outputs, 0);
     } catch (std::exception &e) {
@@ -381,12 +786,48 @@ bool CPUKernelRuntime::Run(session::KernelGraph *kernel_graph, bool is_task_sink
     if (!ret) {
       MS_LOG(EXCEPTION) << "Launch kernel failed. Trace:" << trace::DumpSourceLines(kernel);
     }
+    if (profiling) {
+      auto cost_time = static_cast<float>((GetTime() - launch_start_time) * kSecondToMillisecond);
+      mem_swap_manager_->AddKernelExecutionPerform(kernel, cost_time);
+    }
     resource_manager_.DecreaseAddressRefCount(kernel);
+    if (swap_triggered) {
+      if (mem_swap_manager_->QueryKernelTriggerSwap(kernel)) {
+        AddMemorySwapTask(kernel, profiling);
+      }
+      UpdateHostSwapOutQueue();
+    }
+    if (param_swapped) {
+      AddParameterSwapTask(kernel_pos, false);
+    }
 #ifdef ENABLE_PROFILE
     double cost_time = GetTime() - start_time;
     MS_LOG(INFO) << "cpu kernel: " << kernel->fullname_with_scope() << "  costs " << cost_time * 1e6 << " us";
 #endif
   }
+  if (swap_triggered) {
+    ClearSwapInfo();
+  }
+  if (param_swapped) {
+    param_swap_manager_->SyncRegionReleaseTasks();
+  }
+}
+
+bool CPUKernelRuntime::Run(session::KernelGraph *kernel_graph, bool is_task_sink) {
+  MS_EXCEPTION_IF_NULL(kernel_graph);
+  resource_manager_.IncreaseAddressRefCount(kernel_graph);
+  bool profiling = false;
+  if (!swap_dir_.empty()) {
+    // the first step after the swap scheme is found measures kernels and swap copies to place the prefetches
+    profiling = InitMemorySwap(kernel_graph);
+  } else {
+    mem_swap_manager_ = nullptr;
+    param_swap_plan_ = nullptr;
+  }
+  LaunchKernels(kernel_graph, profiling);
+  if (profiling) {
+    RefineMemSwapScheme(kernel_graph);
+  }
   return true;
 }
 }  // namespace cpu
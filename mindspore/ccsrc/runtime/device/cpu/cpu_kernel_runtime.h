@@ -25,6 +25,8 @@
 #include "backend/session/kernel_graph.h"
 #include "backend/session/session_basic.h"
 #include "runtime/device/cpu/cpu_resource_manager.h"
+#include "runtime/device/cpu/cpu_memory_copy_manager.h"
+#include "backend/optimizer/mem_reuse/mem_swap_manager.h"
 #include "backend/session/anf_runtime_algorithm.h"
 #include "utils/any.h"
 namespace mindspore {
@@ -44,6 +46,10 @@ class CPUKernelRuntime : public KernelRuntime {
                        VectorRef *outputs);
   void IncreaseSummaryRefCount(const session::NamedSummaryOutputs &summary_outputs);
   void DecreaseSummaryRefCount(const session::NamedSummaryOutputs &summary_outputs);
+  // memory swap needs the reference counted memory of every graph, it can't be switched off here
+  void set_dynamic_malloc(bool dynamic_malloc) {
+    resource_manager_.set_dynamic_malloc(dynamic_malloc || !swap_dir_.empty());
+  }
   bool GenDynamicKernel(const session::KernelGraph *graph) override { return true; }
   bool RunDynamicKernelAsync(const session::KernelGraph *graph) override { return true; }
 
@@ -53,6 +59,14 @@ class CPUKernelRuntime : public KernelRuntime {
                                        TypeId type_id) override;
 
  private:
+  struct ParameterSwapPlan {
+    // the part of the memory budget left to the activations
+    size_t mem_budget{0};
+    std::vector<AnfNodePtr> parameters;
+    // addresses of the parameters whose pages are prefetched before, or released after, the kernel at a position
+    std::map<size_t, std::vector<DeviceAddressPtr>> prefetch_addresses;
+    std::map<size_t, std::vector<DeviceAddressPtr>> release_addresses;
+  };
   tensor::TensorPtr CreatTensorForOutput(session::KernelGraph *kernel_graph, const CNodePtr &node, size_t index,
                                          std::map<tensor::TensorPtr, session::KernelWithIndex> *tensor_to_node);
   BaseRef CreatTensorForOutput(session::KernelGraph *kernel_graph, const session::KernelWithIndex &kernel_with_index,
@@ -63,9 +77,36 @@ class CPUKernelRuntime : public KernelRuntime {
   void AssignInputNodeAddress(const session::KernelGraph *kernel_graph);
   void AssignKernelOutputAddress(const session::KernelGraph *kernel_graph);
   void AddRuntimeAddress(DeviceAddress *address, std::vector<kernel::AddressPtr> *input_list);
+  void LaunchKernels(const session::KernelGraph *kernel_graph, bool profiling);
+  // Memory swap of activations to a file on local disk, driven by the MemSwapManager planner. Parameters such as
+  // optimizer states are moved to the file as a whole and paged in around the kernels using them.
+  void InitMemSwapConfig();
+  bool InitMemorySwap(const session::KernelGraph *kernel_graph);
+  bool SearchMemSwapScheme(const session::KernelGraph *kernel_graph);
+  void SearchParameterSwapScheme(const session::KernelGraph *kernel_graph, ParameterSwapPlan *plan);
+  void AddParameterSwapPoints(const std::vector<size_t> &uses, size_t kernel_num, const DeviceAddressPtr &address,
+                              ParameterSwapPlan *plan) const;
+  bool MoveParameterToSwapFile(const AnfNodePtr &parameter);
+  void RefineMemSwapScheme(const session::KernelGraph *kernel_graph);
+  size_t MockRunPeakMemory(const session::KernelGraph *kernel_graph) const;
+  bool IsMemSwapTriggered() const;
+  void AddMemorySwapTask(const AnfNodePtr &kernel, bool profiling);
+  void AddParameterSwapTask(size_t kernel_pos, bool prefetch);
+  void UpdateHostSwapInQueue(const DeviceAddressPtr &device_address);
+  void UpdateHostSwapOutQueue();
+  void ClearSwapInfo();
   CPUResourceManager resource_manager_;
   std::set<DeviceAddressPtr> bound_addresses_;
   std::map<AnfNodePtr, tensor::TensorPtr> input_param_tensor_map_;
+  bool mem_swap_config_inited_{false};
+  std::string swap_dir_;
+  size_t swap_mem_budget_{0};
+  memswap::MemSwapManagerPtr mem_swap_manager_{nullptr};
+  std::map<uint32_t, memswap::MemSwapManagerPtr> mem_swap_map_;
+  // parameters of all graphs share one swap file, which lives as long as the tensors stored in it
+  CPUMemCopyManagerPtr param_swap_manager_{nullptr};
+  ParameterSwapPlan *param_swap_plan_{nullptr};
+  std::map<uint32_t, ParameterSwapPlan> param_swap_plans_;
 };
 }  // namespace cpu
 }  // namespace device
@@ -0,0 +1,364 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/device/cpu/cpu_memory_copy_manager.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "utils/log_adapter.h"
+#include "utils/profile.h"
+#include "utils/convert_utils_base.h"
+#include "securec/include/securec.h"
+
+namespace mindspore {
+namespace device {
+namespace cpu {
+namespace {
+constexpr float kSecondToMillisecond = 1000;
+
+size_t AlignToPage(size_t size) {
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return (size + page_size - 1) / page_size * page_size;
+}
+
+void CopyMemory(void *dst, const void *src, size_t size) {
+  // memcpy_s rejects copies larger than SECUREC_MEM_MAX_LEN, so large tensors are copied in chunks
+  constexpr size_t kCopyChunkSize = 1UL << 30;
+  auto dst_ptr = static_cast<uint8_t *>(dst);
+  auto src_ptr = static_cast<const uint8_t *>(src);
+  for (size_t offset = 0; offset < size; offset += kCopyChunkSize) {
+    size_t chunk = std::min(kCopyChunkSize, size - offset);
+    if (memcpy_s(dst_ptr + offset, chunk, src_ptr + offset, chunk) != EOK) {
+      MS_LOG(EXCEPTION) << "Memory copy of swap task failed, size " << size;
+    }
+  }
+}
+
+void ReleasePages(void *addr, size_t size) {
+  // write the pages back and drop them, so the swapped data no longer occupies RAM via the page cache
+  auto region_size = AlignToPage(size);
+  (void)msync(addr, region_size, MS_SYNC);
+  (void)madvise(addr, region_size, MADV_DONTNEED);
+}
+
+// Tensor data stored in a region of the swap file, the region is unmapped with the last tensor using it.
+class SwapFileTensorData : public tensor::TensorData {
+ public:
+  SwapFileTensorData(const CPUMemCopyManagerPtr &mem_copy_manager, void *addr, const tensor::TensorData &origin)
+      : mem_copy_manager_(mem_copy_manager),
+        addr_(addr),
+        size_(origin.size()),
+        itemsize_(origin.itemsize()),
+        ndim_(origin.ndim()) {}
+
+  ~SwapFileTensorData() override { mem_copy_manager_->FreeHostPinnedMem(addr_); }
+
+  ssize_t size() const override { return size_; }
+
+  ssize_t itemsize() const override { return itemsize_; }
+
+  ssize_t nbytes() const override { return size_ * itemsize_; }
+
+  ssize_t ndim() const override { return ndim_; }
+
+  void *data() override { return addr_; }
+
+  const void *const_data() const override { return addr_; }
+
+  std::string ToString(const TypeId type, const ShapeVector &shape, bool use_comma) const override {
+    // format a copy in RAM, so that the output is the same as for other tensors
+    tensor::Tensor tensor(type, shape, addr_, LongToSize(nbytes()));
+    return tensor.data().ToString(type, shape, use_comma);
+  }
+
+ private:
+  CPUMemCopyManagerPtr mem_copy_manager_;
+  void *addr_;
+  ssize_t size_;
+  ssize_t itemsize_;
+  ssize_t ndim_;
+};
+}  // namespace
+
+CPUMemCopyManager::~CPUMemCopyManager() {
+  if (running_) {
+    {
+      std::lock_guard<std::mutex> lock(task_mutex_);
+      running_ = false;
+    }
+    task_cond_.notify_all();
+    copy_thread_.join();
+  }
+  for (auto &region : mapped_regions_) {
+    (void)munmap(region.first, region.second);
+  }
+  mapped_regions_.clear();
+  if (swap_fd_ >= 0) {
+    (void)close(swap_fd_);
+    (void)unlink(swap_file_.c_str());
+    swap_fd_ = -1;
+  }
+}
+
+void CPUMemCopyManager::Init() {
+  if (running_) {
+    return;
+  }
+  std::string swap_template = swap_dir_ + "/mindspore_swap_XXXXXX";
+  std::vector<char> file_name(swap_template.begin(), swap_template.end());
+  file_name.push_back('\0');
+  swap_fd_ = mkstemp(file_name.data());
+  if (swap_fd_ < 0) {
+    MS_LOG(EXCEPTION) << "Create swap file in " << swap_dir_ << " failed, errno: " << errno;
+  }
+  swap_file_ = file_name.data();
+  running_ = true;
+  copy_thread_ = std::thread(&CPUMemCopyManager::CopyThreadLoop, this);
+  MS_LOG(INFO) << "CPU memory swap file: " << swap_file_;
+}
+
+void CPUMemCopyManager::CopyThreadLoop() {
+  while (true) {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(task_mutex_);
+      task_cond_.wait(lock, [this] { return !running_ || !copy_tasks_.empty(); });
+      if (copy_tasks_.empty()) {
+        return;
+      }
+      task = std::move(copy_tasks_.front());
+      copy_tasks_.pop();
+    }
+    task();
+  }
+}
+
+std::shared_future<void> CPUMemCopyManager::AddCopyTask(const std::function<void()> &copy_func) {
+  std::packaged_task<void()> task(copy_func);
+  auto future = task.get_future().share();
+  {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    copy_tasks_.push(std::move(task));
+  }
+  task_cond_.notify_one();
+  return future;
+}
+
+void CPUMemCopyManager::AddMemSwapOutTask(const DeviceAddressPtr &device_address, const HostAddress &host_addr) {
+  MS_EXCEPTION_IF_NULL(device_address);
+  MS_EXCEPTION_IF_NULL(host_addr.addr);
+  void *device_ptr = device_address->GetMutablePtr();
+  MS_EXCEPTION_IF_NULL(device_ptr);
+  device_address->set_status(DeviceAddressStatus::kInDeviceToHost);
+  auto future = AddCopyTask([device_ptr, host_addr]() {
+    CopyMemory(host_addr.addr, device_ptr, host_addr.size);
+    ReleasePages(host_addr.addr, host_addr.size);
+  });
+  swap_out_queue_.emplace(device_address, future);
+}
+
+void CPUMemCopyManager::AddMemSwapInTask(const DeviceAddressPtr &device_address, const HostAddress &host_addr,
+                                         bool profiling, float *cost_time) {
+  MS_EXCEPTION_IF_NULL(device_address);
+  MS_EXCEPTION_IF_NULL(host_addr.addr);
+  void *device_ptr = device_address->GetMutablePtr();
+  MS_EXCEPTION_IF_NULL(device_ptr);
+  device_address->set_status(DeviceAddressStatus::kInHostToDevice);
+  (void)madvise(host_addr.addr, AlignToPage(host_addr.size), MADV_WILLNEED);
+  auto copy_func = [device_ptr, host_addr]() { CopyMemory(device_ptr, host_addr.addr, host_addr.size); };
+  if (profiling) {
+    MS_EXCEPTION_IF_NULL(cost_time);
+    // finish the queued copies first, so that only this swap in is measured
+    (void)SyncMemCopyStream(SwapKind::kHostToDevice);
+    double start_time = GetTime();
+    copy_func();
+    *cost_time = static_cast<float>((GetTime() - start_time) * kSecondToMillisecond);
+    std::promise<void> done;
+    done.set_value();
+    swap_in_queue_.emplace(device_address, done.get_future().share());
+    return;
+  }
+  swap_in_queue_.emplace(device_address, AddCopyTask(copy_func));
+}
+
+void CPUMemCopyManager::AddMemSwapOutTaskMock(const DeviceAddressPtr &device_address) {
+  MS_EXCEPTION_IF_NULL(device_address);
+  device_address->set_status(DeviceAddressStatus::kInDeviceToHost);
+  swap_out_queue_mock_.emplace(device_address);
+}
+
+void CPUMemCopyManager::AddMemSwapInTaskMock(const DeviceAddressPtr &device_address) {
+  MS_EXCEPTION_IF_NULL(device_address);
+  device_address->set_status(DeviceAddressStatus::kInHostToDevice);
+  swap_in_queue_mock_.emplace(device_address);
+}
+
+void CPUMemCopyManager::WaitTasks(std::queue<CopyTask> *task_queue) {
+  MS_EXCEPTION_IF_NULL(task_queue);
+  // the copy thread runs the tasks in order, so waiting for the newest task covers all of them
+  if (!task_queue->empty()) {
+    task_queue->back().second.wait();
+  }
+}
+
+bool CPUMemCopyManager::SyncMemCopyStream(SwapKind swap_kind) {
+  if (swap_kind == SwapKind::kDeviceToHost) {
+    WaitTasks(&swap_out_queue_);
+  } else {
+    WaitTasks(&swap_in_queue_);
+  }
+  return true;
+}
+
+DeviceAddressPtr CPUMemCopyManager::PopFinishedTask(std::queue<CopyTask> *task_queue) {
+  MS_EXCEPTION_IF_NULL(task_queue);
+  if (task_queue->empty()) {
+    return nullptr;
+  }
+  auto &task = task_queue->front();
+  if (task.second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return nullptr;
+  }
+  // rethrow the copy failure, if any
+  task.second.get();
+  auto device_address = task.first;
+  task_queue->pop();
+  return device_address;
+}
+
+DeviceAddressPtr CPUMemCopyManager::UpdateSwapOutQueue() { return PopFinishedTask(&swap_out_queue_); }
+
+DeviceAddressPtr CPUMemCopyManager::UpdateSwapInQueue() { return PopFinishedTask(&swap_in_queue_); }
+
+DeviceAddressPtr CPUMemCopyManager::UpdateSwapOutQueueMock() {
+  if (swap_out_queue_mock_.empty()) {
+    return nullptr;
+  }
+  auto device_address = swap_out_queue_mock_.front();
+  swap_out_queue_mock_.pop();
+  return device_address;
+}
+
+DeviceAddressPtr CPUMemCopyManager::UpdateSwapInQueueMock() {
+  if (swap_in_queue_mock_.empty()) {
+    return nullptr;
+  }
+  auto device_address = swap_in_queue_mock_.front();
+  swap_in_queue_mock_.pop();
+  return device_address;
+}
+
+bool CPUMemCopyManager::AllocHostPinnedMem(size_t size, void **addr) const {
+  MS_EXCEPTION_IF_NULL(addr);
+  if (swap_fd_ < 0) {
+    MS_LOG(ERROR) << "The swap file is not created.";
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(region_mutex_);
+  auto region_size = AlignToPage(size);
+  auto offset = swap_file_size_;
+  if (ftruncate(swap_fd_, static_cast<off_t>(offset + region_size)) != 0) {
+    MS_LOG(ERROR) << "Extend swap file " << swap_file_ << " to " << offset + region_size << " failed.";
+    return false;
+  }
+  auto region = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, swap_fd_, static_cast<off_t>(offset));
+  if (region == MAP_FAILED) {
+    MS_LOG(ERROR) << "Map swap file " << swap_file_ << " at offset " << offset << " failed.";
+    return false;
+  }
+  swap_file_size_ = offset + region_size;
+  mapped_regions_[region] = region_size;
+  *addr = region;
+  return true;
+}
+
+void CPUMemCopyManager::FreeHostPinnedMem(void *addr) const {
+  std::lock_guard<std::mutex> lock(region_mutex_);
+  auto iter = mapped_regions_.find(addr);
+  if (iter == mapped_regions_.end()) {
+    return;
+  }
+  (void)munmap(iter->first, iter->second);
+  mapped_regions_.erase(iter);
+}
+
+void CPUMemCopyManager::ClearSwapQueue() {
+  (void)SyncMemCopyStream(SwapKind::kDeviceToHost);
+  (void)SyncMemCopyStream(SwapKind::kHostToDevice);
+  while (!swap_out_queue_.empty()) {
+    swap_out_queue_.pop();
+  }
+  while (!swap_in_queue_.empty()) {
+    swap_in_queue_.pop();
+  }
+}
+
+void CPUMemCopyManager::ClearSwapQueueMock() {
+  while (!swap_out_queue_mock_.empty()) {
+    swap_out_queue_mock_.pop();
+  }
+  while (!swap_in_queue_mock_.empty()) {
+    swap_in_queue_mock_.pop();
+  }
+}
+
+bool CPUMemCopyManager::IsMappedRegion(void *addr) const {
+  std::lock_guard<std::mutex> lock(region_mutex_);
+  return mapped_regions_.find(addr) != mapped_regions_.end();
+}
+
+bool CPUMemCopyManager::MoveTensorToSwapFile(const tensor::TensorPtr &tensor) {
+  MS_EXCEPTION_IF_NULL(tensor);
+  if (dynamic_cast<const SwapFileTensorData *>(&tensor->data()) != nullptr) {
+    return true;
+  }
+  auto size = LongToSize(tensor->data().nbytes());
+  void *addr = nullptr;
+  if (size == 0 || !AllocHostPinnedMem(size, &addr)) {
+    return false;
+  }
+  CopyMemory(addr, tensor->data_c(), size);
+  tensor->set_data_ptr(std::make_shared<SwapFileTensorData>(shared_from_this(), addr, tensor->data()));
+  AddRegionReleaseTask(addr, size);
+  return true;
+}
+
+void CPUMemCopyManager::PrefetchRegion(void *addr, size_t size) const {
+  // the data of a parameter may have been replaced by an assignment since it was moved to the swap file
+  if (IsMappedRegion(addr)) {
+    (void)madvise(addr, AlignToPage(size), MADV_WILLNEED);
+  }
+}
+
+void CPUMemCopyManager::AddRegionReleaseTask(void *addr, size_t size) {
+  if (IsMappedRegion(addr)) {
+    region_release_tasks_.push_back(AddCopyTask([addr, size]() { ReleasePages(addr, size); }));
+  }
+}
+
+void CPUMemCopyManager::SyncRegionReleaseTasks() {
+  for (auto &task : region_release_tasks_) {
+    // rethrow the failure, if any
+    task.get();
+  }
+  region_release_tasks_.clear();
+}
+}  // namespace cpu
+}  // namespace device
+}  // namespace mindspore
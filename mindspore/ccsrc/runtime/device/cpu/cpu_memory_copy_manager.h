@@ -0,0 +1,121 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_RUNTIME_DEVICE_CPU_CPU_MEMORY_COPY_MANAGER_H_
+#define MINDSPORE_CCSRC_RUNTIME_DEVICE_CPU_CPU_MEMORY_COPY_MANAGER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "backend/optimizer/mem_reuse/mem_copy_manager.h"
+#include "ir/tensor.h"
+#include "runtime/device/device_address.h"
+#include "backend/kernel_compiler/kernel.h"
+
+namespace mindspore {
+namespace device {
+namespace cpu {
+using mindspore::device::memswap::MemCopyManager;
+using mindspore::device::memswap::SwapKind;
+// On CPU the "device" memory is host RAM and the "host" side of a swap is a memory mapped file on local disk.
+// Copies run on a background thread so that swapping overlaps with kernel execution.
+class CPUMemCopyManager : public MemCopyManager, public std::enable_shared_from_this<CPUMemCopyManager> {
+ public:
+  explicit CPUMemCopyManager(const std::string &swap_dir) : swap_dir_(swap_dir) {}
+
+  ~CPUMemCopyManager() override;
+
+  void Init() override;
+
+  void AddMemSwapOutTask(const DeviceAddressPtr &device_address, const HostAddress &host_addr) override;
+
+  void AddMemSwapInTask(const DeviceAddressPtr &device_address, const HostAddress &host_addr, bool profiling,
+                        float *cost_time) override;
+
+  void AddMemSwapOutTaskMock(const DeviceAddressPtr &device_address) override;
+
+  void AddMemSwapInTaskMock(const DeviceAddressPtr &device_address) override;
+
+  bool SyncMemCopyStream(SwapKind swap_kind) override;
+
+  DeviceAddressPtr UpdateSwapOutQueue() override;
+
+  DeviceAddressPtr UpdateSwapInQueue() override;
+
+  DeviceAddressPtr UpdateSwapOutQueueMock() override;
+
+  DeviceAddressPtr UpdateSwapInQueueMock() override;
+
+  bool AllocHostPinnedMem(size_t size, void **addr) const override;
+
+  void FreeHostPinnedMem(void *addr) const override;
+
+  void ClearSwapQueue() override;
+
+  void ClearSwapQueueMock() override;
+
+  // Parameters moved to the swap file keep it as their storage, so they are not copied in and out by the swap
+  // queues: the kernels access the mapped pages directly, which are only advised in before and dropped after use.
+  bool MoveTensorToSwapFile(const tensor::TensorPtr &tensor);
+
+  void PrefetchRegion(void *addr, size_t size) const;
+
+  void AddRegionReleaseTask(void *addr, size_t size);
+
+  void SyncRegionReleaseTasks();
+
+ private:
+  using CopyTask = std::pair<DeviceAddressPtr, std::shared_future<void>>;
+  std::shared_future<void> AddCopyTask(const std::function<void()> &copy_func);
+  void CopyThreadLoop();
+  static DeviceAddressPtr PopFinishedTask(std::queue<CopyTask> *task_queue);
+  static void WaitTasks(std::queue<CopyTask> *task_queue);
+  bool IsMappedRegion(void *addr) const;
+
+  std::string swap_dir_;
+  std::string swap_file_;
+  int swap_fd_{-1};
+  // the swap file grows with every host address handed out, regions are never reused within one file
+  mutable size_t swap_file_size_{0};
+  mutable std::map<void *, size_t> mapped_regions_;
+  mutable std::mutex region_mutex_;
+
+  std::thread copy_thread_;
+  std::mutex task_mutex_;
+  std::condition_variable task_cond_;
+  std::queue<std::packaged_task<void()>> copy_tasks_;
+  bool running_{false};
+
+  std::queue<CopyTask> swap_out_queue_;
+  std::queue<CopyTask> swap_in_queue_;
+  std::queue<DeviceAddressPtr> swap_out_queue_mock_;
+  std::queue<DeviceAddressPtr> swap_in_queue_mock_;
+  std::vector<std::shared_future<void>> region_release_tasks_;
+};
+using CPUMemCopyManagerPtr = std::shared_ptr<CPUMemCopyManager>;
+}  // namespace cpu
+}  // namespace device
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_RUNTIME_DEVICE_CPU_CPU_MEMORY_COPY_MANAGER_H_
@@ -35,6 +35,10 @@ void CPUResourceManager::MemFree() {
 }
 
 void CPUResourceManager::AssignMemory(const session::KernelGraph *graph) {
+  if (force_dynamic_malloc_) {
+    dynamic_malloc_ = true;
+    return;
+  }
   size_t graph_mem_size = mem_plan_.MemPlan(graph);
   if (graph_mem_size > mem_size_) {
     if (mem_size_ > 0) {
@@ -37,6 +37,8 @@ class CPUResourceManager {
   void MemFree(void *ptr);
   void IncreaseSummaryRefCount(const session::NamedSummaryOutputs &summary_outputs);
   void DecreaseSummaryRefCount(const session::NamedSummaryOutputs &summary_outputs);
+  // force memory to be allocated on first use and released with the reference count instead of one static block
+  void set_dynamic_malloc(bool dynamic_malloc) { force_dynamic_malloc_ = dynamic_malloc; }
 
  private:
   void MemFree();
@@ -45,6 +47,7 @@ class CPUResourceManager {
   size_t mem_size_{0};
   uint8_t *mem_ptr_{nullptr};
   bool dynamic_malloc_{false};
+  bool force_dynamic_malloc_{false};
   std::map<void *, size_t> dynamic_mem_;
 };
 }  // namespace cpu
@@ -92,6 +92,9 @@ constexpr auto kMomentumOpName = "Momentum";
 constexpr auto kApplyMomentumOpName = "ApplyMomentum";
 constexpr auto kCombineMomentumOpName = "CombineMomentum";
 constexpr auto kCombineMomentumWeightOpName = "CombineMomentumWeight";
+constexpr auto kMultiTensorApplyMomentumOpName = "MultiTensorApplyMomentum";
+constexpr auto kMultiTensorAdamOpName = "MultiTensorAdam";
+constexpr auto kMultiTensorApplyRMSPropOpName = "MultiTensorApplyRMSProp";
 constexpr auto kApplyAdadeltaOpName = "ApplyAdadelta";
 constexpr auto kApplyAdagradOpName = "ApplyAdagrad";
 constexpr auto kApplyAdagradDAName = "ApplyAdagradDA";
@@ -470,6 +473,9 @@ const std::set<std::string> kOptOperatorSet = {kMomentumOpName,
                                                kPullOpName,
                                                kCombineMomentumWeightOpName,
                                                kCombineMomentumOpName,
+                                               kMultiTensorApplyMomentumOpName,
+                                               kMultiTensorAdamOpName,
+                                               kMultiTensorApplyRMSPropOpName,
                                                kSparseApplyProximalAdagradOpName};
 
 const std::set<std::string> kHWSpecialFormatSet = {
@@ -262,6 +262,11 @@ class Tensor : public MetaTensor {
   // return The reference to internal data object.
   const TensorDataPtr &data_ptr() const { return data_; }
 
+  // brief Replace the internal data object, e.g. to move the data to another storage.
+  //
+  // param data The new data object, it should hold the same elements as the current one.
+  void set_data_ptr(const TensorDataPtr &data) { data_ = data; }
+
   // brief Get the internal data object.
   //
   // return The reference to internal data object.
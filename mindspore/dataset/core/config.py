@@ -23,7 +23,8 @@ import mindspore._c_dataengine as cde
 
 __all__ = ['set_seed', 'get_seed', 'set_prefetch_size', 'get_prefetch_size', 'set_num_parallel_workers',
            'get_num_parallel_workers', 'set_monitor_sampling_interval', 'get_monitor_sampling_interval', 'load',
-           'get_callback_timeout', 'set_auto_num_workers', 'get_auto_num_workers']
+           'get_callback_timeout', 'set_auto_num_workers', 'get_auto_num_workers',
+           'set_numa_aware', 'get_numa_aware']
 
 INT32_MAX = 2147483647
 UINT32_MAX = 4294967295
@@ -246,6 +247,43 @@ def get_auto_num_workers():
     return _config.get_auto_num_workers()
 
 
+def set_numa_aware(enable):
+    """
+    Set whether the dataset pipeline is numa aware. (This feature is turned off by default)
+    When it is on, the workers of each op are spread over the numa nodes of the machine and every worker
+    allocates the tensors it produces from the memory of its own node. The workers of consecutive ops are not
+    paired up by node, so a row may still be read from another node by the next op. It has no effect on a
+    machine with a single numa node.
+
+    Args:
+        enable (bool): Whether to make the pipeline numa aware.
+
+    Raises:
+        ValueError: If enable is not of boolean type.
+
+    Examples:
+        >>> import mindspore.dataset as ds
+        >>>
+        >>> # Pin the workers to the numa nodes
+        >>> ds.config.set_numa_aware(True)
+    """
+    if not isinstance(enable, bool):
+        raise ValueError("enable isn't of type bool.")
+    _config.set_numa_aware(enable)
+
+
+def get_numa_aware():
+    """
+    Get whether the dataset pipeline is numa aware.
+
+    Returns:
+        Bool, whether the numa aware feature is turned on
+    Examples:
+        >>> ds.config.get_numa_aware()
+    """
+    return _config.get_numa_aware()
+
+
 def set_callback_timeout(timeout):
     """
     Set the default timeout (in seconds) for DSWaitedCallback.
@@ -0,0 +1,97 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_INCLUDE_BATCH_SERVER_H
+#define MINDSPORE_LITE_INCLUDE_BATCH_SERVER_H
+
+#include <vector>
+#include <string>
+#include "include/ms_tensor.h"
+#include "include/context.h"
+
+namespace mindspore {
+namespace session {
+/// \brief BatchServerOptions defined for holding the batching strategy of a BatchServer.
+struct BatchServerOptions {
+  int max_batch_size_ = 8; /**< largest number of requests run together in one RunGraph */
+  int max_wait_us_ = 1000; /**< longest time in microseconds the first request of a batch waits for others */
+  /// \brief Batch sizes the model is resized to ahead of time. A batch is padded up to the smallest bucket that
+  /// holds it. max_batch_size_ is always a bucket. Empty means the powers of 2 up to max_batch_size_.
+  std::vector<int> buckets_;
+};
+
+/// \brief BatchServerStat defined for holding the counters of a BatchServer.
+///
+/// \note Bin i of a histogram counts the times in [2^i, 2^(i+1)) microseconds, bin 0 also counts 0.
+struct BatchServerStat {
+  size_t requests_ = 0;                 /**< number of requests served */
+  size_t batches_ = 0;                  /**< number of RunGraph calls */
+  std::vector<size_t> batch_size_hist_; /**< number of batches of each size, indexed by the batch size */
+  std::vector<size_t> queue_us_hist_;   /**< time from Predict to the start of its batch */
+  std::vector<size_t> latency_us_hist_; /**< time from Predict to its outputs being written */
+};
+
+/// \brief BatchServer defined for coalescing concurrent single-sample requests into batched RunGraph calls.
+///
+/// \note Every graph input and output must carry the batch in its first dimension.
+class MS_API BatchServer {
+ public:
+  /// \brief Static method to create a BatchServer pointer.
+  ///
+  /// \param[in] model_buf Define the buffer read from a model file.
+  /// \param[in] size Define bytes number of model buffer.
+  /// \param[in] context Define the context of the sessions running the batches.
+  /// \param[in] options Define the batching strategy.
+  ///
+  /// \return Pointer of MindSpore Lite BatchServer.
+  static BatchServer *CreateServer(const char *model_buf, size_t size, const lite::Context *context,
+                                   const BatchServerOptions &options);
+
+  /// \brief Destructor of MindSpore Lite BatchServer. Requests still queued are run before it returns.
+  virtual ~BatchServer() = default;
+
+  /// \brief Get bytes number of one sample of each graph input.
+  ///
+  /// \return The vector of sizes in the order of LiteSession::GetInputs.
+  virtual std::vector<size_t> GetInputSizes() const = 0;
+
+  /// \brief Get bytes number of one sample of each graph output.
+  ///
+  /// \return The vector of sizes in the order of GetOutputTensorNames.
+  virtual std::vector<size_t> GetOutputSizes() const = 0;
+
+  /// \brief Get name of output tensors of the model.
+  ///
+  /// \return The vector of string as output tensor names in order.
+  virtual std::vector<std::string> GetOutputTensorNames() const = 0;
+
+  /// \brief Run one sample. It can be called from many threads at the same time and blocks until the batch holding
+  /// the sample has run.
+  ///
+  /// \param[in] inputs Define the data of each graph input, GetInputSizes bytes each.
+  /// \param[out] outputs Define the buffers receiving each graph output, GetOutputSizes bytes each.
+  ///
+  /// \return STATUS as an error code of running the sample, STATUS is defined in errorcode.h.
+  virtual int Predict(const std::vector<const void *> &inputs, const std::vector<void *> &outputs) = 0;
+
+  /// \brief Get the counters collected since the server was created.
+  ///
+  /// \return The counters and histograms of the server.
+  virtual BatchServerStat GetStat() const = 0;
+};
+}  // namespace session
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_INCLUDE_BATCH_SERVER_H
@@ -70,6 +70,13 @@ struct DeviceContext {
 struct Context {
   std::string vendor_name_;
   int thread_num_ = 2; /**< thread number config for thread pool */
+  int resize_cache_size_ = 0; /**< number of input shapes whose kernels are kept by Resize, 0 resizes in place */
+  /// \brief File keeping the fastest kernel choices of the tuned ops, e.g. the convolution algorithm. Ops without a
+  /// choice in it are timed when their kernels are created and the file is updated. Empty disables the tuning.
+  std::string tuning_file_;
+  /// \brief Recurrent kernels, e.g. LSTM, keep their states between RunGraph calls and read their state inputs only on
+  /// the first call after LiteSession::ResetStates, so a stream can be fed a chunk of frames at a time.
+  bool keep_rnn_states_ = false;
   AllocatorPtr allocator = nullptr;
   DeviceContextVector device_list_ = {{DT_CPU, {false, MID_CPU}}};
 };
@@ -24,6 +24,7 @@
 #include "include/ms_tensor.h"
 #include "include/model.h"
 #include "include/context.h"
+#include "include/errorcode.h"
 
 namespace mindspore {
 namespace session {
@@ -118,6 +119,13 @@ class MS_API LiteSession {
   ///
   /// \return STATUS as an error code of resize inputs, STATUS is defined in errorcode.h.
   virtual int Resize(const std::vector<tensor::MSTensor *> &inputs, const std::vector<std::vector<int>> &dims) = 0;
+
+  /// \brief Drop the states recurrent kernels keep between RunGraph calls when Context::keep_rnn_states_ is set, the
+  /// next RunGraph reads the state inputs again. Call it before a new stream.
+  ///
+  /// \return STATUS as an error code of resetting the states, STATUS is defined in errorcode.h. Sessions keeping no
+  /// states return RET_NOT_SUPPORT.
+  virtual int ResetStates() { return lite::RET_NOT_SUPPORT; }
 };
 }  // namespace session
 }  // namespace mindspore
@@ -0,0 +1,48 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_NNACL_ATTENTION_PARAMETER_H_
+#define MINDSPORE_LITE_NNACL_ATTENTION_PARAMETER_H_
+
+#include "nnacl/op_base.h"
+#include "nnacl/quantization/quantize.h"
+
+// query rows and key columns handled by one tile of the score matrix
+#define ATTENTION_ROW_BLOCK 8
+#define ATTENTION_COL_BLOCK 64
+
+typedef struct AttentionParameter {
+  // Primitive parameter
+  OpParameter op_parameter_;
+  float scale_;
+  bool transpose_b_;
+  // shape correlative
+  int batch_;
+  int q_len_;
+  int kv_len_;
+  int head_dim_;
+  int v_head_dim_;
+  int mask_row_stride_;
+} AttentionParameter;
+
+typedef struct AttentionQuantArg {
+  QuantArg q_;
+  QuantArg k_;
+  QuantArg v_;
+  QuantArg mask_;
+  QuantArg out_;
+} AttentionQuantArg;
+
+#endif  // MINDSPORE_LITE_NNACL_ATTENTION_PARAMETER_H_
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "nnacl/fp16/attention_fp16.h"
+#include <math.h>
+#include <string.h>
+#include "nnacl/errorcode.h"
+#include "nnacl/fp32/attention_fp32.h"
+
+static float AttentionDotFp16(const float16_t *a, const float16_t *b, int len) {
+  int index = 0;
+  float res = 0.0f;
+#ifdef ENABLE_NEON
+  float32x4_t sum = vdupq_n_f32(0);
+  for (; index <= len - C4NUM; index += C4NUM) {
+    sum = vmlaq_f32(sum, vcvt_f32_f16(vld1_f16(a + index)), vcvt_f32_f16(vld1_f16(b + index)));
+  }
+  res = sum[0] + sum[1] + sum[2] + sum[3];
+#endif
+  for (; index < len; index++) {
+    res += (float)a[index] * (float)b[index];
+  }
+  return res;
+}
+
+// dst += alpha * src
+static void AttentionAxpyFp16(float alpha, const float16_t *src, float *dst, int len) {
+  int index = 0;
+#ifdef ENABLE_NEON
+  for (; index <= len - C4NUM; index += C4NUM) {
+    vst1q_f32(dst + index, vmlaq_n_f32(vld1q_f32(dst + index), vcvt_f32_f16(vld1_f16(src + index)), alpha));
+  }
+#endif
+  for (; index < len; index++) {
+    dst[index] += alpha * (float)src[index];
+  }
+}
+
+int AttentionFp16(const float16_t *q, const float16_t *k, const float16_t *v, const float16_t *mask, float16_t *out,
+                  float *buffer, int row_start, int row_end, const AttentionParameter *param) {
+  if (q == NULL || k == NULL || v == NULL || out == NULL || buffer == NULL) {
+    return NNACL_NULL_PTR;
+  }
+  int head_dim = param->head_dim_;
+  int v_dim = param->v_head_dim_;
+  int kv_len = param->kv_len_;
+  float *score = buffer;
+  float *acc = score + ATTENTION_ROW_BLOCK * ATTENTION_COL_BLOCK;
+  float *row_max = acc + ATTENTION_ROW_BLOCK * v_dim;
+  float *row_sum = row_max + ATTENTION_ROW_BLOCK;
+
+  for (int r = row_start; r < row_end; r += ATTENTION_ROW_BLOCK) {
+    int rows = MSMIN(ATTENTION_ROW_BLOCK, row_end - r);
+    const float16_t *q_block = q + r * head_dim;
+    memset(acc, 0, rows * v_dim * sizeof(float));
+    for (int i = 0; i < rows; i++) {
+      row_max[i] = -INFINITY;
+      row_sum[i] = 0.0f;
+    }
+    for (int c = 0; c < kv_len; c += ATTENTION_COL_BLOCK) {
+      int cols = MSMIN(ATTENTION_COL_BLOCK, kv_len - c);
+      if (param->transpose_b_) {
+        for (int j = 0; j < cols; j++) {
+          const float16_t *k_row = k + (c + j) * head_dim;
+          for (int i = 0; i < rows; i++) {
+            score[i * cols + j] = AttentionDotFp16(q_block + i * head_dim, k_row, head_dim);
+          }
+        }
+      } else {
+        memset(score, 0, rows * cols * sizeof(float));
+        for (int i = 0; i < rows; i++) {
+          for (int d = 0; d < head_dim; d++) {
+            AttentionAxpyFp16((float)q_block[i * head_dim + d], k + d * kv_len + c, score + i * cols, cols);
+          }
+        }
+      }
+      AttentionScaleMask(score, NULL, rows, cols, 0, param->scale_);
+      if (mask != NULL) {
+        for (int i = 0; i < rows; i++) {
+          const float16_t *mask_row = mask + (r + i) * param->mask_row_stride_ + c;
+          for (int j = 0; j < cols; j++) {
+            score[i * cols + j] += (float)mask_row[j];
+          }
+        }
+      }
+      AttentionSoftmaxUpdate(score, rows, cols, row_max, row_sum, acc, v_dim);
+      for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+          float prob = score[i * cols + j];
+          if (prob != 0.0f) {
+            AttentionAxpyFp16(prob, v + (c + j) * v_dim, acc + i * v_dim, v_dim);
+          }
+        }
+      }
+    }
+    for (int i = 0; i < rows; i++) {
+      float inv_sum = row_sum[i] > 0.0f ? 1.0f / row_sum[i] : 0.0f;
+      float16_t *dst = out + (r + i) * v_dim;
+      for (int j = 0; j < v_dim; j++) {
+        dst[j] = (float16_t)(acc[i * v_dim + j] * inv_sum);
+      }
+    }
+  }
+  return NNACL_OK;
+}
@@ -0,0 +1,34 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_NNACL_FP16_ATTENTION_FP16_H_
+#define MINDSPORE_LITE_NNACL_FP16_ATTENTION_FP16_H_
+
+#include "nnacl/op_base.h"
+#include "nnacl/attention_parameter.h"
+#ifdef ENABLE_NEON
+#include <arm_neon.h>
+#endif
+#ifdef __cplusplus
+extern "C" {
+#endif
+// same tiling as AttentionFp32, the score tile, softmax statistics and accumulated rows in buffer stay in fp32
+int AttentionFp16(const float16_t *q, const float16_t *k, const float16_t *v, const float16_t *mask, float16_t *out,
+                  float *buffer, int row_start, int row_end, const AttentionParameter *param);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_LITE_NNACL_FP16_ATTENTION_FP16_H_
@@ -0,0 +1,162 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "nnacl/fp32/attention_fp32.h"
+#include <math.h>
+#include <string.h>
+#include "nnacl/errorcode.h"
+
+int AttentionBufferSize(const AttentionParameter *param) {
+  return ATTENTION_ROW_BLOCK * (ATTENTION_COL_BLOCK + param->v_head_dim_ + 2);
+}
+
+static float AttentionDot(const float *a, const float *b, int len) {
+  int index = 0;
+  float res = 0.0f;
+#if defined(ENABLE_ARM) || defined(ENABLE_SSE)
+  MS_FLOAT32X4 sum = MS_MOVQ_F32(0.0f);
+  for (; index <= len - C4NUM; index += C4NUM) {
+    sum = MS_MLAQ_F32(sum, MS_LDQ_F32(a + index), MS_LDQ_F32(b + index));
+  }
+  float tmp[C4NUM];
+  MS_STQ_F32(tmp, sum);
+  res = tmp[0] + tmp[1] + tmp[2] + tmp[3];
+#endif
+  for (; index < len; index++) {
+    res += a[index] * b[index];
+  }
+  return res;
+}
+
+// dst += alpha * src
+static void AttentionAxpy(float alpha, const float *src, float *dst, int len) {
+  int index = 0;
+#if defined(ENABLE_ARM) || defined(ENABLE_SSE)
+  for (; index <= len - C4NUM; index += C4NUM) {
+    MS_STQ_F32(dst + index, MS_ADDQ_F32(MS_LDQ_F32(dst + index), MS_MULQ_F32(MS_LDQ_F32(src + index), alpha)));
+  }
+#endif
+  for (; index < len; index++) {
+    dst[index] += alpha * src[index];
+  }
+}
+
+void AttentionScaleMask(float *score, const float *mask, int rows, int cols, int mask_row_stride, float scale) {
+  for (int i = 0; i < rows; i++) {
+    float *dst = score + i * cols;
+    if (mask == NULL) {
+      for (int j = 0; j < cols; j++) {
+        dst[j] *= scale;
+      }
+      continue;
+    }
+    const float *mask_row = mask + i * mask_row_stride;
+    for (int j = 0; j < cols; j++) {
+      dst[j] = dst[j] * scale + mask_row[j];
+    }
+  }
+}
+
+void AttentionSoftmaxUpdate(float *score, int rows, int cols, float *row_max, float *row_sum, float *acc,
+                            int acc_cols) {
+  for (int i = 0; i < rows; i++) {
+    float *src = score + i * cols;
+    float new_max = row_max[i];
+    for (int j = 0; j < cols; j++) {
+      new_max = MSMAX(new_max, src[j]);
+    }
+    if (new_max == -INFINITY) {
+      // every key seen so far is masked out
+      memset(src, 0, cols * sizeof(float));
+      continue;
+    }
+    if (new_max != row_max[i]) {
+      float correction = expf(row_max[i] - new_max);
+      row_sum[i] *= correction;
+      float *acc_row = acc + i * acc_cols;
+      for (int j = 0; j < acc_cols; j++) {
+        acc_row[j] *= correction;
+      }
+      row_max[i] = new_max;
+    }
+    float sum = 0.0f;
+    for (int j = 0; j < cols; j++) {
+      src[j] = expf(src[j] - new_max);
+      sum += src[j];
+    }
+    row_sum[i] += sum;
+  }
+}
+
+int AttentionFp32(const float *q, const float *k, const float *v, const float *mask, float *out, float *buffer,
+                  int row_start, int row_end, const AttentionParameter *param) {
+  if (q == NULL || k == NULL || v == NULL || out == NULL || buffer == NULL) {
+    return NNACL_NULL_PTR;
+  }
+  int head_dim = param->head_dim_;
+  int v_dim = param->v_head_dim_;
+  int kv_len = param->kv_len_;
+  float *score = buffer;
+  float *acc = score + ATTENTION_ROW_BLOCK * ATTENTION_COL_BLOCK;
+  float *row_max = acc + ATTENTION_ROW_BLOCK * v_dim;
+  float *row_sum = row_max + ATTENTION_ROW_BLOCK;
+
+  for (int r = row_start; r < row_end; r += ATTENTION_ROW_BLOCK) {
+    int rows = MSMIN(ATTENTION_ROW_BLOCK, row_end - r);
+    const float *q_block = q + r * head_dim;
+    memset(acc, 0, rows * v_dim * sizeof(float));
+    for (int i = 0; i < rows; i++) {
+      row_max[i] = -INFINITY;
+      row_sum[i] = 0.0f;
+    }
+    for (int c = 0; c < kv_len; c += ATTENTION_COL_BLOCK) {
+      int cols = MSMIN(ATTENTION_COL_BLOCK, kv_len - c);
+      if (param->transpose_b_) {
+        for (int j = 0; j < cols; j++) {
+          const float *k_row = k + (c + j) * head_dim;
+          for (int i = 0; i < rows; i++) {
+            score[i * cols + j] = AttentionDot(q_block + i * head_dim, k_row, head_dim);
+          }
+        }
+      } else {
+        memset(score, 0, rows * cols * sizeof(float));
+        for (int i = 0; i < rows; i++) {
+          for (int d = 0; d < head_dim; d++) {
+            AttentionAxpy(q_block[i * head_dim + d], k + d * kv_len + c, score + i * cols, cols);
+          }
+        }
+      }
+      const float *mask_block = mask == NULL ? NULL : mask + r * param->mask_row_stride_ + c;
+      AttentionScaleMask(score, mask_block, rows, cols, param->mask_row_stride_, param->scale_);
+      AttentionSoftmaxUpdate(score, rows, cols, row_max, row_sum, acc, v_dim);
+      for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+          float prob = score[i * cols + j];
+          if (prob != 0.0f) {
+            AttentionAxpy(prob, v + (c + j) * v_dim, acc + i * v_dim, v_dim);
+          }
+        }
+      }
+    }
+    for (int i = 0; i < rows; i++) {
+      float inv_sum = row_sum[i] > 0.0f ? 1.0f / row_sum[i] : 0.0f;
+      float *dst = out + (r + i) * v_dim;
+      for (int j = 0; j < v_dim; j++) {
+        dst[j] = acc[i * v_dim + j] * inv_sum;
+      }
+    }
+  }
+  return NNACL_OK;
+}
@@ -0,0 +1,47 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_NNACL_FP32_ATTENTION_H_
+#define MINDSPORE_LITE_NNACL_FP32_ATTENTION_H_
+
+#include "nnacl/op_base.h"
+#include "nnacl/attention_parameter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Attention is computed one ATTENTION_ROW_BLOCK x ATTENTION_COL_BLOCK tile of the score matrix at a time with an
+ * online softmax: each query row keeps its running max and exp sum, and the accumulated output row is rescaled
+ * whenever the max grows. The buffer of a thread holds one score tile, the accumulated rows and their statistics.
+ */
+int AttentionBufferSize(const AttentionParameter *param);
+
+// score = score * scale + mask, mask is NULL when there is none
+void AttentionScaleMask(float *score, const float *mask, int rows, int cols, int mask_row_stride, float scale);
+
+// turns a scaled score tile into exp(score - row_max) and rescales row_sum and acc to the new row_max
+void AttentionSoftmaxUpdate(float *score, int rows, int cols, float *row_max, float *row_sum, float *acc, int acc_cols);
+
+/*
+ * q, k, v, mask and out point to one batch of their tensors, the rows [row_start, row_end) of out are computed.
+ */
+int AttentionFp32(const float *q, const float *k, const float *v, const float *mask, float *out, float *buffer,
+                  int row_start, int row_end, const AttentionParameter *param);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_LITE_NNACL_FP32_ATTENTION_H_
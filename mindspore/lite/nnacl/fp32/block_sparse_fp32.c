@@ -0,0 +1,216 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nnacl/fp32/block_sparse_fp32.h"
+#include <string.h>
+
+static inline float BlockSparseAt(const float *src, int col, int deep, bool deep_major, int c, int d) {
+  return deep_major ? src[d * col + c] : src[c * deep + d];
+}
+
+static bool BlockSparseNonzero(const float *src, int col, int deep, bool deep_major, int c_start, int c_end,
+                               int d_start, int d_end) {
+  for (int c = c_start; c < c_end; c++) {
+    for (int d = d_start; d < d_end; d++) {
+      if (BlockSparseAt(src, col, deep, deep_major, c, d) != 0.0f) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+int BlockSparseCount(const float *src, int col, int deep, int block_rows, int block_cols, bool deep_major) {
+  int count = 0;
+  for (int c = 0; c < col; c += block_rows) {
+    for (int d = 0; d < deep; d += block_cols) {
+      if (BlockSparseNonzero(src, col, deep, deep_major, c, MSMIN(c + block_rows, col), d,
+                             MSMIN(d + block_cols, deep))) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+void BlockSparseEncode(const float *src, bool deep_major, BlockSparseMatrix *matrix) {
+  int col = matrix->col_;
+  int deep = matrix->deep_;
+  int block_rows = matrix->block_rows_;
+  int block_cols = matrix->block_cols_;
+  int block_size = block_rows * block_cols;
+  int num = 0;
+  matrix->block_offsets_[0] = 0;
+  for (int br = 0; br < UP_DIV(col, block_rows); br++) {
+    int c_start = br * block_rows;
+    int c_end = MSMIN(c_start + block_rows, col);
+    for (int bc = 0; bc < UP_DIV(deep, block_cols); bc++) {
+      int d_start = bc * block_cols;
+      int d_end = MSMIN(d_start + block_cols, deep);
+      if (!BlockSparseNonzero(src, col, deep, deep_major, c_start, c_end, d_start, d_end)) {
+        continue;
+      }
+      float *value = matrix->value_ + num * block_size;
+      memset(value, 0, block_size * sizeof(float));
+      for (int c = c_start; c < c_end; c++) {
+        for (int d = d_start; d < d_end; d++) {
+          value[(c - c_start) * block_cols + d - d_start] = BlockSparseAt(src, col, deep, deep_major, c, d);
+        }
+      }
+      matrix->block_index_[num++] = bc;
+    }
+    matrix->block_offsets_[br + 1] = num;
+  }
+  matrix->block_num_ = num;
+}
+
+void BlockSparseDecode(const BlockSparseMatrix *matrix, bool deep_major, float *dst) {
+  int col = matrix->col_;
+  int deep = matrix->deep_;
+  int block_rows = matrix->block_rows_;
+  int block_cols = matrix->block_cols_;
+  memset(dst, 0, col * deep * sizeof(float));
+  for (int br = 0; br < UP_DIV(col, block_rows); br++) {
+    int c_start = br * block_rows;
+    int c_end = MSMIN(c_start + block_rows, col);
+    for (int j = matrix->block_offsets_[br]; j < matrix->block_offsets_[br + 1]; j++) {
+      int d_start = matrix->block_index_[j] * block_cols;
+      int d_end = MSMIN(d_start + block_cols, deep);
+      const float *value = matrix->value_ + j * block_rows * block_cols;
+      for (int c = c_start; c < c_end; c++) {
+        for (int d = d_start; d < d_end; d++) {
+          float v = value[(c - c_start) * block_cols + d - d_start];
+          if (deep_major) {
+            dst[d * col + c] = v;
+          } else {
+            dst[c * deep + d] = v;
+          }
+        }
+      }
+    }
+  }
+}
+
+// acc[i] += the dot products of a_row with the rows of the blocks of block row br, for blocks of any size.
+static void BlockRowDot(const float *a_row, const BlockSparseMatrix *b, int br, float *acc) {
+  int block_rows = b->block_rows_;
+  int block_cols = b->block_cols_;
+  for (int j = b->block_offsets_[br]; j < b->block_offsets_[br + 1]; j++) {
+    int d_start = b->block_index_[j] * block_cols;
+    int d_num = MSMIN(block_cols, b->deep_ - d_start);
+    const float *a = a_row + d_start;
+    const float *value = b->value_ + j * block_rows * block_cols;
+    for (int i = 0; i < block_rows; i++) {
+      for (int d = 0; d < d_num; d++) {
+        acc[i] += a[d] * value[i * block_cols + d];
+      }
+    }
+  }
+}
+
+#if defined(ENABLE_ARM) || defined(ENABLE_SSE)
+// BlockRowDot for blocks of C4NUM columns and at most C4NUM rows, the last block column may overrun deep.
+static void BlockRowDotC4(const float *a_row, const BlockSparseMatrix *b, int br, float *acc) {
+  int block_rows = b->block_rows_;
+  int block_size = block_rows * C4NUM;
+  int start = b->block_offsets_[br];
+  int end = b->block_offsets_[br + 1];
+  if (end > start && b->block_index_[end - 1] * C4NUM + C4NUM > b->deep_) {
+    // only the last block column is partial
+    end--;
+    BlockSparseMatrix tail = *b;
+    int offsets[2] = {end, end + 1};
+    tail.block_offsets_ = offsets;
+    BlockRowDot(a_row, &tail, 0, acc);
+  }
+  const int *index = b->block_index_;
+  const float *value = b->value_;
+#ifdef ENABLE_AVX
+  if (block_rows == C4NUM) {
+    __m256 sum01 = _mm256_setzero_ps();
+    __m256 sum23 = _mm256_setzero_ps();
+    for (int j = start; j < end; j++) {
+      __m256 a8 = _mm256_broadcast_ps((const __m128 *)(a_row + index[j] * C4NUM));
+      const float *v = value + j * block_size;
+      sum01 = _mm256_add_ps(sum01, _mm256_mul_ps(a8, _mm256_loadu_ps(v)));
+      sum23 = _mm256_add_ps(sum23, _mm256_mul_ps(a8, _mm256_loadu_ps(v + C8NUM)));
+    }
+    float sum[C16NUM];
+    _mm256_storeu_ps(sum, sum01);
+    _mm256_storeu_ps(sum + C8NUM, sum23);
+    for (int i = 0; i < C4NUM; i++) {
+      acc[i] += sum[i * C4NUM] + sum[i * C4NUM + 1] + sum[i * C4NUM + 2] + sum[i * C4NUM + 3];
+    }
+    return;
+  }
+#endif
+  MS_FLOAT32X4 sum[C4NUM];
+  for (int i = 0; i < block_rows; i++) {
+    sum[i] = MS_MOVQ_F32(0.0f);
+  }
+  for (int j = start; j < end; j++) {
+    MS_FLOAT32X4 a4 = MS_LDQ_F32(a_row + index[j] * C4NUM);
+    const float *v = value + j * block_size;
+    for (int i = 0; i < block_rows; i++) {
+      sum[i] = MS_MLAQ_F32(sum[i], a4, MS_LDQ_F32(v + i * C4NUM));
+    }
+  }
+  for (int i = 0; i < block_rows; i++) {
+    float tmp[C4NUM];
+    MS_STQ_F32(tmp, sum[i]);
+    acc[i] += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+  }
+}
+#endif
+
+void MatMulBlockSparse(const float *a, const BlockSparseMatrix *b, const float *bias, float *c, ActType act_type,
+                       int row, int block_row_start, int block_row_end) {
+  int block_rows = b->block_rows_;
+#if defined(ENABLE_ARM) || defined(ENABLE_SSE)
+  bool use_c4 = b->block_cols_ == C4NUM && block_rows <= C4NUM;
+#endif
+  float acc[BLOCK_SPARSE_MAX_ROWS];
+  for (int r = 0; r < row; r++) {
+    const float *a_row = a + r * b->deep_;
+    float *c_row = c + r * b->col_;
+    for (int br = block_row_start; br < block_row_end; br++) {
+      int c_start = br * block_rows;
+      int c_num = MSMIN(block_rows, b->col_ - c_start);
+      for (int i = 0; i < block_rows; i++) {
+        acc[i] = (bias != NULL && i < c_num) ? bias[c_start + i] : 0.0f;
+      }
+#if defined(ENABLE_ARM) || defined(ENABLE_SSE)
+      if (use_c4) {
+        BlockRowDotC4(a_row, b, br, acc);
+      } else {
+        BlockRowDot(a_row, b, br, acc);
+      }
+#else
+      BlockRowDot(a_row, b, br, acc);
+#endif
+      for (int i = 0; i < c_num; i++) {
+        float v = acc[i];
+        if (act_type == ActType_Relu || act_type == ActType_Relu6) {
+          v = MSMAX(0.0f, v);
+        }
+        if (act_type == ActType_Relu6) {
+          v = MSMIN(6.0f, v);
+        }
+        c_row[c_start + i] = v;
+      }
+    }
+  }
+}
@@ -0,0 +1,62 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_NNACL_FP32_BLOCK_SPARSE_H_
+#define MINDSPORE_LITE_NNACL_FP32_BLOCK_SPARSE_H_
+
+#include "nnacl/op_base.h"
+
+#define BLOCK_SPARSE_MAX_ROWS 8
+
+/*
+ * A weight seen as a [col][deep] matrix and cut into block_rows_ x block_cols_ blocks, of which only the blocks
+ * holding a nonzero are kept (BSR). The blocks of block row i are block_offsets_[i] .. block_offsets_[i + 1] - 1, each
+ * with its block column in block_index_ and its values row major in value_. The blocks of the last block row and
+ * column are padded with zeros. Blocks have at most BLOCK_SPARSE_MAX_ROWS rows.
+ */
+typedef struct BlockSparseMatrix {
+  int col_;
+  int deep_;
+  int block_rows_;
+  int block_cols_;
+  int block_num_;
+  int *block_offsets_;
+  int *block_index_;
+  float *value_;
+} BlockSparseMatrix;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Number of the blocks of src holding a nonzero, src is [col][deep], or [deep][col] if deep_major is set.
+int BlockSparseCount(const float *src, int col, int deep, int block_rows, int block_cols, bool deep_major);
+
+// Fill a matrix whose col_, deep_, block sizes and buffers are set, block_num_ is set to the number of blocks written.
+void BlockSparseEncode(const float *src, bool deep_major, BlockSparseMatrix *matrix);
+
+// Write the plain [col][deep] or [deep][col] data of a matrix to dst.
+void BlockSparseDecode(const BlockSparseMatrix *matrix, bool deep_major, float *dst);
+
+/*
+ * c = act(a * b^T + bias) for the output channels of the block rows [block_row_start, block_row_end). a is row major
+ * [row][deep] and c is [row][col], bias is NULL when there is none.
+ */
+void MatMulBlockSparse(const float *a, const BlockSparseMatrix *b, const float *bias, float *c, ActType act_type,
+                       int row, int block_row_start, int block_row_end);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_LITE_NNACL_FP32_BLOCK_SPARSE_H_
@@ -19,50 +19,6 @@
 #include "nnacl/fp32/activation_fp32.h"
 #include "nnacl/fp32/arithmetic_fp32.h"
 
-void InitGate(float *gate_buffer, const float *bias, const LstmParameter *lstm_parm) {
-  int gate_offest = 0;
-  for (int l = 0; l < 4; l++) {
-    int batch_offest = gate_offest;
-    int bias_offest = l * lstm_parm->hidden_size_;
-    for (int b = 0; b < lstm_parm->batch_; b++) {
-      memcpy(gate_buffer + batch_offest, bias + bias_offest, lstm_parm->hidden_size_ * sizeof(float));
-      batch_offest += lstm_parm->hidden_size_;
-    }
-    gate_offest += lstm_parm->batch_ * lstm_parm->hidden_size_;
-  }
-}
-
-// input: [row, inner_size]; weight: [col, inner_size]; output: [row, col]
-void MatMulAcc(float *output, const float *input, const float *weight, int rows, int cols, int inner_size) {
-  for (int r = 0; r < rows; r++) {
-    for (int c = 0; c < cols; c++) {
-      float res = 0;
-      const float *input_col = input + r * inner_size;
-      const float *weight_col = weight + c * inner_size;
-      int index = 0;
-#ifdef ENABLE_ARM
-      float32x4_t out = vdupq_n_f32(0.0f);
-      for (; index <= inner_size - 4; index += 4) {
-        float32x4_t in_0 = vld1q_f32(input_col + index);
-        float32x4_t in_1 = vld1q_f32(weight_col + index);
-        out = vmlaq_f32(out, in_1, in_0);
-      }
-#ifdef ENABLE_ARM64
-      res += vaddvq_f32(out);
-#else
-      float32x2_t add2 = vadd_f32(vget_low_f32(out), vget_high_f32(out));
-      float32x2_t add4 = vpadd_f32(add2, add2);
-      res += vget_lane_f32(add4, 0);
-#endif
-#endif
-      for (; index < inner_size; index++) {
-        res += input_col[index] * weight_col[index];
-      }
-      output[r * cols + c] += res;
-    }
-  }
-}
-
 void ElementMulAcc(const float *input0, const float *input1, float *output, int element_size) {
   int index = 0;
 #ifdef ENABLE_ARM
@@ -79,108 +35,71 @@ void ElementMulAcc(const float *input0, const float *input1, float *output, int
   }
 }
 
-void UpdataState(float *cell_state, const float *forget_gate, const float *input_gate, const float *cell_gate,
-                 int batch, int hidden_size) {
-  ElementMul(forget_gate, cell_state, cell_state, batch * hidden_size);
-  ElementMulAcc(input_gate, cell_gate, cell_state, batch * hidden_size);
-}
-
-void UpdataOutput(const float *cell_state, const float *output_gate, float *hidden_state, int batch, int hidden_size) {
-  Tanh(cell_state, batch * hidden_size, hidden_state);
-  ElementMul(hidden_state, output_gate, hidden_state, batch * hidden_size);
-}
-
-void LstmStepUnit(float *output, const float *input, const float *input_input_weight, const float *input_forget_weight,
-                  const float *input_cell_weight, const float *input_output_weight, const float *state_input_weight,
-                  const float *state_forget_weight, const float *state_cell_weight, const float *state_output_weight,
-                  const float *bias, float *hidden_state, float *cell_state, float *gate_buffer,
-                  const LstmParameter *lstm_parm) {
-  InitGate(gate_buffer, bias, lstm_parm);
-
-  float *input_gate = gate_buffer;
-  float *forget_gate = gate_buffer + lstm_parm->batch_ * lstm_parm->hidden_size_ * 2;
-  float *cell_gate = gate_buffer + lstm_parm->batch_ * lstm_parm->hidden_size_ * 3;
-  float *output_gate = gate_buffer + lstm_parm->batch_ * lstm_parm->hidden_size_ * 1;
-
-  // input * weight
-  MatMulAcc(input_gate, input, input_input_weight, lstm_parm->batch_, lstm_parm->hidden_size_, lstm_parm->input_size_);
-  MatMulAcc(forget_gate, input, input_forget_weight, lstm_parm->batch_, lstm_parm->hidden_size_,
-            lstm_parm->input_size_);
-  MatMulAcc(cell_gate, input, input_cell_weight, lstm_parm->batch_, lstm_parm->hidden_size_, lstm_parm->input_size_);
-  MatMulAcc(output_gate, input, input_output_weight, lstm_parm->batch_, lstm_parm->hidden_size_,
-            lstm_parm->input_size_);
-
-  // state * weight
-  MatMulAcc(input_gate, hidden_state, state_input_weight, lstm_parm->batch_, lstm_parm->hidden_size_,
-            lstm_parm->hidden_size_);
-  MatMulAcc(forget_gate, hidden_state, state_forget_weight, lstm_parm->batch_, lstm_parm->hidden_size_,
-            lstm_parm->hidden_size_);
-  MatMulAcc(cell_gate, hidden_state, state_cell_weight, lstm_parm->batch_, lstm_parm->hidden_size_,
-            lstm_parm->hidden_size_);
-  MatMulAcc(output_gate, hidden_state, state_output_weight, lstm_parm->batch_, lstm_parm->hidden_size_,
-            lstm_parm->hidden_size_);
-
-  // update input_gate
-  Sigmoid(input_gate, lstm_parm->batch_ * lstm_parm->hidden_size_, input_gate);
-
-  // update forget_gate
-  Sigmoid(forget_gate, lstm_parm->batch_ * lstm_parm->hidden_size_, forget_gate);
-
-  // update cell_gate
-  Tanh(cell_gate, lstm_parm->batch_ * lstm_parm->hidden_size_, cell_gate);
-  // update cell state
-  UpdataState(cell_state, forget_gate, input_gate, cell_gate, lstm_parm->batch_, lstm_parm->hidden_size_);
-
-  // update output_gate
-  Sigmoid(output_gate, lstm_parm->batch_ * lstm_parm->hidden_size_, output_gate);
-  // update output
-  UpdataOutput(cell_state, output_gate, hidden_state, lstm_parm->batch_, lstm_parm->hidden_size_);
-  memcpy(output, hidden_state, lstm_parm->batch_ * lstm_parm->hidden_size_ * sizeof(float));
+void PackLstmStateWeight(float *dst, const float *src, int hidden_size) {
+  int col = 4 * hidden_size;
+  memset(dst, 0, UP_ROUND(col, C4NUM) * hidden_size * sizeof(float));
+  for (int c = 0; c < col; c++) {
+    float *dst_col = dst + c / C4NUM * hidden_size * C4NUM + c % C4NUM;
+    const float *src_row = src + c * hidden_size;
+    for (int k = 0; k < hidden_size; k++) {
+      dst_col[k * C4NUM] = src_row[k];
+    }
+  }
 }
 
-void Lstm(float *output, const float *input, const float *weight_i, const float *weight_h, const float *bias,
-          float *hidden_state, float *cell_state, float *gate_buffer, const LstmParameter *lstm_parm) {
-  // forward
-  const float *input_input_weight = weight_i;
-  const float *input_forget_weight = weight_i + lstm_parm->input_size_ * lstm_parm->hidden_size_ * 2;
-  const float *input_cell_weight = weight_i + lstm_parm->input_size_ * lstm_parm->hidden_size_ * 3;
-  const float *input_output_weight = weight_i + lstm_parm->input_size_ * lstm_parm->hidden_size_ * 1;
-
-  const float *state_input_weight = weight_h;
-  const float *state_forget_weight = weight_h + lstm_parm->hidden_size_ * lstm_parm->hidden_size_ * 2;
-  const float *state_cell_weight = weight_h + lstm_parm->hidden_size_ * lstm_parm->hidden_size_ * 3;
-  const float *state_output_weight = weight_h + lstm_parm->hidden_size_ * lstm_parm->hidden_size_ * 1;
-
-  for (int t = 0; t < lstm_parm->seq_len_; t++) {
-    const float *input_ptr = input + t * lstm_parm->input_step_;
-    float *output_ptr = output + t * lstm_parm->output_step_;
-    LstmStepUnit(output_ptr, input_ptr, input_input_weight, input_forget_weight, input_cell_weight, input_output_weight,
-                 state_input_weight, state_forget_weight, state_cell_weight, state_output_weight, bias, hidden_state,
-                 cell_state, gate_buffer, lstm_parm);
+void LstmStateMatMul(float *gates, const float *state, const float *packed_weight, int batch, int hidden_size) {
+  int col = 4 * hidden_size;
+  // a block of C4NUM columns stays in cache while it is applied to every batch
+  for (int c = 0; c < col; c += C4NUM) {
+    const float *weight = packed_weight + c * hidden_size;
+    int cur_col = MSMIN(C4NUM, col - c);
+    for (int b = 0; b < batch; b++) {
+      const float *state_b = state + b * hidden_size;
+      float res[C4NUM] = {0};
+#ifdef ENABLE_ARM
+      float32x4_t acc = vdupq_n_f32(0.0f);
+      for (int k = 0; k < hidden_size; k++) {
+        acc = vmlaq_n_f32(acc, vld1q_f32(weight + k * C4NUM), state_b[k]);
+      }
+      vst1q_f32(res, acc);
+#else
+      for (int k = 0; k < hidden_size; k++) {
+        for (int j = 0; j < C4NUM; j++) {
+          res[j] += weight[k * C4NUM + j] * state_b[k];
+        }
+      }
+#endif
+      float *gates_b = gates + b * col + c;
+      for (int j = 0; j < cur_col; j++) {
+        gates_b[j] += res[j];
+      }
+    }
   }
+}
 
-  // backward
-  if (lstm_parm->bidirectional_) {
-    input_input_weight = weight_i + lstm_parm->input_size_ * lstm_parm->hidden_size_ * 4;
-    input_forget_weight = weight_i + lstm_parm->input_size_ * lstm_parm->hidden_size_ * 6;
-    input_cell_weight = weight_i + lstm_parm->input_size_ * lstm_parm->hidden_size_ * 7;
-    input_output_weight = weight_i + lstm_parm->input_size_ * lstm_parm->hidden_size_ * 5;
-
-    state_input_weight = weight_h + lstm_parm->hidden_size_ * lstm_parm->hidden_size_ * 4;
-    state_forget_weight = weight_h + lstm_parm->hidden_size_ * lstm_parm->hidden_size_ * 6;
-    state_cell_weight = weight_h + lstm_parm->hidden_size_ * lstm_parm->hidden_size_ * 7;
-    state_output_weight = weight_h + lstm_parm->hidden_size_ * lstm_parm->hidden_size_ * 5;
-
-    float *backward_output = output + lstm_parm->batch_ * lstm_parm->hidden_size_;
-    const float *backward_bias = bias + 4 * lstm_parm->hidden_size_;
-    float *backward_cell_state = cell_state + lstm_parm->batch_ * lstm_parm->hidden_size_;
-    float *backward_hidden_state = hidden_state + lstm_parm->batch_ * lstm_parm->hidden_size_;
-    for (int t = lstm_parm->seq_len_ - 1; t >= 0; t--) {
-      const float *input_ptr = input + t * lstm_parm->input_step_;
-      float *output_ptr = backward_output + t * lstm_parm->output_step_;
-      LstmStepUnit(output_ptr, input_ptr, input_input_weight, input_forget_weight, input_cell_weight,
-                   input_output_weight, state_input_weight, state_forget_weight, state_cell_weight, state_output_weight,
-                   backward_bias, backward_hidden_state, backward_cell_state, gate_buffer, lstm_parm);
+void LstmUnidirectional(float *output, const float *input_gate, const float *packed_state_weight, float *hidden_state,
+                        float *cell_state, float *gate_buffer, const LstmParameter *lstm_parm, bool is_backward) {
+  int hidden_size = lstm_parm->hidden_size_;
+  int gate_step = lstm_parm->batch_ * 4 * hidden_size;
+  for (int i = 0; i < lstm_parm->seq_len_; i++) {
+    int t = is_backward ? lstm_parm->seq_len_ - 1 - i : i;
+    memcpy(gate_buffer, input_gate + t * gate_step, gate_step * sizeof(float));
+    LstmStateMatMul(gate_buffer, hidden_state, packed_state_weight, lstm_parm->batch_, hidden_size);
+    for (int b = 0; b < lstm_parm->batch_; b++) {
+      float *input_gate_b = gate_buffer + b * 4 * hidden_size;
+      float *output_gate_b = input_gate_b + hidden_size;
+      float *forget_gate_b = input_gate_b + 2 * hidden_size;
+      float *cell_gate_b = input_gate_b + 3 * hidden_size;
+      float *cell_state_b = cell_state + b * hidden_size;
+      float *hidden_state_b = hidden_state + b * hidden_size;
+      // input, output and forget gates are adjacent
+      Sigmoid(input_gate_b, 3 * hidden_size, input_gate_b);
+      Tanh(cell_gate_b, hidden_size, cell_gate_b);
+      ElementMul(forget_gate_b, cell_state_b, cell_state_b, hidden_size);
+      ElementMulAcc(input_gate_b, cell_gate_b, cell_state_b, hidden_size);
+      Tanh(cell_state_b, hidden_size, hidden_state_b);
+      ElementMul(hidden_state_b, output_gate_b, hidden_state_b, hidden_size);
     }
+    memcpy(output + t * lstm_parm->output_step_, hidden_state, lstm_parm->batch_ * hidden_size * sizeof(float));
   }
 }
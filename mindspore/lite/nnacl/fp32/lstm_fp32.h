@@ -36,8 +36,17 @@ typedef struct LstmParameter {
 #ifdef __cplusplus
 extern "C" {
 #endif
-void Lstm(float *output, const float *input, const float *weight_i, const float *weight_h, const float *bias,
-          float *hidden_state, float *cell_state, float *gate_buffer, const LstmParameter *lstm_parm);
+// pack the state weight of one direction, [4 * hidden_size, hidden_size], as [UP_DIV(4 * hidden_size, C4NUM),
+// hidden_size, C4NUM] with zero padding, so that the recurrent product reads it in order
+void PackLstmStateWeight(float *dst, const float *src, int hidden_size);
+
+// gates: [batch, 4 * hidden_size] += state: [batch, hidden_size] * packed state weight
+void LstmStateMatMul(float *gates, const float *state, const float *packed_weight, int batch, int hidden_size);
+
+// input_gate: [seq_len, batch, 4 * hidden_size], the input projection plus bias of every step, the gates are in the
+// order input, output, forget, cell
+void LstmUnidirectional(float *output, const float *input_gate, const float *packed_state_weight, float *hidden_state,
+                        float *cell_state, float *gate_buffer, const LstmParameter *lstm_parm, bool is_backward);
 #ifdef __cplusplus
 }
 #endif
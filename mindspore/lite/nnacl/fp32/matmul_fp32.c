@@ -84,6 +84,46 @@ void RowMajor2Row16Major(const float *src_ptr, float *dst_ptr, int row, int col)
   return;
 }
 
+void RowMajor2ColTileMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile) {
+  memset(dst_ptr, 0, UP_ROUND(row, tile) * col * sizeof(float));
+  for (int r = 0; r < row; r++) {
+    const float *src = src_ptr + r * col;
+    float *dst = dst_ptr + r / tile * tile * col + r % tile;
+    for (int c = 0; c < col; c++) {
+      dst[c * tile] = src[c];
+    }
+  }
+}
+
+void RowMajor2RowTileMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile) {
+  memset(dst_ptr, 0, UP_ROUND(col, tile) * row * sizeof(float));
+  for (int r = 0; r < row; r++) {
+    const float *src = src_ptr + r * col;
+    for (int c = 0; c < col; c++) {
+      dst_ptr[c / tile * tile * row + r * tile + c % tile] = src[c];
+    }
+  }
+}
+
+void ColTileMajor2RowMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile) {
+  for (int r = 0; r < row; r++) {
+    const float *src = src_ptr + r / tile * tile * col + r % tile;
+    float *dst = dst_ptr + r * col;
+    for (int c = 0; c < col; c++) {
+      dst[c] = src[c * tile];
+    }
+  }
+}
+
+void RowTileMajor2RowMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile) {
+  for (int r = 0; r < row; r++) {
+    float *dst = dst_ptr + r * col;
+    for (int c = 0; c < col; c++) {
+      dst[c] = src_ptr[c / tile * tile * row + r * tile + c % tile];
+    }
+  }
+}
+
 void RowMajor2Col12Major(const float *src_ptr, float *dst_ptr, size_t row, size_t col) {
   size_t row_up_12 = UP_ROUND(row, C12NUM);
   size_t row12 = row / C12NUM * C12NUM;
@@ -40,6 +40,11 @@ void RowMajor2Col6Major(const float *src_ptr, float *dst_ptr, size_t row, size_t
 void RowMajor2Col8Major(const float *src_ptr, float *dst_ptr, size_t row, size_t col);
 void RowMajor2Col12Major(const float *src_ptr, float *dst_ptr, size_t row, size_t col);
 void RowMajor2Col16Major(const float *src_ptr, float *dst_ptr, size_t row, size_t col);
+// Tile sized versions of the packing above, used for weights packed offline by the converter. They zero the padding.
+void RowMajor2ColTileMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile);
+void RowMajor2RowTileMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile);
+void ColTileMajor2RowMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile);
+void RowTileMajor2RowMajor(const float *src_ptr, float *dst_ptr, int row, int col, int tile);
 #ifdef ENABLE_ARM
 void MatVecMulFp32(const float *a, const float *b, float *c, const float *bias, int act_type, int depth, int col);
 #endif
@@ -0,0 +1,97 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "nnacl/int8/attention_int8.h"
+#include <math.h>
+#include <string.h>
+#include "nnacl/fp32/attention_fp32.h"
+
+static int32_t AttentionDotInt8(const int8_t *a, const int8_t *b, int len, int32_t a_zp, int32_t b_zp) {
+  int32_t res = 0;
+  for (int index = 0; index < len; index++) {
+    res += (a[index] - a_zp) * (b[index] - b_zp);
+  }
+  return res;
+}
+
+int AttentionInt8(const int8_t *q, const int8_t *k, const int8_t *v, const float *mask, int8_t *out, float *buffer,
+                  int row_start, int row_end, const AttentionParameter *param, const AttentionQuantArg *quant) {
+  if (q == NULL || k == NULL || v == NULL || out == NULL || buffer == NULL) {
+    return NNACL_NULL_PTR;
+  }
+  int head_dim = param->head_dim_;
+  int v_dim = param->v_head_dim_;
+  int kv_len = param->kv_len_;
+  int32_t q_zp = quant->q_.zp_;
+  int32_t k_zp = quant->k_.zp_;
+  int32_t v_zp = quant->v_.zp_;
+  float score_scale = param->scale_ * quant->q_.scale_ * quant->k_.scale_;
+  float *score = buffer;
+  float *acc = score + ATTENTION_ROW_BLOCK * ATTENTION_COL_BLOCK;
+  float *row_max = acc + ATTENTION_ROW_BLOCK * v_dim;
+  float *row_sum = row_max + ATTENTION_ROW_BLOCK;
+
+  for (int r = row_start; r < row_end; r += ATTENTION_ROW_BLOCK) {
+    int rows = MSMIN(ATTENTION_ROW_BLOCK, row_end - r);
+    const int8_t *q_block = q + r * head_dim;
+    memset(acc, 0, rows * v_dim * sizeof(float));
+    for (int i = 0; i < rows; i++) {
+      row_max[i] = -INFINITY;
+      row_sum[i] = 0.0f;
+    }
+    for (int c = 0; c < kv_len; c += ATTENTION_COL_BLOCK) {
+      int cols = MSMIN(ATTENTION_COL_BLOCK, kv_len - c);
+      for (int i = 0; i < rows; i++) {
+        const int8_t *q_row = q_block + i * head_dim;
+        for (int j = 0; j < cols; j++) {
+          int32_t dot = 0;
+          if (param->transpose_b_) {
+            dot = AttentionDotInt8(q_row, k + (c + j) * head_dim, head_dim, q_zp, k_zp);
+          } else {
+            for (int d = 0; d < head_dim; d++) {
+              dot += (q_row[d] - q_zp) * (k[d * kv_len + c + j] - k_zp);
+            }
+          }
+          score[i * cols + j] = (float)dot;
+        }
+      }
+      const float *mask_block = mask == NULL ? NULL : mask + r * param->mask_row_stride_ + c;
+      AttentionScaleMask(score, mask_block, rows, cols, param->mask_row_stride_, score_scale);
+      AttentionSoftmaxUpdate(score, rows, cols, row_max, row_sum, acc, v_dim);
+      for (int i = 0; i < rows; i++) {
+        float *acc_row = acc + i * v_dim;
+        for (int j = 0; j < cols; j++) {
+          float prob = score[i * cols + j];
+          if (prob == 0.0f) {
+            continue;
+          }
+          const int8_t *v_row = v + (c + j) * v_dim;
+          for (int d = 0; d < v_dim; d++) {
+            acc_row[d] += prob * (v_row[d] - v_zp);
+          }
+        }
+      }
+    }
+    for (int i = 0; i < rows; i++) {
+      float out_scale = row_sum[i] > 0.0f ? quant->v_.scale_ / (row_sum[i] * quant->out_.scale_) : 0.0f;
+      int8_t *dst = out + (r + i) * v_dim;
+      for (int j = 0; j < v_dim; j++) {
+        int32_t value = (int32_t)roundf(acc[i * v_dim + j] * out_scale) + quant->out_.zp_;
+        dst[j] = (int8_t)MSMAX(MSMIN(value, INT8_MAX), INT8_MIN);
+      }
+    }
+  }
+  return NNACL_OK;
+}
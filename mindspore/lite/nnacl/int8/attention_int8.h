@@ -0,0 +1,35 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_NNACL_INT8_ATTENTION_INT8_H_
+#define MINDSPORE_LITE_NNACL_INT8_ATTENTION_INT8_H_
+
+#include "nnacl/errorcode.h"
+#include "nnacl/attention_parameter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * same tiling as AttentionFp32, q * k^T is accumulated in int32 and the softmax runs in fp32.
+ * mask is dequantized by the caller.
+ */
+int AttentionInt8(const int8_t *q, const int8_t *k, const int8_t *v, const float *mask, int8_t *out, float *buffer,
+                  int row_start, int row_end, const AttentionParameter *param, const AttentionQuantArg *quant);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_LITE_NNACL_INT8_ATTENTION_INT8_H_
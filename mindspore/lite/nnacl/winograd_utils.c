@@ -18,9 +18,6 @@
 #include <stdio.h>
 #include "nnacl/minimal_filtering_generator.h"
 
-#define MIN_UNIT 2
-#define MAX_UNIT 8
-
 static InputTransFunc InputTransFuncList[] = {
   NULL, NULL, NULL, NULL, InputTransform4x4Unit, NULL, InputTransform6x6Unit, NULL, InputTransform8x8Unit};
 
@@ -3815,6 +3812,21 @@ int SelectOutputUnit(ConvParameter *conv_param) {
   return unit;
 }
 
+int WinogradOutputUnits(const ConvParameter *conv_param, int *units) {
+  int kernel_w = conv_param->kernel_w_;
+  if (kernel_w == 1 || conv_param->kernel_h_ != kernel_w || conv_param->dilation_h_ != 1 ||
+      conv_param->dilation_w_ != 1 || conv_param->stride_h_ != 1 || conv_param->stride_w_ != 1) {
+    return 0;
+  }
+  int num = 0;
+  for (int i = MIN_UNIT; i <= MAX_UNIT; ++i) {
+    if (GetOutputTransFunc(i + kernel_w - 1, i, ActType_No)) {
+      units[num++] = i;
+    }
+  }
+  return num;
+}
+
 void CheckIfUseWinograd(bool *use_winograd, int *output_unit, ConvParameter *conv_param) {
   if (conv_param->kernel_w_ == conv_param->kernel_h_ && conv_param->dilation_h_ == 1 && conv_param->dilation_w_ == 1 &&
       conv_param->stride_h_ == 1 && conv_param->stride_w_ == 1) {
@@ -24,6 +24,8 @@
 #include "nnacl/op_base.h"
 
 #define MAX_LEN 256
+#define MIN_UNIT 2
+#define MAX_UNIT 8
 
 #ifdef __cplusplus
 extern "C" {
@@ -311,6 +313,10 @@ void OutputTransform8x7Relu6Unit(const float *src_data, float *dst_data, const f
 int SelectOutputUnit(ConvParameter *conv_param);
 
 void CheckIfUseWinograd(bool *use_winograd, int *output_unit, ConvParameter *conv_param);
+
+// Writes the output units the winograd convolution supports for conv_param to units, which holds
+// MAX_UNIT - MIN_UNIT + 1 of them, and returns their number, 0 if conv_param can not use winograd.
+int WinogradOutputUnits(const ConvParameter *conv_param, int *units);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,308 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/batch_server.h"
+#include <algorithm>
+#include <cstring>
+#include "src/common/log_adapter.h"
+
+namespace mindspore {
+namespace lite {
+namespace {
+constexpr size_t kHistogramBins = 32;
+
+size_t HistogramBin(int64_t us) {
+  size_t bin = 0;
+  while (us > 1 && bin + 1 < kHistogramBins) {
+    us >>= 1;
+    bin++;
+  }
+  return bin;
+}
+}  // namespace
+
+BatchServer::~BatchServer() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stop_ = true;
+  }
+  queue_cond_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  for (auto session : sessions_) {
+    delete session;
+  }
+  sessions_.clear();
+  delete model_;
+  model_ = nullptr;
+}
+
+int BatchServer::InitBuckets(const session::BatchServerOptions &options) {
+  if (options.max_batch_size_ < 1 || options.max_wait_us_ < 0) {
+    MS_LOG(ERROR) << "Invalid batch options, max_batch_size: " << options.max_batch_size_
+                  << ", max_wait_us: " << options.max_wait_us_;
+    return RET_PARAM_INVALID;
+  }
+  max_batch_size_ = static_cast<size_t>(options.max_batch_size_);
+  max_wait_ = std::chrono::microseconds(options.max_wait_us_);
+  if (options.buckets_.empty()) {
+    for (int batch = 1; batch < options.max_batch_size_; batch <<= 1) {
+      buckets_.push_back(batch);
+    }
+  }
+  for (auto batch : options.buckets_) {
+    if (batch < 1 || batch > options.max_batch_size_) {
+      MS_LOG(ERROR) << "Bucket " << batch << " is out of [1, " << options.max_batch_size_ << "]";
+      return RET_PARAM_INVALID;
+    }
+    buckets_.push_back(batch);
+  }
+  buckets_.push_back(options.max_batch_size_);
+  std::sort(buckets_.begin(), buckets_.end());
+  buckets_.erase(std::unique(buckets_.begin(), buckets_.end()), buckets_.end());
+  return RET_OK;
+}
+
+int BatchServer::CreateBucketSession(const Context *context, int batch) {
+  auto session = session::LiteSession::CreateSession(context);
+  if (session == nullptr) {
+    MS_LOG(ERROR) << "Create session of bucket " << batch << " failed";
+    return RET_ERROR;
+  }
+  sessions_.push_back(session);
+  auto ret = session->CompileGraph(model_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Compile graph of bucket " << batch << " failed";
+    return ret;
+  }
+  auto inputs = session->GetInputs();
+  std::vector<std::vector<int>> dims;
+  bool resize = false;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    auto shape = inputs[i]->shape();
+    if (shape.empty()) {
+      MS_LOG(ERROR) << "Input " << i << " has no batch dimension";
+      return RET_INPUT_TENSOR_ERROR;
+    }
+    resize = resize || shape[0] != batch;
+    shape[0] = batch;
+    dims.push_back(shape);
+  }
+  // Resize only once here, the session then keeps the shapes of its bucket for all the batches it runs
+  if (resize) {
+    ret = session->Resize(inputs, dims);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "Resize graph to bucket " << batch << " failed";
+      return ret;
+    }
+  }
+  for (auto &name : session->GetOutputTensorNames()) {
+    auto output = session->GetOutputByTensorName(name);
+    if (output == nullptr || output->shape().empty() || output->shape()[0] != batch) {
+      MS_LOG(ERROR) << "Output " << name << " does not carry the batch in its first dimension";
+      return RET_ERROR;
+    }
+  }
+  return RET_OK;
+}
+
+int BatchServer::InitSampleSizes() {
+  auto session = sessions_.front();
+  auto batch = static_cast<size_t>(buckets_.front());
+  for (auto input : session->GetInputs()) {
+    input_sizes_.push_back(input->Size() / batch);
+  }
+  output_names_ = session->GetOutputTensorNames();
+  for (auto &name : output_names_) {
+    output_sizes_.push_back(session->GetOutputByTensorName(name)->Size() / batch);
+  }
+  return RET_OK;
+}
+
+int BatchServer::Init(const char *model_buf, size_t size, const Context *context,
+                      const session::BatchServerOptions &options) {
+  if (model_buf == nullptr || context == nullptr) {
+    MS_LOG(ERROR) << "model_buf or context is nullptr";
+    return RET_NULL_PTR;
+  }
+  auto ret = InitBuckets(options);
+  if (ret != RET_OK) {
+    return ret;
+  }
+  model_ = Model::Import(model_buf, size);
+  if (model_ == nullptr) {
+    MS_LOG(ERROR) << "Import model failed";
+    return RET_ERROR;
+  }
+  for (auto batch : buckets_) {
+    ret = CreateBucketSession(context, batch);
+    if (ret != RET_OK) {
+      return ret;
+    }
+  }
+  // all the sessions are compiled and never resized again, so the meta graph is not needed any more
+  model_->Free();
+  ret = InitSampleSizes();
+  if (ret != RET_OK) {
+    return ret;
+  }
+  stat_.batch_size_hist_.assign(max_batch_size_ + 1, 0);
+  stat_.queue_us_hist_.assign(kHistogramBins, 0);
+  stat_.latency_us_hist_.assign(kHistogramBins, 0);
+  worker_ = std::thread(&BatchServer::WorkerLoop, this);
+  return RET_OK;
+}
+
+int BatchServer::Predict(const std::vector<const void *> &inputs, const std::vector<void *> &outputs) {
+  if (inputs.size() != input_sizes_.size() || outputs.size() != output_sizes_.size()) {
+    MS_LOG(ERROR) << "Expect " << input_sizes_.size() << " inputs and " << output_sizes_.size() << " outputs, but got "
+                  << inputs.size() << " and " << outputs.size();
+    return RET_PARAM_INVALID;
+  }
+  if (std::find(inputs.begin(), inputs.end(), nullptr) != inputs.end() ||
+      std::find(outputs.begin(), outputs.end(), nullptr) != outputs.end()) {
+    MS_LOG(ERROR) << "Input or output buffer is nullptr";
+    return RET_NULL_PTR;
+  }
+  Request request;
+  request.inputs_ = &inputs;
+  request.outputs_ = &outputs;
+  request.enqueue_time_ = Clock::now();
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  if (stop_) {
+    MS_LOG(ERROR) << "Server is stopping";
+    return RET_ERROR;
+  }
+  queue_.push_back(&request);
+  queue_cond_.notify_one();
+  done_cond_.wait(lock, [&request] { return request.done_; });
+  return request.ret_;
+}
+
+void BatchServer::WorkerLoop() {
+  std::vector<Request *> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      // the batch closes once it is full or its oldest request has waited long enough
+      auto deadline = queue_.front()->enqueue_time_ + max_wait_;
+      queue_cond_.wait_until(lock, deadline, [this] { return stop_ || queue_.size() >= max_batch_size_; });
+      auto num = std::min(queue_.size(), max_batch_size_);
+      batch.assign(queue_.begin(), queue_.begin() + num);
+      queue_.erase(queue_.begin(), queue_.begin() + num);
+    }
+    RunBatch(batch);
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      for (auto request : batch) {
+        request->done_ = true;
+      }
+    }
+    done_cond_.notify_all();
+  }
+}
+
+void BatchServer::RunBatch(const std::vector<Request *> &batch) {
+  auto start = Clock::now();
+  auto num = batch.size();
+  size_t bucket = 0;
+  while (static_cast<size_t>(buckets_[bucket]) < num) {
+    bucket++;
+  }
+  auto session = sessions_[bucket];
+  auto padded = static_cast<size_t>(buckets_[bucket]);
+  int ret = RET_OK;
+  auto inputs = session->GetInputs();
+  for (size_t i = 0; i < inputs.size(); i++) {
+    auto dst = reinterpret_cast<char *>(inputs[i]->MutableData());
+    if (dst == nullptr) {
+      MS_LOG(ERROR) << "Malloc data of input " << i << " failed";
+      ret = RET_MEMORY_FAILED;
+      break;
+    }
+    auto sample_size = input_sizes_[i];
+    for (size_t j = 0; j < num; j++) {
+      memcpy(dst + j * sample_size, batch[j]->inputs_->at(i), sample_size);
+    }
+    // the outputs of the padding samples are dropped, zeros only keep them finite
+    memset(dst + num * sample_size, 0, (padded - num) * sample_size);
+  }
+  if (ret == RET_OK) {
+    ret = session->RunGraph();
+  }
+  for (size_t i = 0; i < output_names_.size() && ret == RET_OK; i++) {
+    auto output = session->GetOutputByTensorName(output_names_[i]);
+    auto src = reinterpret_cast<char *>(output->MutableData());
+    if (src == nullptr) {
+      MS_LOG(ERROR) << "Data of output " << output_names_[i] << " is nullptr";
+      ret = RET_ERROR;
+      break;
+    }
+    auto sample_size = output_sizes_[i];
+    for (size_t j = 0; j < num; j++) {
+      memcpy(batch[j]->outputs_->at(i), src + j * sample_size, sample_size);
+    }
+  }
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Run batch of " << num << " requests failed: " << ret;
+  }
+  for (auto request : batch) {
+    request->ret_ = ret;
+  }
+  UpdateStat(batch, start, Clock::now());
+}
+
+void BatchServer::UpdateStat(const std::vector<Request *> &batch, Clock::time_point start, Clock::time_point end) {
+  std::lock_guard<std::mutex> lock(stat_mutex_);
+  stat_.requests_ += batch.size();
+  stat_.batches_++;
+  stat_.batch_size_hist_[batch.size()]++;
+  for (auto request : batch) {
+    auto queue_us = std::chrono::duration_cast<std::chrono::microseconds>(start - request->enqueue_time_).count();
+    auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(end - request->enqueue_time_).count();
+    stat_.queue_us_hist_[HistogramBin(queue_us)]++;
+    stat_.latency_us_hist_[HistogramBin(latency_us)]++;
+  }
+}
+
+session::BatchServerStat BatchServer::GetStat() const {
+  std::lock_guard<std::mutex> lock(stat_mutex_);
+  return stat_;
+}
+}  // namespace lite
+
+session::BatchServer *session::BatchServer::CreateServer(const char *model_buf, size_t size,
+                                                         const lite::Context *context,
+                                                         const BatchServerOptions &options) {
+  auto server = new (std::nothrow) lite::BatchServer();
+  if (server == nullptr) {
+    MS_LOG(ERROR) << "create server failed";
+    return nullptr;
+  }
+  auto ret = server->Init(model_buf, size, context, options);
+  if (ret != lite::RET_OK) {
+    MS_LOG(ERROR) << "init server failed";
+    delete server;
+    return nullptr;
+  }
+  return server;
+}
+}  // namespace mindspore
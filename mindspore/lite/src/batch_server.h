@@ -0,0 +1,97 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_BATCH_SERVER_H_
+#define MINDSPORE_LITE_SRC_BATCH_SERVER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "include/batch_server.h"
+#include "include/errorcode.h"
+#include "include/lite_session.h"
+#include "include/model.h"
+
+namespace mindspore {
+namespace lite {
+class BatchServer : public session::BatchServer {
+ public:
+  BatchServer() = default;
+
+  ~BatchServer() override;
+
+  int Init(const char *model_buf, size_t size, const Context *context, const session::BatchServerOptions &options);
+
+  std::vector<size_t> GetInputSizes() const override { return input_sizes_; }
+
+  std::vector<size_t> GetOutputSizes() const override { return output_sizes_; }
+
+  std::vector<std::string> GetOutputTensorNames() const override { return output_names_; }
+
+  int Predict(const std::vector<const void *> &inputs, const std::vector<void *> &outputs) override;
+
+  session::BatchServerStat GetStat() const override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    const std::vector<const void *> *inputs_ = nullptr;
+    const std::vector<void *> *outputs_ = nullptr;
+    Clock::time_point enqueue_time_;
+    int ret_ = RET_OK;
+    bool done_ = false;
+  };
+
+  int InitBuckets(const session::BatchServerOptions &options);
+
+  int CreateBucketSession(const Context *context, int batch);
+
+  int InitSampleSizes();
+
+  void WorkerLoop();
+
+  void RunBatch(const std::vector<Request *> &batch);
+
+  void UpdateStat(const std::vector<Request *> &batch, Clock::time_point start, Clock::time_point end);
+
+  Model *model_ = nullptr;
+  size_t max_batch_size_ = 1;
+  std::chrono::microseconds max_wait_{0};
+  // batch sizes in increasing order, the session of buckets_[i] is sessions_[i]
+  std::vector<int> buckets_;
+  std::vector<session::LiteSession *> sessions_;
+  std::vector<size_t> input_sizes_;
+  std::vector<size_t> output_sizes_;
+  std::vector<std::string> output_names_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;
+  std::condition_variable done_cond_;
+  std::deque<Request *> queue_;
+  bool stop_ = false;
+  std::thread worker_;
+
+  mutable std::mutex stat_mutex_;
+  session::BatchServerStat stat_;
+};
+}  // namespace lite
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_SRC_BATCH_SERVER_H_
@@ -17,6 +17,7 @@
 #include "src/inner_context.h"
 #include "include/errorcode.h"
 #include "src/common/log_adapter.h"
+#include "src/runtime/kernel_tuner.h"
 #ifdef SUPPORT_NPU
 #include "src/runtime/agent/npu/npu_manager.h"
 #endif
@@ -25,6 +26,9 @@ namespace mindspore::lite {
 InnerContext::InnerContext(const Context *context) {
   this->allocator = context->allocator;
   this->thread_num_ = context->thread_num_;
+  this->resize_cache_size_ = context->resize_cache_size_;
+  this->tuning_file_ = context->tuning_file_;
+  this->keep_rnn_states_ = context->keep_rnn_states_;
   this->device_list_.clear();
   for (auto &device_ctx : context->device_list_) {
     this->device_list_.push_back(device_ctx);
@@ -51,6 +55,14 @@ int InnerContext::Init() {
       return RET_NULL_PTR;
     }
   }
+  if (this->kernel_tuner_ == nullptr && !this->tuning_file_.empty()) {
+    this->kernel_tuner_ = new (std::nothrow) KernelTuner(this->tuning_file_);
+    if (this->kernel_tuner_ == nullptr) {
+      MS_LOG(ERROR) << "Create KernelTuner failed";
+      return RET_NULL_PTR;
+    }
+    this->kernel_tuner_->Load();
+  }
   return RET_OK;
 }
 
@@ -60,6 +72,8 @@ InnerContext::~InnerContext() {
     free(this->thread_pool_);
     this->thread_pool_ = nullptr;
   }
+  delete this->kernel_tuner_;
+  this->kernel_tuner_ = nullptr;
 }
 
 int InnerContext::IsValid() const {
@@ -22,9 +22,13 @@
 #include "src/runtime/allocator.h"
 
 namespace mindspore::lite {
+class KernelTuner;
+
 struct InnerContext : public Context {
  public:
   struct ThreadPool *thread_pool_ = nullptr;
+  // picks the kernels of the tuned ops, only created when tuning_file_ is set
+  KernelTuner *kernel_tuner_ = nullptr;
 
  public:
   InnerContext() = default;
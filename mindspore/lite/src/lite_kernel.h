@@ -111,6 +111,9 @@ class LiteKernel {
 
   virtual bool IsEval() const { return !this->train_mode_; }
 
+  // drop the state a recurrent kernel keeps between runs, the next run starts again from its state inputs
+  virtual int ResetState() { return mindspore::lite::RET_OK; }
+
   virtual void set_trainable(bool trainable = true) { this->trainable_ = trainable; }
 
   virtual bool is_trainable() const { return this->trainable_; }
@@ -15,6 +15,7 @@
  */
 
 #include "src/lite_session.h"
+#include <algorithm>
 #include <vector>
 #include <utility>
 #include "src/runtime/runtime_api.h"
@@ -28,6 +29,11 @@
 #include "src/kernel_registry.h"
 #include "src/model_common.h"
 #include "src/runtime/kernel/arm/base/dequant.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
+#include "src/runtime/kernel/arm/base/block_sparse_weight.h"
+#include "src/runtime/kernel_tuner.h"
+#include "src/runtime/packed_weight_cache.h"
+#include "src/ops/conv2d.h"
 #if SUPPORT_NPU
 #include "src/runtime/agent/npu/npu_manager.h"
 #endif
@@ -42,8 +48,7 @@ static std::vector<schema::PrimitiveType> packed_op = {
 static bool WeightTensorNeedCopy(const lite::Model *model, const uint32_t tensor_idx) {
 #ifdef SUPPORT_TRAIN
   return false;
-#endif
-
+#else
   MS_ASSERT(model != nullptr);
   auto post_node_idxes = GetLinkedPostNodeIdx(model, tensor_idx);
   return std::none_of(post_node_idxes.begin(), post_node_idxes.end(), [&](const size_t &post_node_idx) {
@@ -51,6 +56,43 @@ static bool WeightTensorNeedCopy(const lite::Model *model, const uint32_t tensor
     MS_ASSERT(node != nullptr);
     return IsContain(packed_op, static_cast<schema::PrimitiveType>(node->primitive_->Type()));
   });
+#endif
+}
+
+// A weight packed by the converter keeps its layout only if each node using it runs a kernel reading that layout.
+static bool PackedWeightUsable(const lite::Model *model, const uint32_t tensor_idx) {
+#ifdef SUPPORT_TRAIN
+  return false;
+#else
+  MS_ASSERT(model != nullptr);
+  auto post_node_idxes = GetLinkedPostNodeIdx(model, tensor_idx);
+  return !post_node_idxes.empty() &&
+         std::all_of(post_node_idxes.begin(), post_node_idxes.end(), [&](const size_t &post_node_idx) {
+           auto node = model->all_nodes_[post_node_idx];
+           MS_ASSERT(node != nullptr);
+           if (node->input_indices_.size() < 2 || node->input_indices_[1] != tensor_idx) {
+             return false;
+           }
+           switch (static_cast<schema::PrimitiveType>(node->primitive_->Type())) {
+             case schema::PrimitiveType_FullConnection:
+             case schema::PrimitiveType_MatMul:
+               return true;
+             case schema::PrimitiveType_Conv2D: {
+               // The winograd, depthwise and group convolutions pack the weight their own way.
+               auto conv = reinterpret_cast<const lite::Conv2D *>(node->primitive_);
+               if (conv->GetGroup() != 1) {
+                 return false;
+               }
+               bool is_1x1 = conv->GetKernelH() == 1 && conv->GetKernelW() == 1;
+               bool maybe_winograd = conv->GetKernelH() == conv->GetKernelW() && conv->GetStrideH() == 1 &&
+                                     conv->GetStrideW() == 1 && conv->GetDilateH() == 1 && conv->GetDilateW() == 1;
+               return is_1x1 || !maybe_winograd;
+             }
+             default:
+               return false;
+           }
+         });
+#endif
 }
 
 LiteSession::LiteSession() { this->is_running_.store(false); }
@@ -81,6 +123,77 @@ void LiteSession::ConvertTensorsQuantParam(const schema::Tensor *src_tensor, lit
   }
 }
 
+int LiteSession::ConvertPackedWeightData(const lite::Model *model, size_t tensor_index,
+                                         const schema::Tensor *src_tensor, lite::Tensor *dst_tensor) {
+  auto weight_pack = src_tensor->weightPack();
+  MS_ASSERT(weight_pack != nullptr);
+  if (weight_pack->layout() == schema::WeightPackLayout_BLOCK_SPARSE) {
+    return ConvertBlockSparseWeightData(tensor_index, src_tensor, dst_tensor);
+  }
+  if (weight_pack->layout() != schema::WeightPackLayout_COL_TILE || weight_pack->colTile() <= 0 ||
+      dst_tensor->data_type() != kNumberTypeFloat32) {
+    MS_LOG(ERROR) << "Unsupported packed weight " << tensor_index << ", layout: "
+                  << schema::EnumNameWeightPackLayout(weight_pack->layout()) << ", tile: " << weight_pack->colTile();
+    return RET_NOT_SUPPORT;
+  }
+  dst_tensor->set_weight_pack(weight_pack->colTile(), weight_pack->deepMajor());
+  if (src_tensor->data()->size() != dst_tensor->Size()) {
+    MS_LOG(ERROR) << "Size of packed weight " << tensor_index << " is " << src_tensor->data()->size() << ", expect "
+                  << dst_tensor->Size();
+    return RET_ERROR;
+  }
+  // The weight is copied in both cases, so that the model buffer can still be freed once the graph is compiled.
+  if (weight_pack->colTile() != kernel::WeightPackUtil::ColTile() || context_->IsCpuFloat16Enabled() ||
+      context_->IsGpuEnabled() || context_->IsNpuEnabled() || !PackedWeightUsable(model, tensor_index)) {
+    MS_LOG(INFO) << "Unpack weight " << tensor_index << " packed with tile " << weight_pack->colTile();
+    auto ret = kernel::WeightPackUtil::UnpackWeight(dst_tensor, src_tensor->data()->data());
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "Unpack weight " << tensor_index << " failed";
+      return ret;
+    }
+    copyed_tensor_idxes_.emplace_back(tensor_index);
+    return RET_OK;
+  }
+  // A weight kept packed is shared with the other sessions of the model.
+  auto src_data = src_tensor->data()->data();
+  auto size = dst_tensor->Size();
+  auto dst_data = PackedWeightCache::GetInstance()->Acquire(dst_tensor, kPackedColTile, size,
+                                                            [&](void *dst) { memcpy(dst, src_data, size); });
+  if (dst_data == nullptr) {
+    MS_LOG(ERROR) << "Data from tensor is nullptr";
+    return RET_NULL_PTR;
+  }
+  dst_tensor->set_data(dst_data);
+  shared_tensor_idxes_.emplace_back(tensor_index);
+  return RET_OK;
+}
+
+// A block sparse weight is decoded to its plain data, the kernels able to skip its zero blocks encode it again.
+int LiteSession::ConvertBlockSparseWeightData(size_t tensor_index, const schema::Tensor *src_tensor,
+                                              lite::Tensor *dst_tensor) {
+  auto weight_pack = src_tensor->weightPack();
+  MS_ASSERT(weight_pack != nullptr);
+  if (weight_pack->blockOffsets() == nullptr || weight_pack->blockIndex() == nullptr) {
+    MS_LOG(ERROR) << "Block sparse weight " << tensor_index << " has no blocks";
+    return RET_ERROR;
+  }
+  std::vector<int> block_offsets(weight_pack->blockOffsets()->begin(), weight_pack->blockOffsets()->end());
+  std::vector<int> block_index(weight_pack->blockIndex()->begin(), weight_pack->blockIndex()->end());
+  auto ret = kernel::BlockSparseWeight::DecodeWeight(dst_tensor, weight_pack->blockRows(), weight_pack->blockCols(),
+                                                     weight_pack->deepMajor(), block_offsets, block_index,
+                                                     src_tensor->data()->data(), src_tensor->data()->size());
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Decode block sparse weight " << tensor_index << " failed";
+    return ret;
+  }
+#ifdef SUPPORT_TRAIN
+  // Training fills the zero blocks, so the weight is run dense.
+  dst_tensor->set_sparse_block(0, 0);
+#endif
+  copyed_tensor_idxes_.emplace_back(tensor_index);
+  return RET_OK;
+}
+
 int LiteSession::ConvertTensorsData(const lite::Model *model, size_t tensor_index, const schema::Tensor *src_tensor,
                                     lite::Tensor *dst_tensor) {
   MS_ASSERT(src_tensor != nullptr);
@@ -98,6 +211,9 @@ int LiteSession::ConvertTensorsData(const lite::Model *model, size_t tensor_inde
       if (tensor_list->Decode(reinterpret_cast<const int *>(src_tensor->data()->data())) != RET_OK) {
         return RET_ERROR;
       }
+    } else if (src_tensor->weightPack() != nullptr &&
+               src_tensor->weightPack()->layout() != schema::WeightPackLayout_NONE) {
+      return ConvertPackedWeightData(model, tensor_index, src_tensor, dst_tensor);
     } else {
       if (WeightTensorNeedCopy(model, tensor_index)) {
         auto dst_data = dst_tensor->MutableData();
@@ -157,6 +273,7 @@ lite::Tensor *LiteSession::ConvertTensor(const schema::Tensor &src_tensor) {
 int LiteSession::ConvertTensors(const lite::Model *model) {
   MS_ASSERT(model != nullptr);
   copyed_tensor_idxes_.clear();
+  shared_tensor_idxes_.clear();
   uint32_t tensor_count = model->all_tensors_.size();
   for (uint32_t i = 0; i < tensor_count; ++i) {
     auto *src_tensor = model->all_tensors_[i];
@@ -169,6 +286,12 @@ int LiteSession::ConvertTensors(const lite::Model *model) {
       MS_LOG(ERROR) << "Convert new " << i << "th tensor failed!";
       return RET_NULL_PTR;
     }
+#ifndef SUPPORT_TRAIN
+    // Weights are read only at inference, so the buffers kernels pack from them are shared by the sessions of a model.
+    if (dst_tensor->IsConst()) {
+      dst_tensor->set_weight_key(model, i);
+    }
+#endif
     auto ret = ConvertTensorsData(model, i, src_tensor, dst_tensor);
     if (ret != RET_OK) {
       MS_LOG(ERROR) << "Convert data of " << i << "th tensor failed";
@@ -389,6 +512,13 @@ int LiteSession::CompileGraph(Model *model) {
     is_running_.store(false);
     return ret;
   }
+  ret = InitResizePlanCache(model);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Init resize plan cache failed: " << ret;
+    is_running_.store(false);
+    return ret;
+  }
+  SaveKernelTuning();
   is_running_.store(false);
   return RET_OK;
 }
@@ -519,6 +649,10 @@ LiteSession::~LiteSession() {
   for (size_t i = 0; i < tensors_.size(); i++) {
     auto *tensor = tensors_.at(i);
     MS_ASSERT(tensor != nullptr);
+    if (IsContain(shared_tensor_idxes_, i)) {
+      PackedWeightCache::GetInstance()->Release(tensor->data_c());
+      tensor->set_data(nullptr);
+    }
     // data of weight tensor of node in packed_op can not be to free, we will free weight data when freeing meta_graph
     if (tensor->IsConst() && !IsContain(this->inputs_, tensor) && !IsContain(copyed_tensor_idxes_, i)) {
       tensor->set_data(nullptr);
@@ -530,9 +664,16 @@ LiteSession::~LiteSession() {
   output_node_map_.clear();
   output_tensor_map_.clear();
   input_vec_.clear();
-  for (auto *kernel : kernels_) {
-    delete kernel;
+  if (resize_plans_ != nullptr) {
+    // kernels_ belong to one of the plans
+    delete resize_plans_;
+    resize_plans_ = nullptr;
+  } else {
+    for (auto *kernel : kernels_) {
+      delete kernel;
+    }
   }
+  kernels_.clear();
   delete this->context_;
   delete this->executor_;
   this->executor_ = nullptr;
@@ -647,6 +788,11 @@ int LiteSession::Resize(const std::vector<mindspore::tensor::MSTensor *> &inputs
     return ret;
   }
 
+  if (resize_plans_ != nullptr) {
+    ret = ResizeWithPlanCache(old_dims, dims);
+    is_running_.store(false);
+    return ret;
+  }
   ret = ReSizeKernels(kernels_);
   if (ret != RET_OK) {
     ResetInputsShape(old_dims);
@@ -661,6 +807,141 @@ int LiteSession::Resize(const std::vector<mindspore::tensor::MSTensor *> &inputs
   return RET_OK;
 }
 
+int LiteSession::ResetStates() {
+  bool expected = false;
+  if (!is_running_.compare_exchange_strong(expected, true)) {
+    MS_LOG(ERROR) << "Not support multi-threading";
+    return RET_ERROR;
+  }
+  for (auto kernel : kernels_) {
+    std::vector<kernel::LiteKernel *> nodes = {kernel};
+    if (kernel->subgraph_type() != kernel::kNotSubGraph) {
+      nodes = reinterpret_cast<kernel::SubGraphKernel *>(kernel)->nodes();
+    }
+    for (auto node : nodes) {
+      auto ret = node->ResetState();
+      if (ret != RET_OK) {
+        MS_LOG(ERROR) << "ResetState of kernel " << node->name() << " failed";
+        is_running_.store(false);
+        return ret;
+      }
+    }
+  }
+  is_running_.store(false);
+  return RET_OK;
+}
+
+int LiteSession::InitResizePlanCache(Model *model) {
+#ifndef SUPPORT_TRAIN
+  if (context_->resize_cache_size_ <= 0 || !ResizePlanUsable()) {
+    return RET_OK;
+  }
+  resize_plans_ = new (std::nothrow) ResizePlanCache(context_->resize_cache_size_);
+  if (resize_plans_ == nullptr) {
+    MS_LOG(ERROR) << "New resize plan cache failed";
+    return RET_MEMORY_FAILED;
+  }
+  compiled_model_ = model;
+  std::vector<std::vector<int>> dims;
+  for (auto *input : inputs_) {
+    dims.push_back(input->shape());
+  }
+  resize_plans_->Insert(dims, CaptureResizePlan());
+#endif
+  return RET_OK;
+}
+
+bool LiteSession::ResizePlanUsable() const {
+  // a plan only restores shapes, the fp16 and device subgraphs also convert or upload data, tensor lists carry
+  // element tensors
+  for (auto *kernel : kernels_) {
+    if (kernel->subgraph_type() != kernel::kCpuFP32SubGraph) {
+      return false;
+    }
+  }
+  return std::none_of(tensors_.begin(), tensors_.end(),
+                      [](Tensor *tensor) { return tensor->data_type() == kObjectTypeTensorType; });
+}
+
+ResizePlan LiteSession::CaptureResizePlan() const {
+  ResizePlan plan;
+  plan.kernels_ = kernels_;
+  for (auto *tensor : tensors_) {
+    plan.tensor_infos_.push_back({tensor->shape(), tensor->format(), tensor->data_type()});
+  }
+  for (auto *node : compiled_model_->all_nodes_) {
+    plan.infer_flags_.push_back(node->primitive_->infer_flag());
+  }
+  return plan;
+}
+
+void LiteSession::ApplyResizePlan(const ResizePlan &plan) {
+  MS_ASSERT(plan.tensor_infos_.size() == tensors_.size());
+  for (size_t i = 0; i < tensors_.size(); i++) {
+    auto *tensor = tensors_[i];
+    if (tensor->IsConst()) {
+      continue;
+    }
+    tensor->FreeData();
+    tensor->set_shape(plan.tensor_infos_[i].shape_);
+    tensor->set_format(plan.tensor_infos_[i].format_);
+    tensor->set_data_type(plan.tensor_infos_[i].data_type_);
+  }
+  for (size_t i = 0; i < compiled_model_->all_nodes_.size(); i++) {
+    compiled_model_->all_nodes_[i]->primitive_->set_infer_flag(plan.infer_flags_[i]);
+  }
+  kernels_ = plan.kernels_;
+}
+
+int LiteSession::ResizeWithPlanCache(const std::vector<std::vector<int>> &old_dims,
+                                     const std::vector<std::vector<int>> &dims) {
+  auto plan = resize_plans_->Find(dims);
+  if (plan != nullptr) {
+    ApplyResizePlan(*plan);
+    return RET_OK;
+  }
+  if (compiled_model_->buf == nullptr) {
+    MS_LOG(ERROR) << "The model buf is freed, can not schedule kernels for new input shapes.";
+    ResetInputsShape(old_dims);
+    return RET_ERROR;
+  }
+  // schedule kernels sized for the new shapes and keep the current ones for switching back
+  auto old_kernels = kernels_;
+  kernels_.clear();
+  Scheduler scheduler(context_, compiled_model_, tensors_);
+  auto ret = scheduler.Schedule(&kernels_);
+  if (ret == RET_OK) {
+    ret = executor_->Prepare(kernels_);
+  }
+  if (ret == RET_OK) {
+    ret = PrepareKernels(compiled_model_);
+  }
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Schedule kernels for new input shapes failed: " << ret;
+    for (auto *kernel : kernels_) {
+      delete kernel;
+    }
+    ResetInputsShape(old_dims);
+    plan = resize_plans_->Find(old_dims);
+    if (plan != nullptr) {
+      ApplyResizePlan(*plan);
+    } else {
+      kernels_ = old_kernels;
+      (void)ReSizeKernels(kernels_);
+    }
+    return ret;
+  }
+  resize_plans_->Insert(dims, CaptureResizePlan());
+  SaveKernelTuning();
+  return RET_OK;
+}
+
+void LiteSession::SaveKernelTuning() {
+  if (context_->kernel_tuner_ != nullptr && context_->kernel_tuner_->Save() != RET_OK) {
+    MS_LOG(WARNING) << "Save tuning file failed, the ops are timed again on the next load.";
+  }
+}
+
 int LiteSession::InitNPURuntime() {
 #if SUPPORT_NPU
   if (this->context_->IsNpuEnabled()) {
@@ -29,6 +29,7 @@
 #include "src/inner_context.h"
 #include "schema/model_generated.h"
 #include "src/executor.h"
+#include "src/resize_plan_cache.h"
 #include "src/tensor.h"
 #include "src/tensorlist.h"
 #if SUPPORT_GPU
@@ -66,12 +67,19 @@ class LiteSession : public session::LiteSession {
   int Resize(const std::vector<mindspore::tensor::MSTensor *> &inputs,
              const std::vector<std::vector<int>> &dims) override;
 
+  int ResetStates() override;
+
  protected:
   static void ConvertTensorsQuantParam(const schema::Tensor *src_tensor, lite::Tensor *dst_tensor);
 
   int ConvertTensorsData(const lite::Model *model, size_t tensor_index, const schema::Tensor *src_tensor,
                          lite::Tensor *dst_tensor);
 
+  int ConvertPackedWeightData(const lite::Model *model, size_t tensor_index, const schema::Tensor *src_tensor,
+                              lite::Tensor *dst_tensor);
+
+  int ConvertBlockSparseWeightData(size_t tensor_index, const schema::Tensor *src_tensor, lite::Tensor *dst_tensor);
+
   lite::Tensor *ConvertTensor(const schema::Tensor &src_tensor);
 
   int ConvertTensors(const lite::Model *model);
@@ -100,6 +108,18 @@ class LiteSession : public session::LiteSession {
 
   static int ReSizeKernels(const std::vector<kernel::LiteKernel *> &kernels);
 
+  int InitResizePlanCache(Model *model);
+
+  bool ResizePlanUsable() const;
+
+  ResizePlan CaptureResizePlan() const;
+
+  void ApplyResizePlan(const ResizePlan &plan);
+
+  int ResizeWithPlanCache(const std::vector<std::vector<int>> &old_dims, const std::vector<std::vector<int>> &dims);
+
+  void SaveKernelTuning();
+
  private:
   void ResetInputsShape(const std::vector<std::vector<int>> &dims);
 
@@ -112,6 +132,8 @@ class LiteSession : public session::LiteSession {
   std::vector<kernel::LiteKernel *> kernels_;
   std::vector<Tensor *> tensors_;
   std::vector<size_t> copyed_tensor_idxes_;
+  // weights whose data is shared with the other sessions of the model through PackedWeightCache
+  std::vector<size_t> shared_tensor_idxes_;
   // graph input tensors
   std::vector<Tensor *> inputs_;
   // graph output tensors
@@ -128,6 +150,10 @@ class LiteSession : public session::LiteSession {
   std::unordered_map<std::string, mindspore::tensor::MSTensor *> output_tensor_map_;
   Executor *executor_ = nullptr;
   std::atomic<bool> is_running_ = false;
+  // model the kernels are scheduled from, only kept when resize_plans_ is used
+  Model *compiled_model_ = nullptr;
+  // kernels of the input shapes seen by Resize, kernels_ are the ones of the most recently used plan
+  ResizePlanCache *resize_plans_ = nullptr;
 #if SUPPORT_GPU
   opencl::OpenCLRuntimeWrapper ocl_runtime_wrap_;
 #endif
@@ -17,6 +17,7 @@
 #include "include/model.h"
 #include "src/common/log_adapter.h"
 #include "src/model_common.h"
+#include "src/runtime/packed_weight_cache.h"
 
 namespace mindspore::lite {
 Model *Model::Import(const char *model_buf, size_t size) { return ImportFromBuffer(model_buf, size, false); }
@@ -48,5 +49,8 @@ void Model::Destroy() {
   }
 }
 
-Model::~Model() { Destroy(); }
+Model::~Model() {
+  Destroy();
+  PackedWeightCache::GetInstance()->ForgetModel(this);
+}
 }  // namespace mindspore::lite
@@ -0,0 +1,116 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/ops/attention.h"
+
+#ifndef PRIMITIVE_WRITEABLE
+#include "src/ops/ops_register.h"
+#endif
+
+namespace mindspore {
+namespace lite {
+#ifdef PRIMITIVE_WRITEABLE
+float Attention::GetScale() const { return this->primitive_->value.AsAttention()->scale; }
+bool Attention::GetTransposeB() const { return this->primitive_->value.AsAttention()->transposeB; }
+
+void Attention::SetScale(float scale) { this->primitive_->value.AsAttention()->scale = scale; }
+void Attention::SetTransposeB(bool transpose_b) { this->primitive_->value.AsAttention()->transposeB = transpose_b; }
+
+#else
+int Attention::UnPackToFlatBuilder(const schema::Primitive *primitive, flatbuffers::FlatBufferBuilder *fbb) {
+  MS_ASSERT(nullptr != primitive);
+  MS_ASSERT(nullptr != fbb);
+  auto attr = primitive->value_as_Attention();
+  if (attr == nullptr) {
+    MS_LOG(ERROR) << "value_as_Attention return nullptr";
+    return RET_ERROR;
+  }
+  auto val_offset = schema::CreateAttention(*fbb, attr->scale(), attr->transposeB());
+  auto prim_offset = schema::CreatePrimitive(*fbb, schema::PrimitiveType_Attention, val_offset.o);
+  fbb->Finish(prim_offset);
+  return RET_OK;
+}
+float Attention::GetScale() const { return this->primitive_->value_as_Attention()->scale(); }
+bool Attention::GetTransposeB() const { return this->primitive_->value_as_Attention()->transposeB(); }
+PrimitiveC *AttentionCreator(const schema::Primitive *primitive) {
+  return PrimitiveC::NewPrimitiveC<Attention>(primitive);
+}
+Registry AttentionRegistry(schema::PrimitiveType_Attention, AttentionCreator);
+
+#endif
+int Attention::InferShape(std::vector<lite::Tensor *> inputs_, std::vector<lite::Tensor *> outputs_) {
+  if (outputs_.size() != kSingleNum || (inputs_.size() != kMultiNum && inputs_.size() != kMultiNum + 1)) {
+    MS_LOG(ERROR) << "Invalid output/input size! output size: " << outputs_.size() << ",input size: " << inputs_.size();
+    return RET_PARAM_INVALID;
+  }
+  auto query = inputs_.at(0);
+  auto key = inputs_.at(1);
+  auto value = inputs_.at(2);
+  MS_ASSERT(query != nullptr && key != nullptr && value != nullptr);
+  auto output = outputs_.front();
+  MS_ASSERT(output != nullptr);
+  output->set_format(query->format());
+  output->set_data_type(query->data_type());
+  if (!infer_flag()) {
+    return RET_INFER_INVALID;
+  }
+
+  auto q_shape = query->shape();
+  auto k_shape = key->shape();
+  auto v_shape = value->shape();
+  if (q_shape.size() < 2 || k_shape.size() != q_shape.size() || v_shape.size() != q_shape.size()) {
+    MS_LOG(ERROR) << "query, key and value should have the same rank of at least 2";
+    return RET_INPUT_TENSOR_ERROR;
+  }
+  size_t rank = q_shape.size();
+  for (size_t i = 0; i + 2 < rank; ++i) {
+    if (k_shape.at(i) != q_shape.at(i) || v_shape.at(i) != q_shape.at(i)) {
+      MS_LOG(ERROR) << "query, key and value should have the same batch dims";
+      return RET_INPUT_TENSOR_ERROR;
+    }
+  }
+  int head_dim = GetTransposeB() ? k_shape.at(rank - 1) : k_shape.at(rank - 2);
+  int kv_len = GetTransposeB() ? k_shape.at(rank - 2) : k_shape.at(rank - 1);
+  if (head_dim != q_shape.at(rank - 1) || kv_len != v_shape.at(rank - 2)) {
+    MS_LOG(ERROR) << "key shape does not match query and value";
+    return RET_INPUT_TENSOR_ERROR;
+  }
+
+  if (inputs_.size() == kMultiNum + 1) {
+    // the additive mask broadcasts to the score shape [..., q_len, kv_len]
+    auto mask_shape = inputs_.at(3)->shape();
+    auto score_shape = q_shape;
+    score_shape.at(rank - 1) = kv_len;
+    if (mask_shape.empty() || mask_shape.size() > rank || mask_shape.back() != kv_len) {
+      MS_LOG(ERROR) << "mask can not broadcast to the attention score";
+      return RET_INPUT_TENSOR_ERROR;
+    }
+    for (size_t i = 1; i <= mask_shape.size(); ++i) {
+      int dim = mask_shape.at(mask_shape.size() - i);
+      if (dim != 1 && dim != score_shape.at(rank - i)) {
+        MS_LOG(ERROR) << "mask can not broadcast to the attention score";
+        return RET_INPUT_TENSOR_ERROR;
+      }
+    }
+  }
+
+  auto out_shape = q_shape;
+  out_shape.at(rank - 1) = v_shape.at(rank - 1);
+  output->set_shape(out_shape);
+  return RET_OK;
+}
+}  // namespace lite
+}  // namespace mindspore
@@ -0,0 +1,53 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_OPS_ATTENTION_H_
+#define MINDSPORE_LITE_SRC_OPS_ATTENTION_H_
+
+#include <vector>
+#include <set>
+#include <cmath>
+#include <memory>
+
+#include "src/ops/primitive_c.h"
+
+namespace mindspore {
+namespace lite {
+/*
+ * output = softmax(scale * q * k^T + mask) * v over the last two dims, inputs are q, k, v and an optional additive
+ * mask which broadcasts to the score shape. k is [..., kv_len, head_dim] when transposeB is set and
+ * [..., head_dim, kv_len] otherwise.
+ */
+class Attention : public PrimitiveC {
+ public:
+  Attention() = default;
+  ~Attention() = default;
+#ifdef PRIMITIVE_WRITEABLE
+  MS_DECLARE_PARENT(Attention, PrimitiveC);
+  explicit Attention(schema::PrimitiveT *primitive) : PrimitiveC(primitive) {}
+  void SetScale(float scale);
+  void SetTransposeB(bool transpose_b);
+#else
+  int UnPackToFlatBuilder(const schema::Primitive *primitive, flatbuffers::FlatBufferBuilder *fbb) override;
+#endif
+  int InferShape(std::vector<lite::Tensor *> inputs_, std::vector<lite::Tensor *> outputs_) override;
+  float GetScale() const;
+  bool GetTransposeB() const;
+};
+}  // namespace lite
+}  // namespace mindspore
+
+#endif  // MINDSPORE_LITE_SRC_OPS_ATTENTION_H_
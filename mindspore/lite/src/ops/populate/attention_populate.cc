@@ -0,0 +1,40 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/ops/attention.h"
+#include "src/ops/primitive_c.h"
+#include "src/ops/populate/populate_register.h"
+#include "nnacl/attention_parameter.h"
+
+namespace mindspore {
+namespace lite {
+OpParameter *PopulateAttentionParameter(const mindspore::lite::PrimitiveC *primitive) {
+  auto attention_param = reinterpret_cast<AttentionParameter *>(malloc(sizeof(AttentionParameter)));
+  if (attention_param == nullptr) {
+    MS_LOG(ERROR) << "malloc AttentionParameter failed.";
+    return nullptr;
+  }
+  memset(attention_param, 0, sizeof(AttentionParameter));
+  attention_param->op_parameter_.type_ = primitive->Type();
+  auto param = reinterpret_cast<mindspore::lite::Attention *>(const_cast<mindspore::lite::PrimitiveC *>(primitive));
+  attention_param->scale_ = param->GetScale();
+  attention_param->transpose_b_ = param->GetTransposeB();
+  return reinterpret_cast<OpParameter *>(attention_param);
+}
+
+Registry AttentionParameterRegistry(schema::PrimitiveType_Attention, PopulateAttentionParameter);
+}  // namespace lite
+}  // namespace mindspore
@@ -158,6 +158,7 @@
 #include "src/ops/merge.h"
 #include "src/ops/switch.h"
 #include "src/ops/partial.h"
+#include "src/ops/attention.h"
 
 #ifdef SUPPORT_TRAIN
 #include "src/ops/neg_grad.h"
@@ -948,6 +949,8 @@ PrimitiveC *PrimitiveC::Create(mindspore::schema::PrimitiveT *primitive) {
       return new (std::nothrow) Merge(primitive);
     case schema::PrimitiveType_Partial:
       return new (std::nothrow) Partial(primitive);
+    case schema::PrimitiveType_Attention:
+      return new (std::nothrow) Attention(primitive);
 #ifdef SUPPORT_TRAIN
     case schema::PrimitiveType_ActivationGrad:
       return new (std::nothrow) ActivationGrad(primitive);
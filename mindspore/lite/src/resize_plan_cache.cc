@@ -0,0 +1,51 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/resize_plan_cache.h"
+
+namespace mindspore::lite {
+ResizePlanCache::~ResizePlanCache() {
+  for (auto &plan : plans_) {
+    DeleteKernels(&plan.second);
+  }
+  plans_.clear();
+}
+
+void ResizePlanCache::DeleteKernels(ResizePlan *plan) {
+  for (auto *kernel : plan->kernels_) {
+    delete kernel;
+  }
+  plan->kernels_.clear();
+}
+
+ResizePlan *ResizePlanCache::Find(const Signature &signature) {
+  for (auto iter = plans_.begin(); iter != plans_.end(); ++iter) {
+    if (iter->first == signature) {
+      plans_.splice(plans_.begin(), plans_, iter);
+      return &plans_.front().second;
+    }
+  }
+  return nullptr;
+}
+
+void ResizePlanCache::Insert(const Signature &signature, ResizePlan plan) {
+  plans_.emplace_front(signature, std::move(plan));
+  while (plans_.size() > capacity_ && plans_.size() > 1) {
+    DeleteKernels(&plans_.back().second);
+    plans_.pop_back();
+  }
+}
+}  // namespace mindspore::lite
@@ -0,0 +1,70 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RESIZE_PLAN_CACHE_H_
+#define MINDSPORE_LITE_SRC_RESIZE_PLAN_CACHE_H_
+
+#include <list>
+#include <utility>
+#include <vector>
+#include "src/lite_kernel.h"
+#include "src/tensor.h"
+
+namespace mindspore::lite {
+// attributes of a tensor decided by InferShape
+struct TensorShapeInfo {
+  std::vector<int> shape_;
+  schema::Format format_ = schema::Format::Format_NHWC;
+  TypeId data_type_ = kTypeUnknown;
+};
+
+// kernels of a session scheduled for one set of input shapes, with the state InferShape left for them
+struct ResizePlan {
+  std::vector<kernel::LiteKernel *> kernels_;
+  // indexed like the tensors of the session
+  std::vector<TensorShapeInfo> tensor_infos_;
+  // indexed like the nodes of the model
+  std::vector<bool> infer_flags_;
+};
+
+// LRU cache of the resize plans of a session, keyed by the shapes of the graph inputs. It owns the kernels of
+// its plans.
+class ResizePlanCache {
+ public:
+  using Signature = std::vector<std::vector<int>>;
+
+  explicit ResizePlanCache(size_t capacity) : capacity_(capacity) {}
+
+  ~ResizePlanCache();
+
+  // return nullptr if there is no plan for the signature, otherwise the plan becomes the most recently used one
+  ResizePlan *Find(const Signature &signature);
+
+  // add a plan as the most recently used one, the kernels of the plans beyond capacity are deleted
+  void Insert(const Signature &signature, ResizePlan plan);
+
+  size_t size() const { return plans_.size(); }
+
+ private:
+  static void DeleteKernels(ResizePlan *plan);
+
+  size_t capacity_;
+  // the most recently used plan comes first
+  std::list<std::pair<Signature, ResizePlan>> plans_;
+};
+}  // namespace mindspore::lite
+
+#endif  // MINDSPORE_LITE_SRC_RESIZE_PLAN_CACHE_H_
@@ -0,0 +1,141 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/runtime/kernel/arm/base/block_sparse_weight.h"
+#include "include/errorcode.h"
+#include "src/common/log_adapter.h"
+#include "src/runtime/packed_weight_cache.h"
+
+using mindspore::lite::RET_ERROR;
+using mindspore::lite::RET_MEMORY_FAILED;
+using mindspore::lite::RET_OK;
+
+namespace mindspore::kernel {
+namespace {
+void GetMatrixShape(const lite::Tensor *weight, bool deep_major, int *col, int *deep) {
+  auto shape = weight->shape();
+  int total = weight->ElementsNum();
+  if (shape.empty() || shape.front() <= 0 || total <= 0) {
+    *col = 0;
+    *deep = 0;
+    return;
+  }
+  if (deep_major) {
+    *deep = shape.front();
+    *col = total / *deep;
+  } else {
+    *col = shape.front();
+    *deep = total / *col;
+  }
+}
+
+// Point the matrix to the offsets, the indexes and the values laid one after the other in buffer.
+void SetMatrixBuffer(void *buffer, BlockSparseMatrix *matrix) {
+  int row_block_num = UP_DIV(matrix->col_, matrix->block_rows_);
+  matrix->block_offsets_ = reinterpret_cast<int *>(buffer);
+  matrix->block_index_ = matrix->block_offsets_ + row_block_num + 1;
+  matrix->value_ = reinterpret_cast<float *>(matrix->block_index_ + matrix->block_num_);
+}
+}  // namespace
+
+bool BlockSparseWeight::IsSparse(const lite::Tensor *weight) {
+  return weight != nullptr && weight->sparse_block_rows() > 0 && weight->sparse_block_cols() > 0 &&
+         weight->data_type() == kNumberTypeFloat32 && weight->weight_pack_tile() == 0 && weight->data_c() != nullptr;
+}
+
+int BlockSparseWeight::DecodeWeight(lite::Tensor *weight, int block_rows, int block_cols, bool deep_major,
+                                    const std::vector<int> &block_offsets, const std::vector<int> &block_index,
+                                    const void *value, size_t value_size) {
+  MS_ASSERT(weight != nullptr);
+  int col = 0;
+  int deep = 0;
+  GetMatrixShape(weight, deep_major, &col, &deep);
+  if (weight->data_type() != kNumberTypeFloat32 || col <= 0 || block_rows <= 0 ||
+      block_rows > BLOCK_SPARSE_MAX_ROWS || block_cols <= 0) {
+    MS_LOG(ERROR) << "Unsupported block sparse weight, block " << block_rows << "x" << block_cols;
+    return RET_ERROR;
+  }
+  size_t row_block_num = UP_DIV(col, block_rows);
+  if (block_offsets.size() != row_block_num + 1 || block_offsets.front() != 0 ||
+      block_offsets.back() != static_cast<int>(block_index.size()) ||
+      value_size != block_index.size() * block_rows * block_cols * sizeof(float)) {
+    MS_LOG(ERROR) << "Block sparse weight does not match its shape";
+    return RET_ERROR;
+  }
+  for (size_t i = 0; i < row_block_num; i++) {
+    if (block_offsets[i] > block_offsets[i + 1]) {
+      MS_LOG(ERROR) << "Offsets of block sparse weight are not sorted";
+      return RET_ERROR;
+    }
+  }
+  for (auto index : block_index) {
+    if (index < 0 || index >= UP_DIV(deep, block_cols)) {
+      MS_LOG(ERROR) << "Block column " << index << " of block sparse weight is out of range";
+      return RET_ERROR;
+    }
+  }
+  auto ret = weight->MallocData();
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Malloc block sparse weight failed";
+    return RET_MEMORY_FAILED;
+  }
+  // Decode only reads the matrix.
+  BlockSparseMatrix matrix = {col,
+                              deep,
+                              block_rows,
+                              block_cols,
+                              static_cast<int>(block_index.size()),
+                              const_cast<int *>(block_offsets.data()),
+                              const_cast<int *>(block_index.data()),
+                              reinterpret_cast<float *>(const_cast<void *>(value))};
+  BlockSparseDecode(&matrix, deep_major, reinterpret_cast<float *>(weight->data_c()));
+  weight->set_sparse_block(block_rows, block_cols);
+  return RET_OK;
+}
+
+int BlockSparseWeight::Init(const lite::Tensor *weight, int col, int deep, bool deep_major) {
+  MS_ASSERT(IsSparse(weight));
+  Release();
+  BlockSparseMatrix matrix = {0};
+  matrix.col_ = col;
+  matrix.deep_ = deep;
+  matrix.block_rows_ = weight->sparse_block_rows();
+  matrix.block_cols_ = weight->sparse_block_cols();
+  auto src = reinterpret_cast<const float *>(weight->data_c());
+  matrix.block_num_ = BlockSparseCount(src, col, deep, matrix.block_rows_, matrix.block_cols_, deep_major);
+  size_t size = (UP_DIV(col, matrix.block_rows_) + 1 + matrix.block_num_) * sizeof(int) +
+                matrix.block_num_ * matrix.block_rows_ * matrix.block_cols_ * sizeof(float);
+  auto encode = [&](void *dst) {
+    SetMatrixBuffer(dst, &matrix);
+    BlockSparseEncode(src, deep_major, &matrix);
+  };
+  buffer_ = lite::PackedWeightCache::GetInstance()->Acquire(weight, lite::kPackedBlockSparse, size, encode);
+  if (buffer_ == nullptr) {
+    MS_LOG(ERROR) << "Malloc block sparse weight failed, size " << size;
+    return RET_MEMORY_FAILED;
+  }
+  SetMatrixBuffer(buffer_, &matrix);
+  matrix_ = matrix;
+  return RET_OK;
+}
+
+void BlockSparseWeight::Release() {
+  if (buffer_ != nullptr) {
+    lite::PackedWeightCache::GetInstance()->Release(buffer_);
+    buffer_ = nullptr;
+  }
+}
+}  // namespace mindspore::kernel
@@ -0,0 +1,59 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_BLOCK_SPARSE_WEIGHT_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_BLOCK_SPARSE_WEIGHT_H_
+
+#include <vector>
+#include "src/tensor.h"
+#include "nnacl/fp32/block_sparse_fp32.h"
+
+namespace mindspore::kernel {
+// A constant fp32 weight the converter has found block sparse, encoded as BSR for MatMulBlockSparse. The fp32
+// fullconnection, matmul and 1x1 convolution kernels run such a weight without packing it dense. The encoded blocks
+// are shared by the sessions compiled from the same model.
+class BlockSparseWeight {
+ public:
+  BlockSparseWeight() = default;
+  ~BlockSparseWeight() { Release(); }
+
+  // Whether the weight is block sparse and can be encoded.
+  static bool IsSparse(const lite::Tensor *weight);
+
+  // Give the weight the plain data of the blocks stored by the converter and keep its block shape. The weight has no
+  // data yet, deep_major tells the orientation of its plain data.
+  static int DecodeWeight(lite::Tensor *weight, int block_rows, int block_cols, bool deep_major,
+                          const std::vector<int> &block_offsets, const std::vector<int> &block_index,
+                          const void *value, size_t value_size);
+
+  // Encode the [col][deep] view of the weight, whose data is [deep][col] if deep_major is set.
+  int Init(const lite::Tensor *weight, int col, int deep, bool deep_major);
+
+  void Release();
+
+  bool valid() const { return buffer_ != nullptr; }
+
+  const BlockSparseMatrix *matrix() const { return &matrix_; }
+
+  int block_row_num() const { return valid() ? UP_DIV(matrix_.col_, matrix_.block_rows_) : 0; }
+
+ private:
+  void *buffer_ = nullptr;
+  BlockSparseMatrix matrix_ = {0};
+};
+}  // namespace mindspore::kernel
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_BLOCK_SPARSE_WEIGHT_H_
@@ -20,6 +20,7 @@
 #include "include/errorcode.h"
 #include "include/context.h"
 #include "src/runtime/kernel/arm/base/dequant.h"
+#include "src/runtime/kernel_tuner.h"
 
 using mindspore::lite::KernelRegistrar;
 using mindspore::lite::RET_ERROR;
@@ -53,6 +54,26 @@ kernel::LiteKernel *CpuFullConnectionFp32KernelCreator(const std::vector<lite::T
     }
     weight_tensor->set_data(dequant_weight);
   }
+  int thread_count = ctx->thread_num_;
+  if (ctx->kernel_tuner_ != nullptr && primitive != nullptr && primitive->infer_flag() &&
+      weight_tensor->sparse_block_rows() == 0) {
+    auto fc_param = reinterpret_cast<MatMulParameter *>(opParameter);
+    auto key = lite::KernelTuner::MakeKey("FullConnection", inputs, outputs, {fc_param->act_type_}, ctx->thread_num_);
+    thread_count = ctx->kernel_tuner_->Tune(
+      key, lite::KernelTuner::ThreadChoices(ctx->thread_num_), [&](int choice) -> kernel::LiteKernel * {
+        auto *param = lite::KernelTuner::CopyParameter(opParameter, sizeof(MatMulParameter));
+        if (param == nullptr) {
+          return nullptr;
+        }
+        auto *candidate = new (std::nothrow) FullconnectionCPUKernel(param, inputs, outputs, ctx, primitive);
+        if (candidate == nullptr) {
+          free(param);
+          return nullptr;
+        }
+        candidate->set_thread_count(choice);
+        return candidate;
+      });
+  }
   auto kernel = new (std::nothrow) FullconnectionCPUKernel(opParameter, inputs, outputs, ctx, primitive);
   if (!kernel) {
     MS_LOG(ERROR) << "kernel is nullptr.";
@@ -64,6 +85,7 @@ kernel::LiteKernel *CpuFullConnectionFp32KernelCreator(const std::vector<lite::T
     free(opParameter);
     return nullptr;
   }
+  kernel->set_thread_count(thread_count);
   auto ret = kernel->Init();
   if (ret != RET_OK) {
     MS_LOG(ERROR) << "Init kernel failed, name: " << opParameter->name_ << ", type: "
@@ -39,6 +39,10 @@ class FullconnectionBaseCPUKernel : public LiteKernel {
   int ReSize() override { return 0; }
   int Run() override { return 0; }
 
+  // Called before Init to run on fewer threads than the context has, e.g. as picked by lite::KernelTuner.
+  void set_thread_count(int thread_count) { thread_count_ = thread_count; }
+  int thread_count() const { return thread_count_; }
+
  protected:
   MatMulParameter *fc_param_ = nullptr;
   int thread_stride_ = 0;
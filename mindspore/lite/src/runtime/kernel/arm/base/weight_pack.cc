@@ -0,0 +1,113 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "src/runtime/kernel/arm/base/weight_pack.h"
+#include "include/errorcode.h"
+#include "src/common/log_adapter.h"
+#include "nnacl/fp32/matmul_fp32.h"
+#include "src/runtime/packed_weight_cache.h"
+
+using mindspore::lite::RET_ERROR;
+using mindspore::lite::RET_MEMORY_FAILED;
+using mindspore::lite::RET_OK;
+
+namespace mindspore::kernel {
+int WeightPackUtil::ColTile() {
+#ifdef ENABLE_AVX
+  return C16NUM;
+#elif defined(ENABLE_ARM32)
+  return C4NUM;
+#else
+  return C8NUM;
+#endif
+}
+
+bool WeightPackUtil::IsPrepacked(const lite::Tensor *weight) {
+  return weight != nullptr && weight->weight_pack_tile() == ColTile() && weight->data_type() == kNumberTypeFloat32 &&
+         weight->data_c() != nullptr;
+}
+
+void WeightPackUtil::GetPackShape(const lite::Tensor *weight, int *col, int *deep) {
+  MS_ASSERT(weight != nullptr);
+  auto shape = weight->shape();
+  int total = weight->ElementsNum();
+  if (shape.empty() || total <= 0) {
+    *col = 0;
+    *deep = 0;
+    return;
+  }
+  if (weight->weight_pack_deep_major()) {
+    *deep = shape.front();
+    *col = total / *deep;
+  } else {
+    *col = shape.front();
+    *deep = total / *col;
+  }
+}
+
+void WeightPackUtil::Unpack(const lite::Tensor *weight, const void *src, void *dst, bool col_first) {
+  int col = 0;
+  int deep = 0;
+  GetPackShape(weight, &col, &deep);
+  auto src_ptr = reinterpret_cast<const float *>(src);
+  auto dst_ptr = reinterpret_cast<float *>(dst);
+  // Both orientations share the same packed layout, only the plain one differs.
+  if (weight->weight_pack_deep_major() && !col_first) {
+    RowTileMajor2RowMajor(src_ptr, dst_ptr, deep, col, weight->weight_pack_tile());
+  } else {
+    ColTileMajor2RowMajor(src_ptr, dst_ptr, col, deep, weight->weight_pack_tile());
+  }
+}
+
+int WeightPackUtil::UnpackWeight(lite::Tensor *weight, const void *packed) {
+  MS_ASSERT(weight != nullptr);
+  if (packed == nullptr || weight->weight_pack_tile() <= 0) {
+    MS_LOG(ERROR) << "Weight " << weight->ToString() << " is not packed.";
+    return RET_ERROR;
+  }
+  int col = 0;
+  int deep = 0;
+  GetPackShape(weight, &col, &deep);
+  size_t size = col * deep * sizeof(float);
+  auto allocator = weight->allocator();
+  auto plain = allocator == nullptr ? malloc(size) : allocator->Malloc(size);
+  if (plain == nullptr) {
+    MS_LOG(ERROR) << "Malloc unpacked weight failed, size " << size;
+    return RET_MEMORY_FAILED;
+  }
+  Unpack(weight, packed, plain);
+  weight->set_weight_pack(0, false);
+  weight->set_data(plain);
+  return RET_OK;
+}
+
+int WeightPackUtil::UnpackWeight(lite::Tensor *weight) {
+  MS_ASSERT(weight != nullptr);
+  if (weight->weight_pack_tile() == 0) {
+    return RET_OK;
+  }
+  auto packed = weight->data_c();
+  weight->set_data(nullptr);
+  auto ret = UnpackWeight(weight, packed);
+  if (ret != RET_OK) {
+    weight->set_data(packed);
+    return ret;
+  }
+  // The packed data may be shared by the sessions of the model.
+  auto allocator = weight->allocator();
+  allocator == nullptr ? lite::PackedWeightCache::GetInstance()->Release(packed) : allocator->Free(packed);
+  return RET_OK;
+}
+}  // namespace mindspore::kernel
@@ -0,0 +1,47 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_WEIGHT_PACK_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_WEIGHT_PACK_H_
+
+#include "src/tensor.h"
+
+namespace mindspore::kernel {
+// Helpers for the fp32 weights the converter packs offline (see schema::WeightPack). The fp32 matmul, fullconnection
+// and convolution kernels use such a weight in place when it is packed with the tile of this build.
+class WeightPackUtil {
+ public:
+  // Tile of the output channels the fp32 matmul and convolution kernels of this build pack their weights with.
+  static int ColTile();
+
+  // Whether the weight is packed with the layout the fp32 kernels of this build use.
+  static bool IsPrepacked(const lite::Tensor *weight);
+
+  // Get the [col][deep] view of a packed weight.
+  static void GetPackShape(const lite::Tensor *weight, int *col, int *deep);
+
+  // Write the plain data of a packed weight to dst. If col_first is set, dst is [col][deep] even if the weight is
+  // deep major.
+  static void Unpack(const lite::Tensor *weight, const void *src, void *dst, bool col_first = false);
+
+  // Give the weight the plain data of packed. The weight has no data yet.
+  static int UnpackWeight(lite::Tensor *weight, const void *packed);
+
+  // Restore the plain layout of a packed weight in place.
+  static int UnpackWeight(lite::Tensor *weight);
+};
+}  // namespace mindspore::kernel
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_WEIGHT_PACK_H_
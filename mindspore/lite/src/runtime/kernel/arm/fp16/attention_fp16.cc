@@ -0,0 +1,123 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "src/runtime/kernel/arm/fp16/attention_fp16.h"
+#include "src/runtime/kernel/arm/fp16/common_fp16.h"
+#include "nnacl/fp16/attention_fp16.h"
+#include "nnacl/fp16/cast_fp16.h"
+#include "src/kernel_registry.h"
+
+using mindspore::kernel::KERNEL_ARCH::kCPU;
+using mindspore::lite::KernelRegistrar;
+using mindspore::lite::RET_ERROR;
+using mindspore::lite::RET_OK;
+using mindspore::schema::PrimitiveType_Attention;
+
+namespace mindspore::kernel {
+int AttentionFp16CPUKernel::Run() {
+  inputs_fp16_.assign(in_tensors_.size(), nullptr);
+  for (size_t i = 0; i < in_tensors_.size(); ++i) {
+    inputs_fp16_.at(i) = ConvertInputFp32toFp16(in_tensors_.at(i), context_);
+    if (inputs_fp16_.at(i) == nullptr) {
+      FreeInputAndOutput();
+      MS_LOG(ERROR) << "input is nullptr";
+      return RET_ERROR;
+    }
+  }
+  auto output_tensor = out_tensors_.at(0);
+  output_fp16_ = MallocOutputFp16(output_tensor, context_);
+  if (output_fp16_ == nullptr) {
+    FreeInputAndOutput();
+    MS_LOG(ERROR) << "output is nullptr";
+    return RET_ERROR;
+  }
+
+  auto ret = RunTiles();
+  if (ret == RET_OK && output_tensor->data_type() == kNumberTypeFloat32) {
+    Float16ToFloat32(output_fp16_, reinterpret_cast<float *>(output_tensor->MutableData()),
+                     output_tensor->ElementsNum());
+  }
+  FreeInputAndOutput();
+  return ret;
+}
+
+int AttentionFp16CPUKernel::DoExecute(int task_id) {
+  auto q = inputs_fp16_.at(0);
+  auto k = inputs_fp16_.at(1);
+  auto v = inputs_fp16_.at(2);
+  auto mask = has_mask() ? inputs_fp16_.at(kMaskIndex) : nullptr;
+  auto buffer = buffer_ + task_id * AttentionBufferSize(param_);
+  int q_size = param_->q_len_ * param_->head_dim_;
+  int k_size = param_->kv_len_ * param_->head_dim_;
+  int v_size = param_->kv_len_ * param_->v_head_dim_;
+  int out_size = param_->q_len_ * param_->v_head_dim_;
+  int start = 0;
+  int end = 0;
+  TaskUnitRange(task_id, &start, &end);
+  for (int unit = start; unit < end; ++unit) {
+    int b = unit / row_block_num_;
+    int row_start = (unit % row_block_num_) * ATTENTION_ROW_BLOCK;
+    int row_end = MSMIN(row_start + ATTENTION_ROW_BLOCK, param_->q_len_);
+    auto ret = AttentionFp16(q + b * q_size, k + b * k_size, v + b * v_size,
+                             mask == nullptr ? nullptr : mask + mask_offsets_.at(b), output_fp16_ + b * out_size,
+                             buffer, row_start, row_end, param_);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "AttentionFp16 error error_code[" << ret << "]";
+      return ret;
+    }
+  }
+  return RET_OK;
+}
+
+void AttentionFp16CPUKernel::FreeInputAndOutput() {
+  for (size_t i = 0; i < inputs_fp16_.size(); ++i) {
+    if (in_tensors_.at(i)->data_type() == kNumberTypeFloat32 && inputs_fp16_.at(i) != nullptr) {
+      context_->allocator->Free(inputs_fp16_.at(i));
+    }
+  }
+  inputs_fp16_.clear();
+  if (out_tensors_.at(0)->data_type() == kNumberTypeFloat32 && output_fp16_ != nullptr) {
+    context_->allocator->Free(output_fp16_);
+  }
+  output_fp16_ = nullptr;
+}
+
+kernel::LiteKernel *CpuAttentionFp16KernelCreator(const std::vector<lite::Tensor *> &inputs,
+                                                  const std::vector<lite::Tensor *> &outputs, OpParameter *opParameter,
+                                                  const lite::InnerContext *ctx, const kernel::KernelKey &desc,
+                                                  const mindspore::lite::PrimitiveC *primitive) {
+  if (opParameter == nullptr) {
+    MS_LOG(ERROR) << "Input opParameter is nullptr!";
+    return nullptr;
+  }
+  MS_ASSERT(desc.type == schema::PrimitiveType_Attention);
+  auto *kernel = new (std::nothrow) AttentionFp16CPUKernel(opParameter, inputs, outputs, ctx, primitive);
+  if (kernel == nullptr) {
+    MS_LOG(ERROR) << "new AttentionFp16CPUKernel fail!";
+    free(opParameter);
+    return nullptr;
+  }
+  auto ret = kernel->Init();
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Init kernel failed, name: " << opParameter->name_ << ", type: "
+                  << schema::EnumNamePrimitiveType(static_cast<schema::PrimitiveType>(opParameter->type_));
+    delete kernel;
+    return nullptr;
+  }
+  return kernel;
+}
+
+REG_KERNEL(kCPU, kNumberTypeFloat16, PrimitiveType_Attention, CpuAttentionFp16KernelCreator)
+}  // namespace mindspore::kernel
@@ -0,0 +1,170 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "src/runtime/kernel/arm/fp32/attention_fp32.h"
+#include <vector>
+#include "schema/model_generated.h"
+#include "src/kernel_registry.h"
+#include "src/runtime/runtime_api.h"
+#include "include/errorcode.h"
+
+using mindspore::kernel::KERNEL_ARCH::kCPU;
+using mindspore::lite::KernelRegistrar;
+using mindspore::lite::RET_ERROR;
+using mindspore::lite::RET_OK;
+using mindspore::schema::PrimitiveType_Attention;
+
+namespace mindspore::kernel {
+int AttentionCPUKernel::Init() {
+  if (!InferShapeDone()) {
+    return RET_OK;
+  }
+  return ReSize();
+}
+
+int AttentionCPUKernel::ReSize() {
+  auto q_shape = in_tensors_.at(0)->shape();
+  auto v_shape = in_tensors_.at(2)->shape();
+  int rank = static_cast<int>(q_shape.size());
+  param_->batch_ = 1;
+  for (int i = 0; i < rank - 2; ++i) {
+    param_->batch_ *= q_shape.at(i);
+  }
+  param_->q_len_ = q_shape.at(rank - 2);
+  param_->head_dim_ = q_shape.at(rank - 1);
+  param_->kv_len_ = v_shape.at(rank - 2);
+  param_->v_head_dim_ = v_shape.at(rank - 1);
+
+  param_->mask_row_stride_ = 0;
+  mask_offsets_.clear();
+  if (has_mask()) {
+    auto mask_shape = in_tensors_.at(kMaskIndex)->shape();
+    std::vector<int> shape(rank - mask_shape.size(), 1);
+    shape.insert(shape.end(), mask_shape.begin(), mask_shape.end());
+    std::vector<int> strides(rank, 0);
+    int stride = 1;
+    for (int i = rank - 1; i >= 0; --i) {
+      strides.at(i) = shape.at(i) == 1 ? 0 : stride;
+      stride *= shape.at(i);
+    }
+    param_->mask_row_stride_ = strides.at(rank - 2);
+    mask_offsets_.resize(param_->batch_);
+    for (int b = 0; b < param_->batch_; ++b) {
+      int rest = b;
+      int offset = 0;
+      for (int i = rank - 3; i >= 0; --i) {
+        offset += (rest % q_shape.at(i)) * strides.at(i);
+        rest /= q_shape.at(i);
+      }
+      mask_offsets_.at(b) = offset;
+    }
+  }
+
+  row_block_num_ = UP_DIV(param_->q_len_, ATTENTION_ROW_BLOCK);
+  thread_count_ = MSMAX(1, MSMIN(context_->thread_num_, param_->batch_ * row_block_num_));
+  return RET_OK;
+}
+
+void AttentionCPUKernel::TaskUnitRange(int task_id, int *start, int *end) const {
+  int unit_num = param_->batch_ * row_block_num_;
+  int unit_per_task = UP_DIV(unit_num, thread_count_);
+  *start = task_id * unit_per_task;
+  *end = MSMIN(unit_num, *start + unit_per_task);
+}
+
+int AttentionCPUKernel::DoExecute(int task_id) {
+  auto q = reinterpret_cast<float *>(in_tensors_.at(0)->data_c());
+  auto k = reinterpret_cast<float *>(in_tensors_.at(1)->data_c());
+  auto v = reinterpret_cast<float *>(in_tensors_.at(2)->data_c());
+  auto mask = has_mask() ? reinterpret_cast<float *>(in_tensors_.at(kMaskIndex)->data_c()) : nullptr;
+  auto out = reinterpret_cast<float *>(out_tensors_.at(0)->data_c());
+  auto buffer = buffer_ + task_id * AttentionBufferSize(param_);
+  int q_size = param_->q_len_ * param_->head_dim_;
+  int k_size = param_->kv_len_ * param_->head_dim_;
+  int v_size = param_->kv_len_ * param_->v_head_dim_;
+  int out_size = param_->q_len_ * param_->v_head_dim_;
+  int start = 0;
+  int end = 0;
+  TaskUnitRange(task_id, &start, &end);
+  for (int unit = start; unit < end; ++unit) {
+    int b = unit / row_block_num_;
+    int row_start = (unit % row_block_num_) * ATTENTION_ROW_BLOCK;
+    int row_end = MSMIN(row_start + ATTENTION_ROW_BLOCK, param_->q_len_);
+    auto ret = AttentionFp32(q + b * q_size, k + b * k_size, v + b * v_size,
+                             mask == nullptr ? nullptr : mask + mask_offsets_.at(b), out + b * out_size, buffer,
+                             row_start, row_end, param_);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "AttentionFp32 error error_code[" << ret << "]";
+      return ret;
+    }
+  }
+  return RET_OK;
+}
+
+int AttentionRun(void *cdata, int task_id) {
+  auto kernel = reinterpret_cast<AttentionCPUKernel *>(cdata);
+  auto ret = kernel->DoExecute(task_id);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "AttentionRun error task_id[" << task_id << "] error_code[" << ret << "]";
+    return RET_ERROR;
+  }
+  return RET_OK;
+}
+
+int AttentionCPUKernel::RunTiles() {
+  buffer_ = reinterpret_cast<float *>(
+    context_->allocator->Malloc(thread_count_ * AttentionBufferSize(param_) * sizeof(float)));
+  if (buffer_ == nullptr) {
+    MS_LOG(ERROR) << "malloc attention buffer failed.";
+    return RET_ERROR;
+  }
+  auto ret = ParallelLaunch(this->context_->thread_pool_, AttentionRun, this, thread_count_);
+  context_->allocator->Free(buffer_);
+  buffer_ = nullptr;
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "AttentionRun error error_code[" << ret << "]";
+  }
+  return ret;
+}
+
+int AttentionCPUKernel::Run() { return RunTiles(); }
+
+kernel::LiteKernel *CpuAttentionFp32KernelCreator(const std::vector<lite::Tensor *> &inputs,
+                                                  const std::vector<lite::Tensor *> &outputs, OpParameter *opParameter,
+                                                  const lite::InnerContext *ctx, const kernel::KernelKey &desc,
+                                                  const mindspore::lite::PrimitiveC *primitive) {
+  if (opParameter == nullptr) {
+    MS_LOG(ERROR) << "Create kernel failed, opParameter is nullptr, type: PrimitiveType_Attention. ";
+    return nullptr;
+  }
+  MS_ASSERT(desc.type == schema::PrimitiveType_Attention);
+  auto *kernel = new (std::nothrow) AttentionCPUKernel(opParameter, inputs, outputs, ctx, primitive);
+  if (kernel == nullptr) {
+    MS_LOG(ERROR) << "new AttentionCPUKernel fail!";
+    free(opParameter);
+    return nullptr;
+  }
+  auto ret = kernel->Init();
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Init kernel failed, name: " << opParameter->name_ << ", type: "
+                  << schema::EnumNamePrimitiveType(static_cast<schema::PrimitiveType>(opParameter->type_));
+    delete kernel;
+    return nullptr;
+  }
+  return kernel;
+}
+
+REG_KERNEL(kCPU, kNumberTypeFloat32, PrimitiveType_Attention, CpuAttentionFp32KernelCreator)
+}  // namespace mindspore::kernel
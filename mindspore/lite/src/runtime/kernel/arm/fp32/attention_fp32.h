@@ -0,0 +1,61 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_ATTENTION_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_ATTENTION_H_
+
+#include <vector>
+#include "src/lite_kernel.h"
+#include "include/context.h"
+#include "nnacl/fp32/attention_fp32.h"
+
+using mindspore::lite::InnerContext;
+
+namespace mindspore::kernel {
+class AttentionCPUKernel : public LiteKernel {
+ public:
+  AttentionCPUKernel(OpParameter *parameter, const std::vector<lite::Tensor *> &inputs,
+                     const std::vector<lite::Tensor *> &outputs, const lite::InnerContext *ctx,
+                     const mindspore::lite::PrimitiveC *primitive)
+      : LiteKernel(parameter, inputs, outputs, ctx, primitive) {
+    param_ = reinterpret_cast<AttentionParameter *>(parameter);
+  }
+  ~AttentionCPUKernel() override = default;
+
+  int Init() override;
+  int ReSize() override;
+  int Run() override;
+  virtual int DoExecute(int task_id);
+
+ protected:
+  // launches thread_count_ tasks, each with its own tile buffer
+  int RunTiles();
+  // the (batch, row block) units of a task are [*start, *end)
+  void TaskUnitRange(int task_id, int *start, int *end) const;
+  bool has_mask() const { return in_tensors_.size() > kMaskIndex; }
+
+  static constexpr size_t kMaskIndex = 3;
+  AttentionParameter *param_ = nullptr;
+  // offset of the mask of each batch, the mask broadcasts to [batch, q_len, kv_len]
+  std::vector<int> mask_offsets_;
+  int row_block_num_ = 0;
+  int thread_count_ = 1;
+  float *buffer_ = nullptr;
+};
+
+int AttentionRun(void *cdata, int task_id);
+}  // namespace mindspore::kernel
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_ATTENTION_H_
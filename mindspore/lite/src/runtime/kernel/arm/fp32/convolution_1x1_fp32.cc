@@ -16,6 +16,7 @@
 
 #include "src/runtime/kernel/arm/fp32/convolution_1x1_fp32.h"
 #include "src/runtime/runtime_api.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
 
 using mindspore::lite::RET_ERROR;
 using mindspore::lite::RET_MEMORY_FAILED;
@@ -24,8 +25,8 @@ using mindspore::lite::RET_OK;
 namespace mindspore::kernel {
 Convolution1x1CPUKernel::~Convolution1x1CPUKernel() {
   FreeTmpBuffer();
-  if (weight_ptr_ != nullptr) {
-    free(weight_ptr_);
+  if (weight_ptr_ != nullptr && !weight_prepacked_) {
+    lite::PackedWeightCache::GetInstance()->Release(weight_ptr_);
     weight_ptr_ = nullptr;
   }
   if (matmul_param_ != nullptr) {
@@ -91,24 +92,33 @@ int Convolution1x1CPUKernel::InitConv1x1BiasWeight() {
     memset(reinterpret_cast<char *>(bias_data_) + weight_size, 0, size - weight_size);
   }
 
-  int size = input_channel * UP_ROUND(output_channel, col_tile) * sizeof(float);
-  int down_size = input_channel * DOWN_DIV(output_channel, col_tile) * col_tile * sizeof(float);
-  weight_ptr_ = reinterpret_cast<float *>(malloc(size));
-  if (weight_ptr_ == nullptr) {
-    MS_LOG(ERROR) << "Conv1x1 Malloc weight_ptr_ error!";
-    return RET_ERROR;
+  if (BlockSparseWeight::IsSparse(filter_tensor)) {
+    return sparse_weight_.Init(filter_tensor, output_channel, input_channel, false);
   }
-  memset(reinterpret_cast<char *>(weight_ptr_) + down_size, 0, size - down_size);
+  if (WeightPackUtil::IsPrepacked(filter_tensor)) {
+    weight_ptr_ = reinterpret_cast<float *>(filter_tensor->data_c());
+    weight_prepacked_ = true;
+    return RET_OK;
+  }
+  int size = input_channel * UP_ROUND(output_channel, col_tile) * sizeof(float);
+  auto pack = [&](void *dst) {
 #ifdef ENABLE_AVX
-  RowMajor2Col16Major(reinterpret_cast<float *>(filter_tensor->MutableData()), weight_ptr_, output_channel,
-                      input_channel);
+    RowMajor2Col16Major(reinterpret_cast<float *>(filter_tensor->MutableData()), reinterpret_cast<float *>(dst),
+                        output_channel, input_channel);
 #elif defined(ENABLE_ARM32)
-  RowMajor2Col4Major(reinterpret_cast<float *>(filter_tensor->MutableData()), weight_ptr_, output_channel,
-                     input_channel);
+    RowMajor2Col4Major(reinterpret_cast<float *>(filter_tensor->MutableData()), reinterpret_cast<float *>(dst),
+                       output_channel, input_channel);
 #else
-  RowMajor2Col8Major(reinterpret_cast<float *>(filter_tensor->MutableData()), weight_ptr_, output_channel,
-                     input_channel);
+    RowMajor2Col8Major(reinterpret_cast<float *>(filter_tensor->MutableData()), reinterpret_cast<float *>(dst),
+                       output_channel, input_channel);
 #endif
+  };
+  weight_ptr_ = reinterpret_cast<float *>(
+    lite::PackedWeightCache::GetInstance()->Acquire(filter_tensor, lite::kPackedColTile, size, pack));
+  if (weight_ptr_ == nullptr) {
+    MS_LOG(ERROR) << "Conv1x1 Malloc weight_ptr_ error!";
+    return RET_ERROR;
+  }
   return RET_OK;
 }
 
@@ -119,7 +129,12 @@ int Convolution1x1CPUKernel::InitConv1x1Param() {
 #elif defined(ENABLE_SSE)
   hw_tile = C4NUM;
 #endif
-  if ((matmul_param_->row_ > (hw_tile * op_parameter_->thread_num_)) && (matmul_param_->row_ > matmul_param_->col_)) {
+  if (sparse_weight_.valid()) {
+    multi_thread_by_hw_ = false;
+    thread_count_ = MSMIN(op_parameter_->thread_num_, sparse_weight_.block_row_num());
+    thread_stride_ = UP_DIV(sparse_weight_.block_row_num(), thread_count_);
+  } else if ((matmul_param_->row_ > (hw_tile * op_parameter_->thread_num_)) &&
+             (matmul_param_->row_ > matmul_param_->col_)) {
     multi_thread_by_hw_ = true;
     thread_count_ = MSMIN(op_parameter_->thread_num_, UP_DIV(matmul_param_->row_, hw_tile));
     thread_stride_ = UP_DIV(UP_DIV(matmul_param_->row_, hw_tile), thread_count_) * hw_tile;
@@ -168,6 +183,15 @@ int Convolution1x1CPUKernel::Init() {
 }
 
 int Convolution1x1CPUKernel::DoConv1x1(int task_id) {
+  if (sparse_weight_.valid()) {
+    int start = task_id * thread_stride_;
+    int end = MSMIN(start + thread_stride_, sparse_weight_.block_row_num());
+    if (start < end) {
+      MatMulBlockSparse(input_ptr_, sparse_weight_.matrix(), reinterpret_cast<float *>(bias_data_), output_ptr_,
+                        matmul_param_->act_type_, matmul_param_->row_, start, end);
+    }
+    return RET_OK;
+  }
   int res_stride = matmul_param_->col_ - task_id * thread_stride_;
   int cur_oc = MSMIN(thread_stride_, res_stride);
   if (cur_oc <= 0) {
@@ -225,7 +249,30 @@ int Convolution1x1RunHw(void *cdata, int task_id) {
   return RET_OK;
 }
 
+int Convolution1x1CPUKernel::RunSparse() {
+  auto src_in = reinterpret_cast<float *>(in_tensors_[0]->MutableData());
+  auto src_out = reinterpret_cast<float *>(out_tensors_[0]->MutableData());
+  for (int batch_index = 0; batch_index < conv_param_->input_batch_; batch_index++) {
+    output_ptr_ = src_out + batch_index * matmul_param_->row_ * matmul_param_->col_;
+    auto tmp_in = src_in + batch_index * conv_param_->input_h_ * conv_param_->input_w_ * conv_param_->input_channel_;
+    if (pre_trans_input_) {
+      Conv1x1InputPack(tmp_in, input_ptr_, conv_param_, sizeof(float));
+    } else {
+      input_ptr_ = tmp_in;
+    }
+    auto ret = ParallelLaunch(this->context_->thread_pool_, Convolution1x1Run, this, thread_count_);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "Conv1x1 block sparse run failed";
+      return ret;
+    }
+  }
+  return RET_OK;
+}
+
 int Convolution1x1CPUKernel::Run() {
+  if (sparse_weight_.valid()) {
+    return RunSparse();
+  }
   auto src_in = reinterpret_cast<float *>(in_tensors_[0]->MutableData());
   auto src_out = reinterpret_cast<float *>(out_tensors_[0]->MutableData());
 
@@ -24,6 +24,8 @@
 #include "nnacl/op_base.h"
 #include "nnacl/winograd_transform.h"
 #include "src/runtime/kernel/arm/base/convolution_base.h"
+#include "src/runtime/packed_weight_cache.h"
+#include "src/runtime/kernel/arm/base/block_sparse_weight.h"
 #include "src/runtime/kernel/arm/base/layout_transform.h"
 #include "nnacl/fp32/conv_fp32.h"
 #include "nnacl/fp32/common_func_fp32.h"
@@ -51,6 +53,7 @@ class Convolution1x1CPUKernel : public ConvolutionBaseCPUKernel {
   int InitConv1x1BiasWeight();
   void InitConv1x1MatmulParam();
   void FreeTmpBuffer();
+  int RunSparse();
 
  private:
   MatMulParameter *matmul_param_ = nullptr;
@@ -59,9 +62,12 @@ class Convolution1x1CPUKernel : public ConvolutionBaseCPUKernel {
   int thread_count_ = 0;
   int thread_stride_ = 0;
   float *weight_ptr_ = nullptr;
+  bool weight_prepacked_ = false;
   float *pack_input_ = nullptr;
   float *input_ptr_ = nullptr;
   float *output_ptr_ = nullptr;
+  // The weight when it is block sparse, weight_ptr_ is then not used and the input is not packed.
+  BlockSparseWeight sparse_weight_;
 };
 }  // namespace mindspore::kernel
 #endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_CONVOLUTION_1X1_H_
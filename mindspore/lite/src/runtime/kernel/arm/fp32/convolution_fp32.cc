@@ -25,6 +25,8 @@
 #include "include/errorcode.h"
 #include "src/runtime/runtime_api.h"
 #include "src/runtime/kernel/arm/base/dequant.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
+#include "src/runtime/kernel_tuner.h"
 
 using mindspore::kernel::KERNEL_ARCH::kCPU;
 using mindspore::lite::KernelRegistrar;
@@ -53,19 +55,26 @@ int ConvolutionCPUKernel::InitWeightBias() {
   int pack_weight_size = oc_block_num * in_channel * kernel_plane;
 
   auto origin_weight = reinterpret_cast<float *>(filter_tensor->data_c());
-  packed_weight_ = reinterpret_cast<float *>(malloc(pack_weight_size * sizeof(float)));
-  if (packed_weight_ == nullptr) {
-    MS_LOG(ERROR) << "malloc packed weight failed.";
-    return RET_ERROR;
-  }
-  memset(packed_weight_, 0, pack_weight_size * sizeof(float));
+  if (WeightPackUtil::IsPrepacked(filter_tensor)) {
+    packed_weight_ = origin_weight;
+    weight_prepacked_ = true;
+  } else {
+    auto pack = [&](void *dst) {
 #ifdef ENABLE_AVX
-  RowMajor2Col16Major(origin_weight, packed_weight_, out_channel, in_channel * kernel_plane);
+      RowMajor2Col16Major(origin_weight, reinterpret_cast<float *>(dst), out_channel, in_channel * kernel_plane);
 #elif ENABLE_ARM32
-  RowMajor2Col4Major(origin_weight, packed_weight_, out_channel, in_channel * kernel_plane);
+      RowMajor2Col4Major(origin_weight, reinterpret_cast<float *>(dst), out_channel, in_channel * kernel_plane);
 #else
-  RowMajor2Col8Major(origin_weight, packed_weight_, out_channel, in_channel * kernel_plane);
+      RowMajor2Col8Major(origin_weight, reinterpret_cast<float *>(dst), out_channel, in_channel * kernel_plane);
 #endif
+    };
+    packed_weight_ = reinterpret_cast<float *>(lite::PackedWeightCache::GetInstance()->Acquire(
+      filter_tensor, lite::kPackedColTile, pack_weight_size * sizeof(float), pack));
+    if (packed_weight_ == nullptr) {
+      MS_LOG(ERROR) << "malloc packed weight failed.";
+      return RET_ERROR;
+    }
+  }
 
   bias_data_ = reinterpret_cast<float *>(malloc(oc_block_num * sizeof(float)));
   if (bias_data_ == nullptr) {
@@ -289,6 +298,68 @@ kernel::LiteKernel *CpuConvFp32KernelSelect(const std::vector<lite::Tensor *> &i
   return nullptr;
 }
 
+namespace {
+// Convolution algorithms tuned by KernelTuner: the output unit of winograd, 1 for the common convolution as
+// SelectOutputUnit does, and 0 for the 1x1 convolution.
+constexpr int kConv1x1Choice = 0;
+constexpr int kConvCommonChoice = 1;
+
+kernel::LiteKernel *CpuConvFp32KernelCreateChoice(const std::vector<lite::Tensor *> &inputs,
+                                                  const std::vector<lite::Tensor *> &outputs, OpParameter *op_parameter,
+                                                  const InnerContext *ctx, const mindspore::lite::PrimitiveC *primitive,
+                                                  int choice) {
+  if (choice == kConv1x1Choice) {
+    return new (std::nothrow) kernel::Convolution1x1CPUKernel(op_parameter, inputs, outputs, ctx, primitive);
+  } else if (choice == kConvCommonChoice) {
+    return new (std::nothrow) kernel::ConvolutionCPUKernel(op_parameter, inputs, outputs, ctx, primitive);
+  }
+  return new (std::nothrow) kernel::ConvolutionWinogradCPUKernel(op_parameter, inputs, outputs, ctx, primitive, choice);
+}
+
+bool ConvFp32Tunable(const std::vector<lite::Tensor *> &inputs, const InnerContext *ctx,
+                     const mindspore::lite::PrimitiveC *primitive) {
+  // Weights packed or sparsified by the converter already fix the algorithm.
+  auto *weight_tensor = inputs.at(kWeightIndex);
+  return ctx->kernel_tuner_ != nullptr && primitive != nullptr && primitive->infer_flag() &&
+         weight_tensor->data_c() != nullptr && weight_tensor->data_type() == kNumberTypeFloat32 &&
+         weight_tensor->weight_pack_tile() == 0 && weight_tensor->sparse_block_rows() == 0;
+}
+
+int TuneConvFp32Algorithm(const std::vector<lite::Tensor *> &inputs, const std::vector<lite::Tensor *> &outputs,
+                          OpParameter *op_parameter, const InnerContext *ctx,
+                          const mindspore::lite::PrimitiveC *primitive, int default_choice) {
+  auto conv_param = reinterpret_cast<ConvParameter *>(op_parameter);
+  std::vector<int> choices = {default_choice};
+  if (default_choice != kConvCommonChoice) {
+    choices.push_back(kConvCommonChoice);
+  }
+  int units[MAX_UNIT - MIN_UNIT + 1];
+  int unit_num = WinogradOutputUnits(conv_param, units);
+  for (int i = 0; i < unit_num; i++) {
+    if (units[i] != default_choice) {
+      choices.push_back(units[i]);
+    }
+  }
+  auto key = lite::KernelTuner::MakeKey(
+    "Conv2D", inputs, outputs,
+    {conv_param->kernel_h_, conv_param->kernel_w_, conv_param->stride_h_, conv_param->stride_w_,
+     conv_param->dilation_h_, conv_param->dilation_w_, conv_param->pad_u_, conv_param->pad_d_, conv_param->pad_l_,
+     conv_param->pad_r_, conv_param->act_type_},
+    ctx->thread_num_);
+  return ctx->kernel_tuner_->Tune(key, choices, [&](int choice) -> kernel::LiteKernel * {
+    auto *param = lite::KernelTuner::CopyParameter(op_parameter, sizeof(ConvParameter));
+    if (param == nullptr) {
+      return nullptr;
+    }
+    auto *kernel = CpuConvFp32KernelCreateChoice(inputs, outputs, param, ctx, primitive, choice);
+    if (kernel == nullptr) {
+      free(param);
+    }
+    return kernel;
+  });
+}
+}  // namespace
+
 kernel::LiteKernel *CpuGroupConvFp32KernelCreator(const std::vector<lite::Tensor *> &inputs,
                                                   const std::vector<lite::Tensor *> &outputs, OpParameter *op_parameter,
                                                   const InnerContext *ctx, const mindspore::lite::PrimitiveC *primitive,
@@ -414,6 +485,15 @@ kernel::LiteKernel *CpuConvFp32KernelCreator(const std::vector<lite::Tensor *> &
   }
 
   auto *weight_tensor = inputs.at(kWeightIndex);
+  // Only the 1x1 and the common convolution use the weight packed by the converter.
+  bool plain_weight = group != 1 || (use_winograd && (conv_param->kernel_h_ != 1 || conv_param->kernel_w_ != 1));
+  if (plain_weight && weight_tensor->weight_pack_tile() != 0) {
+    if (kernel::WeightPackUtil::UnpackWeight(weight_tensor) != RET_OK) {
+      MS_LOG(ERROR) << "Unpack weight failed.";
+      free(op_parameter);
+      return nullptr;
+    }
+  }
   auto *restore_data = weight_tensor->data_c();
   auto restore_type = weight_tensor->data_type();
   bool dequant_flag =
@@ -429,7 +509,16 @@ kernel::LiteKernel *CpuConvFp32KernelCreator(const std::vector<lite::Tensor *> &
   }
 
   kernel::LiteKernel *kernel;
-  if (group == 1) {
+  if (group == 1 && ConvFp32Tunable(inputs, ctx, primitive)) {
+    int choice = kConvCommonChoice;
+    if (conv_param->kernel_h_ == 1 && conv_param->kernel_w_ == 1) {
+      choice = kConv1x1Choice;
+    } else if (use_winograd) {
+      choice = out_unit;
+    }
+    choice = TuneConvFp32Algorithm(inputs, outputs, op_parameter, ctx, primitive, choice);
+    kernel = CpuConvFp32KernelCreateChoice(inputs, outputs, op_parameter, ctx, primitive, choice);
+  } else if (group == 1) {
     kernel = CpuConvFp32KernelSelect(inputs, outputs, op_parameter, ctx, primitive, use_winograd, out_unit);
   } else {
     kernel = CpuGroupConvFp32KernelCreator(inputs, outputs, op_parameter, ctx, primitive, group);
@@ -21,6 +21,7 @@
 #include "src/lite_kernel.h"
 #include "nnacl/op_base.h"
 #include "src/runtime/kernel/arm/base/convolution_base.h"
+#include "src/runtime/packed_weight_cache.h"
 #include "nnacl/fp32/conv_fp32.h"
 
 namespace mindspore::kernel {
@@ -31,8 +32,8 @@ class ConvolutionCPUKernel : public ConvolutionBaseCPUKernel {
                        const mindspore::lite::PrimitiveC *primitive)
       : ConvolutionBaseCPUKernel(parameter, inputs, outputs, ctx, primitive) {}
   ~ConvolutionCPUKernel() override {
-    if (packed_weight_ != nullptr) {
-      free(packed_weight_);
+    if (packed_weight_ != nullptr && !weight_prepacked_) {
+      lite::PackedWeightCache::GetInstance()->Release(packed_weight_);
       packed_weight_ = nullptr;
     }
   }
@@ -58,6 +59,8 @@ class ConvolutionCPUKernel : public ConvolutionBaseCPUKernel {
 
  protected:
   float *packed_weight_ = nullptr;
+  // packed_weight_ points into the weight tensor the converter has already packed.
+  bool weight_prepacked_ = false;
   float *packed_input_ = nullptr;
   float *col_major_input_ = nullptr;
 };
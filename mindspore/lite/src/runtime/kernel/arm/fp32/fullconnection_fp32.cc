@@ -16,6 +16,7 @@
 
 #include "src/runtime/kernel/arm/fp32/fullconnection_fp32.h"
 #include "src/runtime/runtime_api.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
 using mindspore::lite::RET_ERROR;
 using mindspore::lite::RET_MEMORY_FAILED;
 using mindspore::lite::RET_OK;
@@ -32,7 +33,7 @@ void FullconnectionCPUKernel::FreeBuf() {
     a_pack_ptr_ = nullptr;
   }
   if (b_pack_ptr_ != nullptr) {
-    free(b_pack_ptr_);
+    lite::PackedWeightCache::GetInstance()->Release(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
   if (bias_ptr_ != nullptr) {
@@ -50,6 +51,9 @@ int FullconnectionCPUKernel::ReSize() {
   fc_param_->row_ = row;
   fc_param_->col_ = out_tensors_.at(0)->shape().back();
   fc_param_->deep_ = (in_tensors_.at(1)->shape()).at(1);
+  if (BlockSparseWeight::IsSparse(in_tensors_.at(1))) {
+    return InitSparseWeight();
+  }
 
 #ifdef ENABLE_AVX
   int col_tile = C16NUM;
@@ -96,27 +100,61 @@ int FullconnectionCPUKernel::ReSize() {
   }
   memset(a_pack_ptr_, 0, row_tmp * fc_param_->deep_ * sizeof(float));
 
-  int col_tmp = is_vector_input_ ? fc_param_->col_ : fc_param_->col_align_;
-  b_pack_ptr_ = reinterpret_cast<float *>(malloc(col_tmp * fc_param_->deep_ * sizeof(float)));
-  if (b_pack_ptr_ == nullptr) {
-    FreeBuf();
-    return RET_MEMORY_FAILED;
-  }
-  memset(b_pack_ptr_, 0, col_tmp * fc_param_->deep_ * sizeof(float));
-
   fc_param_->a_const_ = (in_tensors_.at(0)->data_c() != nullptr);
   fc_param_->b_const_ = (in_tensors_.at(1)->data_c() != nullptr);
   if (fc_param_->a_const_) {
     InitMatrixA(reinterpret_cast<float *>(in_tensors_.at(0)->MutableData()), a_pack_ptr_);
     a_ptr_ = a_pack_ptr_;
   }
-  if (fc_param_->b_const_) {
-    InitMatrixB(reinterpret_cast<float *>(in_tensors_.at(1)->MutableData()), b_pack_ptr_);
+
+  auto b_tensor = in_tensors_.at(1);
+  int col_tmp = is_vector_input_ ? fc_param_->col_ : fc_param_->col_align_;
+  size_t b_size = col_tmp * fc_param_->deep_ * sizeof(float);
+  bool b_prepacked = WeightPackUtil::IsPrepacked(b_tensor);
+  if (b_prepacked && !is_vector_input_) {
+    // A weight packed by the converter is used in place, except by the vector kernel that wants it plain.
+    b_ptr_ = reinterpret_cast<float *>(b_tensor->data_c());
+  } else if (fc_param_->b_const_) {
+    auto pack = [&](void *dst) {
+      if (b_prepacked) {
+        WeightPackUtil::Unpack(b_tensor, b_tensor->data_c(), dst, true);
+      } else {
+        InitMatrixB(reinterpret_cast<float *>(b_tensor->data_c()), reinterpret_cast<float *>(dst));
+      }
+    };
+    auto format = is_vector_input_ ? lite::kPackedColMajor : lite::kPackedColTile;
+    b_pack_ptr_ =
+      reinterpret_cast<float *>(lite::PackedWeightCache::GetInstance()->Acquire(b_tensor, format, b_size, pack));
+    if (b_pack_ptr_ == nullptr) {
+      FreeBuf();
+      return RET_MEMORY_FAILED;
+    }
     b_ptr_ = b_pack_ptr_;
+  } else {
+    b_pack_ptr_ = reinterpret_cast<float *>(malloc(b_size));
+    if (b_pack_ptr_ == nullptr) {
+      FreeBuf();
+      return RET_MEMORY_FAILED;
+    }
+    memset(b_pack_ptr_, 0, b_size);
   }
   return RET_OK;
 }
 
+int FullconnectionCPUKernel::InitSparseWeight() {
+  // The weight is constant, so its encoding outlives the resizes.
+  if (!sparse_weight_.valid()) {
+    auto ret = sparse_weight_.Init(in_tensors_.at(1), fc_param_->col_, fc_param_->deep_, false);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "Init block sparse weight failed";
+      return ret;
+    }
+  }
+  thread_count_ = MSMIN(ctx_->thread_num_, sparse_weight_.block_row_num());
+  thread_stride_ = UP_DIV(sparse_weight_.block_row_num(), thread_count_);
+  return RET_OK;
+}
+
 int FullconnectionCPUKernel::Init() {
   if (!InferShapeDone()) {
     return RET_OK;
@@ -164,6 +202,16 @@ int FcFp32MatmulRun(void *cdata, int task_id) {
 }
 
 int FullconnectionCPUKernel::DoMatmul(int task_id) {
+  if (sparse_weight_.valid()) {
+    int start = task_id * thread_stride_;
+    int end = MSMIN(start + thread_stride_, sparse_weight_.block_row_num());
+    if (start < end) {
+      auto bias = in_tensors_.size() == 3 ? reinterpret_cast<float *>(in_tensors_[2]->data_c()) : nullptr;
+      MatMulBlockSparse(a_ptr_, sparse_weight_.matrix(), bias, c_ptr_, fc_param_->act_type_, fc_param_->row_, start,
+                        end);
+    }
+    return RET_OK;
+  }
 #ifdef ENABLE_AVX
   int col_tile = C16NUM;
 #elif defined(ENABLE_ARM32)
@@ -193,6 +241,10 @@ int FullconnectionCPUKernel::Run() {
   auto a_ptr = reinterpret_cast<float *>(in_tensors_.at(0)->data_c());
   auto b_ptr = reinterpret_cast<float *>(in_tensors_.at(1)->data_c());
   c_ptr_ = reinterpret_cast<float *>(out_tensors_.at(0)->data_c());
+  if (sparse_weight_.valid()) {
+    a_ptr_ = a_ptr;
+    return ParallelLaunch(this->context_->thread_pool_, FcFp32MatmulRun, this, thread_count_);
+  }
 
   if (!fc_param_->a_const_) {
     if (is_vector_input_) {
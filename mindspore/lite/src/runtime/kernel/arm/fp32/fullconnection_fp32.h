@@ -22,6 +22,8 @@
 #include "include/context.h"
 #include "include/errorcode.h"
 #include "nnacl/fp32/matmul_fp32.h"
+#include "src/runtime/packed_weight_cache.h"
+#include "src/runtime/kernel/arm/base/block_sparse_weight.h"
 
 using mindspore::lite::InnerContext;
 
@@ -45,6 +47,7 @@ class FullconnectionCPUKernel : public FullconnectionBaseCPUKernel {
  private:
   void InitMatrixA(const float *src_ptr, float *dst_ptr);
   void InitMatrixB(const float *src_ptr, float *dst_ptr);
+  int InitSparseWeight();
 
  private:
   float *a_pack_ptr_ = nullptr;
@@ -54,6 +57,8 @@ class FullconnectionCPUKernel : public FullconnectionBaseCPUKernel {
   float *a_ptr_ = nullptr;
   float *b_ptr_ = nullptr;
   bool is_vector_input_ = false;
+  // The weight when it is block sparse, a and c are then used as they are and there is no pack buffer.
+  BlockSparseWeight sparse_weight_;
 };
 }  // namespace mindspore::kernel
 #endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_FULLCONNECTION_H_
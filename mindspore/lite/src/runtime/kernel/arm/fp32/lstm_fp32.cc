@@ -18,20 +18,80 @@
 #include <vector>
 #include "schema/model_generated.h"
 #include "src/kernel_registry.h"
+#include "src/runtime/runtime_api.h"
+#include "nnacl/fp32/matmul_fp32.h"
 #include "include/errorcode.h"
 
 using mindspore::kernel::KERNEL_ARCH::kCPU;
 using mindspore::lite::KernelRegistrar;
 using mindspore::lite::RET_ERROR;
+using mindspore::lite::RET_NOT_SUPPORT;
 using mindspore::lite::RET_OK;
 using mindspore::schema::PrimitiveType_Lstm;
 
 namespace mindspore::kernel {
+namespace {
+#ifdef ENABLE_AVX
+constexpr int kRowTile = C6NUM;
+constexpr int kColTile = C16NUM;
+#elif defined(ENABLE_SSE)
+constexpr int kRowTile = C4NUM;
+constexpr int kColTile = C8NUM;
+#elif defined(ENABLE_ARM32)
+constexpr int kRowTile = C12NUM;
+constexpr int kColTile = C4NUM;
+#else
+constexpr int kRowTile = C12NUM;
+constexpr int kColTile = C8NUM;
+#endif
+
+void PackInputMatrix(const float *src_ptr, float *dst_ptr, int row, int deep) {
+#ifdef ENABLE_AVX
+  RowMajor2Col6Major(src_ptr, dst_ptr, row, deep);
+#elif defined(ENABLE_SSE)
+  RowMajor2Col4Major(src_ptr, dst_ptr, row, deep);
+#else
+  RowMajor2Col12Major(src_ptr, dst_ptr, row, deep);
+#endif
+}
+
+void PackInputWeight(const float *src_ptr, float *dst_ptr, int col, int deep) {
+#ifdef ENABLE_AVX
+  RowMajor2Col16Major(src_ptr, dst_ptr, col, deep);
+#elif defined(ENABLE_ARM32)
+  RowMajor2Col4Major(src_ptr, dst_ptr, col, deep);
+#else
+  RowMajor2Col8Major(src_ptr, dst_ptr, col, deep);
+#endif
+}
+
+int LstmInputMatMulRun(void *cdata, int task_id) {
+  auto kernel = reinterpret_cast<LstmCPUKernel *>(cdata);
+  auto error_code = kernel->DoInputMatMul(task_id);
+  if (error_code != RET_OK) {
+    MS_LOG(ERROR) << "LstmInputMatMulRun error task_id[" << task_id << "] error_code[" << error_code << "]";
+    return RET_ERROR;
+  }
+  return RET_OK;
+}
+}  // namespace
+
 void LstmCPUKernel::FreeTmpBuffer() {
   if (gate_buffer_ != nullptr) {
     free(gate_buffer_);
     gate_buffer_ = nullptr;
   }
+  if (input_gate_ != nullptr) {
+    free(input_gate_);
+    input_gate_ = nullptr;
+  }
+  if (input_pack_ != nullptr) {
+    free(input_pack_);
+    input_pack_ = nullptr;
+  }
+}
+
+void LstmCPUKernel::FreeWeightBias() {
   if (weight_i_ptr_ != nullptr) {
     free(weight_i_ptr_);
     weight_i_ptr_ = nullptr;
@@ -46,6 +106,19 @@ void LstmCPUKernel::FreeTmpBuffer() {
   }
 }
 
+void LstmCPUKernel::FreeState() {
+  if (hidden_state_ != nullptr) {
+    free(hidden_state_);
+    hidden_state_ = nullptr;
+  }
+  if (cell_state_ != nullptr) {
+    free(cell_state_);
+    cell_state_ = nullptr;
+  }
+  state_size_ = 0;
+  state_valid_ = false;
+}
+
 int LstmCPUKernel::InitParam() {
   auto input = in_tensors_.front();
   MS_ASSERT(input != nullptr);
@@ -62,6 +135,13 @@ int LstmCPUKernel::InitParam() {
   lstm_parm_->input_step_ = lstm_parm_->batch_ * lstm_parm_->input_size_;
   lstm_parm_->output_step_ = lstm_parm_->bidirectional_ ? 2 * lstm_parm_->batch_ * lstm_parm_->hidden_size_
                                                         : lstm_parm_->batch_ * lstm_parm_->hidden_size_;
+
+  // the input projection of all steps is one matmul, [seq_len * batch, input_size] * [input_size, 4 * hidden_size]
+  row_ = lstm_parm_->seq_len_ * lstm_parm_->batch_;
+  col_ = 4 * lstm_parm_->hidden_size_;
+  col_align_ = UP_ROUND(col_, kColTile);
+  thread_count_ = MSMIN(op_parameter_->thread_num_, UP_DIV(col_align_, kColTile));
+  thread_stride_ = UP_DIV(UP_DIV(col_align_, kColTile), thread_count_);
   return RET_OK;
 }
 
@@ -71,53 +151,105 @@ int LstmCPUKernel::InitBuffer() {
     MS_LOG(ERROR) << "LstmCPUKernel malloc gate_buffer error.";
     return RET_ERROR;
   }
+  input_gate_ = reinterpret_cast<float *>(malloc(row_ * col_ * sizeof(float)));
+  if (input_gate_ == nullptr) {
+    MS_LOG(ERROR) << "LstmCPUKernel malloc input_gate error.";
+    return RET_ERROR;
+  }
+  int pack_size = UP_ROUND(row_, kRowTile) * lstm_parm_->input_size_;
+  input_pack_ = reinterpret_cast<float *>(malloc(pack_size * sizeof(float)));
+  if (input_pack_ == nullptr) {
+    MS_LOG(ERROR) << "LstmCPUKernel malloc input_pack error.";
+    return RET_ERROR;
+  }
+  memset(input_pack_, 0, pack_size * sizeof(float));
   return RET_OK;
 }
 
 int LstmCPUKernel::InitWeightBias() {
-  // copy weight_i and weight_h
+  int dir_num = lstm_parm_->bidirectional_ ? 2 : 1;
+  int hidden_size = lstm_parm_->hidden_size_;
+  int input_size = lstm_parm_->input_size_;
+  // pack weight_i for the input projection and weight_h for the recurrent product, once per direction
   auto weight_i = in_tensors_.at(1);
   MS_ASSERT(weight_i != nullptr);
-  weight_i_ptr_ = reinterpret_cast<float *>(malloc(weight_i->ElementsNum() * sizeof(float)));
+  weight_i_ptr_ = reinterpret_cast<float *>(malloc(dir_num * col_align_ * input_size * sizeof(float)));
   if (weight_i_ptr_ == nullptr) {
     MS_LOG(ERROR) << "LstmCPUKernel malloc weight_i_ptr_ error.";
     return RET_ERROR;
   }
-  memcpy(weight_i_ptr_, weight_i->MutableData(), weight_i->ElementsNum() * sizeof(float));
+  memset(weight_i_ptr_, 0, dir_num * col_align_ * input_size * sizeof(float));
+  auto weight_i_data = reinterpret_cast<float *>(weight_i->MutableData());
+  for (int i = 0; i < dir_num; i++) {
+    PackInputWeight(weight_i_data + i * col_ * input_size, weight_i_ptr_ + i * col_align_ * input_size, col_,
+                    input_size);
+  }
 
   auto weight_h = in_tensors_.at(2);
   MS_ASSERT(weight_h != nullptr);
-  weight_h_ptr_ = reinterpret_cast<float *>(malloc(weight_h->ElementsNum() * sizeof(float)));
+  int weight_h_size = UP_ROUND(col_, C4NUM) * hidden_size;
+  weight_h_ptr_ = reinterpret_cast<float *>(malloc(dir_num * weight_h_size * sizeof(float)));
   if (weight_h_ptr_ == nullptr) {
     MS_LOG(ERROR) << "LstmCPUKernel malloc weight_h_ error.";
     return RET_ERROR;
   }
-  memcpy(weight_h_ptr_, weight_h->MutableData(), weight_h->ElementsNum() * sizeof(float));
+  auto weight_h_data = reinterpret_cast<float *>(weight_h->MutableData());
+  for (int i = 0; i < dir_num; i++) {
+    PackLstmStateWeight(weight_h_ptr_ + i * weight_h_size, weight_h_data + i * col_ * hidden_size, hidden_size);
+  }
 
-  // init bias
-  int bias_num = lstm_parm_->bidirectional_ ? 2 * 4 * lstm_parm_->hidden_size_ : 4 * lstm_parm_->hidden_size_;
-  bias_ptr_ = reinterpret_cast<float *>(malloc(bias_num * sizeof(float)));
+  // init bias, the input bias and the state bias are added up
+  bias_ptr_ = reinterpret_cast<float *>(malloc(dir_num * col_align_ * sizeof(float)));
   if (bias_ptr_ == nullptr) {
     MS_LOG(ERROR) << "LstmCPUKernel malloc bias_ptr_ error.";
     return RET_ERROR;
   }
-
+  memset(bias_ptr_, 0, dir_num * col_align_ * sizeof(float));
   auto bias_data = reinterpret_cast<float *>(in_tensors_.at(3)->MutableData());
-  const int state_bias_offset = 4 * lstm_parm_->hidden_size_;
-  for (int i = 0; i < state_bias_offset; i++) {
-    bias_ptr_[i] = bias_data[i] + bias_data[i + state_bias_offset];
-  }
-  if (lstm_parm_->bidirectional_) {
-    bias_data += 4 * lstm_parm_->hidden_size_ * 2;
-    auto backward_bias = bias_ptr_ + 4 * lstm_parm_->hidden_size_;
-    for (int i = 0; i < state_bias_offset; i++) {
-      backward_bias[i] = bias_data[i] + bias_data[i + state_bias_offset];
+  for (int i = 0; i < dir_num; i++) {
+    auto dir_bias = bias_ptr_ + i * col_align_;
+    auto dir_bias_data = bias_data + i * 2 * col_;
+    for (int j = 0; j < col_; j++) {
+      dir_bias[j] = dir_bias_data[j] + dir_bias_data[j + col_];
     }
   }
   return RET_OK;
 }
 
+int LstmCPUKernel::InitState() {
+  if (!context_->keep_rnn_states_) {
+    return RET_OK;
+  }
+  int state_size = in_tensors_.at(4)->ElementsNum();
+  if (state_size == state_size_) {
+    return RET_OK;
+  }
+  FreeState();
+  hidden_state_ = reinterpret_cast<float *>(malloc(state_size * sizeof(float)));
+  cell_state_ = reinterpret_cast<float *>(malloc(state_size * sizeof(float)));
+  if (hidden_state_ == nullptr || cell_state_ == nullptr) {
+    MS_LOG(ERROR) << "LstmCPUKernel malloc state error.";
+    FreeState();
+    return RET_ERROR;
+  }
+  state_size_ = state_size;
+  return RET_OK;
+}
+
+int LstmCPUKernel::CheckParam() const {
+  // the backward direction starts from the end of the sequence, it cannot go on from the states of the last chunk
+  if (lstm_parm_->bidirectional_ && context_->keep_rnn_states_) {
+    MS_LOG(ERROR) << "LstmCPUKernel can not keep the states of a bidirectional lstm between runs.";
+    return RET_NOT_SUPPORT;
+  }
+  return RET_OK;
+}
+
 int LstmCPUKernel::Init() {
+  auto ret = CheckParam();
+  if (ret != RET_OK) {
+    return ret;
+  }
   if (!InferShapeDone()) {
     return RET_OK;
   }
@@ -125,29 +257,60 @@ int LstmCPUKernel::Init() {
 }
 
 int LstmCPUKernel::ReSize() {
+  auto ret = CheckParam();
+  if (ret != RET_OK) {
+    return ret;
+  }
   FreeTmpBuffer();
-  auto ret = InitParam();
+  ret = InitParam();
   if (ret != RET_OK) {
     MS_LOG(ERROR) << "LstmCPUKernel InitParam error.";
     return RET_ERROR;
   }
 
-  ret = InitWeightBias();
+  // the weights do not depend on the input shape, a resize of the sequence keeps them packed
+  if (weight_i_ptr_ == nullptr) {
+    ret = InitWeightBias();
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "LstmCPUKernel InitWeightBias error.";
+      FreeWeightBias();
+      return RET_ERROR;
+    }
+  }
+
+  ret = InitBuffer();
   if (ret != RET_OK) {
-    MS_LOG(ERROR) << "LstmCPUKernel InitWeightBias error.";
+    MS_LOG(ERROR) << "LstmCPUKernel InitBuffer error.";
     FreeTmpBuffer();
     return RET_ERROR;
   }
 
-  ret = InitBuffer();
+  ret = InitState();
   if (ret != RET_OK) {
-    MS_LOG(ERROR) << "LstmCPUKernel InitBuffer error.";
+    MS_LOG(ERROR) << "LstmCPUKernel InitState error.";
     FreeTmpBuffer();
     return RET_ERROR;
   }
   return RET_OK;
 }
 
+int LstmCPUKernel::ResetState() {
+  state_valid_ = false;
+  return RET_OK;
+}
+
+int LstmCPUKernel::DoInputMatMul(int task_id) {
+  int cur_oc = MSMIN(thread_stride_ * kColTile, col_ - task_id * thread_stride_ * kColTile);
+  if (cur_oc <= 0) {
+    return RET_OK;
+  }
+  auto b = cur_weight_i_ + task_id * thread_stride_ * kColTile * lstm_parm_->input_size_;
+  auto bias = cur_bias_ + task_id * thread_stride_ * kColTile;
+  auto c = input_gate_ + task_id * thread_stride_ * kColTile;
+  MatMulOpt(input_pack_, b, c, bias, ActType_No, lstm_parm_->input_size_, row_, cur_oc, col_, OutType_Nhwc);
+  return RET_OK;
+}
+
 int LstmCPUKernel::Run() {
   auto input = in_tensors_.at(kInputIndex);
   MS_ASSERT(input != nullptr);
@@ -163,17 +326,52 @@ int LstmCPUKernel::Run() {
   auto output_ptr = reinterpret_cast<float *>(output->MutableData());
   MS_ASSERT(output_ptr);
   auto output_hidden_state = out_tensors_[1];
-  memcpy(output_hidden_state->MutableData(), hidden_state->MutableData(), hidden_state->ElementsNum() * sizeof(float));
   auto output_cell_state = out_tensors_[2];
-  memcpy(output_cell_state->MutableData(), cell_state->MutableData(), cell_state->ElementsNum() * sizeof(float));
+  size_t state_bytes = hidden_state->ElementsNum() * sizeof(float);
+  float *hidden_state_ptr = nullptr;
+  float *cell_state_ptr = nullptr;
+  if (context_->keep_rnn_states_) {
+    // the state inputs are only read by the first run after a reset, later runs go on from the kept states
+    if (!state_valid_) {
+      memcpy(hidden_state_, hidden_state->MutableData(), state_bytes);
+      memcpy(cell_state_, cell_state->MutableData(), state_bytes);
+      state_valid_ = true;
+    }
+    hidden_state_ptr = hidden_state_;
+    cell_state_ptr = cell_state_;
+  } else {
+    memcpy(output_hidden_state->MutableData(), hidden_state->MutableData(), state_bytes);
+    memcpy(output_cell_state->MutableData(), cell_state->MutableData(), state_bytes);
+    hidden_state_ptr = reinterpret_cast<float *>(output_hidden_state->MutableData());
+    cell_state_ptr = reinterpret_cast<float *>(output_cell_state->MutableData());
+  }
 
   MS_ASSERT(weight_h_ptr_);
   MS_ASSERT(weight_i_ptr_);
   MS_ASSERT(bias_ptr_);
   MS_ASSERT(gate_buffer_);
-  Lstm(output_ptr, input_ptr, weight_i_ptr_, weight_h_ptr_, bias_ptr_,
-       reinterpret_cast<float *>(output_hidden_state->MutableData()),
-       reinterpret_cast<float *>(output_cell_state->MutableData()), gate_buffer_, lstm_parm_);
+  // the input matrix is shared by both directions, it is packed once
+  PackInputMatrix(input_ptr, input_pack_, row_, lstm_parm_->input_size_);
+  int dir_num = lstm_parm_->bidirectional_ ? 2 : 1;
+  int state_offset = lstm_parm_->batch_ * lstm_parm_->hidden_size_;
+  int weight_h_size = UP_ROUND(col_, C4NUM) * lstm_parm_->hidden_size_;
+  for (int i = 0; i < dir_num; i++) {
+    cur_weight_i_ = weight_i_ptr_ + i * col_align_ * lstm_parm_->input_size_;
+    cur_bias_ = bias_ptr_ + i * col_align_;
+    auto ret = ParallelLaunch(this->context_->thread_pool_, LstmInputMatMulRun, this, thread_count_);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "LstmCPUKernel input matmul error.";
+      return RET_ERROR;
+    }
+    LstmUnidirectional(output_ptr + i * state_offset, input_gate_, weight_h_ptr_ + i * weight_h_size,
+                       hidden_state_ptr + i * state_offset, cell_state_ptr + i * state_offset, gate_buffer_,
+                       lstm_parm_, i == 1);
+  }
+
+  if (context_->keep_rnn_states_) {
+    memcpy(output_hidden_state->MutableData(), hidden_state_, state_bytes);
+    memcpy(output_cell_state->MutableData(), cell_state_, state_bytes);
+  }
   return RET_OK;
 }
 
@@ -31,22 +31,48 @@ class LstmCPUKernel : public LiteKernel {
     lstm_parm_ = reinterpret_cast<LstmParameter *>(op_parameter_);
   }
 
-  ~LstmCPUKernel() override { FreeTmpBuffer(); }
+  ~LstmCPUKernel() override {
+    FreeTmpBuffer();
+    FreeWeightBias();
+    FreeState();
+  }
 
   int Init() override;
   int ReSize() override;
   int Run() override;
+  int ResetState() override;
+  int DoInputMatMul(int task_id);
 
  private:
+  int CheckParam() const;
   void FreeTmpBuffer();
+  void FreeWeightBias();
+  void FreeState();
   int InitParam();
   int InitBuffer();
   int InitWeightBias();
+  int InitState();
 
   float *gate_buffer_ = nullptr;
+  // input projection plus bias of every step of one direction, [seq_len, batch, 4 * hidden_size]
+  float *input_gate_ = nullptr;
+  float *input_pack_ = nullptr;
+  // weights of every direction, weight_i packed for MatMulOpt and weight_h by PackLstmStateWeight
   float *weight_i_ptr_ = nullptr;
   float *weight_h_ptr_ = nullptr;
   float *bias_ptr_ = nullptr;
+  const float *cur_weight_i_ = nullptr;
+  const float *cur_bias_ = nullptr;
+  int row_ = 0;
+  int col_ = 0;
+  int col_align_ = 0;
+  int thread_count_ = 1;
+  int thread_stride_ = 0;
+  // hidden and cell states kept between runs when the context keeps rnn states
+  float *hidden_state_ = nullptr;
+  float *cell_state_ = nullptr;
+  int state_size_ = 0;
+  bool state_valid_ = false;
   LstmParameter *lstm_parm_ = nullptr;
 };
 }  // namespace mindspore::kernel
@@ -20,6 +20,8 @@
 #include "src/runtime/runtime_api.h"
 #include "src/kernel_registry.h"
 #include "src/runtime/kernel/arm/base/dequant.h"
+#include "src/runtime/kernel_tuner.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
 
 using mindspore::lite::RET_ERROR;
 using mindspore::lite::RET_INPUT_TENSOR_ERROR;
@@ -37,7 +39,7 @@ MatmulCPUKernel::~MatmulCPUKernel() {
     a_pack_ptr_ = nullptr;
   }
   if (b_pack_ptr_ != nullptr) {
-    free(b_pack_ptr_);
+    lite::PackedWeightCache::GetInstance()->Release(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
   if (bias_ptr_ != nullptr) {
@@ -52,7 +54,8 @@ void MatmulCPUKernel::FreeTmpBuffer() {
     a_pack_ptr_ = nullptr;
   }
   if (b_pack_ptr_ != nullptr) {
-    params_->b_const_ ? free(b_pack_ptr_) : context_->allocator->Free(b_pack_ptr_);
+    params_->b_const_ ? lite::PackedWeightCache::GetInstance()->Release(b_pack_ptr_)
+                      : context_->allocator->Free(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
 }
@@ -112,9 +115,27 @@ int MatmulCPUKernel::MallocMatrixBBuffer() {
   params_->col_align_ = UP_ROUND(params_->col_, col_tile_);
   params_->deep_ = params_->b_transpose_ ? b_shape[b_shape.size() - 1] : b_shape[b_shape.size() - 2];
 
+  thread_count_ = MSMIN(thread_count_, UP_DIV(params_->col_align_, col_tile_));
+  thread_stride_ = UP_DIV(UP_DIV(params_->col_align_, col_tile_), thread_count_);
+  if (b_prepacked_) {
+    return RET_OK;
+  }
+
   int col_tmp = is_vector_a_ ? params_->col_ : params_->col_align_;
   if (params_->b_const_) {
-    b_pack_ptr_ = reinterpret_cast<float *>(malloc(params_->batch * col_tmp * params_->deep_ * sizeof(float)));
+    // A constant B is packed once and shared with the sessions compiled from the same model.
+    auto b_tensor = in_tensors_.at(1);
+    auto pack = [&](void *dst) {
+      InitMatrixB(reinterpret_cast<float *>(b_tensor->data_c()), reinterpret_cast<float *>(dst));
+    };
+    lite::PackedWeightFormat format;
+    if (is_vector_a_) {
+      format = params_->b_transpose_ ? lite::kPackedColMajor : lite::kPackedColMajorDeepMajor;
+    } else {
+      format = params_->b_transpose_ ? lite::kPackedColTile : lite::kPackedColTileDeepMajor;
+    }
+    b_pack_ptr_ = reinterpret_cast<float *>(lite::PackedWeightCache::GetInstance()->Acquire(
+      b_tensor, format, params_->batch * col_tmp * params_->deep_ * sizeof(float), pack));
   } else {
     b_pack_ptr_ =
       reinterpret_cast<float *>(context_->allocator->Malloc(params_->batch * col_tmp * params_->deep_ * sizeof(float)));
@@ -123,9 +144,6 @@ int MatmulCPUKernel::MallocMatrixBBuffer() {
     FreeTmpBuffer();
     return RET_MEMORY_FAILED;
   }
-
-  thread_count_ = MSMIN(thread_count_, UP_DIV(params_->col_align_, col_tile_));
-  thread_stride_ = UP_DIV(UP_DIV(params_->col_align_, col_tile_), thread_count_);
   return RET_OK;
 }
 
@@ -256,13 +274,24 @@ int MatmulCPUKernel::Init() {
     a_ptr_ = a_pack_ptr_;
   }
   if (params_->b_const_) {
+    auto b_tensor = in_tensors_.at(1);
+    if (BlockSparseWeight::IsSparse(b_tensor) && b_tensor->shape().size() == 2 && !params_->a_transpose_) {
+      return InitSparseWeight();
+    }
+    if (b_tensor->weight_pack_tile() != 0 && (is_vector_a_ || !WeightPackUtil::IsPrepacked(b_tensor))) {
+      auto ret = WeightPackUtil::UnpackWeight(b_tensor);
+      if (ret != RET_OK) {
+        MS_LOG(ERROR) << "Matmul fp32 unpack matrix B failed";
+        return RET_ERROR;
+      }
+    }
+    b_prepacked_ = WeightPackUtil::IsPrepacked(b_tensor);
     auto ret = MallocMatrixBBuffer();
     if (ret != RET_OK) {
       MS_LOG(ERROR) << "Matmul fp32 malloc matrix B buffer failed";
       return RET_ERROR;
     }
-    InitMatrixB(reinterpret_cast<float *>(in_tensors_.at(1)->data_c()), b_pack_ptr_);
-    b_ptr_ = b_pack_ptr_;
+    b_ptr_ = b_prepacked_ ? reinterpret_cast<float *>(b_tensor->data_c()) : b_pack_ptr_;
     // init bias
     ret = InitBias();
     if (ret != RET_OK) {
@@ -273,7 +302,30 @@ int MatmulCPUKernel::Init() {
   return RET_OK;
 }
 
+int MatmulCPUKernel::InitSparseWeight() {
+  auto b_shape = in_tensors_.at(1)->shape();
+  params_->col_ = params_->b_transpose_ ? b_shape[0] : b_shape[1];
+  params_->deep_ = params_->b_transpose_ ? b_shape[1] : b_shape[0];
+  auto ret = sparse_weight_.Init(in_tensors_.at(1), params_->col_, params_->deep_, !params_->b_transpose_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Matmul fp32 init block sparse weight failed";
+    return ret;
+  }
+  thread_count_ = MSMIN(context_->thread_num_, sparse_weight_.block_row_num());
+  thread_stride_ = UP_DIV(sparse_weight_.block_row_num(), thread_count_);
+  return RET_OK;
+}
+
 int MatmulCPUKernel::RunImpl(int task_id) {
+  if (sparse_weight_.valid()) {
+    int start = task_id * thread_stride_;
+    int end = MSMIN(start + thread_stride_, sparse_weight_.block_row_num());
+    if (start < end) {
+      auto bias = in_tensors_.size() == 3 ? reinterpret_cast<float *>(in_tensors_[2]->data_c()) : nullptr;
+      MatMulBlockSparse(cur_a_ptr_, sparse_weight_.matrix(), bias, cur_c_ptr_, ActType_No, params_->row_, start, end);
+    }
+    return RET_OK;
+  }
   int cur_oc = MSMIN(thread_stride_ * col_tile_, params_->col_ - task_id * thread_stride_ * col_tile_);
   if (cur_oc <= 0) {
     return RET_OK;
@@ -302,7 +354,24 @@ int MatmulFloatRun(void *cdata, int task_id) {
   return RET_OK;
 }
 
+int MatmulCPUKernel::RunSparse() {
+  // All the batches of A share B, so they are run as one matrix.
+  params_->batch = 1;
+  params_->row_ = in_tensors_.at(0)->ElementsNum() / params_->deep_;
+  cur_a_ptr_ = reinterpret_cast<float *>(in_tensors_.at(0)->data_c());
+  cur_c_ptr_ = reinterpret_cast<float *>(out_tensors_.at(0)->data_c());
+  auto ret = ParallelLaunch(this->context_->thread_pool_, MatmulFloatRun, this, thread_count_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Matmul fp32 run function MatmulFloatRun failed";
+    return RET_ERROR;
+  }
+  return RET_OK;
+}
+
 int MatmulCPUKernel::Run() {
+  if (sparse_weight_.valid()) {
+    return RunSparse();
+  }
   auto a_src = reinterpret_cast<float *>(in_tensors_.at(0)->data_c());
   auto b_src = reinterpret_cast<float *>(in_tensors_.at(1)->data_c());
   auto c_src = reinterpret_cast<float *>(out_tensors_.at(0)->data_c());
@@ -326,7 +395,8 @@ int MatmulCPUKernel::Run() {
   }
   if (!params_->b_const_ || IsTrain()) {
     if (b_pack_ptr_ != nullptr) {
-      params_->b_const_ ? free(b_pack_ptr_) : context_->allocator->Free(b_pack_ptr_);
+      params_->b_const_ ? lite::PackedWeightCache::GetInstance()->Release(b_pack_ptr_)
+                        : context_->allocator->Free(b_pack_ptr_);
       b_pack_ptr_ = nullptr;
     }
     auto ret = MallocMatrixBBuffer();
@@ -366,7 +436,8 @@ int MatmulCPUKernel::Run() {
     a_pack_ptr_ = nullptr;
   }
   if (!params_->b_const_ || IsTrain()) {
-    params_->b_const_ ? free(b_pack_ptr_) : context_->allocator->Free(b_pack_ptr_);
+    params_->b_const_ ? lite::PackedWeightCache::GetInstance()->Release(b_pack_ptr_)
+                      : context_->allocator->Free(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
   return RET_OK;
@@ -392,7 +463,7 @@ int MatmulCPUKernel::Eval() {
       a_ptr_ = a_pack_ptr_;
     }
   }
-  if (params_->b_const_) {
+  if (params_->b_const_ && !b_prepacked_) {
     if (b_pack_ptr_ == nullptr) {
       auto ret = MallocMatrixBBuffer();
       if (ret != RET_OK) {
@@ -433,6 +504,27 @@ kernel::LiteKernel *CpuMatmulFp32KernelCreator(const std::vector<lite::Tensor *>
     weight_tensor->set_data(dequant_weight);
   }
 
+  int thread_count = ctx->thread_num_;
+  if (ctx->kernel_tuner_ != nullptr && primitive != nullptr && primitive->infer_flag() &&
+      weight_tensor->sparse_block_rows() == 0) {
+    auto params = reinterpret_cast<MatMulParameter *>(opParameter);
+    auto key = lite::KernelTuner::MakeKey("MatMul", inputs, outputs, {params->a_transpose_, params->b_transpose_},
+                                          ctx->thread_num_);
+    thread_count = ctx->kernel_tuner_->Tune(
+      key, lite::KernelTuner::ThreadChoices(ctx->thread_num_), [&](int choice) -> kernel::LiteKernel * {
+        auto *param = lite::KernelTuner::CopyParameter(opParameter, sizeof(MatMulParameter));
+        if (param == nullptr) {
+          return nullptr;
+        }
+        auto *candidate = new (std::nothrow) MatmulCPUKernel(param, inputs, outputs, ctx, primitive);
+        if (candidate == nullptr) {
+          free(param);
+          return nullptr;
+        }
+        candidate->set_thread_count(choice);
+        return candidate;
+      });
+  }
   auto kernel = new (std::nothrow) MatmulCPUKernel(opParameter, inputs, outputs, ctx, primitive);
   if (kernel == nullptr) {
     MS_LOG(ERROR) << "kernel is nullptr.";
@@ -444,6 +536,7 @@ kernel::LiteKernel *CpuMatmulFp32KernelCreator(const std::vector<lite::Tensor *>
     free(opParameter);
     return nullptr;
   }
+  kernel->set_thread_count(thread_count);
   auto ret = kernel->Init();
   if (ret != RET_OK) {
     MS_LOG(ERROR) << "Init kernel failed, name: " << opParameter->name_ << ", type: "
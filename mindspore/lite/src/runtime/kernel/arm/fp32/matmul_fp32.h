@@ -21,6 +21,8 @@
 #include "nnacl/matmul_parameter.h"
 #include "src/lite_kernel.h"
 #include "src/runtime/kernel/arm/base/matmul_base.h"
+#include "src/runtime/packed_weight_cache.h"
+#include "src/runtime/kernel/arm/base/block_sparse_weight.h"
 
 namespace mindspore::kernel {
 class MatmulCPUKernel : public MatmulBaseCPUKernel {
@@ -43,6 +45,8 @@ class MatmulCPUKernel : public MatmulBaseCPUKernel {
   void InitMatrixA(const float *src_ptr, float *dst_ptr);
   void InitMatrixB(const float *src_ptr, float *dst_ptr);
   void FreeTmpBuffer();
+  int InitSparseWeight();
+  int RunSparse();
 
  private:
   float *a_pack_ptr_ = nullptr;
@@ -54,7 +58,11 @@ class MatmulCPUKernel : public MatmulBaseCPUKernel {
   float *cur_b_ptr_ = nullptr;
   float *cur_c_ptr_ = nullptr;
   bool is_vector_a_ = false;
+  // B is a weight the converter has already packed, b_ptr_ points into it.
+  bool b_prepacked_ = false;
   int col_tile_ = 0;
+  // B when it is a block sparse weight, A and C are then used as they are.
+  BlockSparseWeight sparse_weight_;
 };
 }  // namespace mindspore::kernel
 
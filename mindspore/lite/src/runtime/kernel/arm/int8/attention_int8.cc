@@ -0,0 +1,142 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "src/runtime/kernel/arm/int8/attention_int8.h"
+#include "src/kernel_registry.h"
+#include "include/errorcode.h"
+
+using mindspore::kernel::KERNEL_ARCH::kCPU;
+using mindspore::lite::KernelRegistrar;
+using mindspore::lite::RET_ERROR;
+using mindspore::lite::RET_OK;
+using mindspore::schema::PrimitiveType_Attention;
+
+namespace mindspore::kernel {
+int AttentionInt8CPUKernel::SetQuantArgs() {
+  std::vector<lite::Tensor *> tensors = {in_tensors_.at(0), in_tensors_.at(1), in_tensors_.at(2), out_tensors_.at(0)};
+  std::vector<QuantArg *> args = {&quant_arg_.q_, &quant_arg_.k_, &quant_arg_.v_, &quant_arg_.out_};
+  if (has_mask()) {
+    tensors.push_back(in_tensors_.at(kMaskIndex));
+    args.push_back(&quant_arg_.mask_);
+  }
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    if (tensors.at(i)->data_type() != kNumberTypeInt8) {
+      // only a float mask is allowed next to the int8 tensors
+      args.at(i)->scale_ = 1.0f;
+      args.at(i)->zp_ = 0;
+      continue;
+    }
+    if (tensors.at(i)->quant_params().empty()) {
+      MS_LOG(ERROR) << "attention tensor " << i << " has no quant param";
+      return RET_ERROR;
+    }
+    args.at(i)->scale_ = tensors.at(i)->quant_params().front().scale;
+    args.at(i)->zp_ = tensors.at(i)->quant_params().front().zeroPoint;
+  }
+  return RET_OK;
+}
+
+int AttentionInt8CPUKernel::Init() {
+  auto ret = SetQuantArgs();
+  if (ret != RET_OK) {
+    return ret;
+  }
+  return AttentionCPUKernel::Init();
+}
+
+void AttentionInt8CPUKernel::FreeMask() {
+  if (mask_ != nullptr && in_tensors_.at(kMaskIndex)->data_type() == kNumberTypeInt8) {
+    context_->allocator->Free(mask_);
+  }
+  mask_ = nullptr;
+}
+
+int AttentionInt8CPUKernel::Run() {
+  if (has_mask()) {
+    auto mask_tensor = in_tensors_.at(kMaskIndex);
+    if (mask_tensor->data_type() == kNumberTypeInt8) {
+      int ele_num = mask_tensor->ElementsNum();
+      mask_ = reinterpret_cast<float *>(context_->allocator->Malloc(ele_num * sizeof(float)));
+      if (mask_ == nullptr) {
+        MS_LOG(ERROR) << "malloc mask failed.";
+        return RET_ERROR;
+      }
+      auto src = reinterpret_cast<int8_t *>(mask_tensor->data_c());
+      for (int i = 0; i < ele_num; ++i) {
+        mask_[i] = (src[i] - quant_arg_.mask_.zp_) * quant_arg_.mask_.scale_;
+      }
+    } else {
+      mask_ = reinterpret_cast<float *>(mask_tensor->data_c());
+    }
+  }
+  auto ret = RunTiles();
+  FreeMask();
+  return ret;
+}
+
+int AttentionInt8CPUKernel::DoExecute(int task_id) {
+  auto q = reinterpret_cast<int8_t *>(in_tensors_.at(0)->data_c());
+  auto k = reinterpret_cast<int8_t *>(in_tensors_.at(1)->data_c());
+  auto v = reinterpret_cast<int8_t *>(in_tensors_.at(2)->data_c());
+  auto out = reinterpret_cast<int8_t *>(out_tensors_.at(0)->data_c());
+  auto buffer = buffer_ + task_id * AttentionBufferSize(param_);
+  int q_size = param_->q_len_ * param_->head_dim_;
+  int k_size = param_->kv_len_ * param_->head_dim_;
+  int v_size = param_->kv_len_ * param_->v_head_dim_;
+  int out_size = param_->q_len_ * param_->v_head_dim_;
+  int start = 0;
+  int end = 0;
+  TaskUnitRange(task_id, &start, &end);
+  for (int unit = start; unit < end; ++unit) {
+    int b = unit / row_block_num_;
+    int row_start = (unit % row_block_num_) * ATTENTION_ROW_BLOCK;
+    int row_end = MSMIN(row_start + ATTENTION_ROW_BLOCK, param_->q_len_);
+    auto ret = AttentionInt8(q + b * q_size, k + b * k_size, v + b * v_size,
+                             mask_ == nullptr ? nullptr : mask_ + mask_offsets_.at(b), out + b * out_size, buffer,
+                             row_start, row_end, param_, &quant_arg_);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "AttentionInt8 error error_code[" << ret << "]";
+      return ret;
+    }
+  }
+  return RET_OK;
+}
+
+kernel::LiteKernel *CpuAttentionInt8KernelCreator(const std::vector<lite::Tensor *> &inputs,
+                                                  const std::vector<lite::Tensor *> &outputs, OpParameter *parameter,
+                                                  const lite::InnerContext *ctx, const KernelKey &desc,
+                                                  const mindspore::lite::PrimitiveC *primitive) {
+  if (parameter == nullptr) {
+    MS_LOG(ERROR) << "Input parameter is nullptr!";
+    return nullptr;
+  }
+  auto *kernel = new (std::nothrow) AttentionInt8CPUKernel(parameter, inputs, outputs, ctx, primitive);
+  if (kernel == nullptr) {
+    MS_LOG(ERROR) << "kernel is nullptr.";
+    free(parameter);
+    return nullptr;
+  }
+  auto ret = kernel->Init();
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Init kernel failed, name: " << parameter->name_
+                  << ", type: " << schema::EnumNamePrimitiveType(static_cast<schema::PrimitiveType>(parameter->type_));
+    delete kernel;
+    return nullptr;
+  }
+  return kernel;
+}
+
+REG_KERNEL(kCPU, kNumberTypeInt8, PrimitiveType_Attention, CpuAttentionInt8KernelCreator)
+}  // namespace mindspore::kernel
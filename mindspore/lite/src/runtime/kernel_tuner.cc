@@ -0,0 +1,228 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/runtime/kernel_tuner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "include/errorcode.h"
+#include "src/common/log_adapter.h"
+
+namespace mindspore::lite {
+namespace {
+constexpr int kTuningRuns = 5;
+#ifdef ENABLE_ARM64
+constexpr char kTuningIsa[] = "arm64";
+#elif defined(ENABLE_ARM32)
+constexpr char kTuningIsa[] = "arm32";
+#elif defined(ENABLE_AVX)
+constexpr char kTuningIsa[] = "avx";
+#elif defined(ENABLE_SSE)
+constexpr char kTuningIsa[] = "sse";
+#else
+constexpr char kTuningIsa[] = "generic";
+#endif
+
+void AppendShapes(const std::vector<Tensor *> &tensors, std::ostringstream *key) {
+  for (size_t i = 0; i < tensors.size(); i++) {
+    *key << (i == 0 ? "" : ",");
+    auto shape = tensors[i]->shape();
+    for (size_t j = 0; j < shape.size(); j++) {
+      *key << (j == 0 ? "" : "x") << shape[j];
+    }
+  }
+}
+
+// The process, the thread and the time make the name unique, so that sessions saving the same file at once do not
+// write to or rename the temporary file of each other.
+std::string TmpFileName(const std::string &file) {
+  std::ostringstream name;
+  name << file << ".tmp";
+#ifndef _WIN32
+  name << "." << getpid();
+#endif
+  name << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << "."
+       << std::chrono::steady_clock::now().time_since_epoch().count();
+  return name.str();
+}
+}  // namespace
+
+void KernelTuner::Load() {
+  std::ifstream file(file_);
+  if (!file.is_open()) {
+    MS_LOG(INFO) << "Tuning file " << file_ << " does not exist, all the tuned ops are timed.";
+    return;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string key;
+    int choice;
+    if (!(fields >> key >> choice)) {
+      MS_LOG(WARNING) << "Invalid line in tuning file " << file_ << ": " << line << ", the file is tuned again.";
+      picks_.clear();
+      return;
+    }
+    picks_[key] = choice;
+  }
+  dirty_ = false;
+}
+
+int KernelTuner::Save() {
+  if (!dirty_) {
+    return RET_OK;
+  }
+  // Writing to a temporary file and renaming it keeps sessions loading the file meanwhile from reading half of it.
+  auto tmp_file = TmpFileName(file_);
+  std::ofstream file(tmp_file, std::ios::trunc);
+  if (!file.is_open()) {
+    MS_LOG(ERROR) << "Open tuning file " << tmp_file << " failed.";
+    return RET_ERROR;
+  }
+  file << "# op key, picked choice\n";
+  for (auto &pick : picks_) {
+    file << pick.first << " " << pick.second << "\n";
+  }
+  file.close();
+  if (file.fail() || std::rename(tmp_file.c_str(), file_.c_str()) != 0) {
+    MS_LOG(ERROR) << "Write tuning file " << file_ << " failed.";
+    (void)std::remove(tmp_file.c_str());
+    return RET_ERROR;
+  }
+  dirty_ = false;
+  return RET_OK;
+}
+
+int KernelTuner::Tune(const std::string &key, const std::vector<int> &choices,
+                      const std::function<kernel::LiteKernel *(int)> &create) {
+  MS_ASSERT(!choices.empty());
+  auto iter = picks_.find(key);
+  if (iter != picks_.end() && std::find(choices.begin(), choices.end(), iter->second) != choices.end()) {
+    return iter->second;
+  }
+  if (choices.size() == 1) {
+    return choices.front();
+  }
+  int best_choice = choices.front();
+  double best_time = -1;
+  for (auto choice : choices) {
+    auto *kernel = create(choice);
+    if (kernel == nullptr) {
+      continue;
+    }
+    double time = kernel->Init() == RET_OK ? TimeKernel(kernel) : -1;
+    delete kernel;
+    MS_LOG(DEBUG) << "Tuning " << key << ", choice " << choice << ": " << time << " us";
+    if (time >= 0 && (best_time < 0 || time < best_time)) {
+      best_choice = choice;
+      best_time = time;
+    }
+  }
+  if (best_time < 0) {
+    MS_LOG(WARNING) << "No choice of " << key << " can be timed, use the default one.";
+    return choices.front();
+  }
+  MS_LOG(INFO) << "Tuned " << key << ": choice " << best_choice << ", " << best_time << " us";
+  picks_[key] = best_choice;
+  dirty_ = true;
+  return best_choice;
+}
+
+double KernelTuner::TimeKernel(kernel::LiteKernel *kernel) {
+  // Activations have no data at compile time, the runs use zeroed scratch data instead.
+  std::vector<Tensor *> scratch;
+  double best_time = 0;
+  for (auto *tensor : kernel->in_tensors()) {
+    if (tensor->data_c() == nullptr) {
+      if (tensor->MallocData() != RET_OK) {
+        best_time = -1;
+        break;
+      }
+      memset(tensor->data_c(), 0, tensor->Size());
+      scratch.push_back(tensor);
+    }
+  }
+  for (auto *tensor : kernel->out_tensors()) {
+    if (best_time >= 0 && tensor->data_c() == nullptr) {
+      if (tensor->MallocData() != RET_OK) {
+        best_time = -1;
+        break;
+      }
+      scratch.push_back(tensor);
+    }
+  }
+  // The first run only warms up the caches and the thread pool.
+  for (int i = 0; best_time >= 0 && i <= kTuningRuns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    if (kernel->Run() != RET_OK) {
+      best_time = -1;
+      break;
+    }
+    std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - start;
+    if (i == 1 || (i > 1 && time.count() < best_time)) {
+      best_time = time.count();
+    }
+  }
+  for (auto *tensor : scratch) {
+    tensor->FreeData();
+  }
+  return best_time;
+}
+
+std::string KernelTuner::MakeKey(const std::string &op, const std::vector<Tensor *> &inputs,
+                                 const std::vector<Tensor *> &outputs, const std::vector<int> &attrs,
+                                 int thread_num) {
+  std::ostringstream key;
+  key << op << ":";
+  AppendShapes(inputs, &key);
+  key << ":";
+  AppendShapes(outputs, &key);
+  key << ":";
+  for (size_t i = 0; i < attrs.size(); i++) {
+    key << (i == 0 ? "" : ",") << attrs[i];
+  }
+  key << ":t" << thread_num << ":" << kTuningIsa;
+  return key.str();
+}
+
+std::vector<int> KernelTuner::ThreadChoices(int thread_num) {
+  std::vector<int> choices;
+  for (int num = thread_num; num > 0; num /= 2) {
+    choices.push_back(num);
+  }
+  return choices;
+}
+
+OpParameter *KernelTuner::CopyParameter(const OpParameter *param, size_t size) {
+  auto *copy = reinterpret_cast<OpParameter *>(malloc(size));
+  if (copy == nullptr) {
+    MS_LOG(ERROR) << "Malloc op parameter failed.";
+    return nullptr;
+  }
+  memcpy(copy, param, size);
+  return copy;
+}
+}  // namespace mindspore::lite
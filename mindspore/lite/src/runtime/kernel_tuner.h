@@ -0,0 +1,70 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_KERNEL_TUNER_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_KERNEL_TUNER_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "src/lite_kernel.h"
+#include "src/tensor.h"
+
+namespace mindspore::lite {
+// Picks the fastest way to run an op by timing the kernels of the candidate choices, e.g. the convolution algorithms
+// or the thread counts of a matmul, and remembers the picks in a file so that later loads of the model skip the
+// timing. An op is identified by a key made of its type, shapes, attributes, thread number and the instruction set of
+// the build, so a file tuned on one device should not be reused on a different one.
+class KernelTuner {
+ public:
+  explicit KernelTuner(const std::string &file) : file_(file) {}
+  ~KernelTuner() = default;
+
+  // Read the picks saved before. A missing or broken file leaves the tuner empty.
+  void Load();
+
+  // Write the picks to the file if some were added since the last Load or Save.
+  int Save();
+
+  // Return the fastest of choices for the op of key. The kernel of a choice is made by create and initialized here,
+  // create returns nullptr if the choice does not apply. The pick saved for key is returned without timing. If no
+  // choice can be timed, the first one is returned and nothing is saved.
+  int Tune(const std::string &key, const std::vector<int> &choices,
+           const std::function<kernel::LiteKernel *(int)> &create);
+
+  static std::string MakeKey(const std::string &op, const std::vector<Tensor *> &inputs,
+                             const std::vector<Tensor *> &outputs, const std::vector<int> &attrs, int thread_num);
+
+  // thread_num, then halved down to 1.
+  static std::vector<int> ThreadChoices(int thread_num);
+
+  // Copy of param for a candidate kernel, which frees it. Return nullptr if malloc fails.
+  static OpParameter *CopyParameter(const OpParameter *param, size_t size);
+
+  size_t size() const { return picks_.size(); }
+
+ private:
+  // Shortest time in microseconds of a few runs of kernel, negative if it fails to run.
+  static double TimeKernel(kernel::LiteKernel *kernel);
+
+  std::string file_;
+  std::map<std::string, int> picks_;
+  bool dirty_ = false;
+};
+}  // namespace mindspore::lite
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_TUNER_H_
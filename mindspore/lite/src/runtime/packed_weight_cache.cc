@@ -0,0 +1,91 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/runtime/packed_weight_cache.h"
+#include <cstring>
+#include "src/common/log_adapter.h"
+
+namespace mindspore::lite {
+void *PackedWeightCache::Acquire(const Tensor *weight, PackedWeightFormat format, size_t size,
+                                 const std::function<void(void *)> &pack) {
+  MS_ASSERT(weight != nullptr);
+  if (weight->weight_model() == nullptr) {
+    auto buffer = malloc(size);
+    if (buffer != nullptr) {
+      memset(buffer, 0, size);
+      pack(buffer);
+    }
+    return buffer;
+  }
+  // Packing under the lock keeps two sessions compiled at the same time from packing the same weight twice.
+  std::lock_guard<std::mutex> lock(mutex_);
+  Key key(weight->weight_model(), weight->weight_index(), format, size);
+  auto iter = buffers_.find(key);
+  if (iter != buffers_.end()) {
+    entries_[iter->second].ref_count++;
+    return iter->second;
+  }
+  auto buffer = malloc(size);
+  if (buffer == nullptr) {
+    MS_LOG(ERROR) << "Malloc packed weight failed, size " << size;
+    return nullptr;
+  }
+  memset(buffer, 0, size);
+  pack(buffer);
+  buffers_[key] = buffer;
+  auto &entry = entries_[buffer];
+  entry.key = key;
+  entry.ref_count = 1;
+  return buffer;
+}
+
+void PackedWeightCache::Release(void *buffer) {
+  if (buffer == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find(buffer);
+    if (iter != entries_.end()) {
+      if (--iter->second.ref_count > 0) {
+        return;
+      }
+      if (!iter->second.forgotten) {
+        buffers_.erase(iter->second.key);
+      }
+      entries_.erase(iter);
+    }
+  }
+  free(buffer);
+}
+
+void PackedWeightCache::ForgetModel(const void *model) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto iter = buffers_.begin(); iter != buffers_.end();) {
+    if (std::get<0>(iter->first) == model) {
+      entries_[iter->second].forgotten = true;
+      iter = buffers_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+size_t PackedWeightCache::SharedNum() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+}  // namespace mindspore::lite
@@ -0,0 +1,79 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_PACKED_WEIGHT_CACHE_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_PACKED_WEIGHT_CACHE_H_
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include "src/tensor.h"
+
+namespace mindspore::lite {
+// Layout a kernel packs a constant weight to. The weight is seen as a [col][deep] matrix, or as a [deep][col] one for
+// the DeepMajor formats, e.g. the B of a matmul that is not transposed. Kernels packing a weight the same way share
+// the buffer.
+enum PackedWeightFormat {
+  kPackedColTile = 0,  // [UP_DIV(col, tile)][deep][tile], as the fp32 matmul and convolution kernels use
+  kPackedColTileDeepMajor = 1,
+  kPackedColMajor = 2,  // [col][deep], as the fp32 matmul vector kernels use
+  kPackedColMajorDeepMajor = 3,
+  kPackedBlockSparse = 4  // the nonzero blocks of a block sparse weight, see kernel::BlockSparseWeight
+};
+
+// Packed weights shared by the kernels of all the sessions compiled from the same model, so that each session only
+// holds its activations. A buffer is packed by the first kernel asking for it and freed when the last kernel using it
+// releases it. The buffers are read only once packed.
+class PackedWeightCache {
+ public:
+  static PackedWeightCache *GetInstance() {
+    static PackedWeightCache cache;
+    return &cache;
+  }
+
+  // Get a zeroed buffer of size bytes filled by pack, or the buffer another kernel has already packed from the same
+  // weight. Weights not loaded from a model get a buffer of their own. Return nullptr if malloc fails.
+  void *Acquire(const Tensor *weight, PackedWeightFormat format, size_t size, const std::function<void(void *)> &pack);
+
+  // Give back a buffer got from Acquire. Buffers the cache does not share are freed.
+  void Release(void *buffer);
+
+  // Stop sharing the buffers packed from the model, called when the model is destroyed.
+  void ForgetModel(const void *model);
+
+  // Number of buffers shared now.
+  size_t SharedNum();
+
+ private:
+  PackedWeightCache() = default;
+  ~PackedWeightCache() = default;
+
+  using Key = std::tuple<const void *, size_t, int, size_t>;
+  struct Entry {
+    Key key;
+    int ref_count = 0;
+    bool forgotten = false;
+  };
+
+  std::mutex mutex_;
+  std::map<Key, void *> buffers_;
+  std::unordered_map<void *, Entry> entries_;
+};
+}  // namespace mindspore::lite
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_PACKED_WEIGHT_CACHE_H_
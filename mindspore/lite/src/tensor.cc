@@ -22,6 +22,7 @@
 #include "src/tensor.h"
 #include "securec/include/securec.h"
 #include "include/errorcode.h"
+#include "nnacl/op_base.h"
 
 namespace mindspore {
 namespace lite {
@@ -63,6 +64,10 @@ int Tensor::CopyTensor(const Tensor &src_tensor, bool copy_data) {
   this->shape_ = src_tensor.shape_;
   this->category_ = src_tensor.category_;
   this->format_ = src_tensor.format_;
+  this->weight_pack_tile_ = src_tensor.weight_pack_tile_;
+  this->weight_pack_deep_major_ = src_tensor.weight_pack_deep_major_;
+  this->sparse_block_rows_ = src_tensor.sparse_block_rows_;
+  this->sparse_block_cols_ = src_tensor.sparse_block_cols_;
   if (copy_data) {
     auto ret = CopyTensorData(src_tensor);
     if (0 != ret) {
@@ -217,6 +222,13 @@ size_t Tensor::Size() const {
     MS_LOG(ERROR) << "Element number of tensor should large than 0 : " << element_num;
     return 0;
   }
+  if (weight_pack_tile_ > 0 && !shape_.empty()) {
+    // The packed output channels are rounded up to the tile.
+    int col = weight_pack_deep_major_ ? shape_.back() : shape_.front();
+    if (col > 0) {
+      element_num = element_num / col * UP_ROUND(col, weight_pack_tile_);
+    }
+  }
   return element_size * element_num;
 }
 
@@ -130,6 +130,39 @@ class Tensor : public mindspore::tensor::MSTensor {
 
   void set_quant_clusters(const std::vector<float> &clusters);
 
+  // Tile of the output channels of a weight the converter has packed offline (see schema::WeightPack), 0 if the weight
+  // is in its plain layout. Size() accounts for the padding of the last tile.
+  int weight_pack_tile() const { return weight_pack_tile_; }
+
+  bool weight_pack_deep_major() const { return weight_pack_deep_major_; }
+
+  void set_weight_pack(int tile, bool deep_major) {
+    weight_pack_tile_ = tile;
+    weight_pack_deep_major_ = deep_major;
+  }
+
+  // Block shape of a weight the converter has stored block sparse, 0 if it is dense. The data is plain, kernels able
+  // to skip the zero blocks encode it again (see kernel::BlockSparseWeight).
+  int sparse_block_rows() const { return sparse_block_rows_; }
+
+  int sparse_block_cols() const { return sparse_block_cols_; }
+
+  void set_sparse_block(int rows, int cols) {
+    sparse_block_rows_ = rows;
+    sparse_block_cols_ = cols;
+  }
+
+  // Model and index a constant tensor is loaded from, so that sessions compiled from the same model can share the
+  // buffers kernels derive from it (see PackedWeightCache). nullptr if the tensor is not a weight of a model.
+  const void *weight_model() const { return weight_model_; }
+
+  size_t weight_index() const { return weight_index_; }
+
+  void set_weight_key(const void *model, size_t index) {
+    weight_model_ = model;
+    weight_index_ = index;
+  }
+
   bool IsConst();
 
   bool IsScalar();
@@ -166,6 +199,12 @@ class Tensor : public mindspore::tensor::MSTensor {
   std::vector<QuantArg> quant_params_;
   std::vector<float> quant_clusters_;
   mindspore::lite::Allocator *allocator_ = nullptr;
+  int weight_pack_tile_ = 0;
+  bool weight_pack_deep_major_ = false;
+  int sparse_block_rows_ = 0;
+  int sparse_block_cols_ = 0;
+  const void *weight_model_ = nullptr;
+  size_t weight_index_ = 0;
 };
 
 inline size_t DataTypeSize(const TypeId type) {
@@ -0,0 +1,202 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/train/train_memory_plan.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "include/errorcode.h"
+#include "src/ops/activation_grad.h"
+
+namespace mindspore {
+namespace lite {
+std::vector<size_t> TrainMemoryPlan::InPlaceInputs(const kernel::LiteKernel *kernel) {
+  // the kernels below read element i of every input before they write element i of the output, on every thread
+  switch (kernel->Type()) {
+    case schema::PrimitiveType_NegGrad:
+      return {0};
+    case schema::PrimitiveType_LogGrad:
+    case schema::PrimitiveType_DropoutGrad:
+      return {0, 1};
+    case schema::PrimitiveType_ActivationGrad: {
+      auto primitive = reinterpret_cast<const ActivationGrad *>(kernel->GetPrimitive());
+      if (primitive == nullptr) {
+        return {};
+      }
+      // leaky relu writes the slope to the output before it multiplies it by dy
+      if (primitive->GetType() == schema::ActivationType_LEAKY_RELU) {
+        return {1};
+      }
+      return {0, 1};
+    }
+    default:
+      return {};
+  }
+}
+
+void TrainMemoryPlan::Build(const std::vector<kernel::LiteKernel *> &kernels,
+                            const std::vector<Tensor *> &kept_tensors) {
+  release_after_.assign(kernels.size(), {});
+  in_place_.assign(kernels.size(), {});
+
+  std::unordered_set<Tensor *> kept(kept_tensors.begin(), kept_tensors.end());
+  std::unordered_map<Tensor *, size_t> producer;
+  std::unordered_map<Tensor *, size_t> first_use;
+  std::unordered_map<Tensor *, size_t> last_use;
+  for (size_t i = 0; i < kernels.size(); i++) {
+    for (auto tensor : kernels[i]->in_tensors()) {
+      first_use.emplace(tensor, i);
+      last_use[tensor] = i;
+    }
+    for (auto tensor : kernels[i]->out_tensors()) {
+      producer.emplace(tensor, i);
+      if (last_use.find(tensor) == last_use.end() || last_use[tensor] < i) {
+        last_use[tensor] = i;
+      }
+    }
+  }
+  // only tensors written by a kernel of the list are planned, a tensor read before it is written carries a value from
+  // the previous step and is kept as well
+  auto releasable = [&](Tensor *tensor) {
+    auto iter = producer.find(tensor);
+    if (iter == producer.end() || kept.find(tensor) != kept.end() || tensor->IsConst()) {
+      return false;
+    }
+    auto use = first_use.find(tensor);
+    return use == first_use.end() || use->second > iter->second;
+  };
+  for (auto &item : producer) {
+    if (releasable(item.first)) {
+      release_after_[last_use[item.first]].push_back(item.first);
+    }
+  }
+
+  for (size_t i = 0; i < kernels.size(); i++) {
+    auto kernel = kernels[i];
+    if (kernel->out_tensors().empty()) {
+      continue;
+    }
+    auto output = kernel->out_tensors().front();
+    if (!releasable(output) || producer[output] != i || output->ElementsNum() <= 0) {
+      continue;
+    }
+    for (auto index : InPlaceInputs(kernel)) {
+      if (index >= kernel->in_tensors().size()) {
+        continue;
+      }
+      auto input = kernel->in_tensors().at(index);
+      if (input != output && releasable(input) && last_use[input] == i &&
+          input->ElementsNum() == output->ElementsNum() && input->data_type() == output->data_type()) {
+        in_place_[i].input_ = input;
+        in_place_[i].output_ = output;
+        break;
+      }
+    }
+  }
+}
+
+void TrainMemoryPlan::BeforeKernel(size_t index) {
+  if (index >= in_place_.size() || in_place_[index].input_ == nullptr) {
+    return;
+  }
+  auto &in_place = in_place_[index];
+  auto input = in_place.input_;
+  auto output = in_place.output_;
+  // the output keeps its own buffer when it still holds one or when the two are served by different allocators
+  if (output->data_c() != nullptr || input->data_c() == nullptr || input->allocator() != output->allocator()) {
+    return;
+  }
+  output->set_data(input->data_c());
+  in_place.handed_over_ = true;
+}
+
+int TrainMemoryPlan::AfterKernel(size_t index) {
+  if (index >= release_after_.size()) {
+    return RET_OK;
+  }
+  auto &in_place = in_place_[index];
+  if (in_place.handed_over_) {
+    // the buffer now belongs to the output, it must not be freed with the input
+    in_place.input_->set_data(nullptr);
+    in_place.handed_over_ = false;
+  }
+  for (auto tensor : release_after_[index]) {
+    auto ret = tensor->FreeData();
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "Free tensor data failed";
+      return ret;
+    }
+  }
+  return RET_OK;
+}
+
+size_t TrainMemoryPlan::released_tensors() const {
+  size_t count = 0;
+  for (auto &tensors : release_after_) {
+    count += tensors.size();
+  }
+  return count;
+}
+
+size_t TrainMemoryPlan::in_place_kernels() const {
+  return std::count_if(in_place_.begin(), in_place_.end(),
+                       [](const InPlace &in_place) { return in_place.input_ != nullptr; });
+}
+
+int TrainExecutor::Run(std::vector<Tensor *> &in_tensors, std::vector<Tensor *> &out_tensors,
+                       std::vector<kernel::LiteKernel *> &kernels, Allocator *allocator, const KernelCallBack &before,
+                       const KernelCallBack &after) {
+  MS_ASSERT(plan_ != nullptr);
+  if (kernels.front()->Type() != schema::PrimitiveType_Merge) {
+    auto ret = CheckInputs(in_tensors);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "CheckInputs failed";
+      return ret;
+    }
+  }
+  for (auto out_tensor : out_tensors) {  // increase RefCount of output tensors, such that Run will not free them
+    out_tensor->set_ref_count(out_tensor->ref_count() + 1);
+  }
+  for (size_t i = 0; i < kernels.size(); i++) {
+    auto kernel = kernels[i];
+    MS_ASSERT(nullptr != kernel);
+    plan_->BeforeKernel(i);
+    auto ret = kernel->PreProcess();
+    if (RET_OK != ret) {
+      MS_LOG(ERROR) << "PreProcess kernel failed, name: " << kernel->name();
+      return ret;
+    }
+    ret = kernel->Run(before, after);
+    if (RET_OK != ret) {
+      MS_LOG(ERROR) << "run kernel failed, name: " << kernel->name();
+      return ret;
+    }
+    // release before PostProcess, so a buffer handed over to the output is never freed with the input's ref count
+    ret = plan_->AfterKernel(i);
+    if (RET_OK != ret) {
+      MS_LOG(ERROR) << "release tensors failed, name: " << kernel->name();
+      return ret;
+    }
+    ret = kernel->PostProcess();
+    if (RET_OK != ret) {
+      MS_LOG(ERROR) << "PostProcess kernel failed, name: " << kernel->name();
+      return ret;
+    }
+  }
+  return RET_OK;
+}
+}  // namespace lite
+}  // namespace mindspore
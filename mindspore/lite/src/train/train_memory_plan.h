@@ -0,0 +1,76 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_TRAIN_TRAIN_MEMORY_PLAN_H_
+#define MINDSPORE_LITE_SRC_TRAIN_TRAIN_MEMORY_PLAN_H_
+
+#include <vector>
+#include "src/executor.h"
+#include "src/lite_kernel.h"
+#include "src/tensor.h"
+
+namespace mindspore {
+namespace lite {
+// TrainMemoryPlan decides, for one ordered list of kernels, when the data of every activation and gradient can be
+// given back to the allocator, and which elementwise gradient kernels may write their output over an input.
+class TrainMemoryPlan {
+ public:
+  TrainMemoryPlan() = default;
+  ~TrainMemoryPlan() = default;
+
+  // kept_tensors are never freed, they are the graph inputs and every tensor a user can read after RunGraph
+  void Build(const std::vector<kernel::LiteKernel *> &kernels, const std::vector<Tensor *> &kept_tensors);
+
+  // hands the input buffer of an in place kernel over to its output, called before kernels[index] is preprocessed
+  void BeforeKernel(size_t index);
+
+  // frees the tensors whose last reader is kernels[index]
+  int AfterKernel(size_t index);
+
+  size_t released_tensors() const;
+
+  size_t in_place_kernels() const;
+
+ private:
+  static std::vector<size_t> InPlaceInputs(const kernel::LiteKernel *kernel);
+
+  struct InPlace {
+    Tensor *input_ = nullptr;
+    Tensor *output_ = nullptr;
+    bool handed_over_ = false;
+  };
+
+  // release_after_[i] holds the tensors freed once kernels[i] has run
+  std::vector<std::vector<Tensor *>> release_after_;
+  // in_place_[i].input_ is the input whose buffer kernels[i] writes its first output to, nullptr when it has none
+  std::vector<InPlace> in_place_;
+};
+
+class TrainExecutor : public CpuExecutor {
+ public:
+  explicit TrainExecutor(TrainMemoryPlan *plan) : plan_(plan) {}
+  ~TrainExecutor() override = default;
+
+  int Run(std::vector<Tensor *> &in_tensors, std::vector<Tensor *> &out_tensors,
+          std::vector<kernel::LiteKernel *> &kernels, Allocator *allocator = nullptr,
+          const KernelCallBack &before = nullptr, const KernelCallBack &after = nullptr) override;
+
+ private:
+  TrainMemoryPlan *plan_ = nullptr;
+};
+}  // namespace lite
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_SRC_TRAIN_TRAIN_MEMORY_PLAN_H_
@@ -45,6 +45,39 @@ static size_t TSFindTensor(const std::vector<lite::Tensor *> &where, const lite:
   return where.size();
 }
 
+// the tensors a kernel writes, optimizers and assign update some of their inputs in place
+static std::vector<lite::Tensor *> TSWrittenTensors(const kernel::LiteKernel *kernel) {
+  std::vector<size_t> written_inputs;
+  switch (kernel->Type()) {
+    case schema::PrimitiveType_Sgd:
+      written_inputs = {0, 3, 5};
+      break;
+    case schema::PrimitiveType_Adam:
+      written_inputs = {0, 1, 2};
+      break;
+    case schema::PrimitiveType_ApplyMomentum:
+      written_inputs = {0, 1};
+      break;
+    case schema::PrimitiveType_Assign:
+      written_inputs = {0};
+      break;
+    default:
+      break;
+  }
+  auto written = kernel->out_tensors();
+  for (auto index : written_inputs) {
+    if (index < kernel->in_tensors().size()) {
+      written.push_back(kernel->in_tensors().at(index));
+    }
+  }
+  return written;
+}
+
+static bool TSShareTensor(const std::vector<lite::Tensor *> &a, const std::vector<lite::Tensor *> &b) {
+  return std::any_of(a.begin(), a.end(),
+                     [&b](const lite::Tensor *tensor) { return TSFindTensor(b, tensor) != b.size(); });
+}
+
 TrainSession::TrainSession() { kernel::PopulateTrainParameters(); }
 
 std::vector<CreatorOp> TrainSession::ReplaceOps() {
@@ -101,6 +134,7 @@ int TrainSession::CompileTrainGraph(mindspore::lite::TrainModel *model) {
   CompileOptimizedKernels();  // Prepare a list of kenels which are optimized (weight update step)
   CompileTrainOutputs();      // prepare outputs in train mode
   CompileEvalOutputs();       // prepare outputs in eval mode
+  CompileMemoryPlan();        // prepare when activations and gradients are freed
   AllocWorkSpace();
 
   return RET_OK;
@@ -128,7 +162,7 @@ int TrainSession::RunGraph(const KernelCallBack &before, const KernelCallBack &a
     return lite::RET_NULL_PTR;
   }
   auto run_kernel = (train_mode_) ? train_kernels_ : inference_kernels_;
-  lite::CpuExecutor executor;
+  lite::TrainExecutor executor((train_mode_) ? &train_memory_plan_ : &inference_memory_plan_);
   if (before == nullptr && after == nullptr) {
     return executor.Run(this->inputs_, this->outputs_, run_kernel, this->context_->allocator.get());
   } else {
@@ -302,6 +336,49 @@ void TrainSession::CompileOptimizedKernels() {
   }
 }
 
+void TrainSession::MoveOptimizersToGradients() {
+  // run every optimizer right after the last kernel it depends on, usually the producer of its gradient, so the
+  // gradient is consumed and freed at once instead of living until the end of the backward pass
+  std::vector<kernel::LiteKernel *> ordered;
+  for (auto kernel : this->train_kernels_) {
+    if (!IsOptimizer(kernel)) {
+      ordered.push_back(kernel);
+      continue;
+    }
+    std::vector<lite::Tensor *> touched = kernel->in_tensors();
+    touched.insert(touched.end(), kernel->out_tensors().begin(), kernel->out_tensors().end());
+    auto written = TSWrittenTensors(kernel);
+    auto pos = ordered.size();
+    while (pos > 0 && !TSShareTensor(TSWrittenTensors(ordered[pos - 1]), touched) &&
+           !TSShareTensor(ordered[pos - 1]->in_tensors(), written)) {
+      pos--;
+    }
+    ordered.insert(ordered.begin() + pos, kernel);
+  }
+  train_kernels_ = ordered;
+}
+
+void TrainSession::CompileMemoryPlan() {
+  MoveOptimizersToGradients();
+  std::vector<lite::Tensor *> kept = inputs_;
+  for (auto output_map : {&orig_output_node_map_, &train_output_node_map_, &eval_output_node_map_}) {
+    for (auto &node_outputs : *output_map) {
+      for (auto ms_tensor : node_outputs.second) {
+        kept.push_back(static_cast<lite::Tensor *>(ms_tensor));
+      }
+    }
+  }
+  for (auto kernel : this->train_kernels_) {
+    if (kernel->is_model_output()) {
+      kept.insert(kept.end(), kernel->out_tensors().begin(), kernel->out_tensors().end());
+    }
+  }
+  train_memory_plan_.Build(train_kernels_, kept);
+  inference_memory_plan_.Build(inference_kernels_, kept);
+  MS_LOG(DEBUG) << "train plan frees " << train_memory_plan_.released_tensors() << " tensors, "
+                << train_memory_plan_.in_place_kernels() << " kernels run in place";
+}
+
 bool TrainSession::IsLossKernel(const kernel::LiteKernel *kernel) const {
   return (kernel->Type() == schema::PrimitiveType_SoftmaxCrossEntropy ||
           kernel->Type() == schema::PrimitiveType_SparseSoftmaxCrossEntropy ||
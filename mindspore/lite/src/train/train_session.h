@@ -22,6 +22,7 @@
 #include "src/ops/primitive_c.h"
 #include "include/train_session.h"
 #include "src/train/train_model.h"
+#include "src/train/train_memory_plan.h"
 #include "src/lite_session.h"
 
 /*
@@ -79,6 +80,7 @@ class TrainSession : virtual public session::TrainSession, virtual public lite::
   int Resize(const std::vector<tensor::MSTensor *> &inputs, const std::vector<std::vector<int>> &dims) override {
     return lite::RET_ERROR;
   }
+  int ResetStates() override { return lite::LiteSession::ResetStates(); }
 
  protected:
   void AllocWorkSpace();
@@ -92,6 +94,7 @@ class TrainSession : virtual public session::TrainSession, virtual public lite::
   virtual void CompileOptimizedKernels();
   virtual void CompileTrainOutputs();
   virtual void CompileEvalOutputs();
+  virtual void CompileMemoryPlan();
 
   TrainModel *model_ = nullptr;
   std::unordered_map<std::string, std::vector<mindspore::tensor::MSTensor *>> orig_output_node_map_;
@@ -105,9 +108,12 @@ class TrainSession : virtual public session::TrainSession, virtual public lite::
 
   std::vector<kernel::LiteKernel *> inference_kernels_;
   std::vector<kernel::LiteKernel *> train_kernels_;
+  TrainMemoryPlan train_memory_plan_;
+  TrainMemoryPlan inference_memory_plan_;
 
  private:
   void BuildInferenceKernelsRecursive(kernel::LiteKernel *ker, std::vector<kernel::LiteKernel *> *req_kernels);
+  void MoveOptimizersToGradients();
 };
 }  // namespace lite
 }  // namespace mindspore
@@ -0,0 +1,137 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "include/batch_server.h"
+#include "include/context.h"
+#include "include/errorcode.h"
+
+namespace mindspore {
+class BatchServerTest : public mindspore::CommonTest {
+ public:
+  BatchServerTest() {}
+
+  // a graph of one relu whose input and output are [1, 4]
+  void BuildReluModel(flatbuffers::FlatBufferBuilder *builder) {
+    auto meta_graph = std::make_shared<schema::MetaGraphT>();
+    meta_graph->name = "graph";
+    auto node = std::make_unique<schema::CNodeT>();
+    node->inputIndex = {0};
+    node->outputIndex = {1};
+    node->primitive = std::make_unique<schema::PrimitiveT>();
+    node->primitive->value.type = schema::PrimitiveType_Activation;
+    auto primitive = new schema::ActivationT;
+    primitive->type = schema::ActivationType_RELU;
+    node->primitive->value.value = primitive;
+    node->name = "Relu";
+    meta_graph->nodes.emplace_back(std::move(node));
+    meta_graph->inputIndex = {0};
+    meta_graph->outputIndex = {1};
+    for (int i = 0; i < 2; i++) {
+      auto tensor = std::make_unique<schema::TensorT>();
+      tensor->nodeType = schema::NodeType::NodeType_ValueNode;
+      tensor->format = schema::Format_NHWC;
+      tensor->dataType = TypeId::kNumberTypeFloat32;
+      tensor->dims = {1, 4};
+      tensor->offset = -1;
+      meta_graph->allTensors.emplace_back(std::move(tensor));
+    }
+    auto offset = schema::MetaGraph::Pack(*builder, meta_graph.get());
+    builder->Finish(offset);
+  }
+};
+
+TEST_F(BatchServerTest, TestConcurrentPredict) {
+  flatbuffers::FlatBufferBuilder builder(1024);
+  BuildReluModel(&builder);
+  lite::Context context;
+  context.thread_num_ = 2;
+  session::BatchServerOptions options;
+  options.max_batch_size_ = 4;
+  options.max_wait_us_ = 2000;
+  auto server = session::BatchServer::CreateServer(reinterpret_cast<char *>(builder.GetBufferPointer()),
+                                                   builder.GetSize(), &context, options);
+  ASSERT_NE(nullptr, server);
+  ASSERT_EQ(server->GetInputSizes(), std::vector<size_t>{4 * sizeof(float)});
+  ASSERT_EQ(server->GetOutputSizes(), std::vector<size_t>{4 * sizeof(float)});
+
+  const int thread_num = 8;
+  const int request_num = 50;
+  std::vector<int> failed(thread_num, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&, t]() {
+      for (int k = 0; k < request_num; k++) {
+        float input[4] = {static_cast<float>(t), -1.0f, static_cast<float>(k), -static_cast<float>(k)};
+        float output[4] = {0};
+        auto ret = server->Predict({input}, {output});
+        if (ret != lite::RET_OK || output[0] != t || output[1] != 0 || output[2] != k || output[3] != 0) {
+          failed[t]++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < thread_num; t++) {
+    EXPECT_EQ(0, failed[t]);
+  }
+
+  auto stat = server->GetStat();
+  EXPECT_EQ(static_cast<size_t>(thread_num * request_num), stat.requests_);
+  ASSERT_EQ(static_cast<size_t>(options.max_batch_size_ + 1), stat.batch_size_hist_.size());
+  size_t batched = 0;
+  for (size_t i = 0; i < stat.batch_size_hist_.size(); i++) {
+    batched += i * stat.batch_size_hist_[i];
+  }
+  EXPECT_EQ(stat.requests_, batched);
+  EXPECT_EQ(stat.batches_, std::accumulate(stat.batch_size_hist_.begin(), stat.batch_size_hist_.end(), size_t(0)));
+  EXPECT_EQ(stat.requests_, std::accumulate(stat.latency_us_hist_.begin(), stat.latency_us_hist_.end(), size_t(0)));
+  delete server;
+}
+
+TEST_F(BatchServerTest, TestInvalidRequest) {
+  flatbuffers::FlatBufferBuilder builder(1024);
+  BuildReluModel(&builder);
+  lite::Context context;
+  session::BatchServerOptions options;
+  options.max_batch_size_ = 0;
+  auto server = session::BatchServer::CreateServer(reinterpret_cast<char *>(builder.GetBufferPointer()),
+                                                   builder.GetSize(), &context, options);
+  ASSERT_EQ(nullptr, server);
+  options.max_batch_size_ = 2;
+  options.buckets_ = {3};
+  server = session::BatchServer::CreateServer(reinterpret_cast<char *>(builder.GetBufferPointer()),
+                                              builder.GetSize(), &context, options);
+  ASSERT_EQ(nullptr, server);
+  options.buckets_.clear();
+  server = session::BatchServer::CreateServer(reinterpret_cast<char *>(builder.GetBufferPointer()),
+                                              builder.GetSize(), &context, options);
+  ASSERT_NE(nullptr, server);
+  float input[4] = {0};
+  float output[4] = {0};
+  EXPECT_EQ(lite::RET_PARAM_INVALID, server->Predict({input, input}, {output}));
+  EXPECT_EQ(lite::RET_NULL_PTR, server->Predict({nullptr}, {output}));
+  EXPECT_EQ(size_t(0), server->GetStat().requests_);
+  delete server;
+}
+}  // namespace mindspore
@@ -0,0 +1,328 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "include/model.h"
+#include "src/lite_session.h"
+#include "src/sub_graph_kernel.h"
+#include "src/runtime/kernel_tuner.h"
+#include "src/runtime/kernel/arm/base/fullconnection_base.h"
+#include "src/runtime/kernel/arm/fp32/convolution_1x1_fp32.h"
+#include "src/runtime/kernel/arm/fp32/convolution_fp32.h"
+#include "src/runtime/kernel/arm/fp32/convolution_winograd_fp32.h"
+
+namespace mindspore {
+namespace {
+constexpr char kTuningFile[] = "./kernel_tuner_test.txt";
+
+// a kernel whose runs take choice milliseconds, writing 1 to its output
+class SleepKernel : public kernel::LiteKernel {
+ public:
+  SleepKernel(int choice, const std::vector<lite::Tensor *> &outputs)
+      : LiteKernel(nullptr, {}, outputs, nullptr, nullptr), choice_(choice) {}
+  int Init() override { return lite::RET_OK; }
+  int Run() override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(choice_));
+    reinterpret_cast<float *>(out_tensors_.front()->MutableData())[0] = 1;
+    return lite::RET_OK;
+  }
+
+ private:
+  int choice_;
+};
+
+// graph inputs and weights are value nodes, only the weights have data
+void AddTensor(schema::MetaGraphT *meta_graph, const std::vector<int> &dims, schema::Format format, bool is_const,
+               bool is_input = false) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->nodeType =
+    is_const || is_input ? schema::NodeType::NodeType_ValueNode : schema::NodeType::NodeType_Parameter;
+  tensor->format = format;
+  tensor->dataType = TypeId::kNumberTypeFloat32;
+  tensor->dims = dims;
+  if (is_const) {
+    int size = 1;
+    for (auto dim : dims) {
+      size *= dim;
+    }
+    std::vector<float> data(size);
+    for (int i = 0; i < size; i++) {
+      data[i] = 0.125f * static_cast<float>(i % 13) - 0.75f;
+    }
+    tensor->data.resize(size * sizeof(float));
+    memcpy(tensor->data.data(), data.data(), tensor->data.size());
+  }
+  tensor->offset = -1;
+  meta_graph->allTensors.emplace_back(std::move(tensor));
+}
+
+void AddConv2D(schema::MetaGraphT *meta_graph, const std::string &name, int kernel, int channel_in, int channel_out,
+               const std::vector<uint32_t> &inputs, const std::vector<uint32_t> &outputs) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = inputs;
+  node->outputIndex = outputs;
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = schema::PrimitiveType_Conv2D;
+  auto primitive = new schema::Conv2DT;
+  primitive->padMode = schema::PadMode_SAME_UPPER;
+  primitive->format = schema::Format_NHWC;
+  primitive->group = 1;
+  primitive->channelIn = channel_in;
+  primitive->channelOut = channel_out;
+  primitive->kernelH = kernel;
+  primitive->kernelW = kernel;
+  primitive->strideH = 1;
+  primitive->strideW = 1;
+  primitive->dilateH = 1;
+  primitive->dilateW = 1;
+  node->primitive->value.value = primitive;
+  node->name = name;
+  meta_graph->nodes.emplace_back(std::move(node));
+}
+
+lite::Model *ImportModel(schema::MetaGraphT *meta_graph) {
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto offset = schema::MetaGraph::Pack(builder, meta_graph);
+  builder.Finish(offset);
+  return lite::Model::Import(reinterpret_cast<char *>(builder.GetBufferPointer()), builder.GetSize());
+}
+
+// input [1, 8, 8, 4] -> Conv3x3(8 channels) -> Conv1x1(4 channels) -> output [1, 8, 8, 4]
+lite::Model *BuildConvModel() {
+  auto meta_graph = std::make_unique<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  AddConv2D(meta_graph.get(), "Conv3x3", 3, 4, 8, {0, 1}, {2});
+  AddConv2D(meta_graph.get(), "Conv1x1", 1, 8, 4, {2, 3}, {4});
+  meta_graph->inputIndex = {0};
+  meta_graph->outputIndex = {4};
+  AddTensor(meta_graph.get(), {1, 8, 8, 4}, schema::Format_NHWC, false, true);
+  AddTensor(meta_graph.get(), {8, 3, 3, 4}, schema::Format_KHWC, true);
+  AddTensor(meta_graph.get(), {1, 8, 8, 8}, schema::Format_NHWC, false);
+  AddTensor(meta_graph.get(), {4, 1, 1, 8}, schema::Format_KHWC, true);
+  AddTensor(meta_graph.get(), {1, 8, 8, 4}, schema::Format_NHWC, false);
+  return ImportModel(meta_graph.get());
+}
+
+// input [4, 16] -> FullConnection(weight [64, 16]) -> output [4, 64]
+lite::Model *BuildFullConnectionModel() {
+  auto meta_graph = std::make_unique<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = {0, 1};
+  node->outputIndex = {2};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = schema::PrimitiveType_FullConnection;
+  auto primitive = new schema::FullConnectionT;
+  primitive->useAxis = true;
+  primitive->axis = 1;
+  node->primitive->value.value = primitive;
+  node->name = "FullConnection";
+  meta_graph->nodes.emplace_back(std::move(node));
+  meta_graph->inputIndex = {0};
+  meta_graph->outputIndex = {2};
+  AddTensor(meta_graph.get(), {4, 16}, schema::Format_NHWC, false, true);
+  AddTensor(meta_graph.get(), {64, 16}, schema::Format_NHWC, true);
+  AddTensor(meta_graph.get(), {4, 64}, schema::Format_NHWC, false);
+  return ImportModel(meta_graph.get());
+}
+
+class TunerSession : public lite::LiteSession {
+ public:
+  kernel::LiteKernel *FindNode(const std::string &name) const {
+    for (auto *kernel : kernels_) {
+      std::vector<kernel::LiteKernel *> nodes = {kernel};
+      if (kernel->subgraph_type() != kernel::kNotSubGraph) {
+        nodes = reinterpret_cast<kernel::SubGraphKernel *>(kernel)->nodes();
+      }
+      for (auto *node : nodes) {
+        if (node->name() == name) {
+          return node;
+        }
+      }
+    }
+    return nullptr;
+  }
+};
+
+// compile model, tuned with tuning_file if it is not empty, and run it on fixed input data
+std::unique_ptr<TunerSession> CompileAndRun(lite::Model *model, const std::string &tuning_file, int thread_num,
+                                            std::vector<float> *output) {
+  lite::Context context;
+  context.thread_num_ = thread_num;
+  context.tuning_file_ = tuning_file;
+  auto session = std::make_unique<TunerSession>();
+  if (session->Init(&context) != lite::RET_OK || session->CompileGraph(model) != lite::RET_OK) {
+    return nullptr;
+  }
+  auto input = session->GetInputs().front();
+  auto input_data = reinterpret_cast<float *>(input->MutableData());
+  for (int i = 0; i < input->ElementsNum(); i++) {
+    input_data[i] = 0.25f * static_cast<float>(i % 11) - 1.0f;
+  }
+  if (session->RunGraph() != lite::RET_OK) {
+    return nullptr;
+  }
+  auto out_tensor = session->GetOutputs().begin()->second;
+  auto out_data = reinterpret_cast<float *>(out_tensor->MutableData());
+  output->assign(out_data, out_data + out_tensor->ElementsNum());
+  return session;
+}
+
+void ExpectOutput(const std::vector<float> &output, const std::vector<float> &expect) {
+  ASSERT_EQ(output.size(), expect.size());
+  for (size_t i = 0; i < output.size(); i++) {
+    ASSERT_NEAR(output[i], expect[i], 1e-3);
+  }
+}
+
+// set the pick of the ops whose key contains pattern to choice, return the number of them
+int SetPick(const std::string &pattern, int choice) {
+  std::ifstream in(kTuningFile);
+  std::ostringstream content;
+  std::string line;
+  int count = 0;
+  while (std::getline(in, line)) {
+    auto space = line.rfind(' ');
+    if (line[0] != '#' && space != std::string::npos && line.substr(0, space).find(pattern) != std::string::npos) {
+      line = line.substr(0, space + 1) + std::to_string(choice);
+      count++;
+    }
+    content << line << "\n";
+  }
+  in.close();
+  std::ofstream out(kTuningFile, std::ios::trunc);
+  out << content.str();
+  return count;
+}
+}  // namespace
+
+class KernelTunerTest : public mindspore::CommonTest {
+ public:
+  KernelTunerTest() {}
+};
+
+TEST_F(KernelTunerTest, TestTuneAndReload) {
+  (void)std::remove(kTuningFile);
+  lite::Tensor output(kNumberTypeFloat32, {1, 4});
+  auto key = lite::KernelTuner::MakeKey("Test", {}, {&output}, {1, 2}, 4);
+  EXPECT_EQ(key.find(' '), std::string::npos);
+  {
+    lite::KernelTuner tuner(kTuningFile);
+    tuner.Load();
+    EXPECT_EQ(tuner.size(), size_t(0));
+    int created = 0;
+    auto choice = tuner.Tune(key, {6, 1, 3, 9}, [&](int choice) -> kernel::LiteKernel * {
+      created++;
+      // 9 does not apply
+      return choice == 9 ? nullptr : new SleepKernel(choice, {&output});
+    });
+    EXPECT_EQ(choice, 1);
+    EXPECT_EQ(created, 4);
+    // the scratch output data is freed after the timing
+    EXPECT_EQ(output.data_c(), nullptr);
+    ASSERT_EQ(tuner.Save(), lite::RET_OK);
+  }
+  lite::KernelTuner tuner(kTuningFile);
+  tuner.Load();
+  EXPECT_EQ(tuner.size(), size_t(1));
+  auto create = [](int choice) -> kernel::LiteKernel * { return nullptr; };
+  EXPECT_EQ(tuner.Tune(key, {6, 1, 3}, create), 1);
+  // a pick which is not a choice any more is tuned again, no choice can be timed so the first one is used
+  EXPECT_EQ(tuner.Tune(key, {6, 3}, create), 6);
+  EXPECT_EQ(lite::KernelTuner::ThreadChoices(4), std::vector<int>({4, 2, 1}));
+  (void)std::remove(kTuningFile);
+}
+
+TEST_F(KernelTunerTest, TestTuneConv2D) {
+  (void)std::remove(kTuningFile);
+  auto model = BuildConvModel();
+  ASSERT_NE(model, nullptr);
+  std::vector<float> expect;
+  ASSERT_NE(CompileAndRun(model, "", 2, &expect), nullptr);
+  std::vector<float> output;
+  ASSERT_NE(CompileAndRun(model, kTuningFile, 2, &output), nullptr);
+  ExpectOutput(output, expect);
+  {
+    lite::KernelTuner tuner(kTuningFile);
+    tuner.Load();
+    EXPECT_EQ(tuner.size(), size_t(2));
+  }
+
+  // the saved picks are used as they are: every algorithm of the 3x3 convolution computes the same output, 1 is the
+  // common convolution and the others are winograd output units
+  for (int choice : {1, 2, 4, 6}) {
+    ASSERT_EQ(SetPick("x3x3x", choice), 1);
+    auto session = CompileAndRun(model, kTuningFile, 2, &output);
+    ASSERT_NE(session, nullptr);
+    auto *node = session->FindNode("Conv3x3");
+    if (choice == 1) {
+      EXPECT_NE(dynamic_cast<kernel::ConvolutionCPUKernel *>(node), nullptr);
+    } else {
+      EXPECT_NE(dynamic_cast<kernel::ConvolutionWinogradCPUKernel *>(node), nullptr);
+    }
+    ExpectOutput(output, expect);
+  }
+  // 0 is the 1x1 convolution
+  for (int choice : {0, 1}) {
+    ASSERT_EQ(SetPick("x1x1x", choice), 1);
+    auto session = CompileAndRun(model, kTuningFile, 2, &output);
+    ASSERT_NE(session, nullptr);
+    auto *node = session->FindNode("Conv1x1");
+    if (choice == 0) {
+      EXPECT_NE(dynamic_cast<kernel::Convolution1x1CPUKernel *>(node), nullptr);
+    } else {
+      EXPECT_NE(dynamic_cast<kernel::ConvolutionCPUKernel *>(node), nullptr);
+    }
+    ExpectOutput(output, expect);
+  }
+  delete model;
+  (void)std::remove(kTuningFile);
+}
+
+TEST_F(KernelTunerTest, TestTuneFullConnection) {
+  (void)std::remove(kTuningFile);
+  auto model = BuildFullConnectionModel();
+  ASSERT_NE(model, nullptr);
+  std::vector<float> expect;
+  ASSERT_NE(CompileAndRun(model, "", 4, &expect), nullptr);
+  std::vector<float> output;
+  ASSERT_NE(CompileAndRun(model, kTuningFile, 4, &output), nullptr);
+  ExpectOutput(output, expect);
+
+  // the kernel runs on the picked number of threads and computes the same output
+  for (int choice : {1, 2}) {
+    ASSERT_EQ(SetPick("FullConnection", choice), 1);
+    auto session = CompileAndRun(model, kTuningFile, 4, &output);
+    ASSERT_NE(session, nullptr);
+    auto *node = dynamic_cast<kernel::FullconnectionBaseCPUKernel *>(session->FindNode("FullConnection"));
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->thread_count(), choice);
+    ExpectOutput(output, expect);
+  }
+  delete model;
+  (void)std::remove(kTuningFile);
+}
+}  // namespace mindspore
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include "common/common_test.h"
+#include "src/runtime/packed_weight_cache.h"
+
+namespace mindspore {
+class PackedWeightCacheTest : public mindspore::CommonTest {
+ public:
+  PackedWeightCacheTest() {}
+};
+
+TEST_F(PackedWeightCacheTest, TestShare) {
+  auto cache = lite::PackedWeightCache::GetInstance();
+  auto shared_num = cache->SharedNum();
+  int model = 0;
+  int pack_count = 0;
+  auto pack = [&](void *dst) {
+    pack_count++;
+    reinterpret_cast<float *>(dst)[0] = 1.0f;
+  };
+  lite::Tensor weight0(kNumberTypeFloat32, {4, 4}, schema::Format_NHWC, lite::Tensor::Category::CONST_TENSOR);
+  lite::Tensor weight1(kNumberTypeFloat32, {4, 4}, schema::Format_NHWC, lite::Tensor::Category::CONST_TENSOR);
+  weight0.set_weight_key(&model, 1);
+  weight1.set_weight_key(&model, 1);
+
+  // the second session of the model gets the buffer the first one has packed
+  auto buffer0 = cache->Acquire(&weight0, lite::kPackedColTile, 32 * sizeof(float), pack);
+  auto buffer1 = cache->Acquire(&weight1, lite::kPackedColTile, 32 * sizeof(float), pack);
+  ASSERT_NE(buffer0, nullptr);
+  ASSERT_EQ(buffer0, buffer1);
+  ASSERT_EQ(pack_count, 1);
+  ASSERT_EQ(reinterpret_cast<float *>(buffer0)[0], 1.0f);
+  ASSERT_EQ(reinterpret_cast<float *>(buffer0)[31], 0.0f);
+  ASSERT_EQ(cache->SharedNum(), shared_num + 1);
+
+  // another layout of the same weight is packed on its own
+  auto buffer2 = cache->Acquire(&weight0, lite::kPackedColMajor, 16 * sizeof(float), pack);
+  ASSERT_NE(buffer2, buffer0);
+  ASSERT_EQ(pack_count, 2);
+  cache->Release(buffer2);
+
+  cache->Release(buffer0);
+  ASSERT_EQ(cache->SharedNum(), shared_num + 1);
+  cache->Release(buffer1);
+  ASSERT_EQ(cache->SharedNum(), shared_num);
+}
+
+TEST_F(PackedWeightCacheTest, TestPrivate) {
+  auto cache = lite::PackedWeightCache::GetInstance();
+  auto shared_num = cache->SharedNum();
+  int pack_count = 0;
+  auto pack = [&](void *dst) { pack_count++; };
+  // tensors not loaded from a model are never shared
+  lite::Tensor weight(kNumberTypeFloat32, {4, 4}, schema::Format_NHWC, lite::Tensor::Category::CONST_TENSOR);
+  auto buffer0 = cache->Acquire(&weight, lite::kPackedColTile, 16 * sizeof(float), pack);
+  auto buffer1 = cache->Acquire(&weight, lite::kPackedColTile, 16 * sizeof(float), pack);
+  ASSERT_NE(buffer0, buffer1);
+  ASSERT_EQ(pack_count, 2);
+  ASSERT_EQ(cache->SharedNum(), shared_num);
+  cache->Release(buffer0);
+  cache->Release(buffer1);
+}
+
+TEST_F(PackedWeightCacheTest, TestForgetModel) {
+  auto cache = lite::PackedWeightCache::GetInstance();
+  auto shared_num = cache->SharedNum();
+  int model = 0;
+  auto pack = [](void *dst) {};
+  lite::Tensor weight(kNumberTypeFloat32, {4, 4}, schema::Format_NHWC, lite::Tensor::Category::CONST_TENSOR);
+  weight.set_weight_key(&model, 0);
+  auto buffer0 = cache->Acquire(&weight, lite::kPackedColTile, 16 * sizeof(float), pack);
+  // a model created at the same address after the first one is destroyed does not see its buffers
+  cache->ForgetModel(&model);
+  auto buffer1 = cache->Acquire(&weight, lite::kPackedColTile, 16 * sizeof(float), pack);
+  ASSERT_NE(buffer0, buffer1);
+  ASSERT_EQ(cache->SharedNum(), shared_num + 2);
+  cache->Release(buffer0);
+  auto buffer2 = cache->Acquire(&weight, lite::kPackedColTile, 16 * sizeof(float), pack);
+  ASSERT_EQ(buffer1, buffer2);
+  cache->Release(buffer1);
+  cache->Release(buffer2);
+  ASSERT_EQ(cache->SharedNum(), shared_num);
+}
+}  // namespace mindspore
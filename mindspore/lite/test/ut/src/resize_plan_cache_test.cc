@@ -0,0 +1,231 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "include/errorcode.h"
+#include "include/model.h"
+#include "src/lite_session.h"
+#include "src/resize_plan_cache.h"
+
+namespace mindspore {
+namespace {
+int deleted_kernels = 0;
+
+class CountedKernel : public kernel::LiteKernel {
+ public:
+  CountedKernel() : LiteKernel(nullptr, {}, {}, nullptr, nullptr) {}
+  ~CountedKernel() override { deleted_kernels++; }
+};
+
+lite::ResizePlan MakePlan(int batch) {
+  lite::ResizePlan plan;
+  plan.kernels_ = {new CountedKernel(), new CountedKernel()};
+  plan.tensor_infos_.push_back({{batch, 4}, schema::Format_NHWC, kNumberTypeFloat32});
+  plan.infer_flags_ = {true};
+  return plan;
+}
+
+constexpr int kDeep = 4;
+constexpr int kCol = 3;
+
+// input [1, 4] -> FullConnection(weight [3, 4]) -> output [1, 3]
+lite::Model *BuildFullConnectionModel() {
+  auto meta_graph = std::make_shared<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = {0, 1};
+  node->outputIndex = {2};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = schema::PrimitiveType_FullConnection;
+  auto primitive = new schema::FullConnectionT;
+  primitive->useAxis = true;
+  primitive->axis = 1;
+  node->primitive->value.value = primitive;
+  node->name = "FullConnection";
+  meta_graph->nodes.emplace_back(std::move(node));
+  meta_graph->inputIndex = {0};
+  meta_graph->outputIndex = {2};
+
+  auto input = std::make_unique<schema::TensorT>();
+  input->nodeType = schema::NodeType::NodeType_ValueNode;
+  input->format = schema::Format_NHWC;
+  input->dataType = TypeId::kNumberTypeFloat32;
+  input->dims = {1, kDeep};
+  input->offset = -1;
+  meta_graph->allTensors.emplace_back(std::move(input));
+
+  auto weight = std::make_unique<schema::TensorT>();
+  weight->nodeType = schema::NodeType::NodeType_ValueNode;
+  weight->format = schema::Format_NHWC;
+  weight->dataType = TypeId::kNumberTypeFloat32;
+  weight->dims = {kCol, kDeep};
+  std::vector<float> weight_data(kCol * kDeep);
+  for (size_t i = 0; i < weight_data.size(); i++) {
+    weight_data[i] = 0.5f * static_cast<float>(i) - 2.0f;
+  }
+  weight->data.resize(weight_data.size() * sizeof(float));
+  memcpy(weight->data.data(), weight_data.data(), weight->data.size());
+  weight->offset = -1;
+  meta_graph->allTensors.emplace_back(std::move(weight));
+
+  auto output = std::make_unique<schema::TensorT>();
+  output->nodeType = schema::NodeType::NodeType_Parameter;
+  output->format = schema::Format_NHWC;
+  output->dataType = TypeId::kNumberTypeFloat32;
+  output->dims = {1, kCol};
+  output->offset = -1;
+  meta_graph->allTensors.emplace_back(std::move(output));
+
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto offset = schema::MetaGraph::Pack(builder, meta_graph.get());
+  builder.Finish(offset);
+  return lite::Model::Import(reinterpret_cast<char *>(builder.GetBufferPointer()), builder.GetSize());
+}
+
+class PlanCacheSession : public lite::LiteSession {
+ public:
+  const std::vector<kernel::LiteKernel *> &kernels() const { return kernels_; }
+};
+
+// fill the input with batch rows, run the graph and compare the output with a reference FullConnection
+void RunAndCheck(PlanCacheSession *session, int batch) {
+  auto input = session->GetInputs().front();
+  ASSERT_EQ(input->shape(), std::vector<int>({batch, kDeep}));
+  auto input_data = reinterpret_cast<float *>(input->MutableData());
+  ASSERT_NE(input_data, nullptr);
+  for (int i = 0; i < batch * kDeep; i++) {
+    input_data[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+  ASSERT_EQ(session->RunGraph(), lite::RET_OK);
+  auto output = session->GetOutputs().begin()->second;
+  ASSERT_EQ(output->shape(), std::vector<int>({batch, kCol}));
+  auto output_data = reinterpret_cast<float *>(output->MutableData());
+  for (int r = 0; r < batch; r++) {
+    for (int c = 0; c < kCol; c++) {
+      float expect = 0.0f;
+      for (int d = 0; d < kDeep; d++) {
+        expect += input_data[r * kDeep + d] * (0.5f * static_cast<float>(c * kDeep + d) - 2.0f);
+      }
+      ASSERT_NEAR(output_data[r * kCol + c], expect, 1e-4);
+    }
+  }
+}
+}  // namespace
+
+class ResizePlanCacheTest : public mindspore::CommonTest {
+ public:
+  ResizePlanCacheTest() {}
+};
+
+TEST_F(ResizePlanCacheTest, TestFind) {
+  deleted_kernels = 0;
+  lite::ResizePlanCache cache(2);
+  cache.Insert({{1, 4}}, MakePlan(1));
+  cache.Insert({{2, 4}}, MakePlan(2));
+  ASSERT_EQ(cache.size(), size_t(2));
+  auto plan = cache.Find({{1, 4}});
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->tensor_infos_[0].shape_, std::vector<int>({1, 4}));
+  EXPECT_EQ(cache.Find({{3, 4}}), nullptr);
+  EXPECT_EQ(cache.Find({{1, 4}, {1, 4}}), nullptr);
+  EXPECT_EQ(deleted_kernels, 0);
+}
+
+TEST_F(ResizePlanCacheTest, TestEvict) {
+  deleted_kernels = 0;
+  {
+    lite::ResizePlanCache cache(2);
+    cache.Insert({{1, 4}}, MakePlan(1));
+    cache.Insert({{2, 4}}, MakePlan(2));
+    // the plan of batch 1 becomes the most recently used one, so batch 2 is evicted
+    ASSERT_NE(cache.Find({{1, 4}}), nullptr);
+    cache.Insert({{3, 4}}, MakePlan(3));
+    EXPECT_EQ(cache.size(), size_t(2));
+    EXPECT_EQ(deleted_kernels, 2);
+    EXPECT_EQ(cache.Find({{2, 4}}), nullptr);
+    EXPECT_NE(cache.Find({{1, 4}}), nullptr);
+    EXPECT_NE(cache.Find({{3, 4}}), nullptr);
+  }
+  EXPECT_EQ(deleted_kernels, 6);
+}
+
+#ifndef SUPPORT_TRAIN
+// train sessions resize in place
+TEST_F(ResizePlanCacheTest, TestSessionSwapBack) {
+  auto model = BuildFullConnectionModel();
+  ASSERT_NE(model, nullptr);
+  lite::Context context;
+  context.thread_num_ = 2;
+  context.resize_cache_size_ = 2;
+  auto session = std::make_unique<PlanCacheSession>();
+  ASSERT_EQ(session->Init(&context), lite::RET_OK);
+  ASSERT_EQ(session->CompileGraph(model), lite::RET_OK);
+  RunAndCheck(session.get(), 1);
+  auto kernels_a = session->kernels();
+
+  auto inputs = session->GetInputs();
+  ASSERT_EQ(session->Resize(inputs, {{5, kDeep}}), lite::RET_OK);
+  auto kernels_b = session->kernels();
+  ASSERT_NE(kernels_b, kernels_a);
+  RunAndCheck(session.get(), 5);
+
+  // back to batch 1: the kernels of the first plan are reused, not scheduled again
+  ASSERT_EQ(session->Resize(inputs, {{1, kDeep}}), lite::RET_OK);
+  ASSERT_EQ(session->kernels(), kernels_a);
+  RunAndCheck(session.get(), 1);
+
+  ASSERT_EQ(session->Resize(inputs, {{5, kDeep}}), lite::RET_OK);
+  ASSERT_EQ(session->kernels(), kernels_b);
+  RunAndCheck(session.get(), 5);
+  session.reset();
+  delete model;
+}
+
+TEST_F(ResizePlanCacheTest, TestSessionRollback) {
+  auto model = BuildFullConnectionModel();
+  ASSERT_NE(model, nullptr);
+  lite::Context context;
+  context.thread_num_ = 2;
+  context.resize_cache_size_ = 2;
+  auto session = std::make_unique<PlanCacheSession>();
+  ASSERT_EQ(session->Init(&context), lite::RET_OK);
+  ASSERT_EQ(session->CompileGraph(model), lite::RET_OK);
+  auto inputs = session->GetInputs();
+  ASSERT_EQ(session->Resize(inputs, {{3, kDeep}}), lite::RET_OK);
+  auto kernels = session->kernels();
+
+  // the deep of the input does not match the weight, so InferShape fails while scheduling the new plan
+  ASSERT_NE(session->Resize(inputs, {{2, kDeep + 1}}), lite::RET_OK);
+  ASSERT_EQ(session->kernels(), kernels);
+  RunAndCheck(session.get(), 3);
+
+  // without the model buffer only the cached shapes can be used
+  model->Free();
+  ASSERT_NE(session->Resize(inputs, {{4, kDeep}}), lite::RET_OK);
+  ASSERT_EQ(session->kernels(), kernels);
+  ASSERT_EQ(inputs.front()->shape(), std::vector<int>({3, kDeep}));
+  ASSERT_EQ(session->Resize(inputs, {{1, kDeep}}), lite::RET_OK);
+  ASSERT_EQ(inputs.front()->shape(), std::vector<int>({1, kDeep}));
+  ASSERT_EQ(session->GetOutputs().begin()->second->shape(), std::vector<int>({1, kCol}));
+  session.reset();
+  delete model;
+}
+#endif
+}  // namespace mindspore
@@ -0,0 +1,156 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cmath>
+#include <vector>
+#include "src/common/log_adapter.h"
+#include "common/common_test.h"
+#include "mindspore/lite/src/runtime/kernel/arm/fp32/attention_fp32.h"
+#include "src/kernel_registry.h"
+#include "src/lite_kernel.h"
+
+namespace mindspore {
+class TestAttentionFp32 : public mindspore::CommonTest {
+ public:
+  TestAttentionFp32() = default;
+  void Init(const std::vector<std::vector<int>> &input_shapes, const std::vector<int> &output_shape, float scale,
+            bool transpose_b, int thread_num);
+  void TearDown() override;
+  // softmax(scale * q * k^T + mask) * v computed row by row
+  std::vector<float> NaiveAttention(int batch, int q_len, int kv_len, int head_dim, int v_head_dim, float scale,
+                                    bool transpose_b, const std::vector<int> &mask_index);
+
+ public:
+  float err_tol_ = 1e-5;
+  std::vector<std::vector<float>> input_data_;
+  std::vector<float> output_data_;
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  kernel::KernelKey desc_ = {kernel::KERNEL_ARCH::kCPU, kNumberTypeFloat32, schema::PrimitiveType_Attention};
+  lite::InnerContext ctx_ = lite::InnerContext();
+  kernel::LiteKernel *kernel_ = nullptr;
+};
+
+void TestAttentionFp32::TearDown() {
+  delete kernel_;
+  for (auto tensor : inputs_) {
+    tensor->set_data(nullptr);
+    delete tensor;
+  }
+  for (auto tensor : outputs_) {
+    tensor->set_data(nullptr);
+    delete tensor;
+  }
+}
+
+void TestAttentionFp32::Init(const std::vector<std::vector<int>> &input_shapes, const std::vector<int> &output_shape,
+                             float scale, bool transpose_b, int thread_num) {
+  input_data_.resize(input_shapes.size());
+  for (size_t i = 0; i < input_shapes.size(); ++i) {
+    auto tensor = new lite::Tensor(kNumberTypeFloat32, input_shapes[i]);
+    input_data_[i].resize(tensor->ElementsNum());
+    for (size_t j = 0; j < input_data_[i].size(); ++j) {
+      input_data_[i][j] = i == 3 ? ((j % 5 == 0) ? -10000.0f : 0.0f) : static_cast<float>((j * 7 + i) % 11) / 5 - 1;
+    }
+    tensor->set_data(input_data_[i].data());
+    inputs_.push_back(tensor);
+  }
+  auto out_tensor = new lite::Tensor(kNumberTypeFloat32, output_shape);
+  output_data_.assign(out_tensor->ElementsNum(), 0);
+  out_tensor->set_data(output_data_.data());
+  outputs_.push_back(out_tensor);
+
+  // the kernel frees its parameter
+  auto param = reinterpret_cast<AttentionParameter *>(malloc(sizeof(AttentionParameter)));
+  ASSERT_NE(param, nullptr);
+  memset(param, 0, sizeof(AttentionParameter));
+  param->scale_ = scale;
+  param->transpose_b_ = transpose_b;
+  ctx_.thread_num_ = thread_num;
+  ASSERT_EQ(lite::RET_OK, ctx_.Init());
+  auto creator = lite::KernelRegistry::GetInstance()->GetCreator(desc_);
+  ASSERT_NE(creator, nullptr);
+  kernel_ = creator(inputs_, outputs_, reinterpret_cast<OpParameter *>(param), &ctx_, desc_, nullptr);
+  ASSERT_NE(kernel_, nullptr);
+}
+
+std::vector<float> TestAttentionFp32::NaiveAttention(int batch, int q_len, int kv_len, int head_dim, int v_head_dim,
+                                                     float scale, bool transpose_b,
+                                                     const std::vector<int> &mask_index) {
+  auto &q = input_data_[0];
+  auto &k = input_data_[1];
+  auto &v = input_data_[2];
+  std::vector<float> out(batch * q_len * v_head_dim, 0);
+  std::vector<float> score(kv_len);
+  for (int b = 0; b < batch; ++b) {
+    for (int i = 0; i < q_len; ++i) {
+      float max = -INFINITY;
+      for (int j = 0; j < kv_len; ++j) {
+        float dot = 0;
+        for (int d = 0; d < head_dim; ++d) {
+          float key = transpose_b ? k[(b * kv_len + j) * head_dim + d] : k[(b * head_dim + d) * kv_len + j];
+          dot += q[(b * q_len + i) * head_dim + d] * key;
+        }
+        score[j] = dot * scale + (mask_index.empty() ? 0 : input_data_[3][mask_index[(b * q_len + i) * kv_len + j]]);
+        max = std::max(max, score[j]);
+      }
+      float sum = 0;
+      for (int j = 0; j < kv_len; ++j) {
+        score[j] = std::exp(score[j] - max);
+        sum += score[j];
+      }
+      for (int j = 0; j < kv_len; ++j) {
+        for (int d = 0; d < v_head_dim; ++d) {
+          out[(b * q_len + i) * v_head_dim + d] += score[j] / sum * v[(b * kv_len + j) * v_head_dim + d];
+        }
+      }
+    }
+  }
+  return out;
+}
+
+// k is [kv_len, head_dim], a [batch, 1, 1, kv_len] mask broadcasts over heads and query rows
+TEST_F(TestAttentionFp32, MaskBroadcast) {
+  int batch = 2;
+  int head = 3;
+  int q_len = 10;
+  int kv_len = 10;
+  int head_dim = 8;
+  Init({{batch, head, q_len, head_dim}, {batch, head, kv_len, head_dim}, {batch, head, kv_len, head_dim},
+        {batch, 1, 1, kv_len}},
+       {batch, head, q_len, head_dim}, 0.35f, true, 2);
+  std::vector<int> mask_index(batch * head * q_len * kv_len);
+  for (size_t i = 0; i < mask_index.size(); ++i) {
+    mask_index[i] = i / (head * q_len * kv_len) * kv_len + i % kv_len;
+  }
+  EXPECT_EQ(lite::RET_OK, kernel_->Run());
+  auto expect = NaiveAttention(batch * head, q_len, kv_len, head_dim, head_dim, 0.35f, true, mask_index);
+  ASSERT_EQ(0, CompareOutputData(output_data_.data(), expect.data(), expect.size(), err_tol_));
+}
+
+// k is [head_dim, kv_len], kv_len spans several column tiles so the running softmax is rescaled
+TEST_F(TestAttentionFp32, LongSequence) {
+  int batch = 3;
+  int q_len = 19;
+  int kv_len = 150;
+  int head_dim = 16;
+  int v_head_dim = 6;
+  Init({{batch, q_len, head_dim}, {batch, head_dim, kv_len}, {batch, kv_len, v_head_dim}}, {batch, q_len, v_head_dim},
+       0.25f, false, 4);
+  EXPECT_EQ(lite::RET_OK, kernel_->Run());
+  auto expect = NaiveAttention(batch, q_len, kv_len, head_dim, v_head_dim, 0.25f, false, {});
+  ASSERT_EQ(0, CompareOutputData(output_data_.data(), expect.data(), expect.size(), err_tol_));
+}
+}  // namespace mindspore
@@ -21,6 +21,7 @@
 #include "src/common/file_utils.h"
 #include "nnacl/matmul_parameter.h"
 #include "src/runtime/kernel/arm/fp32/convolution_1x1_fp32.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
 
 namespace mindspore {
 using mindspore::lite::Tensor;
@@ -232,6 +233,43 @@ TEST_F(TestConv1x1Fp32, Conv1x1Test1) {
   free(correct);
 }
 
+TEST_F(TestConv1x1Fp32, Conv1x1TestPrepackedWeight) {
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  auto conv_param = new ConvParameter();
+  auto *ctx = new lite::InnerContext();
+  ctx->thread_num_ = 2;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+  float *correct;
+  int total_size = Conv1x1TestInit1(&inputs_, &outputs_, conv_param, &correct);
+
+  // pack the weight the way the converter does
+  auto weight_t = inputs_[1];
+  std::vector<float> origin(reinterpret_cast<float *>(weight_t->data_c()),
+                            reinterpret_cast<float *>(weight_t->data_c()) + weight_t->ElementsNum());
+  int tile = kernel::WeightPackUtil::ColTile();
+  weight_t->FreeData();
+  weight_t->set_weight_pack(tile, false);
+  ASSERT_EQ(UP_ROUND(3, tile) * 4 * sizeof(float), weight_t->Size());
+  weight_t->MallocData();
+  RowMajor2ColTileMajor(origin.data(), reinterpret_cast<float *>(weight_t->data_c()), 3, 4, tile);
+  ASSERT_TRUE(kernel::WeightPackUtil::IsPrepacked(weight_t));
+
+  auto *conv1x1 =
+    new kernel::Convolution1x1CPUKernel(reinterpret_cast<OpParameter *>(conv_param), inputs_, outputs_, ctx, nullptr);
+  conv1x1->Init();
+  conv1x1->Run();
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(outputs_[0]->MutableData()), correct, total_size, 0.0001));
+
+  // The kernel uses the weight in place and leaves it to the tensor.
+  ASSERT_TRUE(kernel::WeightPackUtil::IsPrepacked(weight_t));
+  delete conv_param;
+  delete conv1x1;
+  for (auto t : inputs_) delete t;
+  for (auto t : outputs_) delete t;
+  free(correct);
+}
+
 int Conv1x1TestInit2(std::vector<lite::Tensor *> *inputs_, std::vector<lite::Tensor *> *outputs_,
                      ConvParameter *conv_param, float **correct) {
   size_t buffer_size;
@@ -22,6 +22,8 @@
 #include "src/common/file_utils.h"
 #include "src/common/log_adapter.h"
 #include "src/runtime/kernel/arm/fp32/fullconnection_fp32.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
+#include "src/runtime/kernel/arm/base/block_sparse_weight.h"
 
 namespace mindspore {
 using mindspore::lite::Tensor;
@@ -87,6 +89,91 @@ TEST_F(TestFcFp32, FcTest1) {
   ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(outputs_[0]->MutableData()), correct, total_size, 0.0001));
 }
 
+TEST_F(TestFcFp32, FcTestPrepackedWeight) {
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  auto matmul_param = new MatMulParameter();
+  float *correct;
+  int total_size = FcTestInit1(&inputs_, &outputs_, matmul_param, &correct);
+
+  // pack the weight the way the converter does
+  auto weight_t = inputs_[1];
+  std::vector<float> origin(reinterpret_cast<float *>(weight_t->data_c()),
+                            reinterpret_cast<float *>(weight_t->data_c()) + weight_t->ElementsNum());
+  int tile = kernel::WeightPackUtil::ColTile();
+  weight_t->FreeData();
+  weight_t->set_weight_pack(tile, false);
+  ASSERT_EQ(UP_ROUND(3, tile) * 8 * sizeof(float), weight_t->Size());
+  weight_t->MallocData();
+  RowMajor2ColTileMajor(origin.data(), reinterpret_cast<float *>(weight_t->data_c()), 3, 8, tile);
+  ASSERT_TRUE(kernel::WeightPackUtil::IsPrepacked(weight_t));
+
+  auto *ctx = new lite::InnerContext;
+  ctx->thread_num_ = 2;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+  auto *fc =
+    new kernel::FullconnectionCPUKernel(reinterpret_cast<OpParameter *>(matmul_param), inputs_, outputs_, ctx, nullptr);
+
+  fc->Init();
+  fc->Run();
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(outputs_[0]->MutableData()), correct, total_size, 0.0001));
+  delete fc;
+
+  ASSERT_EQ(lite::RET_OK, kernel::WeightPackUtil::UnpackWeight(weight_t));
+  ASSERT_EQ(0, weight_t->weight_pack_tile());
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(weight_t->data_c()), origin.data(), origin.size(), 0));
+}
+
+TEST_F(TestFcFp32, FcTestBlockSparseWeight) {
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  auto matmul_param = new MatMulParameter();
+  float *correct;
+  int total_size = FcTestInit1(&inputs_, &outputs_, matmul_param, &correct);
+
+  // prune the weight to 1x4 blocks, keeping 3 of its 6 blocks
+  auto weight_t = inputs_[1];
+  auto weight = reinterpret_cast<float *>(weight_t->data_c());
+  memset(weight + 4, 0, 4 * sizeof(float));
+  memset(weight + 8, 0, 8 * sizeof(float));
+  auto in = reinterpret_cast<float *>(inputs_[0]->data_c());
+  auto bias = reinterpret_cast<float *>(inputs_[2]->data_c());
+  for (int r = 0; r < 2; r++) {
+    for (int c = 0; c < 3; c++) {
+      correct[r * 3 + c] = bias[c];
+      for (int d = 0; d < 8; d++) {
+        correct[r * 3 + c] += in[r * 8 + d] * weight[c * 8 + d];
+      }
+    }
+  }
+
+  // store the weight the way the converter does and load it back
+  std::vector<float> origin(weight, weight + weight_t->ElementsNum());
+  ASSERT_EQ(3, BlockSparseCount(origin.data(), 3, 8, 1, 4, false));
+  std::vector<int> block_offsets(4);
+  std::vector<int> block_index(3);
+  std::vector<float> value(3 * 4);
+  BlockSparseMatrix matrix = {3, 8, 1, 4, 0, block_offsets.data(), block_index.data(), value.data()};
+  BlockSparseEncode(origin.data(), false, &matrix);
+  ASSERT_EQ(std::vector<int>({0, 1, 1, 3}), block_offsets);
+  weight_t->FreeData();
+  ASSERT_EQ(lite::RET_OK, kernel::BlockSparseWeight::DecodeWeight(weight_t, 1, 4, false, block_offsets, block_index,
+                                                                  value.data(), value.size() * sizeof(float)));
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(weight_t->data_c()), origin.data(), origin.size(), 0));
+  ASSERT_TRUE(kernel::BlockSparseWeight::IsSparse(weight_t));
+
+  auto *ctx = new lite::InnerContext;
+  ctx->thread_num_ = 2;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+  auto *fc =
+    new kernel::FullconnectionCPUKernel(reinterpret_cast<OpParameter *>(matmul_param), inputs_, outputs_, ctx, nullptr);
+
+  ASSERT_EQ(lite::RET_OK, fc->Init());
+  ASSERT_EQ(lite::RET_OK, fc->Run());
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(outputs_[0]->MutableData()), correct, total_size, 0.0001));
+  delete fc;
+}
+
 int FcTestInit2(std::vector<lite::Tensor *> *inputs_, std::vector<lite::Tensor *> *outputs_,
                 MatMulParameter *matmal_param, float **correct) {
   size_t buffer_size;
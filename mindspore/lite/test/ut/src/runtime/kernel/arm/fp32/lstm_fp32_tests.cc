@@ -181,6 +181,72 @@ TEST_F(LstmFp32, LstmForwardFp32Accuracy) {
   MS_LOG(INFO) << "LstmFp32 forward accuracy passed";
 }
 
+TEST_F(LstmFp32, LstmStreamingFp32Accuracy) {
+  auto lstm_param = reinterpret_cast<LstmParameter *>(malloc(sizeof(LstmParameter)));
+  ASSERT_NE(lstm_param, nullptr);
+  memset(lstm_param, 0, sizeof(LstmParameter));
+  InitLstmParam(lstm_param);
+  int seq_len = lstm_param->seq_len_;
+  int input_step = lstm_param->batch_ * lstm_param->input_size_;
+  int output_step = lstm_param->batch_ * lstm_param->hidden_size_;
+
+  // init ctx, the kernel keeps its states between runs
+  auto ctx = new lite::InnerContext();
+  ctx->thread_num_ = 1;
+  ctx->keep_rnn_states_ = true;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+
+  // init tensor, the sequence of the forward case is fed one frame per run
+  std::vector<lite::Tensor *> inputs;
+  std::vector<lite::Tensor *> outputs;
+  InitLstmForwardCreator(&inputs, &outputs, lstm_param);
+  auto sequence = inputs[0];
+  auto frame = new lite::Tensor(kNumberTypeFloat32, {1, lstm_param->batch_, lstm_param->input_size_});
+  frame->MallocData();
+  auto frame_output = new lite::Tensor(kNumberTypeFloat32, {1, lstm_param->batch_, lstm_param->hidden_size_});
+  frame_output->MallocData();
+  inputs[0] = frame;
+  auto sequence_output = outputs[0];
+  outputs[0] = frame_output;
+
+  kernel::KernelKey desc = {kernel::KERNEL_ARCH::kCPU, kNumberTypeFloat32, mindspore::schema::PrimitiveType_Lstm};
+  auto creator = lite::KernelRegistry::GetInstance()->GetCreator(desc);
+  ASSERT_NE(creator, nullptr);
+  kernel::LiteKernel *kernel =
+    creator(inputs, outputs, reinterpret_cast<OpParameter *>(lstm_param), ctx, desc, nullptr);
+  ASSERT_NE(kernel, nullptr);
+
+  std::vector<float> output0_data = {-0.0702, 0.1225,  0.0876,  -0.0357, -0.0227, -0.2294,
+                                     -0.0345, -0.0108, -0.2002, 0.0451,  0.0853,  -0.1205};
+  // the second pass starts again from the state inputs after the reset
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<float> stream_output;
+    for (int t = 0; t < seq_len; t++) {
+      memcpy(frame->MutableData(), reinterpret_cast<float *>(sequence->MutableData()) + t * input_step,
+             input_step * sizeof(float));
+      ASSERT_EQ(lite::RET_OK, kernel->Run());
+      auto frame_data = reinterpret_cast<float *>(frame_output->MutableData());
+      stream_output.insert(stream_output.end(), frame_data, frame_data + output_step);
+    }
+    ASSERT_EQ(0, CommonTest::CompareOutputData(stream_output.data(), output0_data.data(), seq_len * output_step,
+                                               0.0001));
+    std::vector<float> output1_data = {0.0451, 0.0853, -0.1205};
+    CompareResult(outputs[1], output1_data);
+    ASSERT_EQ(lite::RET_OK, kernel->ResetState());
+  }
+
+  delete kernel;
+  delete sequence;
+  delete sequence_output;
+  for (unsigned int i = 0; i < inputs.size() - 1; i++) {
+    delete inputs[i];
+  }
+  for (auto &output : outputs) {
+    delete output;
+  }
+  delete ctx;
+}
+
 void InitLstmBackwardCreator(std::vector<lite::Tensor *> *inputs, std::vector<lite::Tensor *> *outputs,
                              const LstmParameter *lstm_param) {
   // prepare input
@@ -331,4 +397,38 @@ TEST_F(LstmFp32, LstmBackwardFp32Accuracy) {
   MS_LOG(INFO) << "LstmFp32 backward accuracy passed";
 }
 
+TEST_F(LstmFp32, LstmBidirectionalStreamingFp32) {
+  auto lstm_param = reinterpret_cast<LstmParameter *>(malloc(sizeof(LstmParameter)));
+  ASSERT_NE(lstm_param, nullptr);
+  memset(lstm_param, 0, sizeof(LstmParameter));
+  InitLstmParam(lstm_param);
+  lstm_param->bidirectional_ = true;
+
+  // init ctx, a bidirectional lstm can not keep its states between runs
+  auto ctx = new lite::InnerContext();
+  ctx->thread_num_ = 1;
+  ctx->keep_rnn_states_ = true;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+
+  std::vector<lite::Tensor *> inputs;
+  std::vector<lite::Tensor *> outputs;
+  InitLstmBackwardCreator(&inputs, &outputs, lstm_param);
+
+  // the kernel frees the parameter when its Init fails
+  kernel::KernelKey desc = {kernel::KERNEL_ARCH::kCPU, kNumberTypeFloat32, mindspore::schema::PrimitiveType_Lstm};
+  auto creator = lite::KernelRegistry::GetInstance()->GetCreator(desc);
+  ASSERT_NE(creator, nullptr);
+  kernel::LiteKernel *kernel =
+    creator(inputs, outputs, reinterpret_cast<OpParameter *>(lstm_param), ctx, desc, nullptr);
+  EXPECT_EQ(kernel, nullptr);
+
+  for (unsigned int i = 0; i < inputs.size() - 1; i++) {
+    delete inputs[i];
+  }
+  for (auto &output : outputs) {
+    delete output;
+  }
+  delete ctx;
+}
+
 }  // namespace mindspore
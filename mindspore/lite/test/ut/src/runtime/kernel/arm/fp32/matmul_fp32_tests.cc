@@ -18,6 +18,7 @@
 #include "common/common_test.h"
 #include "mindspore/lite/src/runtime/kernel/arm/fp32/matmul_fp32.h"
 #include "mindspore/lite/nnacl/fp32/matmul_fp32.h"
+#include "src/runtime/kernel/arm/base/weight_pack.h"
 #include "src/kernel_registry.h"
 #include "src/lite_kernel.h"
 
@@ -300,6 +301,135 @@ TEST_F(TestMatMulFp32, simple_transb) {
   for (auto t : outputs_) delete t;
 }
 
+// Replace the data of a 2D weight with the layout the converter packs it to.
+void PrepackWeight(lite::Tensor *weight_t, bool deep_major) {
+  std::vector<float> origin(reinterpret_cast<float *>(weight_t->data_c()),
+                            reinterpret_cast<float *>(weight_t->data_c()) + weight_t->ElementsNum());
+  int row = weight_t->shape()[0];
+  int col = weight_t->shape()[1];
+  int tile = kernel::WeightPackUtil::ColTile();
+  weight_t->FreeData();
+  weight_t->set_weight_pack(tile, deep_major);
+  weight_t->MallocData();
+  auto packed = reinterpret_cast<float *>(weight_t->data_c());
+  if (deep_major) {
+    ASSERT_EQ(row * UP_ROUND(col, tile) * sizeof(float), weight_t->Size());
+    RowMajor2RowTileMajor(origin.data(), packed, row, col, tile);
+  } else {
+    ASSERT_EQ(UP_ROUND(row, tile) * col * sizeof(float), weight_t->Size());
+    RowMajor2ColTileMajor(origin.data(), packed, row, col, tile);
+  }
+  ASSERT_TRUE(kernel::WeightPackUtil::IsPrepacked(weight_t));
+}
+
+TEST_F(TestMatMulFp32, simple_prepacked) {
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  auto matmul_param = new MatMulParameter();
+  matmul_param->a_transpose_ = false;
+  matmul_param->b_transpose_ = false;
+  matmul_param->has_bias_ = false;
+  float a[] = {-3.2366564, -4.7733846, -7.8329225, 16.146885, 5.060793,  -6.1471,  -1.7680453, -6.5721383,
+               17.87506,   -5.1192183, 10.742863,  1.4536934, 19.693445, 19.45783, 5.063163,   0.5234792};
+  float b[] = {-0.0024438887, 0.0006738146, -0.008169129, 0.0021510671,  -0.012470592,   -0.0053063435,
+               0.006050155,   0.008656233,  0.012911413,  -0.0028635843, -0.00034080597, -0.0010622552,
+               -0.012254699,  -0.01312836,  0.0025241964, -0.004706142,  0.002451482,    -0.009558459,
+               0.004481974,   0.0033251503, -0.011705584, -0.001720293,  -0.0039410214,  -0.0073637343};
+  std::vector<int> a_shape = {2, 8};
+  std::vector<int> b_shape = {8, 3};
+  std::vector<int> c_shape = {2, 3};
+  int total_size = MMTestInit(&inputs_, &outputs_, a, b, a_shape, b_shape, c_shape);
+  // B is [deep][col] when it is not transposed.
+  PrepackWeight(inputs_[1], true);
+  auto ctx = new lite::InnerContext;
+  ctx->thread_num_ = 2;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+  auto mm = new kernel::MatmulCPUKernel(reinterpret_cast<OpParameter *>(matmul_param), inputs_, outputs_, ctx, nullptr);
+  mm->Init();
+  mm->Run();
+  float correct[] = {-0.1256939023733139, -0.07744802534580231,  0.07410638779401779,
+                     -0.3049793541431427, -0.027687929570674896, -0.18109679222106934};
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(outputs_[0]->MutableData()), correct, total_size, 0.0001));
+  ASSERT_TRUE(kernel::WeightPackUtil::IsPrepacked(inputs_[1]));
+  delete mm;
+  for (auto t : inputs_) delete t;
+  for (auto t : outputs_) delete t;
+}
+
+TEST_F(TestMatMulFp32, simple_transb_prepacked) {
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  auto matmul_param = new MatMulParameter();
+  matmul_param->a_transpose_ = false;
+  matmul_param->b_transpose_ = true;
+  matmul_param->has_bias_ = false;
+  float a[] = {-3.2366564, -4.7733846, -7.8329225, 16.146885, 5.060793,  -6.1471,  -1.7680453, -6.5721383,
+               17.87506,   -5.1192183, 10.742863,  1.4536934, 19.693445, 19.45783, 5.063163,   0.5234792};
+  float b[] = {-0.0024438887, 0.0006738146, -0.008169129, 0.0021510671,  -0.012470592,   -0.0053063435,
+               0.006050155,   0.008656233,  0.012911413,  -0.0028635843, -0.00034080597, -0.0010622552,
+               -0.012254699,  -0.01312836,  0.0025241964, -0.004706142,  0.002451482,    -0.009558459,
+               0.004481974,   0.0033251503, -0.011705584, -0.001720293,  -0.0039410214,  -0.0073637343};
+  std::vector<int> a_shape = {2, 8};
+  std::vector<int> b_shape = {3, 8};
+  std::vector<int> c_shape = {2, 3};
+  int total_size = MMTestInit(&inputs_, &outputs_, a, b, a_shape, b_shape, c_shape);
+  // A transposed B is [col][deep].
+  PrepackWeight(inputs_[1], false);
+  auto ctx = new lite::InnerContext;
+  ctx->thread_num_ = 2;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+  auto mm = new kernel::MatmulCPUKernel(reinterpret_cast<OpParameter *>(matmul_param), inputs_, outputs_, ctx, nullptr);
+  mm->Init();
+  mm->Run();
+  float correct[] = {0.00533547, 0.002545945, 0.062974121, -0.445441471, -0.246223617, -0.142070031};
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(outputs_[0]->MutableData()), correct, total_size, 0.0001));
+  ASSERT_TRUE(kernel::WeightPackUtil::IsPrepacked(inputs_[1]));
+  delete mm;
+  for (auto t : inputs_) delete t;
+  for (auto t : outputs_) delete t;
+}
+
+TEST_F(TestMatMulFp32, prepacked_other_tile) {
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  auto matmul_param = new MatMulParameter();
+  matmul_param->a_transpose_ = false;
+  matmul_param->b_transpose_ = true;
+  matmul_param->has_bias_ = false;
+  float a[] = {-3.2366564, -4.7733846, -7.8329225, 16.146885, 5.060793,  -6.1471,  -1.7680453, -6.5721383,
+               17.87506,   -5.1192183, 10.742863,  1.4536934, 19.693445, 19.45783, 5.063163,   0.5234792};
+  float b[] = {-0.0024438887, 0.0006738146, -0.008169129, 0.0021510671,  -0.012470592,   -0.0053063435,
+               0.006050155,   0.008656233,  0.012911413,  -0.0028635843, -0.00034080597, -0.0010622552,
+               -0.012254699,  -0.01312836,  0.0025241964, -0.004706142,  0.002451482,    -0.009558459,
+               0.004481974,   0.0033251503, -0.011705584, -0.001720293,  -0.0039410214,  -0.0073637343};
+  std::vector<int> a_shape = {2, 8};
+  std::vector<int> b_shape = {3, 8};
+  std::vector<int> c_shape = {2, 3};
+  int total_size = MMTestInit(&inputs_, &outputs_, a, b, a_shape, b_shape, c_shape);
+  // A model converted for another target.
+  auto weight_t = inputs_[1];
+  int tile = kernel::WeightPackUtil::ColTile() == C4NUM ? C8NUM : C4NUM;
+  weight_t->FreeData();
+  weight_t->set_weight_pack(tile, false);
+  weight_t->MallocData();
+  RowMajor2ColTileMajor(b, reinterpret_cast<float *>(weight_t->data_c()), 3, 8, tile);
+  ASSERT_FALSE(kernel::WeightPackUtil::IsPrepacked(weight_t));
+  auto ctx = new lite::InnerContext;
+  ctx->thread_num_ = 1;
+  ASSERT_EQ(lite::RET_OK, ctx->Init());
+  auto mm = new kernel::MatmulCPUKernel(reinterpret_cast<OpParameter *>(matmul_param), inputs_, outputs_, ctx, nullptr);
+  mm->Init();
+  mm->Run();
+  // The kernel restores the plain weight and packs it its own way.
+  ASSERT_EQ(0, weight_t->weight_pack_tile());
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(weight_t->data_c()), b, 24, 0));
+  float correct[] = {0.00533547, 0.002545945, 0.062974121, -0.445441471, -0.246223617, -0.142070031};
+  ASSERT_EQ(0, CompareOutputData(reinterpret_cast<float *>(outputs_[0]->MutableData()), correct, total_size, 0.0001));
+  delete mm;
+  for (auto t : inputs_) delete t;
+  for (auto t : outputs_) delete t;
+}
+
 TEST_F(TestMatMulFp32, batch) {
   std::vector<lite::Tensor *> inputs_;
   std::vector<lite::Tensor *> outputs_;
@@ -0,0 +1,193 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cmath>
+#include <vector>
+#include "common/common_test.h"
+#include "mindspore/lite/src/runtime/kernel/arm/int8/attention_int8.h"
+#include "src/kernel_registry.h"
+#include "src/lite_kernel.h"
+
+namespace mindspore {
+class TestAttentionInt8 : public mindspore::CommonTest {
+ public:
+  TestAttentionInt8() = default;
+  void TearDown() override;
+  // quantize values of [-1, 1] into a new int8 input tensor
+  void AddInput(const std::vector<int> &shape, const lite::QuantArg &quant_arg, int seed);
+  // softmax(scale * q * k^T + mask) * v on the dequantized inputs, quantized with the output quant arg
+  std::vector<int8_t> NaiveAttention(int batch, int q_len, int kv_len, int head_dim, int v_head_dim, float scale,
+                                     bool transpose_b, const std::vector<float> &mask);
+
+ public:
+  std::vector<std::vector<int8_t>> input_data_;
+  std::vector<lite::QuantArg> input_quant_;
+  std::vector<lite::Tensor *> inputs_;
+  std::vector<lite::Tensor *> outputs_;
+  lite::QuantArg out_quant_ = {1.0f / 128, 2};
+  kernel::KernelKey desc_ = {kernel::KERNEL_ARCH::kCPU, kNumberTypeInt8, schema::PrimitiveType_Attention};
+  lite::InnerContext ctx_ = lite::InnerContext();
+  kernel::LiteKernel *kernel_ = nullptr;
+};
+
+void TestAttentionInt8::TearDown() {
+  delete kernel_;
+  for (auto tensor : inputs_) {
+    tensor->set_data(nullptr);
+    delete tensor;
+  }
+  for (auto tensor : outputs_) {
+    tensor->set_data(nullptr);
+    delete tensor;
+  }
+}
+
+void TestAttentionInt8::AddInput(const std::vector<int> &shape, const lite::QuantArg &quant_arg, int seed) {
+  auto tensor = new lite::Tensor(kNumberTypeInt8, shape);
+  std::vector<int8_t> data(tensor->ElementsNum());
+  for (size_t j = 0; j < data.size(); ++j) {
+    float value = static_cast<float>((j * 7 + seed) % 11) / 5 - 1;
+    data[j] = static_cast<int8_t>(std::round(value / quant_arg.scale) + quant_arg.zeroPoint);
+  }
+  input_data_.push_back(data);
+  input_quant_.push_back(quant_arg);
+  tensor->AddQuantParam(quant_arg);
+  inputs_.push_back(tensor);
+}
+
+std::vector<int8_t> TestAttentionInt8::NaiveAttention(int batch, int q_len, int kv_len, int head_dim, int v_head_dim,
+                                                      float scale, bool transpose_b, const std::vector<float> &mask) {
+  auto dequant = [this](int index, int offset) {
+    return (input_data_[index][offset] - input_quant_[index].zeroPoint) * input_quant_[index].scale;
+  };
+  std::vector<int8_t> out(batch * q_len * v_head_dim);
+  std::vector<float> score(kv_len);
+  std::vector<float> acc(v_head_dim);
+  for (int b = 0; b < batch; ++b) {
+    for (int i = 0; i < q_len; ++i) {
+      float max = -INFINITY;
+      for (int j = 0; j < kv_len; ++j) {
+        float dot = 0;
+        for (int d = 0; d < head_dim; ++d) {
+          int k_offset = transpose_b ? (b * kv_len + j) * head_dim + d : (b * head_dim + d) * kv_len + j;
+          dot += dequant(0, (b * q_len + i) * head_dim + d) * dequant(1, k_offset);
+        }
+        score[j] = dot * scale + (mask.empty() ? 0 : mask[(b * q_len + i) * kv_len + j]);
+        max = std::max(max, score[j]);
+      }
+      float sum = 0;
+      for (int j = 0; j < kv_len; ++j) {
+        score[j] = std::exp(score[j] - max);
+        sum += score[j];
+      }
+      std::fill(acc.begin(), acc.end(), 0.0f);
+      for (int j = 0; j < kv_len; ++j) {
+        for (int d = 0; d < v_head_dim; ++d) {
+          acc[d] += score[j] / sum * dequant(2, (b * kv_len + j) * v_head_dim + d);
+        }
+      }
+      for (int d = 0; d < v_head_dim; ++d) {
+        int value = static_cast<int>(std::round(acc[d] / out_quant_.scale)) + out_quant_.zeroPoint;
+        out[(b * q_len + i) * v_head_dim + d] = static_cast<int8_t>(std::max(std::min(value, 127), -128));
+      }
+    }
+  }
+  return out;
+}
+
+// k is [head_dim, kv_len] with zero points on every tensor, kv_len spans several column tiles
+TEST_F(TestAttentionInt8, LongSequence) {
+  int batch = 2;
+  int q_len = 11;
+  int kv_len = 130;
+  int head_dim = 12;
+  int v_head_dim = 5;
+  AddInput({batch, q_len, head_dim}, {1.0f / 100, -3}, 0);
+  AddInput({batch, head_dim, kv_len}, {1.0f / 120, 5}, 1);
+  AddInput({batch, kv_len, v_head_dim}, {1.0f / 110, 1}, 2);
+  auto out_tensor = new lite::Tensor(kNumberTypeInt8, {batch, q_len, v_head_dim});
+  out_tensor->AddQuantParam(out_quant_);
+  outputs_.push_back(out_tensor);
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    inputs_[i]->set_data(input_data_[i].data());
+  }
+  std::vector<int8_t> output(out_tensor->ElementsNum());
+  out_tensor->set_data(output.data());
+
+  auto param = reinterpret_cast<AttentionParameter *>(malloc(sizeof(AttentionParameter)));
+  ASSERT_NE(param, nullptr);
+  memset(param, 0, sizeof(AttentionParameter));
+  param->scale_ = 0.5f;
+  param->transpose_b_ = false;
+  ctx_.thread_num_ = 3;
+  ASSERT_EQ(lite::RET_OK, ctx_.Init());
+  auto creator = lite::KernelRegistry::GetInstance()->GetCreator(desc_);
+  ASSERT_NE(creator, nullptr);
+  kernel_ = creator(inputs_, outputs_, reinterpret_cast<OpParameter *>(param), &ctx_, desc_, nullptr);
+  ASSERT_NE(kernel_, nullptr);
+  EXPECT_EQ(lite::RET_OK, kernel_->Run());
+
+  auto expect = NaiveAttention(batch, q_len, kv_len, head_dim, v_head_dim, 0.5f, false, {});
+  // the kernel rescales running sums, off by one in at most a few percent of the values
+  CompareOutputInt8(output.data(), expect.data(), expect.size(), 0.05);
+}
+
+// k is [kv_len, head_dim], a float [1, q_len, kv_len] mask is added to every batch
+TEST_F(TestAttentionInt8, FloatMask) {
+  int batch = 3;
+  int q_len = 9;
+  int kv_len = 10;
+  int head_dim = 8;
+  AddInput({batch, q_len, head_dim}, {1.0f / 100, 0}, 3);
+  AddInput({batch, kv_len, head_dim}, {1.0f / 100, 0}, 4);
+  AddInput({batch, kv_len, head_dim}, {1.0f / 100, 0}, 5);
+  std::vector<float> mask_data(q_len * kv_len);
+  for (size_t j = 0; j < mask_data.size(); ++j) {
+    mask_data[j] = (j % 3 == 0) ? -10000.0f : 0.0f;
+  }
+  auto mask_tensor = new lite::Tensor(kNumberTypeFloat32, {1, q_len, kv_len});
+  inputs_.push_back(mask_tensor);
+  auto out_tensor = new lite::Tensor(kNumberTypeInt8, {batch, q_len, head_dim});
+  out_tensor->AddQuantParam(out_quant_);
+  outputs_.push_back(out_tensor);
+  for (size_t i = 0; i < input_data_.size(); ++i) {
+    inputs_[i]->set_data(input_data_[i].data());
+  }
+  mask_tensor->set_data(mask_data.data());
+  std::vector<int8_t> output(out_tensor->ElementsNum());
+  out_tensor->set_data(output.data());
+
+  auto param = reinterpret_cast<AttentionParameter *>(malloc(sizeof(AttentionParameter)));
+  ASSERT_NE(param, nullptr);
+  memset(param, 0, sizeof(AttentionParameter));
+  param->scale_ = 0.35f;
+  param->transpose_b_ = true;
+  ctx_.thread_num_ = 2;
+  ASSERT_EQ(lite::RET_OK, ctx_.Init());
+  auto creator = lite::KernelRegistry::GetInstance()->GetCreator(desc_);
+  ASSERT_NE(creator, nullptr);
+  kernel_ = creator(inputs_, outputs_, reinterpret_cast<OpParameter *>(param), &ctx_, desc_, nullptr);
+  ASSERT_NE(kernel_, nullptr);
+  EXPECT_EQ(lite::RET_OK, kernel_->Run());
+
+  std::vector<float> mask(batch * q_len * kv_len);
+  for (size_t i = 0; i < mask.size(); ++i) {
+    mask[i] = mask_data[i % mask_data.size()];
+  }
+  auto expect = NaiveAttention(batch, q_len, kv_len, head_dim, head_dim, 0.35f, true, mask);
+  // the kernel rescales running sums, off by one in at most a few percent of the values
+  CompareOutputInt8(output.data(), expect.data(), expect.size(), 0.05);
+}
+}  // namespace mindspore
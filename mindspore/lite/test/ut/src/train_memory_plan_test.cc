@@ -0,0 +1,334 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "src/train/train_memory_plan.h"
+#include "src/train/train_model.h"
+#include "src/train/train_session.h"
+
+namespace mindspore {
+namespace {
+// negates its input, in place when the plan handed the input buffer over
+class NegKernel : public kernel::LiteKernel {
+ public:
+  NegKernel(OpParameter *parameter, lite::Tensor *input, lite::Tensor *output)
+      : LiteKernel(parameter, {input}, {output}, nullptr, nullptr) {}
+
+  int Run() override {
+    auto input = reinterpret_cast<float *>(in_tensors_[0]->MutableData());
+    auto output = reinterpret_cast<float *>(out_tensors_[0]->MutableData());
+    in_place_ = input == output;
+    for (int i = 0; i < in_tensors_[0]->ElementsNum(); i++) {
+      output[i] = -input[i];
+    }
+    return lite::RET_OK;
+  }
+
+  bool in_place_ = false;
+};
+
+OpParameter *NewParameter(schema::PrimitiveType type) {
+  auto parameter = reinterpret_cast<OpParameter *>(malloc(sizeof(OpParameter)));
+  parameter->type_ = type;
+  return parameter;
+}
+
+constexpr int kBatch = 6;
+constexpr int kFeature = 16;
+constexpr int kHidden = 8;
+constexpr int kClass = 4;
+constexpr int kSteps = 3;
+
+void AddNode(schema::MetaGraphT *meta_graph, const std::string &name, schema::PrimitiveType type, void *primitive,
+             const std::vector<uint32_t> &inputs, const std::vector<uint32_t> &outputs) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = inputs;
+  node->outputIndex = outputs;
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = type;
+  node->primitive->value.value = primitive;
+  node->name = name;
+  meta_graph->nodes.emplace_back(std::move(node));
+}
+
+schema::MatMulT *NewMatMul(bool transpose_a, bool transpose_b) {
+  auto primitive = new schema::MatMulT;
+  primitive->transposeA = transpose_a;
+  primitive->transposeB = transpose_b;
+  return primitive;
+}
+
+// a tensor of the model, const ones are filled with value, or with a ramp when ramp is set
+void AddTensor(schema::MetaGraphT *meta_graph, const std::vector<int> &dims, bool is_const, float value = 0.0f,
+               bool ramp = false) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->nodeType = is_const ? schema::NodeType::NodeType_ValueNode : schema::NodeType::NodeType_Parameter;
+  tensor->format = schema::Format_NHWC;
+  tensor->dataType = TypeId::kNumberTypeFloat32;
+  tensor->dims = dims;
+  tensor->offset = -1;
+  if (is_const) {
+    int size = 1;
+    for (auto dim : dims) {
+      size *= dim;
+    }
+    std::vector<float> data(size, value);
+    for (int i = 0; ramp && i < size; i++) {
+      data[i] = 0.05f * static_cast<float>(i % 9) - 0.2f;
+    }
+    tensor->data.resize(size * sizeof(float));
+    memcpy(tensor->data.data(), data.data(), tensor->data.size());
+  }
+  meta_graph->allTensors.emplace_back(std::move(tensor));
+}
+
+// graph inputs are value nodes without data, so the kernels reading them do not free them
+void AddInput(schema::MetaGraphT *meta_graph, const std::vector<int> &dims) {
+  AddTensor(meta_graph, dims, false);
+  meta_graph->allTensors.back()->nodeType = schema::NodeType::NodeType_ValueNode;
+}
+
+//  x(0) -> MatMul(w1(1)) -> (2) -> ReLU -> (3) -> MatMul(w2(4)) -> (5) -> SoftmaxCrossEntropy(labels(6)) -> loss(7)
+//  backward of dy(8): dx3(9) = dy * w2, dw2(10) = dy^T * (3), ActivationGrad(9, 3) -> dx2(11), dw1(12) = dx2^T * x
+//  both ApplyMomentum come last, with accumulates (13, 14), lr(15) and momentum(16)
+lite::TrainModel *BuildTrainModel() {
+  auto meta_graph = std::make_unique<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  AddNode(meta_graph.get(), "MatMul1", schema::PrimitiveType_MatMul, NewMatMul(false, true), {0, 1}, {2});
+  auto relu = new schema::ActivationT;
+  relu->type = schema::ActivationType_RELU;
+  AddNode(meta_graph.get(), "ReLU", schema::PrimitiveType_Activation, relu, {2}, {3});
+  AddNode(meta_graph.get(), "MatMul2", schema::PrimitiveType_MatMul, NewMatMul(false, true), {3, 4}, {5});
+  AddNode(meta_graph.get(), "SoftmaxCrossEntropy", schema::PrimitiveType_SoftmaxCrossEntropy,
+          new schema::SoftmaxCrossEntropyT, {5, 6}, {7, 8});
+  AddNode(meta_graph.get(), "MatMul2GradX", schema::PrimitiveType_MatMul, NewMatMul(false, false), {8, 4}, {9});
+  AddNode(meta_graph.get(), "MatMul2GradW", schema::PrimitiveType_MatMul, NewMatMul(true, false), {8, 3}, {10});
+  auto relu_grad = new schema::ActivationGradT;
+  relu_grad->type = schema::ActivationType_RELU;
+  AddNode(meta_graph.get(), "ReLUGrad", schema::PrimitiveType_ActivationGrad, relu_grad, {9, 3}, {11});
+  AddNode(meta_graph.get(), "MatMul1GradW", schema::PrimitiveType_MatMul, NewMatMul(true, false), {11, 0}, {12});
+  AddNode(meta_graph.get(), "MomentumW2", schema::PrimitiveType_ApplyMomentum, new schema::ApplyMomentumT,
+          {4, 14, 15, 10, 16}, {});
+  AddNode(meta_graph.get(), "MomentumW1", schema::PrimitiveType_ApplyMomentum, new schema::ApplyMomentumT,
+          {1, 13, 15, 12, 16}, {});
+  meta_graph->inputIndex = {0, 6};
+  meta_graph->outputIndex = {5, 7};
+
+  AddInput(meta_graph.get(), {kBatch, kFeature});
+  AddTensor(meta_graph.get(), {kHidden, kFeature}, true, 0.0f, true);
+  AddTensor(meta_graph.get(), {kBatch, kHidden}, false);
+  AddTensor(meta_graph.get(), {kBatch, kHidden}, false);
+  AddTensor(meta_graph.get(), {kClass, kHidden}, true, 0.0f, true);
+  AddTensor(meta_graph.get(), {kBatch, kClass}, false);
+  AddInput(meta_graph.get(), {kBatch * kClass});
+  // the loss is written in place of its initial value, as in the network tests
+  AddTensor(meta_graph.get(), {1}, true);
+  AddTensor(meta_graph.get(), {kBatch, kClass}, false);
+  AddTensor(meta_graph.get(), {kBatch, kHidden}, false);
+  AddTensor(meta_graph.get(), {kClass, kHidden}, false);
+  AddTensor(meta_graph.get(), {kBatch, kHidden}, false);
+  AddTensor(meta_graph.get(), {kHidden, kFeature}, false);
+  AddTensor(meta_graph.get(), {kHidden, kFeature}, true);
+  AddTensor(meta_graph.get(), {kClass, kHidden}, true);
+  AddTensor(meta_graph.get(), {1}, true, 0.1f);
+  AddTensor(meta_graph.get(), {1}, true, 0.9f);
+
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto offset = schema::MetaGraph::Pack(builder, meta_graph.get());
+  builder.Finish(offset);
+  schema::FinishMetaGraphBuffer(builder, offset);
+  return lite::TrainModel::Import(reinterpret_cast<char *>(builder.GetBufferPointer()), builder.GetSize());
+}
+
+class PlanTrainSession : public lite::TrainSession {
+ public:
+  size_t KernelIndex(const std::string &name) const {
+    auto iter = std::find_if(train_kernels_.begin(), train_kernels_.end(),
+                             [&name](const kernel::LiteKernel *kernel) { return kernel->name() == name; });
+    return iter - train_kernels_.begin();
+  }
+
+  // the kernel of train_kernels_ writing tensor
+  size_t ProducerIndex(const lite::Tensor *tensor) const {
+    auto iter = std::find_if(train_kernels_.begin(), train_kernels_.end(), [tensor](const kernel::LiteKernel *kernel) {
+      auto &outputs = kernel->out_tensors();
+      return std::find(outputs.begin(), outputs.end(), tensor) != outputs.end();
+    });
+    return iter - train_kernels_.begin();
+  }
+
+  std::vector<float> Weight(const std::string &optimizer) const {
+    auto weight = train_kernels_.at(KernelIndex(optimizer))->in_tensors().at(0);
+    auto data = reinterpret_cast<float *>(weight->data_c());
+    return std::vector<float>(data, data + weight->ElementsNum());
+  }
+
+  lite::Tensor *Gradient(const std::string &optimizer) const {
+    return train_kernels_.at(KernelIndex(optimizer))->in_tensors().at(3);
+  }
+
+  size_t in_place_kernels() const { return train_memory_plan_.in_place_kernels(); }
+  size_t released_tensors() const { return train_memory_plan_.released_tensors(); }
+};
+
+// keeps the kernels in the order of the graph and runs them with empty memory plans, as the CpuExecutor did
+class UnplannedTrainSession : public PlanTrainSession {
+ protected:
+  void CompileMemoryPlan() override {}
+};
+
+int CompileTrainSession(PlanTrainSession *session) {
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  context.thread_num_ = 1;
+  auto model = BuildTrainModel();
+  if (model == nullptr || session->Init(&context) != lite::RET_OK) {
+    delete model;
+    return lite::RET_ERROR;
+  }
+  // the session owns the model from here on
+  if (session->CompileTrainGraph(model) != lite::RET_OK) {
+    return lite::RET_ERROR;
+  }
+  return session->Train();
+}
+
+// one train step on the batch of step, returns the loss, and whether ActivationGrad wrote over its dy in in_place
+float TrainStep(PlanTrainSession *session, int step, bool *in_place) {
+  auto inputs = session->GetInputs();
+  auto x = reinterpret_cast<float *>(inputs.at(0)->MutableData());
+  for (int i = 0; i < kBatch * kFeature; i++) {
+    x[i] = 0.1f * static_cast<float>((i * 7 + step * 3) % 17) - 0.8f;
+  }
+  auto labels = reinterpret_cast<float *>(inputs.at(1)->MutableData());
+  std::fill(labels, labels + kBatch * kClass, 0.0f);
+  for (int i = 0; i < kBatch; i++) {
+    labels[i * kClass + (i + step) % kClass] = 1.0f;
+  }
+  *in_place = false;
+  auto after = [in_place](std::vector<tensor::MSTensor *> in_tensors, std::vector<tensor::MSTensor *> out_tensors,
+                          const CallBackParam &param) {
+    if (param.node_name == "ReLUGrad") {
+      *in_place = in_tensors.at(0)->MutableData() == out_tensors.at(0)->MutableData();
+    }
+    return true;
+  };
+  if (session->RunGraph(nullptr, after) != lite::RET_OK) {
+    return -1.0f;
+  }
+  auto loss = session->GetOutputsByNodeName("SoftmaxCrossEntropy").at(0);
+  return reinterpret_cast<float *>(loss->MutableData())[0];
+}
+}  // namespace
+
+class TrainMemoryPlanTest : public mindspore::CommonTest {
+ public:
+  TrainMemoryPlanTest() {}
+};
+
+TEST_F(TrainMemoryPlanTest, TestReleaseAndInPlace) {
+  lite::Tensor input(kNumberTypeFloat32, {1, 4});
+  lite::Tensor forward(kNumberTypeFloat32, {1, 4});
+  lite::Tensor gradient(kNumberTypeFloat32, {1, 4});
+  lite::Tensor output(kNumberTypeFloat32, {1, 4});
+  auto input_data = reinterpret_cast<float *>(input.MutableData());
+  for (int i = 0; i < 4; i++) {
+    input_data[i] = i;
+  }
+  NegKernel forward_kernel(NewParameter(schema::PrimitiveType_NONE), &input, &forward);
+  NegKernel grad_kernel(NewParameter(schema::PrimitiveType_NegGrad), &forward, &gradient);
+  NegKernel output_kernel(NewParameter(schema::PrimitiveType_NONE), &gradient, &output);
+  std::vector<kernel::LiteKernel *> kernels = {&forward_kernel, &grad_kernel, &output_kernel};
+
+  lite::TrainMemoryPlan plan;
+  plan.Build(kernels, {&input, &output});
+  EXPECT_EQ(plan.released_tensors(), size_t(2));
+  EXPECT_EQ(plan.in_place_kernels(), size_t(1));
+
+  std::vector<lite::Tensor *> inputs = {&input};
+  std::vector<lite::Tensor *> outputs = {&output};
+  lite::TrainExecutor executor(&plan);
+  for (int step = 0; step < 2; step++) {
+    ASSERT_EQ(executor.Run(inputs, outputs, kernels), lite::RET_OK);
+    EXPECT_FALSE(forward_kernel.in_place_);
+    EXPECT_TRUE(grad_kernel.in_place_);
+    EXPECT_EQ(forward.data_c(), nullptr);
+    EXPECT_EQ(gradient.data_c(), nullptr);
+    ASSERT_NE(output.data_c(), nullptr);
+    auto output_data = reinterpret_cast<float *>(output.data_c());
+    for (int i = 0; i < 4; i++) {
+      EXPECT_EQ(output_data[i], static_cast<float>(-i));
+    }
+  }
+}
+
+TEST_F(TrainMemoryPlanTest, TestKeepStepState) {
+  // state is read by the first kernel before the last one writes it, so it carries over to the next step
+  lite::Tensor state(kNumberTypeFloat32, {1, 4});
+  lite::Tensor next(kNumberTypeFloat32, {1, 4});
+  NegKernel read_kernel(NewParameter(schema::PrimitiveType_NONE), &state, &next);
+  NegKernel write_kernel(NewParameter(schema::PrimitiveType_NegGrad), &next, &state);
+  lite::TrainMemoryPlan plan;
+  plan.Build({&read_kernel, &write_kernel}, {});
+  EXPECT_EQ(plan.released_tensors(), size_t(1));
+  EXPECT_EQ(plan.in_place_kernels(), size_t(0));
+}
+TEST_F(TrainMemoryPlanTest, TestTrainSession) {
+  auto session = std::make_unique<PlanTrainSession>();
+  auto unplanned = std::make_unique<UnplannedTrainSession>();
+  ASSERT_EQ(CompileTrainSession(session.get()), lite::RET_OK);
+  ASSERT_EQ(CompileTrainSession(unplanned.get()), lite::RET_OK);
+  auto initial_w1 = session->Weight("MomentumW1");
+
+  // the optimizer of w2 runs right after its gradient is produced instead of at the end of the backward pass
+  auto momentum_w2 = session->KernelIndex("MomentumW2");
+  EXPECT_EQ(momentum_w2, session->ProducerIndex(session->Gradient("MomentumW2")) + 1);
+  EXPECT_LT(momentum_w2, session->KernelIndex("ReLUGrad"));
+  EXPECT_GT(unplanned->KernelIndex("MomentumW2"), unplanned->KernelIndex("MatMul1GradW"));
+  EXPECT_GE(session->in_place_kernels(), size_t(1));
+  EXPECT_GT(session->released_tensors(), size_t(0));
+
+  for (int step = 0; step < kSteps; step++) {
+    bool in_place = false;
+    bool unplanned_in_place = false;
+    auto loss = TrainStep(session.get(), step, &in_place);
+    auto expect_loss = TrainStep(unplanned.get(), step, &unplanned_in_place);
+    ASSERT_GE(loss, 0.0f);
+    EXPECT_FLOAT_EQ(loss, expect_loss);
+    EXPECT_TRUE(in_place);
+    EXPECT_FALSE(unplanned_in_place);
+    // the gradients are freed once the optimizers have used them
+    EXPECT_EQ(session->Gradient("MomentumW1")->data_c(), nullptr);
+    EXPECT_EQ(session->Gradient("MomentumW2")->data_c(), nullptr);
+  }
+  for (auto optimizer : {"MomentumW1", "MomentumW2"}) {
+    auto weight = session->Weight(optimizer);
+    auto expect = unplanned->Weight(optimizer);
+    ASSERT_EQ(weight.size(), expect.size());
+    for (size_t i = 0; i < weight.size(); i++) {
+      EXPECT_FLOAT_EQ(weight[i], expect[i]);
+    }
+  }
+  EXPECT_NE(session->Weight("MomentumW1"), initial_w1);
+}
+}  // namespace mindspore
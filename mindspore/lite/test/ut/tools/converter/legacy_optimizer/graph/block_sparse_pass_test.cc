@@ -0,0 +1,210 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "include/errorcode.h"
+#include "nnacl/fp32/block_sparse_fp32.h"
+#include "tools/converter/legacy_optimizer/graph/block_sparse_pass.h"
+
+namespace mindspore {
+class BlockSparsePassTest : public mindspore::CommonTest {
+ public:
+  BlockSparsePassTest() = default;
+};
+using MetaGraphTptr = std::shared_ptr<schema::MetaGraphT>;
+using CNodeTptr = std::unique_ptr<schema::CNodeT>;
+
+namespace {
+constexpr int kBlock = 4;
+constexpr int kSize = 8;
+
+// a [8][8] weight of 2 x 2 blocks, only the top right one holds nonzeros unless dense is set
+std::unique_ptr<schema::TensorT> BuildWeight(const std::vector<int> &dims, bool dense = false) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->nodeType = schema::NodeType_ValueNode;
+  tensor->format = dims.size() == 4 ? schema::Format_KHWC : schema::Format_NHWC;
+  tensor->dataType = TypeId::kNumberTypeFloat32;
+  tensor->dims = dims;
+  std::vector<float> data(kSize * kSize, 0.0f);
+  for (int r = 0; r < kSize; r++) {
+    for (int c = 0; c < kSize; c++) {
+      if (dense || (r < kBlock && c >= kBlock)) {
+        data[r * kSize + c] = static_cast<float>(r * kSize + c + 1);
+      }
+    }
+  }
+  tensor->data.resize(data.size() * sizeof(float));
+  memcpy(tensor->data.data(), data.data(), tensor->data.size());
+  return tensor;
+}
+
+std::unique_ptr<schema::TensorT> BuildActivation(const std::vector<int> &dims) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->nodeType = schema::NodeType_Parameter;
+  tensor->format = schema::Format_NHWC;
+  tensor->dataType = TypeId::kNumberTypeFloat32;
+  tensor->dims = dims;
+  return tensor;
+}
+
+CNodeTptr BuildNode(schema::PrimitiveType type) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = {0, 1};
+  node->outputIndex = {2};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = type;
+  node->name = schema::EnumNamePrimitiveType(type);
+  switch (type) {
+    case schema::PrimitiveType_FullConnection:
+      node->primitive->value.value = new schema::FullConnectionT;
+      break;
+    case schema::PrimitiveType_MatMul:
+      node->primitive->value.value = new schema::MatMulT;
+      break;
+    default: {
+      auto conv = new schema::Conv2DT;
+      conv->format = schema::Format_NHWC;
+      conv->group = 1;
+      conv->kernelH = 1;
+      conv->kernelW = 1;
+      conv->strideH = 1;
+      conv->strideW = 1;
+      conv->dilateH = 1;
+      conv->dilateW = 1;
+      conv->channelOut = kSize;
+      node->primitive->value.value = conv;
+      break;
+    }
+  }
+  return node;
+}
+
+// input -> node(weight) -> output
+MetaGraphTptr BuildGraph(CNodeTptr node, std::unique_ptr<schema::TensorT> weight) {
+  auto meta_graph = std::make_shared<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  meta_graph->allTensors.emplace_back(BuildActivation({1, kSize}));
+  meta_graph->allTensors.emplace_back(std::move(weight));
+  meta_graph->allTensors.emplace_back(BuildActivation({1, kSize}));
+  meta_graph->nodes.emplace_back(std::move(node));
+  meta_graph->inputIndex = {0};
+  meta_graph->outputIndex = {2};
+  return meta_graph;
+}
+
+std::vector<float> TensorData(const schema::TensorT &tensor) {
+  auto data = reinterpret_cast<const float *>(tensor.data.data());
+  return std::vector<float>(data, data + tensor.data.size() / sizeof(float));
+}
+
+// the plain data of a block sparse weight
+std::vector<float> Decode(schema::TensorT *weight, bool deep_major) {
+  auto &pack = weight->weightPack;
+  auto value = reinterpret_cast<float *>(weight->data.data());
+  BlockSparseMatrix matrix = {kSize,
+                              kSize,
+                              pack->blockRows,
+                              pack->blockCols,
+                              static_cast<int>(pack->blockIndex.size()),
+                              pack->blockOffsets.data(),
+                              pack->blockIndex.data(),
+                              value};
+  std::vector<float> dst(kSize * kSize);
+  BlockSparseDecode(&matrix, deep_major, dst.data());
+  return dst;
+}
+}  // namespace
+
+TEST_F(BlockSparsePassTest, TestFullConnection) {
+  auto graph = BuildGraph(BuildNode(schema::PrimitiveType_FullConnection), BuildWeight({kSize, kSize}));
+  auto origin = TensorData(*graph->allTensors.at(1));
+  lite::BlockSparsePass pass(kBlock, kBlock, 0.5f);
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_OK);
+
+  auto &weight = graph->allTensors.at(1);
+  ASSERT_NE(weight->weightPack, nullptr);
+  ASSERT_EQ(weight->weightPack->layout, schema::WeightPackLayout_BLOCK_SPARSE);
+  ASSERT_FALSE(weight->weightPack->deepMajor);
+  ASSERT_EQ(weight->weightPack->blockRows, kBlock);
+  ASSERT_EQ(weight->weightPack->blockCols, kBlock);
+  // only block (0, 1) is kept
+  ASSERT_EQ(weight->weightPack->blockOffsets, std::vector<int>({0, 1, 1}));
+  ASSERT_EQ(weight->weightPack->blockIndex, std::vector<int>({1}));
+  ASSERT_EQ(weight->data.size(), kBlock * kBlock * sizeof(float));
+  ASSERT_EQ(weight->dims, std::vector<int>({kSize, kSize}));
+  ASSERT_EQ(Decode(weight.get(), false), origin);
+
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+}
+
+TEST_F(BlockSparsePassTest, TestMatMulAndConv) {
+  lite::BlockSparsePass pass(kBlock, kBlock, 0.5f);
+  // B of a MatMul without transpose is [deep][col].
+  auto graph = BuildGraph(BuildNode(schema::PrimitiveType_MatMul), BuildWeight({kSize, kSize}));
+  auto origin = TensorData(*graph->allTensors.at(1));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_OK);
+  auto &weight = graph->allTensors.at(1);
+  ASSERT_TRUE(weight->weightPack->deepMajor);
+  ASSERT_EQ(Decode(weight.get(), true), origin);
+
+  graph = BuildGraph(BuildNode(schema::PrimitiveType_Conv2D), BuildWeight({kSize, 1, 1, kSize}));
+  origin = TensorData(*graph->allTensors.at(1));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_OK);
+  ASSERT_FALSE(graph->allTensors.at(1)->weightPack->deepMajor);
+  ASSERT_EQ(Decode(graph->allTensors.at(1).get(), false), origin);
+}
+
+TEST_F(BlockSparsePassTest, TestSkipWeight) {
+  lite::BlockSparsePass pass(kBlock, kBlock, 0.5f);
+  // Not sparse enough.
+  auto graph = BuildGraph(BuildNode(schema::PrimitiveType_FullConnection), BuildWeight({kSize, kSize}, true));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+  ASSERT_EQ(graph->allTensors.at(1)->weightPack, nullptr);
+  lite::BlockSparsePass strict_pass(kBlock, kBlock, 0.9f);
+  graph = BuildGraph(BuildNode(schema::PrimitiveType_FullConnection), BuildWeight({kSize, kSize}));
+  ASSERT_EQ(strict_pass.Run(graph.get()), lite::RET_NO_CHANGE);
+
+  // The sparse kernels only run 1x1 convolutions and MatMuls without a transposed A.
+  auto conv = BuildNode(schema::PrimitiveType_Conv2D);
+  conv->primitive->value.AsConv2D()->kernelH = 3;
+  conv->primitive->value.AsConv2D()->kernelW = 3;
+  graph = BuildGraph(std::move(conv), BuildWeight({kSize, 3, 3, kSize}));
+  graph->allTensors.at(1)->data.resize(kSize * 3 * 3 * kSize * sizeof(float));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+  auto matmul = BuildNode(schema::PrimitiveType_MatMul);
+  matmul->primitive->value.AsMatMul()->transposeA = true;
+  graph = BuildGraph(std::move(matmul), BuildWeight({kSize, kSize}));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+
+  // A weight used in two orientations has no single layout.
+  graph = BuildGraph(BuildNode(schema::PrimitiveType_FullConnection), BuildWeight({kSize, kSize}));
+  graph->allTensors.emplace_back(BuildActivation({1, kSize}));
+  auto other = BuildNode(schema::PrimitiveType_MatMul);
+  other->outputIndex = {3};
+  graph->nodes.emplace_back(std::move(other));
+  graph->outputIndex = {2, 3};
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+
+  // No block size, no encoding.
+  graph = BuildGraph(BuildNode(schema::PrimitiveType_FullConnection), BuildWeight({kSize, kSize}));
+  lite::BlockSparsePass no_sparse(0, 0, 0.5f);
+  ASSERT_EQ(no_sparse.Run(graph.get()), lite::RET_NO_CHANGE);
+}
+}  // namespace mindspore
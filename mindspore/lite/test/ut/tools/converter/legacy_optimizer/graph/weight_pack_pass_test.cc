@@ -0,0 +1,218 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "include/errorcode.h"
+#include "nnacl/op_base.h"
+#include "nnacl/fp32/matmul_fp32.h"
+#include "tools/converter/legacy_optimizer/graph/weight_pack_pass.h"
+
+namespace mindspore {
+class WeightPackPassTest : public mindspore::CommonTest {
+ public:
+  WeightPackPassTest() = default;
+};
+using MetaGraphTptr = std::shared_ptr<schema::MetaGraphT>;
+using CNodeTptr = std::unique_ptr<schema::CNodeT>;
+
+namespace {
+constexpr int kTile = C8NUM;
+
+std::unique_ptr<schema::TensorT> BuildTensor(const std::vector<int> &dims, bool is_const,
+                                             schema::Format format = schema::Format_NHWC) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->nodeType = is_const ? schema::NodeType_ValueNode : schema::NodeType_Parameter;
+  tensor->format = format;
+  tensor->dataType = TypeId::kNumberTypeFloat32;
+  tensor->dims = dims;
+  if (is_const) {
+    int total = 1;
+    for (auto dim : dims) {
+      total *= dim;
+    }
+    std::vector<float> data(total);
+    for (int i = 0; i < total; i++) {
+      data[i] = static_cast<float>(i + 1);
+    }
+    tensor->data.resize(total * sizeof(float));
+    memcpy(tensor->data.data(), data.data(), tensor->data.size());
+  }
+  return tensor;
+}
+
+CNodeTptr BuildFullConnection(uint32_t input, uint32_t weight, uint32_t output) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = {input, weight};
+  node->outputIndex = {output};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = schema::PrimitiveType_FullConnection;
+  node->primitive->value.value = new schema::FullConnectionT;
+  node->name = "FullConnection";
+  return node;
+}
+
+CNodeTptr BuildMatMul(uint32_t input, uint32_t weight, uint32_t output, bool transpose_b) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = {input, weight};
+  node->outputIndex = {output};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = schema::PrimitiveType_MatMul;
+  auto prim = new schema::MatMulT;
+  prim->transposeB = transpose_b;
+  node->primitive->value.value = prim;
+  node->name = "MatMul";
+  return node;
+}
+
+CNodeTptr BuildConv2D(uint32_t input, uint32_t weight, uint32_t output, int kernel) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = {input, weight};
+  node->outputIndex = {output};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = schema::PrimitiveType_Conv2D;
+  auto prim = new schema::Conv2DT;
+  prim->format = schema::Format_NHWC;
+  prim->group = 1;
+  prim->strideH = 1;
+  prim->strideW = 1;
+  prim->kernelH = kernel;
+  prim->kernelW = kernel;
+  prim->dilateH = 1;
+  prim->dilateW = 1;
+  prim->channelOut = 3;
+  node->primitive->value.value = prim;
+  node->name = "Conv2D";
+  return node;
+}
+
+// input [2, 8] -> node(weight) -> output
+MetaGraphTptr BuildGraph(CNodeTptr node, std::unique_ptr<schema::TensorT> weight) {
+  auto meta_graph = std::make_shared<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  meta_graph->allTensors.emplace_back(BuildTensor({2, 8}, false));
+  meta_graph->allTensors.emplace_back(std::move(weight));
+  meta_graph->allTensors.emplace_back(BuildTensor({2, 3}, false));
+  meta_graph->nodes.emplace_back(std::move(node));
+  meta_graph->inputIndex = {0};
+  meta_graph->outputIndex = {2};
+  return meta_graph;
+}
+
+std::vector<float> TensorData(const schema::TensorT &tensor) {
+  auto data = reinterpret_cast<const float *>(tensor.data.data());
+  return std::vector<float>(data, data + tensor.data.size() / sizeof(float));
+}
+}  // namespace
+
+TEST_F(WeightPackPassTest, TestFullConnection) {
+  auto graph = BuildGraph(BuildFullConnection(0, 1, 2), BuildTensor({3, 8}, true));
+  auto origin = TensorData(*graph->allTensors.at(1));
+  lite::WeightPackPass pass(schema::WeightPackIsa_ARM64, kTile);
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_OK);
+
+  auto &weight = graph->allTensors.at(1);
+  ASSERT_NE(weight->weightPack, nullptr);
+  ASSERT_EQ(weight->weightPack->layout, schema::WeightPackLayout_COL_TILE);
+  ASSERT_EQ(weight->weightPack->isa, schema::WeightPackIsa_ARM64);
+  ASSERT_EQ(weight->weightPack->colTile, kTile);
+  ASSERT_FALSE(weight->weightPack->deepMajor);
+  // The shape stays, the data is padded to the tile.
+  ASSERT_EQ(weight->dims, std::vector<int>({3, 8}));
+  std::vector<float> expect(UP_ROUND(3, kTile) * 8, 0.0f);
+  RowMajor2ColTileMajor(origin.data(), expect.data(), 3, 8, kTile);
+  ASSERT_EQ(TensorData(*weight), expect);
+
+  // Nothing left to do the second time.
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+}
+
+TEST_F(WeightPackPassTest, TestMatMul) {
+  // B of a MatMul without transpose is [deep][col].
+  auto graph = BuildGraph(BuildMatMul(0, 1, 2, false), BuildTensor({8, 3}, true));
+  auto origin = TensorData(*graph->allTensors.at(1));
+  lite::WeightPackPass pass(schema::WeightPackIsa_AVX, C16NUM);
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_OK);
+  auto &weight = graph->allTensors.at(1);
+  ASSERT_NE(weight->weightPack, nullptr);
+  ASSERT_TRUE(weight->weightPack->deepMajor);
+  std::vector<float> expect(8 * UP_ROUND(3, C16NUM), 0.0f);
+  RowMajor2RowTileMajor(origin.data(), expect.data(), 8, 3, C16NUM);
+  ASSERT_EQ(TensorData(*weight), expect);
+
+  graph = BuildGraph(BuildMatMul(0, 1, 2, true), BuildTensor({3, 8}, true));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_OK);
+  ASSERT_NE(graph->allTensors.at(1)->weightPack, nullptr);
+  ASSERT_FALSE(graph->allTensors.at(1)->weightPack->deepMajor);
+}
+
+TEST_F(WeightPackPassTest, TestConv2D) {
+  lite::WeightPackPass pass(schema::WeightPackIsa_ARM64, kTile);
+  auto graph = BuildGraph(BuildConv2D(0, 1, 2, 1), BuildTensor({3, 1, 1, 8}, true, schema::Format_KHWC));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_OK);
+  ASSERT_NE(graph->allTensors.at(1)->weightPack, nullptr);
+
+  // A 3x3 convolution with stride 1 may run as winograd, which packs the weight its own way.
+  graph = BuildGraph(BuildConv2D(0, 1, 2, 3), BuildTensor({3, 3, 3, 8}, true, schema::Format_KHWC));
+  auto origin = TensorData(*graph->allTensors.at(1));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+  ASSERT_EQ(graph->allTensors.at(1)->weightPack, nullptr);
+  ASSERT_EQ(TensorData(*graph->allTensors.at(1)), origin);
+
+  // So does a group convolution.
+  auto group_conv = BuildConv2D(0, 1, 2, 1);
+  group_conv->primitive->value.AsConv2D()->group = 2;
+  graph = BuildGraph(std::move(group_conv), BuildTensor({3, 1, 1, 4}, true, schema::Format_KHWC));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+}
+
+TEST_F(WeightPackPassTest, TestSkipWeight) {
+  lite::WeightPackPass pass(schema::WeightPackIsa_ARM64, kTile);
+  // Quantized nodes read the weight plain.
+  auto node = BuildFullConnection(0, 1, 2);
+  node->quantType = schema::QuantType_WeightQuant;
+  auto graph = BuildGraph(std::move(node), BuildTensor({3, 8}, true));
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+
+  // A weight used in two orientations has no single layout.
+  graph = BuildGraph(BuildFullConnection(0, 1, 2), BuildTensor({8, 8}, true));
+  graph->allTensors.emplace_back(BuildTensor({2, 8}, false));
+  graph->nodes.emplace_back(BuildMatMul(0, 1, 3, false));
+  graph->outputIndex = {2, 3};
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+
+  // Neither does a weight which is also read by another op.
+  graph = BuildGraph(BuildFullConnection(0, 1, 2), BuildTensor({3, 8}, true));
+  graph->allTensors.emplace_back(BuildTensor({2, 8}, false));
+  graph->nodes.emplace_back(BuildFullConnection(1, 0, 3));
+  graph->outputIndex = {2, 3};
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+
+  // Graph inputs are fed at runtime.
+  graph = BuildGraph(BuildFullConnection(0, 1, 2), BuildTensor({3, 8}, true));
+  graph->inputIndex = {0, 1};
+  ASSERT_EQ(pass.Run(graph.get()), lite::RET_NO_CHANGE);
+
+  // No tile, no packing.
+  graph = BuildGraph(BuildFullConnection(0, 1, 2), BuildTensor({3, 8}, true));
+  lite::WeightPackPass no_pack(schema::WeightPackIsa_GENERIC, 0);
+  ASSERT_EQ(no_pack.Run(graph.get()), lite::RET_NO_CHANGE);
+  ASSERT_EQ(graph->allTensors.at(1)->weightPack, nullptr);
+}
+}  // namespace mindspore
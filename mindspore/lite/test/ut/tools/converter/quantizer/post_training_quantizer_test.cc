@@ -0,0 +1,174 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/common_test.h"
+#include "ir/func_graph.h"
+#include "tools/converter/quantizer/post_training_quantizer.h"
+
+namespace mindspore {
+class PostTrainingQuantizerTest : public mindspore::CommonTest {
+ public:
+  PostTrainingQuantizerTest() = default;
+};
+
+namespace {
+using lite::quant::Calibrator;
+using lite::quant::DivergInfo;
+using lite::quant::DivergPartialMap;
+using DivergInfoMap = std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>>;
+
+constexpr int kBatchNum = 8;
+constexpr int kSessionNum = 3;
+constexpr int kDataSize = 64;
+constexpr int kBitNum = 8;
+// node name -- number of tensors the sessions record for it: the inputs of Concat and Add, the outputs otherwise
+const std::vector<std::pair<std::string, size_t>> kTensorNums = {{"Conv2D", 1}, {"Concat", 2}, {"Split", 3}};
+
+std::vector<float> BatchData(int batch, size_t tensor_index) {
+  std::vector<float> data(kDataSize);
+  int offset = batch * 31 + static_cast<int>(tensor_index) * 7;
+  for (int i = 0; i < kDataSize; i++) {
+    // the range depends on the batch, and some values are 0 which the histogram skips
+    data[i] = 0.1f * static_cast<float>((offset + i * 13) % 41 - 20) * (1 + batch % 3);
+  }
+  return data;
+}
+
+// what a session records for the batches it runs, batch, batch + step and so on
+DivergPartialMap Calibrate(int first_batch, int step, bool histogram, DivergInfoMap *infos) {
+  DivergPartialMap partials;
+  for (auto &node : kTensorNums) {
+    auto &node_partials = partials[node.first];
+    node_partials.resize(node.second);
+    for (int batch = first_batch; batch < kBatchNum; batch += step) {
+      for (size_t i = 0; i < node.second; i++) {
+        auto data = BatchData(batch, i);
+        if (histogram) {
+          auto &info = (*infos)[node.first].at(i);
+          node_partials[i].UpdateHistogram(data.data(), data.size(), info->interval, info->bin_num);
+        } else {
+          node_partials[i].RecordMaxValue(data.data(), data.size());
+        }
+      }
+    }
+  }
+  return partials;
+}
+
+// calibrate with session_num sessions taking interleaved batches, as PostTrainingQuantizer does
+void RunCalibration(int session_num, const std::string &method, const CNodePtr &cnode, DivergInfoMap *infos) {
+  for (auto &node : kTensorNums) {
+    (*infos)[node.first].push_back(
+      std::make_unique<DivergInfo>(cnode, lite::quant::kDefaultBinNumber, kBitNum, 127, -127, method));
+  }
+  std::vector<DivergPartialMap> partials;
+  for (int i = 0; i < session_num; i++) {
+    partials.push_back(Calibrate(i, session_num, false, infos));
+  }
+  Calibrator::MergeMaxValue(partials, infos);
+  ASSERT_EQ(Calibrator::UpdateDivergInverval(infos), lite::RET_OK);
+  partials.clear();
+  for (int i = 0; i < session_num; i++) {
+    partials.push_back(Calibrate(i, session_num, true, infos));
+  }
+  Calibrator::MergeHistogram(partials, infos);
+  for (auto &kv : *infos) {
+    for (auto &info : kv.second) {
+      ASSERT_EQ(info->ComputeThreshold(), lite::RET_OK);
+    }
+  }
+}
+
+std::vector<float> Sorted(std::vector<float> values) {
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+void CheckSameResult(const std::string &method) {
+  auto graph = std::make_shared<FuncGraph>();
+  auto cnode = graph->NewCNode({NewValueNode(graph)});
+  DivergInfoMap single;
+  DivergInfoMap parallel;
+  RunCalibration(1, method, cnode, &single);
+  RunCalibration(kSessionNum, method, cnode, &parallel);
+  for (auto &node : kTensorNums) {
+    auto &single_infos = single[node.first];
+    auto &parallel_infos = parallel[node.first];
+    // the first diverg info of the node is copied for each of its recorded tensors
+    ASSERT_EQ(single_infos.size(), node.second);
+    ASSERT_EQ(parallel_infos.size(), node.second);
+    for (size_t i = 0; i < node.second; i++) {
+      auto &expect = single_infos[i];
+      auto &info = parallel_infos[i];
+      EXPECT_EQ(info->cnode, cnode);
+      EXPECT_EQ(info->min, expect->min);
+      EXPECT_EQ(info->max, expect->max);
+      EXPECT_EQ(info->interval, expect->interval);
+      // the sessions take the batches in another order, the outlier method sorts them anyway
+      ASSERT_EQ(info->min_datas.size(), size_t(kBatchNum));
+      EXPECT_EQ(Sorted(info->min_datas), Sorted(expect->min_datas));
+      EXPECT_EQ(Sorted(info->max_datas), Sorted(expect->max_datas));
+      EXPECT_EQ(info->histogram, expect->histogram);
+      EXPECT_EQ(info->best_T, expect->best_T);
+      EXPECT_EQ(info->percent_result, expect->percent_result);
+    }
+  }
+}
+}  // namespace
+
+TEST_F(PostTrainingQuantizerTest, TestDivergPartial) {
+  auto data = BatchData(1, 0);
+  lite::quant::DivergPartial partial;
+  partial.RecordMaxValue(data.data(), data.size());
+  partial.RecordMaxValue(data.data(), 0);
+  auto min_max = std::minmax_element(data.begin(), data.end());
+  EXPECT_EQ(partial.min, *min_max.first);
+  EXPECT_EQ(partial.max, *min_max.second);
+  EXPECT_EQ(partial.min_datas, std::vector<float>({*min_max.first}));
+  EXPECT_EQ(partial.max_datas, std::vector<float>({*min_max.second}));
+
+  // the same bins as DivergInfo::UpdateHistogram, without its 1e-7 initial counts
+  DivergInfo info(nullptr, lite::quant::kDefaultBinNumber, kBitNum, 127, -127, lite::quant::kMethodKL);
+  ASSERT_EQ(info.RecordMaxValue(data), lite::RET_OK);
+  info.UpdateInterval();
+  ASSERT_EQ(info.UpdateHistogram(data), lite::RET_OK);
+  partial.UpdateHistogram(data.data(), data.size(), info.interval, info.bin_num);
+  ASSERT_EQ(partial.histogram.size(), info.histogram.size());
+  float count = 0;
+  for (size_t i = 0; i < partial.histogram.size(); i++) {
+    EXPECT_NEAR(partial.histogram[i] + 1.0e-7f, info.histogram[i], 1e-6);
+    count += partial.histogram[i];
+  }
+  EXPECT_EQ(count, static_cast<float>(std::count_if(data.begin(), data.end(), [](float v) { return v != 0; })));
+
+  // an interval of 0 only sizes the histogram
+  lite::quant::DivergPartial zero_partial;
+  zero_partial.UpdateHistogram(data.data(), data.size(), 0, info.bin_num);
+  EXPECT_EQ(zero_partial.histogram, std::vector<float>(info.bin_num, 0.0f));
+}
+
+TEST_F(PostTrainingQuantizerTest, TestMergeKL) { CheckSameResult(lite::quant::kMethodKL); }
+
+TEST_F(PostTrainingQuantizerTest, TestMergeMaxMin) { CheckSameResult(lite::quant::kMethodMaxMin); }
+
+TEST_F(PostTrainingQuantizerTest, TestMergeOutlier) { CheckSameResult(lite::quant::kMethodOutlier); }
+}  // namespace mindspore
@@ -0,0 +1,207 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "backend/optimizer/common/optimizer.h"
+#include "tools/converter/model_parser.h"
+#include "tools/anf_exporter/anf_exporter.h"
+#include "tools/optimizer/fusion/attention_fusion.h"
+
+namespace mindspore {
+class AttentionFusionTest : public mindspore::CommonTest {
+ public:
+  AttentionFusionTest() = default;
+};
+using MetaGraphTptr = std::shared_ptr<schema::MetaGraphT>;
+using CNodeTptr = std::unique_ptr<schema::CNodeT>;
+
+namespace {
+// [batch, head, seq, head_dim] of q, k and v
+const std::vector<int> kQkvShape = {2, 4, 6, 8};
+const std::vector<int> kScoreShape = {2, 4, 6, 6};
+constexpr float kScale = 0.125f;
+
+struct AttentionGraphOption {
+  std::vector<int> q_shape = kQkvShape;
+  std::vector<int> k_shape = kQkvShape;
+  int softmax_axis = -1;
+  // k goes through a Transpose swapping its last two dims, and the first MatMul does not transpose it
+  bool transpose_k = false;
+};
+
+CNodeTptr BuildNode(schema::PrimitiveType type, const std::vector<uint32_t> &inputs, uint32_t output) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->inputIndex = inputs;
+  node->outputIndex = {output};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = type;
+  node->name = schema::EnumNamePrimitiveType(type) + std::to_string(output);
+  return node;
+}
+
+std::unique_ptr<schema::TensorT> BuildTensor(const std::vector<int> &dims) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->nodeType = schema::NodeType::NodeType_ValueNode;
+  tensor->format = schema::Format_NHWC;
+  tensor->dataType = TypeId::kNumberTypeFloat32;
+  tensor->dims = dims;
+  tensor->offset = -1;
+  return tensor;
+}
+
+std::unique_ptr<schema::TensorT> BuildActivation(const std::vector<int> &dims) {
+  auto tensor = BuildTensor(dims);
+  tensor->nodeType = schema::NodeType::NodeType_Parameter;
+  return tensor;
+}
+
+// MatMul(SoftMax(Add(Mul(MatMul(q, k^T), scale), mask)), v)
+MetaGraphTptr BuildGraph(const AttentionGraphOption &option) {
+  auto meta_graph = std::make_shared<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  // 0: q, 1: k, 2: v, 3: mask, 4: scale
+  meta_graph->allTensors.emplace_back(BuildTensor(option.q_shape));
+  meta_graph->allTensors.emplace_back(BuildTensor(option.k_shape));
+  meta_graph->allTensors.emplace_back(BuildTensor(kQkvShape));
+  meta_graph->allTensors.emplace_back(BuildTensor({2, 1, 1, 6}));
+  auto scale = BuildTensor({1});
+  scale->data.resize(sizeof(float));
+  memcpy(scale->data.data(), &kScale, sizeof(float));
+  meta_graph->allTensors.emplace_back(std::move(scale));
+  meta_graph->inputIndex = {0, 1, 2, 3};
+
+  uint32_t key = 1;
+  if (option.transpose_k) {
+    auto k_shape = option.k_shape;
+    std::swap(k_shape.at(k_shape.size() - 1), k_shape.at(k_shape.size() - 2));
+    key = meta_graph->allTensors.size();
+    meta_graph->allTensors.emplace_back(BuildActivation(k_shape));
+    auto transpose = BuildNode(schema::PrimitiveType_Transpose, {1}, key);
+    auto transpose_attr = new schema::TransposeT;
+    transpose_attr->perm = {0, 1, 3, 2};
+    transpose->primitive->value.value = transpose_attr;
+    meta_graph->nodes.emplace_back(std::move(transpose));
+  }
+  uint32_t score = meta_graph->allTensors.size();
+  meta_graph->allTensors.emplace_back(BuildActivation(kScoreShape));
+  auto score_matmul = BuildNode(schema::PrimitiveType_MatMul, {0, key}, score);
+  auto score_attr = new schema::MatMulT;
+  score_attr->transposeB = !option.transpose_k;
+  score_matmul->primitive->value.value = score_attr;
+  meta_graph->nodes.emplace_back(std::move(score_matmul));
+
+  uint32_t scaled = meta_graph->allTensors.size();
+  meta_graph->allTensors.emplace_back(BuildActivation(kScoreShape));
+  auto mul = BuildNode(schema::PrimitiveType_Mul, {score, 4}, scaled);
+  mul->primitive->value.value = new schema::MulT;
+  meta_graph->nodes.emplace_back(std::move(mul));
+
+  uint32_t masked = meta_graph->allTensors.size();
+  meta_graph->allTensors.emplace_back(BuildActivation(kScoreShape));
+  auto add = BuildNode(schema::PrimitiveType_Add, {scaled, 3}, masked);
+  add->primitive->value.value = new schema::AddT;
+  meta_graph->nodes.emplace_back(std::move(add));
+
+  uint32_t prob = meta_graph->allTensors.size();
+  meta_graph->allTensors.emplace_back(BuildActivation(kScoreShape));
+  auto softmax = BuildNode(schema::PrimitiveType_SoftMax, {masked}, prob);
+  auto softmax_attr = new schema::SoftMaxT;
+  softmax_attr->axis = option.softmax_axis;
+  softmax->primitive->value.value = softmax_attr;
+  meta_graph->nodes.emplace_back(std::move(softmax));
+
+  uint32_t output = meta_graph->allTensors.size();
+  meta_graph->allTensors.emplace_back(BuildActivation(kQkvShape));
+  auto output_matmul = BuildNode(schema::PrimitiveType_MatMul, {prob, 2}, output);
+  output_matmul->primitive->value.value = new schema::MatMulT;
+  meta_graph->nodes.emplace_back(std::move(output_matmul));
+  meta_graph->outputIndex = {output};
+  return meta_graph;
+}
+
+std::unique_ptr<schema::MetaGraphT> RunAttentionFusion(const MetaGraphTptr &meta_graph) {
+  auto func_graph = lite::ModelParser::Fb2Anf(meta_graph.get());
+  if (func_graph == nullptr) {
+    return nullptr;
+  }
+  auto optimizer = std::make_shared<opt::GraphOptimizer>();
+  auto fusion_pm = std::make_shared<opt::PassManager>("attention fusion pass manager", false);
+  fusion_pm->AddPass(std::make_shared<opt::AttentionFusion>());
+  optimizer->AddPassManager(fusion_pm);
+  auto new_graph = optimizer->Optimize(func_graph);
+  if (new_graph == nullptr) {
+    return nullptr;
+  }
+  return std::unique_ptr<schema::MetaGraphT>(lite::Export(new_graph));
+}
+}  // namespace
+
+TEST_F(AttentionFusionTest, TestFuse) {
+  auto new_meta_graph = RunAttentionFusion(BuildGraph({}));
+  ASSERT_NE(new_meta_graph, nullptr);
+  ASSERT_EQ(new_meta_graph->nodes.size(), 1);
+  auto &attention = new_meta_graph->nodes.front();
+  ASSERT_EQ(attention->primitive->value.type, schema::PrimitiveType_Attention);
+  ASSERT_EQ(attention->inputIndex.size(), 4);
+  ASSERT_FLOAT_EQ(attention->primitive->value.AsAttention()->scale, kScale);
+  ASSERT_TRUE(attention->primitive->value.AsAttention()->transposeB);
+}
+
+TEST_F(AttentionFusionTest, TestFoldTranspose) {
+  AttentionGraphOption option;
+  option.transpose_k = true;
+  option.softmax_axis = 3;
+  auto new_meta_graph = RunAttentionFusion(BuildGraph(option));
+  ASSERT_NE(new_meta_graph, nullptr);
+  ASSERT_EQ(new_meta_graph->nodes.size(), 1);
+  ASSERT_EQ(new_meta_graph->nodes.front()->primitive->value.type, schema::PrimitiveType_Attention);
+  ASSERT_TRUE(new_meta_graph->nodes.front()->primitive->value.AsAttention()->transposeB);
+}
+
+TEST_F(AttentionFusionTest, TestBadCase_SoftmaxAxis) {
+  // a softmax over the query rows is not an attention
+  AttentionGraphOption option;
+  option.softmax_axis = 2;
+  auto new_meta_graph = RunAttentionFusion(BuildGraph(option));
+  ASSERT_NE(new_meta_graph, nullptr);
+  ASSERT_EQ(new_meta_graph->nodes.size(), 5);
+}
+
+TEST_F(AttentionFusionTest, TestBadCase_BroadcastKey) {
+  // the MatMul broadcasts a rank 2 k over the batch, the attention does not
+  AttentionGraphOption option;
+  option.k_shape = {6, 8};
+  auto new_meta_graph = RunAttentionFusion(BuildGraph(option));
+  ASSERT_NE(new_meta_graph, nullptr);
+  ASSERT_EQ(new_meta_graph->nodes.size(), 5);
+
+  option.k_shape = {1, 4, 6, 8};
+  new_meta_graph = RunAttentionFusion(BuildGraph(option));
+  ASSERT_NE(new_meta_graph, nullptr);
+  ASSERT_EQ(new_meta_graph->nodes.size(), 5);
+}
+
+TEST_F(AttentionFusionTest, TestBadCase_UnknownShape) {
+  AttentionGraphOption option;
+  option.q_shape = {};
+  auto new_meta_graph = RunAttentionFusion(BuildGraph(option));
+  ASSERT_NE(new_meta_graph, nullptr);
+  ASSERT_EQ(new_meta_graph->nodes.size(), 5);
+}
+}  // namespace mindspore
@@ -134,7 +134,8 @@ static const std::vector<schema::PrimitiveType> int8OpList = {schema::PrimitiveT
                                                               schema::PrimitiveType_PriorBox,
                                                               schema::PrimitiveType_QuantDTypeCast,
                                                               schema::PrimitiveType_LayerNorm,
-                                                              schema::PrimitiveType_L2Norm};
+                                                              schema::PrimitiveType_L2Norm,
+                                                              schema::PrimitiveType_Attention};
 
 static const std::vector<schema::PrimitiveType> needInsertOpList = {
 #ifdef SUPPORT_TRAIN
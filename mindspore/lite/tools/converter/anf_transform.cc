@@ -26,6 +26,7 @@
 #include "tools/optimizer/fusion/conv_tuplegetitem_fusion.h"
 #include "tools/optimizer/fusion/constant_folding_fusion.h"
 #include "tools/optimizer/fusion/layer_norm_fusion.h"
+#include "tools/optimizer/fusion/attention_fusion.h"
 #include "tools/optimizer/fusion/batchmatmul_fusion.h"
 #include "tools/optimizer/fusion/sigmoid_mul_fusion.h"
 #include "tools/optimizer/fusion/conv_conv_fusion.h"
@@ -93,6 +94,10 @@ FuncGraphPtr AnfTransform::Transform(const FuncGraphPtr &old_graph, const conver
     fusion_pm->AddPass(std::make_shared<opt::ConvBatchNormFusion>());
     fusion_pm->AddPass(std::make_shared<opt::ConvScaleFusion>());
     fusion_pm->AddPass(std::make_shared<opt::LayerNormFusion>());
+    // the int8 attention kernel is scalar, the int8 MatMul and SoftMax it would replace are not
+    if (config->quantType != schema::QuantType_PostTraining) {
+      fusion_pm->AddPass(std::make_shared<opt::AttentionFusion>());
+    }
     fusion_pm->AddPass(std::make_shared<opt::BatchMatMulFusion>());
     fusion_pm->AddPass(std::make_shared<opt::SigmoidMulFusion>());
     fusion_pm->AddPass(std::make_shared<opt::ConvActivationFusion>());
@@ -18,6 +18,7 @@
 #include <regex>
 #include <string>
 #include <algorithm>
+#include <cstdlib>
 #include "ir/dtype/type_id.h"
 
 namespace mindspore {
@@ -46,6 +47,14 @@ Flags::Flags() {
           "whether the model is going to be trained on device."
           "true | false",
           "false");
+  AddFlag(&Flags::weightPackIn, "weightPack",
+          "Pack the fp32 weights offline for the kernels of the target. NONE | ARM64 | ARM32 | SSE | AVX", "NONE");
+  AddFlag(&Flags::sparseBlockIn, "sparseBlock",
+          "Store the fp32 weights of FullConnection, MatMul and 1x1 Conv2D with enough zero blocks as block sparse. "
+          "Block is rows(output channels) x cols(input channels). NONE | 1x4 | 4x4",
+          "NONE");
+  AddFlag(&Flags::sparseThresholdIn, "sparseThreshold",
+          "Least share of zero blocks a weight needs to be stored block sparse, in (0, 1]", "0.7");
 }
 
 int Flags::Init(int argc, const char **argv) {
@@ -149,6 +158,46 @@ int Flags::Init(int argc, const char **argv) {
     return RET_INPUT_PARAM_INVALID;
   }
 
+  if (this->weightPackIn == "NONE") {
+    this->weightPackTile = 0;
+  } else if (this->weightPackIn == "ARM64") {
+    this->weightPackIsa = schema::WeightPackIsa_ARM64;
+    this->weightPackTile = 8;
+  } else if (this->weightPackIn == "ARM32") {
+    this->weightPackIsa = schema::WeightPackIsa_ARM32;
+    this->weightPackTile = 4;
+  } else if (this->weightPackIn == "SSE") {
+    this->weightPackIsa = schema::WeightPackIsa_SSE;
+    this->weightPackTile = 8;
+  } else if (this->weightPackIn == "AVX") {
+    this->weightPackIsa = schema::WeightPackIsa_AVX;
+    this->weightPackTile = 16;
+  } else {
+    std::cerr << "INPUT ILLEGAL: weightPack must be NONE|ARM64|ARM32|SSE|AVX";
+    return RET_INPUT_PARAM_INVALID;
+  }
+
+  if (this->sparseBlockIn == "NONE") {
+    this->sparseBlockRows = 0;
+    this->sparseBlockCols = 0;
+  } else if (this->sparseBlockIn == "1x4") {
+    this->sparseBlockRows = 1;
+    this->sparseBlockCols = 4;
+  } else if (this->sparseBlockIn == "4x4") {
+    this->sparseBlockRows = 4;
+    this->sparseBlockCols = 4;
+  } else {
+    std::cerr << "INPUT ILLEGAL: sparseBlock must be NONE|1x4|4x4";
+    return RET_INPUT_PARAM_INVALID;
+  }
+  char *threshold_end = nullptr;
+  this->sparseThreshold = strtof(this->sparseThresholdIn.c_str(), &threshold_end);
+  if (threshold_end == this->sparseThresholdIn.c_str() || *threshold_end != '\0' || !(this->sparseThreshold > 0) ||
+      this->sparseThreshold > 1) {
+    std::cerr << "INPUT ILLEGAL: sparseThreshold must be in (0, 1]";
+    return RET_INPUT_PARAM_INVALID;
+  }
+
   if (this->trainModelIn == "true") {
     this->trainModel = true;
   } else if (this->trainModelIn == "false") {
@@ -175,6 +224,14 @@ int Flags::Init(int argc, const char **argv) {
       std::cerr << "INPUT ILLEGAL: train model convertor is not supporting quantization";
       return RET_INPUT_PARAM_INVALID;
     }
+    if (this->weightPackTile != 0) {
+      std::cerr << "INPUT ILLEGAL: train model convertor is not supporting weight packing";
+      return RET_INPUT_PARAM_INVALID;
+    }
+    if (this->sparseBlockRows != 0) {
+      std::cerr << "INPUT ILLEGAL: train model convertor is not supporting block sparse weights";
+      return RET_INPUT_PARAM_INVALID;
+    }
   }
   return RET_OK;
 }
@@ -65,6 +65,16 @@ class Flags : public virtual mindspore::lite::FlagParser {
   std::string quantWeightChannel;
   std::string trainModelIn;
   bool trainModel = false;
+  // used for offline weight packing, a tile of 0 keeps the weights plain
+  std::string weightPackIn;
+  schema::WeightPackIsa weightPackIsa = schema::WeightPackIsa_GENERIC;
+  int weightPackTile = 0;
+  // used for block sparse weights, blocks of 0 rows keep the weights dense
+  std::string sparseBlockIn;
+  std::string sparseThresholdIn;
+  int sparseBlockRows = 0;
+  int sparseBlockCols = 0;
+  float sparseThreshold = 0.0f;
 };
 }  // namespace converter
 }  // namespace lite
@@ -37,6 +37,8 @@
 #include "tools/converter/legacy_optimizer/graph/tensor_name_pass.h"
 #include "tools/converter/legacy_optimizer/graph/infer_quant_param_pass.h"
 #include "tools/converter/legacy_optimizer/graph/set_unused_quant_param_to_default_pass.h"
+#include "tools/converter/legacy_optimizer/graph/weight_pack_pass.h"
+#include "tools/converter/legacy_optimizer/graph/block_sparse_pass.h"
 
 using std::string;
 namespace mindspore::lite {
@@ -192,6 +194,29 @@ int GraphDefTransform::Transform(const converter::Flags &ctx) {
     }
   }
 
+  // block sparse weights, before packing which leaves them alone
+  if (ctx.sparseBlockRows != 0) {
+    Optimizer sparseOptimizer;
+    sparseOptimizer.AddPass(
+      new (std::nothrow) BlockSparsePass(ctx.sparseBlockRows, ctx.sparseBlockCols, ctx.sparseThreshold));
+    status = sparseOptimizer.Run(graphDefT);
+    if (status != RET_OK && status != RET_NO_CHANGE) {
+      MS_LOG(ERROR) << "Run sparseOptimizer graphPasses Failed";
+      return status;
+    }
+  }
+
+  // weight packing
+  if (ctx.weightPackTile != 0) {
+    Optimizer weightPackOptimizer;
+    weightPackOptimizer.AddPass(new (std::nothrow) WeightPackPass(ctx.weightPackIsa, ctx.weightPackTile));
+    status = weightPackOptimizer.Run(graphDefT);
+    if (status != RET_OK && status != RET_NO_CHANGE) {
+      MS_LOG(ERROR) << "Run weightPackOptimizer graphPasses Failed";
+      return status;
+    }
+  }
+
   // topological sorting
   {
     Optimizer topologicalOptimizer;
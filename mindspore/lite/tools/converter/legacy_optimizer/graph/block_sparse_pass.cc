@@ -0,0 +1,83 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tools/converter/legacy_optimizer/graph/block_sparse_pass.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "nnacl/op_base.h"
+#include "nnacl/fp32/block_sparse_fp32.h"
+
+namespace mindspore::lite {
+bool BlockSparsePass::CanRewriteInput(const schema::CNodeT &node, size_t input_index, const schema::TensorT &weight,
+                                      bool *deep_major) const {
+  if (!IsMatrixWeightInput(node, input_index, weight, deep_major)) {
+    return false;
+  }
+  switch (node.primitive->value.type) {
+    case schema::PrimitiveType_MatMul:
+      return !node.primitive->value.AsMatMul()->transposeA;
+    case schema::PrimitiveType_Conv2D: {
+      auto attr = node.primitive->value.AsConv2D();
+      return attr->kernelH == 1 && attr->kernelW == 1;
+    }
+    default:
+      return true;
+  }
+}
+
+STATUS BlockSparsePass::RewriteWeight(schema::TensorT *weight, bool deep_major) const {
+  int col = 0;
+  int deep = 0;
+  auto status = GetMatrixSize(*weight, deep_major, &col, &deep);
+  if (status != RET_OK) {
+    return status;
+  }
+  auto origin = reinterpret_cast<const float *>(weight->data.data());
+  int block_num = BlockSparseCount(origin, col, deep, block_rows_, block_cols_, deep_major);
+  int all_block_num = UP_DIV(col, block_rows_) * UP_DIV(deep, block_cols_);
+  // A weight without data would be taken for a variable, so an all zero one stays dense.
+  if (block_num == 0 || all_block_num - block_num < threshold_ * all_block_num) {
+    return RET_NO_CHANGE;
+  }
+
+  std::vector<int> block_offsets(UP_DIV(col, block_rows_) + 1);
+  std::vector<int> block_index(block_num);
+  std::vector<float> value(block_num * block_rows_ * block_cols_);
+  BlockSparseMatrix matrix = {col, deep, block_rows_, block_cols_, 0, block_offsets.data(), block_index.data(),
+                              value.data()};
+  BlockSparseEncode(origin, deep_major, &matrix);
+  MS_LOG(INFO) << "Weight " << weight->name << " keeps " << block_num << " of its " << all_block_num << " blocks";
+  weight->data.resize(value.size() * sizeof(float));
+  memcpy(weight->data.data(), value.data(), weight->data.size());
+
+  weight->weightPack = std::make_unique<schema::WeightPackT>();
+  weight->weightPack->layout = schema::WeightPackLayout_BLOCK_SPARSE;
+  weight->weightPack->deepMajor = deep_major;
+  weight->weightPack->blockRows = block_rows_;
+  weight->weightPack->blockCols = block_cols_;
+  weight->weightPack->blockOffsets = std::move(block_offsets);
+  weight->weightPack->blockIndex = std::move(block_index);
+  return RET_OK;
+}
+
+STATUS BlockSparsePass::Run(schema::MetaGraphT *graph) {
+  if (block_rows_ <= 0 || block_cols_ <= 0) {
+    return RET_NO_CHANGE;
+  }
+  return ConstWeightPass::Run(graph);
+}
+}  // namespace mindspore::lite
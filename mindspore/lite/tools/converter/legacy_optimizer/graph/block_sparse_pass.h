@@ -0,0 +1,49 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_BLOCK_SPARSE_PASS_H
+#define MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_BLOCK_SPARSE_PASS_H
+
+#include "tools/converter/legacy_optimizer/graph/const_weight_pass.h"
+
+namespace mindspore {
+namespace lite {
+// Stores the fp32 weights of FullConnection, MatMul and 1x1 Conv2D whose share of all-zero blocks reaches the
+// threshold as block sparse, so that the model only holds their nonzero blocks and the kernels skip the others.
+class BlockSparsePass : public ConstWeightPass {
+ public:
+  BlockSparsePass(int block_rows, int block_cols, float threshold)
+      : block_rows_(block_rows), block_cols_(block_cols), threshold_(threshold) {}
+
+  ~BlockSparsePass() override = default;
+
+  STATUS Run(schema::MetaGraphT *graph) override;
+
+ protected:
+  bool CanRewriteInput(const schema::CNodeT &node, size_t input_index, const schema::TensorT &weight,
+                       bool *deep_major) const override;
+
+  // Return RET_NO_CHANGE if the weight has too few zero blocks.
+  STATUS RewriteWeight(schema::TensorT *weight, bool deep_major) const override;
+
+ private:
+  int block_rows_;
+  int block_cols_;
+  float threshold_;
+};
+}  // namespace lite
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_BLOCK_SPARSE_PASS_H
@@ -0,0 +1,116 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tools/converter/legacy_optimizer/graph/const_weight_pass.h"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include "src/common/utils.h"
+
+namespace mindspore::lite {
+namespace {
+constexpr size_t kWeightIndex = 1;
+constexpr size_t kMatrixDims = 2;
+constexpr size_t kConvWeightDims = 4;
+}  // namespace
+
+bool ConstWeightPass::IsMatrixWeightInput(const schema::CNodeT &node, size_t input_index,
+                                          const schema::TensorT &weight, bool *deep_major) {
+  if (input_index != kWeightIndex || node.primitive == nullptr || node.quantType != schema::QuantType_QUANT_NONE) {
+    return false;
+  }
+  switch (node.primitive->value.type) {
+    case schema::PrimitiveType_FullConnection:
+      *deep_major = false;
+      return weight.dims.size() == kMatrixDims;
+    case schema::PrimitiveType_MatMul:
+      *deep_major = !node.primitive->value.AsMatMul()->transposeB;
+      return weight.dims.size() == kMatrixDims;
+    case schema::PrimitiveType_Conv2D:
+      *deep_major = false;
+      return node.primitive->value.AsConv2D()->group == 1 && weight.dims.size() == kConvWeightDims &&
+             weight.format == schema::Format_KHWC;
+    default:
+      return false;
+  }
+}
+
+STATUS ConstWeightPass::GetMatrixSize(const schema::TensorT &weight, bool deep_major, int *col, int *deep) {
+  auto &dims = weight.dims;
+  int total = std::accumulate(dims.begin(), dims.end(), 1, std::multiplies<int>());
+  if (dims.empty() || total <= 0 || weight.data.size() != total * sizeof(float)) {
+    MS_LOG(ERROR) << "Size of weight " << weight.name << " does not match its shape";
+    return RET_ERROR;
+  }
+  *col = deep_major ? total / dims.front() : dims.front();
+  *deep = total / *col;
+  return RET_OK;
+}
+
+bool ConstWeightPass::CanRewrite(const schema::MetaGraphT &graph, uint32_t tensor_index, bool *deep_major) const {
+  bool used = false;
+  for (auto &node : graph.nodes) {
+    for (size_t i = 0; i < node->inputIndex.size(); i++) {
+      if (node->inputIndex.at(i) != tensor_index) {
+        continue;
+      }
+      bool node_deep_major = false;
+      if (!CanRewriteInput(*node, i, *graph.allTensors.at(tensor_index), &node_deep_major) ||
+          (used && node_deep_major != *deep_major)) {
+        return false;
+      }
+      *deep_major = node_deep_major;
+      used = true;
+    }
+  }
+  return used;
+}
+
+STATUS ConstWeightPass::Run(schema::MetaGraphT *graph) {
+  if (graph == nullptr) {
+    MS_LOG(ERROR) << "graph is nullptr";
+    return RET_NULL_PTR;
+  }
+  bool changed = false;
+  for (uint32_t i = 0; i < graph->allTensors.size(); i++) {
+    auto &tensor = graph->allTensors.at(i);
+    if (tensor->nodeType != schema::NodeType_ValueNode || tensor->dataType != kNumberTypeFloat32 ||
+        tensor->data.empty() || tensor->weightPack != nullptr) {
+      continue;
+    }
+    bool quantized = std::any_of(tensor->quantParams.begin(), tensor->quantParams.end(),
+                                 [](const std::unique_ptr<schema::QuantParamT> &param) { return param->inited; });
+    if (quantized || IsContain(graph->inputIndex, i) || IsContain(graph->outputIndex, i)) {
+      continue;
+    }
+    bool deep_major = false;
+    if (!CanRewrite(*graph, i, &deep_major)) {
+      continue;
+    }
+    auto status = RewriteWeight(tensor.get(), deep_major);
+    if (status == RET_NO_CHANGE) {
+      continue;
+    }
+    if (status != RET_OK) {
+      MS_LOG(ERROR) << "Rewrite weight " << tensor->name << " failed";
+      return status;
+    }
+    changed = true;
+  }
+  return changed ? RET_OK : RET_NO_CHANGE;
+}
+}  // namespace mindspore::lite
@@ -0,0 +1,56 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_CONST_WEIGHT_PASS_H
+#define MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_CONST_WEIGHT_PASS_H
+
+#include "tools/converter/optimizer.h"
+#include "tools/common/graph_util.h"
+
+namespace mindspore {
+namespace lite {
+// Base of the passes storing the const fp32 weights of FullConnection, MatMul and Conv2D in a layout the kernels
+// read directly. A weight is only rewritten if every node using it accepts the same orientation.
+class ConstWeightPass : public GraphPass {
+ public:
+  ConstWeightPass() = default;
+
+  ~ConstWeightPass() override = default;
+
+  STATUS Run(schema::MetaGraphT *graph) override;
+
+ protected:
+  // Whether input input_index of the node is a FullConnection, MatMul or group 1 Conv2D weight seen as a [col][deep]
+  // matrix, deep_major is set if it is stored [deep][col] instead.
+  static bool IsMatrixWeightInput(const schema::CNodeT &node, size_t input_index, const schema::TensorT &weight,
+                                  bool *deep_major);
+
+  // The [col][deep] sizes of a weight, fails if its data does not match its shape.
+  static STATUS GetMatrixSize(const schema::TensorT &weight, bool deep_major, int *col, int *deep);
+
+  // Whether the node reads input input_index in the new layout, deep_major is set to the orientation of the weight.
+  virtual bool CanRewriteInput(const schema::CNodeT &node, size_t input_index, const schema::TensorT &weight,
+                               bool *deep_major) const = 0;
+
+  // Return RET_NO_CHANGE to leave the weight as it is.
+  virtual STATUS RewriteWeight(schema::TensorT *weight, bool deep_major) const = 0;
+
+ private:
+  bool CanRewrite(const schema::MetaGraphT &graph, uint32_t tensor_index, bool *deep_major) const;
+};
+}  // namespace lite
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_CONST_WEIGHT_PASS_H
@@ -0,0 +1,72 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tools/converter/legacy_optimizer/graph/weight_pack_pass.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "nnacl/op_base.h"
+#include "nnacl/fp32/matmul_fp32.h"
+
+namespace mindspore::lite {
+bool WeightPackPass::CanRewriteInput(const schema::CNodeT &node, size_t input_index, const schema::TensorT &weight,
+                                     bool *deep_major) const {
+  if (!IsMatrixWeightInput(node, input_index, weight, deep_major)) {
+    return false;
+  }
+  if (node.primitive->value.type != schema::PrimitiveType_Conv2D) {
+    return true;
+  }
+  // The winograd convolutions pack the weight their own way.
+  auto attr = node.primitive->value.AsConv2D();
+  bool is_1x1 = attr->kernelH == 1 && attr->kernelW == 1;
+  bool maybe_winograd = attr->kernelH == attr->kernelW && attr->strideH == 1 && attr->strideW == 1 &&
+                        attr->dilateH == 1 && attr->dilateW == 1;
+  return is_1x1 || !maybe_winograd;
+}
+
+STATUS WeightPackPass::RewriteWeight(schema::TensorT *weight, bool deep_major) const {
+  int col = 0;
+  int deep = 0;
+  auto status = GetMatrixSize(*weight, deep_major, &col, &deep);
+  if (status != RET_OK) {
+    return status;
+  }
+  std::vector<float> packed(UP_ROUND(col, col_tile_) * deep, 0.0f);
+  auto origin = reinterpret_cast<const float *>(weight->data.data());
+  if (deep_major) {
+    RowMajor2RowTileMajor(origin, packed.data(), deep, col, col_tile_);
+  } else {
+    RowMajor2ColTileMajor(origin, packed.data(), col, deep, col_tile_);
+  }
+  weight->data.resize(packed.size() * sizeof(float));
+  memcpy(weight->data.data(), packed.data(), weight->data.size());
+
+  weight->weightPack = std::make_unique<schema::WeightPackT>();
+  weight->weightPack->layout = schema::WeightPackLayout_COL_TILE;
+  weight->weightPack->isa = isa_;
+  weight->weightPack->colTile = col_tile_;
+  weight->weightPack->deepMajor = deep_major;
+  return RET_OK;
+}
+
+STATUS WeightPackPass::Run(schema::MetaGraphT *graph) {
+  if (col_tile_ <= 0) {
+    return RET_NO_CHANGE;
+  }
+  return ConstWeightPass::Run(graph);
+}
+}  // namespace mindspore::lite
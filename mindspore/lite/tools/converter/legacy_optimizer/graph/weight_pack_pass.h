@@ -0,0 +1,46 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_WEIGHT_PACK_PASS_H
+#define MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_WEIGHT_PACK_PASS_H
+
+#include "tools/converter/legacy_optimizer/graph/const_weight_pass.h"
+
+namespace mindspore {
+namespace lite {
+// Stores the fp32 weights of FullConnection, MatMul and Conv2D in the layout the kernels of the target pack them to,
+// so that the runtime can use them without packing.
+class WeightPackPass : public ConstWeightPass {
+ public:
+  WeightPackPass(schema::WeightPackIsa isa, int col_tile) : isa_(isa), col_tile_(col_tile) {}
+
+  ~WeightPackPass() override = default;
+
+  STATUS Run(schema::MetaGraphT *graph) override;
+
+ protected:
+  bool CanRewriteInput(const schema::CNodeT &node, size_t input_index, const schema::TensorT &weight,
+                       bool *deep_major) const override;
+
+  STATUS RewriteWeight(schema::TensorT *weight, bool deep_major) const override;
+
+ private:
+  schema::WeightPackIsa isa_;
+  int col_tile_;
+};
+}  // namespace lite
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_WEIGHT_PACK_PASS_H
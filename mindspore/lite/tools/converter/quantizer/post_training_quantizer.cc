@@ -17,6 +17,7 @@
 #include "tools/converter/quantizer/post_training_quantizer.h"
 #include <dirent.h>
 #include <sys/stat.h>
+#include <atomic>
 #include <future>
 #include <map>
 #include <memory>
@@ -88,6 +89,39 @@ STATUS DivergInfo::UpdateHistogram(const std::vector<float> &data) {
   return RET_OK;
 }
 
+void DivergPartial::RecordMaxValue(const float *data, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  float max_num = data[0];
+  float min_num = data[0];
+  for (size_t i = 1; i < count; i++) {
+    max_num = std::max(data[i], max_num);
+    min_num = std::min(data[i], min_num);
+  }
+  this->max = std::max(max_num, this->max);
+  this->min = std::min(min_num, this->min);
+  this->max_datas.emplace_back(max_num);
+  this->min_datas.emplace_back(min_num);
+}
+
+void DivergPartial::UpdateHistogram(const float *data, size_t count, float interval, int bin_num) {
+  if (this->histogram.empty()) {
+    this->histogram.resize(bin_num, 0.0f);
+  }
+  // the interval is 0 only if every value recorded is 0, which the histogram skips anyway
+  if (interval == 0) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (data[i] == 0) {
+      continue;
+    }
+    int bin_index = std::min(static_cast<int>(std::fabs(data[i]) / interval), bin_num - 1);
+    this->histogram[bin_index]++;
+  }
+}
+
 void DivergInfo::DumpHistogram() {
   MS_LOG(INFO) << "Print node " << cnode->fullname_with_scope() << " histogram";
   for (float item : this->histogram) {
@@ -306,13 +340,37 @@ STATUS Calibrator::RecordMaxValue(const vector<float> &data, const std::unique_p
   return RET_OK;
 }
 
-STATUS Calibrator::ComputeThreshold() {
+namespace {
+// Run task(0) to task(task_num - 1) on thread_num threads, the calling one included.
+void ParallelFor(size_t task_num, size_t thread_num, const std::function<void(size_t)> &task) {
+  std::atomic<size_t> next_task(0);
+  auto worker = [&]() {
+    for (size_t i = next_task++; i < task_num; i = next_task++) {
+      task(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(thread_num, task_num); i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+}  // namespace
+
+STATUS Calibrator::ComputeThreshold(size_t thread_num) {
+  // the KL search of each tensor is independent of the others
+  std::vector<DivergInfo *> infos;
   for (auto &kv : this->outputs_diverg_info_) {
     auto &outputs_diverg_info = kv.second;
     for (auto &diverg_info : outputs_diverg_info) {
-      diverg_info->ComputeThreshold();
+      infos.push_back(diverg_info.get());
     }
   }
+  ParallelFor(infos.size(), thread_num, [&infos](size_t i) { infos[i]->ComputeThreshold(); });
+  infos.clear();
   // node A's input may be node B's output, no need to re-compute the node A's input quant param which is the same as
   for (auto &kv : this->inputs_diverg_info_) {
     auto &input_infos = kv.second;
@@ -340,10 +398,11 @@ STATUS Calibrator::ComputeThreshold() {
         }
       }
       if (!already_computed) {
-        input_infos[i]->ComputeThreshold();
+        infos.push_back(input_infos[i].get());
       }
     }
   }
+  ParallelFor(infos.size(), thread_num, [&infos](size_t i) { infos[i]->ComputeThreshold(); });
   return RET_OK;
 }
 
@@ -364,6 +423,52 @@ STATUS Calibrator::UpdateDataFrequency(const vector<float> &data, const std::uni
   return RET_OK;
 }
 
+void Calibrator::MergeMaxValue(const std::vector<DivergPartialMap> &partials,
+                               std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>> *diverg_info) {
+  MS_ASSERT(diverg_info != nullptr);
+  for (auto &session_partials : partials) {
+    for (auto &kv : session_partials) {
+      auto &infos = (*diverg_info)[kv.first];
+      MS_ASSERT(!infos.empty());
+      // every input of Concat and Add, and every output of a node, gets a copy of the first diverg info
+      while (infos.size() < kv.second.size()) {
+        auto diverg = std::make_unique<DivergInfo>();
+        *diverg = *infos[0];
+        infos.push_back(std::move(diverg));
+      }
+    }
+  }
+  for (auto &session_partials : partials) {
+    for (auto &kv : session_partials) {
+      auto &infos = (*diverg_info)[kv.first];
+      for (size_t i = 0; i < kv.second.size(); i++) {
+        auto &partial = kv.second[i];
+        infos[i]->max = std::max(partial.max, infos[i]->max);
+        infos[i]->min = std::min(partial.min, infos[i]->min);
+        infos[i]->max_datas.insert(infos[i]->max_datas.end(), partial.max_datas.begin(), partial.max_datas.end());
+        infos[i]->min_datas.insert(infos[i]->min_datas.end(), partial.min_datas.begin(), partial.min_datas.end());
+      }
+    }
+  }
+}
+
+void Calibrator::MergeHistogram(
+  const std::vector<DivergPartialMap> &partials,
+  std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>> *diverg_info) {
+  MS_ASSERT(diverg_info != nullptr);
+  for (auto &session_partials : partials) {
+    for (auto &kv : session_partials) {
+      auto &infos = (*diverg_info)[kv.first];
+      for (size_t i = 0; i < kv.second.size() && i < infos.size(); i++) {
+        auto &histogram = kv.second[i].histogram;
+        for (size_t j = 0; j < histogram.size() && j < infos[i]->histogram.size(); j++) {
+          infos[i]->histogram[j] += histogram[j];
+        }
+      }
+    }
+  }
+}
+
 STATUS Calibrator::AddQuantizedOp(const CNodePtr &node) {
   if (node == nullptr) {
     MS_LOG(ERROR) << "To be quantized node is null";
@@ -528,6 +633,12 @@ STATUS Calibrator::ReadConfig() {
       config_param_.batch_count = std::stoul(value);
     } else if (key == "thread_num") {
       config_param_.thread_num = std::stoul(value);
+    } else if (key == "parallel_num") {
+      config_param_.parallel_num = std::stoul(value);
+      if (config_param_.parallel_num == 0) {
+        MS_LOG(WARNING) << "parallel_num should be positive. Use default value.";
+        config_param_.parallel_num = 1;
+      }
     } else if (key == "method_x") {
       if (value != kMethodKL && value != kMethodMaxMin && value != kMethodOutlier) {
         MS_LOG(WARNING) << "unsupported method_x: " << value << ". Use default value.";
@@ -550,6 +661,7 @@ STATUS Calibrator::ReadConfig() {
   MS_LOG(DEBUG) << "batch_count: " << config_param_.batch_count << "  "
                 << "method_x: " << config_param_.method_x << "  "
                 << "thread_num: " << config_param_.thread_num << " "
+                << "parallel_num: " << config_param_.parallel_num << " "
                 << "bias_correction: " << config_param_.bias_correction;
 
   delete[] resolved_path;
@@ -1034,20 +1146,117 @@ STATUS PostTrainingQuantizer::CheckFp32TensorVec(const std::string &node_name,
   return RET_OK;
 }
 
+namespace {
+// Feed the data of tensors to the partials of the first tensor_num of them.
+void UpdatePartials(const std::vector<mindspore::tensor::MSTensor *> &tensors, size_t tensor_num,
+                    const std::vector<std::unique_ptr<DivergInfo>> &infos, bool histogram,
+                    std::vector<DivergPartial> *partials) {
+  MS_ASSERT(partials != nullptr);
+  tensor_num = std::min(tensor_num, tensors.size());
+  if (partials->size() < tensor_num) {
+    partials->resize(tensor_num);
+  }
+  for (size_t i = 0; i < tensor_num; i++) {
+    auto tensor = tensors[i];
+    MS_ASSERT(tensor != nullptr);
+    const auto *tensor_data = static_cast<const float *>(tensor->MutableData());
+    MS_ASSERT(tensor_data != nullptr);
+    size_t elem_count = tensor->ElementsNum();
+    if (histogram) {
+      // the diverg infos of every tensor exist once the max values are merged
+      MS_ASSERT(i < infos.size());
+      (*partials)[i].UpdateHistogram(tensor_data, elem_count, infos[i]->interval, infos[i]->bin_num);
+    } else {
+      (*partials)[i].RecordMaxValue(tensor_data, elem_count);
+    }
+  }
+}
+}  // namespace
+
+STATUS PostTrainingQuantizer::CreateCalibSessions(Model *model) {
+  Context ctx;
+  ctx.thread_num_ = calibrator_->GetThreadNum();
+  if (calibrator_->GetParallelNum() > 1) {
+    // sessions binding their threads to the same cores would run one after another
+    ctx.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = NO_BIND;
+  }
+  for (size_t i = 0; i < calibrator_->GetParallelNum(); i++) {
+    auto session = dynamic_cast<mindspore::lite::LiteSession *>(session::LiteSession::CreateSession(&ctx));
+    if (session == nullptr) {
+      MS_LOG(ERROR) << "create session failed!";
+      return RET_ERROR;
+    }
+    calib_sessions_.push_back(session);
+    // the sessions share the packed weights of the model
+    auto ret = session->CompileGraph(model);
+    if (ret != lite::RET_OK) {
+      MS_LOG(ERROR) << "compile graph error";
+      return RET_ERROR;
+    }
+  }
+  fp32_session_ = calib_sessions_.front();
+  return RET_OK;
+}
+
+void PostTrainingQuantizer::DeleteCalibSessions() {
+  // fp32_session_ is kept for the bias correction
+  for (size_t i = 1; i < calib_sessions_.size(); i++) {
+    delete calib_sessions_[i];
+  }
+  calib_sessions_.resize(std::min(calib_sessions_.size(), size_t(1)));
+}
+
 /**
  * 1. create input tensor
  * 2. insert callback to session
- * 3. run session
+ * 3. run session on the batches of session_index, recording to the partials of the session
  **/
-STATUS PostTrainingQuantizer::DoInference() {
+STATUS PostTrainingQuantizer::CalibrateSession(size_t session_index, bool histogram, DivergPartialMap *input_partials,
+                                               DivergPartialMap *output_partials) {
+  MS_ASSERT(input_partials != nullptr);
+  MS_ASSERT(output_partials != nullptr);
+  auto *session = calib_sessions_[session_index];
   // get input tensor
-  vector<mindspore::tensor::MSTensor *> inputs = fp32_session_->GetInputs();
+  vector<mindspore::tensor::MSTensor *> inputs = session->GetInputs();
   if (inputs.size() != calibrator_->GetInputNum()) {
     MS_LOG(ERROR) << "model's input tensor cnt: " << inputs.size() << " != " << calibrator_->GetInputNum();
     return RET_ERROR;
   }
-
-  for (size_t i = 0; i < calibrator_->GetBatchNum(); i++) {
+  // The diverg infos are only read while the sessions run, the partials of the session are only written by it.
+  KernelCallBack beforeCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &beforeInputs,
+                                      const std::vector<mindspore::tensor::MSTensor *> &beforeOutputs,
+                                      const CallBackParam &callParam) -> bool {
+    auto diverg_info_map = calibrator_->GetInputDivergInfo();
+    auto iter = diverg_info_map->find(callParam.node_name);
+    if (iter == diverg_info_map->end()) {
+      return true;
+    }
+    if (PostTrainingQuantizer::CheckFp32TensorVec(callParam.node_name, beforeInputs) != RET_OK) {
+      return false;
+    }
+    size_t tensor_num = iter->second.size();
+    if (!histogram && tensor_num == 1 && (callParam.node_type == kTypeConcat || callParam.node_type == kTypeAdd)) {
+      tensor_num = beforeInputs.size();
+    }
+    UpdatePartials(beforeInputs, tensor_num, iter->second, histogram, &(*input_partials)[callParam.node_name]);
+    return true;
+  };
+  KernelCallBack afterCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &afterInputs,
+                                     const std::vector<mindspore::tensor::MSTensor *> &afterOutputs,
+                                     const CallBackParam &callParam) -> bool {
+    auto diverg_info_map = calibrator_->GetOutputDivergInfo();
+    auto iter = diverg_info_map->find(callParam.node_name);
+    if (iter == diverg_info_map->end()) {
+      return true;
+    }
+    if (PostTrainingQuantizer::CheckFp32TensorVec(callParam.node_name, afterOutputs) != RET_OK) {
+      return false;
+    }
+    size_t tensor_num = histogram ? iter->second.size() : afterOutputs.size();
+    UpdatePartials(afterOutputs, tensor_num, iter->second, histogram, &(*output_partials)[callParam.node_name]);
+    return true;
+  };
+  for (size_t i = session_index; i < calibrator_->GetBatchNum(); i += calib_sessions_.size()) {
     // set multi-input data
     for (size_t input_index = 0; input_index < inputs.size(); input_index++) {
       STATUS status = calibrator_->GenerateInputData(input_index, i, inputs[input_index]);
@@ -1056,65 +1265,7 @@ STATUS PostTrainingQuantizer::DoInference() {
         return RET_ERROR;
       }
     }
-
-    KernelCallBack beforeCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &beforeInputs,
-                                        const std::vector<mindspore::tensor::MSTensor *> &beforeOutputs,
-                                        const CallBackParam &callParam) -> bool {
-      auto diverg_info_map = calibrator_->GetInputDivergInfo();
-      if (diverg_info_map->find(callParam.node_name) == diverg_info_map->end()) {
-        return true;
-      }
-      if (PostTrainingQuantizer::CheckFp32TensorVec(callParam.node_name, beforeInputs) != RET_OK) {
-        return false;
-      }
-      if ((*diverg_info_map)[callParam.node_name].size() == 1 &&
-          (callParam.node_type == kTypeConcat || callParam.node_type == kTypeAdd)) {
-        for (size_t i = 1; i < beforeInputs.size(); i++) {
-          auto input_diverg = std::make_unique<DivergInfo>();
-          *input_diverg = *((*diverg_info_map)[callParam.node_name][0]);
-          (*diverg_info_map)[callParam.node_name].push_back(std::move(input_diverg));
-        }
-      }
-      for (size_t i = 0; i < (*diverg_info_map)[callParam.node_name].size(); i++) {
-        auto tensor = beforeInputs[i];
-        MS_ASSERT(tensor != nullptr);
-        const auto *tensor_data = static_cast<const float *>(tensor->MutableData());
-        MS_ASSERT(tensor_data != nullptr);
-        size_t elem_count = tensor->ElementsNum();
-        vector<float> data(tensor_data, tensor_data + elem_count);
-        this->calibrator_->RecordMaxValue(data, (*diverg_info_map)[callParam.node_name][i]);
-      }
-      return true;
-    };
-    // func
-    KernelCallBack afterCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &afterInputs,
-                                       const std::vector<mindspore::tensor::MSTensor *> &afterOutputs,
-                                       const CallBackParam &callParam) -> bool {
-      auto diverg_info_map = calibrator_->GetOutputDivergInfo();
-      if (diverg_info_map->find(callParam.node_name) == diverg_info_map->end()) {
-        return true;
-      }
-      if (PostTrainingQuantizer::CheckFp32TensorVec(callParam.node_name, afterOutputs) != RET_OK) {
-        return false;
-      }
-      if ((*diverg_info_map)[callParam.node_name].size() == 1 && afterOutputs.size() > 1) {
-        for (size_t i = 1; i < afterOutputs.size(); i++) {
-          auto output_diverg = std::make_unique<DivergInfo>();
-          *output_diverg = *((*diverg_info_map)[callParam.node_name][0]);
-          (*diverg_info_map)[callParam.node_name].push_back(std::move(output_diverg));
-        }
-      }
-      size_t output_i = 0;
-      for (const auto &tensor : afterOutputs) {
-        const auto *tensor_data = static_cast<const float *>(tensor->MutableData());
-        size_t elem_count = tensor->ElementsNum();
-        vector<float> data(tensor_data, tensor_data + elem_count);
-        this->calibrator_->RecordMaxValue(data, (*diverg_info_map)[callParam.node_name][output_i]);
-        output_i++;
-      }
-      return true;
-    };
-    auto status = fp32_session_->RunGraph(beforeCallBack, afterCallBack);
+    auto status = session->RunGraph(beforeCallBack, afterCallBack);
     if (status != RET_OK) {
       MS_LOG(ERROR) << "run model failed!";
       return RET_ERROR;
@@ -1123,6 +1274,35 @@ STATUS PostTrainingQuantizer::DoInference() {
   return RET_OK;
 }
 
+STATUS PostTrainingQuantizer::RunCalibration(bool histogram) {
+  size_t session_num = calib_sessions_.size();
+  std::vector<DivergPartialMap> input_partials(session_num);
+  std::vector<DivergPartialMap> output_partials(session_num);
+  std::vector<std::future<STATUS>> results;
+  for (size_t i = 1; i < session_num; i++) {
+    results.push_back(std::async(std::launch::async, &PostTrainingQuantizer::CalibrateSession, this, i, histogram,
+                                 &input_partials[i], &output_partials[i]));
+  }
+  auto status = CalibrateSession(0, histogram, &input_partials[0], &output_partials[0]);
+  for (auto &result : results) {
+    auto session_status = result.get();
+    status = status == RET_OK ? session_status : status;
+  }
+  if (status != RET_OK) {
+    return status;
+  }
+  if (histogram) {
+    Calibrator::MergeHistogram(input_partials, calibrator_->GetInputDivergInfo());
+    Calibrator::MergeHistogram(output_partials, calibrator_->GetOutputDivergInfo());
+  } else {
+    Calibrator::MergeMaxValue(input_partials, calibrator_->GetInputDivergInfo());
+    Calibrator::MergeMaxValue(output_partials, calibrator_->GetOutputDivergInfo());
+  }
+  return RET_OK;
+}
+
+STATUS PostTrainingQuantizer::DoInference() { return RunCalibration(false); }
+
 STATUS PostTrainingQuantizer::Int8Inference() {
   // int8 inference
   vector<mindspore::tensor::MSTensor *> inputs = int8_session_->GetInputs();
@@ -1500,79 +1680,12 @@ STATUS PostTrainingQuantizer::BiasCorrection(const FuncGraphPtr &func_graph) {
   return ret;
 }
 
-STATUS PostTrainingQuantizer::CollectDataFrequency() {
-  // get input tensor
-  vector<mindspore::tensor::MSTensor *> inputs = fp32_session_->GetInputs();
-  if (inputs.size() != calibrator_->GetInputNum()) {
-    MS_LOG(ERROR) << "model's input tensor cnt: " << inputs.size() << " != " << calibrator_->GetInputNum();
-    return RET_ERROR;
-  }
-
-  for (size_t i = 0; i < calibrator_->GetBatchNum(); i++) {
-    // set multi-input data
-    for (size_t input_index = 0; input_index < inputs.size(); input_index++) {
-      STATUS status = calibrator_->GenerateInputData(input_index, i, inputs[input_index]);
-      if (status != RET_OK) {
-        MS_LOG(ERROR) << "generate input data from images failed!";
-        return RET_ERROR;
-      }
-    }
-
-    KernelCallBack beforeCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &beforeInputs,
-                                        const std::vector<mindspore::tensor::MSTensor *> &beforeOutputs,
-                                        const CallBackParam &callParam) {
-      auto diverg_info_map = calibrator_->GetInputDivergInfo();
-      if (diverg_info_map->find(callParam.node_name) == diverg_info_map->end()) {
-        return true;
-      }
-      if (PostTrainingQuantizer::CheckFp32TensorVec(callParam.node_name, beforeInputs) != RET_OK) {
-        return false;
-      }
-      for (size_t i = 0; i < (*diverg_info_map)[callParam.node_name].size(); i++) {
-        auto tensor = beforeInputs[i];
-        MS_ASSERT(tensor != nullptr);
-        const auto *tensor_data = static_cast<const float *>(tensor->MutableData());
-        MS_ASSERT(tensor_data != nullptr);
-        size_t elem_count = tensor->ElementsNum();
-        vector<float> data(tensor_data, tensor_data + elem_count);
-        this->calibrator_->UpdateDataFrequency(data, (*diverg_info_map)[callParam.node_name][i]);
-      }
-      return true;
-    };
-
-    KernelCallBack afterCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &after_inputs,
-                                       const std::vector<mindspore::tensor::MSTensor *> &after_outputs,
-                                       const CallBackParam &call_param) {
-      auto diverg_info_map = calibrator_->GetOutputDivergInfo();
-      if (diverg_info_map->find(call_param.node_name) == diverg_info_map->end()) {
-        return true;
-      }
-      if (PostTrainingQuantizer::CheckFp32TensorVec(call_param.node_name, after_outputs) != RET_OK) {
-        return false;
-      }
-      int output_i = 0;
-      for (const auto &tensor : after_outputs) {
-        const auto *tensor_data = static_cast<const float *>(tensor->MutableData());
-        MS_ASSERT(tensor_data != nullptr);
-        size_t elem_count = tensor->ElementsNum();
-        vector<float> data(tensor_data, tensor_data + elem_count);
-        this->calibrator_->UpdateDataFrequency(data, (*diverg_info_map)[call_param.node_name][output_i]);
-        output_i++;
-      }
-      return true;
-    };
-    auto status = fp32_session_->RunGraph(beforeCallBack, afterCallBack);
-    if (status != RET_OK) {
-      MS_LOG(ERROR) << "run model failed!";
-      return RET_ERROR;
-    }
-  }
+STATUS PostTrainingQuantizer::CollectDataFrequency() { return RunCalibration(true); }
 
-  return RET_OK;
+STATUS PostTrainingQuantizer::ComputeThreshold() {
+  return this->calibrator_->ComputeThreshold(calibrator_->GetParallelNum() * calibrator_->GetThreadNum());
 }
 
-STATUS PostTrainingQuantizer::ComputeThreshold() { return this->calibrator_->ComputeThreshold(); }
-
 STATUS PostTrainingQuantizer::DoQuantize(FuncGraphPtr func_graph) {
   MS_LOG(INFO) << "start to parse config file";
   STATUS status = PreProcess();
@@ -1608,33 +1721,27 @@ STATUS PostTrainingQuantizer::DoQuantize(FuncGraphPtr func_graph) {
   }
   auto model = lite::Model::Import(content, size);
 
-  Context ctx;
-  ctx.thread_num_ = calibrator_->GetThreadNum();
-
-  fp32_session_ = dynamic_cast<mindspore::lite::LiteSession *>(session::LiteSession::CreateSession(&ctx));
-  if (fp32_session_ == nullptr) {
-    MS_LOG(ERROR) << "create session failed!";
-    return RET_ERROR;
-  }
-
-  auto ret = fp32_session_->CompileGraph(model);
-  if (ret != lite::RET_OK) {
-    MS_LOG(ERROR) << "compile graph error";
-    return RET_ERROR;
+  status = CreateCalibSessions(model);
+  if (status != RET_OK) {
+    DeleteCalibSessions();
+    return status;
   }
 
   MS_LOG(INFO) << "start to update divergence's max value";
   status = DoInference();
   if (status != RET_OK) {
+    DeleteCalibSessions();
     return status;
   }
   MS_LOG(INFO) << "start to update divergence's interval";
   status = UpdateDivergInverval();
   if (status != RET_OK) {
+    DeleteCalibSessions();
     return status;
   }
   MS_LOG(INFO) << "start to collect data's distribution";
   status = CollectDataFrequency();
+  DeleteCalibSessions();
   if (status != RET_OK) {
     return status;
   }
@@ -1698,7 +1805,7 @@ STATUS PostTrainingQuantizer::DoQuantize(FuncGraphPtr func_graph) {
       MS_LOG(ERROR) << "create session failed!";
       return RET_ERROR;
     }
-    ret = int8_session_->CompileGraph(int8_model);
+    auto ret = int8_session_->CompileGraph(int8_model);
     if (ret != lite::RET_OK) {
       MS_LOG(ERROR) << "compile graph error";
       return RET_ERROR;
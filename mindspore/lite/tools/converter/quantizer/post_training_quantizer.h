@@ -48,9 +48,27 @@ struct ConfigParam {
   uint32_t batch_count{100};
   std::string method_x{kMethodKL};
   uint32_t thread_num{1};
+  uint32_t parallel_num{1};  // number of fp32 sessions running the calibration batches at the same time
   bool bias_correction{false};
 };
 
+// Statistics of one tensor gathered by one calibration session. Each session keeps partials of its own while the
+// sessions run in parallel, and the partials are merged into the DivergInfo of the tensor after the runs.
+struct DivergPartial {
+  float min = FLT_MAX;
+  float max = -FLT_MAX;
+  std::vector<float> min_datas;
+  std::vector<float> max_datas;
+  std::vector<float> histogram;
+
+  void RecordMaxValue(const float *data, size_t count);
+
+  void UpdateHistogram(const float *data, size_t count, float interval, int bin_num);
+};
+
+// partials of a session: node name -- partial of each of its input or output tensors
+using DivergPartialMap = std::unordered_map<std::string, std::vector<DivergPartial>>;
+
 class PostTrainingQuantizer : public Quantizer {
  public:
   PostTrainingQuantizer(FuncGraphPtr graph, std::string path, int bit_num, TypeId target_type = kNumberTypeInt8,
@@ -72,6 +90,8 @@ class PostTrainingQuantizer : public Quantizer {
 
   mindspore::lite::LiteSession *fp32_session_;
   mindspore::lite::LiteSession *int8_session_;
+  // sessions running the calibration batches in parallel, the first one is fp32_session_
+  std::vector<mindspore::lite::LiteSession *> calib_sessions_;
 
   std::map<std::string, std::vector<float>> fp32_op_input_map;           // concurency
   std::map<std::string, std::vector<float>> fp32_op_output_ch_mean_map;  // concurency
@@ -97,6 +117,15 @@ class PostTrainingQuantizer : public Quantizer {
   STATUS CheckFp32TensorVec(const std::string &node_name,
                             const std::vector<mindspore::tensor::MSTensor *> &tensor_vec) const;
 
+  STATUS CreateCalibSessions(Model *model);
+
+  void DeleteCalibSessions();
+
+  STATUS CalibrateSession(size_t session_index, bool histogram, DivergPartialMap *input_partials,
+                          DivergPartialMap *output_partials);
+
+  STATUS RunCalibration(bool histogram);
+
   STATUS DoInference();
 
   STATUS UpdateDivergInverval();
@@ -182,6 +211,8 @@ class Calibrator {
 
   uint32_t GetThreadNum() const { return config_param_.thread_num; }
 
+  uint32_t GetParallelNum() const { return config_param_.parallel_num; }
+
   std::string GetMethodX() const { return config_param_.method_x; }
 
   bool GetBiasCorrection() const { return config_param_.bias_correction; }
@@ -196,9 +227,15 @@ class Calibrator {
     std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>> *diverg_info);
 
   static STATUS UpdateDataFrequency(const std::vector<float> &data, const std::unique_ptr<DivergInfo> &diverg_info);
+
+  static void MergeMaxValue(const std::vector<DivergPartialMap> &partials,
+                            std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>> *diverg_info);
+
+  static void MergeHistogram(const std::vector<DivergPartialMap> &partials,
+                             std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>> *diverg_info);
   void Dump();
 
-  STATUS ComputeThreshold();
+  STATUS ComputeThreshold(size_t thread_num = 1);
 
   static std::unordered_map<CNodePtr, float> GetScale(
     std::unordered_map<std::string, std::unique_ptr<DivergInfo>> *diverg_info);
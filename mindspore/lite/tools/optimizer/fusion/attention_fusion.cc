@@ -0,0 +1,292 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tools/optimizer/fusion/attention_fusion.h"
+#include <memory>
+#include <vector>
+#include "src/ops/primitive_c.h"
+#include "src/param_value_lite.h"
+#include "schema/inner/model_generated.h"
+#include "utils/utils.h"
+#include "tools/optimizer/common/gllo_utils.h"
+#include "src/ops/add.h"
+#include "src/ops/div.h"
+#include "src/ops/matmul.h"
+#include "src/ops/mul.h"
+#include "src/ops/softmax.h"
+#include "src/ops/transpose.h"
+
+namespace mindspore {
+namespace opt {
+namespace {
+constexpr size_t kUnaryInputsLength = 2;
+constexpr size_t kBinaryInputsLength = 3;
+
+struct ScoreMatch {
+  AnfNodePtr query = nullptr;
+  AnfNodePtr key = nullptr;
+  bool transpose_b = true;
+  float scale = 1.0f;
+};
+
+bool IsMatMulNode(const BaseRef &n) {
+  if (utils::isa<CNodePtr>(n) || utils::isa<ValueNodePtr>(n)) {
+    auto type = opt::GetCNodeType(n);
+    return type == schema::PrimitiveType_MatMul;
+  }
+  return false;
+}
+
+bool IsSoftMaxNode(const BaseRef &n) {
+  if (utils::isa<CNodePtr>(n) || utils::isa<ValueNodePtr>(n)) {
+    auto type = opt::GetCNodeType(n);
+    return type == schema::PrimitiveType_SoftMax;
+  }
+  return false;
+}
+
+bool IsQuantized(const CNodePtr &cnode) {
+  auto primitive_c = GetValueNode<std::shared_ptr<lite::PrimitiveC>>(cnode->input(0));
+  return primitive_c == nullptr || primitive_c->quant_type() != schema::QuantType_QUANT_NONE;
+}
+
+// the node as a cnode of the type, if nothing outside the attention uses it
+CNodePtr GetFusableCNode(const FuncGraphPtr &func_graph, const AnfNodePtr &node, schema::PrimitiveType type,
+                         size_t input_size) {
+  if (node == nullptr || !utils::isa<CNodePtr>(node) || opt::GetCNodeType(node) != type) {
+    return nullptr;
+  }
+  auto cnode = node->cast<CNodePtr>();
+  if (cnode->inputs().size() != input_size || IsQuantized(cnode) || IsMultiOutputTensors(func_graph, cnode)) {
+    return nullptr;
+  }
+  return cnode;
+}
+
+bool GetScalarConst(const AnfNodePtr &node, float *value) {
+  if (!utils::isa<ParameterPtr>(node) && !utils::isa<ValueNodePtr>(node)) {
+    return false;
+  }
+  auto param_value = GetLiteParamValue(node);
+  if (param_value == nullptr || param_value->tensor_addr() == nullptr ||
+      param_value->tensor_type() != kNumberTypeFloat32 || param_value->tensor_shape_size() != 1) {
+    return false;
+  }
+  *value = *reinterpret_cast<float *>(param_value->tensor_addr());
+  return true;
+}
+
+// shape of the node as given by the model, empty if it is unknown
+ShapeVector GetNodeShape(const AnfNodePtr &node) {
+  auto abstract = node->abstract();
+  if (abstract == nullptr || !utils::isa<abstract::AbstractTensorPtr>(abstract)) {
+    return {};
+  }
+  auto shape = utils::cast<abstract::ShapePtr>(abstract->GetShapeTrack());
+  return shape == nullptr ? ShapeVector() : shape->shape();
+}
+
+// the attention does not broadcast q, k and v like the MatMuls may do, they need the same rank and batch dims
+bool HasSameBatchDims(const AnfNodePtr &query, const AnfNodePtr &key, const AnfNodePtr &value) {
+  auto q_shape = GetNodeShape(query);
+  auto k_shape = GetNodeShape(key);
+  auto v_shape = GetNodeShape(value);
+  if (q_shape.size() < 2 || k_shape.size() != q_shape.size() || v_shape.size() != q_shape.size()) {
+    return false;
+  }
+  for (size_t i = 0; i + 2 < q_shape.size(); ++i) {
+    if (k_shape.at(i) != q_shape.at(i) || v_shape.at(i) != q_shape.at(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsLastTwoDimsSwapped(const std::vector<int> &perm) {
+  int rank = static_cast<int>(perm.size());
+  if (rank < 2 || perm.at(rank - 2) != rank - 1 || perm.at(rank - 1) != rank - 2) {
+    return false;
+  }
+  for (int i = 0; i < rank - 2; ++i) {
+    if (perm.at(i) != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// node = MatMul(q, k) scaled by an optional Mul, Div or RealDiv with a scalar const
+bool MatchScore(const FuncGraphPtr &func_graph, const AnfNodePtr &node, ScoreMatch *match) {
+  AnfNodePtr matmul_node = node;
+  match->scale = 1.0f;
+  auto type = utils::isa<CNodePtr>(node) ? opt::GetCNodeType(node) : schema::PrimitiveType_NONE;
+  if (type == schema::PrimitiveType_Mul || type == schema::PrimitiveType_Div ||
+      type == schema::PrimitiveType_RealDiv) {
+    auto scale_cnode = GetFusableCNode(func_graph, node, type, kBinaryInputsLength);
+    if (scale_cnode == nullptr) {
+      return false;
+    }
+    auto primitive_c = GetValueNode<std::shared_ptr<lite::PrimitiveC>>(scale_cnode->input(0));
+    if (type == schema::PrimitiveType_Mul &&
+        utils::cast<std::shared_ptr<lite::Mul>>(primitive_c)->GetActivationType() !=
+          schema::ActivationType_NO_ACTIVATION) {
+      return false;
+    }
+    if (type == schema::PrimitiveType_Div &&
+        utils::cast<std::shared_ptr<lite::Div>>(primitive_c)->GetActivationType() !=
+          schema::ActivationType_NO_ACTIVATION) {
+      return false;
+    }
+    float value = 0.0f;
+    if (GetScalarConst(scale_cnode->input(2), &value)) {
+      matmul_node = scale_cnode->input(1);
+    } else if (type == schema::PrimitiveType_Mul && GetScalarConst(scale_cnode->input(1), &value)) {
+      matmul_node = scale_cnode->input(2);
+    } else {
+      return false;
+    }
+    if (type != schema::PrimitiveType_Mul) {
+      if (value == 0.0f) {
+        return false;
+      }
+      value = 1.0f / value;
+    }
+    match->scale = value;
+  }
+
+  auto matmul_cnode = GetFusableCNode(func_graph, matmul_node, schema::PrimitiveType_MatMul, kBinaryInputsLength);
+  if (matmul_cnode == nullptr) {
+    return false;
+  }
+  auto matmul = utils::cast<std::shared_ptr<lite::MatMul>>(
+    GetValueNode<std::shared_ptr<lite::PrimitiveC>>(matmul_cnode->input(0)));
+  if (matmul == nullptr || matmul->GetTransposeA()) {
+    return false;
+  }
+  match->query = matmul_cnode->input(1);
+  match->key = matmul_cnode->input(2);
+  match->transpose_b = matmul->GetTransposeB();
+  if (!match->transpose_b) {
+    // a transpose building k^T is folded into the attention
+    auto transpose_cnode =
+      GetFusableCNode(func_graph, match->key, schema::PrimitiveType_Transpose, kUnaryInputsLength);
+    if (transpose_cnode != nullptr) {
+      auto transpose = utils::cast<std::shared_ptr<lite::Transpose>>(
+        GetValueNode<std::shared_ptr<lite::PrimitiveC>>(transpose_cnode->input(0)));
+      if (transpose != nullptr && IsLastTwoDimsSwapped(transpose->GetPerm())) {
+        match->key = transpose_cnode->input(1);
+        match->transpose_b = true;
+      }
+    }
+  }
+  return true;
+}
+}  // namespace
+
+const BaseRef AttentionFusion::DefinePattern() const {
+  auto softmax = std::make_shared<CondVar>(IsSoftMaxNode);
+  VectorRef softmax_ref = VectorRef({softmax, score_});
+  auto matmul = std::make_shared<CondVar>(IsMatMulNode);
+  return VectorRef({matmul, softmax_ref, value_});
+}
+
+const AnfNodePtr AttentionFusion::Process(const FuncGraphPtr &func_graph, const AnfNodePtr &node,
+                                          const EquivPtr &) const {
+  MS_ASSERT(func_graph != nullptr);
+  MS_ASSERT(node != nullptr);
+  MS_LOG(DEBUG) << "attention pass";
+  if (CheckIfFuncGraphIsNull(func_graph) != lite::RET_OK || CheckIfAnfNodeIsNull(node) != lite::RET_OK) {
+    lite::ReturnCode::GetSingleReturnCode()->UpdateReturnCode(lite::RET_NULL_PTR);
+    return nullptr;
+  }
+
+  // softmax(score) * v
+  auto output_cnode = node->cast<CNodePtr>();
+  if (CheckIfCNodeIsNull(output_cnode) != lite::RET_OK ||
+      CheckInputSize(output_cnode, kBinaryInputsLength) != lite::RET_OK || IsQuantized(output_cnode)) {
+    return nullptr;
+  }
+  auto output_matmul = utils::cast<std::shared_ptr<lite::MatMul>>(
+    GetValueNode<std::shared_ptr<lite::PrimitiveC>>(output_cnode->input(0)));
+  if (output_matmul == nullptr || output_matmul->GetTransposeA() || output_matmul->GetTransposeB()) {
+    return nullptr;
+  }
+  auto softmax_cnode =
+    GetFusableCNode(func_graph, output_cnode->input(1), schema::PrimitiveType_SoftMax, kUnaryInputsLength);
+  if (softmax_cnode == nullptr) {
+    return nullptr;
+  }
+  auto softmax = utils::cast<std::shared_ptr<lite::SoftMax>>(
+    GetValueNode<std::shared_ptr<lite::PrimitiveC>>(softmax_cnode->input(0)));
+  if (softmax == nullptr) {
+    return nullptr;
+  }
+
+  // score, or score + mask
+  ScoreMatch match;
+  AnfNodePtr mask_node = nullptr;
+  auto score_node = softmax_cnode->input(1);
+  auto add_cnode = GetFusableCNode(func_graph, score_node, schema::PrimitiveType_Add, kBinaryInputsLength);
+  if (add_cnode != nullptr) {
+    auto add = utils::cast<std::shared_ptr<lite::Add>>(
+      GetValueNode<std::shared_ptr<lite::PrimitiveC>>(add_cnode->input(0)));
+    if (add == nullptr || add->GetActivationType() != schema::ActivationType_NO_ACTIVATION) {
+      return nullptr;
+    }
+    if (MatchScore(func_graph, add_cnode->input(1), &match)) {
+      mask_node = add_cnode->input(2);
+    } else if (MatchScore(func_graph, add_cnode->input(2), &match)) {
+      mask_node = add_cnode->input(1);
+    } else {
+      return nullptr;
+    }
+  } else if (!MatchScore(func_graph, score_node, &match)) {
+    return nullptr;
+  }
+  auto value_node = output_cnode->input(2);
+  if (!HasSameBatchDims(match.query, match.key, value_node)) {
+    MS_LOG(DEBUG) << "shapes of " << output_cnode->fullname_with_scope() << " are unknown or broadcast";
+    return nullptr;
+  }
+  // the score has the rank of q, and the softmax has to run over its last axis
+  auto axis = softmax->GetAxis();
+  if (axis != -1 && axis != static_cast<int>(GetNodeShape(match.query).size()) - 1) {
+    return nullptr;
+  }
+
+  auto attention_primitive = std::make_unique<schema::PrimitiveT>();
+  auto attr = std::make_unique<schema::AttentionT>();
+  attr->scale = match.scale;
+  attr->transposeB = match.transpose_b;
+  attention_primitive->value.type = schema::PrimitiveType_Attention;
+  attention_primitive->value.value = attr.release();
+  auto attention_cvalue = lite::PrimitiveC::Create(attention_primitive.release());
+  if (attention_cvalue == nullptr) {
+    MS_LOG(ERROR) << "create attention primitive failed";
+    return nullptr;
+  }
+  auto primitive_node = NewValueNode(std::shared_ptr<lite::PrimitiveC>(attention_cvalue));
+  std::vector<AnfNodePtr> new_node_inputs = {primitive_node, match.query, match.key, value_node};
+  if (mask_node != nullptr) {
+    new_node_inputs.push_back(mask_node);
+  }
+  auto attention_cnode = func_graph->NewCNode(new_node_inputs);
+  attention_cnode->set_abstract(output_cnode->abstract()->Clone());
+  attention_cnode->set_fullname_with_scope("attention_" + output_cnode->fullname_with_scope());
+  MS_LOG(INFO) << "attention node:" << attention_cnode->fullname_with_scope() << " fusion success";
+  return attention_cnode;
+}
+}  // namespace opt
+}  // namespace mindspore
@@ -0,0 +1,50 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_TOOLS_OPTIMIZER_FUSION_ATTENTION_FUSION_H_
+#define MINDSPORE_LITE_TOOLS_OPTIMIZER_FUSION_ATTENTION_FUSION_H_
+
+#include <memory>
+#include <string>
+#include "backend/optimizer/common/optimizer.h"
+#include "utils/utils.h"
+
+namespace mindspore {
+namespace opt {
+/*
+ * MatMul(SoftMax(Add(Mul(MatMul(q, k), scale), mask)), v) -> Attention(q, k, v, mask)
+ * the scale may be a RealDiv instead of a Mul, and the scale and the mask are both optional.
+ */
+class AttentionFusion : public PatternProcessPass {
+ public:
+  explicit AttentionFusion(const std::string &name = "attention_fusion", bool multigraph = true)
+      : PatternProcessPass(name, multigraph) {
+    score_ = std::make_shared<Var>();
+    value_ = std::make_shared<Var>();
+  }
+
+  ~AttentionFusion() override = default;
+  const BaseRef DefinePattern() const override;
+  const AnfNodePtr Process(const FuncGraphPtr &, const AnfNodePtr &, const EquivPtr &) const override;
+
+ private:
+  VarPtr score_;
+  VarPtr value_;
+};
+}  // namespace opt
+}  // namespace mindspore
+
+#endif  // MINDSPORE_LITE_TOOLS_OPTIMIZER_FUSION_ATTENTION_FUSION_H_
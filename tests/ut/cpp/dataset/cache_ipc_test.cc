@@ -0,0 +1,228 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "minddata/dataset/engine/cache/cache_grpc_client.h"
+#include "minddata/dataset/engine/cache/cache_ipc.h"
+#include "minddata/dataset/engine/cache/cache_request.h"
+#include "minddata/dataset/util/path.h"
+#include "common/common.h"
+#include "utils/log_adapter.h"
+
+using namespace mindspore::dataset;
+using State = SharedRequestQueue::SlotState;
+
+namespace {
+// Ports no cache server is expected to listen on. Each test uses its own so that the queues never clash.
+constexpr int32_t kSlotPort = 50091;
+constexpr int32_t kBellPort = 50092;
+constexpr int32_t kFreeBlockPort = 50093;
+// What the shared memory block handed to the client is tagged with.
+constexpr connection_id_type kConnectionId = 1;
+constexpr int32_t kClientId = 2;
+constexpr int64_t kAddr = 1024;
+}  // namespace
+
+class MindDataTestCacheIpc : public UT::Common {
+ public:
+  MindDataTestCacheIpc() = default;
+
+  // The shared memory keys are made from the unix socket file which the server normally creates.
+  static void TouchSocketFile(int32_t port) {
+    Path dir(kDefaultPathPrefix);
+    ASSERT_TRUE(dir.CreateDirectories().IsOk());
+    std::ofstream f(PortToUnixSocketPath(port));
+    ASSERT_TRUE(f.good());
+  }
+
+  static void RemoveSocketFile(int32_t port) {
+    Path p(PortToUnixSocketPath(port));
+    (void)p.Remove();
+  }
+
+  // Play the server side of the queue and a client attached to it.
+  static void OpenQueues(int32_t port, std::unique_ptr<SharedRequestQueue> *server_q,
+                         std::unique_ptr<SharedRequestQueue> *client_q) {
+    TouchSocketFile(port);
+    ASSERT_TRUE(SharedRequestQueue::CreateQueue(port, server_q).IsOk());
+    ASSERT_TRUE(SharedRequestQueue::AttachQueue(port, client_q).IsOk());
+  }
+};
+
+TEST_F(MindDataTestCacheIpc, TestSlotStateMachine) {
+  std::unique_ptr<SharedRequestQueue> server_q;
+  std::unique_ptr<SharedRequestQueue> client_q;
+  OpenQueues(kSlotPort, &server_q, &client_q);
+  const int32_t num_slots = client_q->NumSlots();
+  ASSERT_EQ(num_slots, server_q->NumSlots());
+  ASSERT_GE(num_slots, 3);
+  // Every slot can be claimed once and only once.
+  std::vector<int32_t> claimed;
+  for (auto i = 0; i < num_slots; ++i) {
+    auto slot_id = client_q->ClaimSlot();
+    ASSERT_NE(slot_id, -1);
+    ASSERT_EQ(server_q->GetState(slot_id), State::kClaimed);
+    claimed.push_back(slot_id);
+  }
+  std::sort(claimed.begin(), claimed.end());
+  ASSERT_TRUE(std::adjacent_find(claimed.begin(), claimed.end()) == claimed.end());
+  ASSERT_EQ(client_q->ClaimSlot(), -1);
+
+  // A full round trip. The server sees what the client writes through its own mapping.
+  const std::string msg = "request";
+  auto *slot = client_q->GetSlot(0);
+  slot->sz = static_cast<int64_t>(msg.size());
+  memcpy(slot->buf, msg.data(), msg.size());
+  client_q->SetState(0, State::kRequest);
+  ASSERT_EQ(server_q->GetSlot(0)->sz, static_cast<int64_t>(msg.size()));
+  ASSERT_EQ(std::string(server_q->GetSlot(0)->buf, msg.size()), msg);
+  ASSERT_TRUE(server_q->Transit(0, State::kRequest, State::kProcessing));
+  // Only one server thread picks it up.
+  ASSERT_FALSE(server_q->Transit(0, State::kRequest, State::kProcessing));
+  ASSERT_TRUE(server_q->Transit(0, State::kProcessing, State::kReply));
+  // It is too late to give up once the reply is there. The client reads it and frees the slot.
+  ASSERT_FALSE(client_q->Abandon(0));
+  ASSERT_EQ(client_q->GetState(0), State::kReply);
+  client_q->SetState(0, State::kFree);
+  ASSERT_EQ(client_q->ClaimSlot(), 0);
+
+  // Giving up on a request the server hasn't picked up frees the slot right away.
+  client_q->SetState(1, State::kRequest);
+  ASSERT_TRUE(client_q->Abandon(1));
+  ASSERT_EQ(server_q->GetState(1), State::kFree);
+  ASSERT_FALSE(server_q->Transit(1, State::kRequest, State::kProcessing));
+
+  // Giving up on a request being processed leaves the slot to the server, which can't post the reply.
+  client_q->SetState(2, State::kRequest);
+  ASSERT_TRUE(server_q->Transit(2, State::kRequest, State::kProcessing));
+  ASSERT_TRUE(client_q->Abandon(2));
+  ASSERT_EQ(server_q->GetState(2), State::kAbandoned);
+  ASSERT_FALSE(server_q->Transit(2, State::kProcessing, State::kReply));
+  server_q->SetState(2, State::kFree);
+  ASSERT_EQ(client_q->GetState(2), State::kFree);
+
+  client_q.reset();
+  server_q.reset();
+  RemoveSocketFile(kSlotPort);
+}
+
+TEST_F(MindDataTestCacheIpc, TestDoorbell) {
+  std::unique_ptr<SharedRequestQueue> server_q;
+  std::unique_ptr<SharedRequestQueue> client_q;
+  OpenQueues(kBellPort, &server_q, &client_q);
+  // A poller which just found nothing polls again right away.
+  auto seen = server_q->RequestBell();
+  server_q->WaitForRequest(seen, 1);
+  // A long idle one sleeps, but wakes up on its own once in a while.
+  server_q->WaitForRequest(seen, std::numeric_limits<int32_t>::max());
+  ASSERT_EQ(server_q->RequestBell(), seen);
+  client_q->RingRequestBell();
+  ASSERT_NE(server_q->RequestBell(), seen);
+  ASSERT_EQ(server_q->ReplyBell(), client_q->ReplyBell());
+
+  // The client sleeps until the server posts the reply.
+  auto slot_id = client_q->ClaimSlot();
+  ASSERT_NE(slot_id, -1);
+  client_q->SetState(slot_id, State::kRequest);
+  std::thread client([&client_q, slot_id]() {
+    int32_t num_idle = 0;
+    auto bell = client_q->ReplyBell();
+    while (client_q->GetState(slot_id) != State::kReply) {
+      client_q->WaitForReply(bell, ++num_idle);
+      bell = client_q->ReplyBell();
+    }
+    client_q->SetState(slot_id, State::kFree);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_TRUE(server_q->Transit(slot_id, State::kRequest, State::kProcessing));
+  ASSERT_TRUE(server_q->Transit(slot_id, State::kProcessing, State::kReply));
+  server_q->RingReplyBell();
+  client.join();
+  ASSERT_EQ(server_q->GetState(slot_id), State::kFree);
+
+  client_q.reset();
+  server_q.reset();
+  RemoveSocketFile(kBellPort);
+}
+
+TEST_F(MindDataTestCacheIpc, TestFreeSharedBlock) {
+  // Play the server: the shared memory arena and the request queue the client attaches to.
+  TouchSocketFile(kFreeBlockPort);
+  SharedMemory::shm_key_t shm_key;
+  ASSERT_TRUE(PortToFtok(kFreeBlockPort, &shm_key).IsOk());
+  SharedMemory arena(shm_key);
+  arena.RemoveResourcesOnExit();
+  ASSERT_TRUE(arena.Create(4096).IsOk());
+  std::unique_ptr<SharedRequestQueue> server_q;
+  ASSERT_TRUE(SharedRequestQueue::CreateQueue(kFreeBlockPort, &server_q).IsOk());
+
+  auto comm = std::make_shared<CacheClientGreeter>("127.0.0.1", kFreeBlockPort, 1);
+  ASSERT_TRUE(comm->ServiceStart().IsOk());
+  bool local_bypass = false;
+  ASSERT_TRUE(comm->AttachToSharedMemory(&local_bypass).IsOk());
+  if (!local_bypass) {
+    MS_LOG(INFO) << "Built without local client support. Nothing to test.";
+    comm.reset();
+    server_q.reset();
+    RemoveSocketFile(kFreeBlockPort);
+    return;
+  }
+
+  // The last tensor using a block can go away on any thread.
+  std::thread th([comm]() { auto pool = std::make_shared<SharedBlockPool>(comm, kConnectionId, kClientId, kAddr); });
+  th.join();
+
+  // The client sends the request from its own thread. Pick it up like the server does.
+  int32_t slot_id = -1;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (slot_id == -1 && std::chrono::steady_clock::now() < deadline) {
+    for (auto i = 0; i < server_q->NumSlots(); ++i) {
+      if (server_q->Transit(i, State::kRequest, State::kProcessing)) {
+        slot_id = i;
+        break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_NE(slot_id, -1);
+  auto *slot = server_q->GetSlot(slot_id);
+  EXPECT_TRUE(BitTest(slot->flag, SharedRequestQueue::kNoReply));
+  CacheRequest rq;
+  ASSERT_TRUE(rq.ParseFromArray(slot->buf, slot->sz));
+  EXPECT_EQ(rq.type(), static_cast<int32_t>(BaseRequest::RequestType::kFreeSharedBlock));
+  EXPECT_EQ(rq.connection_id(), kConnectionId);
+  EXPECT_EQ(rq.client_id(), kClientId);
+  ASSERT_EQ(rq.buf_data_size(), 1);
+  EXPECT_EQ(rq.buf_data(0), std::to_string(kAddr));
+  server_q->SetState(slot_id, State::kFree);
+  EXPECT_EQ(comm->NumPendingFreeBlocks(), 0);
+
+  // Once the client is stopped there is nobody to send the request. The block is dropped.
+  ASSERT_TRUE(comm->ServiceStop().IsOk());
+  comm->FreeSharedBlock(kConnectionId, kClientId, kAddr);
+  EXPECT_EQ(comm->NumPendingFreeBlocks(), 0);
+
+  comm.reset();
+  server_q.reset();
+  RemoveSocketFile(kFreeBlockPort);
+}
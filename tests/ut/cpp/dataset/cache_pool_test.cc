@@ -0,0 +1,267 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include "minddata/dataset/engine/cache/cache_hw.h"
+#include "minddata/dataset/engine/cache/cache_numa.h"
+#include "minddata/dataset/engine/cache/cache_pool.h"
+#include "minddata/dataset/util/path.h"
+#include "common/common.h"
+#include "utils/log_adapter.h"
+
+using namespace mindspore::dataset;
+
+namespace {
+constexpr size_t kRowSz = 4000;
+// Room for about 16 rows once the arena adds its own header to each block.
+constexpr int64_t kPoolSz = 16 * 4096;
+}  // namespace
+
+class MindDataTestCachePool : public UT::Common {
+ public:
+  MindDataTestCachePool() = default;
+
+  // A memory pool which only holds a few rows, so that we run out of memory quickly.
+  std::shared_ptr<NumaMemoryPool> SmallPool() {
+    auto hw = std::make_shared<CacheServerHW>();
+    float ratio = static_cast<float>(kPoolSz) / CacheServerHW::GetTotalSystemMemory();
+    return std::make_shared<NumaMemoryPool>(hw, ratio);
+  }
+
+  static std::string Row(int64_t key) { return std::string(kRowSz, static_cast<char>('a' + key % 26)); }
+
+  static Status InsertRow(CachePool *cp, int64_t key) {
+    std::string row = Row(key);
+    return cp->Insert(key, {ReadableSlice(row.data(), row.size())});
+  }
+
+  static Status ReadRow(const CachePool &cp, int64_t key, std::string *out) {
+    out->assign(kRowSz, '\0');
+    WritableSlice dest(&(*out)[0], out->size());
+    return cp.Read(key, &dest);
+  }
+
+  static void RemoveFolder(Path folder) {
+    if (!folder.Exists()) {
+      return;
+    }
+    auto it = Path::DirIterator::OpenDirectory(&folder);
+    while (it->hasNext()) {
+      (void)it->next().Remove();
+    }
+    (void)folder.Remove();
+  }
+
+  // Save a few rows, some of them compressed, in a checkpoint which outlives the pool.
+  void SaveRows(const std::string &root, const std::string &name, int64_t num_rows) {
+    CachePool cp(SmallPool(), root, CacheEvictPolicy::kEvictNone, kDefaultPinEpochs, true, false, name);
+    ASSERT_TRUE(cp.ServiceStart().IsOk());
+    ASSERT_FALSE(cp.Modified());
+    for (int64_t key = 0; key < num_rows / 2; ++key) {
+      ASSERT_TRUE(InsertRow(&cp, key).IsOk());
+    }
+    ASSERT_TRUE(cp.Modified());
+    ASSERT_TRUE(cp.Checkpoint().IsOk());
+    ASSERT_FALSE(cp.Modified());
+    // The second checkpoint only writes the new rows but saves the whole index.
+    for (int64_t key = num_rows / 2; key < num_rows; ++key) {
+      ASSERT_TRUE(InsertRow(&cp, key).IsOk());
+    }
+    ASSERT_TRUE(cp.Checkpoint().IsOk());
+    cp.Persist();
+  }
+
+  static void LookUp(const CachePool &cp, int64_t key) {
+    auto fbb = std::make_shared<flatbuffers::FlatBufferBuilder>();
+    flatbuffers::Offset<DataLocatorMsg> offset;
+    ASSERT_TRUE(cp.GetDataLocator(key, fbb, &offset).IsOk());
+  }
+};
+
+TEST_F(MindDataTestCachePool, TestEvictLru) {
+  CachePool cp(SmallPool(), "", CacheEvictPolicy::kEvictLru, kDefaultPinEpochs, false, true);
+  ASSERT_TRUE(cp.ServiceStart().IsOk());
+  // Twice as many rows as the memory holds. The oldest ones make room for the new ones.
+  constexpr int64_t num_rows = 32;
+  for (int64_t key = 0; key < num_rows; ++key) {
+    ASSERT_TRUE(InsertRow(&cp, key).IsOk());
+  }
+  auto stat = cp.GetStat(true);
+  EXPECT_GT(stat.num_evicted, 0);
+  EXPECT_EQ(stat.num_mem_cached + stat.num_evicted, num_rows);
+  EXPECT_EQ(stat.num_disk_cached, 0);
+  EXPECT_EQ(stat.gap.size(), stat.num_evicted);
+  // The least recently used rows went first.
+  EXPECT_EQ(stat.gap.front(), 0);
+  std::string out;
+  EXPECT_EQ(ReadRow(cp, 0, &out).get_code(), StatusCode::kFileNotExist);
+  ASSERT_TRUE(ReadRow(cp, num_rows - 1, &out).IsOk());
+  EXPECT_EQ(out, Row(num_rows - 1));
+}
+
+TEST_F(MindDataTestCachePool, TestReadmit) {
+  CachePool cp(SmallPool(), "", CacheEvictPolicy::kEvictLru, kDefaultPinEpochs, false, true);
+  ASSERT_TRUE(cp.ServiceStart().IsOk());
+  constexpr int64_t num_rows = 32;
+  for (int64_t key = 0; key < num_rows; ++key) {
+    ASSERT_TRUE(InsertRow(&cp, key).IsOk());
+  }
+  std::string out;
+  ASSERT_EQ(ReadRow(cp, 0, &out).get_code(), StatusCode::kFileNotExist);
+  // The client recomputes the dropped row and caches it again.
+  ASSERT_TRUE(InsertRow(&cp, 0).IsOk());
+  ASSERT_TRUE(ReadRow(cp, 0, &out).IsOk());
+  EXPECT_EQ(out, Row(0));
+  // A row still in memory is not replaced.
+  EXPECT_EQ(InsertRow(&cp, num_rows - 1).get_code(), StatusCode::kDuplicateKey);
+}
+
+TEST_F(MindDataTestCachePool, TestNoEvictionWithBuildPhase) {
+  // With a build phase rows can't be dropped, so nothing is evicted and the memory simply runs out.
+  CachePool cp(SmallPool(), "", CacheEvictPolicy::kEvictLru, kDefaultPinEpochs, false, false);
+  ASSERT_TRUE(cp.ServiceStart().IsOk());
+  Status rc;
+  int64_t key = 0;
+  for (; key < 32 && rc.IsOk(); ++key) {
+    rc = InsertRow(&cp, key);
+  }
+  EXPECT_TRUE(rc.IsOutofMemory());
+  EXPECT_EQ(cp.GetStat().num_evicted, 0);
+  std::string out;
+  ASSERT_TRUE(ReadRow(cp, 0, &out).IsOk());
+  EXPECT_EQ(out, Row(0));
+}
+
+TEST_F(MindDataTestCachePool, TestFetchEvictedRowIsMiss) {
+  CachePool cp(SmallPool(), "", CacheEvictPolicy::kEvictLru, kDefaultPinEpochs, false, true);
+  ASSERT_TRUE(cp.ServiceStart().IsOk());
+  ASSERT_TRUE(InsertRow(&cp, 0).IsOk());
+  // The lookup finds the row in memory ...
+  LookUp(cp, 0);
+  auto stat = cp.GetStat();
+  EXPECT_EQ(stat.num_hit, 1);
+  EXPECT_EQ(stat.hit_bytes, kRowSz);
+  // ... but it is evicted before the fetch copies it.
+  for (int64_t key = 1; key < 32; ++key) {
+    ASSERT_TRUE(InsertRow(&cp, key).IsOk());
+  }
+  std::string out;
+  EXPECT_EQ(ReadRow(cp, 0, &out).get_code(), StatusCode::kFileNotExist);
+  stat = cp.GetStat();
+  EXPECT_EQ(stat.num_hit, 0);
+  EXPECT_EQ(stat.hit_bytes, 0);
+  EXPECT_EQ(stat.num_miss, 1);
+}
+
+TEST_F(MindDataTestCachePool, TestPinHotSet) {
+  constexpr int32_t pin_epochs = 2;
+  CachePool cp(SmallPool(), "", CacheEvictPolicy::kEvictPinHotSet, pin_epochs, false, true);
+  ASSERT_TRUE(cp.ServiceStart().IsOk());
+  constexpr int64_t num_rows = 8;
+  for (int64_t key = 0; key < num_rows; ++key) {
+    ASSERT_TRUE(InsertRow(&cp, key).IsOk());
+  }
+  // Until the hot set is pinned it is evicted like lru.
+  for (int64_t key = 0; key < num_rows; ++key) {
+    LookUp(cp, key);
+  }
+  ASSERT_TRUE(InsertRow(&cp, 100).IsOk());
+  for (int64_t key = 101; key < 132 && cp.GetStat().num_evicted == 0; ++key) {
+    ASSERT_TRUE(InsertRow(&cp, key).IsOk());
+  }
+  auto evicted = cp.GetStat().num_evicted;
+  ASSERT_GT(evicted, 0);
+  // Finish the second epoch over the largest key looked up so far.
+  int64_t lookups = num_rows;
+  for (int64_t key = 0; lookups < pin_epochs * num_rows; ++key, ++lookups) {
+    LookUp(cp, key % num_rows);
+  }
+  // Nothing in memory can go now. The new rows don't fit.
+  Status rc;
+  for (int64_t key = 200; key < 232 && rc.IsOk(); ++key) {
+    rc = InsertRow(&cp, key);
+  }
+  EXPECT_TRUE(rc.IsOutofMemory());
+  auto stat = cp.GetStat();
+  EXPECT_EQ(stat.num_evicted, evicted);
+  std::string out;
+  ASSERT_TRUE(ReadRow(cp, 100, &out).IsOk());
+  EXPECT_EQ(out, Row(100));
+}
+
+TEST_F(MindDataTestCachePool, TestCheckpointRoundTrip) {
+  const std::string root = "/tmp";
+  const std::string name = "ut_cache_pool_checkpoint";
+  Path folder = Path(root) / name;
+  RemoveFolder(folder);
+  constexpr int64_t num_rows = 8;
+  SaveRows(root, name, num_rows);
+  ASSERT_TRUE(folder.Exists());
+  {
+    CachePool cp(SmallPool(), root, CacheEvictPolicy::kEvictNone, kDefaultPinEpochs, false, false, name);
+    ASSERT_TRUE(cp.ServiceStart().IsOk());
+    auto stat = cp.GetStat();
+    EXPECT_EQ(stat.num_disk_cached, num_rows);
+    EXPECT_EQ(stat.num_mem_cached, 0);
+    EXPECT_EQ(stat.min_key, 0);
+    EXPECT_EQ(stat.max_key, num_rows - 1);
+    for (int64_t key = 0; key < num_rows; ++key) {
+      std::string out;
+      ASSERT_TRUE(ReadRow(cp, key, &out).IsOk());
+      EXPECT_EQ(out, Row(key));
+    }
+  }
+  // Without Persist the spill folder goes with the pool, e.g. when the cache is dropped.
+  EXPECT_FALSE(folder.Exists());
+}
+
+TEST_F(MindDataTestCachePool, TestCheckpointValidation) {
+  const std::string root = "/tmp";
+  const std::string name = "ut_cache_pool_bad_checkpoint";
+  Path folder = Path(root) / name;
+  std::string index = (folder / "INDEX.ckpt").toString();
+  constexpr int64_t num_rows = 4;
+  // A checkpoint written by another version of the index.
+  RemoveFolder(folder);
+  SaveRows(root, name, num_rows);
+  {
+    std::fstream f(index, std::ios::binary | std::ios::in | std::ios::out);
+    uint32_t version = 1;
+    f.seekp(sizeof(uint32_t));
+    f.write(reinterpret_cast<const char *>(&version), sizeof(version));
+  }
+  {
+    CachePool cp(SmallPool(), root, CacheEvictPolicy::kEvictNone, kDefaultPinEpochs, false, false, name);
+    EXPECT_TRUE(cp.ServiceStart().IsError());
+  }
+  // A checkpoint which lost its last record.
+  RemoveFolder(folder);
+  SaveRows(root, name, num_rows);
+  {
+    std::ifstream in(index, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream out(index, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), content.size() - 1);
+  }
+  {
+    CachePool cp(SmallPool(), root, CacheEvictPolicy::kEvictNone, kDefaultPinEpochs, false, false, name);
+    EXPECT_TRUE(cp.ServiceStart().IsError());
+  }
+  RemoveFolder(folder);
+}
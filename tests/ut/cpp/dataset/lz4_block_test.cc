@@ -0,0 +1,91 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <random>
+#include <string>
+#include <vector>
+#include "minddata/dataset/util/lz4_block.h"
+#include "common/common.h"
+#include "utils/log_adapter.h"
+
+using namespace mindspore::dataset;
+
+class MindDataTestLz4Block : public UT::Common {
+ public:
+  MindDataTestLz4Block() = default;
+
+  // Compresses src and checks that it decompresses back. Returns the compressed size.
+  size_t RoundTrip(const std::string &src) {
+    std::string compressed(Lz4CompressBound(src.size()), '\0');
+    WritableSlice dest(&compressed[0], compressed.size());
+    size_t sz = Lz4Compress(ReadableSlice(src.data(), src.size()), &dest);
+    EXPECT_GT(sz, 0);
+    std::string out(src.size(), '\0');
+    WritableSlice restored(&out[0], out.size());
+    Status rc = Lz4Decompress(ReadableSlice(compressed.data(), sz), &restored);
+    EXPECT_TRUE(rc.IsOk());
+    EXPECT_EQ(out, src);
+    return sz;
+  }
+};
+
+TEST_F(MindDataTestLz4Block, TestRoundTrip) {
+  EXPECT_EQ(RoundTrip(""), 1);
+  RoundTrip("short");
+  // Long runs and repeated phrases shrink a lot.
+  size_t sz = RoundTrip(std::string(100000, 'a'));
+  EXPECT_LT(sz, 1000);
+  std::string text;
+  for (int i = 0; i < 2000; i++) {
+    text += "row " + std::to_string(i % 37) + " of the cached dataset; ";
+  }
+  sz = RoundTrip(text);
+  EXPECT_LT(sz, text.size() / 4);
+  // Random bytes do not compress but still round trip.
+  std::mt19937 gen(1);
+  std::string noise(70000, '\0');
+  for (auto &c : noise) {
+    c = static_cast<char>(gen());
+  }
+  sz = RoundTrip(noise);
+  EXPECT_LE(sz, Lz4CompressBound(noise.size()));
+}
+
+TEST_F(MindDataTestLz4Block, TestSmallBuffer) {
+  std::mt19937 gen(2);
+  std::string noise(4096, '\0');
+  for (auto &c : noise) {
+    c = static_cast<char>(gen());
+  }
+  // Incompressible data does not fit into a buffer smaller than the input.
+  std::string compressed(noise.size(), '\0');
+  WritableSlice dest(&compressed[0], compressed.size());
+  EXPECT_EQ(Lz4Compress(ReadableSlice(noise.data(), noise.size()), &dest), 0);
+}
+
+TEST_F(MindDataTestLz4Block, TestCorruptedBlock) {
+  std::string src(1000, 'x');
+  std::string compressed(Lz4CompressBound(src.size()), '\0');
+  WritableSlice dest(&compressed[0], compressed.size());
+  size_t sz = Lz4Compress(ReadableSlice(src.data(), src.size()), &dest);
+  ASSERT_GT(sz, 0);
+  std::string out(src.size(), '\0');
+  WritableSlice restored(&out[0], out.size());
+  // Truncated block
+  EXPECT_TRUE(Lz4Decompress(ReadableSlice(compressed.data(), sz - 1), &restored).IsError());
+  // Wrong original size
+  WritableSlice too_small(&out[0], out.size() - 1);
+  EXPECT_TRUE(Lz4Decompress(ReadableSlice(compressed.data(), sz), &too_small).IsError());
+}
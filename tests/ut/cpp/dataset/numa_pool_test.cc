@@ -0,0 +1,87 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "minddata/dataset/core/global_context.h"
+#include "minddata/dataset/util/allocator.h"
+#include "minddata/dataset/util/numa_pool.h"
+#include "common/common.h"
+#include "utils/log_adapter.h"
+
+using namespace mindspore::dataset;
+
+class MindDataTestNumaPool : public UT::Common {
+ public:
+  MindDataTestNumaPool() {}
+};
+
+TEST_F(MindDataTestNumaPool, TestAllocate) {
+  // A small arena so that we also go through the fallback to malloc.
+  auto mp = std::make_shared<NumaPool>(0, 1);
+  std::vector<void *> v;
+  for (int i = 0; i < 100; i++) {
+    void *ptr = nullptr;
+    ASSERT_TRUE(mp->Allocate(64 * 1024, &ptr).IsOk());
+    ASSERT_NE(ptr, nullptr);
+    memset(ptr, i, 64 * 1024);
+    v.push_back(ptr);
+  }
+  ASSERT_TRUE(mp->Reallocate(&v[0], 64 * 1024, 128 * 1024).IsOk());
+  EXPECT_EQ(static_cast<unsigned char *>(v[0])[100], 0);
+  // Blocks can be freed by another thread.
+  std::thread t([&v, &mp]() {
+    for (auto p : v) {
+      mp->Deallocate(p);
+    }
+  });
+  t.join();
+  EXPECT_EQ(mp->PercentFree(), 100);
+}
+
+TEST_F(MindDataTestNumaPool, TestThreadPool) {
+  const auto &nodes = GetNumaNodes();
+  ASSERT_EQ(static_cast<int32_t>(nodes.size()), GetNumaNodeCount());
+  ASSERT_FALSE(nodes.empty());
+  EXPECT_TRUE(std::is_sorted(nodes.begin(), nodes.end()));
+  EXPECT_TRUE(std::adjacent_find(nodes.begin(), nodes.end()) == nodes.end());
+  auto global_pool = GlobalContext::Instance()->mem_pool();
+  EXPECT_EQ(GetThreadNumaNode(), -1);
+  // The last node is the one most likely to have an id different from its index.
+  int32_t numa_node = nodes.back();
+  std::thread t([global_pool, numa_node]() {
+    ASSERT_TRUE(BindThreadToNumaNode(numa_node).IsOk());
+    EXPECT_EQ(GetThreadNumaNode(), numa_node);
+    auto pool = GlobalContext::Instance()->mem_pool();
+    // We only get a node pool if there is more than one node.
+    if (GetNumaNodeCount() > 1) {
+      EXPECT_NE(pool, global_pool);
+    } else {
+      EXPECT_EQ(pool, global_pool);
+    }
+    auto alloc = Allocator<int>(pool);
+    std::vector<int, Allocator<int>> v(alloc);
+    for (int i = 0; i < 1000; ++i) {
+      v.push_back(i);
+    }
+    EXPECT_EQ(v[999], 999);
+  });
+  t.join();
+  EXPECT_TRUE(BindThreadToNumaNode(-1).IsError());
+  EXPECT_TRUE(BindThreadToNumaNode(nodes.back() + 1).IsError());
+}
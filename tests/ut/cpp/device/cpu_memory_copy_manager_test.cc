@@ -0,0 +1,181 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "runtime/device/cpu/cpu_device_address.h"
+#include "runtime/device/cpu/cpu_memory_copy_manager.h"
+
+namespace mindspore {
+namespace device {
+namespace cpu {
+class CPUMemCopyManagerTest : public UT::Common {
+ public:
+  CPUMemCopyManagerTest() {}
+
+  void SetUp() override {
+    char swap_dir[] = "/tmp/cpu_mem_copy_manager_test_XXXXXX";
+    ASSERT_NE(mkdtemp(swap_dir), nullptr);
+    swap_dir_ = swap_dir;
+    mem_copy_manager_ = std::make_shared<CPUMemCopyManager>(swap_dir_);
+    mem_copy_manager_->Init();
+  }
+
+  void TearDown() override {
+    mem_copy_manager_ = nullptr;
+    (void)rmdir(swap_dir_.c_str());
+  }
+
+  DeviceAddressPtr CreateDeviceAddress(std::vector<float> *data) {
+    return std::make_shared<CPUDeviceAddress>(data->data(), data->size() * sizeof(float));
+  }
+
+  HostAddress AllocHostAddress(size_t size) {
+    void *addr = nullptr;
+    EXPECT_TRUE(mem_copy_manager_->AllocHostPinnedMem(size, &addr));
+    return HostAddress(addr, size);
+  }
+
+  std::string swap_dir_;
+  CPUMemCopyManagerPtr mem_copy_manager_;
+};
+
+TEST_F(CPUMemCopyManagerTest, test_swap_file_regions) {
+  auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto first = AllocHostAddress(10);
+  auto second = AllocHostAddress(page_size + 1);
+  auto third = AllocHostAddress(page_size);
+  std::vector<void *> regions = {first.addr, second.addr, third.addr};
+  for (auto region : regions) {
+    ASSERT_NE(region, nullptr);
+    EXPECT_TRUE(reinterpret_cast<uintptr_t>(region) % page_size == 0);
+  }
+  EXPECT_NE(first.addr, second.addr);
+  EXPECT_NE(second.addr, third.addr);
+
+  // the regions do not overlap in the swap file
+  memset(first.addr, 1, first.size);
+  memset(second.addr, 2, second.size);
+  memset(third.addr, 3, third.size);
+  EXPECT_EQ(static_cast<uint8_t *>(first.addr)[first.size - 1], 1);
+  EXPECT_EQ(static_cast<uint8_t *>(second.addr)[second.size - 1], 2);
+  EXPECT_EQ(static_cast<uint8_t *>(third.addr)[0], 3);
+  for (auto region : regions) {
+    mem_copy_manager_->FreeHostPinnedMem(region);
+  }
+  // freeing an address that is not a region of the swap file is ignored
+  int value = 0;
+  mem_copy_manager_->FreeHostPinnedMem(&value);
+}
+
+TEST_F(CPUMemCopyManagerTest, test_swap_out_and_in) {
+  const size_t num = 3;
+  const size_t elem_num = 1024;
+  std::vector<std::vector<float>> data(num, std::vector<float>(elem_num));
+  std::vector<DeviceAddressPtr> device_addresses;
+  std::vector<HostAddress> host_addresses;
+  for (size_t i = 0; i < num; ++i) {
+    for (size_t j = 0; j < elem_num; ++j) {
+      data[i][j] = static_cast<float>(i * elem_num + j);
+    }
+    device_addresses.push_back(CreateDeviceAddress(&data[i]));
+    host_addresses.push_back(AllocHostAddress(elem_num * sizeof(float)));
+    mem_copy_manager_->AddMemSwapOutTask(device_addresses[i], host_addresses[i]);
+    EXPECT_EQ(device_addresses[i]->status(), DeviceAddressStatus::kInDeviceToHost);
+  }
+  EXPECT_TRUE(mem_copy_manager_->SyncMemCopyStream(SwapKind::kDeviceToHost));
+  // finished swap outs are popped in the order they were added
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_EQ(mem_copy_manager_->UpdateSwapOutQueue(), device_addresses[i]);
+  }
+  EXPECT_EQ(mem_copy_manager_->UpdateSwapOutQueue(), nullptr);
+
+  for (size_t i = 0; i < num; ++i) {
+    std::fill(data[i].begin(), data[i].end(), 0);
+    mem_copy_manager_->AddMemSwapInTask(device_addresses[i], host_addresses[i], false, nullptr);
+    EXPECT_EQ(device_addresses[i]->status(), DeviceAddressStatus::kInHostToDevice);
+  }
+  EXPECT_TRUE(mem_copy_manager_->SyncMemCopyStream(SwapKind::kHostToDevice));
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_EQ(mem_copy_manager_->UpdateSwapInQueue(), device_addresses[i]);
+    for (size_t j = 0; j < elem_num; ++j) {
+      EXPECT_EQ(data[i][j], static_cast<float>(i * elem_num + j));
+    }
+  }
+  EXPECT_EQ(mem_copy_manager_->UpdateSwapInQueue(), nullptr);
+}
+
+TEST_F(CPUMemCopyManagerTest, test_swap_in_after_swap_out) {
+  // a swap in queued right after the swap out of the same data reads what the swap out wrote
+  std::vector<float> data = {1, 2, 3, 4};
+  std::vector<float> other(data.size(), 0);
+  auto host_address = AllocHostAddress(data.size() * sizeof(float));
+  mem_copy_manager_->AddMemSwapOutTask(CreateDeviceAddress(&data), host_address);
+  auto other_address = CreateDeviceAddress(&other);
+  mem_copy_manager_->AddMemSwapInTask(other_address, host_address, false, nullptr);
+  mem_copy_manager_->ClearSwapQueue();
+  EXPECT_EQ(other, data);
+  EXPECT_EQ(mem_copy_manager_->UpdateSwapOutQueue(), nullptr);
+  EXPECT_EQ(mem_copy_manager_->UpdateSwapInQueue(), nullptr);
+}
+
+TEST_F(CPUMemCopyManagerTest, test_profiling_swap_in) {
+  std::vector<float> data = {1, 2, 3, 4};
+  std::vector<float> other(data.size(), 0);
+  auto host_address = AllocHostAddress(data.size() * sizeof(float));
+  mem_copy_manager_->AddMemSwapOutTask(CreateDeviceAddress(&data), host_address);
+  EXPECT_TRUE(mem_copy_manager_->SyncMemCopyStream(SwapKind::kDeviceToHost));
+  float cost_time = -1;
+  auto other_address = CreateDeviceAddress(&other);
+  mem_copy_manager_->AddMemSwapInTask(other_address, host_address, true, &cost_time);
+  // a profiled swap in is done synchronously
+  EXPECT_GE(cost_time, 0);
+  EXPECT_EQ(other, data);
+  EXPECT_EQ(mem_copy_manager_->UpdateSwapInQueue(), other_address);
+}
+
+TEST_F(CPUMemCopyManagerTest, test_move_tensor_to_swap_file) {
+  std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  auto tensor = std::make_shared<tensor::Tensor>(kNumberTypeFloat32, ShapeVector({2, 3}), data.data(),
+                                                 data.size() * sizeof(float));
+  auto text = tensor->ToString();
+  auto origin_data = tensor->data_c();
+  ASSERT_TRUE(mem_copy_manager_->MoveTensorToSwapFile(tensor));
+  EXPECT_NE(tensor->data_c(), origin_data);
+  EXPECT_EQ(tensor->Size(), data.size() * sizeof(float));
+  EXPECT_EQ(tensor->ToString(), text);
+  // moving again keeps the storage
+  auto swap_data = tensor->data_c();
+  ASSERT_TRUE(mem_copy_manager_->MoveTensorToSwapFile(tensor));
+  EXPECT_EQ(tensor->data_c(), swap_data);
+
+  // the pages stay valid after they are released and prefetched
+  mem_copy_manager_->AddRegionReleaseTask(swap_data, tensor->Size());
+  mem_copy_manager_->SyncRegionReleaseTasks();
+  mem_copy_manager_->PrefetchRegion(swap_data, tensor->Size());
+  auto values = static_cast<float *>(swap_data);
+  EXPECT_EQ(std::vector<float>(values, values + data.size()), data);
+  values[0] = 10;
+  mem_copy_manager_->AddRegionReleaseTask(swap_data, tensor->Size());
+  mem_copy_manager_->SyncRegionReleaseTasks();
+  EXPECT_EQ(values[0], 10);
+}
+}  // namespace cpu
+}  // namespace device
+}  // namespace mindspore
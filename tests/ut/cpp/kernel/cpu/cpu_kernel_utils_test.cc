@@ -0,0 +1,162 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "backend/kernel_compiler/cpu/cpu_kernel.h"
+
+namespace mindspore {
+namespace kernel {
+namespace {
+constexpr auto kTimeout = std::chrono::seconds(60);
+
+// Runs func on a thread of its own, so that a deadlock of the pool aborts the test instead of hanging it.
+void RunWithTimeout(const std::function<void()> &func) {
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> future = done->get_future();
+  std::thread([func, done]() {
+    func();
+    done->set_value();
+  }).detach();
+  if (future.wait_for(kTimeout) != std::future_status::ready) {
+    // the tasks still reference the test, it can't go on
+    MS_LOG(ERROR) << "ParallelFor didn't return in " << kTimeout.count() << "s, the pool deadlocks.";
+    std::abort();
+  }
+}
+}  // namespace
+
+class CPUKernelUtilsTest : public UT::Common {
+ public:
+  CPUKernelUtilsTest() = default;
+};
+
+TEST_F(CPUKernelUtilsTest, test_nested_parallel_for) {
+  constexpr size_t kOuterNum = 64;
+  constexpr size_t kInnerNum = 100;
+  constexpr int kRepeat = 20;
+  std::vector<std::atomic<int>> runs(kOuterNum * kInnerNum);
+  std::atomic<bool> nested_on_worker(false);
+  RunWithTimeout([&]() {
+    std::thread::id caller = std::this_thread::get_id();
+    for (int repeat = 0; repeat < kRepeat; ++repeat) {
+      CPUKernelUtils::ParallelFor(
+        [&](size_t start, size_t end) {
+          // the caller holds its task until a worker has taken another one, so that the nested calls also start on
+          // a worker of the pool
+          if (std::this_thread::get_id() != caller) {
+            nested_on_worker = true;
+          }
+          while (!nested_on_worker.load()) {
+            std::this_thread::yield();
+          }
+          for (size_t i = start; i < end; ++i) {
+            // the outer task waits for the inner batch while other outer tasks hold the rest of the pool
+            CPUKernelUtils::ParallelFor(
+              [&runs, i](size_t inner_start, size_t inner_end) {
+                for (size_t j = inner_start; j < inner_end; ++j) {
+                  runs[i * kInnerNum + j]++;
+                }
+              },
+              kInnerNum);
+          }
+        },
+        kOuterNum);
+    }
+  });
+  for (size_t i = 0; i < runs.size(); ++i) {
+    EXPECT_EQ(runs[i].load(), kRepeat) << "task " << i;
+  }
+}
+
+TEST_F(CPUKernelUtilsTest, test_interleaved_parallel_for) {
+  // every task of both batches waits until both batches have started, so neither can finish before the other begins
+  constexpr size_t kCallerNum = 2;
+  constexpr size_t kCount = 32;
+  std::vector<std::atomic<int>> started(kCallerNum);
+  std::vector<std::vector<std::atomic<int>>> runs;
+  for (size_t caller = 0; caller < kCallerNum; ++caller) {
+    runs.emplace_back(kCount);
+  }
+  RunWithTimeout([&]() {
+    std::vector<std::thread> callers;
+    for (size_t caller = 0; caller < kCallerNum; ++caller) {
+      callers.emplace_back([&, caller]() {
+        CPUKernelUtils::ParallelFor(
+          [&, caller](size_t start, size_t end) {
+            started[caller]++;
+            while (started[0].load() == 0 || started[1].load() == 0) {
+              std::this_thread::yield();
+            }
+            for (size_t i = start; i < end; ++i) {
+              runs[caller][i]++;
+            }
+          },
+          kCount);
+      });
+    }
+    for (auto &caller : callers) {
+      caller.join();
+    }
+  });
+  for (size_t caller = 0; caller < kCallerNum; ++caller) {
+    for (size_t i = 0; i < kCount; ++i) {
+      EXPECT_EQ(runs[caller][i].load(), 1) << "caller " << caller << ", task " << i;
+    }
+  }
+}
+
+TEST_F(CPUKernelUtilsTest, test_concurrent_parallel_for) {
+  constexpr size_t kCallerNum = 8;
+  constexpr size_t kCount = 1000;
+  constexpr int kRepeat = 50;
+  std::vector<std::vector<std::atomic<int>>> runs;
+  for (size_t caller = 0; caller < kCallerNum; ++caller) {
+    runs.emplace_back(kCount);
+  }
+  RunWithTimeout([&]() {
+    std::vector<std::thread> callers;
+    for (size_t caller = 0; caller < kCallerNum; ++caller) {
+      callers.emplace_back([&, caller]() {
+        for (int repeat = 0; repeat < kRepeat; ++repeat) {
+          CPUKernelUtils::ParallelFor(
+            [&, caller](size_t start, size_t end) {
+              for (size_t i = start; i < end; ++i) {
+                runs[caller][i]++;
+              }
+            },
+            kCount);
+        }
+      });
+    }
+    for (auto &caller : callers) {
+      caller.join();
+    }
+  });
+  for (size_t caller = 0; caller < kCallerNum; ++caller) {
+    for (size_t i = 0; i < kCount; ++i) {
+      EXPECT_EQ(runs[caller][i].load(), kRepeat) << "caller " << caller << ", task " << i;
+    }
+  }
+}
+}  // namespace kernel
+}  // namespace mindspore
@@ -0,0 +1,154 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cmath>
+#include <vector>
+#include "common/common_test.h"
+#define private public
+#define protected public
+#include "backend/kernel_compiler/cpu/multi_tensor_optimizer_cpu_kernel.h"
+#undef private
+#undef protected
+
+namespace mindspore {
+namespace kernel {
+class MultiTensorOptimizerCpuKernelTest : public UT::Common {
+ public:
+  MultiTensorOptimizerCpuKernelTest() = default;
+
+  void SetUp() override {
+    inputs_.clear();
+    workspace_.clear();
+    outputs_.clear();
+  }
+
+  AddressPtr CreateKernelAddress(void *addr, size_t size) {
+    auto kernel_addr = std::make_shared<Address>();
+    kernel_addr->addr = addr;
+    kernel_addr->size = size;
+    return kernel_addr;
+  }
+
+  AddressPtr CreateTensorAddress(std::vector<float> *tensor) {
+    return CreateKernelAddress(tensor->data(), tensor->size() * sizeof(float));
+  }
+
+  AddressPtr CreateScalarAddress(float *scalar) { return CreateKernelAddress(scalar, sizeof(float)); }
+
+  std::vector<AddressPtr> inputs_;
+  std::vector<AddressPtr> workspace_;
+  std::vector<AddressPtr> outputs_;
+};
+
+TEST_F(MultiTensorOptimizerCpuKernelTest, test_apply_momentum) {
+  // one tiny parameter and one large enough to be split across tasks, the split crosses the parameter boundary
+  std::vector<size_t> elem_nums = {3, 20000};
+  std::vector<std::vector<float>> vars;
+  std::vector<std::vector<float>> accums;
+  std::vector<std::vector<float>> grads;
+  for (auto elem_num : elem_nums) {
+    vars.emplace_back(elem_num, 1.0);
+    accums.emplace_back(elem_num, 0.5);
+    grads.emplace_back(elem_num, 0.1);
+  }
+  float lr = 0.01;
+  float momentum = 0.9;
+  for (size_t i = 0; i < elem_nums.size(); ++i) {
+    inputs_.push_back(CreateTensorAddress(&vars[i]));
+    inputs_.push_back(CreateTensorAddress(&accums[i]));
+    inputs_.push_back(CreateScalarAddress(&lr));
+    inputs_.push_back(CreateTensorAddress(&grads[i]));
+    inputs_.push_back(CreateScalarAddress(&momentum));
+  }
+  auto kernel = std::make_shared<MultiTensorApplyMomentumCPUKernel>();
+  kernel->group_num_ = elem_nums.size();
+  EXPECT_TRUE(kernel->Launch(inputs_, workspace_, outputs_));
+  float accum = 0.5 * 0.9 + 0.1;
+  float var = 1.0 - accum * 0.01;
+  for (size_t i = 0; i < elem_nums.size(); ++i) {
+    for (size_t j = 0; j < elem_nums[i]; ++j) {
+      EXPECT_TRUE(std::fabs(accums[i][j] - accum) < 1e-6);
+      EXPECT_TRUE(std::fabs(vars[i][j] - var) < 1e-6);
+    }
+  }
+}
+
+TEST_F(MultiTensorOptimizerCpuKernelTest, test_adam) {
+  std::vector<size_t> elem_nums = {5000, 7, 9000};
+  std::vector<std::vector<float>> vars;
+  std::vector<std::vector<float>> ms;
+  std::vector<std::vector<float>> vs;
+  std::vector<std::vector<float>> grads;
+  for (auto elem_num : elem_nums) {
+    vars.emplace_back(elem_num, 1.0);
+    ms.emplace_back(elem_num, 1.0);
+    vs.emplace_back(elem_num, 1.0);
+    grads.emplace_back(elem_num, 1.0);
+  }
+  float beta1_power = 0.9;
+  float beta2_power = 0.999;
+  float lr = 0.001;
+  float beta1 = 0.9;
+  float beta2 = 0.999;
+  float epsilon = 1e-8;
+  for (size_t i = 0; i < elem_nums.size(); ++i) {
+    inputs_.push_back(CreateTensorAddress(&vars[i]));
+    inputs_.push_back(CreateTensorAddress(&ms[i]));
+    inputs_.push_back(CreateTensorAddress(&vs[i]));
+    inputs_.push_back(CreateScalarAddress(&beta1_power));
+    inputs_.push_back(CreateScalarAddress(&beta2_power));
+    inputs_.push_back(CreateScalarAddress(&lr));
+    inputs_.push_back(CreateScalarAddress(&beta1));
+    inputs_.push_back(CreateScalarAddress(&beta2));
+    inputs_.push_back(CreateScalarAddress(&epsilon));
+    inputs_.push_back(CreateTensorAddress(&grads[i]));
+  }
+  auto kernel = std::make_shared<MultiTensorAdamCPUKernel>();
+  kernel->group_num_ = elem_nums.size();
+  EXPECT_TRUE(kernel->Launch(inputs_, workspace_, outputs_));
+  float new_lr = lr * std::sqrt(1.0 - beta2_power) / (1 - beta1_power);
+  float var = 1.0 - new_lr * 1.0 / (1.0 + epsilon);
+  for (size_t i = 0; i < elem_nums.size(); ++i) {
+    for (size_t j = 0; j < elem_nums[i]; ++j) {
+      EXPECT_TRUE(std::fabs(vars[i][j] - var) < 1e-6);
+    }
+  }
+}
+
+TEST_F(MultiTensorOptimizerCpuKernelTest, test_apply_rms_prop) {
+  std::vector<float> var(10, 1.0);
+  std::vector<float> mean_square(10, 0.0);
+  std::vector<float> moment(10, 0.0);
+  std::vector<float> grad(10, 1.0);
+  float lr = 0.1;
+  inputs_.push_back(CreateTensorAddress(&var));
+  inputs_.push_back(CreateTensorAddress(&mean_square));
+  inputs_.push_back(CreateTensorAddress(&moment));
+  inputs_.push_back(CreateScalarAddress(&lr));
+  inputs_.push_back(CreateTensorAddress(&grad));
+  auto kernel = std::make_shared<MultiTensorApplyRMSPropCPUKernel>();
+  kernel->group_num_ = 1;
+  kernel->decay_ = 0.75;
+  kernel->momentum_ = 0;
+  kernel->epsilon_ = 0;
+  EXPECT_TRUE(kernel->Launch(inputs_, workspace_, outputs_));
+  // mean_square = 0.25, moment = 0.1 / sqrt(0.25) = 0.2
+  for (size_t i = 0; i < var.size(); ++i) {
+    EXPECT_TRUE(std::fabs(mean_square[i] - 0.25) < 1e-6);
+    EXPECT_TRUE(std::fabs(var[i] - 0.8) < 1e-6);
+  }
+}
+}  // namespace kernel
+}  // namespace mindspore
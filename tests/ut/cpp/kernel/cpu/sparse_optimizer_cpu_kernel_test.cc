@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <map>
+#include <utility>
 #include <vector>
 #include "common/common_test.h"
 #include "backend/kernel_compiler/cpu/sparse_optimizer_cpu_kernel.h"
@@ -130,5 +132,99 @@ TEST_F(CommonUtilTest, BucketReduceSparseGradient2) {
     EXPECT_EQ(unique_grad.value_[i], expect_value[i]);
   }
 }
+
+TEST_F(CommonUtilTest, BucketReduceSparseGradientWithHashSlotMap) {
+  // every bucket covers more than kDenseReduceMaxRange indices, so the hash table reduces the gradient
+  const size_t max_index = size_t(1) << 30;
+  ASSERT_GT(max_index / CPUKernelUtils::GetParallelThreadNum(), kDenseReduceMaxRange);
+  const size_t indices_num = 3000;
+  const size_t unique_num = 100;
+  const size_t index_step = 10000019;
+  std::vector<int> indices;
+  std::vector<float> grad;
+  for (size_t i = 0; i < indices_num; ++i) {
+    indices.push_back(static_cast<int>((unique_num - 1 - i % unique_num) * index_step));
+    grad.push_back(i % unique_num);
+    grad.push_back(1);
+  }
+  // out of range indices are skipped
+  indices[0] = -1;
+  indices[1] = static_cast<int>(max_index);
+  std::vector<int> unique_indices(indices_num);
+  std::vector<float> summed_grad(indices_num * 2);
+  std::vector<int> tmp_indices(indices_num);
+  std::vector<float> tmp_grad(indices_num * 2);
+  SparseGradient<int> unique_grad({summed_grad.data(), unique_indices.data(), indices_num});
+  SparseGradient<int> workspace_grad({tmp_grad.data(), tmp_indices.data(), indices_num});
+  SparseGradient<int> input_grad({grad.data(), indices.data(), indices_num});
+
+  ReduceSparseGradientParam<int> param;
+  param.input_grad_ = &input_grad;
+  param.workspace_grad_ = &workspace_grad;
+  param.output_grad_ = &unique_grad;
+  param.max_index_ = max_index;
+  param.value_stride_ = 2;
+  SparseOptimizerCPUKernel::BucketReduceSparseGradient(param);
+
+  // the reduced indices are sorted by bucket and keep the first appearance order inside a bucket, so compare them
+  // through a map
+  EXPECT_EQ(unique_grad.indices_size_, unique_num);
+  std::map<int, std::pair<float, float>> reduced;
+  for (size_t i = 0; i < unique_grad.indices_size_; ++i) {
+    reduced[unique_grad.indices_[i]] = {unique_grad.value_[2 * i], unique_grad.value_[2 * i + 1]};
+  }
+  ASSERT_EQ(reduced.size(), unique_num);
+  for (size_t i = 0; i < unique_num; ++i) {
+    int index = static_cast<int>((unique_num - 1 - i) * index_step);
+    ASSERT_EQ(reduced.count(index), 1);
+    float rows = indices_num / unique_num - (i < 2 ? 1 : 0);
+    EXPECT_EQ(reduced[index].first, i * rows);
+    EXPECT_EQ(reduced[index].second, rows);
+  }
+}
+
+TEST_F(CommonUtilTest, BucketReduceAndApplySparseGradient) {
+  // the reduced rows of every bucket are applied to var right after the bucket is reduced
+  const size_t max_index = 1 << 20;
+  const size_t indices_num = 2000;
+  std::vector<int> indices;
+  std::vector<float> grad;
+  for (size_t i = 0; i < indices_num; ++i) {
+    indices.push_back(static_cast<int>((i % 100) * 10000));
+    grad.push_back(1);
+  }
+  // an out of range index is skipped
+  indices[0] = -1;
+  std::vector<int> unique_indices(indices_num);
+  std::vector<float> summed_grad(indices_num);
+  std::vector<int> tmp_indices(indices_num);
+  std::vector<float> tmp_grad(indices_num);
+  SparseGradient<int> unique_grad({summed_grad.data(), unique_indices.data(), indices_num});
+  SparseGradient<int> workspace_grad({tmp_grad.data(), tmp_indices.data(), indices_num});
+  SparseGradient<int> input_grad({grad.data(), indices.data(), indices_num});
+
+  ReduceSparseGradientParam<int> param;
+  param.input_grad_ = &input_grad;
+  param.workspace_grad_ = &workspace_grad;
+  param.output_grad_ = &unique_grad;
+  param.max_index_ = max_index;
+  param.value_stride_ = 1;
+
+  std::vector<float> var(max_index, 0);
+  MultiThreadComputeParams<int> compute_params;
+  compute_params.var_ = var.data();
+  compute_params.var_outer_dim_size_ = 1;
+  MultiThreadComputeFunc<int> func = [](MultiThreadComputeParams<int> *input_params, size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      input_params->var_[input_params->sparse_grad_.indices_[i]] += input_params->sparse_grad_.value_[i];
+    }
+  };
+  SparseOptimizerCPUKernel::BucketReduceAndApplySparseGradient<int>(param, func, compute_params);
+
+  for (size_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(var[i * 10000], i == 0 ? 19 : 20);
+  }
+  EXPECT_EQ(var[1], 0);
+}
 }  // namespace kernel
 }  // namespace mindspore
@@ -0,0 +1,211 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "backend/optimizer/pass/memory_budget_recompute.h"
+#include "backend/session/anf_runtime_algorithm.h"
+#include "backend/session/kernel_graph.h"
+#include "runtime/device/kernel_info.h"
+#include "utils/utils.h"
+
+namespace mindspore {
+namespace opt {
+using KernelBuildInfoBuilder = kernel::KernelBuildInfo::KernelBuildInfoBuilder;
+
+class TestMemoryBudgetRecompute : public UT::Common {
+ public:
+  TestMemoryBudgetRecompute() = default;
+  ~TestMemoryBudgetRecompute() override = default;
+
+  void SetUp() override {
+    /*
+     * forward:  t0 = f0(x); t1 = f1(t0); t2 = loss(t1)
+     * backward: t3 = g2(t2); t4 = g1(t3, t1); t5 = g0(t4, t0)
+     */
+    tensors_ = {MakeTensor(100, 0, {1, 5}, {}), MakeTensor(100, 1, {2, 4}, {0}), MakeTensor(10, 2, {3}, {1}),
+                MakeTensor(10, 3, {4}, {2}),    MakeTensor(10, 4, {5}, {3, 1}),  MakeTensor(10, 5, {}, {4, 0})};
+  }
+  void TearDown() override {}
+
+ protected:
+  static RecomputeTensorInfo MakeTensor(size_t size, size_t def_step, const std::vector<size_t> &use_steps,
+                                        const std::vector<size_t> &producer_inputs) {
+    RecomputeTensorInfo tensor;
+    tensor.size = size;
+    tensor.def_step = def_step;
+    tensor.use_steps = use_steps;
+    tensor.producer_inputs = producer_inputs;
+    tensor.flops = static_cast<double>(size);
+    tensor.recomputable = true;
+    return tensor;
+  }
+  std::vector<RecomputeTensorInfo> tensors_;
+};
+
+TEST_F(TestMemoryBudgetRecompute, test_estimate_peak) {
+  RecomputePlanner planner(tensors_, 6, 3);
+  std::vector<bool> dropped(tensors_.size(), false);
+  EXPECT_EQ(planner.EstimatePeak(dropped), 220);
+  dropped[0] = true;
+  EXPECT_EQ(planner.EstimatePeak(dropped), 200);
+  EXPECT_EQ(planner.RecomputeStep(0), 5);
+  EXPECT_EQ(planner.RecomputeStep(1), 4);
+}
+
+TEST_F(TestMemoryBudgetRecompute, test_recompute_segment) {
+  RecomputePlanner planner(tensors_, 6, 3);
+  std::vector<bool> dropped(tensors_.size(), false);
+  dropped[0] = true;
+  dropped[1] = true;
+  EXPECT_EQ(planner.RecomputeSegment(1, dropped), std::vector<size_t>({0, 1}));
+  EXPECT_EQ(planner.RecomputeSegment(0, dropped), std::vector<size_t>({0}));
+}
+
+TEST_F(TestMemoryBudgetRecompute, test_plan_within_budget) {
+  RecomputePlanner planner(tensors_, 6, 3);
+  auto plan = planner.Plan(1024);
+  EXPECT_TRUE(plan.dropped.empty());
+  EXPECT_EQ(plan.origin_peak, plan.planned_peak);
+  EXPECT_EQ(plan.extra_flops, 0);
+}
+
+TEST_F(TestMemoryBudgetRecompute, test_plan_over_budget) {
+  RecomputePlanner planner(tensors_, 6, 3);
+  auto plan = planner.Plan(150);
+  EXPECT_EQ(plan.origin_peak, 220);
+  EXPECT_EQ(plan.planned_peak, 200);
+  EXPECT_EQ(plan.dropped, std::vector<size_t>({0}));
+  EXPECT_EQ(plan.extra_flops, 100);
+  EXPECT_EQ(plan.total_flops, 240);
+}
+
+TEST_F(TestMemoryBudgetRecompute, test_not_recomputable) {
+  for (auto &tensor : tensors_) {
+    tensor.recomputable = false;
+  }
+  RecomputePlanner planner(tensors_, 6, 3);
+  auto plan = planner.Plan(0);
+  EXPECT_TRUE(plan.dropped.empty());
+  EXPECT_EQ(plan.planned_peak, 220);
+}
+
+class TestMemoryBudgetRecomputeGraph : public UT::Common {
+ public:
+  TestMemoryBudgetRecomputeGraph() = default;
+  ~TestMemoryBudgetRecomputeGraph() override = default;
+
+  void SetUp() override {
+    /*
+     * The graph of TestMemoryBudgetRecompute with float tensors, so every size is four times larger:
+     * forward:  f0 = Square(x); f1 = Square(f0); loss = ReduceSum(f1)
+     * backward: g2 = Mul(loss); g1 = Mul(g2, f1); g0 = Mul(g1, f0)
+     */
+    graph_ = std::make_shared<session::KernelGraph>();
+    x_ = graph_->NewParameter(std::make_shared<abstract::AbstractTensor>(kFloat32, std::vector<int64_t>{100}));
+    f0_ = NewKernel("Square", {x_}, {100}, false);
+    f1_ = NewKernel("Square", {f0_}, {100}, false);
+    loss_ = NewKernel("ReduceSum", {f1_}, {10}, false);
+    g2_ = NewKernel("Mul", {loss_}, {10}, true);
+    g1_ = NewKernel("Mul", {g2_, f1_}, {10}, true);
+    g0_ = NewKernel("Mul", {g1_, f0_}, {10}, true);
+    graph_->set_execution_order({f0_, f1_, loss_, g2_, g1_, g0_});
+    graph_->set_output(g0_);
+  }
+  void TearDown() override {}
+
+ protected:
+  CNodePtr NewKernel(const std::string &op_name, const std::vector<AnfNodePtr> &inputs,
+                     const std::vector<int64_t> &shape, bool backward) {
+    std::vector<AnfNodePtr> node_inputs = {NewValueNode(std::make_shared<Primitive>(op_name))};
+    node_inputs.insert(node_inputs.end(), inputs.begin(), inputs.end());
+    auto node = graph_->NewCNode(node_inputs);
+    node->set_abstract(std::make_shared<abstract::AbstractTensor>(kFloat32, shape));
+    node->set_kernel_info(std::make_shared<device::KernelInfo>());
+    KernelBuildInfoBuilder builder;
+    builder.SetInputsFormat(std::vector<std::string>(inputs.size(), kOpFormat_DEFAULT));
+    builder.SetInputsDeviceType(std::vector<TypeId>(inputs.size(), kNumberTypeFloat32));
+    builder.SetOutputsFormat({kOpFormat_DEFAULT});
+    builder.SetOutputsDeviceType({kNumberTypeFloat32});
+    AnfAlgo::SetSelectKernelBuildInfo(builder.Build(), node.get());
+    // the pass tells the backward kernels by their scope
+    node->set_fullname_with_scope((backward ? "Gradients/" : "Default/") + op_name + "-op" +
+                                  std::to_string(kernel_num_++));
+    return node;
+  }
+
+  // Every kernel input produced by another kernel is computed earlier in the execution order.
+  static void CheckExecutionOrder(const std::vector<CNodePtr> &execution_order) {
+    for (size_t step = 0; step < execution_order.size(); ++step) {
+      const auto &kernel = execution_order[step];
+      for (size_t i = 1; i < kernel->inputs().size(); ++i) {
+        auto input = kernel->input(i);
+        if (!input->isa<CNode>()) {
+          continue;
+        }
+        auto iter = std::find(execution_order.begin(), execution_order.end(), input);
+        ASSERT_NE(iter, execution_order.end()) << kernel->fullname_with_scope() << " input " << i;
+        EXPECT_LT(static_cast<size_t>(iter - execution_order.begin()), step) << kernel->fullname_with_scope();
+      }
+    }
+  }
+
+  KernelGraphPtr graph_;
+  AnfNodePtr x_;
+  CNodePtr f0_;
+  CNodePtr f1_;
+  CNodePtr loss_;
+  CNodePtr g2_;
+  CNodePtr g1_;
+  CNodePtr g0_;
+  size_t kernel_num_{0};
+};
+
+TEST_F(TestMemoryBudgetRecomputeGraph, test_recompute_over_budget) {
+  MemoryBudgetRecompute pass(600);
+  EXPECT_TRUE(pass.Run(graph_));
+  EXPECT_EQ(pass.recomputed_num(), 1);
+
+  // f0 is regenerated from x right before g0, the only backward kernel reading it
+  const auto &execution_order = graph_->execution_order();
+  ASSERT_EQ(execution_order.size(), 7);
+  auto clone = execution_order[5];
+  EXPECT_NE(clone, f0_);
+  EXPECT_EQ(AnfAlgo::GetCNodeName(clone), "Square");
+  ASSERT_EQ(clone->inputs().size(), 2);
+  EXPECT_EQ(clone->input(1), x_);
+  EXPECT_EQ(AnfAlgo::GetOutputDeviceShape(clone, 0), AnfAlgo::GetOutputDeviceShape(f0_, 0));
+  EXPECT_EQ(execution_order[6], g0_);
+  EXPECT_EQ(g0_->input(2), clone);
+
+  // the forward kernels and the other backward edges are left alone
+  EXPECT_EQ(std::vector<CNodePtr>(execution_order.begin(), execution_order.begin() + 5),
+            std::vector<CNodePtr>({f0_, f1_, loss_, g2_, g1_}));
+  EXPECT_EQ(f1_->input(1), f0_);
+  EXPECT_EQ(g1_->input(2), f1_);
+  CheckExecutionOrder(execution_order);
+}
+
+TEST_F(TestMemoryBudgetRecomputeGraph, test_graph_within_budget) {
+  MemoryBudgetRecompute pass(1024);
+  EXPECT_FALSE(pass.Run(graph_));
+  EXPECT_EQ(pass.recomputed_num(), 0);
+  EXPECT_EQ(graph_->execution_order(), std::vector<CNodePtr>({f0_, f1_, loss_, g2_, g1_, g0_}));
+  EXPECT_EQ(g0_->input(2), f0_);
+}
+}  // namespace opt
+}  // namespace mindspore
@@ -0,0 +1,275 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "backend/optimizer/common/optimizer.h"
+#include "backend/optimizer/common/pass_manager.h"
+#include "backend/optimizer/pass/multi_tensor_optimizer_fusion.h"
+#include "backend/kernel_compiler/cpu/adam_cpu_kernel.h"
+#include "backend/kernel_compiler/cpu/apply_momentum_cpu_kernel.h"
+#include "backend/kernel_compiler/cpu/multi_tensor_optimizer_cpu_kernel.h"
+#include "backend/session/anf_runtime_algorithm.h"
+#include "backend/session/kernel_graph.h"
+#include "frontend/operator/ops.h"
+#include "runtime/device/kernel_info.h"
+#include "utils/utils.h"
+
+namespace mindspore {
+namespace opt {
+using KernelBuildInfoBuilder = kernel::KernelBuildInfo::KernelBuildInfoBuilder;
+
+class TestMultiTensorOptimizerFusion : public UT::Common {
+ public:
+  TestMultiTensorOptimizerFusion() = default;
+  ~TestMultiTensorOptimizerFusion() override = default;
+
+  void SetUp() override {
+    graph_ = std::make_shared<session::KernelGraph>();
+    optimizers_.clear();
+    buffers_.clear();
+  }
+
+ protected:
+  AnfNodePtr NewParameter(const std::vector<int64_t> &shape, float base) {
+    auto parameter = graph_->NewParameter(std::make_shared<abstract::AbstractTensor>(kFloat32, shape));
+    size_t elem_num = std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<int64_t>());
+    std::vector<float> data(elem_num);
+    for (size_t i = 0; i < elem_num; ++i) {
+      data[i] = base + 0.001f * static_cast<float>(i % 97);
+    }
+    buffers_[parameter] = data;
+    return parameter;
+  }
+
+  CNodePtr NewOptimizer(const std::string &op_name, const std::vector<AnfNodePtr> &inputs, size_t output_num,
+                        const std::vector<int64_t> &shape) {
+    std::vector<AnfNodePtr> node_inputs = {NewValueNode(std::make_shared<Primitive>(op_name))};
+    node_inputs.insert(node_inputs.end(), inputs.begin(), inputs.end());
+    auto node = graph_->NewCNode(node_inputs);
+    auto abstract = std::make_shared<abstract::AbstractTensor>(kFloat32, shape);
+    if (output_num == 1) {
+      node->set_abstract(abstract);
+    } else {
+      node->set_abstract(std::make_shared<abstract::AbstractTuple>(AbstractBasePtrList(output_num, abstract)));
+    }
+    node->set_kernel_info(std::make_shared<device::KernelInfo>());
+    KernelBuildInfoBuilder builder;
+    builder.SetInputsFormat(std::vector<std::string>(inputs.size(), kOpFormat_DEFAULT));
+    builder.SetInputsDeviceType(std::vector<TypeId>(inputs.size(), kNumberTypeFloat32));
+    builder.SetOutputsFormat(std::vector<std::string>(output_num, kOpFormat_DEFAULT));
+    builder.SetOutputsDeviceType(std::vector<TypeId>(output_num, kNumberTypeFloat32));
+    AnfAlgo::SetSelectKernelBuildInfo(builder.Build(), node.get());
+    optimizers_.push_back(node);
+    return node;
+  }
+
+  CNodePtr NewApplyMomentum(const std::vector<int64_t> &shape, float base) {
+    return NewOptimizer(kApplyMomentumOpName,
+                        {NewParameter(shape, base), NewParameter(shape, 0.5), NewParameter({1}, 0.01),
+                         NewParameter(shape, 0.1 * base), NewParameter({1}, 0.9)},
+                        1, shape);
+  }
+
+  CNodePtr NewAdam(const std::vector<int64_t> &shape, float base, bool use_nesterov) {
+    auto node = NewOptimizer(kApplyAdamOpName,
+                             {NewParameter(shape, base), NewParameter(shape, 0.2), NewParameter(shape, 0.3),
+                              NewParameter({1}, 0.9), NewParameter({1}, 0.999), NewParameter({1}, 0.001),
+                              NewParameter({1}, 0.9), NewParameter({1}, 0.999), NewParameter({1}, 1e-8),
+                              NewParameter(shape, 0.1 * base)},
+                             3, shape);
+    AnfAlgo::SetNodeAttr("use_nesterov", MakeValue(use_nesterov), node);
+    return node;
+  }
+
+  void SetGraphOutput() {
+    std::vector<AnfNodePtr> make_tuple_inputs = {NewValueNode(prim::kPrimMakeTuple)};
+    make_tuple_inputs.insert(make_tuple_inputs.end(), optimizers_.begin(), optimizers_.end());
+    auto make_tuple = graph_->NewCNode(make_tuple_inputs);
+    AbstractBasePtrList abstract_list;
+    for (const auto &optimizer : optimizers_) {
+      abstract_list.push_back(optimizer->abstract());
+    }
+    make_tuple->set_abstract(std::make_shared<abstract::AbstractTuple>(abstract_list));
+    graph_->set_output(make_tuple);
+  }
+
+  void RunPass() {
+    auto optimizer = std::make_shared<GraphOptimizer>();
+    auto pm = std::make_shared<PassManager>();
+    pm->AddPass(std::make_shared<MultiTensorOptimizerFusion>());
+    optimizer->AddPassManager(pm);
+    (void)optimizer->Optimize(graph_);
+  }
+
+  std::vector<CNodePtr> GetKernels() {
+    std::vector<CNodePtr> kernels;
+    for (const auto &node : TopoSort(graph_->get_return())) {
+      if (node->isa<CNode>() && AnfAlgo::IsRealKernel(node)) {
+        kernels.push_back(node->cast<CNodePtr>());
+      }
+    }
+    return kernels;
+  }
+
+  static std::shared_ptr<kernel::CPUKernel> CreateKernel(const std::string &op_name) {
+    if (op_name == kApplyMomentumOpName) {
+      return std::make_shared<kernel::ApplyMomentumCPUKernel>();
+    } else if (op_name == kApplyAdamOpName) {
+      return std::make_shared<kernel::AdamCPUKernel>();
+    } else if (op_name == kMultiTensorApplyMomentumOpName) {
+      return std::make_shared<kernel::MultiTensorApplyMomentumCPUKernel>();
+    } else if (op_name == kMultiTensorAdamOpName) {
+      return std::make_shared<kernel::MultiTensorAdamCPUKernel>();
+    }
+    return nullptr;
+  }
+
+  // launch every kernel of the graph on the buffers of its input parameters
+  void LaunchKernels() {
+    for (const auto &kernel_node : GetKernels()) {
+      auto kernel = CreateKernel(AnfAlgo::GetCNodeName(kernel_node));
+      ASSERT_NE(kernel, nullptr);
+      kernel->InitKernel(kernel_node);
+      std::vector<kernel::AddressPtr> inputs;
+      for (size_t i = 0; i < AnfAlgo::GetInputTensorNum(kernel_node); ++i) {
+        auto &buffer = buffers_.at(AnfAlgo::GetInputNode(kernel_node, i));
+        inputs.push_back(std::make_shared<kernel::Address>(buffer.data(), buffer.size() * sizeof(float)));
+      }
+      std::vector<kernel::AddressPtr> workspaces;
+      std::vector<kernel::AddressPtr> outputs(AnfAlgo::GetOutputTensorNum(kernel_node),
+                                              std::make_shared<kernel::Address>(nullptr, 0));
+      EXPECT_TRUE(kernel->Launch(inputs, workspaces, outputs));
+    }
+  }
+
+  void BuildMixedOptimizerGraph() {
+    (void)NewApplyMomentum({3}, 1.0);
+    (void)NewAdam({64, 33}, 1.0, false);
+    (void)NewApplyMomentum({129, 65}, 2.0);
+    (void)NewAdam({7}, 3.0, false);
+    (void)NewAdam({5, 5}, 4.0, true);
+    (void)NewApplyMomentum({1000}, 5.0);
+    SetGraphOutput();
+  }
+
+  // the parameters in the order they were created, with their data
+  std::vector<std::vector<float>> GetParameterData() {
+    std::vector<std::vector<float>> data;
+    for (const auto &parameter : graph_->parameters()) {
+      data.push_back(buffers_.at(parameter));
+    }
+    return data;
+  }
+
+  KernelGraphPtr graph_;
+  std::vector<AnfNodePtr> optimizers_;
+  std::map<AnfNodePtr, std::vector<float>> buffers_;
+};
+
+TEST_F(TestMultiTensorOptimizerFusion, test_fuse_by_op_and_attr) {
+  BuildMixedOptimizerGraph();
+  RunPass();
+  std::map<std::string, std::vector<CNodePtr>> kernels;
+  for (const auto &kernel : GetKernels()) {
+    kernels[AnfAlgo::GetCNodeName(kernel)].push_back(kernel);
+  }
+  // the nesterov Adam has no other Adam with the same attributes, so it is left alone
+  ASSERT_EQ(kernels.size(), 3);
+  ASSERT_EQ(kernels[kMultiTensorApplyMomentumOpName].size(), 1);
+  ASSERT_EQ(kernels[kMultiTensorAdamOpName].size(), 1);
+  ASSERT_EQ(kernels[kApplyAdamOpName].size(), 1);
+  EXPECT_TRUE(AnfAlgo::GetNodeAttr<bool>(kernels[kApplyAdamOpName][0], "use_nesterov"));
+
+  auto momentum = kernels[kMultiTensorApplyMomentumOpName][0];
+  EXPECT_EQ(AnfAlgo::GetNodeAttr<size_t>(momentum, "n"), 3);
+  EXPECT_EQ(AnfAlgo::GetInputTensorNum(momentum), 15);
+  EXPECT_EQ(AnfAlgo::GetOutputTensorNum(momentum), 3);
+  auto adam = kernels[kMultiTensorAdamOpName][0];
+  EXPECT_EQ(AnfAlgo::GetNodeAttr<size_t>(adam, "n"), 2);
+  EXPECT_EQ(AnfAlgo::GetInputTensorNum(adam), 20);
+  EXPECT_EQ(AnfAlgo::GetOutputTensorNum(adam), 6);
+  EXPECT_FALSE(AnfAlgo::GetNodeAttr<bool>(adam, "use_nesterov"));
+  // the inputs keep the order of the original optimizers
+  EXPECT_EQ(AnfAlgo::GetInputNode(adam, 0), AnfAlgo::GetInputNode(optimizers_[1]->cast<CNodePtr>(), 0));
+  EXPECT_EQ(AnfAlgo::GetInputNode(adam, 10), AnfAlgo::GetInputNode(optimizers_[3]->cast<CNodePtr>(), 0));
+}
+
+TEST_F(TestMultiTensorOptimizerFusion, test_skip_dependent_optimizer) {
+  auto first = NewApplyMomentum({8}, 1.0);
+  (void)NewApplyMomentum({8}, 2.0);
+  // the gradient of the third optimizer is the output of the first one
+  std::vector<int64_t> shape = {8};
+  (void)NewOptimizer(kApplyMomentumOpName,
+                     {NewParameter(shape, 3.0), NewParameter(shape, 0.5), NewParameter({1}, 0.01), first,
+                      NewParameter({1}, 0.9)},
+                     1, shape);
+  SetGraphOutput();
+  RunPass();
+  size_t fused_num = 0;
+  size_t single_num = 0;
+  for (const auto &kernel : GetKernels()) {
+    auto op_name = AnfAlgo::GetCNodeName(kernel);
+    if (op_name == kMultiTensorApplyMomentumOpName) {
+      ++fused_num;
+      EXPECT_EQ(AnfAlgo::GetNodeAttr<size_t>(kernel, "n"), 2);
+    } else if (op_name == kApplyMomentumOpName) {
+      ++single_num;
+      auto grad = AnfAlgo::VisitKernel(AnfAlgo::GetInputNode(kernel, 3), 0).first;
+      EXPECT_EQ(AnfAlgo::GetCNodeName(grad), kMultiTensorApplyMomentumOpName);
+    }
+  }
+  EXPECT_EQ(fused_num, 1);
+  EXPECT_EQ(single_num, 1);
+}
+
+TEST_F(TestMultiTensorOptimizerFusion, test_fused_update_equals_unfused) {
+  BuildMixedOptimizerGraph();
+  LaunchKernels();
+  auto unfused_data = GetParameterData();
+
+  SetUp();
+  BuildMixedOptimizerGraph();
+  RunPass();
+  LaunchKernels();
+  auto fused_data = GetParameterData();
+
+  ASSERT_EQ(fused_data.size(), unfused_data.size());
+  for (size_t i = 0; i < fused_data.size(); ++i) {
+    ASSERT_EQ(fused_data[i].size(), unfused_data[i].size());
+    for (size_t j = 0; j < fused_data[i].size(); ++j) {
+      EXPECT_NEAR(fused_data[i][j], unfused_data[i][j], 1e-5);
+    }
+  }
+}
+
+TEST_F(TestMultiTensorOptimizerFusion, test_enabled_by_env) {
+  (void)unsetenv(kEnvCpuOptimizerFusion);
+  EXPECT_FALSE(MultiTensorOptimizerFusion::IsEnabledByEnv());
+  (void)setenv(kEnvCpuOptimizerFusion, "0", 1);
+  EXPECT_FALSE(MultiTensorOptimizerFusion::IsEnabledByEnv());
+  (void)setenv(kEnvCpuOptimizerFusion, "1", 1);
+  EXPECT_TRUE(MultiTensorOptimizerFusion::IsEnabledByEnv());
+  (void)unsetenv(kEnvCpuOptimizerFusion);
+}
+}  // namespace opt
+}  // namespace mindspore
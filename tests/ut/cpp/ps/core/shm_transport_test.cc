@@ -0,0 +1,176 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+#include "common/common_test.h"
+#include "ps/core/shm_transport.h"
+#include "ps/core/cluster_config.h"
+
+namespace mindspore {
+namespace ps {
+namespace core {
+class TestShmTransport : public UT::Common {
+ public:
+  TestShmTransport() = default;
+  virtual ~TestShmTransport() = default;
+
+  void SetUp() override {
+    // a connection over the loopback, both of its ends are on this host
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = 0;
+    ASSERT_EQ(bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(listen_fd_, 1), 0);
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len), 0);
+    client_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(client_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+    server_fd_ = accept(listen_fd_, nullptr, nullptr);
+    ASSERT_GE(server_fd_, 0);
+  }
+
+  void TearDown() override {
+    (void)close(client_fd_);
+    (void)close(server_fd_);
+    (void)close(listen_fd_);
+  }
+
+  int listen_fd_{-1};
+  int client_fd_{-1};
+  int server_fd_{-1};
+};
+
+TEST_F(TestShmTransport, ArenaWrapsAround) {
+  std::string name = "mindspore_ps_test_" + std::to_string(getpid());
+  auto writer = ShmArena::Create(name, 100);
+  ASSERT_NE(writer, nullptr);
+  auto reader = ShmArena::Attach(name);
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(reader->capacity(), 100);
+
+  uint64_t first = 0;
+  uint64_t second = 0;
+  uint8_t *addr = nullptr;
+  EXPECT_TRUE(writer->Allocate(60, &first, &addr));
+  (void)memset(addr, 1, 60);
+  // the end of the ring is too small and the start is not freed yet
+  EXPECT_FALSE(writer->Allocate(50, &second, &addr));
+  EXPECT_FALSE(writer->Allocate(101, &second, &addr));
+  const uint8_t *data = reader->Data(first, 60);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(data[59], 1);
+  reader->Release(first, 60);
+  EXPECT_TRUE(writer->Allocate(50, &second, &addr));
+  EXPECT_EQ(second, 100);
+  (void)memset(addr, 2, 50);
+  EXPECT_EQ(reader->Data(second, 50)[0], 2);
+  EXPECT_EQ(reader->Data(second + 50, 60), nullptr);
+}
+
+TEST_F(TestShmTransport, ArenaOfFullShm) {
+  // the memory of the arena is allocated when it is created, not when a message is written to it
+  std::string name = "mindspore_ps_test_full_" + std::to_string(getpid());
+  EXPECT_EQ(ShmArena::Create(name, static_cast<size_t>(1) << 50), nullptr);
+  EXPECT_NE(access(("/dev/shm/" + name).c_str(), F_OK), 0);
+}
+
+TEST_F(TestShmTransport, SendThroughShm) {
+  size_t arena_size = ClusterConfig::shm_arena_size();
+  ClusterConfig::set_shm_arena_size(1 << 20);
+  ShmTransport sender;
+  ShmTransport receiver;
+  CommMessage offer;
+  sender.Init(client_fd_, [&offer](const CommMessage &msg) { offer = msg; });
+  EXPECT_EQ(offer.pb_meta().shm_handshake(), SHM_OFFER);
+  // the messages go through the socket until the peer has attached the arena
+  EXPECT_FALSE(sender.enable());
+  CommMessage answer;
+  EXPECT_FALSE(receiver.ReceiveMessage(&offer, [&answer](const CommMessage &msg) { answer = msg; }));
+  EXPECT_EQ(answer.pb_meta().shm_handshake(), SHM_ACCEPT);
+  EXPECT_FALSE(sender.ReceiveMessage(&answer, [](const CommMessage &) {}));
+  EXPECT_TRUE(sender.enable());
+  // the file is removed once both ends have mapped it
+  EXPECT_NE(access(("/dev/shm/" + offer.pb_meta().shm_name()).c_str(), F_OK), 0);
+
+  CommMessage message;
+  message.mutable_pb_meta()->set_request_id(7);
+  std::string data(kShmMinMessageSize * 3, 'a');
+  data[5] = 'b';
+  message.set_data(data);
+  CommMessage packed;
+  EXPECT_TRUE(sender.SendMessage(message, [&packed](const CommMessage &msg) { packed = msg; }));
+  EXPECT_TRUE(packed.data().empty());
+  EXPECT_TRUE(ShmTransport::IsShmMessage(packed));
+
+  EXPECT_TRUE(receiver.ReceiveMessage(&packed, [](const CommMessage &) {}));
+  EXPECT_FALSE(ShmTransport::IsShmMessage(packed));
+  EXPECT_EQ(packed.pb_meta().request_id(), 7);
+  EXPECT_EQ(packed.data(), data);
+
+  // the small messages and those larger than the arena go through the socket
+  message.set_data("small");
+  EXPECT_FALSE(sender.SendMessage(message, [](const CommMessage &) {}));
+  message.set_data(std::string(ClusterConfig::shm_arena_size() + 1, 'c'));
+  EXPECT_FALSE(sender.SendMessage(message, [](const CommMessage &) {}));
+  ClusterConfig::set_shm_arena_size(arena_size);
+}
+
+TEST_F(TestShmTransport, FallBackWhenPeerCannotAttach) {
+  size_t arena_size = ClusterConfig::shm_arena_size();
+  ClusterConfig::set_shm_arena_size(1 << 20);
+  ShmTransport sender;
+  ShmTransport receiver;
+  CommMessage offer;
+  sender.Init(client_fd_, [&offer](const CommMessage &msg) { offer = msg; });
+  // a peer of the same address with a /dev/shm of its own doesn't find the file of the arena
+  ASSERT_EQ(unlink(("/dev/shm/" + offer.pb_meta().shm_name()).c_str()), 0);
+  CommMessage answer;
+  EXPECT_FALSE(receiver.ReceiveMessage(&offer, [&answer](const CommMessage &msg) { answer = msg; }));
+  EXPECT_EQ(answer.pb_meta().shm_handshake(), SHM_REJECT);
+  EXPECT_FALSE(sender.ReceiveMessage(&answer, [](const CommMessage &) {}));
+  EXPECT_FALSE(sender.enable());
+
+  CommMessage message;
+  message.set_data(std::string(kShmMinMessageSize * 2, 'a'));
+  EXPECT_FALSE(sender.SendMessage(message, [](const CommMessage &) {}));
+
+  // the data of an arena that was not attached is dropped instead of raising an exception
+  message.mutable_pb_meta()->set_shm_name(offer.pb_meta().shm_name());
+  message.mutable_pb_meta()->set_shm_length(kShmMinMessageSize);
+  message.clear_data();
+  EXPECT_FALSE(receiver.ReceiveMessage(&message, [](const CommMessage &) {}));
+  ClusterConfig::set_shm_arena_size(arena_size);
+}
+
+TEST_F(TestShmTransport, DisabledByDefault) {
+  EXPECT_EQ(ClusterConfig::shm_arena_size(), 0);
+  ShmTransport sender;
+  bool offered = false;
+  sender.Init(client_fd_, [&offered](const CommMessage &) { offered = true; });
+  EXPECT_FALSE(offered);
+  EXPECT_FALSE(sender.enable());
+}
+}  // namespace core
+}  // namespace ps
+}  // namespace mindspore
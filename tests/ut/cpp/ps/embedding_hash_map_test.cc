@@ -0,0 +1,146 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <set>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/ps_cache/embedding_hash_map.h"
+
+namespace mindspore {
+namespace ps {
+class TestEmbeddingHashMap : public UT::Common {
+ public:
+  TestEmbeddingHashMap() = default;
+  virtual ~TestEmbeddingHashMap() = default;
+
+  // Inserts the id at data_step, the graph has finished the steps before graph_running_step.
+  int Insert(EmbeddingHashMap *hash_map, int64_t id, size_t data_step, size_t graph_running_step) {
+    swap_out_index_ = INVALID_INDEX_VALUE;
+    return hash_map->ParseData(id, data_step, graph_running_step, &swap_out_index_, &swap_out_id_);
+  }
+
+  int swap_out_index_{INVALID_INDEX_VALUE};
+  int64_t swap_out_id_{0};
+};
+
+TEST_F(TestEmbeddingHashMap, InsertAndFind) {
+  EmbeddingHashMap hash_map(0, 1000);
+  std::set<int> indexes;
+  for (int64_t i = 0; i < 1000; ++i) {
+    // ids beyond the int range
+    int64_t id = (i << 33) + i;
+    int index = Insert(&hash_map, id, 1, 1);
+    EXPECT_NE(index, INVALID_INDEX_VALUE);
+    EXPECT_EQ(swap_out_index_, INVALID_INDEX_VALUE);
+    indexes.insert(index);
+  }
+  EXPECT_EQ(indexes.size(), 1000);
+  EXPECT_EQ(hash_map.hash_count(), 1000);
+  for (int64_t i = 0; i < 1000; ++i) {
+    int index = hash_map.GetIndex((i << 33) + i);
+    EXPECT_NE(index, INVALID_INDEX_VALUE);
+    EXPECT_EQ(hash_map.hash_step(index), 1);
+  }
+  EXPECT_EQ(hash_map.GetIndex(1000), INVALID_INDEX_VALUE);
+  std::vector<int> ids = {0, 3, 7};
+  std::vector<int> batch_indexes(ids.size());
+  hash_map.GetIndexes(ids.data(), ids.size(), batch_indexes.data());
+  EXPECT_EQ(batch_indexes[0], hash_map.GetIndex(0));
+  EXPECT_EQ(batch_indexes[1], INVALID_INDEX_VALUE);
+  EXPECT_EQ(batch_indexes[2], INVALID_INDEX_VALUE);
+}
+
+TEST_F(TestEmbeddingHashMap, LruSwapOut) {
+  EmbeddingHashMap hash_map(0, 3, kCacheLRU);
+  for (int64_t id = 0; id < 3; ++id) {
+    Insert(&hash_map, id, 1, 1);
+  }
+  hash_map.set_hash_step(hash_map.GetIndex(0), 2);
+  int index_of_1 = hash_map.GetIndex(1);
+  // the data of step 2 is not used by the graph yet, id 1 is the least recently used
+  int index = Insert(&hash_map, 3, 2, 2);
+  EXPECT_EQ(index, index_of_1);
+  EXPECT_EQ(swap_out_index_, index_of_1);
+  EXPECT_EQ(swap_out_id_, 1);
+  EXPECT_EQ(hash_map.GetIndex(1), INVALID_INDEX_VALUE);
+  EXPECT_EQ(hash_map.GetIndex(3), index);
+  // ids 0 and 3 are used by step 2, which the graph is running
+  EXPECT_EQ(Insert(&hash_map, 4, 2, 2), hash_map.GetIndex(2));
+  EXPECT_EQ(Insert(&hash_map, 5, 2, 2), INVALID_INDEX_VALUE);
+  EXPECT_EQ(swap_out_index_, INVALID_INDEX_VALUE);
+}
+
+TEST_F(TestEmbeddingHashMap, LfuSwapOut) {
+  EmbeddingHashMap hash_map(0, 3, kCacheLFU);
+  for (int64_t id = 0; id < 3; ++id) {
+    Insert(&hash_map, id, 1, 1);
+  }
+  for (size_t step = 2; step < 5; ++step) {
+    hash_map.set_hash_step(hash_map.GetIndex(0), step);
+  }
+  hash_map.set_hash_step(hash_map.GetIndex(2), 5);
+  // id 2 is used more recently than id 0 but less often, id 1 is used least often
+  int index_of_1 = hash_map.GetIndex(1);
+  EXPECT_EQ(Insert(&hash_map, 3, 6, 6), index_of_1);
+  EXPECT_EQ(swap_out_id_, 1);
+  // the new ids are swapped out first until they are used again
+  Insert(&hash_map, 4, 7, 7);
+  EXPECT_EQ(swap_out_id_, 3);
+  Insert(&hash_map, 5, 8, 8);
+  EXPECT_EQ(swap_out_id_, 4);
+  hash_map.set_hash_step(hash_map.GetIndex(5), 8);
+  Insert(&hash_map, 6, 9, 9);
+  EXPECT_EQ(swap_out_id_, 2);
+  EXPECT_NE(hash_map.GetIndex(0), INVALID_INDEX_VALUE);
+}
+
+TEST_F(TestEmbeddingHashMap, ReuseDeletedSlots) {
+  EmbeddingHashMap hash_map(0, 64);
+  for (size_t step = 1; step <= 100; ++step) {
+    for (int64_t i = 0; i < 64; ++i) {
+      int64_t id = static_cast<int64_t>(step) * 64 + i;
+      EXPECT_NE(Insert(&hash_map, id, step, step), INVALID_INDEX_VALUE);
+    }
+  }
+  EXPECT_EQ(hash_map.hash_count(), 64);
+  for (int64_t i = 0; i < 64; ++i) {
+    EXPECT_NE(hash_map.GetIndex(100 * 64 + i), INVALID_INDEX_VALUE);
+    EXPECT_EQ(hash_map.GetIndex(99 * 64 + i), INVALID_INDEX_VALUE);
+  }
+}
+TEST_F(TestEmbeddingHashMap, RehashBoundedWhenFull) {
+  // every insertion into the full cache swaps an id out and leaves a deleted slot behind
+  constexpr size_t kCapacity = 895;
+  constexpr size_t kSwapNum = 50000;
+  EmbeddingHashMap hash_map(0, kCapacity);
+  int64_t next_id = 0;
+  for (size_t i = 0; i < kCapacity; ++i) {
+    EXPECT_NE(Insert(&hash_map, next_id++, 1, 1), INVALID_INDEX_VALUE);
+  }
+  for (size_t i = 0; i < kSwapNum; ++i) {
+    size_t step = i + 2;
+    ASSERT_NE(Insert(&hash_map, next_id++, step, step), INVALID_INDEX_VALUE);
+    EXPECT_NE(swap_out_index_, INVALID_INDEX_VALUE);
+  }
+  EXPECT_EQ(hash_map.hash_count(), kCapacity);
+  // at least a quarter of the slots, which is more than half of the capacity, is deleted between two rehashes
+  EXPECT_LE(hash_map.rehash_count(), kSwapNum / (kCapacity / 2));
+  for (int64_t id = next_id - static_cast<int64_t>(kCapacity); id < next_id; ++id) {
+    EXPECT_NE(hash_map.GetIndex(id), INVALID_INDEX_VALUE);
+  }
+  EXPECT_EQ(hash_map.GetIndex(next_id - static_cast<int64_t>(kCapacity) - 1), INVALID_INDEX_VALUE);
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,133 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/embedding_hot_rows.h"
+
+namespace mindspore {
+namespace ps {
+class TestEmbeddingHotRows : public UT::Common {
+ public:
+  TestEmbeddingHotRows() = default;
+  virtual ~TestEmbeddingHotRows() = default;
+};
+
+TEST_F(TestEmbeddingHotRows, HotRows) {
+  // the shard holds the ids 100 to 109
+  EmbeddingAccessCounter counter(10, 100, 16);
+  std::vector<Key> ids = {105, 101, 105, 108, 105, 101, 3, 110};
+  counter.Record(ids.data(), ids.size());
+  counter.Record(108, 5);
+  EXPECT_EQ(counter.HotRows(2), std::vector<Key>({108, 105}));
+  // taking the hot rows doesn't change the counts
+  EXPECT_EQ(counter.HotRows(5), std::vector<Key>({108, 105, 101}));
+  counter.Record(101, 4);
+  EXPECT_EQ(counter.HotRows(5), std::vector<Key>({101, 108, 105}));
+}
+
+TEST_F(TestEmbeddingHotRows, DecayOnTimer) {
+  const auto decay_interval = std::chrono::milliseconds(100);
+  EmbeddingAccessCounter counter(10, 100, 16, decay_interval);
+  counter.Record(101, 8);
+  counter.Record(102, 1);
+  std::this_thread::sleep_for(decay_interval * 2);
+  EXPECT_EQ(counter.HotRows(5), std::vector<Key>({101, 102}));
+  // the next lookups halve the counts first, 101 has 4 left and 102 none
+  counter.Record(103, 5);
+  EXPECT_EQ(counter.HotRows(5), std::vector<Key>({103, 101}));
+}
+
+TEST_F(TestEmbeddingHotRows, BoundedCandidates) {
+  // a large shard with a few hot ids among many cold ones
+  const size_t row_num = 1 << 24;
+  EmbeddingAccessCounter counter(row_num, 0, 8);
+  std::vector<Key> hot_ids = {77, 5000000, 123456};
+  for (size_t step = 0; step < 100; ++step) {
+    std::vector<Key> ids;
+    for (size_t i = 0; i < 100; ++i) {
+      ids.push_back((step * 100 + i) * 1609 % row_num);
+    }
+    for (size_t i = 0; i < hot_ids.size(); ++i) {
+      for (size_t j = 0; j < 10 * (hot_ids.size() - i); ++j) {
+        ids.push_back(hot_ids[i]);
+      }
+    }
+    counter.Record(ids.data(), ids.size());
+  }
+  EXPECT_EQ(counter.HotRows(3), hot_ids);
+  // only the candidates are counted by id, they are pruned back to 8 before they reach twice as many
+  size_t candidate_num = counter.HotRows(row_num).size();
+  EXPECT_GE(candidate_num, 8);
+  EXPECT_LT(candidate_num, 16);
+}
+
+TEST_F(TestEmbeddingHotRows, ParseEnv) {
+  EXPECT_EQ(ParseHotRowEnv(kEnvHotRowNum, "0"), 0);
+  EXPECT_EQ(ParseHotRowEnv(kEnvHotRowNum, "128"), 128);
+  EXPECT_ANY_THROW(ParseHotRowEnv(kEnvHotRowNum, ""));
+  EXPECT_ANY_THROW(ParseHotRowEnv(kEnvHotRowNum, "-8"));
+  EXPECT_ANY_THROW(ParseHotRowEnv(kEnvHotRowNum, "8rows"));
+  EXPECT_ANY_THROW(ParseHotRowEnv(kEnvHotRowRefreshSteps, "99999999999999999999999"));
+}
+
+TEST_F(TestEmbeddingHotRows, FindAndTakeHits) {
+  std::vector<int> ids = {7, 3};
+  std::vector<float> rows = {1, 2, 3, 4, 5, 6};
+  HotEmbeddingRows hot_rows(ids.data(), ids.size(), rows.data(), 3, 0);
+  EXPECT_EQ(hot_rows.size(), 2);
+  EXPECT_TRUE(hot_rows.Contains(3));
+  EXPECT_FALSE(hot_rows.Contains(4));
+  const float *row = hot_rows.Find(3);
+  ASSERT_NE(row, nullptr);
+  EXPECT_EQ(row[0], 4);
+  EXPECT_EQ(row[2], 6);
+  EXPECT_EQ(hot_rows.Find(4), nullptr);
+  hot_rows.Find(3);
+
+  std::vector<int> ids_and_hits;
+  hot_rows.TakeHits(&ids_and_hits);
+  EXPECT_EQ(ids_and_hits, std::vector<int>({3, 2}));
+  ids_and_hits.clear();
+  hot_rows.TakeHits(&ids_and_hits);
+  EXPECT_TRUE(ids_and_hits.empty());
+}
+TEST_F(TestEmbeddingHotRows, PushDropsRowsAndExpires) {
+  std::vector<int> ids = {7, 3, 5};
+  std::vector<float> rows = {1, 2, 3, 4, 5, 6};
+  HotEmbeddingRows hot_rows(ids.data(), ids.size(), rows.data(), 2, 1);
+  EXPECT_NE(hot_rows.Find(3), nullptr);
+  EXPECT_FALSE(hot_rows.Expired());
+
+  // the worker pushed a gradient for 3, its copy is older than the update
+  std::vector<int> pushed_ids = {3, 42};
+  hot_rows.Push(pushed_ids.data(), pushed_ids.size());
+  EXPECT_FALSE(hot_rows.Contains(3));
+  EXPECT_EQ(hot_rows.Find(3), nullptr);
+  EXPECT_EQ(hot_rows.size(), 2);
+  EXPECT_FALSE(hot_rows.Expired());
+  std::vector<int> ids_and_hits;
+  hot_rows.TakeHits(&ids_and_hits);
+  EXPECT_EQ(ids_and_hits, std::vector<int>({3, 1}));
+
+  // the other rows are kept, but the copies are now beyond the staleness bound
+  hot_rows.Push(pushed_ids.data() + 1, 1);
+  EXPECT_TRUE(hot_rows.Contains(7));
+  EXPECT_TRUE(hot_rows.Expired());
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,63 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vector>
+#include "common/common_test.h"
+#include "ps/embedding_storage.h"
+
+namespace mindspore {
+namespace ps {
+class TestEmbeddingStorage : public UT::Common {
+ public:
+  TestEmbeddingStorage() = default;
+  virtual ~TestEmbeddingStorage() = default;
+
+  void SetUp() override { EmbeddingStorage::GetInstance().Initialize("/tmp"); }
+  void TearDown() override { EmbeddingStorage::GetInstance().Initialize(""); }
+};
+
+TEST_F(TestEmbeddingStorage, AllocateWeight) {
+  auto &storage = EmbeddingStorage::GetInstance();
+  EXPECT_TRUE(storage.enable());
+  const size_t row_num = 1000;
+  const size_t row_size = 16;
+  WeightPtr table = storage.AllocateWeight(row_num * row_size);
+  ASSERT_NE(table, nullptr);
+  EXPECT_EQ(table->size(), row_num * row_size);
+  EXPECT_TRUE(storage.IsFileBacked(table->data()));
+  EXPECT_TRUE(storage.IsFileBacked(table->data() + row_num * row_size - 1));
+  for (size_t i = 0; i < table->size(); ++i) {
+    EXPECT_EQ((*table)[i], 0);
+    (*table)[i] = i;
+  }
+  // ids out of the shard are skipped
+  std::vector<Key> ids = {100, 5, 999, 100, 1, 2000};
+  storage.Prefetch(table->data(), table->size(), row_size, 100, ids.data(), ids.size());
+  for (size_t i = 0; i < table->size(); ++i) {
+    EXPECT_EQ((*table)[i], i);
+  }
+
+  float *state = storage.AllocateState(table->size());
+  EXPECT_TRUE(storage.IsFileBacked(state));
+  EXPECT_EQ(state[table->size() - 1], 0);
+
+  float *data = table->data();
+  table = nullptr;
+  EXPECT_FALSE(storage.IsFileBacked(data));
+  std::vector<float> memory(10);
+  EXPECT_FALSE(storage.IsFileBacked(memory.data()));
+}
+}  // namespace ps
+}  // namespace mindspore
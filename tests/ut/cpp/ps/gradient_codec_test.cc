@@ -0,0 +1,115 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cmath>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/gradient_codec.h"
+
+namespace mindspore {
+namespace ps {
+class TestGradientCodec : public UT::Common {
+ public:
+  TestGradientCodec() = default;
+  virtual ~TestGradientCodec() = default;
+
+  void SetUp() override {
+    grad_.resize(1000);
+    for (size_t i = 0; i < grad_.size(); ++i) {
+      grad_[i] = std::sin(static_cast<float>(i)) * (i % 7 + 1);
+    }
+  }
+  void TearDown() override {}
+
+  float MaxError(const std::vector<float> &decoded, const std::vector<float> &expected) {
+    EXPECT_EQ(decoded.size(), expected.size());
+    float error = 0;
+    for (size_t i = 0; i < decoded.size() && i < expected.size(); ++i) {
+      error = std::max(error, std::fabs(decoded[i] - expected[i]));
+    }
+    return error;
+  }
+
+  std::vector<float> grad_;
+};
+
+TEST_F(TestGradientCodec, RoundTrip) {
+  std::vector<GradCodecType> types = {kGradCodecFp16, kGradCodecBf16, kGradCodecInt8};
+  std::vector<float> max_errors = {5e-3, 5e-2, 5e-2};
+  for (size_t i = 0; i < types.size(); ++i) {
+    auto codec = CreateGradientCodec(types[i]);
+    ASSERT_NE(codec, nullptr);
+    EXPECT_EQ(codec->type(), types[i]);
+    // the encoded gradient is appended after the data already in the buffer
+    std::vector<float> encoded = {3.0};
+    codec->Encode(grad_.data(), grad_.size(), &encoded);
+    EXPECT_LT(encoded.size(), grad_.size() / 2 + 4);
+    std::vector<float> decoded;
+    EXPECT_EQ(codec->Decode(encoded.data() + 1, encoded.size() - 1, &decoded), encoded.size() - 1);
+    EXPECT_LT(MaxError(decoded, grad_), max_errors[i]);
+  }
+  EXPECT_EQ(CreateGradientCodec(kGradCodecNone), nullptr);
+}
+
+TEST_F(TestGradientCodec, TopKErrorFeedback) {
+  auto codec = CreateGradientCodec(kGradCodecTopK, 0.1);
+  ASSERT_NE(codec, nullptr);
+  std::vector<float> sent(grad_.size(), 0);
+  size_t step_num = 20;
+  std::vector<float> zeros(grad_.size(), 0);
+  // the residual of 1000 elements is flushed by 10 zero gradients at a ratio of 0.1
+  size_t flush_step_num = 10;
+  for (size_t step = 0; step < step_num + flush_step_num; ++step) {
+    std::vector<float> encoded;
+    codec->Encode(step < step_num ? grad_.data() : zeros.data(), grad_.size(), &encoded);
+    // header, k, then k indices and k values
+    EXPECT_EQ(encoded.size(), 2 + 2 * 100);
+    std::vector<float> decoded;
+    EXPECT_EQ(codec->Decode(encoded.data(), encoded.size(), &decoded), encoded.size());
+    for (size_t i = 0; i < sent.size(); ++i) {
+      sent[i] += decoded[i];
+    }
+  }
+  // what is not sent stays in the residual, nothing is lost once it is flushed
+  std::vector<float> expected(grad_.size());
+  for (size_t i = 0; i < grad_.size(); ++i) {
+    expected[i] = grad_[i] * step_num;
+  }
+  EXPECT_LT(MaxError(sent, expected), 1e-3);
+}
+
+TEST_F(TestGradientCodec, Truncated) {
+  auto codec = CreateGradientCodec(kGradCodecFp16);
+  std::vector<float> encoded;
+  codec->Encode(grad_.data(), grad_.size(), &encoded);
+  std::vector<float> decoded;
+  EXPECT_ANY_THROW(codec->Decode(encoded.data(), encoded.size() - 1, &decoded));
+  EXPECT_ANY_THROW(GradCodecTypeFromName("fp8"));
+  EXPECT_EQ(GradCodecTypeFromName("topk"), kGradCodecTopK);
+}
+
+TEST_F(TestGradientCodec, TopKRatio) {
+  EXPECT_FLOAT_EQ(GradTopKRatioFromString("0.05"), 0.05);
+  EXPECT_FLOAT_EQ(GradTopKRatioFromString("1"), 1);
+  EXPECT_ANY_THROW(GradTopKRatioFromString(""));
+  EXPECT_ANY_THROW(GradTopKRatioFromString("abc"));
+  EXPECT_ANY_THROW(GradTopKRatioFromString("0.1x"));
+  EXPECT_ANY_THROW(GradTopKRatioFromString("0"));
+  EXPECT_ANY_THROW(GradTopKRatioFromString("-0.5"));
+  EXPECT_ANY_THROW(GradTopKRatioFromString("1.5"));
+  EXPECT_ANY_THROW(GradTopKRatioFromString("nan"));
+}
+}  // namespace ps
+}  // namespace mindspore
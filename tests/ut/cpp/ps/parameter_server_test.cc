@@ -0,0 +1,187 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#define private public
+#define protected public
+#include "ps/parameter_server.h"
+#undef private
+#undef protected
+
+namespace mindspore {
+namespace ps {
+namespace {
+constexpr size_t kWorkerNum = 4;
+constexpr size_t kStepNum = 6;
+constexpr float kLearningRate = 0.5;
+constexpr float kMomentum = 0.5;
+constexpr auto kTimeout = std::chrono::seconds(60);
+
+// The gradients, their mean and the momentum updates are exact in float, so the weights don't depend on the order
+// the workers push in.
+float Gradient(size_t worker, size_t step, Key key, size_t index) {
+  return static_cast<float>((worker + step * 3 + key + index) % 5) - 2.0f;
+}
+}  // namespace
+
+class TestParameterServer : public UT::Common {
+ public:
+  TestParameterServer() = default;
+
+  void SetUp() override {
+    ps_.reset(new ParameterServer<float>());
+    ps_->worker_num_ = kWorkerNum;
+    ps_->pserver_num_ = 1;
+    ps_->InitOptimInfoBuilders();
+  }
+
+  void TearDown() override { ps_.reset(); }
+
+  // A dense weight updated by ApplyMomentum, set up as the init requests of the workers do.
+  void AddWeight(const Key &key, size_t size) {
+    WeightPtr weight = std::make_shared<Weight>(size, 0);
+    for (size_t i = 0; i < size; ++i) {
+      (*weight)[i] = static_cast<float>(i % 8);
+    }
+    ps_->InitWeight(key, weight);
+    ps_->InitGrad(key, std::make_shared<Grad>(size, 0));
+    ps_->weight_key_to_optims_[key] = kApplyMomentum;
+    ps_->optimizers_[key] = std::make_shared<kernel::ps::ApplyMomentumPSKernel>(0, 1, kWorkerNum);
+    ps_->optim_inputs_shape_[key] = std::make_shared<InputsShape>();
+    ps_->optim_infos_.emplace(key, nullptr);
+    keys_.push_back(key);
+    sizes_.push_back(size);
+  }
+
+  // Spins until ready returns true, gives up when the server doesn't make progress.
+  bool WaitUntil(const std::function<bool()> &ready) {
+    auto deadline = std::chrono::steady_clock::now() + kTimeout;
+    while (!ready()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        timeout_ = true;
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  // Pushes the gradients of all keys, then pulls all keys, for every step, the way a synchronous worker does.
+  void RunWorker(size_t worker, std::vector<WeightPtr> *pulled) {
+    for (size_t step = 0; step < kStepNum; ++step) {
+      for (size_t k = 0; k < keys_.size(); ++k) {
+        Key key = keys_[k];
+        if (!WaitUntil([this, key]() { return ps_->ReadyForPush(key); })) {
+          return;
+        }
+        Keys keys;
+        keys.push_back(key);
+        Values values;
+        Lengths lengths;
+        values.push_back(kLearningRate);
+        for (size_t i = 0; i < sizes_[k]; ++i) {
+          values.push_back(Gradient(worker, step, key, i));
+        }
+        values.push_back(kMomentum);
+        lengths.push_back(1);
+        lengths.push_back(SizeToInt(sizes_[k]));
+        lengths.push_back(1);
+        ps_->AccumGrad(keys, values, lengths, SizeToInt(worker));
+      }
+      for (size_t k = 0; k < keys_.size(); ++k) {
+        Key key = keys_[k];
+        if (!WaitUntil([this, key, worker]() { return ps_->ReadyForPull(key, SizeToInt(worker)); })) {
+          return;
+        }
+        (*pulled)[k] = ps_->weight(key, SizeToInt(worker));
+      }
+    }
+  }
+
+  // The weights after kStepNum steps of ApplyMomentum on the mean gradient of the workers, computed in order.
+  std::vector<float> ExpectedWeight(const Key &key, size_t size) {
+    std::vector<float> weight(size);
+    std::vector<float> accum(size, 0);
+    for (size_t i = 0; i < size; ++i) {
+      weight[i] = static_cast<float>(i % 8);
+    }
+    for (size_t step = 0; step < kStepNum; ++step) {
+      for (size_t i = 0; i < size; ++i) {
+        float grad = 0;
+        for (size_t worker = 0; worker < kWorkerNum; ++worker) {
+          grad += Gradient(worker, step, key, i);
+        }
+        grad /= kWorkerNum;
+        accum[i] = accum[i] * kMomentum + grad;
+        weight[i] -= accum[i] * kLearningRate;
+      }
+    }
+    return weight;
+  }
+
+  std::unique_ptr<ParameterServer<float>> ps_;
+  std::vector<Key> keys_;
+  std::vector<size_t> sizes_;
+  std::atomic<bool> timeout_{false};
+};
+
+TEST_F(TestParameterServer, ConcurrentPushPullAndUpdate) {
+  // keys 1 and 65 share a lock stripe, 2 and 7 have their own, and 2 is large enough to be updated while the others
+  // are pulled
+  AddWeight(1, 16);
+  AddWeight(1 + kKeyLockStripeNum, 16);
+  AddWeight(2, 40000);
+  AddWeight(7, 3);
+  EXPECT_EQ(&ps_->key_mutex(1), &ps_->key_mutex(1 + kKeyLockStripeNum));
+  EXPECT_NE(&ps_->key_mutex(1), &ps_->key_mutex(2));
+
+  std::thread update_thread(&ParameterServer<float>::UpdateWeights, ps_.get());
+  std::vector<std::vector<WeightPtr>> pulled(kWorkerNum, std::vector<WeightPtr>(keys_.size()));
+  std::vector<std::thread> workers;
+  for (size_t worker = 0; worker < kWorkerNum; ++worker) {
+    workers.emplace_back(&TestParameterServer::RunWorker, this, worker, &pulled[worker]);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  ps_->Finalize();
+  update_thread.join();
+  ASSERT_FALSE(timeout_.load());
+
+  for (size_t k = 0; k < keys_.size(); ++k) {
+    std::vector<float> expected = ExpectedWeight(keys_[k], sizes_[k]);
+    const WeightPtr &weight = ps_->weights_.at(keys_[k]);
+    ASSERT_EQ(weight->size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ((*weight)[i], expected[i]) << "key " << keys_[k] << ", index " << i;
+    }
+    // every worker pulled the weights of the last step
+    for (size_t worker = 0; worker < kWorkerNum; ++worker) {
+      const WeightPtr &weight_pulled = pulled[worker][k];
+      ASSERT_NE(weight_pulled, nullptr);
+      for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ((*weight_pulled)[i], expected[i]) << "worker " << worker << ", key " << keys_[k];
+      }
+    }
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,129 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <thread>
+#include "common/common_test.h"
+#include "ps/staleness_clock.h"
+
+namespace mindspore {
+namespace ps {
+class TestStalenessClock : public UT::Common {
+ public:
+  TestStalenessClock() = default;
+
+ protected:
+  const Key key_ = 0;
+  const int worker0_ = 9;
+  const int worker1_ = 11;
+};
+
+TEST_F(TestStalenessClock, StalenessBound) {
+  StalenessClock clock(2, 1, std::chrono::hours(1));
+  EXPECT_TRUE(clock.ReadyForPull(key_, worker0_));
+  clock.Push(key_, worker0_, true);
+  EXPECT_TRUE(clock.ReadyForPull(key_, worker0_));
+  // the other worker hasn't shown up yet, it is at 0
+  clock.Push(key_, worker0_, true);
+  EXPECT_FALSE(clock.ReadyForPull(key_, worker0_));
+  clock.Push(key_, worker1_, true);
+  EXPECT_TRUE(clock.ReadyForPull(key_, worker0_));
+  EXPECT_TRUE(clock.ReadyForPull(key_, worker1_));
+  // the keys are counted separately
+  EXPECT_TRUE(clock.ReadyForPull(key_ + 1, worker0_));
+}
+
+TEST_F(TestStalenessClock, PushSlack) {
+  StalenessClock clock(2, 2, std::chrono::hours(1));
+  uint64_t slack = 0;
+  EXPECT_TRUE(clock.PushSlack(key_, worker0_, &slack));
+  EXPECT_EQ(slack, 2);
+  clock.Push(key_, worker0_, true);
+  EXPECT_TRUE(clock.PushSlack(key_, worker0_, &slack));
+  EXPECT_EQ(slack, 1);
+  EXPECT_TRUE(clock.PushSlack(key_, worker1_, &slack));
+  EXPECT_EQ(slack, 2);
+  clock.Push(key_, worker0_, true);
+  clock.Push(key_, worker0_, true);
+  EXPECT_FALSE(clock.PushSlack(key_, worker0_, &slack));
+  clock.Push(key_, worker1_, true);
+  EXPECT_TRUE(clock.PushSlack(key_, worker0_, &slack));
+  EXPECT_EQ(slack, 0);
+}
+
+TEST_F(TestStalenessClock, GradStaleness) {
+  StalenessClock clock(2, 0, std::chrono::hours(1));
+  clock.Pull(key_, worker0_);
+  clock.Push(key_, worker1_, true);
+  clock.Push(key_, worker1_, false);
+  clock.Push(key_, worker1_, true);
+  EXPECT_EQ(clock.GradStaleness(key_, worker0_), 2);
+  EXPECT_EQ(clock.GradStaleness(key_, worker1_), 2);
+  clock.Pull(key_, worker0_);
+  EXPECT_EQ(clock.GradStaleness(key_, worker0_), 0);
+}
+
+TEST_F(TestStalenessClock, FinishedWorkerIsNotWaitedFor) {
+  StalenessClock clock(2, 1, std::chrono::hours(1));
+  clock.Pull(key_, worker1_);
+  for (int i = 0; i < 3; ++i) {
+    clock.Push(key_, worker0_, true);
+  }
+  EXPECT_FALSE(clock.ReadyForPull(key_, worker0_));
+  EXPECT_FALSE(clock.Finish(worker1_));
+  EXPECT_TRUE(clock.ReadyForPull(key_, worker0_));
+  EXPECT_TRUE(clock.Finish(worker0_));
+}
+
+TEST_F(TestStalenessClock, SilentWorkerTimesOut) {
+  const auto timeout = std::chrono::milliseconds(100);
+  StalenessClock clock(2, 1, timeout);
+  clock.Push(key_, worker1_, true);
+  for (int i = 0; i < 3; ++i) {
+    clock.Push(key_, worker0_, true);
+  }
+  // the pull of the worker ahead waits like the worker polls it, until the silent worker times out
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(clock.ReadyForPull(key_, worker0_));
+  while (!clock.ReadyForPull(key_, worker0_)) {
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_GE(std::chrono::steady_clock::now() - start, timeout);
+  // the bound holds again once the silent worker comes back
+  clock.Push(key_, worker0_, true);
+  clock.Push(key_, worker1_, true);
+  EXPECT_FALSE(clock.ReadyForPull(key_, worker0_));
+}
+
+TEST_F(TestStalenessClock, UnseenWorkerTimesOut) {
+  StalenessClock clock(2, 0, std::chrono::milliseconds(100));
+  clock.Push(key_, worker0_, true);
+  EXPECT_FALSE(clock.ReadyForPull(key_, worker0_));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_TRUE(clock.ReadyForPull(key_, worker0_));
+}
+
+TEST_F(TestStalenessClock, ParseEnv) {
+  EXPECT_EQ(ParseStalenessEnv(kEnvStaleness, "0"), 0);
+  EXPECT_EQ(ParseStalenessEnv(kEnvStaleness, "3"), 3);
+  EXPECT_ANY_THROW(ParseStalenessEnv(kEnvStaleness, ""));
+  EXPECT_ANY_THROW(ParseStalenessEnv(kEnvStaleness, "-1"));
+  EXPECT_ANY_THROW(ParseStalenessEnv(kEnvStaleness, "abc"));
+  EXPECT_ANY_THROW(ParseStalenessEnv(kEnvStaleness, "2x"));
+  EXPECT_ANY_THROW(ParseStalenessEnv(kEnvStaleness, "99999999999999999999999"));
+}
+}  // namespace ps
+}  // namespace mindspore